@@ -0,0 +1,82 @@
+// Connected components and minimum spanning forest throughput.
+//
+//   components_benchmark [vertices] [edges]    (default 1000000, 4000000)
+//
+// Vertices are random points in a cube and each edge joins a vertex to a
+// random one of its 64 index neighbours, so the graph splits into many
+// components at low densities and has Euclidean weights with local
+// structure. Timed: component labelling, then the spanning forest with
+// Kruskal (parallel radix sort, serial unions) and with Boruvka.
+// Build with -DALICE2_BUILD_BENCHMARKS=ON.
+
+#include "../src/coda/core/geometry/GraphComponents.h"
+#include "../src/coda/core/utilities/Parallel.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <vector>
+
+using namespace alice2;
+
+namespace {
+
+double Milliseconds(const std::function<void()>& work) {
+    auto start = std::chrono::steady_clock::now();
+    work();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int vertices = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    int edges = argc > 2 ? std::atoi(argv[2]) : 4000000;
+    if (vertices < 2) {
+        vertices = 2;
+    }
+    if (edges < 1) {
+        edges = 1;
+    }
+
+    std::mt19937 random(11);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::vector<Vec3f> positions(size_t(vertices), Vec3f(0.0f, 0.0f, 0.0f));
+    for (Vec3f& position : positions) {
+        position = Vec3f(unit(random), unit(random), unit(random));
+    }
+    std::vector<uint32_t> edgeVertices;
+    edgeVertices.reserve(size_t(edges) * 2);
+    for (int i = 0; i < edges; ++i) {
+        uint32_t a = random() % uint32_t(vertices);
+        uint32_t b = uint32_t((a + 1 + random() % 64) % uint32_t(vertices));
+        edgeVertices.insert(edgeVertices.end(), {a, b});
+    }
+    Graph graph;
+    if (!graph.Create(positions, edgeVertices)) {
+        return 1;
+    }
+    std::printf("%zu vertices, %zu edges, %zu threads\n", graph.GetVertexCount(), graph.GetEdgeCount(),
+                parallel::ThreadCount());
+
+    GraphComponents components;
+    std::vector<uint32_t> labels, forest;
+    size_t count = 0;
+    double labelling = Milliseconds([&] { count = components.ComputeComponents(graph, labels); });
+    std::printf("  %-24s %9.1f ms   (%zu components)\n", "components", labelling, count);
+
+    bool ok = true;
+    const SpanningForestMethod methods[] = {SpanningForestMethod::Kruskal, SpanningForestMethod::Boruvka};
+    const char* names[] = {"forest (Kruskal)", "forest (Boruvka)"};
+    for (int m = 0; m < 2; ++m) {
+        SpanningForestSettings settings;
+        settings.method = methods[m];
+        components.SetSettings(settings);
+        double weight = 0.0;
+        double time = Milliseconds([&] { ok = components.ComputeSpanningForest(graph, forest, &weight) && ok; });
+        std::printf("  %-24s %9.1f ms   (%zu edges, weight %.1f)\n", names[m], time, forest.size(), weight);
+    }
+    return ok ? 0 : 1;
+}
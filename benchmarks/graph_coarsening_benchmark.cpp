@@ -0,0 +1,99 @@
+// Multilevel coarsening and multilevel layout.
+//
+//   graph_coarsening_benchmark [nodes] [iterations]    (default 1000000, 30)
+//
+// The graph is the random sparse network of graph_layout_benchmark: each
+// node links to one of the eight previous nodes and, past the first few,
+// to a uniformly random earlier one. Timed: building the heavy-edge
+// hierarchy (listed level by level), then a multilevel layout with the
+// given iterations per level on a tenth of the nodes, against the same
+// iterations of a flat layout from the spread start.
+// Build with -DALICE2_BUILD_BENCHMARKS=ON.
+
+#include "../src/coda/core/geometry/GraphCoarsening.h"
+#include "../src/coda/core/utilities/Parallel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <vector>
+
+using namespace alice2;
+
+namespace {
+
+double Milliseconds(const std::function<void()>& work) {
+    auto start = std::chrono::steady_clock::now();
+    work();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+Graph MakeGraph(int nodes) {
+    std::mt19937 random(7);
+    std::vector<uint32_t> edges;
+    for (int i = 1; i < nodes; ++i) {
+        int local = i - 1 - int(random() % uint32_t(std::min(i, 8)));
+        edges.insert(edges.end(), {uint32_t(local), uint32_t(i)});
+        if (i > 8) {
+            edges.insert(edges.end(), {uint32_t(random() % uint32_t(i)), uint32_t(i)});
+        }
+    }
+    Graph graph;
+    graph.Create(std::vector<Vec3f>(size_t(nodes), Vec3f(0.0f, 0.0f, 0.0f)), edges);
+    return graph;
+}
+
+// Mean edge length over the layout's extent; lower is tighter
+double Spread(const Graph& graph) {
+    const std::vector<Vec3f>& positions = graph.GetPositions();
+    Vec3f minBound = positions[0], maxBound = positions[0];
+    for (const Vec3f& p : positions) {
+        minBound = Vec3f(std::min(minBound.x, p.x), std::min(minBound.y, p.y), std::min(minBound.z, p.z));
+        maxBound = Vec3f(std::max(maxBound.x, p.x), std::max(maxBound.y, p.y), std::max(maxBound.z, p.z));
+    }
+    double length = 0.0;
+    for (uint32_t e = 0; e < graph.GetEdgeCount(); ++e) {
+        length += (graph.GetPosition(graph.GetEdgeSource(e)) - graph.GetPosition(graph.GetEdgeTarget(e))).Length();
+    }
+    return length / double(graph.GetEdgeCount()) / double((maxBound - minBound).Length());
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int nodes = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 30;
+    if (nodes < 100) {
+        nodes = 100;
+    }
+    if (iterations < 1) {
+        iterations = 1;
+    }
+
+    Graph graph = MakeGraph(nodes);
+    std::printf("%zu nodes, %zu edges, %zu threads\n", graph.GetVertexCount(), graph.GetEdgeCount(),
+                parallel::ThreadCount());
+
+    GraphHierarchy hierarchy;
+    bool ok = true;
+    double build = Milliseconds([&] { ok = hierarchy.Build(graph); });
+    std::printf("  %-24s %9.1f ms   (%zu levels)\n", "hierarchy", build, hierarchy.GetLevelCount());
+    for (size_t l = 0; l < hierarchy.GetLevelCount(); ++l) {
+        const Graph& level = hierarchy.GetLevel(l).graph;
+        std::printf("    level %-2zu %10zu nodes %10zu edges\n", l, level.GetVertexCount(), level.GetEdgeCount());
+    }
+
+    Graph multilevel = MakeGraph(std::max(nodes / 10, 100)), flat = MakeGraph(std::max(nodes / 10, 100));
+    GraphHierarchy layoutHierarchy;
+    GraphLayout layout;
+    double time = Milliseconds([&] { ok = layoutHierarchy.Layout(multilevel, layout, iterations) && ok; });
+    std::printf("  %-24s %9.1f ms   (%zu levels, spread %.4f)\n", "multilevel layout", time,
+                layoutHierarchy.GetLevelCount(), Spread(multilevel));
+    GraphLayout flatLayout;
+    time = Milliseconds([&] { ok = flatLayout.Step(flat, iterations) && ok; });
+    std::printf("  %-24s %9.1f ms   (spread %.4f)\n", "flat layout", time, Spread(flat));
+    return ok ? 0 : 1;
+}
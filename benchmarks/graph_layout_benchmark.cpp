@@ -0,0 +1,70 @@
+// Barnes-Hut force-directed layout throughput.
+//
+//   graph_layout_benchmark [nodes] [iterations]    (default 100000, 20)
+//
+// The graph is a random sparse network: each node links to two
+// earlier nodes, one nearby in index and one uniformly random, so it has
+// both local structure and long-range shortcuts. Timed: the first
+// iteration (which also spreads the coincident start positions) and the
+// mean of the following ones, i.e. the cost of one interactive frame.
+// Build with -DALICE2_BUILD_BENCHMARKS=ON.
+
+#include "../src/coda/core/geometry/GraphLayout.h"
+#include "../src/coda/core/utilities/Parallel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <vector>
+
+using namespace alice2;
+
+namespace {
+
+double Milliseconds(const std::function<void()>& work) {
+    auto start = std::chrono::steady_clock::now();
+    work();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int nodes = argc > 1 ? std::atoi(argv[1]) : 100000;
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 20;
+    if (nodes < 2) {
+        nodes = 2;
+    }
+    if (iterations < 1) {
+        iterations = 1;
+    }
+
+    std::mt19937 random(7);
+    std::vector<Vec3f> positions(size_t(nodes), Vec3f(0.0f, 0.0f, 0.0f));
+    std::vector<uint32_t> edges;
+    for (int i = 1; i < nodes; ++i) {
+        int local = i - 1 - int(random() % uint32_t(std::min(i, 8)));
+        edges.insert(edges.end(), {uint32_t(local), uint32_t(i)});
+        if (i > 8) {
+            edges.insert(edges.end(), {uint32_t(random() % uint32_t(i)), uint32_t(i)});
+        }
+    }
+    Graph graph;
+    if (!graph.Create(positions, edges)) {
+        return 1;
+    }
+    std::printf("%zu nodes, %zu edges, %zu threads\n", graph.GetVertexCount(), graph.GetEdgeCount(),
+                parallel::ThreadCount());
+
+    GraphLayout layout;
+    bool ok = true;
+    double first = Milliseconds([&] { ok = layout.Step(graph); });
+    std::printf("  %-24s %9.1f ms   (%zu nodes)\n", "first iteration", first, layout.GetNodes().size());
+    double steady = Milliseconds([&] { ok = layout.Step(graph, iterations) && ok; });
+    std::printf("  %-24s %9.1f ms   (%d iterations, speed %.3g)\n", "per iteration", steady / iterations,
+                iterations, double(layout.GetSpeed()));
+    return ok ? 0 : 1;
+}
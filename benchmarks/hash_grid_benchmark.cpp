@@ -0,0 +1,89 @@
+// Spatial hash grid rebuild and radius query throughput.
+//
+//   hash_grid_benchmark [points] [neighbours]    (default 1000000, 32)
+//
+// Particles fill a unit cube uniformly and the query radius is chosen so a
+// ball holds the given number of neighbours on average; cells are one
+// radius wide. Timed: a first build, a rebuild after every particle moved
+// (as a simulation frame would), the neighbour lists of every particle, and
+// the same queries issued in random order through ForEachInRadius.
+// Build with -DALICE2_BUILD_BENCHMARKS=ON.
+
+#include "../src/coda/core/utilities/HashGrid.h"
+#include "../src/coda/core/utilities/Parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <vector>
+
+using namespace alice2;
+
+namespace {
+
+double Milliseconds(const std::function<void()>& work) {
+    auto start = std::chrono::steady_clock::now();
+    work();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int points = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    int neighbours = argc > 2 ? std::atoi(argv[2]) : 32;
+    if (points < 1) {
+        points = 1;
+    }
+    if (neighbours < 1) {
+        neighbours = 1;
+    }
+
+    std::mt19937 random(5);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::vector<Vec3f> positions(static_cast<size_t>(points));
+    for (Vec3f& position : positions) {
+        position = Vec3f(unit(random), unit(random), unit(random));
+    }
+    const float radius = std::cbrt(3.0f * float(neighbours) / (4.0f * 3.14159265f * float(points)));
+    std::printf("%zu points, radius %.4f, %zu threads\n", positions.size(), radius, parallel::ThreadCount());
+
+    spatial::HashGrid grid;
+    double build = Milliseconds([&] { grid.Build(positions, radius); });
+    std::printf("  %-24s %9.1f ms   (%zu buckets)\n", "build", build, grid.GetBucketCount());
+
+    std::uniform_real_distribution<float> jitter(-0.25f * radius, 0.25f * radius);
+    for (Vec3f& position : positions) {
+        position += Vec3f(jitter(random), jitter(random), jitter(random));
+    }
+    double rebuild = Milliseconds([&] { grid.Build(positions, radius); });
+    std::printf("  %-24s %9.1f ms\n", "rebuild", rebuild);
+
+    std::vector<uint32_t> offsets, neighbors;
+    double lists = Milliseconds([&] { grid.FindAllInRadius(radius, offsets, neighbors); });
+    std::printf("  %-24s %9.1f ms   (%.1f per point)\n", "all neighbour lists", lists,
+                double(neighbors.size()) / double(positions.size()));
+
+    std::vector<uint32_t> queries(positions.size());
+    for (size_t i = 0; i < queries.size(); ++i) {
+        queries[i] = uint32_t(i);
+    }
+    std::shuffle(queries.begin(), queries.end(), random);
+    std::atomic<size_t> found{0};
+    double scattered = Milliseconds([&] {
+        parallel::For(queries.size(), 1024, [&](size_t begin, size_t end) {
+            size_t local = 0;
+            for (size_t i = begin; i < end; ++i) {
+                grid.ForEachInRadius(positions[queries[i]], radius, [&](uint32_t, float) { ++local; });
+            }
+            found += local;
+        });
+    });
+    std::printf("  %-24s %9.1f ms   (%zu hits)\n", "random-order queries", scattered, found.load());
+    return found.load() == neighbors.size() + positions.size() ? 0 : 1;
+}
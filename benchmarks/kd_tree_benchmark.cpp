@@ -0,0 +1,97 @@
+// KD-tree build and batched neighbour query throughput on a point cloud.
+//
+//   kd_tree_benchmark [points] [queries] [k]    (default 10000000, 1000000, 8)
+//
+// The cloud samples a bumpy torus with a little noise, as a scan would.
+// Timed: the parallel build, batched kNN for queries taken from the cloud
+// in leaf order (coherent, as normal estimation issues them) and in random
+// order, a kNN capped at a radius, and an uncapped batched radius search
+// sized to about k neighbours per query.
+// Build with -DALICE2_BUILD_BENCHMARKS=ON.
+
+#include "../src/coda/core/utilities/KdTree.h"
+#include "../src/coda/core/utilities/Parallel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <vector>
+
+using namespace alice2;
+
+namespace {
+
+double Milliseconds(const std::function<void()>& work) {
+    auto start = std::chrono::steady_clock::now();
+    work();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int points = argc > 1 ? std::atoi(argv[1]) : 10000000;
+    int queryCount = argc > 2 ? std::atoi(argv[2]) : 1000000;
+    int k = argc > 3 ? std::atoi(argv[3]) : 8;
+    points = std::max(points, 1);
+    queryCount = std::max(std::min(queryCount, points), 1);
+    k = std::max(k, 1);
+
+    const float pi = 3.14159265f;
+    std::mt19937 random(9);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::normal_distribution<float> noise(0.0f, 0.002f);
+    std::vector<Vec3f> cloud(static_cast<size_t>(points));
+    for (Vec3f& point : cloud) {
+        float u = 2.0f * pi * unit(random), v = 2.0f * pi * unit(random);
+        float tube = 0.3f + 0.03f * std::sin(6.0f * u) * std::cos(4.0f * v) + noise(random);
+        point = Vec3f((1.0f + tube * std::cos(v)) * std::cos(u), (1.0f + tube * std::cos(v)) * std::sin(u),
+                      tube * std::sin(v));
+    }
+    std::printf("%zu points, %d queries, k %d, %zu threads\n", cloud.size(), queryCount, k,
+                parallel::ThreadCount());
+
+    spatial::KdTree tree;
+    double build = Milliseconds([&] { tree.Build(cloud); });
+    std::printf("  %-24s %9.1f ms   (%zu nodes)\n", "build", build, tree.GetNodes().size());
+
+    const size_t count = size_t(queryCount);
+    std::vector<Vec3f> coherent(tree.GetPoints().begin(), tree.GetPoints().begin() + count);
+    std::vector<Vec3f> scattered(count);
+    for (Vec3f& query : scattered) {
+        query = cloud[random() % cloud.size()];
+    }
+    std::vector<uint32_t> indices(count * size_t(k)), counts(count);
+    std::vector<float> distances(count * size_t(k));
+
+    double leafOrder = Milliseconds(
+        [&] { tree.FindKNearest(coherent.data(), count, uint32_t(k), indices.data(), distances.data()); });
+    std::printf("  %-24s %9.1f ms\n", "kNN (leaf order)", leafOrder);
+    double randomOrder = Milliseconds(
+        [&] { tree.FindKNearest(scattered.data(), count, uint32_t(k), indices.data(), distances.data()); });
+    std::printf("  %-24s %9.1f ms\n", "kNN (random order)", randomOrder);
+
+    // Radius of a disc holding 2k points on the smooth torus (area 4 pi^2 R r);
+    // the bumps, noise and uneven (u, v) sampling leave about k inside
+    const float area = 4.0f * pi * pi * 0.3f;
+    const float radius = std::sqrt(2.0f * float(k) * area / (pi * float(points)));
+    size_t found = 0;
+    double capped = Milliseconds([&] {
+        tree.FindKNearest(coherent.data(), count, uint32_t(k), indices.data(), distances.data(), counts.data(),
+                          radius);
+    });
+    for (uint32_t c : counts) {
+        found += c;
+    }
+    std::printf("  %-24s %9.1f ms   (%.1f per query)\n", "kNN within radius", capped, double(found) / double(count));
+
+    std::vector<uint32_t> offsets, neighbours;
+    double uncapped = Milliseconds([&] { tree.FindInRadius(coherent.data(), count, radius, offsets, neighbours); });
+    std::printf("  %-24s %9.1f ms   (%.1f per query)\n", "radius search", uncapped,
+                double(neighbours.size()) / double(count));
+    return 0;
+}
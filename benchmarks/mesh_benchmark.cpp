@@ -0,0 +1,304 @@
+// Index-based half-edge Mesh vs. a naive pointer-based half-edge mesh.
+//
+//   mesh_benchmark [gridSize]    (default 1000 -> 1M quads; 3163 -> ~10M)
+//
+// Both meshes hold the same quad grid. Each timed pass does the same work:
+// build, one-ring Laplacian average, face centres, boundary loop walk and
+// area-weighted vertex normals. Results are cross-checked by checksum.
+// Build with -DALICE2_BUILD_BENCHMARKS=ON.
+
+#include "../src/coda/core/geometry/Mesh.h"
+#include "../src/coda/core/interface/functionset/FnMesh.h"
+#include "../src/coda/core/interface/iterators/ItMesh.h"
+#include "../src/coda/core/utilities/Parallel.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+using namespace alice2;
+
+namespace {
+
+// ---------------------------------------------------------------------------
+// Naive pointer mesh: one heap node per element, links are raw pointers
+// ---------------------------------------------------------------------------
+
+struct PHalfEdge;
+
+struct PVertex {
+    Vec3f position;
+    PHalfEdge* outgoing = nullptr;
+};
+
+struct PFace {
+    PHalfEdge* halfEdge = nullptr;
+};
+
+struct PHalfEdge {
+    PHalfEdge* next = nullptr;
+    PHalfEdge* prev = nullptr;
+    PHalfEdge* twin = nullptr;
+    PVertex* target = nullptr;
+    PFace* face = nullptr;
+};
+
+struct PointerMesh {
+    std::vector<PVertex*> vertices;
+    std::vector<PFace*> faces;
+    std::vector<PHalfEdge*> halfEdges;
+
+    ~PointerMesh() {
+        for (PVertex* v : vertices) delete v;
+        for (PFace* f : faces) delete f;
+        for (PHalfEdge* h : halfEdges) delete h;
+    }
+
+    void Build(const std::vector<Vec3f>& positions, const std::vector<uint32_t>& faceIndices, size_t faceSize) {
+        for (const Vec3f& p : positions) {
+            vertices.push_back(new PVertex{p});
+        }
+
+        std::unordered_map<uint64_t, PHalfEdge*> directed;
+        directed.reserve(faceIndices.size());
+        size_t faceCount = faceIndices.size() / faceSize;
+        for (size_t f = 0; f < faceCount; ++f) {
+            PFace* face = new PFace();
+            faces.push_back(face);
+            PHalfEdge* loop[8];
+            for (size_t k = 0; k < faceSize; ++k) {
+                uint32_t from = faceIndices[f * faceSize + k];
+                uint32_t to = faceIndices[f * faceSize + (k + 1) % faceSize];
+                PHalfEdge* h = new PHalfEdge();
+                h->target = vertices[to];
+                h->face = face;
+                halfEdges.push_back(h);
+                loop[k] = h;
+                vertices[from]->outgoing = h;
+                directed[(uint64_t(from) << 32) | to] = h;
+
+                auto twin = directed.find((uint64_t(to) << 32) | from);
+                if (twin != directed.end()) {
+                    h->twin = twin->second;
+                    twin->second->twin = h;
+                }
+            }
+            for (size_t k = 0; k < faceSize; ++k) {
+                loop[k]->next = loop[(k + 1) % faceSize];
+                loop[(k + 1) % faceSize]->prev = loop[k];
+            }
+            face->halfEdge = loop[0];
+        }
+
+        // Boundary half-edges, then their loop links
+        size_t interiorCount = halfEdges.size();
+        for (size_t i = 0; i < interiorCount; ++i) {
+            PHalfEdge* h = halfEdges[i];
+            if (!h->twin) {
+                PHalfEdge* b = new PHalfEdge();
+                b->target = h->prev->target;
+                b->twin = h;
+                h->twin = b;
+                halfEdges.push_back(b);
+            }
+        }
+        for (size_t i = interiorCount; i < halfEdges.size(); ++i) {
+            PHalfEdge* b = halfEdges[i];
+            PHalfEdge* h = b->twin;
+            while (h->face) {
+                h = h->prev->twin;
+            }
+            b->next = h;
+            h->prev = b;
+        }
+        for (size_t i = interiorCount; i < halfEdges.size(); ++i) {
+            PHalfEdge* b = halfEdges[i];
+            b->twin->target->outgoing = b; // Boundary outgoing preferred
+        }
+    }
+};
+
+double Milliseconds(const std::function<void()>& work) {
+    auto start = std::chrono::steady_clock::now();
+    work();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+double Checksum(const std::vector<Vec3f>& values) {
+    double sum = 0.0;
+    for (size_t i = 0; i < values.size(); ++i) {
+        sum += (values[i].x + 2.0 * values[i].y + 3.0 * values[i].z) * (1.0 + double(i % 7));
+    }
+    return sum;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int gridSize = argc > 1 ? std::atoi(argv[1]) : 1000;
+    if (gridSize < 2) {
+        gridSize = 2;
+    }
+
+    std::printf("Grid %d x %d (%zu quads), %zu threads\n", gridSize, gridSize,
+                size_t(gridSize) * gridSize, parallel::ThreadCount());
+
+    // Source soup (shared by both meshes); bumped heights so normals vary
+    Mesh mesh;
+    FnMesh fnMesh(mesh);
+    fnMesh.CreateGrid(gridSize, gridSize, 1.0f);
+    std::vector<Vec3f> positions = mesh.GetPositions();
+    for (size_t i = 0; i < positions.size(); ++i) {
+        positions[i].y = 0.25f * float((i * 2654435761u) % 1000) / 1000.0f;
+    }
+    std::vector<uint32_t> faceIndices;
+    std::vector<uint32_t> faceCounts(mesh.GetFaceCount(), 4);
+    faceIndices.reserve(mesh.GetFaceCount() * 4);
+    for (uint32_t f : Faces(mesh)) {
+        for (uint32_t v : FaceVertices(mesh, f)) {
+            faceIndices.push_back(v);
+        }
+    }
+
+    // --- Build --------------------------------------------------------------
+    double indexBuild = Milliseconds([&] { mesh.Create(positions, faceCounts, faceIndices); });
+    PointerMesh pointerMesh;
+    double pointerBuild = Milliseconds([&] { pointerMesh.Build(positions, faceIndices, 4); });
+    std::printf("  mesh valid: %s, %zu half-edges\n", fnMesh.Validate() ? "yes" : "NO", mesh.GetHalfEdgeCount());
+
+    // --- One-ring Laplacian average -----------------------------------------
+    std::vector<Vec3f> indexAverage(mesh.GetVertexCount()), pointerAverage(mesh.GetVertexCount());
+    double indexRing = Milliseconds([&] {
+        for (uint32_t v : Vertices(mesh)) {
+            Vec3f sum;
+            int count = 0;
+            for (uint32_t n : VertexNeighbors(mesh, v)) {
+                sum += mesh.GetPosition(n);
+                ++count;
+            }
+            indexAverage[v] = count ? sum / float(count) : mesh.GetPosition(v);
+        }
+    });
+    double pointerRing = Milliseconds([&] {
+        for (size_t v = 0; v < pointerMesh.vertices.size(); ++v) {
+            PHalfEdge* start = pointerMesh.vertices[v]->outgoing;
+            Vec3f sum;
+            int count = 0;
+            PHalfEdge* h = start;
+            do {
+                sum += h->target->position;
+                ++count;
+                h = h->prev->twin;
+            } while (h != start);
+            pointerAverage[v] = sum / float(count);
+        }
+    });
+
+    // --- Face centres -------------------------------------------------------
+    std::vector<Vec3f> indexCenters(mesh.GetFaceCount()), pointerCenters(mesh.GetFaceCount());
+    double indexFaces = Milliseconds([&] {
+        for (uint32_t f : Faces(mesh)) {
+            Vec3f sum;
+            int count = 0;
+            for (uint32_t v : FaceVertices(mesh, f)) {
+                sum += mesh.GetPosition(v);
+                ++count;
+            }
+            indexCenters[f] = sum / float(count);
+        }
+    });
+    double pointerFaces = Milliseconds([&] {
+        for (size_t f = 0; f < pointerMesh.faces.size(); ++f) {
+            PHalfEdge* start = pointerMesh.faces[f]->halfEdge;
+            Vec3f sum;
+            int count = 0;
+            PHalfEdge* h = start;
+            do {
+                sum += h->prev->target->position;
+                ++count;
+                h = h->next;
+            } while (h != start);
+            pointerCenters[f] = sum / float(count);
+        }
+    });
+
+    // --- Boundary loops -----------------------------------------------------
+    size_t indexBoundary = 0, pointerBoundary = 0;
+    double indexLoops = Milliseconds([&] {
+        std::vector<std::vector<uint32_t>> loops;
+        fnMesh.GetBoundaryLoops(loops);
+        for (const auto& loop : loops) indexBoundary += loop.size();
+    });
+    double pointerLoops = Milliseconds([&] {
+        std::unordered_map<PHalfEdge*, bool> visited;
+        for (PHalfEdge* start : pointerMesh.halfEdges) {
+            if (start->face || visited.count(start)) continue;
+            PHalfEdge* h = start;
+            do {
+                visited[h] = true;
+                ++pointerBoundary;
+                h = h->next;
+            } while (h != start);
+        }
+    });
+
+    // --- Vertex normals (the index side runs on the thread pool) -------------
+    std::vector<Vec3f> indexNormals, pointerNormals(pointerMesh.vertices.size());
+    double indexNormalTime = Milliseconds([&] { fnMesh.ComputeVertexNormals(indexNormals); });
+    double pointerNormalTime = Milliseconds([&] {
+        std::unordered_map<PFace*, Vec3f> faceNormals;
+        faceNormals.reserve(pointerMesh.faces.size());
+        for (PFace* face : pointerMesh.faces) {
+            Vec3f normal;
+            PHalfEdge* h = face->halfEdge;
+            do {
+                const Vec3f& a = h->prev->target->position;
+                const Vec3f& b = h->target->position;
+                normal.x += (a.y - b.y) * (a.z + b.z);
+                normal.y += (a.z - b.z) * (a.x + b.x);
+                normal.z += (a.x - b.x) * (a.y + b.y);
+                h = h->next;
+            } while (h != face->halfEdge);
+            faceNormals[face] = normal;
+        }
+        for (size_t v = 0; v < pointerMesh.vertices.size(); ++v) {
+            PHalfEdge* start = pointerMesh.vertices[v]->outgoing;
+            Vec3f sum;
+            PHalfEdge* h = start;
+            do {
+                if (h->face) sum += faceNormals[h->face];
+                h = h->prev->twin;
+            } while (h != start);
+            pointerNormals[v] = sum.Normalize();
+        }
+    });
+
+    auto report = [](const char* name, double indexMs, double pointerMs) {
+        std::printf("  %-18s index %9.1f ms   pointer %9.1f ms   (%.1fx)\n", name, indexMs, pointerMs,
+                    indexMs > 0.0 ? pointerMs / indexMs : 0.0);
+    };
+    report("build", indexBuild, pointerBuild);
+    report("one-ring average", indexRing, pointerRing);
+    report("face centres", indexFaces, pointerFaces);
+    report("boundary loops", indexLoops, pointerLoops);
+    report("vertex normals", indexNormalTime, pointerNormalTime);
+
+    size_t indexBytes = mesh.GetHalfEdgeCount() * 4 * sizeof(uint32_t)
+        + mesh.GetVertexCount() * (sizeof(Vec3f) + sizeof(uint32_t)) + mesh.GetFaceCount() * sizeof(uint32_t);
+    size_t pointerBytes = pointerMesh.halfEdges.size() * (sizeof(PHalfEdge) + sizeof(void*))
+        + pointerMesh.vertices.size() * (sizeof(PVertex) + sizeof(void*))
+        + pointerMesh.faces.size() * (sizeof(PFace) + sizeof(void*));
+    std::printf("  memory (excl. allocator overhead): index %.1f MB, pointer %.1f MB\n",
+                indexBytes / 1048576.0, pointerBytes / 1048576.0);
+
+    bool match = std::abs(Checksum(indexAverage) - Checksum(pointerAverage)) < 1e-6 * std::abs(Checksum(indexAverage)) + 1e-3
+        && std::abs(Checksum(indexCenters) - Checksum(pointerCenters)) < 1e-6 * std::abs(Checksum(indexCenters)) + 1e-3
+        && std::abs(Checksum(indexNormals) - Checksum(pointerNormals)) < 1e-6 * std::abs(Checksum(indexNormals)) + 1e-3
+        && indexBoundary == pointerBoundary;
+    std::printf("  results match: %s\n", match ? "yes" : "NO");
+    return match ? 0 : 1;
+}
@@ -0,0 +1,123 @@
+// Out-of-core point octree conversion and node read throughput.
+//
+//   point_octree_benchmark [points] [chunk points] [file]
+//                          (default 20000000, 2097152, point_octree_benchmark.a2oct)
+//
+// The cloud samples a bumpy torus with a little noise, as a scan would, and
+// is generated on the fly by a PointSource, so only the builder's chunks are
+// held in memory. Timed: the conversion, reading every node in file order,
+// and reading the nodes a viewer streams first (breadth first, the upper
+// levels of the tree). The file is removed at the end.
+// Build with -DALICE2_BUILD_BENCHMARKS=ON.
+
+#include "../src/coda/core/geometry/PointCloudFile.h"
+#include "../src/coda/core/geometry/PointOctree.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace alice2;
+
+namespace {
+
+double Milliseconds(const std::function<void()>& work) {
+    auto start = std::chrono::steady_clock::now();
+    work();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Repeatable torus samples; Rewind restarts the generator
+class TorusSource : public PointSource {
+public:
+    explicit TorusSource(size_t count) : m_Count(count) {}
+
+    bool Rewind() override {
+        m_Random.seed(7);
+        m_Next = 0;
+        return true;
+    }
+
+    size_t Read(OctreePoint* points, size_t maxCount) override {
+        const float pi = 3.14159265f;
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        std::normal_distribution<float> noise(0.0f, 0.002f);
+        size_t count = std::min(maxCount, m_Count - m_Next);
+        for (size_t i = 0; i < count; ++i) {
+            float u = 2.0f * pi * unit(m_Random);
+            float v = 2.0f * pi * unit(m_Random);
+            float r = 0.3f + 0.02f * std::sin(7.0f * u) * std::sin(5.0f * v);
+            float x = (1.0f + r * std::cos(v)) * std::cos(u);
+            float y = (1.0f + r * std::cos(v)) * std::sin(u);
+            float z = r * std::sin(v);
+            points[i].position = Localize(x + noise(m_Random), y + noise(m_Random), z + noise(m_Random));
+            points[i].color = PackPointColor(Color(u / (2.0f * pi), v / (2.0f * pi), 0.5f));
+        }
+        m_Next += count;
+        return count;
+    }
+
+private:
+    size_t m_Count;
+    size_t m_Next = 0;
+    std::mt19937 m_Random{7};
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    long long points = argc > 1 ? std::atoll(argv[1]) : 20000000;
+    long long chunkPoints = argc > 2 ? std::atoll(argv[2]) : 2097152;
+    std::string path = argc > 3 ? argv[3] : "point_octree_benchmark.a2oct";
+    points = std::max(points, 1LL);
+
+    TorusSource source{size_t(points)};
+    PointOctreeSettings settings;
+    settings.chunkPoints = size_t(std::max(chunkPoints, 1LL));
+    PointOctreeBuilder builder(settings);
+
+    std::printf("Point octree: %lld points, %zu per chunk\n", points, settings.chunkPoints);
+    bool built = false;
+    double build = Milliseconds([&] { built = builder.Build(source, path); });
+    if (!built) {
+        return 1;
+    }
+    std::printf("  %-24s %9.1f ms   (%zu nodes, %zu chunks, depth %u)\n", "convert", build,
+                builder.GetNodeCount(), builder.GetChunkCount(), builder.GetDepth());
+
+    PointOctree octree;
+    if (!octree.Open(path)) {
+        std::remove(path.c_str());
+        return 1;
+    }
+    std::vector<OctreePoint> nodePoints;
+    size_t read = 0;
+    double all = Milliseconds([&] {
+        for (uint32_t node = 0; node < octree.GetNodeCount(); ++node) {
+            octree.ReadNode(node, nodePoints);
+            read += nodePoints.size();
+        }
+    });
+    std::printf("  %-24s %9.1f ms   (%.1f M points/s)\n", "read all nodes", all, double(read) / 1e3 / all);
+
+    // Nodes are stored breadth first: at most 1 + 8 + 64 nodes above level 3
+    const uint32_t first = std::min<uint32_t>(octree.GetNodeCount(), 73);
+    read = 0;
+    double coarse = Milliseconds([&] {
+        for (uint32_t node = 0; node < first; ++node) {
+            octree.ReadNode(node, nodePoints);
+            read += nodePoints.size();
+        }
+    });
+    std::printf("  %-24s %9.1f ms   (%u nodes, %zu points)\n", "read first nodes", coarse, first, read);
+
+    octree.Close();
+    std::remove(path.c_str());
+    return 0;
+}
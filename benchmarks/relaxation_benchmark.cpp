@@ -0,0 +1,79 @@
+// Dynamic relaxation throughput on a hanging cable net.
+//
+//   relaxation_benchmark [side] [steps]    (default 450, 50)
+//
+// A side x side grid of springs at 0.95 of their length, pinned along two
+// opposite borders and loaded by gravity, so it both contracts and sags.
+// Timed: the first step (which also colours the goals) and the mean of the
+// following ones, i.e. the cost of one interactive frame.
+// Build with -DALICE2_BUILD_BENCHMARKS=ON.
+
+#include "../src/coda/core/geometry/Relaxation.h"
+#include "../src/coda/core/utilities/Parallel.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+
+using namespace alice2;
+
+namespace {
+
+double Milliseconds(const std::function<void()>& work) {
+    auto start = std::chrono::steady_clock::now();
+    work();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int side = argc > 1 ? std::atoi(argv[1]) : 450;
+    int steps = argc > 2 ? std::atoi(argv[2]) : 50;
+    if (side < 2) {
+        side = 2;
+    }
+    if (steps < 1) {
+        steps = 1;
+    }
+
+    std::vector<Vec3f> positions;
+    std::vector<uint32_t> edges;
+    for (int i = 0; i < side; ++i) {
+        for (int j = 0; j < side; ++j) {
+            uint32_t v = uint32_t(i * side + j);
+            positions.push_back(Vec3f(float(i), float(j), 0.0f));
+            if (i > 0) {
+                edges.insert(edges.end(), {v - uint32_t(side), v});
+            }
+            if (j > 0) {
+                edges.insert(edges.end(), {v - 1, v});
+            }
+        }
+    }
+    Graph graph;
+    if (!graph.Create(positions, edges)) {
+        return 1;
+    }
+
+    RelaxationSettings settings;
+    settings.gravity = Vec3f(0.0f, 0.0f, -0.01f);
+    RelaxationSolver solver(settings);
+    solver.AddSprings(graph, 10.0f, 0.95f);
+    for (int j = 0; j < side; ++j) {
+        solver.AddAnchor(uint32_t(j), positions[size_t(j)]);
+        solver.AddAnchor(uint32_t((side - 1) * side + j), positions[size_t((side - 1) * side + j)]);
+    }
+    std::printf("%zu nodes, %zu goals, %zu threads\n", graph.GetVertexCount(), solver.GetGoals().size(),
+                parallel::ThreadCount());
+
+    bool ok = true;
+    double first = Milliseconds([&] { ok = solver.Step(graph); });
+    std::printf("  %-24s %9.1f ms   (%zu colours)\n", "first step", first, solver.GetColorOffsets().size() - 1);
+    double steady = Milliseconds([&] { ok = solver.Step(graph, steps) && ok; });
+    std::printf("  %-24s %9.2f ms   (residual %.3g, sag %.2f)\n", "per step", steady / steps,
+                double(solver.GetResidual()), -double(graph.GetPosition(uint32_t((side / 2) * side + side / 2)).z));
+    return ok ? 0 : 1;
+}
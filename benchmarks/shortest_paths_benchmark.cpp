@@ -0,0 +1,96 @@
+// Shortest path query throughput on a street-like grid.
+//
+//   shortest_paths_benchmark [side] [origins]    (default 1000 -> 1M vertices, 256)
+//
+// The graph is a jittered square lattice with Euclidean edge lengths. Timed:
+// preparing the weighted adjacency, one full single-source query with
+// Dijkstra and with delta-stepping, and an origin-destination batch from
+// the given number of origins to 1000 targets.
+// Build with -DALICE2_BUILD_BENCHMARKS=ON.
+
+#include "../src/coda/core/geometry/ShortestPaths.h"
+#include "../src/coda/core/utilities/Parallel.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <vector>
+
+using namespace alice2;
+
+namespace {
+
+double Milliseconds(const std::function<void()>& work) {
+    auto start = std::chrono::steady_clock::now();
+    work();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int side = argc > 1 ? std::atoi(argv[1]) : 1000;
+    int originCount = argc > 2 ? std::atoi(argv[2]) : 256;
+    if (side < 2) {
+        side = 2;
+    }
+    if (originCount < 1) {
+        originCount = 1;
+    }
+
+    std::mt19937 random(11);
+    std::uniform_real_distribution<float> jitter(-0.3f, 0.3f);
+    std::vector<Vec3f> positions;
+    std::vector<uint32_t> edges;
+    for (int i = 0; i < side; ++i) {
+        for (int j = 0; j < side; ++j) {
+            positions.push_back(Vec3f(float(i) + jitter(random), 0.0f, float(j) + jitter(random)));
+            uint32_t v = uint32_t(i * side + j);
+            if (i > 0) {
+                edges.insert(edges.end(), {v - uint32_t(side), v});
+            }
+            if (j > 0) {
+                edges.insert(edges.end(), {v - 1, v});
+            }
+        }
+    }
+    Graph graph;
+    if (!graph.Create(positions, edges)) {
+        return 1;
+    }
+    std::printf("%zu vertices, %zu edges, %zu threads\n", graph.GetVertexCount(), graph.GetEdgeCount(),
+                parallel::ThreadCount());
+
+    ShortestPathSettings settings;
+    settings.method = ShortestPathMethod::Dijkstra;
+    ShortestPaths paths(settings);
+    bool ok = true;
+    double prepare = Milliseconds([&] { ok = paths.Prepare(graph); });
+    std::printf("  %-24s %9.1f ms\n", "prepare", prepare);
+
+    std::vector<float> distances;
+    std::vector<uint32_t> predecessors;
+    const uint32_t center = uint32_t((side / 2) * side + side / 2);
+    double dijkstra = Milliseconds([&] { ok = paths.Compute(graph, center, distances, &predecessors) && ok; });
+    std::printf("  %-24s %9.1f ms\n", "dijkstra", dijkstra);
+
+    settings.method = ShortestPathMethod::DeltaStepping;
+    paths.SetSettings(settings);
+    double deltaStepping = Milliseconds([&] { ok = paths.Compute(graph, center, distances, &predecessors) && ok; });
+    std::printf("  %-24s %9.1f ms\n", "delta-stepping", deltaStepping);
+
+    std::vector<uint32_t> origins(static_cast<size_t>(originCount));
+    std::vector<uint32_t> targets(1000);
+    for (uint32_t& origin : origins) {
+        origin = uint32_t(random() % graph.GetVertexCount());
+    }
+    for (uint32_t& target : targets) {
+        target = uint32_t(random() % graph.GetVertexCount());
+    }
+    std::vector<float> matrix;
+    double batch = Milliseconds([&] { ok = paths.ComputeBatch(graph, origins, targets, matrix) && ok; });
+    std::printf("  %-24s %9.1f ms   %6.1f queries/s\n", "batch", batch, double(originCount) / (batch * 1e-3));
+    return ok ? 0 : 1;
+}
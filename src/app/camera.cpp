@@ -1,24 +1,40 @@
 #include "camera.h"
 #include "unified_application.h"
 #include "../platform/platform_interface.h"
+#include "../coda/core/utilities/Math.h"
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 
 namespace alice2 {
 
+// Column-major 4x4 multiply: result = a * b
+static void MultiplyMatrices(const float* a, const float* b, float* result) {
+    for (int col = 0; col < 4; ++col) {
+        for (int row = 0; row < 4; ++row) {
+            float sum = 0.0f;
+            for (int k = 0; k < 4; ++k) {
+                sum += a[k * 4 + row] * b[col * 4 + k];
+            }
+            result[col * 4 + row] = sum;
+        }
+    }
+}
+
 Camera::Camera() {
     UpdatePositionFromAngles();
     UpdateMatrices();
 }
 
 void Camera::Update(float deltaTime) {
-    // Update matrices if needed
+    // Rebuild cached matrices once per frame if anything changed
     UpdateMatrices();
 }
 
 void Camera::SetAspect(float aspect) {
+    if (aspect == m_Aspect) return;
     m_Aspect = aspect;
-    UpdateMatrices();
+    MarkDirty();
 }
 
 void Camera::SetPosition(const Vec3f& position) {
@@ -28,29 +44,47 @@ void Camera::SetPosition(const Vec3f& position) {
     m_Distance = toTarget.Length();
     if (m_Distance > 0.001f) {
         toTarget = toTarget.Normalize();
-        m_Pitch = std::asin(-toTarget.y);
-        m_Yaw = std::atan2(toTarget.x, toTarget.z);
+        m_Pitch = math::Asin(-toTarget.y);
+        m_Yaw = math::Atan2(toTarget.x, toTarget.z);
     }
-    UpdateMatrices();
+    MarkDirty();
 }
 
 void Camera::SetTarget(const Vec3f& target) {
     m_Target = target;
     UpdatePositionFromAngles();
-    UpdateMatrices();
+}
+
+void Camera::SetFov(float fovDegrees) {
+    m_Fov = std::max(1.0f, std::min(179.0f, fovDegrees));
+    MarkDirty();
+}
+
+void Camera::SetClipPlanes(float nearPlane, float farPlane) {
+    m_Near = std::max(1e-5f, nearPlane);
+    m_Far = std::max(m_Near * 1.001f, farPlane);
+    MarkDirty();
+}
+
+void Camera::SetReversedZ(bool reversed) {
+    m_ReversedZ = reversed;
+    MarkDirty();
+}
+
+void Camera::SetInfiniteFar(bool infinite) {
+    m_InfiniteFar = infinite;
+    MarkDirty();
 }
 
 void Camera::SetDistance(float distance) {
     m_Distance = std::max(0.1f, distance);
     UpdatePositionFromAngles();
-    UpdateMatrices();
 }
 
 void Camera::SetAngles(float yaw, float pitch) {
     m_Yaw = yaw;
     m_Pitch = std::max(-1.5f, std::min(1.5f, pitch)); // Clamp pitch to avoid gimbal lock
     UpdatePositionFromAngles();
-    UpdateMatrices();
 }
 
 void Camera::Orbit(float deltaYaw, float deltaPitch) {
@@ -58,40 +92,95 @@ void Camera::Orbit(float deltaYaw, float deltaPitch) {
     m_Pitch += deltaPitch;
     m_Pitch = std::max(-1.5f, std::min(1.5f, m_Pitch)); // Clamp pitch
     UpdatePositionFromAngles();
-    UpdateMatrices();
 }
 
 void Camera::Zoom(float deltaDistance) {
     m_Distance += deltaDistance;
     m_Distance = std::max(0.1f, std::min(100.0f, m_Distance)); // Clamp distance
     UpdatePositionFromAngles();
-    UpdateMatrices();
 }
 
 void Camera::GetViewMatrix(float* matrix) const {
-    CreateViewMatrix(matrix);
+    const Matrix4& view = GetViewMatrix();
+    std::copy(view.begin(), view.end(), matrix);
 }
 
 void Camera::GetProjectionMatrix(float* matrix) const {
-    CreateProjectionMatrix(matrix);
+    const Matrix4& projection = GetProjectionMatrix();
+    std::copy(projection.begin(), projection.end(), matrix);
+}
+
+const Camera::Matrix4& Camera::GetViewMatrix() const {
+    UpdateMatrices();
+    return m_ViewMatrix;
+}
+
+const Camera::Matrix4& Camera::GetProjectionMatrix() const {
+    UpdateMatrices();
+    return m_ProjectionMatrix;
+}
+
+const Camera::Matrix4& Camera::GetViewProjectionMatrix() const {
+    UpdateMatrices();
+    return m_ViewProjectionMatrix;
+}
+
+const Camera::Matrix4& Camera::GetInverseViewMatrix() const {
+    UpdateMatrices();
+    return m_InverseViewMatrix;
+}
+
+const Camera::Matrix4& Camera::GetInverseProjectionMatrix() const {
+    UpdateMatrices();
+    return m_InverseProjectionMatrix;
+}
+
+const Camera::Matrix4& Camera::GetInverseViewProjectionMatrix() const {
+    UpdateMatrices();
+    return m_InverseViewProjectionMatrix;
+}
+
+const std::array<Plane, 6>& Camera::GetFrustumPlanes() const {
+    UpdateMatrices();
+    return m_FrustumPlanes;
+}
+
+bool Camera::IsSphereVisible(const Vec3f& center, float radius) const {
+    for (const Plane& plane : GetFrustumPlanes()) {
+        if (plane.Distance(center) < -radius) {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint64_t Camera::GetVersion() const {
+    UpdateMatrices();
+    return m_Version;
 }
 
 void Camera::ProcessInput(platform::IPlatform* platform, float deltaTime) {
     if (!platform) return;
 
+    // Accumulate all changes for this frame and rebuild the position once at the end
+    bool changed = false;
+
     // Mouse input for orbital camera
     auto [mouseX, mouseY] = platform->GetMousePosition();
     bool mousePressed = platform->IsMouseButtonPressed(0); // Left mouse button
 
     if (mousePressed) {
-        if (m_MousePressed) {
+        if (m_MousePressed && (mouseX != m_LastMouseX || mouseY != m_LastMouseY)) {
             // Calculate mouse delta
             double deltaX = mouseX - m_LastMouseX;
             double deltaY = mouseY - m_LastMouseY;
 
             // Apply rotation
             float rotateSpeed = m_RotateSpeed * deltaTime;
-            Orbit(static_cast<float>(-deltaX * rotateSpeed), static_cast<float>(-deltaY * rotateSpeed));
+            m_Yaw += static_cast<float>(-deltaX * rotateSpeed);
+            m_Pitch += static_cast<float>(-deltaY * rotateSpeed);
+            m_Pitch = std::max(-1.5f, std::min(1.5f, m_Pitch)); // Clamp pitch
+            changed = true;
         }
         m_MousePressed = true;
     } else {
@@ -109,54 +198,59 @@ void Camera::ProcessInput(platform::IPlatform* platform, float deltaTime) {
     Vec3f forward = (m_Target - m_Position).Normalize();
     Vec3f right = forward.Cross(m_Up).Normalize();
     Vec3f up = m_Up;
-
-    if (platform->IsKeyPressed(87)) { // W key - move target forward
-        m_Target += forward * moveSpeed;
-        UpdatePositionFromAngles();
-    }
-    if (platform->IsKeyPressed(83)) { // S key - move target backward
-        m_Target -= forward * moveSpeed;
-        UpdatePositionFromAngles();
-    }
-    if (platform->IsKeyPressed(65)) { // A key - move target left
-        m_Target -= right * moveSpeed;
-        UpdatePositionFromAngles();
-    }
-    if (platform->IsKeyPressed(68)) { // D key - move target right
-        m_Target += right * moveSpeed;
-        UpdatePositionFromAngles();
+    Vec3f move;
+
+    if (platform->IsKeyPressed(87)) move += forward; // W key - move target forward
+    if (platform->IsKeyPressed(83)) move -= forward; // S key - move target backward
+    if (platform->IsKeyPressed(65)) move -= right;   // A key - move target left
+    if (platform->IsKeyPressed(68)) move += right;   // D key - move target right
+    if (platform->IsKeyPressed(81)) move += up;      // Q key - move target up
+    if (platform->IsKeyPressed(69)) move -= up;      // E key - move target down
+
+    if (!(move == Vec3f())) {
+        m_Target += move * moveSpeed;
+        changed = true;
     }
-    if (platform->IsKeyPressed(81)) { // Q key - move target up
-        m_Target += up * moveSpeed;
-        UpdatePositionFromAngles();
+
+    // Mouse wheel or +/- keys for zoom
+    float zoom = 0.0f;
+    if (platform->IsKeyPressed(187)) zoom -= zoomSpeed; // + key
+    if (platform->IsKeyPressed(189)) zoom += zoomSpeed; // - key
+
+    if (zoom != 0.0f) {
+        m_Distance = std::max(0.1f, std::min(100.0f, m_Distance + zoom)); // Clamp distance
+        changed = true;
     }
-    if (platform->IsKeyPressed(69)) { // E key - move target down
-        m_Target -= up * moveSpeed;
+
+    if (changed) {
         UpdatePositionFromAngles();
     }
+}
 
-    // Mouse wheel or +/- keys for zoom
-    if (platform->IsKeyPressed(187)) { // + key
-        Zoom(-zoomSpeed);
-    }
-    if (platform->IsKeyPressed(189)) { // - key
-        Zoom(zoomSpeed);
+void Camera::UpdateMatrices() const {
+    if (!m_Dirty) {
+        return;
     }
 
-    UpdateMatrices();
-}
+    CreateViewMatrix(m_ViewMatrix.data());
+    CreateProjectionMatrix(m_ProjectionMatrix.data());
+    CreateInverseViewMatrix(m_InverseViewMatrix.data());
+    CreateInverseProjectionMatrix(m_InverseProjectionMatrix.data());
+
+    MultiplyMatrices(m_ProjectionMatrix.data(), m_ViewMatrix.data(), m_ViewProjectionMatrix.data());
+    MultiplyMatrices(m_InverseViewMatrix.data(), m_InverseProjectionMatrix.data(), m_InverseViewProjectionMatrix.data());
 
-void Camera::UpdateMatrices() {
-    // This will be called whenever camera parameters change
-    // Matrices are calculated on-demand in Get methods
+    ExtractFrustumPlanes();
+
+    m_Dirty = false;
+    ++m_Version;
 }
 
 void Camera::UpdatePositionFromAngles() {
     // Calculate position from spherical coordinates
-    float cosYaw = std::cos(m_Yaw);
-    float sinYaw = std::sin(m_Yaw);
-    float cosPitch = std::cos(m_Pitch);
-    float sinPitch = std::sin(m_Pitch);
+    float cosYaw, sinYaw, cosPitch, sinPitch;
+    math::SinCos(m_Yaw, sinYaw, cosYaw);
+    math::SinCos(m_Pitch, sinPitch, cosPitch);
 
     // Position relative to target
     Vec3f offset;
@@ -165,6 +259,7 @@ void Camera::UpdatePositionFromAngles() {
     offset.z = m_Distance * cosPitch * cosYaw;
 
     m_Position = m_Target + offset;
+    MarkDirty();
 }
 
 void Camera::CreateViewMatrix(float* matrix) const {
@@ -191,7 +286,7 @@ void Camera::CreateViewMatrix(float* matrix) const {
 }
 
 void Camera::CreateProjectionMatrix(float* matrix) const {
-    // Create perspective projection matrix
+    // Create perspective projection matrix with depth in [0,1] (WebGPU clip space)
     float fovRad = m_Fov * (3.14159265359f / 180.0f);
     float tanHalfFov = std::tan(fovRad * 0.5f);
 
@@ -202,9 +297,86 @@ void Camera::CreateProjectionMatrix(float* matrix) const {
 
     matrix[0] = 1.0f / (m_Aspect * tanHalfFov);
     matrix[5] = 1.0f / tanHalfFov;
-    matrix[10] = -(m_Far + m_Near) / (m_Far - m_Near);
     matrix[11] = -1.0f;
-    matrix[14] = -(2.0f * m_Far * m_Near) / (m_Far - m_Near);
+
+    if (m_ReversedZ) {
+        if (m_InfiniteFar) {
+            // depth = near / -z_view: 1 at the near plane, approaching 0 at infinity
+            matrix[10] = 0.0f;
+            matrix[14] = m_Near;
+        } else {
+            matrix[10] = m_Near / (m_Far - m_Near);
+            matrix[14] = (m_Far * m_Near) / (m_Far - m_Near);
+        }
+    } else {
+        if (m_InfiniteFar) {
+            matrix[10] = -1.0f;
+            matrix[14] = -m_Near;
+        } else {
+            matrix[10] = m_Far / (m_Near - m_Far);
+            matrix[14] = (m_Far * m_Near) / (m_Near - m_Far);
+        }
+    }
+}
+
+void Camera::CreateInverseViewMatrix(float* matrix) const {
+    // The view matrix is rigid, so its inverse is the transposed rotation plus the eye position
+    Vec3f forward = (m_Target - m_Position).Normalize();
+    Vec3f right = forward.Cross(m_Up).Normalize();
+    Vec3f up = right.Cross(forward).Normalize();
+
+    matrix[0] = right.x;    matrix[4] = up.x;    matrix[8] = -forward.x;  matrix[12] = m_Position.x;
+    matrix[1] = right.y;    matrix[5] = up.y;    matrix[9] = -forward.y;  matrix[13] = m_Position.y;
+    matrix[2] = right.z;    matrix[6] = up.z;    matrix[10] = -forward.z; matrix[14] = m_Position.z;
+    matrix[3] = 0.0f;       matrix[7] = 0.0f;    matrix[11] = 0.0f;       matrix[15] = 1.0f;
+}
+
+void Camera::CreateInverseProjectionMatrix(float* matrix) const {
+    // Closed-form inverse of a perspective matrix with entries (0, 5, 10, 11, 14)
+    const Matrix4& p = m_ProjectionMatrix;
+
+    for (int i = 0; i < 16; ++i) {
+        matrix[i] = 0.0f;
+    }
+
+    matrix[0] = 1.0f / p[0];
+    matrix[5] = 1.0f / p[5];
+    matrix[11] = 1.0f / p[14];
+    matrix[14] = 1.0f / p[11];
+    matrix[15] = -p[10] / (p[14] * p[11]);
+}
+
+void Camera::ExtractFrustumPlanes() const {
+    // Gribb/Hartmann plane extraction from the combined view-projection matrix
+    const Matrix4& m = m_ViewProjectionMatrix;
+    auto row = [&m](int i) { return std::array<float, 4>{m[i], m[4 + i], m[8 + i], m[12 + i]}; };
+    auto r0 = row(0), r1 = row(1), r2 = row(2), r3 = row(3);
+
+    auto makePlane = [](const std::array<float, 4>& a, const std::array<float, 4>& b, float sign) {
+        Plane plane;
+        plane.normal = Vec3f(a[0] + sign * b[0], a[1] + sign * b[1], a[2] + sign * b[2]);
+        plane.d = a[3] + sign * b[3];
+        float length = plane.normal.Length();
+        if (length > 0.0f) {
+            plane.normal /= length;
+            plane.d /= length;
+        }
+        return plane;
+    };
+
+    m_FrustumPlanes[FRUSTUM_LEFT] = makePlane(r3, r0, 1.0f);
+    m_FrustumPlanes[FRUSTUM_RIGHT] = makePlane(r3, r0, -1.0f);
+    m_FrustumPlanes[FRUSTUM_BOTTOM] = makePlane(r3, r1, 1.0f);
+    m_FrustumPlanes[FRUSTUM_TOP] = makePlane(r3, r1, -1.0f);
+
+    // Depth clips to 0 <= z <= w; reversed-Z swaps which side is near. With an
+    // infinite far plane the far equation degenerates to a constant positive
+    // distance, which never rejects anything.
+    std::array<float, 4> zero{0.0f, 0.0f, 0.0f, 0.0f};
+    Plane zMin = makePlane(zero, r2, 1.0f);
+    Plane zMax = makePlane(r3, r2, -1.0f);
+    m_FrustumPlanes[FRUSTUM_NEAR] = m_ReversedZ ? zMax : zMin;
+    m_FrustumPlanes[FRUSTUM_FAR] = m_ReversedZ ? zMin : zMax;
 }
 
 } // namespace alice2
\ No newline at end of file
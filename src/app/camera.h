@@ -1,13 +1,27 @@
 #pragma once
 #include "../core/base/Types.h"
+#include <array>
+#include <cstdint>
 
 namespace alice2 {
 
 // Forward declarations
 namespace platform { class IPlatform; }
 
+// Plane in the form dot(normal, p) + d = 0, normal pointing into the frustum
+struct Plane {
+    Vec3f normal;
+    float d = 0.0f;
+
+    float Distance(const Vec3f& p) const { return normal.Dot(p) + d; }
+};
+
+enum FrustumPlane { FRUSTUM_LEFT = 0, FRUSTUM_RIGHT, FRUSTUM_BOTTOM, FRUSTUM_TOP, FRUSTUM_NEAR, FRUSTUM_FAR };
+
 class Camera {
 public:
+    using Matrix4 = std::array<float, 16>; // Column-major
+
     Camera();
     ~Camera() = default;
 
@@ -16,10 +30,34 @@ public:
     void SetPosition(const Vec3f& position);
     void SetTarget(const Vec3f& target);
 
+    // Projection settings. Depth is always mapped to WebGPU's [0,1] clip range;
+    // reversed-Z maps near to 1 and far to 0 and pairs with a Greater depth test.
+    void SetFov(float fovDegrees);
+    void SetClipPlanes(float nearPlane, float farPlane);
+    void SetReversedZ(bool reversed);
+    void SetInfiniteFar(bool infinite);
+    bool IsReversedZ() const { return m_ReversedZ; }
+    bool IsInfiniteFar() const { return m_InfiniteFar; }
+
     // Matrix access
     void GetViewMatrix(float* matrix) const;
     void GetProjectionMatrix(float* matrix) const;
 
+    // Cached matrices, rebuilt lazily when the camera is dirty
+    const Matrix4& GetViewMatrix() const;
+    const Matrix4& GetProjectionMatrix() const;
+    const Matrix4& GetViewProjectionMatrix() const;
+    const Matrix4& GetInverseViewMatrix() const;
+    const Matrix4& GetInverseProjectionMatrix() const;
+    const Matrix4& GetInverseViewProjectionMatrix() const;
+    const std::array<Plane, 6>& GetFrustumPlanes() const;
+
+    bool IsSphereVisible(const Vec3f& center, float radius) const;
+
+    // Incremented every time the cached matrices change; compare against a
+    // stored value to skip uniform uploads when the camera hasn't moved
+    uint64_t GetVersion() const;
+
     // Camera controls
     void ProcessInput(platform::IPlatform* platform, float deltaTime);
 
@@ -48,6 +86,8 @@ private:
     float m_Aspect = 16.0f / 9.0f;
     float m_Near = 0.1f;
     float m_Far = 100.0f;
+    bool m_ReversedZ = true;   // Near plane at depth 1, far at depth 0
+    bool m_InfiniteFar = true; // Ignore m_Far and push the far plane to infinity
 
     // Camera movement
     float m_MoveSpeed = 5.0f;
@@ -59,10 +99,25 @@ private:
     double m_LastMouseX = 0.0;
     double m_LastMouseY = 0.0;
 
-    void UpdateMatrices();
+    // Cached matrices and frustum
+    mutable bool m_Dirty = true;
+    mutable uint64_t m_Version = 0;
+    mutable Matrix4 m_ViewMatrix{};
+    mutable Matrix4 m_ProjectionMatrix{};
+    mutable Matrix4 m_ViewProjectionMatrix{};
+    mutable Matrix4 m_InverseViewMatrix{};
+    mutable Matrix4 m_InverseProjectionMatrix{};
+    mutable Matrix4 m_InverseViewProjectionMatrix{};
+    mutable std::array<Plane, 6> m_FrustumPlanes{};
+
+    void MarkDirty() { m_Dirty = true; }
+    void UpdateMatrices() const;
     void UpdatePositionFromAngles();
     void CreateViewMatrix(float* matrix) const;
     void CreateProjectionMatrix(float* matrix) const;
+    void CreateInverseViewMatrix(float* matrix) const;
+    void CreateInverseProjectionMatrix(float* matrix) const;
+    void ExtractFrustumPlanes() const;
 };
 
-} // namespace alice2
\ No newline at end of file
+} // namespace alice2
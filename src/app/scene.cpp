@@ -1,6 +1,7 @@
 #include "scene.h"
 #include "camera.h"
 #include "../renderer/unified_renderer.h"
+#include "../coda/core/utilities/Math.h"
 #include <iostream>
 #include <cmath>
 
@@ -41,13 +42,25 @@ void Scene::Update(float deltaTime) {
 
         // Animate some test points
         if (!m_TestPoints.empty() && m_TestPoints.size() > 4) {
-            // Animate the extra points in a circle
-            for (size_t i = 4; i < m_TestPoints.size(); ++i) {
-                float angle = time + (i - 4) * 0.5f;
-                float radius = 2.0f;
-                m_TestPoints[i].x = radius * std::cos(angle);
-                m_TestPoints[i].z = radius * std::sin(angle);
-                m_TestPoints[i].y = std::sin(time * 2.0f + i) * 0.5f;
+            // Animate the extra points in a circle; phases for the orbit angle and
+            // the bobbing height go through one batched sincos call
+            size_t count = m_TestPoints.size() - 4;
+            m_AnimPhases.resize(count * 2);
+            m_AnimSin.resize(count * 2);
+            m_AnimCos.resize(count * 2);
+
+            for (size_t i = 0; i < count; ++i) {
+                m_AnimPhases[i] = time + i * 0.5f;
+                m_AnimPhases[count + i] = time * 2.0f + (i + 4);
+            }
+            math::SinCos(m_AnimPhases.data(), m_AnimSin.data(), m_AnimCos.data(), count * 2, math::Precision::Fast);
+
+            float radius = 2.0f;
+            for (size_t i = 0; i < count; ++i) {
+                Vec3f& point = m_TestPoints[i + 4];
+                point.x = radius * m_AnimCos[i];
+                point.z = radius * m_AnimSin[i];
+                point.y = m_AnimSin[count + i] * 0.5f;
             }
         }
     }
@@ -58,20 +71,14 @@ void Scene::Render(UnifiedRenderer* renderer) {
         return;
     }
 
-    // DEBUGGING: Test with identity matrices to render directly in NDC space
-    float identityMatrix[16] = {
-        1.0f, 0.0f, 0.0f, 0.0f,
-        0.0f, 1.0f, 0.0f, 0.0f,
-        0.0f, 0.0f, 1.0f, 0.0f,
-        0.0f, 0.0f, 0.0f, 1.0f
-    };
-
-    renderer->SetViewMatrix(identityMatrix);
-    renderer->SetProjectionMatrix(identityMatrix);
-
-    // Simple NDC test - render basic geometry directly in normalized device coordinates
+    // Upload the camera only when it changed since the last frame
+    if (m_Camera && m_Camera->GetVersion() != m_CameraVersion) {
+        renderer->SetReversedZ(m_Camera->IsReversedZ());
+        renderer->SetViewProjectionMatrix(m_Camera->GetViewProjectionMatrix().data());
+        m_CameraVersion = m_Camera->GetVersion();
+    }
 
-    // Render a simple triangle directly in NDC space (-1 to 1 range)
+    // Render a simple triangle around the origin
     renderer->BeginTriangles();
     Vec3f p0(-0.8f, -0.8f, 0.0f);  // Bottom left
     Vec3f p1(0.8f, -0.8f, 0.0f);   // Bottom right
@@ -80,7 +87,7 @@ void Scene::Render(UnifiedRenderer* renderer) {
     renderer->AddTriangle(p0, p1, p2, triangleColor);
     renderer->EndTriangles();
 
-    // Render a simple line directly in NDC space
+    // Render a simple line along the X axis
     renderer->BeginLines();
     Vec3f lineStart(-0.9f, 0.0f, 0.0f);
     Vec3f lineEnd(0.9f, 0.0f, 0.0f);
@@ -91,6 +98,7 @@ void Scene::Render(UnifiedRenderer* renderer) {
 
 void Scene::Cleanup() {
     m_Camera.reset();
+    m_CameraVersion = 0;
     m_TestPoints.clear();
     m_TestLines.clear();
     m_IsInitialized = false;
@@ -2,6 +2,7 @@
 
 #include <memory>
 #include <vector>
+#include <cstdint>
 #include "../core/base/Types.h"
 
 namespace alice2 {
@@ -32,12 +33,18 @@ public:
 
 private:
     std::unique_ptr<Camera> m_Camera;
+    uint64_t m_CameraVersion = 0; // Last camera version uploaded to the renderer
     bool m_IsInitialized = false;
 
     // Test geometry data
     std::vector<Vec3f> m_TestPoints;
     std::vector<std::pair<Vec3f, Vec3f>> m_TestLines;
 
+    // Scratch buffers for batched animation (reused across frames)
+    std::vector<float> m_AnimPhases;
+    std::vector<float> m_AnimSin;
+    std::vector<float> m_AnimCos;
+
     void CreateTestData();
 };
 
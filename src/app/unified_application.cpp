@@ -121,12 +121,12 @@ void UnifiedApplication::OnEvent(const platform::Event& event) {
 
 void UnifiedApplication::OnUpdate(float deltaTime) {
     if (m_Scene) {
-        m_Scene->Update(deltaTime);
-
-        // Process camera input
+        // Process camera input before the scene update so matrices are rebuilt once per frame
         if (m_Scene->GetCamera()) {
             m_Scene->GetCamera()->ProcessInput(m_Platform.get(), deltaTime);
         }
+
+        m_Scene->Update(deltaTime);
     }
 }
 
@@ -0,0 +1,46 @@
+#include "EditLog.h"
+
+#include <algorithm>
+
+namespace alice2 {
+
+void EditLog::MarkVertex(uint32_t vertex, size_t vertexCount) {
+    if (m_LastLogged.size() != vertexCount) {
+        m_LastLogged.assign(vertexCount, 0);
+    }
+
+    // Already logged beyond every reader's position: they will all see it
+    uint64_t logged = m_LastLogged[vertex];
+    if (logged != 0 && logged - 1 >= m_ReadMark) {
+        return;
+    }
+
+    // Past a quarter of the vertex count a full update is cheaper than the log
+    if (m_Vertices.size() >= std::max<size_t>(1024, vertexCount / 4)) {
+        MarkAll();
+        return;
+    }
+
+    m_LastLogged[vertex] = GetCursor() + 1;
+    m_Vertices.push_back(vertex);
+}
+
+void EditLog::MarkAll() {
+    m_Base += m_Vertices.size() + 1;
+    m_Vertices.clear();
+    m_FullMark = m_Base;
+    m_ReadMark = m_Base;
+    std::fill(m_LastLogged.begin(), m_LastLogged.end(), 0);
+}
+
+bool EditLog::GetEditsSince(uint64_t cursor, std::vector<uint32_t>& vertices) const {
+    vertices.clear();
+    m_ReadMark = std::max(m_ReadMark, GetCursor());
+    if (cursor < m_FullMark) {
+        return false;
+    }
+    vertices.assign(m_Vertices.begin() + static_cast<ptrdiff_t>(cursor - m_Base), m_Vertices.end());
+    return true;
+}
+
+} // namespace alice2
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace alice2 {
+
+// Log of moved vertices behind the Mesh and Graph edit APIs. A vertex is
+// appended at most once per reader pass; each consumer (normals, spatial
+// indices, GPU upload) keeps its own cursor into the log, an absolute
+// position that survives compaction. Not thread-safe: mark from one thread.
+class EditLog {
+public:
+    // vertexCount is the owner's current vertex count; past a quarter of it
+    // a full update is cheaper than the log, which then turns into MarkAll()
+    void MarkVertex(uint32_t vertex, size_t vertexCount);
+    void MarkAll();
+    uint64_t GetCursor() const { return m_Base + m_Vertices.size(); }
+    // Vertices moved since cursor (may repeat). Returns false when the caller
+    // must treat every vertex as dirty (MarkAll, or the log was compacted
+    // past the cursor).
+    bool GetEditsSince(uint64_t cursor, std::vector<uint32_t>& vertices) const;
+
+private:
+    std::vector<uint32_t> m_Vertices;
+    std::vector<uint64_t> m_LastLogged; // Absolute log position + 1, 0 = never
+    uint64_t m_Base = 0;                // Absolute position of m_Vertices[0]
+    uint64_t m_FullMark = 0;            // Cursors below this see a full edit
+    mutable uint64_t m_ReadMark = 0;    // Furthest position any reader reached
+};
+
+} // namespace alice2
@@ -0,0 +1,348 @@
+#include "Graph.h"
+#include "../utilities/Parallel.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace alice2 {
+
+namespace {
+
+// Orders every vertex's slots by (neighbour, edge), for binary searches and
+// a layout that does not depend on insertion order
+void SortSlots(const std::vector<uint32_t>& offsets, std::vector<uint32_t>& neighbors,
+               std::vector<uint32_t>& slotEdges) {
+    size_t vertexCount = offsets.empty() ? 0 : offsets.size() - 1;
+    parallel::For(vertexCount, 4096, [&](size_t begin, size_t end) {
+        std::vector<uint64_t> keys;
+        for (size_t v = begin; v < end; ++v) {
+            uint32_t first = offsets[v], last = offsets[v + 1];
+            if (last - first <= 32) {
+                for (uint32_t i = first + 1; i < last; ++i) {
+                    uint32_t neighbor = neighbors[i], edge = slotEdges[i];
+                    uint32_t j = i;
+                    for (; j > first && (neighbors[j - 1] > neighbor
+                                         || (neighbors[j - 1] == neighbor && slotEdges[j - 1] > edge)); --j) {
+                        neighbors[j] = neighbors[j - 1];
+                        slotEdges[j] = slotEdges[j - 1];
+                    }
+                    neighbors[j] = neighbor;
+                    slotEdges[j] = edge;
+                }
+                continue;
+            }
+            keys.resize(last - first);
+            for (uint32_t i = first; i < last; ++i) {
+                keys[i - first] = (uint64_t(neighbors[i]) << 32) | slotEdges[i];
+            }
+            std::sort(keys.begin(), keys.end());
+            for (uint32_t i = first; i < last; ++i) {
+                neighbors[i] = static_cast<uint32_t>(keys[i - first] >> 32);
+                slotEdges[i] = static_cast<uint32_t>(keys[i - first]);
+            }
+        }
+    });
+}
+
+} // namespace
+
+bool Graph::Create(const std::vector<Vec3f>& positions, const std::vector<uint32_t>& edgeVertices, bool directed) {
+    Clear();
+
+    if (edgeVertices.size() % 2 != 0) {
+        std::cerr << "Graph::Create: edge vertex count is not a multiple of 2" << std::endl;
+        return false;
+    }
+    if (edgeVertices.size() >= INVALID_INDEX / 2) {
+        std::cerr << "Graph::Create: too many edges for 32-bit slot indices" << std::endl;
+        return false;
+    }
+
+    const size_t vertexCount = positions.size();
+    const size_t edgeCount = edgeVertices.size() / 2;
+
+    // Two-level counting sort on the vertex, without atomics. Slots are first
+    // partitioned into buckets of consecutive vertices (per-chunk bucket
+    // histograms, as in the radix sort); a bucket's slots then occupy exactly
+    // its final CSR range, so each bucket counts and scatters its own
+    // vertices locally, in cache and in parallel with the others.
+    const size_t slotCount = directed ? edgeCount : 2 * edgeCount;
+    int shift = 0;
+    while ((vertexCount >> shift) > 1024) {
+        ++shift;
+    }
+    const size_t bucketCount = vertexCount == 0 ? 0 : ((vertexCount - 1) >> shift) + 1;
+    const size_t chunkCount = parallel::ChunkCount(edgeCount, 16384);
+    const size_t chunkSize = chunkCount ? (edgeCount + chunkCount - 1) / chunkCount : 0;
+
+    std::vector<uint32_t> histograms(chunkCount * bucketCount, 0);
+    std::vector<uint8_t> invalidEdges(edgeCount, 0);
+    parallel::ForChunks(chunkCount, [&](size_t chunk) {
+        uint32_t* histogram = &histograms[chunk * bucketCount];
+        size_t end = std::min(edgeCount, (chunk + 1) * chunkSize);
+        for (size_t e = chunk * chunkSize; e < end; ++e) {
+            uint32_t from = edgeVertices[2 * e], to = edgeVertices[2 * e + 1];
+            if (from >= vertexCount || to >= vertexCount) {
+                invalidEdges[e] = 1;
+                continue;
+            }
+            ++histogram[from >> shift];
+            if (!directed) {
+                ++histogram[to >> shift];
+            }
+        }
+    });
+    for (size_t e = 0; e < edgeCount; ++e) {
+        if (invalidEdges[e]) {
+            std::cerr << "Graph::Create: edge " << e << " has an out-of-range vertex" << std::endl;
+            return false;
+        }
+    }
+
+    // Exclusive prefix over (bucket, chunk) gives each chunk its scatter offsets
+    std::vector<uint32_t> bucketOffsets(bucketCount + 1, 0);
+    uint32_t offset = 0;
+    for (size_t bucket = 0; bucket < bucketCount; ++bucket) {
+        bucketOffsets[bucket] = offset;
+        for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+            uint32_t& slot = histograms[chunk * bucketCount + bucket];
+            uint32_t count = slot;
+            slot = offset;
+            offset += count;
+        }
+    }
+    bucketOffsets[bucketCount] = offset;
+
+    std::vector<uint64_t> partitionKeys(slotCount); // vertex << 32 | neighbour
+    std::vector<uint32_t> partitionEdges(slotCount);
+    parallel::ForChunks(chunkCount, [&](size_t chunk) {
+        uint32_t* cursor = &histograms[chunk * bucketCount];
+        size_t end = std::min(edgeCount, (chunk + 1) * chunkSize);
+        for (size_t e = chunk * chunkSize; e < end; ++e) {
+            uint64_t from = edgeVertices[2 * e], to = edgeVertices[2 * e + 1];
+            uint32_t slot = cursor[from >> shift]++;
+            partitionKeys[slot] = (from << 32) | to;
+            partitionEdges[slot] = static_cast<uint32_t>(e);
+            if (!directed) {
+                slot = cursor[to >> shift]++;
+                partitionKeys[slot] = (to << 32) | from;
+                partitionEdges[slot] = static_cast<uint32_t>(e);
+            }
+        }
+    });
+    histograms = std::vector<uint32_t>();
+
+    std::vector<uint32_t> offsets(vertexCount + 1);
+    offsets[vertexCount] = static_cast<uint32_t>(slotCount);
+    m_Neighbors.resize(slotCount);
+    m_SlotEdges.resize(slotCount);
+    parallel::ForChunks(bucketCount, [&](size_t bucket) {
+        size_t firstVertex = bucket << shift;
+        size_t lastVertex = std::min(vertexCount, (bucket + 1) << shift);
+        uint32_t first = bucketOffsets[bucket], last = bucketOffsets[bucket + 1];
+        std::vector<uint32_t> cursors(lastVertex - firstVertex + 1, 0);
+        for (uint32_t i = first; i < last; ++i) {
+            ++cursors[(partitionKeys[i] >> 32) - firstVertex + 1];
+        }
+        cursors[0] = first;
+        for (size_t v = firstVertex; v < lastVertex; ++v) {
+            cursors[v - firstVertex + 1] += cursors[v - firstVertex];
+            offsets[v] = cursors[v - firstVertex];
+        }
+        for (uint32_t i = first; i < last; ++i) {
+            uint32_t slot = cursors[(partitionKeys[i] >> 32) - firstVertex]++;
+            m_Neighbors[slot] = static_cast<uint32_t>(partitionKeys[i]);
+            m_SlotEdges[slot] = partitionEdges[i];
+        }
+    });
+
+    m_Offsets = std::move(offsets);
+    SortSlots(m_Offsets, m_Neighbors, m_SlotEdges);
+
+    m_Positions = positions;
+    m_EdgeVertices = edgeVertices;
+    m_Directed = directed;
+    m_VertexAttributes.Resize(vertexCount);
+    m_EdgeAttributes.Resize(edgeCount);
+    ++m_TopologyVersion;
+    MarkAllDirty();
+    return true;
+}
+
+void Graph::Clear() {
+    m_Positions.clear();
+    m_EdgeVertices.clear();
+    m_Offsets.clear();
+    m_Neighbors.clear();
+    m_SlotEdges.clear();
+    m_PendingNeighbors.clear();
+    m_PendingEdges.clear();
+    m_PendingNext.clear();
+    m_PendingHead.clear();
+    m_PendingCount.clear();
+    m_VertexAttributes.Resize(0);
+    m_EdgeAttributes.Resize(0);
+    ++m_TopologyVersion;
+    MarkAllDirty();
+}
+
+uint32_t Graph::AddVertex(const Vec3f& position) {
+    uint32_t vertex = static_cast<uint32_t>(m_Positions.size());
+    m_Positions.push_back(position);
+    m_VertexAttributes.Resize(m_Positions.size());
+    ++m_TopologyVersion;
+    return vertex;
+}
+
+uint32_t Graph::AddEdge(uint32_t from, uint32_t to) {
+    if (from >= m_Positions.size() || to >= m_Positions.size()) {
+        std::cerr << "Graph::AddEdge: vertex out of range" << std::endl;
+        return INVALID_INDEX;
+    }
+    uint32_t edge = static_cast<uint32_t>(GetEdgeCount());
+    m_EdgeVertices.push_back(from);
+    m_EdgeVertices.push_back(to);
+    m_EdgeAttributes.Resize(GetEdgeCount());
+
+    InsertPending(from, to, edge);
+    if (!m_Directed) {
+        InsertPending(to, from, edge);
+    }
+    CompactIfFull();
+    ++m_TopologyVersion;
+    return edge;
+}
+
+bool Graph::AddEdges(const std::vector<uint32_t>& edgeVertices) {
+    if (edgeVertices.size() % 2 != 0) {
+        std::cerr << "Graph::AddEdges: edge vertex count is not a multiple of 2" << std::endl;
+        return false;
+    }
+    for (uint32_t vertex : edgeVertices) {
+        if (vertex >= m_Positions.size()) {
+            std::cerr << "Graph::AddEdges: vertex " << vertex << " out of range" << std::endl;
+            return false;
+        }
+    }
+    if (edgeVertices.empty()) {
+        return true;
+    }
+
+    uint32_t edge = static_cast<uint32_t>(GetEdgeCount());
+    for (size_t i = 0; i < edgeVertices.size(); i += 2, ++edge) {
+        InsertPending(edgeVertices[i], edgeVertices[i + 1], edge);
+        if (!m_Directed) {
+            InsertPending(edgeVertices[i + 1], edgeVertices[i], edge);
+        }
+    }
+    m_EdgeVertices.insert(m_EdgeVertices.end(), edgeVertices.begin(), edgeVertices.end());
+    m_EdgeAttributes.Resize(GetEdgeCount());
+    CompactIfFull();
+    ++m_TopologyVersion;
+    return true;
+}
+
+void Graph::InsertPending(uint32_t vertex, uint32_t neighbor, uint32_t edge) {
+    if (m_PendingHead.size() < m_Positions.size()) {
+        m_PendingHead.resize(m_Positions.size(), INVALID_INDEX);
+        m_PendingCount.resize(m_Positions.size(), 0);
+    }
+    uint32_t slot = static_cast<uint32_t>(m_PendingNeighbors.size());
+    m_PendingNeighbors.push_back(neighbor);
+    m_PendingEdges.push_back(edge);
+    m_PendingNext.push_back(m_PendingHead[vertex]);
+    m_PendingHead[vertex] = slot;
+    ++m_PendingCount[vertex];
+}
+
+void Graph::CompactIfFull() {
+    // Compaction rewrites every slot, so letting the buffer grow with the
+    // graph keeps its amortised cost at a few slot copies per insertion
+    if (m_PendingNeighbors.size() > std::max<size_t>(4096, m_Neighbors.size() / 8)) {
+        Compact();
+    }
+}
+
+void Graph::Compact() {
+    if (IsCompact()) {
+        return;
+    }
+
+    const size_t vertexCount = m_Positions.size();
+    const size_t baseVertices = m_Offsets.empty() ? 0 : m_Offsets.size() - 1;
+    auto baseDegree = [&](size_t v) { return v < baseVertices ? m_Offsets[v + 1] - m_Offsets[v] : 0u; };
+    auto pendingDegree = [&](size_t v) { return v < m_PendingCount.size() ? m_PendingCount[v] : 0u; };
+
+    std::vector<uint32_t> offsets(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        offsets[v + 1] = offsets[v] + baseDegree(v) + pendingDegree(v);
+    }
+
+    std::vector<uint32_t> neighbors(offsets[vertexCount]);
+    std::vector<uint32_t> slotEdges(offsets[vertexCount]);
+    parallel::For(vertexCount, 4096, [&](size_t begin, size_t end) {
+        for (size_t v = begin; v < end; ++v) {
+            uint32_t out = offsets[v];
+            for (uint32_t i = 0, first = v < baseVertices ? m_Offsets[v] : 0; i < baseDegree(v); ++i, ++out) {
+                neighbors[out] = m_Neighbors[first + i];
+                slotEdges[out] = m_SlotEdges[first + i];
+            }
+            for (uint32_t slot = pendingDegree(v) ? m_PendingHead[v] : INVALID_INDEX; slot != INVALID_INDEX;
+                 slot = m_PendingNext[slot], ++out) {
+                neighbors[out] = m_PendingNeighbors[slot];
+                slotEdges[out] = m_PendingEdges[slot];
+            }
+        }
+    });
+    SortSlots(offsets, neighbors, slotEdges);
+
+    m_Offsets = std::move(offsets);
+    m_Neighbors = std::move(neighbors);
+    m_SlotEdges = std::move(slotEdges);
+    m_PendingNeighbors.clear();
+    m_PendingEdges.clear();
+    m_PendingNext.clear();
+    m_PendingHead.clear();
+    m_PendingCount.clear();
+}
+
+Graph::Adjacency Graph::GetAdjacency(uint32_t vertex) const {
+    Adjacency adjacency = {0, 0, INVALID_INDEX, 0};
+    if (size_t(vertex) + 1 < m_Offsets.size()) {
+        adjacency.begin = m_Offsets[vertex];
+        adjacency.end = m_Offsets[vertex + 1];
+    }
+    if (vertex < m_PendingHead.size()) {
+        adjacency.pendingHead = m_PendingHead[vertex];
+        adjacency.pendingCount = m_PendingCount[vertex];
+    }
+    return adjacency;
+}
+
+uint32_t Graph::FindEdge(uint32_t from, uint32_t to) const {
+    if (from >= m_Positions.size() || to >= m_Positions.size()) {
+        return INVALID_INDEX;
+    }
+    Adjacency adjacency = GetAdjacency(from);
+    auto begin = m_Neighbors.begin() + adjacency.begin, end = m_Neighbors.begin() + adjacency.end;
+    auto slot = std::lower_bound(begin, end, to);
+    if (slot != end && *slot == to) {
+        return m_SlotEdges[slot - m_Neighbors.begin()];
+    }
+    for (uint32_t pending = adjacency.pendingHead; pending != INVALID_INDEX; pending = m_PendingNext[pending]) {
+        if (m_PendingNeighbors[pending] == to) {
+            return m_PendingEdges[pending];
+        }
+    }
+    return INVALID_INDEX;
+}
+
+AttributeSet& Graph::GetAttributes(GraphElement element) {
+    return element == GraphElement::Edge ? m_EdgeAttributes : m_VertexAttributes;
+}
+
+const AttributeSet& Graph::GetAttributes(GraphElement element) const {
+    return const_cast<Graph*>(this)->GetAttributes(element);
+}
+
+} // namespace alice2
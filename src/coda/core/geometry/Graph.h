@@ -0,0 +1,157 @@
+#pragma once
+
+#include "EditLog.h"
+#include "Mesh.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace alice2 {
+
+enum class GraphElement {
+    Vertex,
+    Edge
+};
+
+// ---------------------------------------------------------------------------
+// Index-based graph with compressed sparse row adjacency
+// ---------------------------------------------------------------------------
+//
+// Edges are stored once as vertex pairs (2e, 2e + 1 in GetEdgeVertices()),
+// which doubles as a line index buffer. Adjacency is CSR: the slots of
+// vertex v are [offsets[v], offsets[v + 1]) in the neighbour and slot-edge
+// arrays, sorted by neighbour. An undirected graph lists every edge at both
+// ends (a self-loop twice at its vertex); a directed one only at its source.
+//
+// Inserted edges go to a pending buffer of per-vertex chains (O(1) per
+// insertion) that queries follow after the CSR slots; once it holds an
+// eighth of the slots it is merged in by Compact(). Slot positions are
+// therefore only stable between compactions, while vertex and edge indices
+// never move.
+class Graph {
+public:
+    // Slots of one vertex: [begin, end) in GetNeighbors()/GetSlotEdges(),
+    // then pendingCount pending slots chained from pendingHead through
+    // GetPendingNext(), newest first
+    struct Adjacency {
+        uint32_t begin;
+        uint32_t end;
+        uint32_t pendingHead;
+        uint32_t pendingCount;
+
+        uint32_t GetDegree() const { return (end - begin) + pendingCount; }
+    };
+
+    Graph() = default;
+
+    // Builds from an edge list of vertex pairs by a parallel counting sort on
+    // the vertex. Parallel edges are kept.
+    bool Create(const std::vector<Vec3f>& positions, const std::vector<uint32_t>& edgeVertices,
+                bool directed = false);
+    void Clear();
+
+    uint32_t AddVertex(const Vec3f& position);
+    // Returns the new edge index, INVALID_INDEX for out-of-range vertices
+    uint32_t AddEdge(uint32_t from, uint32_t to);
+    // Batch insertion of vertex pairs, validated as a whole
+    bool AddEdges(const std::vector<uint32_t>& edgeVertices);
+    // Merges the pending buffer into the CSR arrays
+    void Compact();
+    bool IsCompact() const { return m_PendingNeighbors.empty() && m_Offsets.size() == m_Positions.size() + 1; }
+
+    // Element counts
+    size_t GetVertexCount() const { return m_Positions.size(); }
+    size_t GetEdgeCount() const { return m_EdgeVertices.size() / 2; }
+    bool IsDirected() const { return m_Directed; }
+
+    // Positions. Edits through SetPosition are tracked; after writing through
+    // GetPositions() call MarkVertexDirty / MarkAllDirty.
+    std::vector<Vec3f>& GetPositions() { return m_Positions; }
+    const std::vector<Vec3f>& GetPositions() const { return m_Positions; }
+    const Vec3f& GetPosition(uint32_t vertex) const { return m_Positions[vertex]; }
+    void SetPosition(uint32_t vertex, const Vec3f& position) {
+        m_Positions[vertex] = position;
+        MarkVertexDirty(vertex);
+    }
+
+    // Geometry edit log, with the same semantics as Mesh's
+    void MarkVertexDirty(uint32_t vertex) { m_EditLog.MarkVertex(vertex, m_Positions.size()); }
+    void MarkAllDirty() { m_EditLog.MarkAll(); }
+    uint64_t GetEditCursor() const { return m_EditLog.GetCursor(); }
+    bool GetEditsSince(uint64_t cursor, std::vector<uint32_t>& vertices) const {
+        return m_EditLog.GetEditsSince(cursor, vertices);
+    }
+
+    // Edge endpoints (from, to as inserted)
+    uint32_t GetEdgeSource(uint32_t edge) const { return m_EdgeVertices[2 * edge]; }
+    uint32_t GetEdgeTarget(uint32_t edge) const { return m_EdgeVertices[2 * edge + 1]; }
+    uint32_t GetOtherVertex(uint32_t edge, uint32_t vertex) const {
+        return m_EdgeVertices[2 * edge] ^ m_EdgeVertices[2 * edge + 1] ^ vertex;
+    }
+
+    // Adjacency
+    Adjacency GetAdjacency(uint32_t vertex) const;
+    uint32_t GetDegree(uint32_t vertex) const { return GetAdjacency(vertex).GetDegree(); }
+    // An edge from -> to (either way when undirected), INVALID_INDEX if none
+    uint32_t FindEdge(uint32_t from, uint32_t to) const;
+
+    // Raw arrays for bulk kernels. Kernels that walk only the CSR arrays
+    // should Compact() first.
+    const std::vector<uint32_t>& GetEdgeVertices() const { return m_EdgeVertices; }
+    const std::vector<uint32_t>& GetOffsets() const { return m_Offsets; }
+    const std::vector<uint32_t>& GetNeighbors() const { return m_Neighbors; }
+    const std::vector<uint32_t>& GetSlotEdges() const { return m_SlotEdges; }
+    const std::vector<uint32_t>& GetPendingNeighbors() const { return m_PendingNeighbors; }
+    const std::vector<uint32_t>& GetPendingEdges() const { return m_PendingEdges; }
+    const std::vector<uint32_t>& GetPendingNext() const { return m_PendingNext; }
+
+    // Attribute layers, kept sized to their element count
+    AttributeSet& GetAttributes(GraphElement element);
+    const AttributeSet& GetAttributes(GraphElement element) const;
+
+    template <typename T>
+    std::vector<T>& AddVertexAttribute(const std::string& name, const T& defaultValue = T()) {
+        return m_VertexAttributes.Add<T>(name, defaultValue);
+    }
+    template <typename T>
+    std::vector<T>& AddEdgeAttribute(const std::string& name, const T& defaultValue = T()) {
+        return m_EdgeAttributes.Add<T>(name, defaultValue);
+    }
+    template <typename T>
+    std::vector<T>* GetVertexAttribute(const std::string& name) { return m_VertexAttributes.Get<T>(name); }
+    template <typename T>
+    std::vector<T>* GetEdgeAttribute(const std::string& name) { return m_EdgeAttributes.Get<T>(name); }
+
+    // Bumped on Create(), Clear() and every insertion; compaction keeps it
+    uint64_t GetTopologyVersion() const { return m_TopologyVersion; }
+
+private:
+    std::vector<Vec3f> m_Positions;
+    std::vector<uint32_t> m_EdgeVertices; // 2 per edge
+    bool m_Directed = false;
+
+    // CSR over the first m_Offsets.size() - 1 vertices; later ones have only
+    // pending slots until the next compaction
+    std::vector<uint32_t> m_Offsets;
+    std::vector<uint32_t> m_Neighbors;
+    std::vector<uint32_t> m_SlotEdges;
+    std::vector<uint32_t> m_PendingNeighbors;
+    std::vector<uint32_t> m_PendingEdges;
+    std::vector<uint32_t> m_PendingNext;   // Older slot of the same vertex
+    std::vector<uint32_t> m_PendingHead;   // Per vertex, empty while none are pending
+    std::vector<uint32_t> m_PendingCount;
+
+    AttributeSet m_VertexAttributes;
+    AttributeSet m_EdgeAttributes;
+
+    uint64_t m_TopologyVersion = 0;
+
+    EditLog m_EditLog;
+
+    void InsertPending(uint32_t vertex, uint32_t neighbor, uint32_t edge);
+    void CompactIfFull();
+};
+
+} // namespace alice2
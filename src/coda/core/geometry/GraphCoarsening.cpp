@@ -0,0 +1,379 @@
+#include "GraphCoarsening.h"
+#include "../utilities/Parallel.h"
+#include "../utilities/SpatialSort.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <iostream>
+#include <numeric>
+
+namespace alice2 {
+
+namespace {
+
+constexpr size_t VertexGrain = 4096;
+constexpr size_t EdgeGrain = 16384;
+
+// Tie-break between equally heavy edges, symmetric in the endpoints so
+// that both sides rank their candidates alike
+uint32_t PairHash(uint32_t a, uint32_t b) {
+    uint64_t x = a < b ? uint64_t(a) << 32 | b : uint64_t(b) << 32 | a;
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    return uint32_t(x);
+}
+
+} // namespace
+
+void GraphHierarchy::Clear() {
+    m_Levels.clear();
+    m_Graph = nullptr;
+    m_TopologyVersion = 0;
+}
+
+void GraphHierarchy::BuildAdjacency(size_t vertexCount, const std::vector<uint32_t>& edgeVertices,
+                                    const std::vector<float>& edgeWeights) {
+    // Counting sort of both directions of every non-loop edge
+    m_Offsets.assign(vertexCount + 1, 0);
+    const size_t edgeCount = edgeVertices.size() / 2;
+    for (size_t e = 0; e < edgeCount; ++e) {
+        uint32_t a = edgeVertices[2 * e], b = edgeVertices[2 * e + 1];
+        if (a != b) {
+            ++m_Offsets[a + 1];
+            ++m_Offsets[b + 1];
+        }
+    }
+    for (size_t v = 0; v < vertexCount; ++v) {
+        m_Offsets[v + 1] += m_Offsets[v];
+    }
+    m_Neighbors.resize(m_Offsets[vertexCount]);
+    m_Weights.resize(m_Offsets[vertexCount]);
+    std::vector<uint32_t> cursor(m_Offsets.begin(), m_Offsets.end() - 1);
+    for (size_t e = 0; e < edgeCount; ++e) {
+        uint32_t a = edgeVertices[2 * e], b = edgeVertices[2 * e + 1];
+        if (a != b) {
+            m_Neighbors[cursor[a]] = b;
+            m_Weights[cursor[a]++] = edgeWeights[e];
+            m_Neighbors[cursor[b]] = a;
+            m_Weights[cursor[b]++] = edgeWeights[e];
+        }
+    }
+}
+
+void GraphHierarchy::Match(const std::vector<float>& vertexWeights) {
+    const size_t vertexCount = vertexWeights.size();
+    m_Matches.assign(vertexCount, INVALID_INDEX);
+    m_Proposals.resize(vertexCount);
+
+    for (int round = 0; round < m_Settings.matchingRounds; ++round) {
+        // Heaviest edge per unit of aggregate weight, so that heavy
+        // aggregates do not keep absorbing their neighbours
+        parallel::For(vertexCount, VertexGrain, [&](size_t begin, size_t end) {
+            for (size_t u = begin; u < end; ++u) {
+                uint32_t best = INVALID_INDEX;
+                if (m_Matches[u] == INVALID_INDEX) {
+                    float bestScore = -1.0f;
+                    uint32_t bestHash = 0;
+                    for (uint32_t slot = m_Offsets[u]; slot < m_Offsets[u + 1]; ++slot) {
+                        uint32_t v = m_Neighbors[slot];
+                        if (m_Matches[v] != INVALID_INDEX) {
+                            continue;
+                        }
+                        float score = m_Weights[slot] / (vertexWeights[u] * vertexWeights[v]);
+                        uint32_t hash = PairHash(uint32_t(u), v);
+                        if (score > bestScore || (score == bestScore && hash > bestHash)) {
+                            best = v;
+                            bestScore = score;
+                            bestHash = hash;
+                        }
+                    }
+                }
+                m_Proposals[u] = best;
+            }
+        });
+        // Mutual proposals match; each vertex writes only its own slot
+        parallel::For(vertexCount, VertexGrain, [&](size_t begin, size_t end) {
+            for (size_t u = begin; u < end; ++u) {
+                uint32_t v = m_Proposals[u];
+                if (v != INVALID_INDEX && m_Proposals[v] == u) {
+                    m_Matches[u] = v;
+                }
+            }
+        });
+    }
+
+    // Two-hop matching: vertices left over because their neighbours are all
+    // taken (leaves of a hub, say) pair up with others whose heaviest edge
+    // leads to the same vertex
+    m_Proposals.clear();
+    std::vector<uint32_t> hubs;
+    for (size_t u = 0; u < vertexCount; ++u) {
+        if (m_Matches[u] != INVALID_INDEX || m_Offsets[u] == m_Offsets[u + 1]) {
+            continue;
+        }
+        uint32_t hub = m_Neighbors[m_Offsets[u]];
+        float heaviest = m_Weights[m_Offsets[u]];
+        for (uint32_t slot = m_Offsets[u] + 1; slot < m_Offsets[u + 1]; ++slot) {
+            if (m_Weights[slot] > heaviest) {
+                hub = m_Neighbors[slot];
+                heaviest = m_Weights[slot];
+            }
+        }
+        hubs.push_back(hub);
+        m_Proposals.push_back(uint32_t(u));
+    }
+    spatial::RadixSort(hubs, m_Proposals);
+    for (size_t i = 0; i + 1 < hubs.size(); ++i) {
+        if (hubs[i] == hubs[i + 1]) {
+            m_Matches[m_Proposals[i]] = m_Proposals[i + 1];
+            m_Matches[m_Proposals[i + 1]] = m_Proposals[i];
+            ++i;
+        }
+    }
+}
+
+bool GraphHierarchy::Build(const Graph& graph) {
+    Clear();
+    const size_t inputCount = graph.GetVertexCount();
+    const std::vector<float>* inputWeights = nullptr;
+    if (!m_Settings.weightAttribute.empty()) {
+        inputWeights = graph.GetAttributes(GraphElement::Edge).Get<float>(m_Settings.weightAttribute);
+        if (!inputWeights) {
+            std::cerr << "GraphHierarchy: no float edge attribute '" << m_Settings.weightAttribute << "'" << std::endl;
+            return false;
+        }
+        if (std::any_of(inputWeights->begin(), inputWeights->end(),
+                        [](float weight) { return !(weight > 0.0f) || !std::isfinite(weight); })) {
+            std::cerr << "GraphHierarchy: edge weights must be finite and positive" << std::endl;
+            return false;
+        }
+    }
+
+    std::vector<uint32_t> edgeVertices = graph.GetEdgeVertices();
+    std::vector<float> edgeWeights = inputWeights ? *inputWeights : std::vector<float>(graph.GetEdgeCount(), 1.0f);
+    std::vector<float> vertexWeights(inputCount, 1.0f);
+    std::vector<uint64_t> keys;
+    std::vector<uint32_t> order;
+
+    while (m_Levels.size() < m_Settings.maxLevels && vertexWeights.size() > m_Settings.minVertices) {
+        const size_t vertexCount = vertexWeights.size();
+        BuildAdjacency(vertexCount, edgeVertices, edgeWeights);
+        Match(vertexWeights);
+
+        // The smaller vertex of a pair leads it and numbers the aggregate
+        Level level;
+        level.parents.resize(vertexCount);
+        uint32_t aggregateCount = 0;
+        for (size_t u = 0; u < vertexCount; ++u) {
+            uint32_t match = m_Matches[u];
+            level.parents[u] = match == INVALID_INDEX || u < match ? aggregateCount++ : level.parents[match];
+        }
+        if (float(aggregateCount) > (1.0f - m_Settings.minReduction) * float(vertexCount)) {
+            break;
+        }
+        level.childOffsets.assign(size_t(aggregateCount) + 1, 0);
+        for (size_t u = 0; u < vertexCount; ++u) {
+            ++level.childOffsets[level.parents[u] + 1];
+        }
+        for (uint32_t a = 0; a < aggregateCount; ++a) {
+            level.childOffsets[a + 1] += level.childOffsets[a];
+        }
+        level.children.resize(vertexCount);
+        std::vector<uint32_t> cursor(level.childOffsets.begin(), level.childOffsets.end() - 1);
+        for (size_t u = 0; u < vertexCount; ++u) {
+            level.children[cursor[level.parents[u]]++] = uint32_t(u);
+        }
+        level.vertexWeights.assign(aggregateCount, 0.0f);
+        for (size_t u = 0; u < vertexCount; ++u) {
+            level.vertexWeights[level.parents[u]] += vertexWeights[u];
+        }
+
+        // Merge parallel coarse edges: sort by packed (min, max) endpoints
+        const size_t edgeCount = edgeVertices.size() / 2;
+        keys.resize(edgeCount);
+        order.resize(edgeCount);
+        parallel::For(edgeCount, EdgeGrain, [&](size_t begin, size_t end) {
+            for (size_t e = begin; e < end; ++e) {
+                uint32_t a = level.parents[edgeVertices[2 * e]], b = level.parents[edgeVertices[2 * e + 1]];
+                keys[e] = a == b ? ~uint64_t(0) : uint64_t(std::min(a, b)) << 32 | std::max(a, b);
+                order[e] = uint32_t(e);
+            }
+        });
+        spatial::RadixSort(keys, order);
+        std::vector<uint32_t> coarseEdges;
+        std::vector<float> coarseWeights;
+        for (size_t i = 0; i < edgeCount && keys[i] != ~uint64_t(0); ++i) {
+            if (i == 0 || keys[i] != keys[i - 1]) {
+                coarseEdges.push_back(uint32_t(keys[i] >> 32));
+                coarseEdges.push_back(uint32_t(keys[i]));
+                coarseWeights.push_back(0.0f);
+            }
+            coarseWeights.back() += edgeWeights[order[i]];
+        }
+        // Heaviest edges first, so that a prefix of the list is the most
+        // significant part of the level (stable, by inverted float bits)
+        std::vector<uint32_t> rank(coarseWeights.size()), sorted(coarseWeights.size());
+        std::iota(sorted.begin(), sorted.end(), 0u);
+        for (size_t e = 0; e < rank.size(); ++e) {
+            rank[e] = ~std::bit_cast<uint32_t>(coarseWeights[e]);
+        }
+        spatial::RadixSort(rank, sorted);
+        keys.resize(coarseWeights.size());
+        for (size_t i = 0; i < sorted.size(); ++i) {
+            keys[i] = uint64_t(coarseEdges[2 * sorted[i]]) << 32 | coarseEdges[2 * sorted[i] + 1];
+            rank[i] = std::bit_cast<uint32_t>(coarseWeights[sorted[i]]);
+        }
+        for (size_t i = 0; i < sorted.size(); ++i) {
+            coarseEdges[2 * i] = uint32_t(keys[i] >> 32);
+            coarseEdges[2 * i + 1] = uint32_t(keys[i]);
+            coarseWeights[i] = std::bit_cast<float>(rank[i]);
+        }
+
+        if (!level.graph.Create(std::vector<Vec3f>(aggregateCount), coarseEdges)) {
+            return false;
+        }
+        level.graph.AddEdgeAttribute<float>(WeightAttribute) = coarseWeights;
+        level.radii.assign(aggregateCount, 0.0f);
+        m_Levels.push_back(std::move(level));
+
+        edgeVertices.swap(coarseEdges);
+        edgeWeights.swap(coarseWeights);
+        vertexWeights = m_Levels.back().vertexWeights;
+    }
+
+    m_Graph = &graph;
+    m_TopologyVersion = graph.GetTopologyVersion();
+    UpdatePositions(graph);
+    return true;
+}
+
+void GraphHierarchy::UpdateLevel(size_t index, const std::vector<Vec3f>& finerPositions,
+                                 const std::vector<float>* finerRadii) {
+    Level& level = m_Levels[index];
+    const std::vector<float>* finerWeights = index > 0 ? &m_Levels[index - 1].vertexWeights : nullptr;
+    std::vector<Vec3f>& positions = level.graph.GetPositions();
+    const size_t aggregateCount = positions.size();
+    const size_t chunkCount = parallel::ChunkCount(aggregateCount, VertexGrain);
+    std::vector<double> squaredRadii(chunkCount, 0.0);
+
+    parallel::ForChunks(chunkCount, [&](size_t chunk) {
+        size_t begin = aggregateCount * chunk / chunkCount, end = aggregateCount * (chunk + 1) / chunkCount;
+        double sum = 0.0;
+        for (size_t a = begin; a < end; ++a) {
+            Vec3f center;
+            float weight = 0.0f;
+            for (uint32_t i = level.childOffsets[a]; i < level.childOffsets[a + 1]; ++i) {
+                uint32_t child = level.children[i];
+                float w = finerWeights ? (*finerWeights)[child] : 1.0f;
+                center += finerPositions[child] * w;
+                weight += w;
+            }
+            center /= weight;
+            float radius = 0.0f;
+            for (uint32_t i = level.childOffsets[a]; i < level.childOffsets[a + 1]; ++i) {
+                uint32_t child = level.children[i];
+                radius = std::max(radius, (finerPositions[child] - center).Length() +
+                                              (finerRadii ? (*finerRadii)[child] : 0.0f));
+            }
+            positions[a] = center;
+            level.radii[a] = radius;
+            sum += double(radius) * radius;
+        }
+        squaredRadii[chunk] = sum;
+    });
+    double sum = 0.0;
+    for (double value : squaredRadii) {
+        sum += value;
+    }
+    level.error = aggregateCount > 0 ? float(std::sqrt(sum / double(aggregateCount))) : 0.0f;
+    level.graph.MarkAllDirty();
+}
+
+void GraphHierarchy::UpdatePositions(const Graph& graph) {
+    const std::vector<Vec3f>& positions = graph.GetPositions();
+    if (positions.empty()) {
+        return;
+    }
+    Vec3f minBound = positions[0], maxBound = positions[0];
+    for (const Vec3f& p : positions) {
+        minBound = Vec3f(std::min(minBound.x, p.x), std::min(minBound.y, p.y), std::min(minBound.z, p.z));
+        maxBound = Vec3f(std::max(maxBound.x, p.x), std::max(maxBound.y, p.y), std::max(maxBound.z, p.z));
+    }
+    m_Center = (minBound + maxBound) * 0.5f;
+    m_Radius = (maxBound - minBound).Length() * 0.5f;
+
+    for (size_t level = 0; level < m_Levels.size(); ++level) {
+        if (level == 0) {
+            UpdateLevel(0, positions, nullptr);
+        } else {
+            UpdateLevel(level, m_Levels[level - 1].graph.GetPositions(), &m_Levels[level - 1].radii);
+        }
+    }
+    ++m_PositionVersion;
+}
+
+void GraphHierarchy::Prolong(size_t index, std::vector<Vec3f>& finerPositions, float scale, bool planar) const {
+    const Level& level = m_Levels[index];
+    const std::vector<Vec3f>& positions = level.graph.GetPositions();
+    Vec3f centroid;
+    for (const Vec3f& p : positions) {
+        centroid += p;
+    }
+    centroid /= float(std::max<size_t>(positions.size(), 1));
+
+    // Children fan out around their aggregate at a fraction of the mean
+    // edge length, so that they start apart but inside its neighbourhood
+    const std::vector<uint32_t>& edgeVertices = level.graph.GetEdgeVertices();
+    double length = 0.0;
+    for (size_t i = 0; i + 1 < edgeVertices.size(); i += 2) {
+        length += (positions[edgeVertices[i]] - positions[edgeVertices[i + 1]]).Length();
+    }
+    float offset = edgeVertices.empty() ? 1.0f : float(length / double(edgeVertices.size() / 2)) * scale * 0.1f;
+
+    finerPositions.resize(level.parents.size());
+    parallel::For(level.parents.size(), VertexGrain, [&](size_t begin, size_t end) {
+        for (size_t v = begin; v < end; ++v) {
+            uint32_t a = level.parents[v];
+            float angle = float(v - level.children[level.childOffsets[a]]) * 2.39996323f +
+                          float(PairHash(uint32_t(v), a) & 0xffff) * 1e-4f;
+            Vec3f direction = planar ? Vec3f(std::cos(angle), 0.0f, std::sin(angle))
+                                     : Vec3f(std::cos(angle), float(int(v & 1) * 2 - 1) * 0.5f, std::sin(angle));
+            finerPositions[v] = centroid + (positions[a] - centroid) * scale + direction * offset;
+        }
+    });
+}
+
+bool GraphHierarchy::Layout(Graph& graph, GraphLayout& layout, int iterationsPerLevel) {
+    if (!IsBuiltFor(graph) && !Build(graph)) {
+        return false;
+    }
+    const GraphLayoutSettings settings = layout.GetSettings();
+    GraphLayoutSettings coarseSettings = settings;
+    coarseSettings.weightAttribute = WeightAttribute;
+
+    bool ok = true;
+    for (size_t level = m_Levels.size(); level-- > 0;) {
+        Graph& coarse = m_Levels[level].graph;
+        layout.SetSettings(coarseSettings);
+        layout.Reset();
+        ok = layout.Step(coarse, iterationsPerLevel) && ok;
+        // Settled layouts grow about as the square root of the vertex count
+        size_t finerCount = level > 0 ? m_Levels[level - 1].graph.GetVertexCount() : graph.GetVertexCount();
+        float scale = std::sqrt(float(finerCount) / float(coarse.GetVertexCount()));
+        if (level > 0) {
+            Prolong(level, m_Levels[level - 1].graph.GetPositions(), scale, settings.planar);
+        } else {
+            Prolong(0, graph.GetPositions(), scale, settings.planar);
+            graph.MarkAllDirty();
+        }
+    }
+    layout.SetSettings(settings);
+    layout.Reset();
+    ok = layout.Step(graph, iterationsPerLevel) && ok;
+    UpdatePositions(graph);
+    return ok;
+}
+
+} // namespace alice2
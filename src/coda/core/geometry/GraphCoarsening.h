@@ -0,0 +1,108 @@
+#pragma once
+
+#include "Graph.h"
+#include "GraphLayout.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace alice2 {
+
+struct GraphCoarseningSettings {
+    std::string weightAttribute; // Float edge layer; empty weighs every edge 1
+    size_t minVertices = 64;     // Stop once a level is this small
+    size_t maxLevels = 24;
+    float minReduction = 0.1f;   // Stop when a level removes less than this fraction of vertices
+    int matchingRounds = 3;
+};
+
+// Multilevel coarsening by heavy-edge matching, for multilevel layouts and
+// level-of-detail display of large graphs.
+//
+// Each level matches vertices of the finer one in parallel rounds: every
+// unmatched vertex proposes to the unmatched neighbour with the heaviest
+// edge relative to both aggregate weights, and mutual proposals match.
+// Matched pairs merge into one aggregate at their weighted centroid;
+// parallel edges between aggregates merge into one whose weight is their
+// sum (a radix sort on the packed endpoint pair), and edges inside an
+// aggregate vanish. Levels halve roughly, so their edge counts fall
+// geometrically down to a bounded top.
+//
+// Level 0 is the first coarse level; the input graph is not copied.
+class GraphHierarchy {
+public:
+    static constexpr const char* WeightAttribute = "weight";
+
+    struct Level {
+        Graph graph;                       // Aggregates, with edge layer "weight"
+        std::vector<uint32_t> parents;     // Vertex of the finer level -> aggregate here
+        std::vector<uint32_t> childOffsets; // Aggregate a has children [childOffsets[a], childOffsets[a + 1])
+        std::vector<uint32_t> children;
+        std::vector<float> vertexWeights;  // Input vertices per aggregate
+        std::vector<float> radii;          // Bounding radius of those vertices
+        float error = 0.0f;                // Root-mean-square radius
+    };
+
+    explicit GraphHierarchy(const GraphCoarseningSettings& settings = GraphCoarseningSettings())
+        : m_Settings(settings) {}
+
+    void SetSettings(const GraphCoarseningSettings& settings) { m_Settings = settings; }
+    const GraphCoarseningSettings& GetSettings() const { return m_Settings; }
+
+    // Coarsens until a stopping rule holds; small graphs get no levels.
+    // False for a missing or non-positive weight layer.
+    bool Build(const Graph& graph);
+    void Clear();
+    // Whether the levels are current for the graph's topology
+    bool IsBuiltFor(const Graph& graph) const {
+        return m_Graph == &graph && m_TopologyVersion == graph.GetTopologyVersion();
+    }
+
+    size_t GetLevelCount() const { return m_Levels.size(); }
+    const Level& GetLevel(size_t level) const { return m_Levels[level]; }
+    Level& GetLevel(size_t level) { return m_Levels[level]; }
+
+    // Re-centres the aggregates (positions and radii, bottom up) after the
+    // input positions moved, and the bounding sphere of the input
+    void UpdatePositions(const Graph& graph);
+    const Vec3f& GetCenter() const { return m_Center; }
+    float GetRadius() const { return m_Radius; }
+    // Bumped by Build() and UpdatePositions()
+    uint64_t GetPositionVersion() const { return m_PositionVersion; }
+
+    // Seeds the level below (the input graph's for level 0) from a level:
+    // every vertex starts at its aggregate, spread about the centroid by
+    // scale, plus a small offset that separates the aggregate's children
+    void Prolong(size_t level, std::vector<Vec3f>& finerPositions, float scale, bool planar) const;
+
+    // Multilevel layout: iterations on the coarsest level, then on each
+    // finer one seeded by Prolong(), finishing on the graph itself. Builds
+    // the hierarchy first if it is stale.
+    bool Layout(Graph& graph, GraphLayout& layout, int iterationsPerLevel);
+
+private:
+    GraphCoarseningSettings m_Settings;
+    std::vector<Level> m_Levels;
+
+    const Graph* m_Graph = nullptr;
+    uint64_t m_TopologyVersion = 0;
+    uint64_t m_PositionVersion = 0;
+    Vec3f m_Center;
+    float m_Radius = 0.0f;
+
+    // Undirected weighted adjacency of the level being matched
+    std::vector<uint32_t> m_Offsets;
+    std::vector<uint32_t> m_Neighbors;
+    std::vector<float> m_Weights;
+    std::vector<uint32_t> m_Proposals;
+    std::vector<uint32_t> m_Matches;
+
+    void BuildAdjacency(size_t vertexCount, const std::vector<uint32_t>& edgeVertices,
+                        const std::vector<float>& edgeWeights);
+    void Match(const std::vector<float>& vertexWeights);
+    void UpdateLevel(size_t level, const std::vector<Vec3f>& finerPositions, const std::vector<float>* finerRadii);
+};
+
+} // namespace alice2
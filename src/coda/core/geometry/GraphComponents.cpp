@@ -0,0 +1,243 @@
+#include "GraphComponents.h"
+#include "../utilities/Parallel.h"
+#include "../utilities/SpatialSort.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <iostream>
+#include <numeric>
+
+namespace alice2 {
+
+namespace {
+
+constexpr size_t EdgeGrain = 8192;
+constexpr size_t VertexGrain = 16384;
+constexpr uint64_t NoEdge = ~uint64_t(0);
+
+// Unsigned key in the order of the float, negative values included
+uint32_t WeightKey(float weight) {
+    uint32_t bits = std::bit_cast<uint32_t>(weight);
+    return (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
+}
+
+float KeyWeight(uint32_t key) {
+    return std::bit_cast<float>((key & 0x80000000u) ? key & 0x7fffffffu : ~key);
+}
+
+void AtomicMin(uint64_t& target, uint64_t value) {
+    std::atomic_ref<uint64_t> ref(target);
+    uint64_t current = ref.load(std::memory_order_relaxed);
+    while (value < current && !ref.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+// Keeps the items flagged by keep(item), in order, with a per-chunk count
+// and prefix sum so that both passes run in parallel
+template <typename Keep>
+void Filter(std::vector<uint32_t>& items, std::vector<uint32_t>& scratch, std::vector<uint32_t>& counts,
+            const Keep& keep) {
+    const size_t count = items.size();
+    const size_t chunkCount = parallel::ChunkCount(count, EdgeGrain);
+    counts.assign(chunkCount + 1, 0);
+    scratch.resize(count);
+    // Survivors are first packed to the front of their chunk's range
+    parallel::ForChunks(chunkCount, [&](size_t chunk) {
+        size_t begin = count * chunk / chunkCount, end = count * (chunk + 1) / chunkCount;
+        uint32_t kept = 0;
+        for (size_t i = begin; i < end; ++i) {
+            if (keep(items[i])) {
+                scratch[begin + kept++] = items[i];
+            }
+        }
+        counts[chunk + 1] = kept;
+    });
+    for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+        counts[chunk + 1] += counts[chunk];
+    }
+    items.resize(counts[chunkCount]);
+    parallel::ForChunks(chunkCount, [&](size_t chunk) {
+        size_t begin = count * chunk / chunkCount;
+        std::copy(scratch.begin() + begin, scratch.begin() + begin + (counts[chunk + 1] - counts[chunk]),
+                  items.begin() + counts[chunk]);
+    });
+}
+
+} // namespace
+
+size_t GraphComponents::ComputeComponents(const Graph& graph, std::vector<uint32_t>& labels,
+                                          std::vector<uint32_t>* sizes) {
+    const size_t vertexCount = graph.GetVertexCount();
+    const std::vector<uint32_t>& edgeVertices = graph.GetEdgeVertices();
+    m_Sets.Reset(vertexCount);
+    parallel::For(graph.GetEdgeCount(), EdgeGrain, [&](size_t begin, size_t end) {
+        for (size_t e = begin; e < end; ++e) {
+            m_Sets.Unite(edgeVertices[2 * e], edgeVertices[2 * e + 1]);
+        }
+    });
+    m_Sets.GetRoots(labels);
+
+    // A root is the smallest vertex of its set, so it is numbered before
+    // any other member is reached
+    uint32_t componentCount = 0;
+    for (size_t v = 0; v < vertexCount; ++v) {
+        labels[v] = labels[v] == v ? componentCount++ : labels[labels[v]];
+    }
+    if (sizes) {
+        sizes->assign(componentCount, 0);
+        for (uint32_t label : labels) {
+            ++(*sizes)[label];
+        }
+    }
+    return componentCount;
+}
+
+bool GraphComponents::ComputeKeys(const Graph& graph) {
+    const size_t edgeCount = graph.GetEdgeCount();
+    const std::vector<float>* weights = nullptr;
+    if (!m_Settings.weightAttribute.empty()) {
+        weights = graph.GetAttributes(GraphElement::Edge).Get<float>(m_Settings.weightAttribute);
+        if (!weights) {
+            std::cerr << "GraphComponents: no float edge attribute '" << m_Settings.weightAttribute << "'"
+                      << std::endl;
+            return false;
+        }
+        if (std::any_of(weights->begin(), weights->end(), [](float weight) { return std::isnan(weight); })) {
+            std::cerr << "GraphComponents: edge weights must not be NaN" << std::endl;
+            return false;
+        }
+    }
+    const std::vector<Vec3f>& positions = graph.GetPositions();
+    m_Keys.resize(edgeCount);
+    parallel::For(edgeCount, EdgeGrain, [&](size_t begin, size_t end) {
+        for (size_t e = begin; e < end; ++e) {
+            float weight = weights ? (*weights)[e]
+                                   : (positions[graph.GetEdgeSource(uint32_t(e))] -
+                                      positions[graph.GetEdgeTarget(uint32_t(e))])
+                                         .Length();
+            m_Keys[e] = WeightKey(weight);
+        }
+    });
+    return true;
+}
+
+void GraphComponents::RunBoruvka(const Graph& graph) {
+    const std::vector<uint32_t>& edgeVertices = graph.GetEdgeVertices();
+    m_Lightest.assign(graph.GetVertexCount(), NoEdge);
+    m_Edges.resize(graph.GetEdgeCount());
+    std::iota(m_Edges.begin(), m_Edges.end(), 0u);
+
+    // Each round drops the edges inside a component and offers the others
+    // to both components they join; the filter is the round's edge pass
+    auto offer = [&](uint32_t e) {
+        uint32_t a = m_Sets.Find(edgeVertices[2 * e]), b = m_Sets.Find(edgeVertices[2 * e + 1]);
+        if (a == b) {
+            return false;
+        }
+        uint64_t packed = uint64_t(m_Keys[e]) << 32 | e;
+        AtomicMin(m_Lightest[a], packed);
+        AtomicMin(m_Lightest[b], packed);
+        return true;
+    };
+    Filter(m_Edges, m_Scratch, m_ChunkCounts, offer);
+    while (!m_Edges.empty()) {
+        // Hook every component along its lightest edge. With ties broken by
+        // index these edges form a forest, so a union only fails for an
+        // edge that both of its components picked.
+        parallel::For(m_Lightest.size(), VertexGrain, [&](size_t begin, size_t end) {
+            for (size_t v = begin; v < end; ++v) {
+                if (m_Lightest[v] != NoEdge) {
+                    uint32_t e = uint32_t(m_Lightest[v]);
+                    m_Lightest[v] = NoEdge;
+                    if (m_Sets.Unite(edgeVertices[2 * e], edgeVertices[2 * e + 1])) {
+                        m_Selected[e] = 1;
+                    }
+                }
+            }
+        });
+        Filter(m_Edges, m_Scratch, m_ChunkCounts, offer);
+    }
+}
+
+void GraphComponents::RunKruskal(const Graph& graph) {
+    const std::vector<uint32_t>& edgeVertices = graph.GetEdgeVertices();
+    m_Edges.resize(graph.GetEdgeCount());
+    std::iota(m_Edges.begin(), m_Edges.end(), 0u);
+    // The sort is stable, which keeps equal weights in index order
+    m_Scratch = m_Keys;
+    spatial::RadixSort(m_Scratch, m_Edges);
+
+    size_t remaining = graph.GetVertexCount() > 0 ? graph.GetVertexCount() - 1 : 0;
+    for (size_t i = 0; i < m_Edges.size() && remaining > 0; ++i) {
+        uint32_t e = m_Edges[i];
+        if (m_Sets.Unite(edgeVertices[2 * e], edgeVertices[2 * e + 1])) {
+            m_Selected[e] = 1;
+            --remaining;
+        }
+    }
+}
+
+bool GraphComponents::ComputeSpanningForest(const Graph& graph, std::vector<uint32_t>& edges, double* totalWeight) {
+    edges.clear();
+    if (totalWeight) {
+        *totalWeight = 0.0;
+    }
+    if (!ComputeKeys(graph)) {
+        return false;
+    }
+    const size_t edgeCount = graph.GetEdgeCount();
+    m_Sets.Reset(graph.GetVertexCount());
+    m_Selected.assign(edgeCount, 0);
+
+    SpanningForestMethod method = m_Settings.method;
+    if (method == SpanningForestMethod::Auto) {
+        method = edgeCount >= m_Settings.parallelThreshold && parallel::ThreadCount() > 1
+                     ? SpanningForestMethod::Boruvka
+                     : SpanningForestMethod::Kruskal;
+    }
+    if (method == SpanningForestMethod::Boruvka) {
+        RunBoruvka(graph);
+    } else {
+        RunKruskal(graph);
+    }
+
+    edges.resize(edgeCount);
+    std::iota(edges.begin(), edges.end(), 0u);
+    Filter(edges, m_Scratch, m_ChunkCounts, [&](uint32_t e) { return m_Selected[e] != 0; });
+    if (totalWeight) {
+        for (uint32_t e : edges) {
+            *totalWeight += KeyWeight(m_Keys[e]);
+        }
+    }
+    return true;
+}
+
+void GraphComponents::ColorLabels(const std::vector<uint32_t>& labels, std::vector<Color>& colors) {
+    colors.resize(labels.size());
+    parallel::For(labels.size(), VertexGrain, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            if (labels[i] == INVALID_INDEX) {
+                colors[i] = Color::Gray();
+                continue;
+            }
+            // Golden-ratio hue steps keep consecutive labels apart
+            float hue = float(std::fmod(double(labels[i]) * 0.6180339887, 1.0)) * 6.0f;
+            float saturation = 0.65f, value = 0.95f;
+            float f = hue - std::floor(hue);
+            float p = value * (1.0f - saturation), q = value * (1.0f - saturation * f),
+                  t = value * (1.0f - saturation * (1.0f - f));
+            switch (int(hue) % 6) {
+            case 0: colors[i] = Color(value, t, p); break;
+            case 1: colors[i] = Color(q, value, p); break;
+            case 2: colors[i] = Color(p, value, t); break;
+            case 3: colors[i] = Color(p, q, value); break;
+            case 4: colors[i] = Color(t, p, value); break;
+            default: colors[i] = Color(value, p, q); break;
+            }
+        }
+    });
+}
+
+} // namespace alice2
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "Graph.h"
+#include "../utilities/UnionFind.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace alice2 {
+
+enum class SpanningForestMethod {
+    Auto,    // Boruvka on large graphs when threads are available
+    Boruvka,
+    Kruskal
+};
+
+struct SpanningForestSettings {
+    std::string weightAttribute; // Float edge layer; empty uses Euclidean edge lengths
+    SpanningForestMethod method = SpanningForestMethod::Auto;
+    size_t parallelThreshold = 1 << 16; // Auto: edge count from which Boruvka is used
+};
+
+// Connected components and minimum spanning forests of a Graph, with edge
+// directions ignored.
+//
+// Both run on a concurrent UnionFind. Components unite the endpoints of all
+// edges in parallel. Boruvka rounds find the lightest edge out of every
+// component with an atomic minimum on packed (weight, edge) words, hook the
+// components along them, and drop edges that became internal; Kruskal
+// radix-sorts the weights and unites in order. Ties break by edge index,
+// so both return the same, unique forest.
+//
+// Results go into caller-owned buffers; scratch state lives in the object.
+class GraphComponents {
+public:
+    explicit GraphComponents(const SpanningForestSettings& settings = SpanningForestSettings()) : m_Settings(settings) {}
+
+    void SetSettings(const SpanningForestSettings& settings) { m_Settings = settings; }
+    const SpanningForestSettings& GetSettings() const { return m_Settings; }
+
+    // Component of every vertex, numbered from 0 in the order of each
+    // component's smallest vertex; returns the number of components. Sizes
+    // (optional) receives the vertex count of each.
+    size_t ComputeComponents(const Graph& graph, std::vector<uint32_t>& labels, std::vector<uint32_t>* sizes = nullptr);
+
+    // Edges of a minimum spanning forest, in increasing index order, and
+    // optionally their total weight. False for a missing weight layer or
+    // NaN weights; negative weights are allowed.
+    bool ComputeSpanningForest(const Graph& graph, std::vector<uint32_t>& edges, double* totalWeight = nullptr);
+
+    // Sets of the last computation: the components, or the trees of the forest
+    UnionFind& GetSets() { return m_Sets; }
+
+    // Distinct colours per label, e.g. into a vertex layer for
+    // ObjGraph::SetEdgeColorAttribute(); INVALID_INDEX maps to grey
+    static void ColorLabels(const std::vector<uint32_t>& labels, std::vector<Color>& colors);
+
+private:
+    SpanningForestSettings m_Settings;
+
+    UnionFind m_Sets;
+    std::vector<uint32_t> m_Keys;     // Order-preserving bits of the edge weights
+    std::vector<uint32_t> m_Edges;    // Boruvka: live edges; Kruskal: sorted edges
+    std::vector<uint32_t> m_Scratch;
+    std::vector<uint64_t> m_Lightest; // Boruvka: packed (key, edge) per component root
+    std::vector<uint8_t> m_Selected;  // Per edge, 1 when in the forest
+    std::vector<uint32_t> m_ChunkCounts;
+
+    bool ComputeKeys(const Graph& graph);
+    void RunBoruvka(const Graph& graph);
+    void RunKruskal(const Graph& graph);
+};
+
+} // namespace alice2
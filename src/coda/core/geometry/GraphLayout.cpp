@@ -0,0 +1,470 @@
+#include "GraphLayout.h"
+#include "../utilities/Parallel.h"
+#include "../utilities/Simd.h"
+#include "../utilities/SpatialSort.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace alice2 {
+
+namespace {
+
+constexpr size_t GrainSize = 4096;
+// Morton keys carry 10 levels of 3 bits; below that bodies share a leaf
+constexpr int MaxLevel = 10;
+constexpr uint32_t SubtreeBit = 0x80000000u;
+
+struct Range {
+    uint32_t begin;
+    uint32_t end;
+    int level;
+};
+
+struct TopNode {
+    Range range;
+    std::vector<uint32_t> children; // Top node indices or, with SubtreeBit, subtrees
+};
+
+inline uint32_t Digit(uint32_t key, int level) {
+    return (key >> (27 - 3 * level)) & 7u;
+}
+
+struct TreeInput {
+    const std::vector<uint32_t>& keys;
+    const std::vector<float>& x;
+    const std::vector<float>& y;
+    const std::vector<float>& z;
+    const std::vector<float>& mass;
+};
+
+// Child ranges of [begin, end) by the key digit at level (the keys are sorted)
+void SplitRange(const std::vector<uint32_t>& keys, uint32_t begin, uint32_t end, int level,
+                std::vector<Range>& children) {
+    children.clear();
+    while (begin < end) {
+        uint32_t digit = Digit(keys[begin], level);
+        uint32_t split = uint32_t(std::partition_point(keys.begin() + begin, keys.begin() + end,
+                                                       [&](uint32_t key) { return Digit(key, level) == digit; })
+                                  - keys.begin());
+        children.push_back({begin, split, level + 1});
+        begin = split;
+    }
+}
+
+void MakeLeaf(const TreeInput& input, GraphLayout::Node& node, uint32_t begin, uint32_t end) {
+    constexpr float inf = std::numeric_limits<float>::infinity();
+    Vec3f lo(inf, inf, inf), hi(-inf, -inf, -inf), weighted;
+    float mass = 0.0f;
+    for (uint32_t i = begin; i < end; ++i) {
+        Vec3f p(input.x[i], input.y[i], input.z[i]);
+        lo = Vec3f(std::min(lo.x, p.x), std::min(lo.y, p.y), std::min(lo.z, p.z));
+        hi = Vec3f(std::max(hi.x, p.x), std::max(hi.y, p.y), std::max(hi.z, p.z));
+        weighted += p * input.mass[i];
+        mass += input.mass[i];
+    }
+    node.center = weighted / mass;
+    node.mass = mass;
+    node.min = lo;
+    node.max = hi;
+    node.first = begin;
+    node.count = end - begin;
+}
+
+// Interior node from its children, which follow it up to nodes.size()
+void Aggregate(std::vector<GraphLayout::Node>& nodes, uint32_t index) {
+    constexpr float inf = std::numeric_limits<float>::infinity();
+    GraphLayout::Node& node = nodes[index];
+    Vec3f lo(inf, inf, inf), hi(-inf, -inf, -inf), weighted;
+    float mass = 0.0f;
+    for (uint32_t child = index + 1; child < nodes.size(); child = nodes[child].skip) {
+        const GraphLayout::Node& c = nodes[child];
+        lo = Vec3f(std::min(lo.x, c.min.x), std::min(lo.y, c.min.y), std::min(lo.z, c.min.z));
+        hi = Vec3f(std::max(hi.x, c.max.x), std::max(hi.y, c.max.y), std::max(hi.z, c.max.z));
+        weighted += c.center * c.mass;
+        mass += c.mass;
+    }
+    node.center = weighted / mass;
+    node.mass = mass;
+    node.min = lo;
+    node.max = hi;
+    node.first = 0;
+    node.count = 0;
+    node.skip = uint32_t(nodes.size());
+}
+
+// Serial depth-first build; skip indices are relative to nodes[0]
+void BuildSubtree(const TreeInput& input, std::vector<GraphLayout::Node>& nodes, uint32_t begin, uint32_t end,
+                  int level) {
+    uint32_t index = uint32_t(nodes.size());
+    nodes.emplace_back();
+    if (end - begin <= GraphLayout::LeafSize || level >= MaxLevel) {
+        MakeLeaf(input, nodes[index], begin, end);
+        nodes[index].skip = index + 1;
+        return;
+    }
+    std::vector<Range> children;
+    SplitRange(input.keys, begin, end, level, children);
+    for (const Range& child : children) {
+        BuildSubtree(input, nodes, child.begin, child.end, child.level);
+    }
+    Aggregate(nodes, index);
+}
+
+// Squared distance from a point to a box, 0 inside
+inline float DistanceSquared(const Vec3f& p, const Vec3f& lo, const Vec3f& hi) {
+    float dx = std::max(std::max(lo.x - p.x, p.x - hi.x), 0.0f);
+    float dy = std::max(std::max(lo.y - p.y, p.y - hi.y), 0.0f);
+    float dz = std::max(std::max(lo.z - p.z, p.z - hi.z), 0.0f);
+    return dx * dx + dy * dy + dz * dz;
+}
+
+// Interaction list of one leaf in SoA, padded with massless entries
+struct InteractionList {
+    std::vector<float> x, y, z, mass;
+
+    void Clear() {
+        x.clear();
+        y.clear();
+        z.clear();
+        mass.clear();
+    }
+    void Add(float px, float py, float pz, float m) {
+        x.push_back(px);
+        y.push_back(py);
+        z.push_back(pz);
+        mass.push_back(m);
+    }
+    void Pad(size_t width) {
+        while (x.size() % width != 0) {
+            Add(0.0f, 0.0f, 0.0f, 0.0f);
+        }
+    }
+};
+
+} // namespace
+
+void GraphLayout::Reset() {
+    m_Graph = nullptr;
+    m_Iterations = 0;
+    m_Speed = 1.0f;
+    m_SpeedEfficiency = 1.0f;
+}
+
+void GraphLayout::Prepare(Graph& graph) {
+    if (m_Graph == &graph && m_TopologyVersion == graph.GetTopologyVersion()) {
+        return;
+    }
+    Reset();
+    m_Graph = &graph;
+    m_TopologyVersion = graph.GetTopologyVersion();
+
+    size_t vertexCount = graph.GetVertexCount();
+    m_Mass.assign(vertexCount, 1.0f);
+    for (uint32_t vertex : graph.GetEdgeVertices()) {
+        m_Mass[vertex] += 1.0f;
+    }
+    m_Forces.assign(vertexCount, Vec3f());
+    m_PreviousForces.assign(vertexCount, Vec3f());
+
+    // Coincident vertices feel no force from each other: spread them on a
+    // sunflower spiral (or a spherical one) sized like the settled layout
+    std::vector<Vec3f>& positions = graph.GetPositions();
+    bool coincident = true;
+    for (size_t v = 1; v < vertexCount && coincident; ++v) {
+        coincident = positions[v].x == positions[0].x && positions[v].y == positions[0].y
+            && positions[v].z == positions[0].z;
+    }
+    if (coincident && vertexCount > 1) {
+        const float golden = 2.39996323f;
+        float radius = 10.0f * std::sqrt(float(vertexCount));
+        for (size_t v = 0; v < vertexCount; ++v) {
+            float t = (float(v) + 0.5f) / float(vertexCount);
+            float angle = golden * float(v);
+            if (m_Settings.planar) {
+                positions[v] = Vec3f(std::cos(angle), 0.0f, std::sin(angle)) * (radius * std::sqrt(t));
+            } else {
+                float y = 1.0f - 2.0f * t, ring = std::sqrt(std::max(0.0f, 1.0f - y * y));
+                positions[v] = Vec3f(std::cos(angle) * ring, y, std::sin(angle) * ring) * (radius * std::cbrt(t));
+            }
+        }
+    } else if (m_Settings.planar) {
+        for (Vec3f& p : positions) {
+            p.y = 0.0f;
+        }
+    }
+}
+
+void GraphLayout::BuildTree(const std::vector<Vec3f>& positions) {
+    const size_t count = positions.size();
+    std::vector<uint32_t> keys(count);
+    spatial::ComputeKeys30(positions.data(), count, spatial::SpaceFillingCurve::Morton, keys.data());
+    m_Order.resize(count);
+    std::iota(m_Order.begin(), m_Order.end(), 0u);
+    spatial::RadixSort(keys, m_Order);
+
+    m_BodyX.resize(count);
+    m_BodyY.resize(count);
+    m_BodyZ.resize(count);
+    m_BodyMass.resize(count);
+    parallel::For(count, GrainSize, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const Vec3f& p = positions[m_Order[i]];
+            m_BodyX[i] = p.x;
+            m_BodyY[i] = p.y;
+            m_BodyZ[i] = p.z;
+            m_BodyMass[i] = m_Mass[m_Order[i]];
+        }
+    });
+    TreeInput input{keys, m_BodyX, m_BodyY, m_BodyZ, m_BodyMass};
+
+    // Top of the tree split serially until the ranges are small enough to
+    // hand one per task to the workers, as in MeshBvh
+    const uint32_t subtreeSize = uint32_t(std::max<size_t>(count / (parallel::ThreadCount() * 8), 4096));
+    std::vector<TopNode> top;
+    std::vector<Range> subtrees;
+    auto addRange = [&](const Range& range) -> uint32_t {
+        if (range.end - range.begin <= subtreeSize || range.level >= MaxLevel) {
+            subtrees.push_back(range);
+            return uint32_t(subtrees.size() - 1) | SubtreeBit;
+        }
+        top.push_back({range, {}});
+        return uint32_t(top.size() - 1);
+    };
+    uint32_t root = addRange({0, uint32_t(count), 0});
+    std::vector<Range> children;
+    for (size_t i = 0; i < top.size(); ++i) {
+        SplitRange(keys, top[i].range.begin, top[i].range.end, top[i].range.level, children);
+        for (const Range& child : children) {
+            uint32_t reference = addRange(child);
+            top[i].children.push_back(reference);
+        }
+    }
+
+    std::vector<std::vector<Node>> subtreeNodes(subtrees.size());
+    parallel::ForChunks(subtrees.size(), [&](size_t s) {
+        BuildSubtree(input, subtreeNodes[s], subtrees[s].begin, subtrees[s].end, subtrees[s].level);
+    });
+
+    // Flatten depth first, subtrees copied as blocks with rebased skips
+    m_Nodes.clear();
+    auto emit = [&](auto&& self, uint32_t reference) -> void {
+        uint32_t index = uint32_t(m_Nodes.size());
+        if (reference & SubtreeBit) {
+            for (Node node : subtreeNodes[reference & ~SubtreeBit]) {
+                node.skip += index;
+                m_Nodes.push_back(node);
+            }
+            return;
+        }
+        m_Nodes.emplace_back();
+        for (uint32_t child : top[reference].children) {
+            self(self, child);
+        }
+        Aggregate(m_Nodes, index);
+    };
+    emit(emit, root);
+
+    m_Leaves.clear();
+    for (uint32_t n = 0; n < m_Nodes.size(); ++n) {
+        if (m_Nodes[n].count > 0) {
+            m_Leaves.push_back(n);
+        }
+    }
+}
+
+void GraphLayout::ComputeRepulsion() {
+    using simd::FloatV;
+    const float thetaSquared = m_Settings.theta * m_Settings.theta;
+    const Node& root = m_Nodes[0];
+    Vec3f extent = root.max - root.min;
+    // Softening keeps coincident vertices finite; far below any layout scale
+    float softening = std::max(std::max(extent.x, extent.y), extent.z) * 1e-4f;
+    const float epsilon = softening * softening + 1e-12f;
+    const float repulsion = m_Settings.repulsion;
+
+    parallel::For(m_Leaves.size(), 16, [&](size_t begin, size_t end) {
+        InteractionList list;
+        alignas(32) float lanes[3][FloatV::Width];
+        for (size_t l = begin; l < end; ++l) {
+            const Node& group = m_Nodes[m_Leaves[l]];
+
+            // Cells well separated from the whole leaf act as point masses
+            list.Clear();
+            for (uint32_t n = 0; n < m_Nodes.size();) {
+                const Node& node = m_Nodes[n];
+                Vec3f size = node.max - node.min;
+                float width = std::max(std::max(size.x, size.y), size.z);
+                if (width * width < thetaSquared * DistanceSquared(node.center, group.min, group.max)) {
+                    list.Add(node.center.x, node.center.y, node.center.z, node.mass);
+                    n = node.skip;
+                } else if (node.count > 0) {
+                    for (uint32_t i = node.first; i < node.first + node.count; ++i) {
+                        list.Add(m_BodyX[i], m_BodyY[i], m_BodyZ[i], m_BodyMass[i]);
+                    }
+                    n = node.skip;
+                } else {
+                    ++n;
+                }
+            }
+            list.Pad(FloatV::Width);
+
+            // F = kr m_i m_j d / |d|^2; massless padding and the body itself
+            // (d = 0) contribute nothing
+            const FloatV eps = FloatV::Broadcast(epsilon);
+            for (uint32_t i = group.first; i < group.first + group.count; ++i) {
+                FloatV px = FloatV::Broadcast(m_BodyX[i]);
+                FloatV py = FloatV::Broadcast(m_BodyY[i]);
+                FloatV pz = FloatV::Broadcast(m_BodyZ[i]);
+                FloatV fx = FloatV::Broadcast(0.0f), fy = fx, fz = fx;
+                for (size_t j = 0; j < list.x.size(); j += FloatV::Width) {
+                    FloatV dx = px - FloatV::Load(&list.x[j]);
+                    FloatV dy = py - FloatV::Load(&list.y[j]);
+                    FloatV dz = pz - FloatV::Load(&list.z[j]);
+                    FloatV d2 = simd::MulAdd(dx, dx, simd::MulAdd(dy, dy, simd::MulAdd(dz, dz, eps)));
+                    FloatV s = FloatV::Load(&list.mass[j]) / d2;
+                    fx = simd::MulAdd(dx, s, fx);
+                    fy = simd::MulAdd(dy, s, fy);
+                    fz = simd::MulAdd(dz, s, fz);
+                }
+                fx.Store(lanes[0]);
+                fy.Store(lanes[1]);
+                fz.Store(lanes[2]);
+                Vec3f force;
+                for (int k = 0; k < FloatV::Width; ++k) {
+                    force += Vec3f(lanes[0][k], lanes[1][k], lanes[2][k]);
+                }
+                m_Forces[m_Order[i]] = force * (repulsion * m_BodyMass[i]);
+            }
+        }
+    });
+}
+
+void GraphLayout::ComputeAttraction(const Graph& graph, const std::vector<Vec3f>& positions) {
+    const std::vector<float>* weights = nullptr;
+    if (!m_Settings.weightAttribute.empty()) {
+        weights = graph.GetAttributes(GraphElement::Edge).Get<float>(m_Settings.weightAttribute);
+    }
+    const float attraction = m_Settings.attraction;
+    const float gravity = m_Settings.gravity;
+
+    if (!graph.IsDirected()) {
+        // Every edge is listed at both ends, so each vertex gathers its own
+        const std::vector<uint32_t>& neighbors = graph.GetNeighbors();
+        const std::vector<uint32_t>& slotEdges = graph.GetSlotEdges();
+        const std::vector<uint32_t>& pendingNext = graph.GetPendingNext();
+        parallel::For(positions.size(), GrainSize, [&](size_t begin, size_t end) {
+            for (size_t v = begin; v < end; ++v) {
+                Graph::Adjacency adjacency = graph.GetAdjacency(uint32_t(v));
+                Vec3f force;
+                for (uint32_t slot = adjacency.begin; slot < adjacency.end; ++slot) {
+                    float w = weights ? (*weights)[slotEdges[slot]] : 1.0f;
+                    force += (positions[neighbors[slot]] - positions[v]) * w;
+                }
+                for (uint32_t slot = adjacency.pendingHead; slot != INVALID_INDEX; slot = pendingNext[slot]) {
+                    float w = weights ? (*weights)[graph.GetPendingEdges()[slot]] : 1.0f;
+                    force += (positions[graph.GetPendingNeighbors()[slot]] - positions[v]) * w;
+                }
+                m_Forces[v] += force * attraction;
+            }
+        });
+    } else {
+        const std::vector<uint32_t>& edgeVertices = graph.GetEdgeVertices();
+        for (size_t e = 0; e < graph.GetEdgeCount(); ++e) {
+            uint32_t a = edgeVertices[2 * e], b = edgeVertices[2 * e + 1];
+            Vec3f force = (positions[b] - positions[a]) * (attraction * (weights ? (*weights)[e] : 1.0f));
+            m_Forces[a] += force;
+            m_Forces[b] -= force;
+        }
+    }
+
+    parallel::For(positions.size(), GrainSize, [&](size_t begin, size_t end) {
+        for (size_t v = begin; v < end; ++v) {
+            float distance = positions[v].Length();
+            if (distance > 0.0f) {
+                m_Forces[v] -= positions[v] * (gravity * m_Mass[v] / distance);
+            }
+        }
+    });
+}
+
+void GraphLayout::Move(std::vector<Vec3f>& positions) {
+    const size_t count = positions.size();
+    if (m_Settings.planar) {
+        for (Vec3f& force : m_Forces) {
+            force.y = 0.0f;
+        }
+    }
+
+    // Swinging (force changing direction) against traction (force holding
+    // steady), mass weighted, set the global speed
+    size_t chunkCount = parallel::ChunkCount(count, GrainSize);
+    size_t chunkSize = chunkCount ? (count + chunkCount - 1) / chunkCount : 0;
+    std::vector<double> chunkSwing(chunkCount, 0.0), chunkTraction(chunkCount, 0.0);
+    parallel::ForChunks(chunkCount, [&](size_t chunk) {
+        size_t end = std::min(count, (chunk + 1) * chunkSize);
+        double swing = 0.0, traction = 0.0;
+        for (size_t v = chunk * chunkSize; v < end; ++v) {
+            swing += m_Mass[v] * (m_Forces[v] - m_PreviousForces[v]).Length();
+            traction += 0.5 * m_Mass[v] * (m_Forces[v] + m_PreviousForces[v]).Length();
+        }
+        chunkSwing[chunk] = swing;
+        chunkTraction[chunk] = traction;
+    });
+    double swing = std::accumulate(chunkSwing.begin(), chunkSwing.end(), 0.0);
+    double traction = std::accumulate(chunkTraction.begin(), chunkTraction.end(), 0.0);
+
+    if (swing > 0.0 && traction > 0.0) {
+        // The adaptive speed of the reference ForceAtlas2 implementation
+        double n = double(count);
+        double estimatedTolerance = 0.05 * std::sqrt(n);
+        double jitter = m_Settings.tolerance
+            * std::max(std::sqrt(estimatedTolerance), std::min(10.0, estimatedTolerance * traction / (n * n)));
+        const double minEfficiency = 0.05;
+        if (swing / traction > 2.0) {
+            if (m_SpeedEfficiency > minEfficiency) {
+                m_SpeedEfficiency *= 0.5f;
+            }
+            jitter = std::max(jitter, double(m_Settings.tolerance));
+        }
+        double target = jitter * m_SpeedEfficiency * traction / swing;
+        if (swing > jitter * traction) {
+            if (m_SpeedEfficiency > minEfficiency) {
+                m_SpeedEfficiency *= 0.7f;
+            }
+        } else if (m_Speed < 1000.0f) {
+            m_SpeedEfficiency *= 1.3f;
+        }
+        m_Speed = float(m_Speed + std::min(target - m_Speed, 0.5 * m_Speed));
+    }
+
+    const float speed = m_Speed;
+    parallel::For(count, GrainSize, [&](size_t begin, size_t end) {
+        for (size_t v = begin; v < end; ++v) {
+            float vertexSwing = m_Mass[v] * (m_Forces[v] - m_PreviousForces[v]).Length();
+            positions[v] += m_Forces[v] * (speed / (1.0f + std::sqrt(speed * vertexSwing)));
+        }
+    });
+    std::swap(m_Forces, m_PreviousForces);
+}
+
+bool GraphLayout::Step(Graph& graph, int iterations) {
+    if (graph.GetVertexCount() == 0) {
+        return true;
+    }
+    Prepare(graph);
+    std::vector<Vec3f>& positions = graph.GetPositions();
+    for (int i = 0; i < iterations; ++i) {
+        BuildTree(positions);
+        ComputeRepulsion();
+        ComputeAttraction(graph, positions);
+        Move(positions);
+        ++m_Iterations;
+    }
+    graph.MarkAllDirty();
+    return true;
+}
+
+} // namespace alice2
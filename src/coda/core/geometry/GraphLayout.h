@@ -0,0 +1,89 @@
+#pragma once
+
+#include "Graph.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace alice2 {
+
+struct GraphLayoutSettings {
+    float repulsion = 1.0f;  // Between every pair, scaled by (degree + 1) of both
+    float attraction = 1.0f; // Along edges, linear in length
+    float gravity = 1.0f;    // Towards the origin, independent of distance
+    float theta = 1.2f;      // Barnes-Hut opening ratio: cell size / distance
+    float tolerance = 1.0f;  // Jitter tolerance of the adaptive speed
+    bool planar = true;      // Lay out in the XZ plane
+    std::string weightAttribute; // Optional float edge layer scaling attraction
+};
+
+// ForceAtlas2-style force-directed layout (Jacomy et al. 2014) with
+// Barnes-Hut repulsion. Every iteration builds an octree over the vertices
+// in Morton order (top levels split serially, subtrees in parallel) and
+// walks it once per leaf: cells far from the leaf's bounds enter its
+// interaction list as a single mass, near ones as their vertices. The
+// leaf's vertices then sum their list with SIMD, so repulsion costs
+// O(n log n) and vectorises over the sources. Step sizes adapt per vertex
+// from how much its force swings between iterations.
+//
+// Step() writes the graph positions and marks them dirty, so an ObjGraph
+// drawing the graph streams the layout as it runs.
+class GraphLayout {
+public:
+    struct Node {
+        Vec3f center;   // Centre of mass
+        float mass;
+        Vec3f min;
+        uint32_t skip;  // First node after this subtree
+        Vec3f max;
+        uint32_t first; // Leaf: first body in Morton order
+        uint32_t count; // Leaf: body count; 0 for interior nodes
+    };
+
+    static constexpr uint32_t LeafSize = 16;
+
+    explicit GraphLayout(const GraphLayoutSettings& settings = GraphLayoutSettings()) : m_Settings(settings) {}
+
+    void SetSettings(const GraphLayoutSettings& settings) { m_Settings = settings; }
+    const GraphLayoutSettings& GetSettings() const { return m_Settings; }
+
+    // Runs iterations and writes the positions back. Coincident starting
+    // positions are spread over a disc (or ball) first. State resets when
+    // the graph's topology changes.
+    bool Step(Graph& graph, int iterations = 1);
+    void Reset();
+
+    size_t GetIterationCount() const { return m_Iterations; }
+    float GetSpeed() const { return m_Speed; }
+    // Tree of the last iteration
+    const std::vector<Node>& GetNodes() const { return m_Nodes; }
+
+private:
+    GraphLayoutSettings m_Settings;
+
+    const Graph* m_Graph = nullptr;
+    uint64_t m_TopologyVersion = 0;
+    size_t m_Iterations = 0;
+    float m_Speed = 1.0f;
+    float m_SpeedEfficiency = 1.0f;
+
+    std::vector<float> m_Mass;       // Degree + 1
+    std::vector<Vec3f> m_Forces;
+    std::vector<Vec3f> m_PreviousForces;
+
+    // Octree over the bodies in Morton order, SoA for the force kernel
+    std::vector<Node> m_Nodes;
+    std::vector<uint32_t> m_Leaves;
+    std::vector<uint32_t> m_Order;   // Body -> vertex
+    std::vector<float> m_BodyX, m_BodyY, m_BodyZ, m_BodyMass;
+
+    void Prepare(Graph& graph);
+    void BuildTree(const std::vector<Vec3f>& positions);
+    void ComputeRepulsion();
+    void ComputeAttraction(const Graph& graph, const std::vector<Vec3f>& positions);
+    void Move(std::vector<Vec3f>& positions);
+};
+
+} // namespace alice2
@@ -0,0 +1,244 @@
+#include "HeatGeodesics.h"
+#include "../utilities/Parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace alice2 {
+
+namespace {
+
+constexpr size_t GrainSize = 4096;
+// Right-hand sides per blocked solve; wider blocks stop paying off once a
+// row of the interleaved solution no longer fits a cache line or two
+constexpr size_t BlockSize = 8;
+
+// system = scale * L + massScale * M in the pattern of L; vertices without
+// mass (isolated) get a unit diagonal so the factorisation stays definite
+void AssembleSystem(const MeshLaplacian& laplacian, double scale, double massScale, sparse::CsrMatrix& system) {
+    const std::vector<double>& source = laplacian.GetMatrix().GetValues();
+    const std::vector<double>& mass = laplacian.GetMass();
+    const std::vector<uint32_t>& diagonal = laplacian.GetDiagonalPositions();
+    std::vector<double>& values = system.GetValues();
+    parallel::For(values.size(), GrainSize, [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; ++k) {
+            values[k] = scale * source[k];
+        }
+    });
+    for (size_t v = 0; v < mass.size(); ++v) {
+        values[diagonal[v]] += mass[v] > 0.0 ? massScale * mass[v] : 1.0;
+    }
+}
+
+} // namespace
+
+void HeatGeodesics::SetTimeScale(float timeScale) {
+    if (timeScale != m_TimeScale) {
+        m_TimeScale = timeScale;
+        // Same pattern, new values: the symbolic analysis survives
+        m_EditCursor = ~uint64_t(0);
+    }
+}
+
+bool HeatGeodesics::Prepare(const Mesh& mesh) {
+    bool sameTopology = m_Prepared && m_Mesh == &mesh && m_TopologyVersion == mesh.GetTopologyVersion();
+    if (sameTopology && m_EditCursor == mesh.GetEditCursor()) {
+        return true;
+    }
+    m_Prepared = false;
+    if (!m_Laplacian.Update(mesh)) {
+        std::cerr << "HeatGeodesics: needs a triangle mesh" << std::endl;
+        return false;
+    }
+
+    if (!sameTopology) {
+        BuildTopology(mesh);
+        m_HeatSystem = m_Laplacian.GetMatrix();
+        m_PoissonSystem = m_Laplacian.GetMatrix();
+        // Both systems share the pattern of L, so one ordering serves both
+        if (!m_Heat.Analyze(m_HeatSystem)) {
+            return false;
+        }
+        m_Poisson = m_Heat;
+    }
+    BuildGeometry(mesh);
+
+    // Mean edge length sets the diffusion time and the Poisson regulariser
+    const std::vector<Vec3f>& positions = mesh.GetPositions();
+    size_t edgeCount = mesh.GetHalfEdgeNext().size() / 2;
+    double length = 0.0;
+    for (size_t e = 0; e < edgeCount; ++e) {
+        uint32_t h = static_cast<uint32_t>(2 * e);
+        length += (positions[mesh.Target(h)] - positions[mesh.Target(h ^ 1)]).Length();
+    }
+    double h = edgeCount > 0 ? length / double(edgeCount) : 1.0;
+    if (h <= 0.0) {
+        h = 1.0;
+    }
+
+    // Heat: (M + t L) u = delta. Poisson: (L + eps M) phi = div X, where the
+    // tiny mass term pins the constant null space of the pure Neumann problem
+    AssembleSystem(m_Laplacian, double(m_TimeScale) * h * h, 1.0, m_HeatSystem);
+    AssembleSystem(m_Laplacian, 1.0, 1e-8 / (h * h), m_PoissonSystem);
+    if (!m_Heat.Factorize(m_HeatSystem) || !m_Poisson.Factorize(m_PoissonSystem)) {
+        std::cerr << "HeatGeodesics: factorisation failed" << std::endl;
+        return false;
+    }
+
+    m_Mesh = &mesh;
+    m_TopologyVersion = mesh.GetTopologyVersion();
+    m_EditCursor = mesh.GetEditCursor();
+    m_Prepared = true;
+    return true;
+}
+
+void HeatGeodesics::BuildTopology(const Mesh& mesh) {
+    uint32_t vertexCount = static_cast<uint32_t>(mesh.GetVertexCount());
+    size_t faceCount = mesh.GetFaceCount();
+    m_FaceVertices.resize(faceCount * 3);
+    m_CornerOffsets.assign(vertexCount + 1, 0);
+    for (size_t f = 0; f < faceCount; ++f) {
+        uint32_t h = mesh.FaceHalfEdge(static_cast<uint32_t>(f));
+        for (size_t k = 0; k < 3; ++k, h = mesh.Next(h)) {
+            m_FaceVertices[f * 3 + k] = mesh.Target(h);
+            ++m_CornerOffsets[mesh.Target(h) + 1];
+        }
+    }
+    for (uint32_t v = 0; v < vertexCount; ++v) {
+        m_CornerOffsets[v + 1] += m_CornerOffsets[v];
+    }
+    m_Corners.resize(faceCount * 3);
+    std::vector<uint32_t> cursor(m_CornerOffsets.begin(), m_CornerOffsets.end() - 1);
+    for (size_t c = 0; c < m_FaceVertices.size(); ++c) {
+        m_Corners[cursor[m_FaceVertices[c]]++] = static_cast<uint32_t>(c);
+    }
+}
+
+void HeatGeodesics::BuildGeometry(const Mesh& mesh) {
+    const std::vector<Vec3f>& positions = mesh.GetPositions();
+    size_t faceCount = m_FaceVertices.size() / 3;
+    m_CornerWeights.resize(faceCount * 3);
+    parallel::For(faceCount, GrainSize, [&](size_t begin, size_t end) {
+        for (size_t f = begin; f < end; ++f) {
+            const Vec3f& p0 = positions[m_FaceVertices[f * 3]];
+            const Vec3f& p1 = positions[m_FaceVertices[f * 3 + 1]];
+            const Vec3f& p2 = positions[m_FaceVertices[f * 3 + 2]];
+            Vec3f normal = (p1 - p0).Cross(p2 - p0);
+            float doubleArea = normal.Length();
+            if (doubleArea <= 0.0f) {
+                m_CornerWeights[f * 3] = m_CornerWeights[f * 3 + 1] = m_CornerWeights[f * 3 + 2] = Vec3f();
+                continue;
+            }
+            // Area times the gradient of corner k's hat function: N x e_k / 2
+            // with e_k the counter-clockwise edge opposite the corner
+            Vec3f n = normal * (0.5f / doubleArea);
+            m_CornerWeights[f * 3] = n.Cross(p2 - p1);
+            m_CornerWeights[f * 3 + 1] = n.Cross(p0 - p2);
+            m_CornerWeights[f * 3 + 2] = n.Cross(p1 - p0);
+        }
+    });
+}
+
+bool HeatGeodesics::Compute(const Mesh& mesh, const std::vector<uint32_t>& sources, std::vector<float>& distances) {
+    std::vector<std::vector<uint32_t>> sourceSets(1, sources);
+    std::vector<std::vector<float>> results;
+    if (!Compute(mesh, sourceSets, results)) {
+        return false;
+    }
+    distances = std::move(results[0]);
+    return true;
+}
+
+bool HeatGeodesics::Compute(const Mesh& mesh, const std::vector<std::vector<uint32_t>>& sourceSets,
+                            std::vector<std::vector<float>>& distances) {
+    size_t vertexCount = mesh.GetVertexCount();
+    for (const std::vector<uint32_t>& sources : sourceSets) {
+        if (sources.empty()) {
+            std::cerr << "HeatGeodesics: empty source set" << std::endl;
+            return false;
+        }
+        for (uint32_t source : sources) {
+            if (source >= vertexCount) {
+                std::cerr << "HeatGeodesics: source vertex " << source << " out of range" << std::endl;
+                return false;
+            }
+        }
+    }
+    if (!Prepare(mesh)) {
+        return false;
+    }
+
+    distances.resize(sourceSets.size());
+    for (size_t first = 0; first < sourceSets.size(); first += BlockSize) {
+        SolveBatch(sourceSets, distances, first, std::min(BlockSize, sourceSets.size() - first));
+    }
+    return true;
+}
+
+void HeatGeodesics::SolveBatch(const std::vector<std::vector<uint32_t>>& sourceSets,
+                               std::vector<std::vector<float>>& distances, size_t first, size_t count) {
+    size_t n = m_CornerOffsets.size() - 1;
+    size_t faceCount = m_FaceVertices.size() / 3;
+
+    // Heat from unit impulses at the sources, all sets in one solve
+    std::vector<double> rhs(n * count, 0.0), solution(n * count);
+    for (size_t r = 0; r < count; ++r) {
+        for (uint32_t source : sourceSets[first + r]) {
+            rhs[r * n + source] = 1.0;
+        }
+    }
+    m_Heat.Solve(rhs.data(), solution.data(), count);
+
+    // Unit field against the heat gradient per face, then its integrated
+    // divergence gathered per vertex over the corner lists (no atomics)
+    std::vector<Vec3f> field(faceCount);
+    for (size_t r = 0; r < count; ++r) {
+        const double* u = solution.data() + r * n;
+        parallel::For(faceCount, GrainSize, [&](size_t begin, size_t end) {
+            for (size_t f = begin; f < end; ++f) {
+                // In double: far from the sources u decays below float range
+                double gx = 0.0, gy = 0.0, gz = 0.0;
+                for (size_t k = 0; k < 3; ++k) {
+                    const Vec3f& w = m_CornerWeights[f * 3 + k];
+                    double value = u[m_FaceVertices[f * 3 + k]];
+                    gx += w.x * value;
+                    gy += w.y * value;
+                    gz += w.z * value;
+                }
+                double length = std::sqrt(gx * gx + gy * gy + gz * gz);
+                double scale = length > 0.0 ? -1.0 / length : 0.0;
+                field[f] = Vec3f(float(gx * scale), float(gy * scale), float(gz * scale));
+            }
+        });
+        double* b = rhs.data() + r * n;
+        parallel::For(n, GrainSize, [&](size_t begin, size_t end) {
+            for (size_t v = begin; v < end; ++v) {
+                double sum = 0.0;
+                for (uint32_t c = m_CornerOffsets[v]; c < m_CornerOffsets[v + 1]; ++c) {
+                    uint32_t corner = m_Corners[c];
+                    sum += double(m_CornerWeights[corner].Dot(field[corner / 3]));
+                }
+                b[v] = sum;
+            }
+        });
+    }
+    m_Poisson.Solve(rhs.data(), solution.data(), count);
+
+    // Shift so the sources sit at zero on average
+    for (size_t r = 0; r < count; ++r) {
+        const double* phi = solution.data() + r * n;
+        double shift = 0.0;
+        for (uint32_t source : sourceSets[first + r]) {
+            shift += phi[source];
+        }
+        shift /= double(sourceSets[first + r].size());
+        std::vector<float>& result = distances[first + r];
+        result.resize(n);
+        for (size_t v = 0; v < n; ++v) {
+            result[v] = float(phi[v] - shift);
+        }
+    }
+}
+
+} // namespace alice2
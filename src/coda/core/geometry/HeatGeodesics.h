@@ -0,0 +1,65 @@
+#pragma once
+
+#include "Mesh.h"
+#include "MeshLaplacian.h"
+#include "../utilities/Sparse.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace alice2 {
+
+// Geodesic distance on triangle meshes by the heat method (Crane et al.
+// 2013): diffuse heat from the sources for a short time t, normalise its
+// gradient, and integrate the resulting unit field back with a Poisson
+// solve. Both systems, (M + t L) and L, are factored once per mesh; after
+// vertex edits only the numeric factorisations are redone. A source set
+// then costs two back-substitutions plus parallel gradient and divergence
+// passes, and batches share one traversal of each factor.
+class HeatGeodesics {
+public:
+    // t = timeScale * h^2 with h the mean edge length
+    explicit HeatGeodesics(float timeScale = 1.0f) : m_TimeScale(timeScale) {}
+
+    void SetTimeScale(float timeScale);
+    float GetTimeScale() const { return m_TimeScale; }
+
+    // Builds or refreshes the operators and factorisations; Compute() calls
+    // it, so this only moves the cost ahead of the first query
+    bool Prepare(const Mesh& mesh);
+
+    // Distance of every vertex from the nearest source (0 at the sources).
+    // Vertices on components without a source get meaningless values.
+    bool Compute(const Mesh& mesh, const std::vector<uint32_t>& sources, std::vector<float>& distances);
+    // One distance field per source set
+    bool Compute(const Mesh& mesh, const std::vector<std::vector<uint32_t>>& sourceSets,
+                 std::vector<std::vector<float>>& distances);
+
+private:
+    float m_TimeScale;
+
+    const Mesh* m_Mesh = nullptr;
+    uint64_t m_TopologyVersion = 0;
+    uint64_t m_EditCursor = 0;
+    bool m_Prepared = false;
+
+    MeshLaplacian m_Laplacian;
+    sparse::CsrMatrix m_HeatSystem;
+    sparse::CsrMatrix m_PoissonSystem;
+    sparse::CholeskySolver m_Heat;
+    sparse::CholeskySolver m_Poisson;
+
+    std::vector<uint32_t> m_FaceVertices;   // 3 per face
+    std::vector<uint32_t> m_CornerOffsets;  // Per vertex, into m_Corners
+    std::vector<uint32_t> m_Corners;        // face * 3 + corner around each vertex
+    std::vector<Vec3f> m_CornerWeights;     // Area-weighted gradient of each corner's hat function
+
+    void BuildTopology(const Mesh& mesh);
+    void BuildGeometry(const Mesh& mesh);
+    // Sets [first, first + count) through one blocked solve per system
+    void SolveBatch(const std::vector<std::vector<uint32_t>>& sourceSets, std::vector<std::vector<float>>& distances,
+                    size_t first, size_t count);
+};
+
+} // namespace alice2
@@ -0,0 +1,551 @@
+#include "Isosurface.h"
+#include "../utilities/Parallel.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+namespace alice2 {
+
+namespace {
+
+constexpr int BrickSize = SparseScalarGrid::BrickSize;
+constexpr int CacheSize = BrickSize + 3; // Local points -1 .. BrickSize + 1
+constexpr int CacheVolume = CacheSize * CacheSize * CacheSize;
+constexpr uint32_t NotFound = ~uint32_t(0);
+constexpr int MaxCaseTriangles = 5;
+
+inline int CacheIndex(int x, int y, int z) {
+    return ((z + 1) * CacheSize + (y + 1)) * CacheSize + (x + 1);
+}
+
+inline int CellBit(int x, int y, int z) {
+    return (z * BrickSize + y) * BrickSize + x;
+}
+
+// Marching cubes cases, generated instead of tabulated. Corner c sits at
+// (c & 1, c >> 1 & 1, c >> 2 & 1); edge e runs along axis e / 4. Each face is
+// walked counter-clockwise seen from outside the cube and every crossing
+// where the walk enters the inside is joined to the next one where it
+// leaves. Ambiguous faces thereby always separate their inside corners,
+// the same decision from both cubes sharing the face, so surfaces are
+// closed; the segments chain into loops that are cut into triangles wound
+// towards the outside.
+struct CaseTable {
+    uint8_t edgeCorner[12];
+    uint8_t edgeAxis[12];
+    uint8_t triangleCount[256];
+    uint8_t triangles[256][MaxCaseTriangles * 3];
+
+    CaseTable() {
+        for (int e = 0; e < 12; ++e) {
+            int axis = e / 4, u = (axis + 1) % 3, v = (axis + 2) % 3;
+            edgeAxis[e] = uint8_t(axis);
+            edgeCorner[e] = uint8_t(((e & 1) << u) | (((e >> 1) & 1) << v));
+        }
+        auto edgeBetween = [](int c0, int c1) {
+            int axis = std::countr_zero(unsigned(c0 ^ c1));
+            int low = std::min(c0, c1), u = (axis + 1) % 3, v = (axis + 2) % 3;
+            return axis * 4 + ((low >> u) & 1) + 2 * ((low >> v) & 1);
+        };
+
+        // Faces of an edge: (axis, side) of its two other axes
+        auto shareFace = [&](int a, int b) {
+            for (int i = 1; i < 3; ++i) {
+                for (int j = 1; j < 3; ++j) {
+                    int axisA = (edgeAxis[a] + i) % 3, axisB = (edgeAxis[b] + j) % 3;
+                    if (axisA == axisB && ((edgeCorner[a] >> axisA) & 1) == ((edgeCorner[b] >> axisB) & 1)) {
+                        return true;
+                    }
+                }
+            }
+            return false;
+        };
+
+        const int square[4][2] = {{0, 0}, {1, 0}, {1, 1}, {0, 1}}; // CCW about +axis in (u, v)
+        for (int cube = 0; cube < 256; ++cube) {
+            int next[12];
+            std::fill(next, next + 12, -1);
+            for (int axis = 0; axis < 3; ++axis) {
+                int u = (axis + 1) % 3, v = (axis + 2) % 3;
+                for (int side = 0; side < 2; ++side) {
+                    int corners[4];
+                    for (int k = 0; k < 4; ++k) {
+                        int q = side ? k : (4 - k) % 4;
+                        corners[k] = (side << axis) | (square[q][0] << u) | (square[q][1] << v);
+                    }
+                    int crossings[4], count = 0;
+                    bool entering[4];
+                    for (int k = 0; k < 4; ++k) {
+                        int a = corners[k], b = corners[(k + 1) % 4];
+                        bool insideA = (cube >> a) & 1, insideB = (cube >> b) & 1;
+                        if (insideA != insideB) {
+                            crossings[count] = edgeBetween(a, b);
+                            entering[count++] = insideB;
+                        }
+                    }
+                    for (int k = 0; k < count; ++k) {
+                        if (entering[k]) {
+                            next[crossings[k]] = crossings[(k + 1) % count];
+                        }
+                    }
+                }
+            }
+
+            bool used[12] = {};
+            int count = 0;
+            for (int e = 0; e < 12; ++e) {
+                if (next[e] < 0 || used[e]) {
+                    continue;
+                }
+                int loop[12], length = 0;
+                for (int f = e; !used[f]; f = next[f]) {
+                    used[f] = true;
+                    loop[length++] = f;
+                }
+                // Clip ears whose new diagonal stays off the cube faces: a
+                // diagonal on a face would be repeated by the neighbouring
+                // cube and make the edge non-manifold
+                while (length >= 3 && count < MaxCaseTriangles) {
+                    int ear = 0;
+                    for (int k = 0; k < length && length > 3; ++k) {
+                        if (!shareFace(loop[(k + length - 1) % length], loop[(k + 1) % length])) {
+                            ear = k;
+                            break;
+                        }
+                    }
+                    triangles[cube][3 * count] = uint8_t(loop[(ear + length - 1) % length]);
+                    triangles[cube][3 * count + 1] = uint8_t(loop[ear]);
+                    triangles[cube][3 * count + 2] = uint8_t(loop[(ear + 1) % length]);
+                    ++count;
+                    std::copy(loop + ear + 1, loop + length, loop + ear);
+                    --length;
+                }
+            }
+            triangleCount[cube] = uint8_t(count);
+        }
+    }
+};
+
+const CaseTable& Cases() {
+    static const CaseTable table;
+    return table;
+}
+
+// Lattice adaptors. Both enumerate bricks in z-major order, find a brick's
+// index from its coordinates and gather its samples with a one-point apron
+// (two above) into a CacheSize^3 block; points [lo, hi) of the block exist.
+
+class DenseLattice {
+public:
+    explicit DenseLattice(const ScalarGrid& grid)
+        : m_Grid(grid),
+          m_Bricks{(grid.GetSizeX() + BrickSize - 1) / BrickSize, (grid.GetSizeY() + BrickSize - 1) / BrickSize,
+                   (grid.GetSizeZ() + BrickSize - 1) / BrickSize} {}
+
+    size_t GetBrickCount() const { return size_t(m_Bricks[0]) * m_Bricks[1] * m_Bricks[2]; }
+    void GetBrick(size_t brick, int* coordinates) const {
+        coordinates[0] = int(brick % m_Bricks[0]);
+        coordinates[1] = int((brick / m_Bricks[0]) % m_Bricks[1]);
+        coordinates[2] = int(brick / (size_t(m_Bricks[0]) * m_Bricks[1]));
+    }
+    uint32_t FindBrick(int bx, int by, int bz) const {
+        if (bx < 0 || by < 0 || bz < 0 || bx >= m_Bricks[0] || by >= m_Bricks[1] || bz >= m_Bricks[2]) {
+            return NotFound;
+        }
+        return uint32_t((size_t(bz) * m_Bricks[1] + by) * m_Bricks[0] + bx);
+    }
+    void GetLimits(const int* brick, int* lo, int* hi) const {
+        const int sizes[3] = {m_Grid.GetSizeX(), m_Grid.GetSizeY(), m_Grid.GetSizeZ()};
+        for (int a = 0; a < 3; ++a) {
+            lo[a] = brick[a] == 0 ? 0 : -1;
+            hi[a] = std::min(CacheSize - 1, sizes[a] - brick[a] * BrickSize);
+        }
+    }
+    // Apron points past the grid clamp to the border (gradients go one-sided)
+    void Gather(const int* brick, float* cache) const {
+        const int sx = m_Grid.GetSizeX(), sy = m_Grid.GetSizeY(), sz = m_Grid.GetSizeZ();
+        const float* values = m_Grid.GetValues().data();
+        const int x0 = brick[0] * BrickSize - 1;
+        if (x0 >= 0 && x0 + CacheSize <= sx) {
+            for (int z = -1; z < CacheSize - 1; ++z) {
+                int gz = std::clamp(brick[2] * BrickSize + z, 0, sz - 1);
+                for (int y = -1; y < CacheSize - 1; ++y) {
+                    int gy = std::clamp(brick[1] * BrickSize + y, 0, sy - 1);
+                    std::copy_n(values + (size_t(gz) * sy + gy) * sx + x0, CacheSize, cache + CacheIndex(-1, y, z));
+                }
+            }
+            return;
+        }
+        for (int z = -1; z < CacheSize - 1; ++z) {
+            int gz = std::clamp(brick[2] * BrickSize + z, 0, sz - 1);
+            for (int y = -1; y < CacheSize - 1; ++y) {
+                int gy = std::clamp(brick[1] * BrickSize + y, 0, sy - 1);
+                const float* row = values + (size_t(gz) * sy + gy) * sx;
+                float* out = cache + CacheIndex(-1, y, z);
+                for (int x = -1; x < CacheSize - 1; ++x) {
+                    *out++ = row[std::clamp(brick[0] * BrickSize + x, 0, sx - 1)];
+                }
+            }
+        }
+    }
+    uint64_t GetCellCount() const {
+        return uint64_t(m_Grid.GetSizeX() - 1) * (m_Grid.GetSizeY() - 1) * (m_Grid.GetSizeZ() - 1);
+    }
+    const Vec3f& GetOrigin() const { return m_Grid.GetOrigin(); }
+    float GetSpacing() const { return m_Grid.GetSpacing(); }
+
+private:
+    const ScalarGrid& m_Grid;
+    int m_Bricks[3];
+};
+
+// Visits the allocated bricks and their lower neighbours: a crossed edge
+// or cell has a corner in an allocated brick, so its owning brick (that of
+// its lowest point) is at most one below in each axis.
+class SparseLattice {
+public:
+    explicit SparseLattice(const SparseScalarGrid& grid) : m_Grid(grid) {
+        m_Keys.reserve(grid.GetBrickCount() * 8);
+        for (uint32_t b = 0; b < grid.GetBrickCount(); ++b) {
+            int bx, by, bz;
+            grid.GetBrickCoordinates(b, bx, by, bz);
+            for (int d = 0; d < 8; ++d) {
+                m_Keys.push_back(SparseScalarGrid::BrickKey(bx - (d & 1), by - ((d >> 1) & 1), bz - ((d >> 2) & 1)));
+            }
+        }
+        // Keys pack x in the low bits, so sorted keys are z-major
+        std::sort(m_Keys.begin(), m_Keys.end());
+        m_Keys.erase(std::unique(m_Keys.begin(), m_Keys.end()), m_Keys.end());
+    }
+
+    size_t GetBrickCount() const { return m_Keys.size(); }
+    void GetBrick(size_t brick, int* coordinates) const {
+        const int64_t bias = int64_t(1) << 20;
+        for (int a = 0; a < 3; ++a) {
+            coordinates[a] = int(int64_t((m_Keys[brick] >> (21 * a)) & ((uint64_t(1) << 21) - 1)) - bias);
+        }
+    }
+    uint32_t FindBrick(int bx, int by, int bz) const {
+        uint64_t key = SparseScalarGrid::BrickKey(bx, by, bz);
+        auto it = std::lower_bound(m_Keys.begin(), m_Keys.end(), key);
+        return it != m_Keys.end() && *it == key ? uint32_t(it - m_Keys.begin()) : NotFound;
+    }
+    void GetLimits(const int*, int* lo, int* hi) const {
+        for (int a = 0; a < 3; ++a) {
+            lo[a] = -1;
+            hi[a] = CacheSize - 1;
+        }
+    }
+    // Copies each of the 27 neighbouring bricks' overlap with the block
+    void Gather(const int* brick, float* cache) const {
+        const int ranges[3][2] = {{-1, 0}, {0, BrickSize}, {BrickSize, CacheSize - 1}};
+        for (int dz = -1; dz <= 1; ++dz) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    uint32_t source = m_Grid.FindBrick(brick[0] + dx, brick[1] + dy, brick[2] + dz);
+                    const float* values = source != NotFound ? m_Grid.GetBrickValues(source) : nullptr;
+                    float fill = values ? 0.0f : m_Grid.GetFill(brick[0] + dx, brick[1] + dy, brick[2] + dz);
+                    for (int z = ranges[dz + 1][0]; z < ranges[dz + 1][1]; ++z) {
+                        for (int y = ranges[dy + 1][0]; y < ranges[dy + 1][1]; ++y) {
+                            float* out = cache + CacheIndex(0, y, z);
+                            for (int x = ranges[dx + 1][0]; x < ranges[dx + 1][1]; ++x) {
+                                out[x] = values ? values[CellBit(x - dx * BrickSize, y - dy * BrickSize,
+                                                                 z - dz * BrickSize)]
+                                                : fill;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+    uint64_t GetCellCount() const { return uint64_t(m_Keys.size()) * SparseScalarGrid::BrickVolume; }
+    const Vec3f& GetOrigin() const { return m_Grid.GetOrigin(); }
+    float GetSpacing() const { return m_Grid.GetSpacing(); }
+
+private:
+    const SparseScalarGrid& m_Grid;
+    std::vector<uint64_t> m_Keys;
+};
+
+inline Vec3f Gradient(const float* cache, int x, int y, int z) {
+    int i = CacheIndex(x, y, z);
+    return Vec3f(cache[i + 1] - cache[i - 1], cache[i + CacheSize] - cache[i - CacheSize],
+                 cache[i + CacheSize * CacheSize] - cache[i - CacheSize * CacheSize]);
+}
+
+} // namespace
+
+template <typename Lattice>
+bool Isosurface::Run(const Lattice& lattice, float isoValue, IsosurfaceMethod method) {
+    const CaseTable& cases = Cases();
+    const bool dual = method == IsosurfaceMethod::SurfaceNets;
+    const size_t brickCount = lattice.GetBrickCount();
+    const int axisStride[3] = {1, CacheSize, CacheSize * CacheSize};
+    m_Bricks.resize(brickCount);
+    m_CellCount = lattice.GetCellCount();
+
+    // Inside (below isoValue) flags of a gathered block. Returns false early
+    // when the whole block, apron included, is on one side of the surface.
+    auto classify = [&](const float* cache, uint8_t* inside) {
+        const float iso = isoValue; // A local, so byte stores cannot alias it
+        int count = 0;
+        for (int i = 0; i < CacheVolume; ++i) {
+            count += cache[i] < iso;
+        }
+        if (count == 0 || count == CacheVolume) {
+            return false;
+        }
+        for (int i = 0; i < CacheVolume; ++i) {
+            inside[i] = cache[i] < iso;
+        }
+        return true;
+    };
+    // Case index of the cell at local (x, y, z)
+    auto cellCase = [&](const uint8_t* inside, int x, int y, int z) {
+        const uint8_t* base = inside + CacheIndex(x, y, z);
+        const int dy = CacheSize, dz = CacheSize * CacheSize;
+        return base[0] | base[1] << 1 | base[dy] << 2 | base[dy + 1] << 3 | base[dz] << 4 | base[dz + 1] << 5
+             | base[dz + dy] << 6 | base[dz + dy + 1] << 7;
+    };
+
+    // Pass 1: mark the vertices each brick owns and count its triangles.
+    // Bricks the surface does not reach are skipped after classification.
+    parallel::For(brickCount, 8, [&](size_t begin, size_t end) {
+        std::vector<float> cache(CacheVolume);
+        std::vector<uint8_t> inside(CacheVolume);
+        for (size_t b = begin; b < end; ++b) {
+            int brick[3], lo[3], hi[3];
+            lattice.GetBrick(b, brick);
+            lattice.GetLimits(brick, lo, hi);
+            lattice.Gather(brick, cache.data());
+            Brick& state = m_Bricks[b];
+            std::fill(state.bits, state.bits + 24, 0);
+            std::fill(state.prefix, state.prefix + 24, 0);
+            state.vertexCount = state.triangleCount = 0;
+            if (!classify(cache.data(), inside.data())) {
+                continue;
+            }
+            uint32_t triangles = 0;
+
+            for (int z = 0; z < std::min(BrickSize, hi[2]); ++z) {
+                for (int y = 0; y < std::min(BrickSize, hi[1]); ++y) {
+                    for (int x = 0; x < std::min(BrickSize, hi[0]); ++x) {
+                        int p[3] = {x, y, z};
+                        int i = CacheIndex(x, y, z);
+                        bool cell = x + 1 < hi[0] && y + 1 < hi[1] && z + 1 < hi[2];
+                        if (dual) {
+                            int index = cell ? cellCase(inside.data(), x, y, z) : 0;
+                            if (index != 0 && index != 255) {
+                                int bit = CellBit(x, y, z);
+                                state.bits[bit >> 6] |= uint64_t(1) << (bit & 63);
+                            }
+                        } else if (cell) {
+                            triangles += cases.triangleCount[cellCase(inside.data(), x, y, z)];
+                        }
+                        for (int a = 0; a < 3; ++a) {
+                            if (p[a] + 1 >= hi[a] || inside[i + axisStride[a]] == inside[i]) {
+                                continue;
+                            }
+                            if (!dual) {
+                                int bit = CellBit(x, y, z) * 3 + a;
+                                state.bits[bit >> 6] |= uint64_t(1) << (bit & 63);
+                                continue;
+                            }
+                            // A quad needs all four cells around the edge
+                            int u = (a + 1) % 3, v = (a + 2) % 3;
+                            if (p[u] - 1 >= lo[u] && p[u] + 1 < hi[u] && p[v] - 1 >= lo[v] && p[v] + 1 < hi[v]) {
+                                triangles += 2;
+                            }
+                        }
+                    }
+                }
+            }
+            uint32_t count = 0;
+            for (int w = 0; w < 24; ++w) {
+                state.prefix[w] = uint16_t(count);
+                count += uint32_t(std::popcount(state.bits[w]));
+            }
+            state.vertexCount = count;
+            state.triangleCount = triangles;
+        }
+    });
+
+    uint64_t vertexTotal = 0, triangleTotal = 0;
+    for (Brick& state : m_Bricks) {
+        state.vertexBase = vertexTotal;
+        state.triangleBase = triangleTotal;
+        vertexTotal += state.vertexCount;
+        triangleTotal += state.triangleCount;
+    }
+    if (vertexTotal > std::numeric_limits<uint32_t>::max()) {
+        std::cerr << "Isosurface: " << vertexTotal << " vertices exceed 32-bit indices" << std::endl;
+        return false;
+    }
+    m_Positions.resize(vertexTotal);
+    m_Normals.resize(vertexTotal);
+    m_Triangles.resize(triangleTotal * 3);
+
+    // Pass 2: write vertices at brick base + rank and triangles at the brick
+    // triangle base; neighbours' vertex indices come from their masks
+    const Vec3f origin = lattice.GetOrigin();
+    const float spacing = lattice.GetSpacing();
+    parallel::For(brickCount, 8, [&](size_t begin, size_t end) {
+        std::vector<float> cache(CacheVolume);
+        std::vector<uint8_t> inside(CacheVolume);
+        for (size_t b = begin; b < end; ++b) {
+            const Brick& state = m_Bricks[b];
+            if (state.vertexCount == 0 && state.triangleCount == 0) {
+                continue;
+            }
+            int brick[3], lo[3], hi[3];
+            lattice.GetBrick(b, brick);
+            lattice.GetLimits(brick, lo, hi);
+            lattice.Gather(brick, cache.data());
+            classify(cache.data(), inside.data());
+            const Vec3f corner = origin + Vec3f(float(brick[0]), float(brick[1]), float(brick[2])) * (spacing * BrickSize);
+
+            // Neighbour bricks holding vertices this brick's triangles use:
+            // above for marching cubes edges, below for surface nets cells
+            const Brick* neighbours[8];
+            for (int d = 0; d < 8; ++d) {
+                int sign = dual ? -1 : 1;
+                uint32_t index = lattice.FindBrick(brick[0] + sign * (d & 1), brick[1] + sign * ((d >> 1) & 1),
+                                                   brick[2] + sign * ((d >> 2) & 1));
+                neighbours[d] = index != NotFound ? &m_Bricks[index] : nullptr;
+            }
+            // Vertex index of bit in the brick at local offset d (local
+            // coordinates one past the brick select the neighbour)
+            auto vertexIndex = [&](int d, int bit) {
+                const Brick& owner = *neighbours[d];
+                uint64_t below = owner.bits[bit >> 6] & ((uint64_t(1) << (bit & 63)) - 1);
+                return uint32_t(owner.vertexBase + owner.prefix[bit >> 6] + std::popcount(below));
+            };
+
+            uint64_t vertex = state.vertexBase;
+            for (int w = 0; w < 24; ++w) {
+                for (uint64_t word = state.bits[w]; word; word &= word - 1) {
+                    int bit = w * 64 + std::countr_zero(word);
+                    Vec3f local, gradient;
+                    if (!dual) {
+                        int point = bit / 3, a = bit % 3;
+                        int p[3] = {point % BrickSize, (point / BrickSize) % BrickSize, point / (BrickSize * BrickSize)};
+                        int i = CacheIndex(p[0], p[1], p[2]);
+                        float v0 = cache[i], v1 = cache[i + axisStride[a]];
+                        float t = (isoValue - v0) / (v1 - v0);
+                        float q[3] = {float(p[0]), float(p[1]), float(p[2])};
+                        q[a] += t;
+                        local = Vec3f(q[0], q[1], q[2]);
+                        int n[3] = {p[0], p[1], p[2]};
+                        ++n[a];
+                        gradient = Gradient(cache.data(), p[0], p[1], p[2]) * (1.0f - t)
+                                 + Gradient(cache.data(), n[0], n[1], n[2]) * t;
+                    } else {
+                        // Mass point of the cell's edge crossings, with the
+                        // trilinear gradient there
+                        int x = bit % BrickSize, y = (bit / BrickSize) % BrickSize, z = bit / (BrickSize * BrickSize);
+                        float sum[3] = {0.0f, 0.0f, 0.0f};
+                        int crossings = 0;
+                        for (int e = 0; e < 12; ++e) {
+                            int c = cases.edgeCorner[e], a = cases.edgeAxis[e];
+                            int i = CacheIndex(x + (c & 1), y + ((c >> 1) & 1), z + ((c >> 2) & 1));
+                            float v0 = cache[i], v1 = cache[i + axisStride[a]];
+                            if ((v0 < isoValue) == (v1 < isoValue)) {
+                                continue;
+                            }
+                            float q[3] = {float(c & 1), float((c >> 1) & 1), float((c >> 2) & 1)};
+                            q[a] += (isoValue - v0) / (v1 - v0);
+                            sum[0] += q[0];
+                            sum[1] += q[1];
+                            sum[2] += q[2];
+                            ++crossings;
+                        }
+                        float f[3] = {sum[0] / crossings, sum[1] / crossings, sum[2] / crossings};
+                        local = Vec3f(x + f[0], y + f[1], z + f[2]);
+                        for (int c = 0; c < 8; ++c) {
+                            float weight = ((c & 1) ? f[0] : 1.0f - f[0]) * (((c >> 1) & 1) ? f[1] : 1.0f - f[1])
+                                         * (((c >> 2) & 1) ? f[2] : 1.0f - f[2]);
+                            gradient += Gradient(cache.data(), x + (c & 1), y + ((c >> 1) & 1), z + ((c >> 2) & 1))
+                                      * weight;
+                        }
+                    }
+                    m_Positions[vertex] = corner + local * spacing;
+                    m_Normals[vertex] = gradient.Normalize();
+                    ++vertex;
+                }
+            }
+
+            uint32_t* out = m_Triangles.data() + state.triangleBase * 3;
+            for (int z = 0; z < std::min(BrickSize, hi[2]); ++z) {
+                for (int y = 0; y < std::min(BrickSize, hi[1]); ++y) {
+                    for (int x = 0; x < std::min(BrickSize, hi[0]); ++x) {
+                        if (!dual) {
+                            if (x + 1 >= hi[0] || y + 1 >= hi[1] || z + 1 >= hi[2]) {
+                                continue;
+                            }
+                            int index = cellCase(inside.data(), x, y, z);
+                            for (int k = 0; k < 3 * cases.triangleCount[index]; ++k) {
+                                int e = cases.triangles[index][k], c = cases.edgeCorner[e];
+                                int p[3] = {x + (c & 1), y + ((c >> 1) & 1), z + ((c >> 2) & 1)};
+                                int d = (p[0] >> 3) | ((p[1] >> 3) << 1) | ((p[2] >> 3) << 2);
+                                *out++ = vertexIndex(d, CellBit(p[0] & 7, p[1] & 7, p[2] & 7) * 3 + cases.edgeAxis[e]);
+                            }
+                            continue;
+                        }
+                        int p[3] = {x, y, z};
+                        int i = CacheIndex(x, y, z);
+                        for (int a = 0; a < 3; ++a) {
+                            int u = (a + 1) % 3, v = (a + 2) % 3;
+                            if (p[a] + 1 >= hi[a] || inside[i + axisStride[a]] == inside[i]
+                                || p[u] - 1 < lo[u] || p[u] + 1 >= hi[u] || p[v] - 1 < lo[v] || p[v] + 1 >= hi[v]) {
+                                continue;
+                            }
+                            // Cells p, p - u, p - u - v, p - v circle the edge
+                            // counter-clockwise about +a
+                            uint32_t quad[4];
+                            const int offsets[4][2] = {{0, 0}, {1, 0}, {1, 1}, {0, 1}};
+                            for (int k = 0; k < 4; ++k) {
+                                int q[3] = {x, y, z};
+                                q[u] -= offsets[k][0];
+                                q[v] -= offsets[k][1];
+                                int d = (q[0] < 0) | ((q[1] < 0) << 1) | ((q[2] < 0) << 2);
+                                quad[k] = vertexIndex(d, CellBit(q[0] & 7, q[1] & 7, q[2] & 7));
+                            }
+                            if (!inside[i]) {
+                                std::swap(quad[1], quad[3]);
+                            }
+                            *out++ = quad[0];
+                            *out++ = quad[1];
+                            *out++ = quad[2];
+                            *out++ = quad[0];
+                            *out++ = quad[2];
+                            *out++ = quad[3];
+                        }
+                    }
+                }
+            }
+        }
+    });
+    return true;
+}
+
+bool Isosurface::Extract(const ScalarGrid& grid, float isoValue, IsosurfaceMethod method) {
+    if (grid.GetPointCount() == 0) {
+        std::cerr << "Isosurface: the grid is empty" << std::endl;
+        return false;
+    }
+    return Run(DenseLattice(grid), isoValue, method);
+}
+
+bool Isosurface::Extract(const SparseScalarGrid& grid, float isoValue, IsosurfaceMethod method) {
+    return Run(SparseLattice(grid), isoValue, method);
+}
+
+bool Isosurface::CreateMesh(Mesh& mesh) const {
+    return mesh.CreateTriangles(m_Positions, m_Triangles);
+}
+
+} // namespace alice2
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "Mesh.h"
+#include "ScalarGrid.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace alice2 {
+
+enum class IsosurfaceMethod {
+    MarchingCubes, // Vertices on lattice edges, up to five triangles per cell
+    SurfaceNets    // Dual: one vertex per crossed cell, a quad per crossed edge; cells
+                   // crossed by several sheets join them (non-manifold)
+};
+
+// Isosurface extraction from dense or brick-sparse scalar grids. The lattice
+// is processed as 8^3 bricks in z-major order, so parallel chunks are slabs
+// of bricks. A first pass marks crossed edges (or cells) per brick in a
+// bitmask; after a prefix sum over bricks every vertex has a fixed index,
+// brick base plus its rank in the mask. Shared vertices are therefore
+// deduplicated by edge (or cell) key without locks or hashing, and the
+// output is deterministic. Triangles face the increasing field direction;
+// points below isoValue are inside.
+class Isosurface {
+public:
+    bool Extract(const ScalarGrid& grid, float isoValue = 0.0f,
+                 IsosurfaceMethod method = IsosurfaceMethod::MarchingCubes);
+    bool Extract(const SparseScalarGrid& grid, float isoValue = 0.0f,
+                 IsosurfaceMethod method = IsosurfaceMethod::MarchingCubes);
+
+    const std::vector<Vec3f>& GetPositions() const { return m_Positions; }
+    const std::vector<Vec3f>& GetNormals() const { return m_Normals; } // Unit field gradients
+    const std::vector<uint32_t>& GetTriangleIndices() const { return m_Triangles; }
+    size_t GetVertexCount() const { return m_Positions.size(); }
+    size_t GetTriangleCount() const { return m_Triangles.size() / 3; }
+    uint64_t GetCellCount() const { return m_CellCount; } // Cells visited by the last extraction
+
+    bool CreateMesh(Mesh& mesh) const;
+
+private:
+    struct Brick {
+        uint64_t bits[24];     // Crossed edges (point * 3 + axis) or cells
+        uint16_t prefix[24];   // Set bits before each word
+        uint32_t vertexCount;
+        uint32_t triangleCount;
+        uint64_t vertexBase;
+        uint64_t triangleBase;
+    };
+
+    std::vector<Brick> m_Bricks;
+    std::vector<Vec3f> m_Positions;
+    std::vector<Vec3f> m_Normals;
+    std::vector<uint32_t> m_Triangles;
+    uint64_t m_CellCount = 0;
+
+    template <typename Lattice>
+    bool Run(const Lattice& lattice, float isoValue, IsosurfaceMethod method);
+};
+
+} // namespace alice2
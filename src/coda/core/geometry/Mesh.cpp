@@ -0,0 +1,269 @@
+#include "Mesh.h"
+#include "../utilities/Parallel.h"
+#include "../utilities/SpatialSort.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace alice2 {
+
+// ---------------------------------------------------------------------------
+// AttributeSet
+// ---------------------------------------------------------------------------
+
+AttributeSet::AttributeSet(const AttributeSet& other)
+    : m_Count(other.m_Count) {
+    for (const auto& [name, layer] : other.m_Layers) {
+        m_Layers[name] = layer->Clone();
+    }
+}
+
+AttributeSet& AttributeSet::operator=(const AttributeSet& other) {
+    if (this != &other) {
+        AttributeSet copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+void AttributeSet::Resize(size_t count) {
+    m_Count = count;
+    for (auto& [name, layer] : m_Layers) {
+        layer->Resize(count);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Mesh
+// ---------------------------------------------------------------------------
+
+bool Mesh::Create(const std::vector<Vec3f>& positions,
+                  const std::vector<uint32_t>& faceCounts,
+                  const std::vector<uint32_t>& faceIndices) {
+    Clear();
+
+    const size_t vertexCount = positions.size();
+    const size_t faceCount = faceCounts.size();
+
+    // Corner offsets per face, with validation of the soup
+    std::vector<size_t> faceOffsets(faceCount + 1);
+    size_t cornerCount = 0;
+    for (size_t f = 0; f < faceCount; ++f) {
+        if (faceCounts[f] < 3) {
+            std::cerr << "Mesh::Create: face " << f << " has fewer than 3 vertices" << std::endl;
+            return false;
+        }
+        faceOffsets[f] = cornerCount;
+        cornerCount += faceCounts[f];
+    }
+    faceOffsets[faceCount] = cornerCount;
+
+    if (cornerCount != faceIndices.size()) {
+        std::cerr << "Mesh::Create: face counts describe " << cornerCount << " corners but "
+                  << faceIndices.size() << " indices were given" << std::endl;
+        return false;
+    }
+    if (cornerCount >= INVALID_INDEX / 2) {
+        std::cerr << "Mesh::Create: too many corners for 32-bit half-edge indices" << std::endl;
+        return false;
+    }
+
+    // One key per directed corner edge: (min vertex, max vertex) in 64 bits
+    std::vector<uint64_t> keys(cornerCount);
+    std::vector<uint32_t> corners(cornerCount);
+    std::vector<uint8_t> invalidFaces(faceCount, 0);
+    parallel::For(faceCount, 4096, [&](size_t begin, size_t end) {
+        for (size_t f = begin; f < end; ++f) {
+            size_t offset = faceOffsets[f];
+            size_t n = faceOffsets[f + 1] - offset;
+            for (size_t k = 0; k < n; ++k) {
+                uint32_t from = faceIndices[offset + k];
+                uint32_t to = faceIndices[offset + (k + 1) % n];
+                if (from >= vertexCount || to >= vertexCount || from == to) {
+                    invalidFaces[f] = 1;
+                }
+                uint64_t lo = std::min(from, to), hi = std::max(from, to);
+                keys[offset + k] = (lo << 32) | hi;
+                corners[offset + k] = static_cast<uint32_t>(offset + k);
+            }
+        }
+    });
+    for (size_t f = 0; f < faceCount; ++f) {
+        if (invalidFaces[f]) {
+            std::cerr << "Mesh::Create: face " << f << " has an out-of-range or repeated vertex" << std::endl;
+            return false;
+        }
+    }
+
+    spatial::RadixSort(keys, corners);
+
+    // Each run of equal keys is one edge: a single corner is a boundary edge,
+    // two opposite corners an interior edge. Half-edge 2e runs low -> high.
+    std::vector<uint32_t> cornerHalfEdge(cornerCount);
+    m_HalfEdgeVertex.reserve(cornerCount + cornerCount / 4);
+    for (size_t i = 0; i < cornerCount;) {
+        size_t runEnd = i + 1;
+        while (runEnd < cornerCount && keys[runEnd] == keys[i]) {
+            ++runEnd;
+        }
+
+        uint32_t lo = static_cast<uint32_t>(keys[i] >> 32);
+        uint32_t hi = static_cast<uint32_t>(keys[i]);
+        if (runEnd - i > 2) {
+            std::cerr << "Mesh::Create: non-manifold edge (" << lo << ", " << hi << ") shared by "
+                      << (runEnd - i) << " faces" << std::endl;
+            Clear();
+            return false;
+        }
+
+        uint32_t edgeHalfEdge = static_cast<uint32_t>(m_HalfEdgeVertex.size());
+        bool used[2] = {false, false};
+        for (size_t j = i; j < runEnd; ++j) {
+            uint32_t corner = corners[j];
+            uint32_t side = faceIndices[corner] == lo ? 0u : 1u;
+            if (used[side]) {
+                std::cerr << "Mesh::Create: inconsistent face orientation at edge (" << lo << ", " << hi << ")"
+                          << std::endl;
+                Clear();
+                return false;
+            }
+            used[side] = true;
+            cornerHalfEdge[corner] = edgeHalfEdge + side;
+        }
+        m_HalfEdgeVertex.push_back(hi);
+        m_HalfEdgeVertex.push_back(lo);
+
+        i = runEnd;
+    }
+    keys = std::vector<uint64_t>();
+    corners = std::vector<uint32_t>();
+
+    // Face loops
+    const size_t halfEdgeCount = m_HalfEdgeVertex.size();
+    m_Positions = positions;
+    m_HalfEdgeNext.assign(halfEdgeCount, INVALID_INDEX);
+    m_HalfEdgePrev.assign(halfEdgeCount, INVALID_INDEX);
+    m_HalfEdgeFace.assign(halfEdgeCount, INVALID_INDEX);
+    m_FaceHalfEdge.resize(faceCount);
+
+    parallel::For(faceCount, 4096, [&](size_t begin, size_t end) {
+        for (size_t f = begin; f < end; ++f) {
+            size_t offset = faceOffsets[f];
+            size_t n = faceOffsets[f + 1] - offset;
+            for (size_t k = 0; k < n; ++k) {
+                uint32_t h = cornerHalfEdge[offset + k];
+                uint32_t hn = cornerHalfEdge[offset + (k + 1) % n];
+                m_HalfEdgeNext[h] = hn;
+                m_HalfEdgePrev[hn] = h;
+                m_HalfEdgeFace[h] = static_cast<uint32_t>(f);
+            }
+            m_FaceHalfEdge[f] = cornerHalfEdge[offset];
+        }
+    });
+
+    // Boundary loops: the boundary half-edge after b leaves b's target. Rotate
+    // through the faces around that vertex (reading only interior links) until
+    // the outgoing boundary half-edge of the same fan is reached.
+    parallel::For(halfEdgeCount, 16384, [&](size_t begin, size_t end) {
+        for (size_t b = begin; b < end; ++b) {
+            if (m_HalfEdgeFace[b] != INVALID_INDEX) {
+                continue;
+            }
+            uint32_t h = static_cast<uint32_t>(b) ^ 1u;
+            while (m_HalfEdgeFace[h] != INVALID_INDEX) {
+                h = m_HalfEdgePrev[h] ^ 1u;
+            }
+            m_HalfEdgeNext[b] = h;
+            m_HalfEdgePrev[h] = static_cast<uint32_t>(b);
+        }
+    });
+
+    // Outgoing half-edge per vertex, boundary ones preferred so circulation
+    // around boundary vertices starts and ends on the boundary
+    m_VertexHalfEdge.assign(vertexCount, INVALID_INDEX);
+    std::vector<uint32_t> degrees(vertexCount, 0);
+    for (size_t h = 0; h < halfEdgeCount; ++h) {
+        uint32_t source = m_HalfEdgeVertex[h ^ 1u];
+        ++degrees[source];
+        if (m_VertexHalfEdge[source] == INVALID_INDEX || m_HalfEdgeFace[h] == INVALID_INDEX) {
+            m_VertexHalfEdge[source] = static_cast<uint32_t>(h);
+        }
+    }
+
+    // Faces meeting only at a vertex form several fans around it, and a
+    // circulation from m_VertexHalfEdge would visit only one of them
+    std::vector<uint8_t> splitVertices(vertexCount, 0);
+    parallel::For(vertexCount, 16384, [&](size_t begin, size_t end) {
+        for (size_t v = begin; v < end; ++v) {
+            uint32_t start = m_VertexHalfEdge[v];
+            if (start == INVALID_INDEX) {
+                continue;
+            }
+            uint32_t fan = 0;
+            uint32_t h = start;
+            do {
+                ++fan;
+                h = m_HalfEdgeNext[h ^ 1u];
+            } while (h != start);
+            splitVertices[v] = fan != degrees[v];
+        }
+    });
+    for (size_t v = 0; v < vertexCount; ++v) {
+        if (splitVertices[v]) {
+            std::cerr << "Mesh::Create: non-manifold vertex " << v << " where faces meet only at the vertex"
+                      << std::endl;
+            Clear();
+            return false;
+        }
+    }
+
+    ResizeAttributes();
+    ++m_TopologyVersion;
+    MarkAllDirty();
+    return true;
+}
+
+bool Mesh::CreateTriangles(const std::vector<Vec3f>& positions, const std::vector<uint32_t>& triangles) {
+    std::vector<uint32_t> faceCounts(triangles.size() / 3, 3);
+    if (triangles.size() % 3 != 0) {
+        std::cerr << "Mesh::CreateTriangles: index count is not a multiple of 3" << std::endl;
+        return false;
+    }
+    return Create(positions, faceCounts, triangles);
+}
+
+void Mesh::Clear() {
+    m_Positions.clear();
+    m_HalfEdgeVertex.clear();
+    m_HalfEdgeNext.clear();
+    m_HalfEdgePrev.clear();
+    m_HalfEdgeFace.clear();
+    m_VertexHalfEdge.clear();
+    m_FaceHalfEdge.clear();
+    ResizeAttributes();
+    ++m_TopologyVersion;
+    MarkAllDirty();
+}
+
+AttributeSet& Mesh::GetAttributes(MeshElement element) {
+    switch (element) {
+    case MeshElement::Vertex: return m_VertexAttributes;
+    case MeshElement::Edge: return m_EdgeAttributes;
+    case MeshElement::Face: return m_FaceAttributes;
+    case MeshElement::HalfEdge: return m_HalfEdgeAttributes;
+    }
+    return m_VertexAttributes;
+}
+
+const AttributeSet& Mesh::GetAttributes(MeshElement element) const {
+    return const_cast<Mesh*>(this)->GetAttributes(element);
+}
+
+void Mesh::ResizeAttributes() {
+    m_VertexAttributes.Resize(GetVertexCount());
+    m_EdgeAttributes.Resize(GetEdgeCount());
+    m_FaceAttributes.Resize(GetFaceCount());
+    m_HalfEdgeAttributes.Resize(GetHalfEdgeCount());
+}
+
+} // namespace alice2
@@ -0,0 +1,234 @@
+#pragma once
+
+#include "../../../core/base/Types.h"
+#include "EditLog.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace alice2 {
+
+constexpr uint32_t INVALID_INDEX = 0xffffffffu;
+
+enum class MeshElement {
+    Vertex,
+    Edge,
+    Face,
+    HalfEdge
+};
+
+// ---------------------------------------------------------------------------
+// Typed per-element attribute layers (one contiguous array per attribute)
+// ---------------------------------------------------------------------------
+
+class AttributeLayerBase {
+public:
+    virtual ~AttributeLayerBase() = default;
+    virtual void Resize(size_t count) = 0;
+    virtual std::unique_ptr<AttributeLayerBase> Clone() const = 0;
+};
+
+template <typename T>
+class AttributeLayer : public AttributeLayerBase {
+public:
+    explicit AttributeLayer(const T& defaultValue) : m_Default(defaultValue) {}
+
+    void Resize(size_t count) override { m_Data.resize(count, m_Default); }
+    std::unique_ptr<AttributeLayerBase> Clone() const override { return std::make_unique<AttributeLayer<T>>(*this); }
+
+    std::vector<T>& GetData() { return m_Data; }
+    const std::vector<T>& GetData() const { return m_Data; }
+
+private:
+    std::vector<T> m_Data;
+    T m_Default;
+};
+
+class AttributeSet {
+public:
+    AttributeSet() = default;
+    AttributeSet(const AttributeSet& other);
+    AttributeSet& operator=(const AttributeSet& other);
+    AttributeSet(AttributeSet&&) = default;
+    AttributeSet& operator=(AttributeSet&&) = default;
+
+    // Adds (or returns the existing) layer sized to the element count
+    template <typename T>
+    std::vector<T>& Add(const std::string& name, const T& defaultValue = T()) {
+        if (std::vector<T>* existing = Get<T>(name)) {
+            return *existing;
+        }
+        auto layer = std::make_unique<AttributeLayer<T>>(defaultValue);
+        layer->Resize(m_Count);
+        std::vector<T>& data = layer->GetData();
+        m_Layers[name] = std::move(layer);
+        return data;
+    }
+
+    // Null when missing or stored with a different type
+    template <typename T>
+    std::vector<T>* Get(const std::string& name) {
+        auto it = m_Layers.find(name);
+        if (it == m_Layers.end()) {
+            return nullptr;
+        }
+        auto* layer = dynamic_cast<AttributeLayer<T>*>(it->second.get());
+        return layer ? &layer->GetData() : nullptr;
+    }
+
+    template <typename T>
+    const std::vector<T>* Get(const std::string& name) const {
+        return const_cast<AttributeSet*>(this)->Get<T>(name);
+    }
+
+    bool Has(const std::string& name) const { return m_Layers.count(name) > 0; }
+    bool Remove(const std::string& name) { return m_Layers.erase(name) > 0; }
+    void Clear() { m_Layers.clear(); }
+
+    void Resize(size_t count);
+    size_t GetCount() const { return m_Count; }
+
+private:
+    std::unordered_map<std::string, std::unique_ptr<AttributeLayerBase>> m_Layers;
+    size_t m_Count = 0;
+};
+
+// ---------------------------------------------------------------------------
+// Index-based half-edge mesh
+// ---------------------------------------------------------------------------
+//
+// Connectivity lives in flat uint32_t arrays. Half-edges come in pairs: edge
+// e owns half-edges 2e and 2e + 1, so Twin(h) = h ^ 1 needs no storage.
+// Boundary half-edges are real half-edges with an INVALID_INDEX face, linked
+// into boundary loops, so every circulation is a plain index walk. Boundary
+// vertices point at their outgoing boundary half-edge.
+//
+// Only manifold, consistently oriented polygon meshes are accepted: an edge
+// joins at most two faces and the faces around a vertex form a single fan.
+// Create() reports the first offending edge or vertex and leaves the mesh
+// empty otherwise.
+class Mesh {
+public:
+    Mesh() = default;
+
+    // Builds from a polygon soup: faceCounts[i] corners per face, indices
+    // concatenated in faceIndices. Edge pairing runs on the parallel radix sort.
+    bool Create(const std::vector<Vec3f>& positions,
+                const std::vector<uint32_t>& faceCounts,
+                const std::vector<uint32_t>& faceIndices);
+    bool CreateTriangles(const std::vector<Vec3f>& positions, const std::vector<uint32_t>& triangles);
+    void Clear();
+
+    // Element counts
+    size_t GetVertexCount() const { return m_Positions.size(); }
+    size_t GetFaceCount() const { return m_FaceHalfEdge.size(); }
+    size_t GetEdgeCount() const { return m_HalfEdgeVertex.size() / 2; }
+    size_t GetHalfEdgeCount() const { return m_HalfEdgeVertex.size(); }
+
+    // Positions. Edits through SetPosition are tracked; after writing through
+    // GetPositions() call MarkVertexDirty / MarkAllDirty.
+    std::vector<Vec3f>& GetPositions() { return m_Positions; }
+    const std::vector<Vec3f>& GetPositions() const { return m_Positions; }
+    const Vec3f& GetPosition(uint32_t vertex) const { return m_Positions[vertex]; }
+    void SetPosition(uint32_t vertex, const Vec3f& position) {
+        m_Positions[vertex] = position;
+        MarkVertexDirty(vertex);
+    }
+
+    // Geometry edit log (see EditLog). Moved vertices are appended once per
+    // reader pass; each consumer (normals, spatial indices, GPU upload) keeps
+    // its own cursor into the log. Not thread-safe: mark from one thread.
+    void MarkVertexDirty(uint32_t vertex) { m_EditLog.MarkVertex(vertex, m_Positions.size()); }
+    void MarkAllDirty() { m_EditLog.MarkAll(); }
+    uint64_t GetEditCursor() const { return m_EditLog.GetCursor(); }
+    // Vertices moved since cursor (may repeat). Returns false when the caller
+    // must treat every vertex as dirty (topology change, MarkAllDirty, or
+    // the log was compacted past the cursor).
+    bool GetEditsSince(uint64_t cursor, std::vector<uint32_t>& vertices) const {
+        return m_EditLog.GetEditsSince(cursor, vertices);
+    }
+
+    // Half-edge connectivity (O(1) array lookups)
+    uint32_t Twin(uint32_t halfEdge) const { return halfEdge ^ 1u; }
+    uint32_t Next(uint32_t halfEdge) const { return m_HalfEdgeNext[halfEdge]; }
+    uint32_t Prev(uint32_t halfEdge) const { return m_HalfEdgePrev[halfEdge]; }
+    uint32_t Target(uint32_t halfEdge) const { return m_HalfEdgeVertex[halfEdge]; }
+    uint32_t Source(uint32_t halfEdge) const { return m_HalfEdgeVertex[halfEdge ^ 1u]; }
+    uint32_t Face(uint32_t halfEdge) const { return m_HalfEdgeFace[halfEdge]; }
+    uint32_t Edge(uint32_t halfEdge) const { return halfEdge >> 1; }
+    uint32_t EdgeHalfEdge(uint32_t edge) const { return edge << 1; }
+    uint32_t VertexHalfEdge(uint32_t vertex) const { return m_VertexHalfEdge[vertex]; }
+    uint32_t FaceHalfEdge(uint32_t face) const { return m_FaceHalfEdge[face]; }
+
+    bool IsBoundaryHalfEdge(uint32_t halfEdge) const { return m_HalfEdgeFace[halfEdge] == INVALID_INDEX; }
+    bool IsBoundaryEdge(uint32_t edge) const {
+        return IsBoundaryHalfEdge(edge << 1) || IsBoundaryHalfEdge((edge << 1) | 1u);
+    }
+    bool IsBoundaryVertex(uint32_t vertex) const {
+        uint32_t h = m_VertexHalfEdge[vertex];
+        return h != INVALID_INDEX && IsBoundaryHalfEdge(h);
+    }
+    bool IsIsolatedVertex(uint32_t vertex) const { return m_VertexHalfEdge[vertex] == INVALID_INDEX; }
+
+    // Raw arrays for bulk kernels
+    const std::vector<uint32_t>& GetHalfEdgeVertices() const { return m_HalfEdgeVertex; }
+    const std::vector<uint32_t>& GetHalfEdgeNext() const { return m_HalfEdgeNext; }
+    const std::vector<uint32_t>& GetHalfEdgePrev() const { return m_HalfEdgePrev; }
+    const std::vector<uint32_t>& GetHalfEdgeFaces() const { return m_HalfEdgeFace; }
+    const std::vector<uint32_t>& GetVertexHalfEdges() const { return m_VertexHalfEdge; }
+    const std::vector<uint32_t>& GetFaceHalfEdges() const { return m_FaceHalfEdge; }
+
+    // Attribute layers, kept sized to their element count
+    AttributeSet& GetAttributes(MeshElement element);
+    const AttributeSet& GetAttributes(MeshElement element) const;
+
+    template <typename T>
+    std::vector<T>& AddVertexAttribute(const std::string& name, const T& defaultValue = T()) {
+        return m_VertexAttributes.Add<T>(name, defaultValue);
+    }
+    template <typename T>
+    std::vector<T>& AddFaceAttribute(const std::string& name, const T& defaultValue = T()) {
+        return m_FaceAttributes.Add<T>(name, defaultValue);
+    }
+    template <typename T>
+    std::vector<T>& AddEdgeAttribute(const std::string& name, const T& defaultValue = T()) {
+        return m_EdgeAttributes.Add<T>(name, defaultValue);
+    }
+    template <typename T>
+    std::vector<T>* GetVertexAttribute(const std::string& name) { return m_VertexAttributes.Get<T>(name); }
+    template <typename T>
+    std::vector<T>* GetFaceAttribute(const std::string& name) { return m_FaceAttributes.Get<T>(name); }
+    template <typename T>
+    std::vector<T>* GetEdgeAttribute(const std::string& name) { return m_EdgeAttributes.Get<T>(name); }
+
+    // Bumped on every successful Create()/Clear(); caches keyed on topology
+    // compare against it
+    uint64_t GetTopologyVersion() const { return m_TopologyVersion; }
+
+private:
+    std::vector<Vec3f> m_Positions;
+
+    std::vector<uint32_t> m_HalfEdgeVertex; // Target vertex
+    std::vector<uint32_t> m_HalfEdgeNext;
+    std::vector<uint32_t> m_HalfEdgePrev;
+    std::vector<uint32_t> m_HalfEdgeFace;   // INVALID_INDEX on boundary
+    std::vector<uint32_t> m_VertexHalfEdge; // Outgoing; boundary one preferred
+    std::vector<uint32_t> m_FaceHalfEdge;
+
+    AttributeSet m_VertexAttributes;
+    AttributeSet m_EdgeAttributes;
+    AttributeSet m_FaceAttributes;
+    AttributeSet m_HalfEdgeAttributes;
+
+    uint64_t m_TopologyVersion = 0;
+
+    EditLog m_EditLog;
+
+    void ResizeAttributes();
+};
+
+} // namespace alice2
@@ -0,0 +1,910 @@
+#include "MeshBvh.h"
+#include "../utilities/Parallel.h"
+#include "../utilities/Simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace alice2 {
+
+namespace {
+
+constexpr int BinCount = 16;
+constexpr int MaxDepth = 64;     // Deeper nodes split at the object median
+constexpr int StackSize = 128;   // MaxDepth plus log2 of any triangle count
+constexpr size_t GrainSize = 4096;
+constexpr float Infinity = std::numeric_limits<float>::infinity();
+
+inline float Component(const Vec3f& v, int axis) { return axis == 0 ? v.x : (axis == 1 ? v.y : v.z); }
+
+// Written as selects so they compile to minss/maxss rather than branches,
+// which mispredict constantly while binning
+inline float MinF(float a, float b) { return a < b ? a : b; }
+inline float MaxF(float a, float b) { return a > b ? a : b; }
+
+inline Vec3f Min(const Vec3f& a, const Vec3f& b) { return Vec3f(MinF(a.x, b.x), MinF(a.y, b.y), MinF(a.z, b.z)); }
+inline Vec3f Max(const Vec3f& a, const Vec3f& b) { return Vec3f(MaxF(a.x, b.x), MaxF(a.y, b.y), MaxF(a.z, b.z)); }
+
+struct Box {
+    Vec3f min = Vec3f(Infinity, Infinity, Infinity);
+    Vec3f max = Vec3f(-Infinity, -Infinity, -Infinity);
+
+    void Grow(const Vec3f& p) {
+        min = Min(min, p);
+        max = Max(max, p);
+    }
+    void Grow(const Box& box) {
+        min = Min(min, box.min);
+        max = Max(max, box.max);
+    }
+    float Area() const {
+        Vec3f d = max - min;
+        return d.x < 0.0f ? 0.0f : 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+    }
+};
+
+struct Bin {
+    Box bounds;
+    uint32_t count = 0;
+};
+
+// Small nodes use fewer bins: near the leaves the per-node cost of
+// clearing and sweeping bins outweighs the per-triangle work
+struct Bins {
+    int count = BinCount;
+    Bin bins[3][BinCount];
+
+    explicit Bins(uint32_t triangles = BinCount) : count(int(std::min<uint32_t>(triangles, BinCount))) {}
+};
+
+// Triangle bounds and centroid; the records themselves are partitioned so
+// every pass over a node range reads memory sequentially
+struct Primitive {
+    Box bounds;
+    Vec3f centroid;
+    uint32_t triangle;
+};
+
+struct BuildInput {
+    std::vector<Primitive> primitives;
+};
+
+struct Range {
+    uint32_t begin;
+    uint32_t end;
+    int depth;
+};
+
+void BinRange(const BuildInput& input, const Box& centroidBounds, uint32_t begin, uint32_t end, Bins& bins) {
+    Vec3f extent = centroidBounds.max - centroidBounds.min;
+    float scale[3];
+    for (int axis = 0; axis < 3; ++axis) {
+        float e = Component(extent, axis);
+        scale[axis] = e > 0.0f ? float(bins.count) * 0.9999f / e : 0.0f;
+    }
+    for (uint32_t i = begin; i < end; ++i) {
+        const Primitive& primitive = input.primitives[i];
+        Vec3f offset = primitive.centroid - centroidBounds.min;
+        for (int axis = 0; axis < 3; ++axis) {
+            Bin& bin = bins.bins[axis][int(Component(offset, axis) * scale[axis])];
+            bin.bounds.Grow(primitive.bounds);
+            ++bin.count;
+        }
+    }
+}
+
+struct Split {
+    int axis = -1;
+    int bin = 0;       // Bins [0, bin] go left
+    int binCount = BinCount;
+    float cost = Infinity;
+};
+
+Split FindSplit(const Bins& bins, const Box& centroidBounds) {
+    Split best;
+    best.binCount = bins.count;
+    const int binCount = bins.count;
+    Vec3f extent = centroidBounds.max - centroidBounds.min;
+    for (int axis = 0; axis < 3; ++axis) {
+        if (Component(extent, axis) <= 0.0f) {
+            continue;
+        }
+        const Bin* row = bins.bins[axis];
+        float rightArea[BinCount];
+        uint32_t rightCount[BinCount];
+        Box box;
+        uint32_t count = 0;
+        for (int b = binCount - 1; b > 0; --b) {
+            box.Grow(row[b].bounds);
+            count += row[b].count;
+            rightArea[b] = box.Area();
+            rightCount[b] = count;
+        }
+        box = Box();
+        count = 0;
+        for (int b = 0; b < binCount - 1; ++b) {
+            box.Grow(row[b].bounds);
+            count += row[b].count;
+            if (count == 0 || rightCount[b + 1] == 0) {
+                continue;
+            }
+            float cost = box.Area() * float(count) + rightArea[b + 1] * float(rightCount[b + 1]);
+            if (cost < best.cost) {
+                best.axis = axis;
+                best.bin = b;
+                best.cost = cost;
+            }
+        }
+    }
+    return best;
+}
+
+// Splits a range in place and returns the middle; falls back to the object
+// median along the widest centroid axis when binning finds no useful split
+uint32_t Partition(BuildInput& input, const Box& centroidBounds, const Split& split, uint32_t begin, uint32_t end,
+                   bool median) {
+    if (!median && split.axis >= 0) {
+        float low = Component(centroidBounds.min, split.axis);
+        float scale = float(split.binCount) * 0.9999f / (Component(centroidBounds.max, split.axis) - low);
+        auto it = std::partition(input.primitives.begin() + begin, input.primitives.begin() + end,
+                                 [&](const Primitive& primitive) {
+                                     return int((Component(primitive.centroid, split.axis) - low) * scale) <= split.bin;
+                                 });
+        uint32_t middle = uint32_t(it - input.primitives.begin());
+        if (middle != begin && middle != end) {
+            return middle;
+        }
+    }
+    Vec3f extent = centroidBounds.max - centroidBounds.min;
+    int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+    uint32_t middle = begin + (end - begin) / 2;
+    std::nth_element(input.primitives.begin() + begin, input.primitives.begin() + middle,
+                     input.primitives.begin() + end, [&](const Primitive& a, const Primitive& b) {
+                         return Component(a.centroid, axis) < Component(b.centroid, axis);
+                     });
+    return middle;
+}
+
+// Decides between a leaf and a split: the split must beat intersecting all
+// triangles (traversal and intersection cost both 1) unless the leaf is too big
+bool ShouldSplit(const Split& split, const Box& bounds, uint32_t count) {
+    if (count <= 1) {
+        return false;
+    }
+    if (count > MeshBvh::MaxLeafSize) {
+        return true;
+    }
+    float area = bounds.Area();
+    return split.axis >= 0 && area > 0.0f && 1.0f + split.cost / area < float(count);
+}
+
+void MakeLeaf(MeshBvh::Node& node, const Box& bounds, uint32_t begin, uint32_t end) {
+    node.min = bounds.min;
+    node.max = bounds.max;
+    node.offset = begin;
+    node.count = uint16_t(end - begin);
+    node.axis = 0;
+}
+
+// Serial depth-first build; child offsets are relative to nodes[0]
+void BuildSubtree(BuildInput& input, std::vector<MeshBvh::Node>& nodes, uint32_t begin, uint32_t end, int depth) {
+    uint32_t index = uint32_t(nodes.size());
+    nodes.emplace_back();
+    Box bounds, centroidBounds;
+    for (uint32_t i = begin; i < end; ++i) {
+        bounds.Grow(input.primitives[i].bounds);
+        centroidBounds.Grow(input.primitives[i].centroid);
+    }
+    uint32_t count = end - begin;
+    Split split;
+    if (count > 1 && depth < MaxDepth) {
+        Bins bins(count);
+        BinRange(input, centroidBounds, begin, end, bins);
+        split = FindSplit(bins, centroidBounds);
+    }
+    if (!ShouldSplit(split, bounds, count)) {
+        MakeLeaf(nodes[index], bounds, begin, end);
+        return;
+    }
+    uint32_t middle = Partition(input, centroidBounds, split, begin, end, depth >= MaxDepth);
+    BuildSubtree(input, nodes, begin, middle, depth + 1);
+    uint32_t right = uint32_t(nodes.size());
+    BuildSubtree(input, nodes, middle, end, depth + 1);
+    MeshBvh::Node& node = nodes[index];
+    node.min = bounds.min;
+    node.max = bounds.max;
+    node.offset = right;
+    node.count = 0;
+    node.axis = uint16_t(split.axis >= 0 ? split.axis : 0);
+}
+
+// Node of the top of the tree, split with parallel binning; children are
+// top nodes or, with SubtreeBit set, independently built subtrees
+constexpr uint32_t SubtreeBit = 0x80000000u;
+
+struct TopNode {
+    MeshBvh::Node node;
+    Range range;
+    uint32_t left = 0;
+    uint32_t right = 0;
+};
+
+// Widens the far distance by 1 + 2 gamma(3) (Ize, "Robust BVH Ray Traversal",
+// 2013) so rounding never culls a box whose triangles the ray hits, nor one
+// holding a triangle tied with the current hit. The packet traversal
+// computes the same expression lane by lane.
+constexpr float SlabScale = 1.0000004f;
+
+inline bool SlabTest(const MeshBvh::Node& node, const Vec3f& origin, const Vec3f& inverse, float tMin, float tMax,
+                     float& tNear) {
+    float x0 = (node.min.x - origin.x) * inverse.x, x1 = (node.max.x - origin.x) * inverse.x;
+    float y0 = (node.min.y - origin.y) * inverse.y, y1 = (node.max.y - origin.y) * inverse.y;
+    float z0 = (node.min.z - origin.z) * inverse.z, z1 = (node.max.z - origin.z) * inverse.z;
+    float near = MaxF(MaxF(MinF(x0, x1), MinF(y0, y1)), MaxF(MinF(z0, z1), tMin));
+    float far = MinF(MinF(MinF(MaxF(x0, x1), MaxF(y0, y1)), MaxF(z0, z1)), tMax) * SlabScale;
+    tNear = near;
+    return near <= far;
+}
+
+// Watertight ray-triangle test (Woop, Benthin and Wald 2013). Each ray is
+// sheared to run along +z from its origin; vertices are transformed per ray,
+// not per triangle, so triangles sharing an edge evaluate it identically and
+// no ray slips between them. Single rays run the same kernel with the ray in
+// every lane, so they hit exactly what the packets hit.
+struct ShearedRays {
+    simd::FloatV ox, oy, oz;
+    simd::FloatV rows[9]; // Shear rows: x and y across the ray, z along it
+};
+
+// Shear of one ray as a 3x3 matrix; a zero direction gives NaNs, which miss
+inline void ShearRows(const Vec3f& direction, float rows[9]) {
+    const float d[3] = {direction.x, direction.y, direction.z};
+    float ax = std::abs(d[0]), ay = std::abs(d[1]), az = std::abs(d[2]);
+    int kz = ax > ay ? (ax > az ? 0 : 2) : (ay > az ? 1 : 2);
+    int kx = (kz + 1) % 3, ky = (kx + 1) % 3;
+    if (d[kz] < 0.0f) {
+        std::swap(kx, ky); // Keeps the winding
+    }
+    std::fill(rows, rows + 9, 0.0f);
+    rows[kx] = 1.0f;
+    rows[kz] = -d[kx] / d[kz];
+    rows[3 + ky] = 1.0f;
+    rows[3 + kz] = -d[ky] / d[kz];
+    rows[6 + kz] = 1.0f / d[kz];
+}
+
+inline void Shear(const ShearedRays& rays, const Vec3f& p, simd::FloatV& x, simd::FloatV& y, simd::FloatV& z) {
+    using simd::FloatV;
+    FloatV px = FloatV::Broadcast(p.x) - rays.ox;
+    FloatV py = FloatV::Broadcast(p.y) - rays.oy;
+    FloatV pz = FloatV::Broadcast(p.z) - rays.oz;
+    x = rays.rows[0] * px + rays.rows[1] * py + rays.rows[2] * pz;
+    y = rays.rows[3] * px + rays.rows[4] * py + rays.rows[5] * pz;
+    z = rays.rows[6] * px + rays.rows[7] * py + rays.rows[8] * pz;
+}
+
+// Signed area of the edge p -> q seen along the ray, always evaluated from
+// the lower vertex index: the two triangles sharing an edge then get exactly
+// opposite values, even where the compiler fuses the products
+inline simd::FloatV EdgeFunction(const simd::FloatV& px, const simd::FloatV& py, uint32_t p, const simd::FloatV& qx,
+                                 const simd::FloatV& qy, uint32_t q) {
+    return p < q ? px * qy - py * qx : -(qx * py - qy * px);
+}
+
+// Lanes whose ray crosses the triangle (either side) at any t; u and v weight
+// the second and third corners. Callers test t against their interval.
+inline simd::FloatV IntersectTriangle(const ShearedRays& rays, const std::vector<Vec3f>& positions,
+                                      const uint32_t* corners, simd::FloatV& t, simd::FloatV& u, simd::FloatV& v) {
+    using simd::FloatV;
+    FloatV ax, ay, az, bx, by, bz, cx, cy, cz;
+    Shear(rays, positions[corners[0]], ax, ay, az);
+    Shear(rays, positions[corners[1]], bx, by, bz);
+    Shear(rays, positions[corners[2]], cx, cy, cz);
+    FloatV ea = EdgeFunction(cx, cy, corners[2], bx, by, corners[1]);
+    FloatV eb = EdgeFunction(ax, ay, corners[0], cx, cy, corners[2]);
+    FloatV ec = EdgeFunction(bx, by, corners[1], ax, ay, corners[0]);
+    const FloatV zero = FloatV::Broadcast(0.0f);
+    FloatV inside = Or(And(And(CmpLe(zero, ea), CmpLe(zero, eb)), CmpLe(zero, ec)),
+                       And(And(CmpLe(ea, zero), CmpLe(eb, zero)), CmpLe(ec, zero)));
+    FloatV det = ea + eb + ec;
+    FloatV inverse = FloatV::Broadcast(1.0f) / det;
+    t = (ea * az + eb * bz + ec * cz) * inverse;
+    u = eb * inverse;
+    v = ec * inverse;
+    return And(inside, CmpGt(simd::Abs(det), zero));
+}
+
+inline ShearedRays ShearRay(const Vec3f& origin, const Vec3f& direction) {
+    using simd::FloatV;
+    ShearedRays ray;
+    ray.ox = FloatV::Broadcast(origin.x);
+    ray.oy = FloatV::Broadcast(origin.y);
+    ray.oz = FloatV::Broadcast(origin.z);
+    float rows[9];
+    ShearRows(direction, rows);
+    for (int i = 0; i < 9; ++i) {
+        ray.rows[i] = FloatV::Broadcast(rows[i]);
+    }
+    return ray;
+}
+
+// One ray through the packet kernel; false for misses and grazing rays
+inline bool IntersectTriangle(const ShearedRays& ray, const std::vector<Vec3f>& positions, const uint32_t* corners,
+                              float& t, float& u, float& v) {
+    using simd::FloatV;
+    FloatV laneT, laneU, laneV;
+    if (simd::MoveMask(IntersectTriangle(ray, positions, corners, laneT, laneU, laneV)) == 0) {
+        return false;
+    }
+    alignas(32) float values[3][FloatV::Width];
+    laneT.Store(values[0]);
+    laneU.Store(values[1]);
+    laneV.Store(values[2]);
+    t = values[0][0];
+    u = values[1][0];
+    v = values[2][0];
+    return true;
+}
+
+// Closest hits win; equal distances go to the lower triangle so the result
+// does not depend on the traversal order
+inline bool IsCloser(float t, uint32_t triangle, const RayHit& hit, float tMax) {
+    return hit.IsHit() ? t < hit.t || (t == hit.t && triangle < hit.triangle) : t < tMax;
+}
+
+inline float BoxDistanceSquared(const MeshBvh::Node& node, const Vec3f& p) {
+    float dx = std::max(std::max(node.min.x - p.x, p.x - node.max.x), 0.0f);
+    float dy = std::max(std::max(node.min.y - p.y, p.y - node.max.y), 0.0f);
+    float dz = std::max(std::max(node.min.z - p.z, p.z - node.max.z), 0.0f);
+    return dx * dx + dy * dy + dz * dz;
+}
+
+// Closest point on triangle abc (Ericson, Real-Time Collision Detection 5.1.5)
+Vec3f ClosestPointOnTriangle(const Vec3f& p, const Vec3f& a, const Vec3f& b, const Vec3f& c) {
+    Vec3f ab = b - a, ac = c - a, ap = p - a;
+    float d1 = ab.Dot(ap), d2 = ac.Dot(ap);
+    if (d1 <= 0.0f && d2 <= 0.0f) {
+        return a;
+    }
+    Vec3f bp = p - b;
+    float d3 = ab.Dot(bp), d4 = ac.Dot(bp);
+    if (d3 >= 0.0f && d4 <= d3) {
+        return b;
+    }
+    float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+        return a + ab * (d1 / (d1 - d3));
+    }
+    Vec3f cp = p - c;
+    float d5 = ab.Dot(cp), d6 = ac.Dot(cp);
+    if (d6 >= 0.0f && d5 <= d6) {
+        return c;
+    }
+    float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+        return a + ac * (d2 / (d2 - d6));
+    }
+    float va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+        return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+    }
+    float denominator = va + vb + vc;
+    if (denominator <= 0.0f) {
+        return a; // Degenerate triangle
+    }
+    float inverse = 1.0f / denominator;
+    return a + ab * (vb * inverse) + ac * (vc * inverse);
+}
+
+} // namespace
+
+void MeshBvh::Clear() {
+    m_Nodes.clear();
+    m_Triangles.clear();
+    m_TriangleFaces.clear();
+    m_Positions.clear();
+    m_Mesh = nullptr;
+}
+
+bool MeshBvh::Build(const Mesh& mesh) {
+    std::vector<uint32_t> triangles, faces;
+    for (uint32_t f = 0; f < uint32_t(mesh.GetFaceCount()); ++f) {
+        // Fan from the first corner
+        uint32_t start = mesh.FaceHalfEdge(f);
+        uint32_t first = mesh.Target(start);
+        for (uint32_t h = mesh.Next(start); mesh.Next(h) != start; h = mesh.Next(h)) {
+            triangles.insert(triangles.end(), {first, mesh.Target(h), mesh.Target(mesh.Next(h))});
+            faces.push_back(f);
+        }
+    }
+    if (!BuildTriangles(mesh.GetPositions(), triangles, faces)) {
+        return false;
+    }
+    m_Mesh = &mesh;
+    m_TopologyVersion = mesh.GetTopologyVersion();
+    m_EditCursor = mesh.GetEditCursor();
+    return true;
+}
+
+bool MeshBvh::Build(const std::vector<Vec3f>& positions, const std::vector<uint32_t>& triangles) {
+    if (triangles.size() % 3 != 0) {
+        std::cerr << "MeshBvh: index count is not a multiple of 3" << std::endl;
+        return false;
+    }
+    std::vector<uint32_t> corners(triangles), faces(triangles.size() / 3);
+    for (size_t t = 0; t < faces.size(); ++t) {
+        faces[t] = uint32_t(t);
+    }
+    m_Mesh = nullptr;
+    return BuildTriangles(positions, corners, faces);
+}
+
+bool MeshBvh::BuildTriangles(const std::vector<Vec3f>& positions, std::vector<uint32_t>& triangles,
+                             std::vector<uint32_t>& faces) {
+    Clear();
+    for (uint32_t index : triangles) {
+        if (index >= positions.size()) {
+            std::cerr << "MeshBvh: triangle index " << index << " out of range" << std::endl;
+            return false;
+        }
+    }
+    size_t triangleCount = faces.size();
+    if (triangleCount == 0) {
+        return true;
+    }
+    if (triangleCount >= SubtreeBit) {
+        std::cerr << "MeshBvh: too many triangles" << std::endl;
+        return false;
+    }
+    m_Positions = positions;
+
+    BuildInput input;
+    input.primitives.resize(triangleCount);
+    parallel::For(triangleCount, GrainSize, [&](size_t begin, size_t end) {
+        for (size_t t = begin; t < end; ++t) {
+            Box box;
+            box.Grow(positions[triangles[t * 3]]);
+            box.Grow(positions[triangles[t * 3 + 1]]);
+            box.Grow(positions[triangles[t * 3 + 2]]);
+            input.primitives[t] = {box, (box.min + box.max) * 0.5f, uint32_t(t)};
+        }
+    });
+
+    // Top of the tree: split with parallel binning until the ranges are
+    // small enough to hand one per task to the workers
+    const uint32_t subtreeSize = uint32_t(std::max<size_t>(triangleCount / (parallel::ThreadCount() * 8), 4096));
+    std::vector<TopNode> top;
+    std::vector<Range> subtrees;
+    auto addRange = [&](uint32_t begin, uint32_t end, int depth) -> uint32_t {
+        if (end - begin <= subtreeSize) {
+            subtrees.push_back({begin, end, depth});
+            return uint32_t(subtrees.size() - 1) | SubtreeBit;
+        }
+        top.push_back({MeshBvh::Node(), {begin, end, depth}});
+        return uint32_t(top.size() - 1);
+    };
+    uint32_t root = addRange(0, uint32_t(triangleCount), 0);
+    for (size_t i = 0; i < top.size(); ++i) {
+        uint32_t begin = top[i].range.begin, end = top[i].range.end;
+        int depth = top[i].range.depth;
+        size_t chunkCount = parallel::ChunkCount(end - begin, GrainSize);
+        std::vector<Box> chunkBounds(chunkCount), chunkCentroids(chunkCount);
+        size_t chunkSize = (end - begin + chunkCount - 1) / chunkCount;
+        parallel::ForChunks(chunkCount, [&](size_t chunk) {
+            uint32_t first = begin + uint32_t(chunk * chunkSize);
+            uint32_t last = uint32_t(std::min<size_t>(first + chunkSize, end));
+            for (uint32_t k = first; k < last; ++k) {
+                chunkBounds[chunk].Grow(input.primitives[k].bounds);
+                chunkCentroids[chunk].Grow(input.primitives[k].centroid);
+            }
+        });
+        Box bounds, centroidBounds;
+        for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+            bounds.Grow(chunkBounds[chunk]);
+            centroidBounds.Grow(chunkCentroids[chunk]);
+        }
+        std::vector<Bins> chunkBins(chunkCount);
+        parallel::ForChunks(chunkCount, [&](size_t chunk) {
+            uint32_t first = begin + uint32_t(chunk * chunkSize);
+            uint32_t last = uint32_t(std::min<size_t>(first + chunkSize, end));
+            BinRange(input, centroidBounds, first, last, chunkBins[chunk]);
+        });
+        for (size_t chunk = 1; chunk < chunkCount; ++chunk) {
+            for (int axis = 0; axis < 3; ++axis) {
+                for (int b = 0; b < chunkBins[0].count; ++b) {
+                    chunkBins[0].bins[axis][b].bounds.Grow(chunkBins[chunk].bins[axis][b].bounds);
+                    chunkBins[0].bins[axis][b].count += chunkBins[chunk].bins[axis][b].count;
+                }
+            }
+        }
+        Split split = FindSplit(chunkBins[0], centroidBounds);
+        uint32_t middle = Partition(input, centroidBounds, split, begin, end, depth >= MaxDepth);
+
+        uint32_t left = addRange(begin, middle, depth + 1);
+        uint32_t right = addRange(middle, end, depth + 1);
+        TopNode& node = top[i];
+        node.node.min = bounds.min;
+        node.node.max = bounds.max;
+        node.node.count = 0;
+        node.node.axis = uint16_t(split.axis >= 0 ? split.axis : 0);
+        node.left = left;
+        node.right = right;
+    }
+
+    std::vector<std::vector<Node>> subtreeNodes(subtrees.size());
+    parallel::ForChunks(subtrees.size(), [&](size_t s) {
+        BuildSubtree(input, subtreeNodes[s], subtrees[s].begin, subtrees[s].end, subtrees[s].depth);
+    });
+
+    // Flatten depth first: top nodes in pre-order, subtrees copied as blocks
+    // with their child offsets rebased
+    size_t nodeCount = top.size();
+    for (const std::vector<Node>& nodes : subtreeNodes) {
+        nodeCount += nodes.size();
+    }
+    m_Nodes.reserve(nodeCount);
+    auto emit = [&](auto&& self, uint32_t reference) -> uint32_t {
+        uint32_t index = uint32_t(m_Nodes.size());
+        if (reference & SubtreeBit) {
+            for (Node node : subtreeNodes[reference & ~SubtreeBit]) {
+                if (node.count == 0) {
+                    node.offset += index;
+                }
+                m_Nodes.push_back(node);
+            }
+            return index;
+        }
+        m_Nodes.push_back(top[reference].node);
+        self(self, top[reference].left);
+        uint32_t right = self(self, top[reference].right);
+        m_Nodes[index].offset = right;
+        return index;
+    };
+    emit(emit, root);
+
+    // Triangles and their faces in leaf order
+    m_Triangles.resize(triangleCount * 3);
+    m_TriangleFaces.resize(triangleCount);
+    parallel::For(triangleCount, GrainSize, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            uint32_t t = input.primitives[i].triangle;
+            m_Triangles[i * 3] = triangles[t * 3];
+            m_Triangles[i * 3 + 1] = triangles[t * 3 + 1];
+            m_Triangles[i * 3 + 2] = triangles[t * 3 + 2];
+            m_TriangleFaces[i] = faces[t];
+        }
+    });
+    return true;
+}
+
+bool MeshBvh::Refit(const Mesh& mesh) {
+    if (m_Mesh != &mesh || m_TopologyVersion != mesh.GetTopologyVersion()) {
+        std::cerr << "MeshBvh: Refit() needs the mesh the hierarchy was built from, unchanged in topology"
+                  << std::endl;
+        return false;
+    }
+    m_Positions = mesh.GetPositions();
+    RefitBounds();
+    m_EditCursor = mesh.GetEditCursor();
+    return true;
+}
+
+bool MeshBvh::Refit(const std::vector<Vec3f>& positions) {
+    if (positions.size() != m_Positions.size()) {
+        std::cerr << "MeshBvh: Refit() with a different vertex count" << std::endl;
+        return false;
+    }
+    m_Positions = positions;
+    RefitBounds();
+    return true;
+}
+
+bool MeshBvh::Update(const Mesh& mesh) {
+    if (m_Mesh != &mesh || m_TopologyVersion != mesh.GetTopologyVersion()) {
+        return Build(mesh);
+    }
+    if (m_EditCursor != mesh.GetEditCursor()) {
+        return Refit(mesh);
+    }
+    return true;
+}
+
+void MeshBvh::RefitBounds() {
+    // Leaves in parallel, then interior nodes in reverse: children always
+    // follow their parent in the depth-first layout
+    parallel::For(m_Nodes.size(), GrainSize, [&](size_t begin, size_t end) {
+        for (size_t n = begin; n < end; ++n) {
+            Node& node = m_Nodes[n];
+            if (node.count == 0) {
+                continue;
+            }
+            Box box;
+            for (uint32_t i = node.offset * 3, last = (node.offset + node.count) * 3; i < last; ++i) {
+                box.Grow(m_Positions[m_Triangles[i]]);
+            }
+            node.min = box.min;
+            node.max = box.max;
+        }
+    });
+    for (size_t n = m_Nodes.size(); n-- > 0;) {
+        Node& node = m_Nodes[n];
+        if (node.count == 0) {
+            const Node& left = m_Nodes[n + 1];
+            const Node& right = m_Nodes[node.offset];
+            node.min = Min(left.min, right.min);
+            node.max = Max(left.max, right.max);
+        }
+    }
+}
+
+bool MeshBvh::Intersect(const Ray& ray, RayHit& hit) const {
+    hit = RayHit();
+    if (m_Nodes.empty()) {
+        return false;
+    }
+    Vec3f inverse(1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z);
+    float tMax = ray.tMax, tNear;
+    if (!SlabTest(m_Nodes[0], ray.origin, inverse, ray.tMin, tMax, tNear)) {
+        return false;
+    }
+    const ShearedRays sheared = ShearRay(ray.origin, ray.direction);
+    uint32_t stack[StackSize];
+    int top = 0;
+    uint32_t current = 0;
+    while (true) {
+        const Node& node = m_Nodes[current];
+        if (node.count > 0) {
+            for (uint32_t t = node.offset; t < node.offset + node.count; ++t) {
+                const uint32_t* corners = &m_Triangles[size_t(t) * 3];
+                float distance, u, v;
+                if (IntersectTriangle(sheared, m_Positions, corners, distance, u, v) &&
+                    distance >= ray.tMin && IsCloser(distance, t, hit, ray.tMax)) {
+                    tMax = distance;
+                    hit.t = distance;
+                    hit.triangle = t;
+                    hit.u = u;
+                    hit.v = v;
+                }
+            }
+        } else {
+            uint32_t left = current + 1, right = node.offset;
+            float tLeft, tRight;
+            bool hitLeft = SlabTest(m_Nodes[left], ray.origin, inverse, ray.tMin, tMax, tLeft);
+            bool hitRight = SlabTest(m_Nodes[right], ray.origin, inverse, ray.tMin, tMax, tRight);
+            if (hitLeft && hitRight) {
+                if (tRight < tLeft) {
+                    std::swap(left, right);
+                }
+                stack[top++] = right;
+                current = left;
+                continue;
+            }
+            if (hitLeft || hitRight) {
+                current = hitLeft ? left : right;
+                continue;
+            }
+        }
+        if (top == 0) {
+            break;
+        }
+        current = stack[--top];
+    }
+    if (hit.IsHit()) {
+        hit.face = m_TriangleFaces[hit.triangle];
+    }
+    return hit.IsHit();
+}
+
+bool MeshBvh::IsOccluded(const Ray& ray) const {
+    if (m_Nodes.empty()) {
+        return false;
+    }
+    Vec3f inverse(1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z);
+    const ShearedRays sheared = ShearRay(ray.origin, ray.direction);
+    uint32_t stack[StackSize];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        const Node& node = m_Nodes[stack[--top]];
+        float tNear;
+        if (!SlabTest(node, ray.origin, inverse, ray.tMin, ray.tMax, tNear)) {
+            continue;
+        }
+        if (node.count == 0) {
+            stack[top++] = node.offset;
+            stack[top++] = uint32_t(&node - m_Nodes.data()) + 1;
+            continue;
+        }
+        for (uint32_t t = node.offset; t < node.offset + node.count; ++t) {
+            const uint32_t* corners = &m_Triangles[size_t(t) * 3];
+            float distance, u, v;
+            if (IntersectTriangle(sheared, m_Positions, corners, distance, u, v) &&
+                distance >= ray.tMin && distance < ray.tMax) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void MeshBvh::Intersect(const std::vector<Ray>& rays, std::vector<RayHit>& hits) const {
+    hits.resize(rays.size());
+    Intersect(rays.data(), hits.data(), rays.size());
+}
+
+void MeshBvh::Intersect(const Ray* rays, RayHit* hits, size_t count) const {
+    constexpr size_t Width = simd::FloatV::Width;
+    size_t packets = (count + Width - 1) / Width;
+    parallel::For(packets, 16, [&](size_t begin, size_t end) {
+        for (size_t p = begin; p < end; ++p) {
+            size_t first = p * Width;
+            IntersectPacket(rays + first, hits + first, std::min(Width, count - first));
+        }
+    });
+}
+
+void MeshBvh::IntersectPacket(const Ray* rays, RayHit* hits, size_t count) const {
+    using simd::FloatV;
+    constexpr int Width = FloatV::Width;
+    for (size_t i = 0; i < count; ++i) {
+        hits[i] = RayHit();
+    }
+    if (m_Nodes.empty()) {
+        return;
+    }
+
+    // Rays as structure of arrays; missing lanes get an empty interval
+    alignas(32) float lanes[17][Width];
+    for (int i = 0; i < Width; ++i) {
+        const Ray& ray = rays[size_t(i) < count ? i : 0];
+        lanes[0][i] = ray.origin.x;
+        lanes[1][i] = ray.origin.y;
+        lanes[2][i] = ray.origin.z;
+        lanes[3][i] = ray.direction.x;
+        lanes[4][i] = ray.direction.y;
+        lanes[5][i] = ray.direction.z;
+        lanes[6][i] = size_t(i) < count ? ray.tMin : 1.0f;
+        lanes[7][i] = size_t(i) < count ? ray.tMax : -1.0f;
+        float rows[9];
+        ShearRows(ray.direction, rows);
+        for (int r = 0; r < 9; ++r) {
+            lanes[8 + r][i] = rows[r];
+        }
+    }
+    ShearedRays sheared;
+    const FloatV ox = sheared.ox = FloatV::Load(lanes[0]);
+    const FloatV oy = sheared.oy = FloatV::Load(lanes[1]);
+    const FloatV oz = sheared.oz = FloatV::Load(lanes[2]);
+    for (int r = 0; r < 9; ++r) {
+        sheared.rows[r] = FloatV::Load(lanes[8 + r]);
+    }
+    const FloatV dx = FloatV::Load(lanes[3]), dy = FloatV::Load(lanes[4]), dz = FloatV::Load(lanes[5]);
+    const FloatV one = FloatV::Broadcast(1.0f), zero = FloatV::Broadcast(0.0f);
+    const FloatV ix = one / dx, iy = one / dy, iz = one / dz;
+    const FloatV tMin = FloatV::Load(lanes[6]);
+    FloatV tMax = FloatV::Load(lanes[7]);
+    FloatV hitU = zero, hitV = zero;
+    FloatV hitTriangle = simd::AsFloat(simd::IntV::Broadcast(-1));
+
+    // Children are visited in the order the first ray's direction suggests
+    const bool negative[3] = {rays[0].direction.x < 0.0f, rays[0].direction.y < 0.0f, rays[0].direction.z < 0.0f};
+    uint32_t stack[StackSize];
+    int top = 0;
+    uint32_t current = 0;
+    while (true) {
+        const Node& node = m_Nodes[current];
+        FloatV x0 = (FloatV::Broadcast(node.min.x) - ox) * ix, x1 = (FloatV::Broadcast(node.max.x) - ox) * ix;
+        FloatV y0 = (FloatV::Broadcast(node.min.y) - oy) * iy, y1 = (FloatV::Broadcast(node.max.y) - oy) * iy;
+        FloatV z0 = (FloatV::Broadcast(node.min.z) - oz) * iz, z1 = (FloatV::Broadcast(node.max.z) - oz) * iz;
+        FloatV near = Max(Max(Min(x0, x1), Min(y0, y1)), Max(Min(z0, z1), tMin));
+        FloatV far = Min(Min(Min(Max(x0, x1), Max(y0, y1)), Max(z0, z1)), tMax) * FloatV::Broadcast(SlabScale);
+        FloatV active = CmpLe(near, far);
+        if (simd::MoveMask(active) != 0) {
+            if (node.count == 0) {
+                uint32_t left = current + 1, right = node.offset;
+                if (negative[node.axis]) {
+                    std::swap(left, right);
+                }
+                stack[top++] = right;
+                current = left;
+                continue;
+            }
+            for (uint32_t t = node.offset; t < node.offset + node.count; ++t) {
+                const uint32_t* corners = &m_Triangles[size_t(t) * 3];
+                FloatV distance, u, v;
+                FloatV mask = IntersectTriangle(sheared, m_Positions, corners, distance, u, v);
+                // Same rule as IsCloser: ties go to the lower triangle
+                FloatV index = simd::AsFloat(simd::IntV::Broadcast(int32_t(t)));
+                FloatV tie = And(CmpEq(distance, tMax), CmpGt(simd::AsInt(hitTriangle), simd::AsInt(index)));
+                // Lanes whose own ray missed the leaf skip it, as a single ray would
+                mask = And(And(mask, active), And(CmpLe(tMin, distance), Or(CmpLt(distance, tMax), tie)));
+                if (simd::MoveMask(mask) == 0) {
+                    continue;
+                }
+                tMax = Select(mask, distance, tMax);
+                hitU = Select(mask, u, hitU);
+                hitV = Select(mask, v, hitV);
+                hitTriangle = Select(mask, index, hitTriangle);
+            }
+        }
+        if (top == 0) {
+            break;
+        }
+        current = stack[--top];
+    }
+
+    alignas(32) float t[Width], u[Width], v[Width];
+    alignas(32) int32_t triangle[Width];
+    tMax.Store(t);
+    hitU.Store(u);
+    hitV.Store(v);
+    simd::AsInt(hitTriangle).Store(triangle);
+    for (size_t i = 0; i < count; ++i) {
+        if (triangle[i] >= 0) {
+            hits[i].t = t[i];
+            hits[i].triangle = uint32_t(triangle[i]);
+            hits[i].face = m_TriangleFaces[uint32_t(triangle[i])];
+            hits[i].u = u[i];
+            hits[i].v = v[i];
+        }
+    }
+}
+
+bool MeshBvh::FindClosestPoint(const Vec3f& point, ClosestPoint& result, float maxDistance) const {
+    result = ClosestPoint();
+    if (m_Nodes.empty()) {
+        return false;
+    }
+    float best = maxDistance < std::sqrt(std::numeric_limits<float>::max()) ? maxDistance * maxDistance
+                                                                             : std::numeric_limits<float>::max();
+    struct Entry {
+        uint32_t node;
+        float distance;
+    };
+    Entry stack[StackSize];
+    int top = 0;
+    stack[top++] = {0, BoxDistanceSquared(m_Nodes[0], point)};
+    while (top > 0) {
+        Entry entry = stack[--top];
+        if (entry.distance > best) {
+            continue;
+        }
+        const Node& node = m_Nodes[entry.node];
+        if (node.count == 0) {
+            uint32_t left = entry.node + 1, right = node.offset;
+            float dLeft = BoxDistanceSquared(m_Nodes[left], point);
+            float dRight = BoxDistanceSquared(m_Nodes[right], point);
+            // Nearer child on top of the stack
+            if (dLeft < dRight) {
+                std::swap(left, right);
+                std::swap(dLeft, dRight);
+            }
+            if (dLeft <= best) {
+                stack[top++] = {left, dLeft};
+            }
+            if (dRight <= best) {
+                stack[top++] = {right, dRight};
+            }
+            continue;
+        }
+        for (uint32_t t = node.offset; t < node.offset + node.count; ++t) {
+            const uint32_t* corners = &m_Triangles[size_t(t) * 3];
+            Vec3f candidate = ClosestPointOnTriangle(point, m_Positions[corners[0]], m_Positions[corners[1]],
+                                                     m_Positions[corners[2]]);
+            float distance = candidate.SquareDistanceTo(point);
+            if (distance <= best) {
+                best = distance;
+                result.point = candidate;
+                result.distanceSquared = distance;
+                result.triangle = t;
+            }
+        }
+    }
+    if (result.IsFound()) {
+        result.face = m_TriangleFaces[result.triangle];
+    }
+    return result.IsFound();
+}
+
+} // namespace alice2
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "Mesh.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace alice2 {
+
+struct Ray {
+    Vec3f origin;
+    Vec3f direction; // Need not be unit length; t is measured in its units
+    float tMin = 0.0f;
+    float tMax = std::numeric_limits<float>::max();
+};
+
+struct RayHit {
+    float t = std::numeric_limits<float>::max();
+    uint32_t triangle = INVALID_INDEX; // Into GetTriangles()
+    uint32_t face = INVALID_INDEX;     // Mesh face, or the input triangle for raw triangle lists
+    float u = 0.0f; // Barycentric weights of the triangle's second and third corners
+    float v = 0.0f;
+
+    bool IsHit() const { return triangle != INVALID_INDEX; }
+};
+
+struct ClosestPoint {
+    Vec3f point;
+    float distanceSquared = std::numeric_limits<float>::max();
+    uint32_t triangle = INVALID_INDEX;
+    uint32_t face = INVALID_INDEX;
+
+    bool IsFound() const { return triangle != INVALID_INDEX; }
+};
+
+// Bounding volume hierarchy over the triangles of a mesh (polygons are fanned)
+// for ray casting, picking and closest-point queries. The builder bins
+// centroids into up to 16 slots per axis and splits at the lowest surface area
+// cost; large nodes bin in parallel, and once enough independent subtrees
+// exist they are built concurrently. Nodes are 32 bytes and stored depth
+// first, so the left child follows its parent and leaves reference a
+// contiguous run of triangles whose corner indices are copied alongside.
+//
+// When only positions change, Refit() recomputes the boxes bottom-up
+// without touching the structure; quality degrades with large deformations,
+// at which point a rebuild restores it. Update() picks between the two from
+// the mesh's topology version and edit cursor.
+class MeshBvh {
+public:
+    struct Node {
+        Vec3f min;
+        uint32_t offset;   // Leaf: first triangle; interior: right child (left is the next node)
+        Vec3f max;
+        uint16_t count;    // Triangles in a leaf, 0 for interior nodes
+        uint16_t axis;     // Split axis of an interior node
+    };
+
+    static constexpr uint32_t MaxLeafSize = 8;
+
+    bool Build(const Mesh& mesh);
+    bool Build(const std::vector<Vec3f>& positions, const std::vector<uint32_t>& triangles);
+    // Same triangles, moved vertices
+    bool Refit(const Mesh& mesh);
+    bool Refit(const std::vector<Vec3f>& positions);
+    // Rebuild after a topology change, refit after vertex edits, else nothing
+    bool Update(const Mesh& mesh);
+    void Clear();
+
+    // Closest hit along the ray within [tMin, tMax]. The triangle test is
+    // watertight, and equal distances go to the lower triangle, so the
+    // batched Intersect below returns exactly the same hits.
+    bool Intersect(const Ray& ray, RayHit& hit) const;
+    // Any hit within [tMin, tMax]; stops at the first one found
+    bool IsOccluded(const Ray& ray) const;
+    // Batch of rays traced in SIMD packets of consecutive rays, packets in
+    // parallel; coherent batches (camera rays in tile order) traverse fastest
+    void Intersect(const Ray* rays, RayHit* hits, size_t count) const;
+    void Intersect(const std::vector<Ray>& rays, std::vector<RayHit>& hits) const;
+
+    // Nearest point on the surface within maxDistance
+    bool FindClosestPoint(const Vec3f& point, ClosestPoint& result,
+                          float maxDistance = std::numeric_limits<float>::max()) const;
+
+    const std::vector<Node>& GetNodes() const { return m_Nodes; }
+    // Corner indices of the triangles in leaf order
+    const std::vector<uint32_t>& GetTriangles() const { return m_Triangles; }
+    size_t GetTriangleCount() const { return m_Triangles.size() / 3; }
+    bool IsEmpty() const { return m_Nodes.empty(); }
+
+private:
+    std::vector<Node> m_Nodes;
+    std::vector<uint32_t> m_Triangles;     // 3 per triangle, leaf order
+    std::vector<uint32_t> m_TriangleFaces; // Source face per triangle, leaf order
+    std::vector<Vec3f> m_Positions;        // Copy the queries read from
+
+    const Mesh* m_Mesh = nullptr;
+    uint64_t m_TopologyVersion = 0;
+    uint64_t m_EditCursor = 0;
+
+    bool BuildTriangles(const std::vector<Vec3f>& positions, std::vector<uint32_t>& triangles,
+                        std::vector<uint32_t>& faces);
+    void RefitBounds();
+    void IntersectPacket(const Ray* rays, RayHit* hits, size_t count) const;
+};
+
+} // namespace alice2
@@ -0,0 +1,100 @@
+#include "MeshFeatures.h"
+#include "../utilities/Parallel.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace alice2 {
+
+namespace {
+
+constexpr size_t GrainSize = 4096;
+
+} // namespace
+
+size_t FeatureEdges::Extract(const Mesh& mesh, const FeatureEdgeSettings& settings) {
+    m_Normals.Update(mesh);
+    const std::vector<Vec3f>& normals = m_Normals.GetFaceNormals();
+    const std::vector<Vec3f>& positions = mesh.GetPositions();
+    const std::vector<float>* creases =
+        settings.creases ? mesh.GetAttributes(MeshElement::Edge).Get<float>("crease") : nullptr;
+    if (creases && creases->size() != mesh.GetEdgeCount()) {
+        creases = nullptr;
+    }
+    const float sharpAngle = std::max(settings.sharpAngle, 0.0f);
+
+    size_t edgeCount = mesh.GetEdgeCount();
+    m_Angles.resize(edgeCount);
+    m_EdgeFlags.resize(edgeCount);
+    size_t chunkCount = parallel::ChunkCount(edgeCount, GrainSize);
+    size_t chunkSize = chunkCount > 0 ? (edgeCount + chunkCount - 1) / chunkCount : 0;
+    m_ChunkOffsets.assign(chunkCount + 1, 0);
+
+    // Pass 1: classify every edge and count the features of each chunk
+    parallel::ForChunks(chunkCount, [&](size_t chunk) {
+        size_t begin = chunk * chunkSize, end = std::min(edgeCount, begin + chunkSize);
+        size_t count = 0;
+        for (size_t e = begin; e < end; ++e) {
+            uint32_t h = mesh.EdgeHalfEdge(static_cast<uint32_t>(e));
+            uint32_t f0 = mesh.Face(h), f1 = mesh.Face(mesh.Twin(h));
+            uint8_t flags = 0;
+            float angle = 0.0f;
+            if (f0 == INVALID_INDEX || f1 == INVALID_INDEX) {
+                flags |= settings.boundary ? Boundary : 0;
+            } else {
+                const Vec3f& n0 = normals[f0];
+                const Vec3f& n1 = normals[f1];
+                const Vec3f& source = positions[mesh.Source(h)];
+                Vec3f direction = (positions[mesh.Target(h)] - source).Normalize();
+                angle = std::atan2(direction.Dot(n0.Cross(n1)), n0.Dot(n1)) * RAD_TO_DEG;
+                if (settings.sharp && std::abs(angle) >= sharpAngle && n0.Dot(n0) > 0.0f && n1.Dot(n1) > 0.0f) {
+                    flags |= Sharp;
+                }
+                if (settings.silhouette) {
+                    // The edge lies in both face planes, so its source point
+                    // serves as the view ray target for either face
+                    Vec3f view = settings.orthographic ? settings.viewOrigin : source - settings.viewOrigin;
+                    if (n0.Dot(view) * n1.Dot(view) < 0.0f) {
+                        flags |= Silhouette;
+                    }
+                }
+            }
+            if (creases && (*creases)[e] > 0.0f) {
+                flags |= Crease;
+            }
+            m_Angles[e] = angle;
+            m_EdgeFlags[e] = flags;
+            count += flags != 0;
+        }
+        m_ChunkOffsets[chunk + 1] = count;
+    });
+
+    for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+        m_ChunkOffsets[chunk + 1] += m_ChunkOffsets[chunk];
+    }
+    size_t featureCount = m_ChunkOffsets[chunkCount];
+    m_Edges.resize(featureCount);
+    m_Flags.resize(featureCount);
+    m_Indices.resize(featureCount * 2);
+
+    // Pass 2: each chunk writes its features at its prefix offset, so the
+    // output stays in edge order whatever the thread count
+    parallel::ForChunks(chunkCount, [&](size_t chunk) {
+        size_t begin = chunk * chunkSize, end = std::min(edgeCount, begin + chunkSize);
+        size_t out = m_ChunkOffsets[chunk];
+        for (size_t e = begin; e < end; ++e) {
+            if (m_EdgeFlags[e] == 0) {
+                continue;
+            }
+            uint32_t h = mesh.EdgeHalfEdge(static_cast<uint32_t>(e));
+            m_Edges[out] = static_cast<uint32_t>(e);
+            m_Flags[out] = m_EdgeFlags[e];
+            m_Indices[2 * out] = mesh.Source(h);
+            m_Indices[2 * out + 1] = mesh.Target(h);
+            ++out;
+        }
+    });
+    return featureCount;
+}
+
+} // namespace alice2
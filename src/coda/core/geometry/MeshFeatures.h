@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Mesh.h"
+#include "MeshNormals.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace alice2 {
+
+struct FeatureEdgeSettings {
+    bool sharp = true;
+    float sharpAngle = 30.0f; // Degrees between the two face normals
+    bool boundary = true;
+    bool creases = true;      // Edges with a positive "crease" attribute
+    bool silhouette = false;
+    // Camera position for silhouettes; under an orthographic projection the
+    // view direction instead
+    Vec3f viewOrigin;
+    bool orthographic = false;
+};
+
+// Batch feature-edge extraction over the unique edges of a mesh. Every edge
+// is classified once, in parallel, and the result is a compact list of edges
+// with their vertex index pairs, ready for an indexed line buffer. Face
+// normals are kept in a MeshNormals cache, so after vertex edits only the
+// moved one-rings are re-normalised before the edges are classified again.
+class FeatureEdges {
+public:
+    static constexpr uint8_t Sharp = 1;
+    static constexpr uint8_t Boundary = 2;
+    static constexpr uint8_t Crease = 4;
+    static constexpr uint8_t Silhouette = 8;
+
+    // Returns the number of feature edges found
+    size_t Extract(const Mesh& mesh, const FeatureEdgeSettings& settings = FeatureEdgeSettings());
+
+    const std::vector<uint32_t>& GetEdges() const { return m_Edges; }
+    const std::vector<uint8_t>& GetFlags() const { return m_Flags; }        // Per extracted edge
+    const std::vector<uint32_t>& GetIndices() const { return m_Indices; }   // Vertex pairs, edge order
+    size_t GetCount() const { return m_Edges.size(); }
+
+    // Signed dihedral angle in degrees of every mesh edge from the last
+    // Extract(), as Vec3f::DihedralAngle along Source -> Target of the
+    // edge's first half-edge; positive on convex edges, zero on the boundary
+    const std::vector<float>& GetDihedralAngles() const { return m_Angles; }
+
+private:
+    MeshNormals m_Normals;
+    std::vector<float> m_Angles;
+    std::vector<uint8_t> m_EdgeFlags;        // Per mesh edge
+    std::vector<size_t> m_ChunkOffsets;
+
+    std::vector<uint32_t> m_Edges;
+    std::vector<uint8_t> m_Flags;
+    std::vector<uint32_t> m_Indices;
+};
+
+} // namespace alice2
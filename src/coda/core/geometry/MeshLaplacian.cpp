@@ -0,0 +1,128 @@
+#include "MeshLaplacian.h"
+#include "../utilities/Parallel.h"
+
+#include <iostream>
+
+namespace alice2 {
+
+namespace {
+
+constexpr size_t GrainSize = 4096;
+
+// Cotangent of the angle at the corner opposite h in its triangle
+float OppositeCotangent(const Mesh& mesh, uint32_t h) {
+    if (mesh.Face(h) == INVALID_INDEX) {
+        return 0.0f;
+    }
+    const Vec3f& corner = mesh.GetPosition(mesh.Target(mesh.Next(h)));
+    return (mesh.GetPosition(mesh.Source(h)) - corner).Cotan(mesh.GetPosition(mesh.Target(h)) - corner);
+}
+
+} // namespace
+
+void MeshLaplacian::SetWeighting(LaplacianWeighting weighting) {
+    if (weighting != m_Weighting) {
+        m_Weighting = weighting;
+        m_Mesh = nullptr;
+    }
+}
+
+void MeshLaplacian::BuildPattern(const Mesh& mesh) {
+    uint32_t vertexCount = static_cast<uint32_t>(mesh.GetVertexCount());
+    std::vector<sparse::Triplet> triplets;
+    triplets.reserve(vertexCount + mesh.GetHalfEdgeCount());
+    for (uint32_t v = 0; v < vertexCount; ++v) {
+        triplets.push_back({v, v, 0.0});
+    }
+    for (uint32_t h = 0; h < mesh.GetHalfEdgeCount(); ++h) {
+        triplets.push_back({mesh.Source(h), mesh.Target(h), 0.0});
+    }
+    m_Matrix.SetFromTriplets(vertexCount, vertexCount, triplets);
+
+    m_HalfEdgePositions.resize(mesh.GetHalfEdgeCount());
+    m_DiagonalPositions.resize(vertexCount);
+    parallel::For(mesh.GetHalfEdgeCount(), GrainSize, [&](size_t begin, size_t end) {
+        for (size_t h = begin; h < end; ++h) {
+            uint32_t he = static_cast<uint32_t>(h);
+            m_HalfEdgePositions[h] = static_cast<uint32_t>(m_Matrix.Find(mesh.Source(he), mesh.Target(he)));
+        }
+    });
+    parallel::For(vertexCount, GrainSize, [&](size_t begin, size_t end) {
+        for (size_t v = begin; v < end; ++v) {
+            uint32_t vertex = static_cast<uint32_t>(v);
+            m_DiagonalPositions[v] = static_cast<uint32_t>(m_Matrix.Find(vertex, vertex));
+        }
+    });
+
+    m_FaceCorners.resize(mesh.GetFaceCount());
+    m_Triangles = true;
+    for (uint32_t f = 0; f < mesh.GetFaceCount(); ++f) {
+        uint32_t start = mesh.FaceHalfEdge(f);
+        uint32_t corners = 0;
+        uint32_t h = start;
+        do {
+            ++corners;
+            h = mesh.Next(h);
+        } while (h != start);
+        m_FaceCorners[f] = corners;
+        m_Triangles = m_Triangles && corners == 3;
+    }
+
+    m_Mesh = &mesh;
+    m_TopologyVersion = mesh.GetTopologyVersion();
+}
+
+bool MeshLaplacian::Update(const Mesh& mesh) {
+    if (m_Mesh != &mesh || m_TopologyVersion != mesh.GetTopologyVersion()) {
+        BuildPattern(mesh);
+    }
+    bool cotangent = m_Weighting == LaplacianWeighting::Cotangent;
+    if (cotangent && !m_Triangles) {
+        std::cerr << "MeshLaplacian: cotangent weights need a triangle mesh" << std::endl;
+        return false;
+    }
+
+    m_EdgeWeights.resize(mesh.GetEdgeCount());
+    parallel::For(mesh.GetEdgeCount(), GrainSize, [&](size_t begin, size_t end) {
+        for (size_t e = begin; e < end; ++e) {
+            uint32_t h = mesh.EdgeHalfEdge(static_cast<uint32_t>(e));
+            m_EdgeWeights[e] = cotangent
+                ? 0.5 * (double(OppositeCotangent(mesh, h)) + double(OppositeCotangent(mesh, mesh.Twin(h))))
+                : 1.0;
+        }
+    });
+
+    // Each vertex owns its row, so rows are gathered without atomics
+    m_Areas.Update(mesh);
+    const std::vector<float>& areas = m_Areas.GetFaceAreas();
+    const std::vector<uint32_t>& offsets = m_Matrix.GetRowOffsets();
+    std::vector<double>& values = m_Matrix.GetValues();
+    m_Mass.resize(mesh.GetVertexCount());
+    parallel::For(mesh.GetVertexCount(), GrainSize, [&](size_t begin, size_t end) {
+        for (size_t v = begin; v < end; ++v) {
+            std::fill(values.begin() + offsets[v], values.begin() + offsets[v + 1], 0.0);
+            uint32_t start = mesh.VertexHalfEdge(static_cast<uint32_t>(v));
+            if (start == INVALID_INDEX) {
+                m_Mass[v] = 1.0; // Isolated vertices stay put in implicit solves
+                continue;
+            }
+            double diagonal = 0.0, mass = 0.0;
+            uint32_t h = start;
+            do {
+                double weight = m_EdgeWeights[mesh.Edge(h)];
+                values[m_HalfEdgePositions[h]] -= weight;
+                diagonal += weight;
+                uint32_t f = mesh.Face(h);
+                if (f != INVALID_INDEX) {
+                    mass += double(areas[f]) / m_FaceCorners[f];
+                }
+                h = mesh.Twin(mesh.Prev(h));
+            } while (h != start);
+            values[m_DiagonalPositions[v]] += diagonal;
+            m_Mass[v] = mass;
+        }
+    });
+    return true;
+}
+
+} // namespace alice2
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Mesh.h"
+#include "MeshNormals.h"
+#include "../utilities/Sparse.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace alice2 {
+
+enum class LaplacianWeighting {
+    Uniform,   // Graph Laplacian, any polygon mesh
+    Cotangent  // w_ij = (cot a + cot b) / 2, triangle meshes
+};
+
+// Discrete Laplacian L = D - W of a mesh (symmetric positive semi-definite)
+// with the lumped barycentric mass matrix. The sparsity pattern is built once
+// per topology; Update() afterwards only rewrites values, computing the edge
+// weights in parallel, so solvers can keep their symbolic factorisation.
+class MeshLaplacian {
+public:
+    explicit MeshLaplacian(LaplacianWeighting weighting = LaplacianWeighting::Cotangent)
+        : m_Weighting(weighting) {}
+
+    void SetWeighting(LaplacianWeighting weighting);
+    LaplacianWeighting GetWeighting() const { return m_Weighting; }
+
+    // False when cotangent weights are asked of a non-triangle mesh
+    bool Update(const Mesh& mesh);
+
+    const sparse::CsrMatrix& GetMatrix() const { return m_Matrix; }
+    const std::vector<double>& GetMass() const { return m_Mass; }
+    const std::vector<double>& GetEdgeWeights() const { return m_EdgeWeights; }
+    // Position of each vertex's diagonal entry in GetMatrix().GetValues()
+    const std::vector<uint32_t>& GetDiagonalPositions() const { return m_DiagonalPositions; }
+    uint64_t GetTopologyVersion() const { return m_TopologyVersion; }
+
+private:
+    LaplacianWeighting m_Weighting;
+
+    const Mesh* m_Mesh = nullptr;
+    uint64_t m_TopologyVersion = 0;
+
+    sparse::CsrMatrix m_Matrix;
+    std::vector<double> m_Mass;
+    std::vector<double> m_EdgeWeights;
+    std::vector<uint32_t> m_HalfEdgePositions; // Value position of (Source(h), Target(h))
+    std::vector<uint32_t> m_DiagonalPositions;
+    std::vector<uint32_t> m_FaceCorners;
+    bool m_Triangles = false;
+    MeshNormals m_Areas;
+
+    void BuildPattern(const Mesh& mesh);
+};
+
+} // namespace alice2
@@ -0,0 +1,277 @@
+#include "MeshNormals.h"
+#include "../utilities/Math.h"
+#include "../utilities/Parallel.h"
+#include "../utilities/Simd.h"
+
+#include <algorithm>
+
+namespace alice2 {
+
+using namespace simd;
+
+namespace {
+
+constexpr size_t GrainSize = 4096;
+constexpr size_t BlockSize = 64;
+
+// Corner positions of a block of triangles in SoA form, and the results of
+// the vectorised pass over it
+struct TriangleBlock {
+    float ax[BlockSize], ay[BlockSize], az[BlockSize];
+    float bx[BlockSize], by[BlockSize], bz[BlockSize];
+    float cx[BlockSize], cy[BlockSize], cz[BlockSize];
+    float nx[BlockSize], ny[BlockSize], nz[BlockSize];
+    float doubleArea[BlockSize], dotA[BlockSize], dotB[BlockSize];
+};
+
+template <typename V>
+inline void TriangleKernel(TriangleBlock& t, size_t i) {
+    V ax = V::Load(t.ax + i), ay = V::Load(t.ay + i), az = V::Load(t.az + i);
+    V e1x = V::Load(t.bx + i) - ax, e1y = V::Load(t.by + i) - ay, e1z = V::Load(t.bz + i) - az;
+    V e2x = V::Load(t.cx + i) - ax, e2y = V::Load(t.cy + i) - ay, e2z = V::Load(t.cz + i) - az;
+
+    V nx = e1y * e2z - e1z * e2y;
+    V ny = e1z * e2x - e1x * e2z;
+    V nz = e1x * e2y - e1y * e2x;
+    V length = Sqrt(MulAdd(nx, nx, MulAdd(ny, ny, nz * nz)));
+
+    // Degenerate triangles get a zero normal rather than NaNs
+    V valid = CmpGt(length, V::Broadcast(0.0f));
+    V inverse = And(valid, V::Broadcast(1.0f) / Max(length, V::Broadcast(1e-30f)));
+    (nx * inverse).Store(t.nx + i);
+    (ny * inverse).Store(t.ny + i);
+    (nz * inverse).Store(t.nz + i);
+    length.Store(t.doubleArea + i);
+
+    // Corner angles are atan2(|e1 x e2|, e1 . e2); the cross length is shared
+    V e3x = V::Load(t.cx + i) - V::Load(t.bx + i);
+    V e3y = V::Load(t.cy + i) - V::Load(t.by + i);
+    V e3z = V::Load(t.cz + i) - V::Load(t.bz + i);
+    MulAdd(e1x, e2x, MulAdd(e1y, e2y, e1z * e2z)).Store(t.dotA + i);
+    (-MulAdd(e1x, e3x, MulAdd(e1y, e3y, e1z * e3z))).Store(t.dotB + i);
+}
+
+// Newell's method: twice the area times the unit normal, exact for planar
+// polygons and a stable average for non-planar ones
+Vec3f NewellNormal(const Mesh& mesh, uint32_t face) {
+    Vec3f normal;
+    uint32_t start = mesh.FaceHalfEdge(face);
+    uint32_t h = start;
+    do {
+        const Vec3f& a = mesh.GetPosition(mesh.Source(h));
+        const Vec3f& b = mesh.GetPosition(mesh.Target(h));
+        normal.x += (a.y - b.y) * (a.z + b.z);
+        normal.y += (a.z - b.z) * (a.x + b.x);
+        normal.z += (a.x - b.x) * (a.y + b.y);
+        h = mesh.Next(h);
+    } while (h != start);
+    return normal;
+}
+
+template <typename Fn>
+void ForIndices(const uint32_t* indices, size_t count, Fn&& fn) {
+    parallel::For(count, GrainSize, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            fn(indices ? indices[i] : static_cast<uint32_t>(i));
+        }
+    });
+}
+
+} // namespace
+
+void MeshNormals::SetWeighting(NormalWeighting weighting) {
+    if (weighting != m_Weighting) {
+        m_Weighting = weighting;
+        Invalidate();
+    }
+}
+
+size_t MeshNormals::Update(const Mesh& mesh) {
+    if (m_Mesh != &mesh || m_TopologyVersion != mesh.GetTopologyVersion()
+        || !mesh.GetEditsSince(m_EditCursor, m_EditedVertices)) {
+        Rebuild(mesh);
+        return mesh.GetFaceCount();
+    }
+    m_EditCursor = mesh.GetEditCursor();
+    if (m_EditedVertices.empty()) {
+        return 0;
+    }
+
+    // Faces around the moved vertices
+    NextStamp();
+    m_DirtyFaces.clear();
+    for (uint32_t v : m_EditedVertices) {
+        uint32_t start = mesh.VertexHalfEdge(v);
+        if (start == INVALID_INDEX) {
+            continue;
+        }
+        uint32_t h = start;
+        do {
+            uint32_t f = mesh.Face(h);
+            if (f != INVALID_INDEX && m_FaceStamp[f] != m_Stamp) {
+                m_FaceStamp[f] = m_Stamp;
+                m_DirtyFaces.push_back(f);
+            }
+            h = mesh.Twin(mesh.Prev(h));
+        } while (h != start);
+    }
+    if (m_DirtyFaces.size() * 4 > mesh.GetFaceCount()) {
+        Rebuild(mesh);
+        return mesh.GetFaceCount();
+    }
+
+    // Every corner of a recomputed face needs its vertex normal refreshed
+    m_DirtyVertices.clear();
+    for (uint32_t f : m_DirtyFaces) {
+        uint32_t start = mesh.FaceHalfEdge(f);
+        uint32_t h = start;
+        do {
+            uint32_t v = mesh.Source(h);
+            if (m_VertexStamp[v] != m_Stamp) {
+                m_VertexStamp[v] = m_Stamp;
+                m_DirtyVertices.push_back(v);
+            }
+            h = mesh.Next(h);
+        } while (h != start);
+    }
+
+    ComputeFaces(mesh, m_DirtyFaces.data(), m_DirtyFaces.size());
+    ComputeVertices(mesh, m_DirtyVertices.data(), m_DirtyVertices.size());
+    return m_DirtyFaces.size();
+}
+
+void MeshNormals::Rebuild(const Mesh& mesh) {
+    m_Mesh = &mesh;
+    m_TopologyVersion = mesh.GetTopologyVersion();
+    m_EditCursor = mesh.GetEditCursor();
+
+    size_t faceCount = mesh.GetFaceCount();
+    m_FaceNormals.resize(faceCount);
+    m_FaceAreas.resize(faceCount);
+    m_VertexNormals.resize(mesh.GetVertexCount());
+    m_CornerAngles.resize(m_Weighting == NormalWeighting::Angle ? mesh.GetHalfEdgeCount() : 0);
+    m_FaceStamp.assign(faceCount, 0);
+    m_VertexStamp.assign(mesh.GetVertexCount(), 0);
+    m_Stamp = 0;
+
+    // Triangle corners are cached so the SIMD gather is a flat index read
+    const auto& next = mesh.GetHalfEdgeNext();
+    m_Triangles = faceCount > 0;
+    for (size_t f = 0; f < faceCount && m_Triangles; ++f) {
+        uint32_t h = mesh.FaceHalfEdge(static_cast<uint32_t>(f));
+        m_Triangles = next[next[next[h]]] == h;
+    }
+    m_Corners.resize(m_Triangles ? faceCount * 3 : 0);
+    if (m_Triangles) {
+        ForIndices(nullptr, faceCount, [&](uint32_t f) {
+            uint32_t h = mesh.FaceHalfEdge(f);
+            m_Corners[f * 3] = mesh.Source(h);
+            m_Corners[f * 3 + 1] = mesh.Target(h);
+            m_Corners[f * 3 + 2] = mesh.Target(mesh.Next(h));
+        });
+    }
+
+    ComputeFaces(mesh, nullptr, faceCount);
+    ComputeVertices(mesh, nullptr, mesh.GetVertexCount());
+}
+
+void MeshNormals::ComputeFaces(const Mesh& mesh, const uint32_t* faces, size_t count) {
+    bool angles = m_Weighting == NormalWeighting::Angle;
+
+    if (!m_Triangles) {
+        ForIndices(faces, count, [&](uint32_t f) {
+            Vec3f normal = NewellNormal(mesh, f);
+            float length = normal.Length();
+            m_FaceNormals[f] = length > 0.0f ? normal / length : Vec3f();
+            m_FaceAreas[f] = 0.5f * length;
+            if (!angles) {
+                return;
+            }
+            uint32_t start = mesh.FaceHalfEdge(f);
+            uint32_t h = start;
+            do {
+                const Vec3f& corner = mesh.GetPosition(mesh.Source(h));
+                Vec3f e1 = mesh.GetPosition(mesh.Target(h)) - corner;
+                Vec3f e2 = mesh.GetPosition(mesh.Source(mesh.Prev(h))) - corner;
+                m_CornerAngles[h] = math::Atan2(e1.Cross(e2).Length(), e1.Dot(e2));
+                h = mesh.Next(h);
+            } while (h != start);
+        });
+        return;
+    }
+
+    size_t blockCount = (count + BlockSize - 1) / BlockSize;
+    parallel::For(blockCount, GrainSize / BlockSize, [&](size_t blockBegin, size_t blockEnd) {
+        TriangleBlock t;
+        float angleA[BlockSize], angleB[BlockSize];
+        const std::vector<Vec3f>& positions = mesh.GetPositions();
+
+        for (size_t block = blockBegin; block < blockEnd; ++block) {
+            size_t first = block * BlockSize;
+            size_t n = std::min(BlockSize, count - first);
+            for (size_t i = 0; i < n; ++i) {
+                uint32_t f = faces ? faces[first + i] : static_cast<uint32_t>(first + i);
+                const Vec3f& a = positions[m_Corners[f * 3]];
+                const Vec3f& b = positions[m_Corners[f * 3 + 1]];
+                const Vec3f& c = positions[m_Corners[f * 3 + 2]];
+                t.ax[i] = a.x; t.ay[i] = a.y; t.az[i] = a.z;
+                t.bx[i] = b.x; t.by[i] = b.y; t.bz[i] = b.z;
+                t.cx[i] = c.x; t.cy[i] = c.y; t.cz[i] = c.z;
+            }
+
+            size_t i = 0;
+            for (; i + FloatV::Width <= n; i += FloatV::Width) {
+                TriangleKernel<FloatV>(t, i);
+            }
+            for (; i < n; ++i) {
+                TriangleKernel<Float1>(t, i);
+            }
+            if (angles) {
+                math::Atan2(t.doubleArea, t.dotA, angleA, n);
+                math::Atan2(t.doubleArea, t.dotB, angleB, n);
+            }
+
+            for (size_t k = 0; k < n; ++k) {
+                uint32_t f = faces ? faces[first + k] : static_cast<uint32_t>(first + k);
+                m_FaceNormals[f] = Vec3f(t.nx[k], t.ny[k], t.nz[k]);
+                m_FaceAreas[f] = 0.5f * t.doubleArea[k];
+                if (angles) {
+                    uint32_t h = mesh.FaceHalfEdge(f);
+                    m_CornerAngles[h] = angleA[k];
+                    m_CornerAngles[mesh.Next(h)] = angleB[k];
+                    m_CornerAngles[mesh.Prev(h)] = 3.14159265f - angleA[k] - angleB[k];
+                }
+            }
+        }
+    });
+}
+
+void MeshNormals::ComputeVertices(const Mesh& mesh, const uint32_t* vertices, size_t count) {
+    // Gather over the one-ring: no scatter, no atomics
+    bool angles = m_Weighting == NormalWeighting::Angle;
+    ForIndices(vertices, count, [&](uint32_t v) {
+        Vec3f sum;
+        uint32_t start = mesh.VertexHalfEdge(v);
+        if (start != INVALID_INDEX) {
+            uint32_t h = start;
+            do {
+                uint32_t f = mesh.Face(h);
+                if (f != INVALID_INDEX) {
+                    sum += m_FaceNormals[f] * (angles ? m_CornerAngles[h] : m_FaceAreas[f]);
+                }
+                h = mesh.Twin(mesh.Prev(h));
+            } while (h != start);
+        }
+        m_VertexNormals[v] = sum.Normalize();
+    });
+}
+
+void MeshNormals::NextStamp() {
+    if (++m_Stamp == 0) {
+        std::fill(m_FaceStamp.begin(), m_FaceStamp.end(), 0);
+        std::fill(m_VertexStamp.begin(), m_VertexStamp.end(), 0);
+        m_Stamp = 1;
+    }
+}
+
+} // namespace alice2
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "Mesh.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace alice2 {
+
+enum class NormalWeighting {
+    Area,  // Face normals weighted by face area
+    Angle  // Weighted by the corner angle at the vertex (tessellation independent)
+};
+
+// Cached face and vertex normals for one Mesh, kept in sync incrementally.
+//
+// Update() reads the mesh edit log: faces around moved vertices are
+// recomputed, then the vertex normals of those faces' corners. Topology
+// changes, MarkAllDirty() or edits touching more than a quarter of the faces
+// fall back to a full parallel pass. Triangle meshes run the SIMD kernel;
+// other polygons use Newell's method.
+class MeshNormals {
+public:
+    explicit MeshNormals(NormalWeighting weighting = NormalWeighting::Area) : m_Weighting(weighting) {}
+
+    void SetWeighting(NormalWeighting weighting);
+    NormalWeighting GetWeighting() const { return m_Weighting; }
+
+    // Returns the number of faces recomputed (0 when already up to date)
+    size_t Update(const Mesh& mesh);
+    void Invalidate() { m_Mesh = nullptr; }
+
+    const std::vector<Vec3f>& GetFaceNormals() const { return m_FaceNormals; }
+    const std::vector<Vec3f>& GetVertexNormals() const { return m_VertexNormals; }
+    const std::vector<float>& GetFaceAreas() const { return m_FaceAreas; }
+
+private:
+    NormalWeighting m_Weighting;
+
+    const Mesh* m_Mesh = nullptr;
+    uint64_t m_TopologyVersion = 0;
+    uint64_t m_EditCursor = 0;
+    bool m_Triangles = false;
+
+    std::vector<Vec3f> m_FaceNormals;    // Unit length, zero for degenerate faces
+    std::vector<float> m_FaceAreas;
+    std::vector<float> m_CornerAngles;   // Per half-edge: angle at Source(h) in Face(h)
+    std::vector<Vec3f> m_VertexNormals;
+    std::vector<uint32_t> m_Corners;     // Triangle meshes: 3 vertices per face
+
+    // Incremental scratch, reused across updates
+    std::vector<uint32_t> m_EditedVertices;
+    std::vector<uint32_t> m_DirtyFaces;
+    std::vector<uint32_t> m_DirtyVertices;
+    std::vector<uint32_t> m_FaceStamp;
+    std::vector<uint32_t> m_VertexStamp;
+    uint32_t m_Stamp = 0;
+
+    void Rebuild(const Mesh& mesh);
+    void ComputeFaces(const Mesh& mesh, const uint32_t* faces, size_t count);
+    void ComputeVertices(const Mesh& mesh, const uint32_t* vertices, size_t count);
+    void NextStamp();
+};
+
+} // namespace alice2
@@ -0,0 +1,644 @@
+#include "MeshSimplify.h"
+#include "../utilities/Parallel.h"
+#include "../utilities/SpatialSort.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+namespace alice2 {
+
+namespace {
+
+constexpr size_t GrainSize = 4096;
+constexpr uint64_t NoCollapse = ~uint64_t(0);
+
+// Costs are non-negative floats, so their bit patterns order like the values.
+// Only the top bits (~12% buckets) are kept and a bijective hash of the edge
+// index breaks ties: near-equal costs then get random priorities, so local
+// minima are spread out instead of sweeping along the index order.
+inline uint64_t CollapseKey(float cost, uint32_t edge) {
+    uint32_t bits;
+    std::memcpy(&bits, &cost, sizeof(bits));
+    uint32_t priority = edge * 0x9e3779b1u;
+    priority ^= priority >> 16;
+    return (static_cast<uint64_t>(bits >> 20) << 32) | priority;
+}
+
+inline Vec3f TriangleNormal(const Vec3f& a, const Vec3f& b, const Vec3f& c) {
+    return (b - a).Cross(c - a);
+}
+
+// Removes entries for which keep(i) is false, preserving order
+template <typename Keep>
+size_t CompactTriangles(std::vector<uint32_t>& triangles, Keep&& keep) {
+    size_t count = triangles.size() / 3;
+    size_t chunkCount = parallel::ChunkCount(count, GrainSize);
+    if (chunkCount == 0) {
+        return 0;
+    }
+    size_t chunkSize = (count + chunkCount - 1) / chunkCount;
+
+    std::vector<size_t> offsets(chunkCount + 1, 0);
+    parallel::ForChunks(chunkCount, [&](size_t chunk) {
+        size_t end = std::min(count, (chunk + 1) * chunkSize);
+        size_t kept = 0;
+        for (size_t t = chunk * chunkSize; t < end; ++t) {
+            kept += keep(t) ? 1 : 0;
+        }
+        offsets[chunk + 1] = kept;
+    });
+    for (size_t c = 0; c < chunkCount; ++c) {
+        offsets[c + 1] += offsets[c];
+    }
+
+    std::vector<uint32_t> compacted(offsets[chunkCount] * 3);
+    parallel::ForChunks(chunkCount, [&](size_t chunk) {
+        size_t end = std::min(count, (chunk + 1) * chunkSize);
+        size_t out = offsets[chunk] * 3;
+        for (size_t t = chunk * chunkSize; t < end; ++t) {
+            if (keep(t)) {
+                compacted[out++] = triangles[t * 3];
+                compacted[out++] = triangles[t * 3 + 1];
+                compacted[out++] = triangles[t * 3 + 2];
+            }
+        }
+    });
+    triangles.swap(compacted);
+    return triangles.size() / 3;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Quadric
+// ---------------------------------------------------------------------------
+
+void MeshSimplifier::Quadric::AddPlane(double nx, double ny, double nz, double d, double weight) {
+    a2 += weight * nx * nx; ab += weight * nx * ny; ac += weight * nx * nz; ad += weight * nx * d;
+    b2 += weight * ny * ny; bc += weight * ny * nz; bd += weight * ny * d;
+    c2 += weight * nz * nz; cd += weight * nz * d;
+    d2 += weight * d * d;
+}
+
+MeshSimplifier::Quadric& MeshSimplifier::Quadric::operator+=(const Quadric& other) {
+    a2 += other.a2; ab += other.ab; ac += other.ac; ad += other.ad;
+    b2 += other.b2; bc += other.bc; bd += other.bd;
+    c2 += other.c2; cd += other.cd;
+    d2 += other.d2;
+    area += other.area;
+    return *this;
+}
+
+double MeshSimplifier::Quadric::Evaluate(double x, double y, double z) const {
+    return x * (a2 * x + ab * y + ac * z) + y * (ab * x + b2 * y + bc * z) + z * (ac * x + bc * y + c2 * z)
+        + 2.0 * (ad * x + bd * y + cd * z) + d2;
+}
+
+// ---------------------------------------------------------------------------
+// MeshSimplifier
+// ---------------------------------------------------------------------------
+
+bool MeshSimplifier::Load(const Mesh& mesh) {
+    std::vector<uint32_t> triangles;
+    triangles.reserve(mesh.GetFaceCount() * 3);
+    for (uint32_t face = 0; face < mesh.GetFaceCount(); ++face) {
+        uint32_t start = mesh.FaceHalfEdge(face);
+        uint32_t anchor = mesh.Source(start);
+        for (uint32_t h = mesh.Next(start); mesh.Target(h) != anchor; h = mesh.Next(h)) {
+            triangles.push_back(anchor);
+            triangles.push_back(mesh.Source(h));
+            triangles.push_back(mesh.Target(h));
+        }
+    }
+    return Load(mesh.GetPositions(), triangles);
+}
+
+bool MeshSimplifier::Load(const std::vector<Vec3f>& positions, const std::vector<uint32_t>& triangles) {
+    m_Positions.clear();
+    m_Triangles.clear();
+    m_Attributes.clear();
+    m_AttributeComponents = 0;
+    m_Quadrics.clear();
+    m_Error = 0.0f;
+
+    if (triangles.size() % 3 != 0) {
+        std::cerr << "MeshSimplifier: index count is not a multiple of 3" << std::endl;
+        return false;
+    }
+    for (uint32_t index : triangles) {
+        if (index >= positions.size()) {
+            std::cerr << "MeshSimplifier: vertex index " << index << " out of range" << std::endl;
+            return false;
+        }
+    }
+
+    m_Positions = positions;
+    m_Triangles = triangles;
+    CompactTriangles(m_Triangles, [&](size_t t) {
+        const uint32_t* tri = &m_Triangles[t * 3];
+        return tri[0] != tri[1] && tri[1] != tri[2] && tri[2] != tri[0];
+    });
+    return true;
+}
+
+bool MeshSimplifier::SetAttributes(const std::vector<float>& values, int components) {
+    if (components < 0 || values.size() != m_Positions.size() * static_cast<size_t>(components)) {
+        std::cerr << "MeshSimplifier: attribute array does not match the vertex count" << std::endl;
+        return false;
+    }
+    m_Attributes = values;
+    m_AttributeComponents = components;
+    return true;
+}
+
+void MeshSimplifier::InitializeQuadrics(const SimplifySettings& settings) {
+    m_Quadrics.assign(m_Positions.size(), Quadric());
+
+    // Area-weighted face planes, gathered per vertex over its star
+    parallel::For(m_Positions.size(), GrainSize, [&](size_t begin, size_t end) {
+        for (size_t v = begin; v < end; ++v) {
+            Quadric& q = m_Quadrics[v];
+            for (uint32_t i = m_StarOffsets[v]; i < m_StarOffsets[v + 1]; ++i) {
+                const uint32_t* tri = &m_Triangles[m_Stars[i] * 3];
+                const Vec3f& p0 = m_Positions[tri[0]];
+                Vec3f normal = TriangleNormal(p0, m_Positions[tri[1]], m_Positions[tri[2]]);
+                float length = normal.Length();
+                if (length <= 0.0f) {
+                    continue;
+                }
+                normal = normal / length;
+                double area = 0.5 * length;
+                q.AddPlane(normal.x, normal.y, normal.z, -normal.Dot(p0), area);
+                q.area += area;
+            }
+        }
+    });
+
+    // Open boundaries get planes through the edge, perpendicular to its face
+    if (settings.lockBoundary || settings.boundaryWeight <= 0.0f) {
+        return;
+    }
+    for (const Edge& edge : m_Edges) {
+        if (edge.faceCount != 1) {
+            continue;
+        }
+        uint32_t triangle = INVALID_INDEX;
+        for (uint32_t i = m_StarOffsets[edge.a]; i < m_StarOffsets[edge.a + 1] && triangle == INVALID_INDEX; ++i) {
+            const uint32_t* tri = &m_Triangles[m_Stars[i] * 3];
+            if (tri[0] == edge.b || tri[1] == edge.b || tri[2] == edge.b) {
+                triangle = m_Stars[i];
+            }
+        }
+        const uint32_t* tri = &m_Triangles[triangle * 3];
+        Vec3f faceNormal = TriangleNormal(m_Positions[tri[0]], m_Positions[tri[1]], m_Positions[tri[2]]);
+        Vec3f direction = m_Positions[edge.b] - m_Positions[edge.a];
+        Vec3f normal = direction.Cross(faceNormal).Normalize();
+        double weight = settings.boundaryWeight * direction.Dot(direction);
+        double d = -normal.Dot(m_Positions[edge.a]);
+        m_Quadrics[edge.a].AddPlane(normal.x, normal.y, normal.z, d, weight);
+        m_Quadrics[edge.b].AddPlane(normal.x, normal.y, normal.z, d, weight);
+    }
+}
+
+void MeshSimplifier::BuildConnectivity() {
+    size_t cornerCount = m_Triangles.size();
+    size_t vertexCount = m_Positions.size();
+
+    // Stars: corners sorted by vertex, offsets by binary search
+    std::vector<uint32_t> vertexKeys(m_Triangles);
+    std::vector<uint32_t> corners(cornerCount);
+    parallel::For(cornerCount, 1 << 16, [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; ++c) {
+            corners[c] = static_cast<uint32_t>(c / 3);
+        }
+    });
+    spatial::RadixSort(vertexKeys, corners);
+    m_Stars.swap(corners);
+    m_StarOffsets.resize(vertexCount + 1);
+    parallel::For(vertexCount + 1, GrainSize, [&](size_t begin, size_t end) {
+        for (size_t v = begin; v < end; ++v) {
+            m_StarOffsets[v] = static_cast<uint32_t>(
+                std::lower_bound(vertexKeys.begin(), vertexKeys.end(), static_cast<uint32_t>(v)) - vertexKeys.begin());
+        }
+    });
+
+    // Edges: corner c spans tri[c] -> tri[next(c)]; sort by (min, max) and merge runs
+    std::vector<uint64_t> edgeKeys(cornerCount);
+    std::vector<uint32_t> edgeCorners(cornerCount);
+    parallel::For(cornerCount, 1 << 16, [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; ++c) {
+            uint32_t from = m_Triangles[c];
+            uint32_t to = m_Triangles[c - c % 3 + (c % 3 + 1) % 3];
+            edgeKeys[c] = (static_cast<uint64_t>(std::min(from, to)) << 32) | std::max(from, to);
+            edgeCorners[c] = static_cast<uint32_t>(c);
+        }
+    });
+    spatial::RadixSort(edgeKeys, edgeCorners);
+
+    m_Edges.clear();
+    m_CornerEdges.resize(cornerCount);
+    m_Boundary.assign(vertexCount, 0);
+    for (size_t i = 0; i < cornerCount;) {
+        size_t run = i + 1;
+        while (run < cornerCount && edgeKeys[run] == edgeKeys[i]) {
+            ++run;
+        }
+        Edge edge;
+        edge.a = static_cast<uint32_t>(edgeKeys[i] >> 32);
+        edge.b = static_cast<uint32_t>(edgeKeys[i]);
+        edge.faceCount = static_cast<uint32_t>(run - i);
+        if (edge.faceCount != 2) {
+            m_Boundary[edge.a] = 1;
+            m_Boundary[edge.b] = 1;
+        }
+        uint32_t index = static_cast<uint32_t>(m_Edges.size());
+        for (size_t k = i; k < run; ++k) {
+            m_CornerEdges[edgeCorners[k]] = index;
+        }
+        m_Edges.push_back(edge);
+        i = run;
+    }
+}
+
+float MeshSimplifier::EvaluateEdge(uint32_t edgeIndex, const SimplifySettings& settings, Vec3f& position,
+                                   std::vector<uint32_t>& ringA, std::vector<uint32_t>& ringB) const {
+    constexpr float inf = std::numeric_limits<float>::infinity();
+    const Edge& edge = m_Edges[edgeIndex];
+    uint32_t a = edge.a, b = edge.b;
+
+    if (edge.faceCount > 2) {
+        return inf;
+    }
+    bool boundaryA = m_Boundary[a] != 0, boundaryB = m_Boundary[b] != 0;
+    if (settings.lockBoundary && (boundaryA || boundaryB)) {
+        return inf;
+    }
+    // Joining two boundary points across the interior pinches the surface
+    if (boundaryA && boundaryB && edge.faceCount != 1) {
+        return inf;
+    }
+
+    // Link condition: the endpoints share exactly the opposite vertices
+    auto gatherRing = [&](uint32_t v, std::vector<uint32_t>& ring) {
+        ring.clear();
+        for (uint32_t i = m_StarOffsets[v]; i < m_StarOffsets[v + 1]; ++i) {
+            const uint32_t* tri = &m_Triangles[m_Stars[i] * 3];
+            for (int k = 0; k < 3; ++k) {
+                if (tri[k] != v) {
+                    ring.push_back(tri[k]);
+                }
+            }
+        }
+        std::sort(ring.begin(), ring.end());
+        ring.erase(std::unique(ring.begin(), ring.end()), ring.end());
+    };
+    gatherRing(a, ringA);
+    gatherRing(b, ringB);
+    size_t shared = 0;
+    for (size_t i = 0, j = 0; i < ringA.size() && j < ringB.size();) {
+        if (ringA[i] < ringB[j]) {
+            ++i;
+        } else if (ringB[j] < ringA[i]) {
+            ++j;
+        } else {
+            ++shared;
+            ++i;
+            ++j;
+        }
+    }
+    if (shared != edge.faceCount) {
+        return inf;
+    }
+
+    // Optimal position minimises the summed quadric; fall back to the
+    // endpoints or midpoint when the system is singular or the optimum strays
+    Quadric q = m_Quadrics[a];
+    q += m_Quadrics[b];
+    const Vec3f& pa = m_Positions[a];
+    const Vec3f& pb = m_Positions[b];
+    Vec3f mid = (pa + pb) * 0.5f;
+
+    double c00 = q.b2 * q.c2 - q.bc * q.bc;
+    double c01 = q.ac * q.bc - q.ab * q.c2;
+    double c02 = q.ab * q.bc - q.ac * q.b2;
+    double det = q.a2 * c00 + q.ab * c01 + q.ac * c02;
+    double scale = std::max({q.a2, q.b2, q.c2});
+    double bestCost = std::numeric_limits<double>::infinity();
+    Vec3f best = mid;
+    if (scale > 0.0 && std::abs(det) > 1e-9 * scale * scale * scale) {
+        double c11 = q.a2 * q.c2 - q.ac * q.ac;
+        double c12 = q.ab * q.ac - q.a2 * q.bc;
+        double c22 = q.a2 * q.b2 - q.ab * q.ab;
+        double x = -(c00 * q.ad + c01 * q.bd + c02 * q.cd) / det;
+        double y = -(c01 * q.ad + c11 * q.bd + c12 * q.cd) / det;
+        double z = -(c02 * q.ad + c12 * q.bd + c22 * q.cd) / det;
+        Vec3f optimum(static_cast<float>(x), static_cast<float>(y), static_cast<float>(z));
+        if ((optimum - mid).Length() <= (pb - pa).Length()) {
+            best = optimum;
+            bestCost = q.Evaluate(x, y, z);
+        }
+    }
+    for (const Vec3f& candidate : {pa, pb, mid}) {
+        double cost = q.Evaluate(candidate.x, candidate.y, candidate.z);
+        if (cost < bestCost) {
+            bestCost = cost;
+            best = candidate;
+        }
+    }
+
+    // Reject collapses that fold or flatten a surviving triangle
+    for (uint32_t v : {a, b}) {
+        for (uint32_t i = m_StarOffsets[v]; i < m_StarOffsets[v + 1]; ++i) {
+            const uint32_t* tri = &m_Triangles[m_Stars[i] * 3];
+            if (tri[0] == a + b - v || tri[1] == a + b - v || tri[2] == a + b - v) {
+                continue; // Removed by the collapse
+            }
+            Vec3f p[3] = {m_Positions[tri[0]], m_Positions[tri[1]], m_Positions[tri[2]]};
+            Vec3f before = TriangleNormal(p[0], p[1], p[2]);
+            for (int k = 0; k < 3; ++k) {
+                if (tri[k] == v) {
+                    p[k] = best;
+                }
+            }
+            Vec3f after = TriangleNormal(p[0], p[1], p[2]);
+            if (after.Dot(before) <= 0.2f * after.Length() * before.Length()) {
+                return inf;
+            }
+        }
+    }
+
+    position = best;
+    double area = std::max(q.area, 1e-30);
+    return static_cast<float>(std::max(bestCost, 0.0) / area);
+}
+
+size_t MeshSimplifier::CollapsePass(const SimplifySettings& settings, size_t targetTriangles) {
+    size_t edgeCount = m_Edges.size();
+    size_t vertexCount = m_Positions.size();
+
+    // Costs and optimal positions. Edges away from the previous pass's
+    // collapses keep their cached values: their stars and quadrics are as
+    // they were. Edges are sorted by (a, b), so the cache is searchable.
+    std::vector<float> costs(edgeCount);
+    std::vector<Vec3f> targets(edgeCount);
+    bool cached = m_Dirty.size() == vertexCount;
+    parallel::For(edgeCount, 1024, [&](size_t begin, size_t end) {
+        std::vector<uint32_t> ringA, ringB;
+        for (size_t e = begin; e < end; ++e) {
+            const Edge& edge = m_Edges[e];
+            if (cached && !m_Dirty[edge.a] && !m_Dirty[edge.b]) {
+                uint64_t key = (static_cast<uint64_t>(edge.a) << 32) | edge.b;
+                auto it = std::lower_bound(m_CachedKeys.begin(), m_CachedKeys.end(), key);
+                if (it != m_CachedKeys.end() && *it == key) {
+                    size_t i = static_cast<size_t>(it - m_CachedKeys.begin());
+                    costs[e] = m_CachedCosts[i];
+                    targets[e] = m_CachedTargets[i];
+                    continue;
+                }
+            }
+            costs[e] = EvaluateEdge(static_cast<uint32_t>(e), settings, targets[e], ringA, ringB);
+        }
+    });
+
+    // Only the cheapest edges take part: a few times the collapses still
+    // needed, since the independent set keeps just a fraction of them
+    size_t needed = (GetTriangleCount() - targetTriangles + 1) / 2;
+    float maxCost = settings.maxError * settings.maxError;
+    std::vector<float> valid;
+    valid.reserve(edgeCount);
+    for (float cost : costs) {
+        if (cost <= maxCost) {
+            valid.push_back(cost);
+        }
+    }
+    if (valid.empty()) {
+        return 0;
+    }
+    size_t rank = std::min(needed * 4, valid.size()) - 1;
+    std::nth_element(valid.begin(), valid.begin() + static_cast<ptrdiff_t>(rank), valid.end());
+    float threshold = valid[rank];
+
+    // Selection rounds. Costs stay valid for edges whose endpoints lie outside
+    // every collapsed one-ring (their stars, quadrics and rings are untouched),
+    // so later rounds only exclude those dirty vertices.
+    std::vector<uint64_t> keys(edgeCount);
+    std::vector<uint64_t> vertexMin(vertexCount), ringMin(vertexCount);
+    std::vector<uint32_t> remap(vertexCount);
+    std::vector<uint8_t> dirty(vertexCount, 0);
+    std::vector<uint32_t> round(edgeCount, 0); // Round in which the edge collapsed, 0 = not
+    parallel::For(vertexCount, 1 << 16, [&](size_t begin, size_t end) {
+        for (size_t v = begin; v < end; ++v) {
+            remap[v] = static_cast<uint32_t>(v);
+        }
+    });
+
+    int components = m_AttributeComponents;
+    size_t collapseCount = 0;
+    float passCost = 0.0f;
+    for (uint32_t r = 1; collapseCount < needed; ++r) {
+        parallel::For(edgeCount, 1 << 16, [&](size_t begin, size_t end) {
+            for (size_t e = begin; e < end; ++e) {
+                const Edge& edge = m_Edges[e];
+                bool eligible = costs[e] <= threshold && !dirty[edge.a] && !dirty[edge.b];
+                keys[e] = eligible ? CollapseKey(costs[e], static_cast<uint32_t>(e)) : NoCollapse;
+            }
+        });
+
+        // Cheapest key touching each vertex, then the cheapest over its closed
+        // one-ring. An edge wins when it is that minimum at both endpoints,
+        // which keeps any triangle from seeing two winners.
+        parallel::For(vertexCount, GrainSize, [&](size_t begin, size_t end) {
+            for (size_t v = begin; v < end; ++v) {
+                uint64_t best = NoCollapse;
+                for (uint32_t i = m_StarOffsets[v]; i < m_StarOffsets[v + 1]; ++i) {
+                    uint32_t t = m_Stars[i];
+                    for (uint32_t k = 0; k < 3; ++k) {
+                        uint32_t from = m_Triangles[t * 3 + k], to = m_Triangles[t * 3 + (k + 1) % 3];
+                        if (from == v || to == v) {
+                            best = std::min(best, keys[m_CornerEdges[t * 3 + k]]);
+                        }
+                    }
+                }
+                vertexMin[v] = best;
+            }
+        });
+        parallel::For(vertexCount, GrainSize, [&](size_t begin, size_t end) {
+            for (size_t v = begin; v < end; ++v) {
+                uint64_t best = vertexMin[v];
+                for (uint32_t i = m_StarOffsets[v]; i < m_StarOffsets[v + 1]; ++i) {
+                    const uint32_t* tri = &m_Triangles[m_Stars[i] * 3];
+                    best = std::min({best, vertexMin[tri[0]], vertexMin[tri[1]], vertexMin[tri[2]]});
+                }
+                ringMin[v] = best;
+            }
+        });
+
+        // Apply the winners: b merges into a
+        parallel::For(edgeCount, GrainSize, [&](size_t begin, size_t end) {
+            for (size_t e = begin; e < end; ++e) {
+                uint64_t key = keys[e];
+                const Edge& edge = m_Edges[e];
+                if (key == NoCollapse || ringMin[edge.a] != key || ringMin[edge.b] != key) {
+                    continue;
+                }
+                const Vec3f& pa = m_Positions[edge.a];
+                Vec3f direction = m_Positions[edge.b] - pa;
+                float lengthSquared = direction.Dot(direction);
+                float t = lengthSquared > 0.0f ? (targets[e] - pa).Dot(direction) / lengthSquared : 0.5f;
+                t = std::clamp(t, 0.0f, 1.0f);
+                for (int k = 0; k < components; ++k) {
+                    float& va = m_Attributes[edge.a * components + k];
+                    va += (m_Attributes[edge.b * components + k] - va) * t;
+                }
+                m_Positions[edge.a] = targets[e];
+                m_Quadrics[edge.a] += m_Quadrics[edge.b];
+                remap[edge.b] = edge.a;
+                round[e] = r;
+            }
+        });
+
+        // Winners dirty their endpoints' one-rings for the following rounds
+        size_t roundCount = 0;
+        for (size_t e = 0; e < edgeCount; ++e) {
+            if (round[e] != r) {
+                continue;
+            }
+            ++roundCount;
+            passCost = std::max(passCost, costs[e]);
+            for (uint32_t v : {m_Edges[e].a, m_Edges[e].b}) {
+                for (uint32_t i = m_StarOffsets[v]; i < m_StarOffsets[v + 1]; ++i) {
+                    const uint32_t* tri = &m_Triangles[m_Stars[i] * 3];
+                    dirty[tri[0]] = dirty[tri[1]] = dirty[tri[2]] = 1;
+                }
+            }
+        }
+        collapseCount += roundCount;
+        // Late rounds find few winners; a fresh pass is cheaper by then
+        if (roundCount * 10 <= collapseCount) {
+            break;
+        }
+    }
+    if (collapseCount == 0) {
+        return 0;
+    }
+    m_Error = std::max(m_Error, std::sqrt(passCost));
+
+    m_CachedKeys.resize(edgeCount);
+    parallel::For(edgeCount, 1 << 16, [&](size_t begin, size_t end) {
+        for (size_t e = begin; e < end; ++e) {
+            m_CachedKeys[e] = (static_cast<uint64_t>(m_Edges[e].a) << 32) | m_Edges[e].b;
+        }
+    });
+    m_CachedCosts.swap(costs);
+    m_CachedTargets.swap(targets);
+    m_Dirty.swap(dirty);
+
+    parallel::For(m_Triangles.size(), 1 << 16, [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; ++c) {
+            m_Triangles[c] = remap[m_Triangles[c]];
+        }
+    });
+    CompactTriangles(m_Triangles, [&](size_t t) {
+        const uint32_t* tri = &m_Triangles[t * 3];
+        return tri[0] != tri[1] && tri[1] != tri[2] && tri[2] != tri[0];
+    });
+    return collapseCount;
+}
+
+size_t MeshSimplifier::Simplify(const SimplifySettings& settings) {
+    m_Dirty.clear(); // Cached costs depend on the settings
+
+    // The last few passes would each remove a handful of triangles, so the
+    // target is met to within 2%
+    size_t stopAt = settings.targetTriangles + settings.targetTriangles / 50;
+    while (GetTriangleCount() > stopAt) {
+        BuildConnectivity();
+        if (m_Quadrics.empty()) {
+            InitializeQuadrics(settings);
+        }
+        if (CollapsePass(settings, settings.targetTriangles) == 0) {
+            break;
+        }
+    }
+    return GetTriangleCount();
+}
+
+void MeshSimplifier::GetLod(MeshLod& lod) const {
+    size_t vertexCount = m_Positions.size();
+    std::vector<uint32_t> newIndex(vertexCount, INVALID_INDEX);
+    for (uint32_t v : m_Triangles) {
+        newIndex[v] = 0;
+    }
+    uint32_t used = 0;
+    for (size_t v = 0; v < vertexCount; ++v) {
+        if (newIndex[v] != INVALID_INDEX) {
+            newIndex[v] = used++;
+        }
+    }
+
+    size_t components = static_cast<size_t>(m_AttributeComponents);
+    lod.positions.resize(used);
+    lod.attributes.resize(used * components);
+    parallel::For(vertexCount, GrainSize, [&](size_t begin, size_t end) {
+        for (size_t v = begin; v < end; ++v) {
+            uint32_t target = newIndex[v];
+            if (target == INVALID_INDEX) {
+                continue;
+            }
+            lod.positions[target] = m_Positions[v];
+            std::copy_n(m_Attributes.begin() + static_cast<ptrdiff_t>(v * components), components,
+                        lod.attributes.begin() + static_cast<ptrdiff_t>(target * components));
+        }
+    });
+
+    lod.triangles.resize(m_Triangles.size());
+    parallel::For(m_Triangles.size(), 1 << 16, [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; ++c) {
+            lod.triangles[c] = newIndex[m_Triangles[c]];
+        }
+    });
+
+    // Unique edges from the sorted (min, max) corner pairs
+    std::vector<uint64_t> keys(lod.triangles.size());
+    std::vector<uint32_t> unused(lod.triangles.size(), 0);
+    parallel::For(keys.size(), 1 << 16, [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; ++c) {
+            uint32_t from = lod.triangles[c];
+            uint32_t to = lod.triangles[c - c % 3 + (c % 3 + 1) % 3];
+            keys[c] = (static_cast<uint64_t>(std::min(from, to)) << 32) | std::max(from, to);
+        }
+    });
+    spatial::RadixSort(keys, unused);
+    lod.edges.clear();
+    for (size_t i = 0; i < keys.size(); ++i) {
+        if (i == 0 || keys[i] != keys[i - 1]) {
+            lod.edges.push_back(static_cast<uint32_t>(keys[i] >> 32));
+            lod.edges.push_back(static_cast<uint32_t>(keys[i]));
+        }
+    }
+    lod.error = m_Error;
+}
+
+void MeshSimplifier::BuildLodChain(std::vector<MeshLod>& lods, float ratio, size_t minTriangles,
+                                   const SimplifySettings& settings) {
+    ratio = std::clamp(ratio, 0.05f, 0.95f);
+    while (GetTriangleCount() > minTriangles) {
+        size_t before = GetTriangleCount();
+        SimplifySettings level = settings;
+        level.targetTriangles = std::max(minTriangles, static_cast<size_t>(before * ratio));
+        size_t after = Simplify(level);
+        if (after == before) {
+            break;
+        }
+        lods.emplace_back();
+        GetLod(lods.back());
+        // Stopped short by the error bound or running out of legal collapses
+        if (after > level.targetTriangles + level.targetTriangles / 50) {
+            break;
+        }
+    }
+}
+
+} // namespace alice2
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "Mesh.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace alice2 {
+
+struct SimplifySettings {
+    size_t targetTriangles = 0;                                // Stop within 2% of this count
+    float maxError = std::numeric_limits<float>::infinity();  // Stop before exceeding this (world units)
+    bool lockBoundary = false;                                 // Keep boundary vertices in place
+    float boundaryWeight = 10.0f;                              // Penalty planes along open boundaries
+};
+
+// One level of detail as a compact indexed triangle list
+struct MeshLod {
+    std::vector<Vec3f> positions;
+    std::vector<uint32_t> triangles;
+    std::vector<uint32_t> edges;      // Unique vertex pairs for wireframe display
+    std::vector<float> attributes;    // Per-vertex attributes, GetAttributeComponents() floats each
+    float error = 0.0f;               // Largest quadric distance to the source surface
+};
+
+// Quadric error metric (Garland-Heckbert) edge-collapse simplifier.
+//
+// Collapses run in parallel passes over an independent set: every edge
+// gets a cost and optimal position from the summed endpoint quadrics, and
+// an edge collapses only when it is the cheapest within the one-rings of
+// both endpoints. No triangle then touches two collapsing edges, so the
+// whole set is applied at once. Each pass only considers the cheapest
+// edges needed to reach the target, keeping the result close to the
+// greedy order. Collapses that flip a triangle or break the link condition
+// are rejected, so manifold input stays manifold.
+//
+// Per-vertex attributes (colours, UVs, ...) follow the collapse, blended by
+// where the new vertex projects onto the collapsed edge.
+class MeshSimplifier {
+public:
+    MeshSimplifier() = default;
+
+    // Polygon faces are fan-triangulated
+    bool Load(const Mesh& mesh);
+    bool Load(const std::vector<Vec3f>& positions, const std::vector<uint32_t>& triangles);
+    // values holds components floats per vertex; call after Load
+    bool SetAttributes(const std::vector<float>& values, int components);
+
+    // Collapses until a setting stops it; returns the remaining triangle count
+    size_t Simplify(const SimplifySettings& settings);
+
+    size_t GetTriangleCount() const { return m_Triangles.size() / 3; }
+    int GetAttributeComponents() const { return m_AttributeComponents; }
+    float GetError() const { return m_Error; }
+
+    // Compacted copy of the current state (unreferenced vertices dropped)
+    void GetLod(MeshLod& lod) const;
+
+    // Appends successively coarser levels, each keeping ratio of the previous
+    // triangle count, until minTriangles or simplification stalls. The
+    // simplifier's current state is not included.
+    void BuildLodChain(std::vector<MeshLod>& lods, float ratio = 0.5f, size_t minTriangles = 1024,
+                       const SimplifySettings& settings = SimplifySettings());
+
+private:
+    struct Quadric {
+        double a2 = 0, ab = 0, ac = 0, ad = 0, b2 = 0, bc = 0, bd = 0, c2 = 0, cd = 0, d2 = 0;
+        double area = 0; // Face area accumulated; turns the sum into a mean squared distance
+
+        void AddPlane(double nx, double ny, double nz, double d, double weight);
+        Quadric& operator+=(const Quadric& other);
+        double Evaluate(double x, double y, double z) const;
+    };
+
+    struct Edge {
+        uint32_t a, b;      // a < b
+        uint32_t faceCount; // 1 on boundary, 2 inside, more when non-manifold
+    };
+
+    std::vector<Vec3f> m_Positions;
+    std::vector<uint32_t> m_Triangles;
+    std::vector<float> m_Attributes;
+    int m_AttributeComponents = 0;
+    std::vector<Quadric> m_Quadrics;
+    float m_Error = 0.0f;
+
+    // Per-pass connectivity
+    std::vector<Edge> m_Edges;
+    std::vector<uint32_t> m_CornerEdges;  // Edge of corner c -> c + 1 in its triangle
+    std::vector<uint32_t> m_StarOffsets;  // Triangles around each vertex (CSR)
+    std::vector<uint32_t> m_Stars;
+    std::vector<uint8_t> m_Boundary;      // Vertex on a boundary or non-manifold edge
+
+    // Previous pass's edge costs by (a, b) key, valid away from dirty vertices
+    std::vector<uint64_t> m_CachedKeys;
+    std::vector<float> m_CachedCosts;
+    std::vector<Vec3f> m_CachedTargets;
+    std::vector<uint8_t> m_Dirty;
+
+    void InitializeQuadrics(const SimplifySettings& settings);
+    void BuildConnectivity();
+    // Cost as squared distance; infinity when the collapse is not allowed
+    float EvaluateEdge(uint32_t edge, const SimplifySettings& settings, Vec3f& position,
+                       std::vector<uint32_t>& scratchA, std::vector<uint32_t>& scratchB) const;
+    size_t CollapsePass(const SimplifySettings& settings, size_t targetTriangles);
+};
+
+} // namespace alice2
@@ -0,0 +1,321 @@
+#include "MeshSmoothing.h"
+#include "../utilities/Parallel.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace alice2 {
+
+namespace {
+
+constexpr size_t GrainSize = 4096;
+
+inline float Coordinate(const Vec3f& p, size_t c) { return c == 0 ? p.x : (c == 1 ? p.y : p.z); }
+
+// L scaled by timeStep plus the mass on the diagonal, in the pattern of L
+void AssembleSystem(const sparse::CsrMatrix& stiffness, const std::vector<double>& mass,
+                    const std::vector<uint32_t>& diagonal, double timeStep, sparse::CsrMatrix& system) {
+    const std::vector<double>& source = stiffness.GetValues();
+    std::vector<double>& values = system.GetValues();
+    parallel::For(values.size(), GrainSize, [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; ++k) {
+            values[k] = timeStep * source[k];
+        }
+    });
+    for (size_t v = 0; v < mass.size(); ++v) {
+        values[diagonal[v]] += mass[v];
+    }
+}
+
+// Solves one system per coordinate, the three concurrently; rhs(c, b)
+// fills the right-hand side for coordinate c
+template <typename Rhs>
+void SolveCoordinates(const sparse::CholeskySolver& solver, size_t size, std::vector<double> (&x)[3], Rhs&& rhs) {
+    parallel::ForChunks(3, [&](size_t c) {
+        std::vector<double> b(size);
+        rhs(c, b);
+        solver.Solve(b, x[c]);
+    });
+}
+
+} // namespace
+
+MeshSmoother::MeshSmoother(LaplacianWeighting weighting) : m_Laplacian(weighting) {}
+
+void MeshSmoother::SetWeighting(LaplacianWeighting weighting) {
+    if (weighting != m_Laplacian.GetWeighting()) {
+        m_Laplacian.SetWeighting(weighting);
+        Reset();
+    }
+}
+
+void MeshSmoother::Reset() {
+    m_Implicit.valid = false;
+    m_Implicit.mesh = nullptr;
+    m_Flow.analyzed = false;
+    m_Flow.mesh = nullptr;
+    m_Fair.valid = false;
+    m_Fair.mesh = nullptr;
+}
+
+bool MeshSmoother::SmoothExplicit(Mesh& mesh, float lambda, int iterations, bool fixBoundary) {
+    std::vector<Vec3f> next(mesh.GetVertexCount());
+    for (int iteration = 0; iteration < iterations; ++iteration) {
+        if (!m_Laplacian.Update(mesh)) {
+            return false;
+        }
+        const sparse::CsrMatrix& laplacian = m_Laplacian.GetMatrix();
+        const std::vector<uint32_t>& offsets = laplacian.GetRowOffsets();
+        const std::vector<uint32_t>& columns = laplacian.GetColumnIndices();
+        const std::vector<double>& values = laplacian.GetValues();
+        const std::vector<uint32_t>& diagonal = m_Laplacian.GetDiagonalPositions();
+        const std::vector<Vec3f>& positions = mesh.GetPositions();
+
+        parallel::For(positions.size(), GrainSize, [&](size_t begin, size_t end) {
+            for (size_t v = begin; v < end; ++v) {
+                double d = values[diagonal[v]];
+                // Obtuse fans can leave no positive weight; such vertices wait
+                if (d <= 0.0 || (fixBoundary && mesh.IsBoundaryVertex(static_cast<uint32_t>(v)))) {
+                    next[v] = positions[v];
+                    continue;
+                }
+                double x = 0.0, y = 0.0, z = 0.0;
+                for (uint32_t k = offsets[v]; k < offsets[v + 1]; ++k) {
+                    const Vec3f& p = positions[columns[k]];
+                    x += values[k] * p.x;
+                    y += values[k] * p.y;
+                    z += values[k] * p.z;
+                }
+                double scale = lambda / d;
+                next[v] = positions[v] - Vec3f(float(x * scale), float(y * scale), float(z * scale));
+            }
+        });
+        mesh.GetPositions().swap(next);
+        mesh.MarkAllDirty();
+    }
+    return true;
+}
+
+bool MeshSmoother::SmoothImplicit(Mesh& mesh, float timeStep, int iterations) {
+    ImplicitCache& cache = m_Implicit;
+    if (!cache.valid || cache.mesh != &mesh || cache.topologyVersion != mesh.GetTopologyVersion()
+        || cache.timeStep != timeStep) {
+        cache.valid = false;
+        if (!m_Laplacian.Update(mesh)) {
+            return false;
+        }
+        sparse::CsrMatrix system = m_Laplacian.GetMatrix();
+        AssembleSystem(m_Laplacian.GetMatrix(), m_Laplacian.GetMass(), m_Laplacian.GetDiagonalPositions(), timeStep,
+                       system);
+        if (!cache.solver.Compute(system)) {
+            return false;
+        }
+        cache.mass = m_Laplacian.GetMass();
+        cache.mesh = &mesh;
+        cache.topologyVersion = mesh.GetTopologyVersion();
+        cache.timeStep = timeStep;
+        cache.valid = true;
+    }
+
+    size_t n = mesh.GetVertexCount();
+    std::vector<double> x[3];
+    for (int iteration = 0; iteration < iterations; ++iteration) {
+        std::vector<Vec3f>& positions = mesh.GetPositions();
+        SolveCoordinates(cache.solver, n, x, [&](size_t c, std::vector<double>& b) {
+            for (size_t v = 0; v < n; ++v) {
+                b[v] = cache.mass[v] * Coordinate(positions[v], c);
+            }
+        });
+        for (size_t v = 0; v < n; ++v) {
+            positions[v] = Vec3f(float(x[0][v]), float(x[1][v]), float(x[2][v]));
+        }
+    }
+    mesh.MarkAllDirty();
+    return true;
+}
+
+bool MeshSmoother::MeanCurvatureFlow(Mesh& mesh, float timeStep, int iterations, bool conformalized) {
+    FlowCache& cache = m_Flow;
+    if (cache.mesh != &mesh || cache.topologyVersion != mesh.GetTopologyVersion()
+        || cache.conformalized != conformalized) {
+        cache.analyzed = false;
+    }
+
+    size_t n = mesh.GetVertexCount();
+    std::vector<double> x[3];
+    for (int iteration = 0; iteration < iterations; ++iteration) {
+        if (!m_Laplacian.Update(mesh)) {
+            return false;
+        }
+        if (!cache.analyzed) {
+            cache.stiffness = m_Laplacian.GetMatrix();
+            cache.system = m_Laplacian.GetMatrix();
+            if (!cache.solver.Analyze(cache.system)) {
+                return false;
+            }
+            cache.mesh = &mesh;
+            cache.topologyVersion = mesh.GetTopologyVersion();
+            cache.conformalized = conformalized;
+            cache.analyzed = true;
+        }
+
+        const std::vector<double>& mass = m_Laplacian.GetMass();
+        AssembleSystem(conformalized ? cache.stiffness : m_Laplacian.GetMatrix(), mass,
+                       m_Laplacian.GetDiagonalPositions(), timeStep, cache.system);
+        if (!cache.solver.Factorize(cache.system)) {
+            return false;
+        }
+
+        std::vector<Vec3f>& positions = mesh.GetPositions();
+        SolveCoordinates(cache.solver, n, x, [&](size_t c, std::vector<double>& b) {
+            for (size_t v = 0; v < n; ++v) {
+                b[v] = mass[v] * Coordinate(positions[v], c);
+            }
+        });
+        for (size_t v = 0; v < n; ++v) {
+            positions[v] = Vec3f(float(x[0][v]), float(x[1][v]), float(x[2][v]));
+        }
+        mesh.MarkAllDirty();
+    }
+    return true;
+}
+
+bool MeshSmoother::Fair(Mesh& mesh, int order, const std::vector<uint8_t>& fixedVertices) {
+    uint32_t n = static_cast<uint32_t>(mesh.GetVertexCount());
+    if (order < 1 || order > 2) {
+        std::cerr << "MeshSmoother: fairing order must be 1 or 2" << std::endl;
+        return false;
+    }
+    if (!fixedVertices.empty() && fixedVertices.size() != n) {
+        std::cerr << "MeshSmoother: fixed vertex flags do not match the vertex count" << std::endl;
+        return false;
+    }
+    std::vector<uint8_t> fixed(n);
+    for (uint32_t v = 0; v < n; ++v) {
+        bool pinned = fixedVertices.empty() ? mesh.IsBoundaryVertex(v) : fixedVertices[v] != 0;
+        fixed[v] = pinned || mesh.IsIsolatedVertex(v);
+    }
+
+    FairCache& cache = m_Fair;
+    if (!cache.valid || cache.mesh != &mesh || cache.topologyVersion != mesh.GetTopologyVersion()
+        || cache.order != order || cache.fixed != fixed) {
+        cache.valid = false;
+        if (!m_Laplacian.Update(mesh)) {
+            return false;
+        }
+
+        // Local numbering of the free and fixed sets
+        std::vector<uint32_t> local(n);
+        cache.freeVertices.clear();
+        cache.fixedVertices.clear();
+        for (uint32_t v = 0; v < n; ++v) {
+            std::vector<uint32_t>& set = fixed[v] ? cache.fixedVertices : cache.freeVertices;
+            local[v] = static_cast<uint32_t>(set.size());
+            set.push_back(v);
+        }
+        if (cache.freeVertices.empty()) {
+            return true;
+        }
+        if (cache.fixedVertices.empty()) {
+            std::cerr << "MeshSmoother: fairing needs at least one fixed vertex" << std::endl;
+            return false;
+        }
+
+        // Rows of L (order 1) or L M^-1 L (order 2) for the free vertices,
+        // split into the free block and the coupling to fixed vertices
+        const sparse::CsrMatrix& laplacian = m_Laplacian.GetMatrix();
+        const std::vector<uint32_t>& offsets = laplacian.GetRowOffsets();
+        const std::vector<uint32_t>& columns = laplacian.GetColumnIndices();
+        const std::vector<double>& values = laplacian.GetValues();
+        const std::vector<double>& mass = m_Laplacian.GetMass();
+
+        size_t freeCount = cache.freeVertices.size();
+        size_t chunkCount = parallel::ChunkCount(freeCount, 256);
+        size_t chunkSize = (freeCount + chunkCount - 1) / chunkCount;
+        std::vector<std::vector<sparse::Triplet>> freeTriplets(chunkCount), fixedTriplets(chunkCount);
+        parallel::ForChunks(chunkCount, [&](size_t chunk) {
+            std::vector<double> accumulator(order == 2 ? n : 0, 0.0);
+            std::vector<uint32_t> marks(order == 2 ? n : 0, ~0u);
+            std::vector<uint32_t> touched;
+            auto emit = [&](uint32_t row, uint32_t v, double value) {
+                if (fixed[v]) {
+                    fixedTriplets[chunk].push_back({row, local[v], value});
+                } else {
+                    freeTriplets[chunk].push_back({row, local[v], value});
+                }
+            };
+
+            size_t end = std::min(freeCount, (chunk + 1) * chunkSize);
+            for (size_t i = chunk * chunkSize; i < end; ++i) {
+                uint32_t row = static_cast<uint32_t>(i);
+                uint32_t v = cache.freeVertices[i];
+                if (order == 1) {
+                    for (uint32_t k = offsets[v]; k < offsets[v + 1]; ++k) {
+                        emit(row, columns[k], values[k]);
+                    }
+                    continue;
+                }
+                touched.clear();
+                for (uint32_t k = offsets[v]; k < offsets[v + 1]; ++k) {
+                    uint32_t middle = columns[k];
+                    double weight = values[k] / std::max(mass[middle], 1e-12);
+                    for (uint32_t j = offsets[middle]; j < offsets[middle + 1]; ++j) {
+                        uint32_t u = columns[j];
+                        if (marks[u] != row) {
+                            marks[u] = row;
+                            accumulator[u] = 0.0;
+                            touched.push_back(u);
+                        }
+                        accumulator[u] += weight * values[j];
+                    }
+                }
+                for (uint32_t u : touched) {
+                    emit(row, u, accumulator[u]);
+                }
+            }
+        });
+
+        std::vector<sparse::Triplet> freeBlock, coupling;
+        for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+            freeBlock.insert(freeBlock.end(), freeTriplets[chunk].begin(), freeTriplets[chunk].end());
+            coupling.insert(coupling.end(), fixedTriplets[chunk].begin(), fixedTriplets[chunk].end());
+        }
+        sparse::CsrMatrix system;
+        system.SetFromTriplets(freeCount, freeCount, freeBlock);
+        cache.coupling.SetFromTriplets(freeCount, cache.fixedVertices.size(), coupling);
+        if (!cache.solver.Compute(system)) {
+            return false;
+        }
+
+        cache.fixed.swap(fixed);
+        cache.mesh = &mesh;
+        cache.topologyVersion = mesh.GetTopologyVersion();
+        cache.order = order;
+        cache.valid = true;
+    }
+    if (cache.freeVertices.empty()) {
+        return true;
+    }
+
+    // A_ff p_f = -A_fc p_c
+    std::vector<Vec3f>& positions = mesh.GetPositions();
+    size_t freeCount = cache.freeVertices.size();
+    std::vector<double> x[3];
+    SolveCoordinates(cache.solver, freeCount, x, [&](size_t c, std::vector<double>& b) {
+        std::vector<double> held(cache.fixedVertices.size());
+        for (size_t i = 0; i < held.size(); ++i) {
+            held[i] = Coordinate(positions[cache.fixedVertices[i]], c);
+        }
+        cache.coupling.Multiply(held, b);
+        for (double& value : b) {
+            value = -value;
+        }
+    });
+    for (size_t i = 0; i < freeCount; ++i) {
+        positions[cache.freeVertices[i]] = Vec3f(float(x[0][i]), float(x[1][i]), float(x[2][i]));
+    }
+    mesh.MarkAllDirty();
+    return true;
+}
+
+} // namespace alice2
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "Mesh.h"
+#include "MeshLaplacian.h"
+#include "../utilities/Sparse.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace alice2 {
+
+// Laplacian smoothing, fairing and curvature flow on a Mesh. Implicit
+// operators keep their Cholesky factorisation (or at least its symbolic
+// analysis) between calls on the same mesh and topology, so repeated steps
+// cost a back-substitution or a numeric refactorisation.
+class MeshSmoother {
+public:
+    explicit MeshSmoother(LaplacianWeighting weighting = LaplacianWeighting::Cotangent);
+
+    void SetWeighting(LaplacianWeighting weighting);
+    LaplacianWeighting GetWeighting() const { return m_Laplacian.GetWeighting(); }
+
+    // Explicit steps p -= lambda D^-1 L p (the normalised umbrella operator);
+    // stable for lambda <= 1. Weights follow the surface every step.
+    bool SmoothExplicit(Mesh& mesh, float lambda = 0.5f, int iterations = 1, bool fixBoundary = true);
+
+    // Backward Euler steps (M + t L) p' = M p. L and M come from the mesh on
+    // the first call and are kept while mesh, topology and timeStep stay the
+    // same, so further calls are back-substitutions only.
+    bool SmoothImplicit(Mesh& mesh, float timeStep, int iterations = 1);
+
+    // Mean-curvature flow. The mass matrix follows the surface each step; the
+    // conformalized flow (Kazhdan et al. 2012) keeps L from the first step,
+    // the classic flow rebuilds it. Steps refactorise numerically only.
+    bool MeanCurvatureFlow(Mesh& mesh, float timeStep, int iterations = 1, bool conformalized = true);
+
+    // Solves L^order p = 0 for the free vertices with the fixed ones held:
+    // order 1 is a membrane (harmonic), 2 the thin-plate (biharmonic) fair
+    // surface. fixedVertices holds one flag per vertex; empty fixes the
+    // boundary. The factorisation is kept per mesh, topology, order and
+    // fixed set, so moving fixed vertices and re-fairing is a solve.
+    bool Fair(Mesh& mesh, int order = 2, const std::vector<uint8_t>& fixedVertices = {});
+
+    // Drops cached operators and factorisations
+    void Reset();
+
+private:
+    MeshLaplacian m_Laplacian;
+
+    struct ImplicitCache {
+        const Mesh* mesh = nullptr;
+        uint64_t topologyVersion = 0;
+        float timeStep = 0.0f;
+        bool valid = false;
+        std::vector<double> mass;
+        sparse::CholeskySolver solver;
+    } m_Implicit;
+
+    struct FlowCache {
+        const Mesh* mesh = nullptr;
+        uint64_t topologyVersion = 0;
+        bool conformalized = false;
+        bool analyzed = false;
+        sparse::CsrMatrix stiffness; // L of the first step (conformalized flow)
+        sparse::CsrMatrix system;
+        sparse::CholeskySolver solver;
+    } m_Flow;
+
+    struct FairCache {
+        const Mesh* mesh = nullptr;
+        uint64_t topologyVersion = 0;
+        int order = 0;
+        bool valid = false;
+        std::vector<uint8_t> fixed;
+        std::vector<uint32_t> freeVertices;
+        std::vector<uint32_t> fixedVertices;
+        sparse::CsrMatrix coupling; // Free rows x fixed columns of L^order
+        sparse::CholeskySolver solver;
+    } m_Fair;
+};
+
+} // namespace alice2
@@ -0,0 +1,397 @@
+#include "PointCloudFile.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace alice2 {
+
+namespace {
+
+constexpr size_t TextBufferSize = 1 << 20;
+constexpr size_t PlyBatchSize = 1 << 14;
+
+uint32_t PackBytes(uint32_t r, uint32_t g, uint32_t b, uint32_t a) {
+    return r | g << 8 | b << 16 | a << 24;
+}
+
+uint32_t ClampByte(double value) {
+    return value <= 0.0 ? 0u : (value >= 255.0 ? 255u : uint32_t(value + 0.5));
+}
+
+bool IsSeparator(char c) {
+    return c == ' ' || c == '\t' || c == ',' || c == ';' || c == '\r';
+}
+
+// Up to maxCount numbers from the start of [line, end); stops at the first
+// token that is not a number
+int ParseNumbers(const char* line, const char* end, double* numbers, int maxCount) {
+    int count = 0;
+    const char* cursor = line;
+    while (count < maxCount) {
+        while (cursor < end && IsSeparator(*cursor)) {
+            ++cursor;
+        }
+        if (cursor >= end) {
+            break;
+        }
+        char* next = nullptr;
+        double value = std::strtod(cursor, &next);
+        if (next == cursor || next > end) {
+            break;
+        }
+        numbers[count++] = value;
+        cursor = next;
+    }
+    return count;
+}
+
+std::string Extension(const std::string& path) {
+    size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos || path.find_first_of("/\\", dot) != std::string::npos) {
+        return std::string();
+    }
+    std::string extension = path.substr(dot + 1);
+    for (char& c : extension) {
+        c = char(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return extension;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// TextPointSource
+// ---------------------------------------------------------------------------
+
+TextPointSource::~TextPointSource() {
+    if (m_File) {
+        std::fclose(m_File);
+    }
+}
+
+bool TextPointSource::Open(const std::string& path) {
+    if (m_File) {
+        std::fclose(m_File);
+    }
+    m_File = std::fopen(path.c_str(), "rb");
+    if (!m_File) {
+        std::cerr << "Cannot open point file " << path << std::endl;
+        return false;
+    }
+    // One spare byte keeps the buffered text terminated for strtod
+    m_Buffer.assign(TextBufferSize + 1, '\0');
+    return Rewind();
+}
+
+bool TextPointSource::Rewind() {
+    if (!m_File) {
+        return false;
+    }
+    std::rewind(m_File);
+    m_Begin = m_End = 0;
+    m_Eof = false;
+    m_Valid = true;
+    return true;
+}
+
+bool TextPointSource::NextLine(const char*& line, const char*& end) {
+    for (;;) {
+        const char* begin = m_Buffer.data() + m_Begin;
+        const char* newline = static_cast<const char*>(std::memchr(begin, '\n', m_End - m_Begin));
+        if (newline || (m_Eof && m_Begin < m_End)) {
+            line = begin;
+            end = newline ? newline : m_Buffer.data() + m_End;
+            m_Begin = newline ? size_t(newline - m_Buffer.data()) + 1 : m_End;
+            return true;
+        }
+        if (m_Eof) {
+            return false;
+        }
+        // Move the partial line to the front and refill, growing the buffer
+        // for a line longer than all of it
+        size_t remaining = m_End - m_Begin;
+        std::memmove(m_Buffer.data(), m_Buffer.data() + m_Begin, remaining);
+        m_Begin = 0;
+        m_End = remaining;
+        if (m_End + 1 >= m_Buffer.size()) {
+            m_Buffer.resize(m_Buffer.size() * 2);
+        }
+        size_t read = std::fread(m_Buffer.data() + m_End, 1, m_Buffer.size() - 1 - m_End, m_File);
+        m_End += read;
+        m_Buffer[m_End] = '\0';
+        if (read == 0) {
+            m_Eof = true;
+            if (std::ferror(m_File)) {
+                m_Valid = false;
+                return false;
+            }
+        }
+    }
+}
+
+size_t TextPointSource::Read(OctreePoint* points, size_t maxCount) {
+    size_t count = 0;
+    const char* line = nullptr;
+    const char* end = nullptr;
+    while (count < maxCount && NextLine(line, end)) {
+        double values[7];
+        int found = ParseNumbers(line, end, values, 7);
+        if (found < 3) {
+            continue;
+        }
+        OctreePoint& point = points[count++];
+        point.position = Localize(values[0], values[1], values[2]);
+        if (found >= 7) {
+            point.color = PackBytes(ClampByte(values[4]), ClampByte(values[5]), ClampByte(values[6]), 255);
+        } else if (found == 6) {
+            point.color = PackBytes(ClampByte(values[3]), ClampByte(values[4]), ClampByte(values[5]), 255);
+        } else {
+            point.color = 0xffffffffu;
+        }
+    }
+    return count;
+}
+
+// ---------------------------------------------------------------------------
+// PlyPointSource
+// ---------------------------------------------------------------------------
+
+PlyPointSource::~PlyPointSource() {
+    if (m_File) {
+        std::fclose(m_File);
+    }
+}
+
+bool PlyPointSource::Open(const std::string& path) {
+    if (m_File) {
+        std::fclose(m_File);
+    }
+    m_File = std::fopen(path.c_str(), "rb");
+    if (!m_File) {
+        std::cerr << "Cannot open point file " << path << std::endl;
+        return false;
+    }
+    if (!ParseHeader()) {
+        std::cerr << "Unsupported PLY header in " << path << std::endl;
+        std::fclose(m_File);
+        m_File = nullptr;
+        return false;
+    }
+    return Rewind();
+}
+
+bool PlyPointSource::ParseHeader() {
+    static const struct {
+        const char* name;
+        Type type;
+        size_t size;
+    } types[] = {
+        {"char", Type::Int8, 1},     {"int8", Type::Int8, 1},       {"uchar", Type::Uint8, 1},
+        {"uint8", Type::Uint8, 1},   {"short", Type::Int16, 2},     {"int16", Type::Int16, 2},
+        {"ushort", Type::Uint16, 2}, {"uint16", Type::Uint16, 2},   {"int", Type::Int32, 4},
+        {"int32", Type::Int32, 4},   {"uint", Type::Uint32, 4},     {"uint32", Type::Uint32, 4},
+        {"float", Type::Float32, 4}, {"float32", Type::Float32, 4}, {"double", Type::Float64, 8},
+        {"float64", Type::Float64, 8},
+    };
+    static const char* roles[] = {"x", "y", "z", "red", "green", "blue", "alpha"};
+
+    char buffer[512];
+    if (!std::fgets(buffer, sizeof(buffer), m_File) || std::strncmp(buffer, "ply", 3) != 0) {
+        return false;
+    }
+    m_Properties.clear();
+    m_Stride = 0;
+    m_VertexCount = 0;
+    bool inVertex = false, sawVertex = false, hasFormat = false;
+    while (std::fgets(buffer, sizeof(buffer), m_File)) {
+        char word[64] = {}, second[64] = {}, third[64] = {};
+        int words = std::sscanf(buffer, "%63s %63s %63s", word, second, third);
+        if (words <= 0 || std::strcmp(word, "comment") == 0 || std::strcmp(word, "obj_info") == 0) {
+            continue;
+        }
+        if (std::strcmp(word, "end_header") == 0) {
+            m_DataStart = std::ftell(m_File);
+            int position = 0;
+            for (const Property& property : m_Properties) {
+                position |= property.role >= 0 && property.role < 3 ? 1 << property.role : 0;
+            }
+            return hasFormat && sawVertex && position == 7;
+        }
+        if (std::strcmp(word, "format") == 0) {
+            if (std::strcmp(second, "ascii") == 0) {
+                m_Binary = false;
+            } else if (std::strcmp(second, "binary_little_endian") == 0) {
+                m_Binary = true;
+            } else {
+                return false;
+            }
+            hasFormat = true;
+        } else if (std::strcmp(word, "element") == 0) {
+            inVertex = std::strcmp(second, "vertex") == 0;
+            if (inVertex) {
+                if (sawVertex) {
+                    return false;
+                }
+                m_VertexCount = std::strtoull(third, nullptr, 10);
+                sawVertex = true;
+            } else if (!sawVertex) {
+                // Data of an earlier element would have to be skipped
+                return false;
+            }
+        } else if (std::strcmp(word, "property") == 0 && inVertex) {
+            if (std::strcmp(second, "list") == 0) {
+                return false;
+            }
+            const auto* type = std::find_if(std::begin(types), std::end(types),
+                                            [&](const auto& t) { return std::strcmp(t.name, second) == 0; });
+            if (type == std::end(types)) {
+                return false;
+            }
+            const char* name = std::strncmp(third, "diffuse_", 8) == 0 ? third + 8 : third;
+            int role = -1;
+            for (int r = 0; r < 7; ++r) {
+                if (std::strcmp(name, roles[r]) == 0) {
+                    role = r;
+                }
+            }
+            m_Properties.push_back({type->type, m_Stride, role});
+            m_Stride += type->size;
+        }
+    }
+    return false;
+}
+
+bool PlyPointSource::Rewind() {
+    if (!m_File || std::fseek(m_File, m_DataStart, SEEK_SET) != 0) {
+        return false;
+    }
+    m_Read = 0;
+    m_Valid = true;
+    return true;
+}
+
+size_t PlyPointSource::Read(OctreePoint* points, size_t maxCount) {
+    if (!m_File || !m_Valid) {
+        return 0;
+    }
+    size_t count = size_t(std::min<uint64_t>(maxCount, m_VertexCount - m_Read));
+    double values[7];
+    auto emit = [&](OctreePoint& point, bool hasColor[4]) {
+        point.position = Localize(values[0], values[1], values[2]);
+        point.color = PackBytes(hasColor[0] ? ClampByte(values[3]) : 255u, hasColor[1] ? ClampByte(values[4]) : 255u,
+                                hasColor[2] ? ClampByte(values[5]) : 255u, hasColor[3] ? ClampByte(values[6]) : 255u);
+    };
+    // Colour channels to 0-255: floats are 0-1 and ushorts 0-65535
+    auto colorByte = [](Type type, double value) {
+        return type == Type::Float32 || type == Type::Float64 ? value * 255.0
+               : type == Type::Uint16                         ? value / 257.0
+                                                              : value;
+    };
+
+    if (!m_Binary) {
+        size_t done = 0;
+        while (done < count) {
+            if (m_Line.empty()) {
+                m_Line.resize(4096);
+            }
+            // Lines are short, but read them whole whatever their length
+            size_t length = 0;
+            for (;;) {
+                if (!std::fgets(m_Line.data() + length, int(m_Line.size() - length), m_File)) {
+                    break;
+                }
+                length += std::strlen(m_Line.data() + length);
+                if (length > 0 && m_Line[length - 1] == '\n') {
+                    break;
+                }
+                m_Line.resize(m_Line.size() * 2);
+            }
+            if (length == 0) {
+                m_Valid = false;
+                break;
+            }
+            double fields[64];
+            int found = ParseNumbers(m_Line.data(), m_Line.data() + length, fields,
+                                     int(std::min<size_t>(m_Properties.size(), 64)));
+            if (size_t(found) < std::min<size_t>(m_Properties.size(), 64)) {
+                m_Valid = false;
+                break;
+            }
+            bool hasColor[4] = {false, false, false, false};
+            for (size_t p = 0; p < size_t(found); ++p) {
+                const Property& property = m_Properties[p];
+                if (property.role >= 0) {
+                    double value = fields[p];
+                    if (property.role >= 3) {
+                        value = colorByte(property.type, value);
+                        hasColor[property.role - 3] = true;
+                    }
+                    values[property.role] = value;
+                }
+            }
+            emit(points[done++], hasColor);
+        }
+        m_Read += done;
+        return done;
+    }
+
+    size_t done = 0;
+    while (done < count) {
+        size_t batch = std::min(count - done, PlyBatchSize);
+        m_Buffer.resize(batch * m_Stride);
+        size_t read = std::fread(m_Buffer.data(), m_Stride, batch, m_File);
+        for (size_t i = 0; i < read; ++i) {
+            const unsigned char* record = m_Buffer.data() + i * m_Stride;
+            bool hasColor[4] = {false, false, false, false};
+            for (const Property& property : m_Properties) {
+                if (property.role < 0) {
+                    continue;
+                }
+                const unsigned char* field = record + property.offset;
+                double value = 0.0;
+                switch (property.type) {
+                case Type::Int8: { int8_t v; std::memcpy(&v, field, 1); value = v; break; }
+                case Type::Uint8: value = *field; break;
+                case Type::Int16: { int16_t v; std::memcpy(&v, field, 2); value = v; break; }
+                case Type::Uint16: { uint16_t v; std::memcpy(&v, field, 2); value = v; break; }
+                case Type::Int32: { int32_t v; std::memcpy(&v, field, 4); value = v; break; }
+                case Type::Uint32: { uint32_t v; std::memcpy(&v, field, 4); value = v; break; }
+                case Type::Float32: { float v; std::memcpy(&v, field, 4); value = v; break; }
+                case Type::Float64: std::memcpy(&value, field, 8); break;
+                }
+                if (property.role >= 3) {
+                    value = colorByte(property.type, value);
+                    hasColor[property.role - 3] = true;
+                }
+                values[property.role] = value;
+            }
+            emit(points[done + i], hasColor);
+        }
+        done += read;
+        if (read < batch) {
+            m_Valid = false;
+            break;
+        }
+    }
+    m_Read += done;
+    return done;
+}
+
+std::unique_ptr<PointSource> OpenPointSource(const std::string& path) {
+    std::string extension = Extension(path);
+    if (extension == "ply") {
+        auto source = std::make_unique<PlyPointSource>();
+        return source->Open(path) ? std::move(source) : nullptr;
+    }
+    if (extension == "xyz" || extension == "pts" || extension == "txt" || extension == "csv") {
+        auto source = std::make_unique<TextPointSource>();
+        return source->Open(path) ? std::move(source) : nullptr;
+    }
+    std::cerr << "Unknown point cloud format: " << path << std::endl;
+    return nullptr;
+}
+
+} // namespace alice2
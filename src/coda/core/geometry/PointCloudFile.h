@@ -0,0 +1,96 @@
+#pragma once
+
+#include "PointOctree.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace alice2 {
+
+// Sequential reader of a point cloud for passes over inputs that do not fit
+// in memory. Coordinates are parsed in double precision and have the offset
+// subtracted before they are narrowed to the OctreePoint floats; points
+// without colour are white.
+class PointSource {
+public:
+    virtual ~PointSource() = default;
+
+    // Starts again from the first point
+    virtual bool Rewind() = 0;
+    // Reads up to maxCount points; 0 at the end of the input or on error
+    virtual size_t Read(OctreePoint* points, size_t maxCount) = 0;
+    // False after a read error (a malformed or truncated file)
+    bool IsValid() const { return m_Valid; }
+
+    void SetOffset(double x, double y, double z) { m_Offset[0] = x; m_Offset[1] = y; m_Offset[2] = z; }
+    const double* GetOffset() const { return m_Offset; }
+
+protected:
+    double m_Offset[3] = {0.0, 0.0, 0.0};
+    bool m_Valid = true;
+
+    Vec3f Localize(double x, double y, double z) const {
+        return Vec3f(float(x - m_Offset[0]), float(y - m_Offset[1]), float(z - m_Offset[2]));
+    }
+};
+
+// Text points, one per line, separated by spaces, tabs or commas: x y z,
+// x y z r g b, x y z intensity, or x y z intensity r g b (Leica PTS),
+// with colours in 0-255. Lines that do not start with three numbers, such
+// as headers and PTS point counts, are skipped.
+class TextPointSource : public PointSource {
+public:
+    ~TextPointSource() override;
+    bool Open(const std::string& path);
+    bool Rewind() override;
+    size_t Read(OctreePoint* points, size_t maxCount) override;
+
+private:
+    std::FILE* m_File = nullptr;
+    std::vector<char> m_Buffer;
+    size_t m_Begin = 0, m_End = 0;
+    bool m_Eof = false;
+
+    bool NextLine(const char*& line, const char*& end);
+};
+
+// Vertices of a PLY file, ASCII or binary little-endian: x, y, z as float
+// or double and optional red, green, blue (and alpha) as uchar, ushort or
+// float. The vertex element must come first.
+class PlyPointSource : public PointSource {
+public:
+    ~PlyPointSource() override;
+    bool Open(const std::string& path);
+    bool Rewind() override;
+    size_t Read(OctreePoint* points, size_t maxCount) override;
+
+    uint64_t GetVertexCount() const { return m_VertexCount; }
+
+private:
+    enum class Type : uint8_t { Int8, Uint8, Int16, Uint16, Int32, Uint32, Float32, Float64 };
+    struct Property {
+        Type type;
+        size_t offset;
+        int role; // 0-2 position, 3-6 colour, -1 ignored
+    };
+
+    std::FILE* m_File = nullptr;
+    bool m_Binary = false;
+    uint64_t m_VertexCount = 0;
+    uint64_t m_Read = 0;
+    long m_DataStart = 0;
+    size_t m_Stride = 0;
+    std::vector<Property> m_Properties;
+    std::vector<unsigned char> m_Buffer;
+    std::vector<char> m_Line;
+
+    bool ParseHeader();
+};
+
+// Opens a .ply, .xyz, .pts, .txt or .csv file by extension; null on failure
+std::unique_ptr<PointSource> OpenPointSource(const std::string& path);
+
+} // namespace alice2
@@ -0,0 +1,695 @@
+#include "PointOctree.h"
+#include "PointCloudFile.h"
+#include "../utilities/Parallel.h"
+#include "../utilities/Quantize.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <unordered_map>
+
+namespace alice2 {
+
+namespace {
+
+const char Magic[8] = {'A', '2', 'P', 'O', 'C', 'T', '\0', '\0'};
+
+constexpr size_t ReadBatch = 1 << 16;
+// Counting grid of 128^3 cells for clouds larger than one chunk
+constexpr uint32_t CountLevel = 7;
+// Chunk files are appended through buffers sharing this budget
+constexpr size_t AppendBudget = size_t(64) << 20;
+constexpr size_t MinAppendPoints = 4096;
+
+bool Seek(std::FILE* file, uint64_t offset) {
+#if defined(_WIN32)
+    return _fseeki64(file, static_cast<long long>(offset), SEEK_SET) == 0;
+#else
+    return fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+}
+
+uint64_t FileSize(std::FILE* file) {
+#if defined(_WIN32)
+    return _fseeki64(file, 0, SEEK_END) == 0 ? uint64_t(_ftelli64(file)) : 0;
+#else
+    return fseeko(file, 0, SEEK_END) == 0 ? uint64_t(ftello(file)) : 0;
+#endif
+}
+
+uint64_t NodeKey(uint32_t level, uint32_t x, uint32_t y, uint32_t z) {
+    return uint64_t(level) << 57 | uint64_t(x) << 38 | uint64_t(y) << 19 | uint64_t(z);
+}
+
+// Integer cell of a point at the finest level the builder addresses. Node
+// cubes, sampling cells and octants are all bit ranges of it, so a point
+// lands in the same cube however it is classified.
+struct FineGrid {
+    double min[3];
+    double scale;
+    uint32_t bits;
+
+    void Cell(const Vec3f& p, uint32_t cell[3]) const {
+        const double limit = double((1u << bits) - 1);
+        const float coordinates[3] = {p.x, p.y, p.z};
+        for (int axis = 0; axis < 3; ++axis) {
+            double v = (double(coordinates[axis]) - min[axis]) * scale;
+            cell[axis] = v >= limit ? uint32_t(limit) : (v > 0.0 ? uint32_t(v) : 0u);
+        }
+    }
+};
+
+// One bit per sampling cell of a node; a node keeps the first point of
+// every cell and clears the bits through the points it kept
+class CellSampler {
+public:
+    CellSampler(const FineGrid& grid, uint32_t gridBits)
+        : m_Grid(grid), m_GridBits(gridBits), m_Bits(std::max<size_t>(size_t(1) << (3 * gridBits), 64) / 64) {}
+
+    bool Take(const Vec3f& p, uint32_t level) {
+        size_t index = Index(p, level);
+        uint64_t bit = uint64_t(1) << (index & 63);
+        if (m_Bits[index >> 6] & bit) {
+            return false;
+        }
+        m_Bits[index >> 6] |= bit;
+        return true;
+    }
+    void Release(const Vec3f& p, uint32_t level) {
+        size_t index = Index(p, level);
+        m_Bits[index >> 6] &= ~(uint64_t(1) << (index & 63));
+    }
+
+private:
+    const FineGrid& m_Grid;
+    uint32_t m_GridBits;
+    std::vector<uint64_t> m_Bits;
+
+    size_t Index(const Vec3f& p, uint32_t level) const {
+        uint32_t cell[3];
+        m_Grid.Cell(p, cell);
+        const uint32_t shift = m_Grid.bits - level - m_GridBits;
+        const uint32_t mask = (1u << m_GridBits) - 1;
+        return size_t(cell[0] >> shift & mask) | size_t(cell[1] >> shift & mask) << m_GridBits |
+               size_t(cell[2] >> shift & mask) << (2 * m_GridBits);
+    }
+};
+
+struct NodeRecord {
+    uint64_t key;
+    uint64_t offset;
+    uint32_t count;
+};
+
+// The output file while nodes are appended from several threads; the node
+// table is assembled from the records at the end
+struct OutputFile {
+    std::FILE* file = nullptr;
+    uint64_t end = sizeof(PointOctree::Header);
+    std::vector<NodeRecord> records;
+    std::mutex mutex;
+    bool ok = true;
+
+    void Append(uint64_t key, const std::vector<OctreePoint>& points) {
+        std::lock_guard<std::mutex> lock(mutex);
+        records.push_back({key, end, uint32_t(points.size())});
+        if (!points.empty() && std::fwrite(points.data(), sizeof(OctreePoint), points.size(), file) != points.size()) {
+            ok = false;
+        }
+        end += points.size() * sizeof(OctreePoint);
+    }
+};
+
+// Cells of the counting grid merged into one in-memory unit of work
+struct Chunk {
+    uint32_t level, x, y, z;
+    uint64_t count = 0;
+    std::string path;
+    std::vector<OctreePoint> buffer; // Pending appends
+    bool split = false;              // Whether the chunk root got children
+    bool ok = true;
+
+    bool Flush() {
+        if (buffer.empty()) {
+            return ok;
+        }
+        std::FILE* file = std::fopen(path.c_str(), "ab");
+        ok = ok && file && std::fwrite(buffer.data(), sizeof(OctreePoint), buffer.size(), file) == buffer.size();
+        if (file) {
+            ok = std::fclose(file) == 0 && ok;
+        }
+        buffer.clear();
+        return ok;
+    }
+};
+
+bool ReadFile(const std::string& path, std::vector<OctreePoint>& points, size_t count) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        return count == 0;
+    }
+    points.resize(count);
+    bool ok = std::fread(points.data(), sizeof(OctreePoint), count, file) == count;
+    std::fclose(file);
+    return ok;
+}
+
+bool WriteFile(const std::string& path, const std::vector<OctreePoint>& points) {
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    bool ok = std::fwrite(points.data(), sizeof(OctreePoint), points.size(), file) == points.size();
+    return std::fclose(file) == 0 && ok;
+}
+
+// Next batch of finite points; 0 at the end of the input
+size_t ReadFinite(PointSource& source, OctreePoint* points, size_t maxCount) {
+    for (;;) {
+        size_t read = source.Read(points, maxCount);
+        if (read == 0) {
+            return 0;
+        }
+        size_t kept = 0;
+        for (size_t i = 0; i < read; ++i) {
+            const Vec3f& p = points[i].position;
+            if (std::isfinite(p.x) && std::isfinite(p.y) && std::isfinite(p.z)) {
+                points[kept++] = points[i];
+            }
+        }
+        if (kept > 0) {
+            return kept;
+        }
+    }
+}
+
+// Splits the points of a subtree root top-down: every node keeps one point
+// per sampling cell and passes the rest to its octants until a node holds
+// at most maxNodePoints. Descendants are appended to the output; the root
+// keeps its sample in points.
+class SubtreeBuilder {
+public:
+    SubtreeBuilder(const FineGrid& grid, uint32_t gridBits, uint32_t maxNodePoints, OutputFile& output)
+        : m_Grid(grid), m_Sampler(grid, gridBits), m_MaxNodePoints(maxNodePoints), m_Output(output) {}
+
+    bool Subdivide(uint32_t level, uint32_t x, uint32_t y, uint32_t z, std::vector<OctreePoint>& points) {
+        if (points.size() <= m_MaxNodePoints || level >= PointOctreeBuilder::MaxLevel) {
+            return false;
+        }
+        std::vector<OctreePoint> children[8];
+        const uint32_t shift = m_Grid.bits - level - 1;
+        size_t kept = 0;
+        for (const OctreePoint& point : points) {
+            if (m_Sampler.Take(point.position, level)) {
+                points[kept++] = point;
+                continue;
+            }
+            uint32_t cell[3];
+            m_Grid.Cell(point.position, cell);
+            children[(cell[0] >> shift & 1) | (cell[1] >> shift & 1) << 1 | (cell[2] >> shift & 1) << 2].push_back(point);
+        }
+        // One cell taken means the points may all coincide; a leaf holds
+        // them then, instead of a chain of one-point nodes down to MaxLevel
+        if (kept == 1 && Coincide(points[0], children)) {
+            m_Sampler.Release(points[0].position, level);
+            points.resize(1);
+            for (const std::vector<OctreePoint>& child : children) {
+                points.insert(points.end(), child.begin(), child.end());
+            }
+            return false;
+        }
+        points.resize(kept);
+        points.shrink_to_fit();
+        for (const OctreePoint& point : points) {
+            m_Sampler.Release(point.position, level);
+        }
+        for (uint32_t octant = 0; octant < 8; ++octant) {
+            std::vector<OctreePoint>& child = children[octant];
+            if (child.empty()) {
+                continue;
+            }
+            uint32_t cx = 2 * x + (octant & 1), cy = 2 * y + (octant >> 1 & 1), cz = 2 * z + (octant >> 2);
+            Subdivide(level + 1, cx, cy, cz, child);
+            m_Output.Append(NodeKey(level + 1, cx, cy, cz), child);
+            child = std::vector<OctreePoint>();
+        }
+        return true;
+    }
+
+private:
+    const FineGrid& m_Grid;
+    CellSampler m_Sampler;
+    uint32_t m_MaxNodePoints;
+    OutputFile& m_Output;
+
+    bool Coincide(const OctreePoint& point, const std::vector<OctreePoint> (&children)[8]) const {
+        uint32_t first[3], cell[3];
+        m_Grid.Cell(point.position, first);
+        for (const std::vector<OctreePoint>& child : children) {
+            for (const OctreePoint& other : child) {
+                m_Grid.Cell(other.position, cell);
+                if (cell[0] != first[0] || cell[1] != first[1] || cell[2] != first[2]) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+};
+
+} // namespace
+
+uint32_t PackPointColor(const Color& color) {
+    return uint32_t(quantize::FloatToUnorm8(color.r)) | uint32_t(quantize::FloatToUnorm8(color.g)) << 8 |
+           uint32_t(quantize::FloatToUnorm8(color.b)) << 16 | uint32_t(quantize::FloatToUnorm8(color.a)) << 24;
+}
+
+Color UnpackPointColor(uint32_t color) {
+    return Color(quantize::Unorm8ToFloat(uint8_t(color)), quantize::Unorm8ToFloat(uint8_t(color >> 8)),
+                 quantize::Unorm8ToFloat(uint8_t(color >> 16)), quantize::Unorm8ToFloat(uint8_t(color >> 24)));
+}
+
+uint32_t PointOctreeNode::GetChildCount() const {
+    return uint32_t(std::popcount(childMask));
+}
+
+// ---------------------------------------------------------------------------
+// PointOctree
+// ---------------------------------------------------------------------------
+
+PointOctree::~PointOctree() {
+    Close();
+}
+
+bool PointOctree::Open(const std::string& path) {
+    Close();
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        std::cerr << "Cannot open point octree " << path << std::endl;
+        return false;
+    }
+    Header header = {};
+    if (std::fread(&header, sizeof(header), 1, file) != 1 || std::memcmp(header.magic, Magic, sizeof(Magic)) != 0 ||
+        header.version != Version) {
+        std::cerr << "Not a point octree file (version " << Version << "): " << path << std::endl;
+        std::fclose(file);
+        return false;
+    }
+    const uint64_t fileSize = FileSize(file);
+    std::vector<PointOctreeNode> nodes(header.nodeCount);
+    bool ok = header.nodeCount > 0 && header.nodeTableOffset + uint64_t(header.nodeCount) * sizeof(PointOctreeNode) <= fileSize &&
+              Seek(file, header.nodeTableOffset) &&
+              std::fread(nodes.data(), sizeof(PointOctreeNode), nodes.size(), file) == nodes.size();
+    uint32_t maxNodePoints = 0;
+    for (size_t i = 0; ok && i < nodes.size(); ++i) {
+        const PointOctreeNode& node = nodes[i];
+        ok = node.offset + uint64_t(node.count) * sizeof(OctreePoint) <= header.nodeTableOffset &&
+             (node.childMask == 0 || (node.firstChild > i && uint64_t(node.firstChild) + node.GetChildCount() <= nodes.size()));
+        maxNodePoints = std::max(maxNodePoints, node.count);
+    }
+    if (!ok) {
+        std::cerr << "Corrupt or truncated point octree: " << path << std::endl;
+        std::fclose(file);
+        return false;
+    }
+    m_File = file;
+    m_Header = header;
+    m_Nodes = std::move(nodes);
+    m_MaxNodePoints = maxNodePoints;
+    return true;
+}
+
+void PointOctree::Close() {
+    std::lock_guard<std::mutex> lock(m_FileMutex);
+    if (m_File) {
+        std::fclose(m_File);
+        m_File = nullptr;
+    }
+    m_Header = Header();
+    m_Nodes.clear();
+    m_MaxNodePoints = 0;
+}
+
+float PointOctree::GetNodeSize(uint32_t node) const {
+    return std::ldexp(m_Header.size, -int(m_Nodes[node].level));
+}
+
+float PointOctree::GetNodeSpacing(uint32_t node) const {
+    return std::ldexp(m_Header.spacing, -int(m_Nodes[node].level));
+}
+
+void PointOctree::GetNodeBounds(uint32_t node, Vec3f& min, Vec3f& max) const {
+    const PointOctreeNode& n = m_Nodes[node];
+    const double size = std::ldexp(double(m_Header.size), -int(n.level));
+    min = Vec3f(float(m_Header.min[0] + n.x * size), float(m_Header.min[1] + n.y * size),
+                float(m_Header.min[2] + n.z * size));
+    max = Vec3f(float(m_Header.min[0] + (n.x + 1) * size), float(m_Header.min[1] + (n.y + 1) * size),
+                float(m_Header.min[2] + (n.z + 1) * size));
+}
+
+bool PointOctree::ReadNode(uint32_t node, std::vector<OctreePoint>& points) const {
+    std::lock_guard<std::mutex> lock(m_FileMutex);
+    if (!m_File || node >= m_Nodes.size()) {
+        return false;
+    }
+    const PointOctreeNode& n = m_Nodes[node];
+    points.resize(n.count);
+    if (n.count == 0) {
+        return true;
+    }
+    if (!Seek(m_File, n.offset) || std::fread(points.data(), sizeof(OctreePoint), n.count, m_File) != n.count) {
+        std::cerr << "Failed to read point octree node " << node << std::endl;
+        points.clear();
+        return false;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// PointOctreeBuilder
+// ---------------------------------------------------------------------------
+
+PointOctreeBuilder::PointOctreeBuilder(const PointOctreeSettings& settings) : m_Settings(settings) {}
+
+bool PointOctreeBuilder::Build(PointSource& source, const std::string& outputPath) {
+    m_PointCount = 0;
+    m_NodeCount = 0;
+    m_ChunkCount = 0;
+    m_Depth = 0;
+
+    const uint32_t resolution = std::bit_ceil(std::clamp<uint32_t>(m_Settings.gridResolution, 2, 256));
+    const uint32_t gridBits = uint32_t(std::countr_zero(resolution));
+    const uint32_t maxNodePoints = std::max<uint32_t>(m_Settings.maxNodePoints, 1);
+    const size_t chunkPoints = std::max<size_t>(m_Settings.chunkPoints, maxNodePoints);
+    std::vector<OctreePoint> batch(ReadBatch);
+
+    // Pass one: bounds and count, in input coordinates
+    source.SetOffset(0.0, 0.0, 0.0);
+    if (!source.Rewind()) {
+        std::cerr << "Cannot read the point cloud" << std::endl;
+        return false;
+    }
+    float low[3] = {std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+                    std::numeric_limits<float>::max()};
+    float high[3] = {-low[0], -low[1], -low[2]};
+    uint64_t total = 0;
+    while (size_t read = ReadFinite(source, batch.data(), batch.size())) {
+        for (size_t i = 0; i < read; ++i) {
+            const Vec3f& p = batch[i].position;
+            low[0] = std::min(low[0], p.x), high[0] = std::max(high[0], p.x);
+            low[1] = std::min(low[1], p.y), high[1] = std::max(high[1], p.y);
+            low[2] = std::min(low[2], p.z), high[2] = std::max(high[2], p.z);
+        }
+        total += read;
+    }
+    if (!source.IsValid() || total == 0) {
+        std::cerr << (total == 0 ? "The point cloud is empty" : "Failed to read the point cloud") << std::endl;
+        return false;
+    }
+
+    // Positions are stored relative to the rounded centre. Bounds read as
+    // floats may be off by their rounding, which the padding covers; points
+    // outside the cube would still be clamped into its border cells.
+    PointOctree::Header header = {};
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = PointOctree::Version;
+    header.gridResolution = resolution;
+    double extent = 0.0;
+    for (int axis = 0; axis < 3; ++axis) {
+        header.offset[axis] = m_Settings.recenter ? std::round(0.5 * (double(low[axis]) + double(high[axis]))) : 0.0;
+        extent = std::max(extent, double(high[axis]) - double(low[axis]));
+    }
+    double padding = 0.0;
+    for (int axis = 0; axis < 3; ++axis) {
+        padding = std::max({padding, std::abs(double(low[axis])), std::abs(double(high[axis]))});
+    }
+    padding = padding * 1e-6 + extent * 1e-6 + 1e-6;
+    header.size = float(extent + 2.0 * padding);
+    for (int axis = 0; axis < 3; ++axis) {
+        header.min[axis] = float(double(low[axis]) - header.offset[axis] - padding);
+    }
+    header.spacing = header.size / float(resolution);
+
+    FineGrid grid;
+    grid.bits = MaxLevel + gridBits;
+    grid.scale = std::ldexp(1.0, int(grid.bits)) / double(header.size);
+    for (int axis = 0; axis < 3; ++axis) {
+        grid.min[axis] = header.min[axis];
+    }
+    source.SetOffset(header.offset[0], header.offset[1], header.offset[2]);
+
+    // Pass two: counts on the counting grid, summed up a pyramid of levels
+    const uint32_t countLevel = total <= chunkPoints ? 0 : CountLevel;
+    const uint32_t countShift = grid.bits - countLevel;
+    auto cellIndex = [](uint32_t level, uint32_t x, uint32_t y, uint32_t z) {
+        return size_t(x) | size_t(y) << level | size_t(z) << (2 * level);
+    };
+    std::vector<std::vector<uint64_t>> counts(countLevel + 1);
+    counts[countLevel].assign(size_t(1) << (3 * countLevel), 0);
+    uint64_t recount = 0;
+    if (!source.Rewind()) {
+        std::cerr << "Cannot rewind the point cloud" << std::endl;
+        return false;
+    }
+    while (size_t read = ReadFinite(source, batch.data(), batch.size())) {
+        for (size_t i = 0; i < read; ++i) {
+            uint32_t cell[3];
+            grid.Cell(batch[i].position, cell);
+            ++counts[countLevel][cellIndex(countLevel, cell[0] >> countShift, cell[1] >> countShift, cell[2] >> countShift)];
+        }
+        recount += read;
+    }
+    if (!source.IsValid() || recount != total) {
+        std::cerr << "The point cloud changed between passes" << std::endl;
+        return false;
+    }
+    for (uint32_t level = countLevel; level > 0; --level) {
+        const uint32_t side = 1u << (level - 1);
+        counts[level - 1].assign(size_t(1) << (3 * (level - 1)), 0);
+        for (uint32_t z = 0; z < 2 * side; ++z) {
+            for (uint32_t y = 0; y < 2 * side; ++y) {
+                for (uint32_t x = 0; x < 2 * side; ++x) {
+                    counts[level - 1][cellIndex(level - 1, x >> 1, y >> 1, z >> 1)] += counts[level][cellIndex(level, x, y, z)];
+                }
+            }
+        }
+    }
+    auto countOf = [&](uint32_t level, uint32_t x, uint32_t y, uint32_t z) {
+        return counts[level][cellIndex(level, x, y, z)];
+    };
+    // A cube small enough, or a cell of the counting grid, is one chunk.
+    // Dense counting cells can exceed chunkPoints and are processed whole.
+    auto isChunk = [&](uint32_t level, uint32_t x, uint32_t y, uint32_t z) {
+        return level == countLevel || countOf(level, x, y, z) <= chunkPoints;
+    };
+
+    std::string base = outputPath;
+    if (!m_Settings.temporaryDirectory.empty()) {
+        size_t slash = outputPath.find_last_of("/\\");
+        base = m_Settings.temporaryDirectory + "/" + (slash == std::string::npos ? outputPath : outputPath.substr(slash + 1));
+    }
+    std::vector<Chunk> chunks;
+    std::vector<uint32_t> cellChunk(counts[countLevel].size(), 0);
+    auto partition = [&](auto&& self, uint32_t level, uint32_t x, uint32_t y, uint32_t z) -> void {
+        if (countOf(level, x, y, z) == 0) {
+            return;
+        }
+        if (isChunk(level, x, y, z)) {
+            const uint32_t span = 1u << (countLevel - level);
+            for (uint32_t cz = z * span; cz < (z + 1) * span; ++cz) {
+                for (uint32_t cy = y * span; cy < (y + 1) * span; ++cy) {
+                    for (uint32_t cx = x * span; cx < (x + 1) * span; ++cx) {
+                        cellChunk[cellIndex(countLevel, cx, cy, cz)] = uint32_t(chunks.size());
+                    }
+                }
+            }
+            Chunk chunk;
+            chunk.level = level, chunk.x = x, chunk.y = y, chunk.z = z;
+            chunk.count = countOf(level, x, y, z);
+            chunk.path = base + ".chunk" + std::to_string(chunks.size()) + ".tmp";
+            chunks.push_back(std::move(chunk));
+            return;
+        }
+        for (uint32_t octant = 0; octant < 8; ++octant) {
+            self(self, level + 1, 2 * x + (octant & 1), 2 * y + (octant >> 1 & 1), 2 * z + (octant >> 2));
+        }
+    };
+    partition(partition, 0, 0, 0, 0);
+    m_ChunkCount = chunks.size();
+
+    auto removeTemporaries = [&] {
+        for (const Chunk& chunk : chunks) {
+            std::remove(chunk.path.c_str());
+        }
+    };
+
+    // Pass three: every point appended to its chunk's file
+    const size_t appendPoints = std::max(MinAppendPoints, AppendBudget / sizeof(OctreePoint) / chunks.size());
+    for (Chunk& chunk : chunks) {
+        std::remove(chunk.path.c_str());
+    }
+    bool ok = source.Rewind();
+    while (size_t read = ok ? ReadFinite(source, batch.data(), batch.size()) : 0) {
+        for (size_t i = 0; i < read && ok; ++i) {
+            uint32_t cell[3];
+            grid.Cell(batch[i].position, cell);
+            Chunk& chunk =
+                chunks[cellChunk[cellIndex(countLevel, cell[0] >> countShift, cell[1] >> countShift, cell[2] >> countShift)]];
+            chunk.buffer.push_back(batch[i]);
+            if (chunk.buffer.size() >= appendPoints) {
+                ok = chunk.Flush();
+            }
+        }
+    }
+    for (Chunk& chunk : chunks) {
+        ok = chunk.Flush() && ok;
+        chunk.buffer = std::vector<OctreePoint>();
+    }
+    if (!ok || !source.IsValid()) {
+        std::cerr << "Failed to write the temporary chunk files next to " << base << std::endl;
+        removeTemporaries();
+        return false;
+    }
+    cellChunk = std::vector<uint32_t>();
+
+    OutputFile output;
+    output.file = std::fopen(outputPath.c_str(), "wb");
+    if (!output.file || std::fwrite(&header, sizeof(header), 1, output.file) != 1) {
+        std::cerr << "Cannot write " << outputPath << std::endl;
+        if (output.file) {
+            std::fclose(output.file);
+        }
+        removeTemporaries();
+        return false;
+    }
+
+    // Chunks build their subtrees concurrently; each root's sample goes back
+    // into the chunk file for the levels above
+    parallel::ForChunks(chunks.size(), [&](size_t c) {
+        Chunk& chunk = chunks[c];
+        std::vector<OctreePoint> points;
+        chunk.ok = ReadFile(chunk.path, points, size_t(chunk.count));
+        if (chunk.ok) {
+            SubtreeBuilder builder(grid, gridBits, maxNodePoints, output);
+            chunk.split = builder.Subdivide(chunk.level, chunk.x, chunk.y, chunk.z, points);
+            chunk.ok = WriteFile(chunk.path, points);
+            chunk.count = points.size();
+        }
+    });
+
+    std::unordered_map<uint64_t, size_t> chunkIndex;
+    for (size_t c = 0; c < chunks.size(); ++c) {
+        chunkIndex[NodeKey(chunks[c].level, chunks[c].x, chunks[c].y, chunks[c].z)] = c;
+    }
+
+    // Levels above the chunks, bottom-up: a node samples its children's
+    // samples and the children keep what it did not take
+    auto gather = [&](auto&& self, uint32_t level, uint32_t x, uint32_t y, uint32_t z, std::vector<OctreePoint>& kept,
+                      bool& hasChildren) -> bool {
+        if (isChunk(level, x, y, z)) {
+            const size_t c = chunkIndex.at(NodeKey(level, x, y, z));
+            hasChildren = chunks[c].split;
+            bool read = chunks[c].ok && ReadFile(chunks[c].path, kept, size_t(chunks[c].count));
+            std::remove(chunks[c].path.c_str());
+            return read;
+        }
+        CellSampler sampler(grid, gridBits);
+        hasChildren = true;
+        for (uint32_t octant = 0; octant < 8; ++octant) {
+            uint32_t cx = 2 * x + (octant & 1), cy = 2 * y + (octant >> 1 & 1), cz = 2 * z + (octant >> 2);
+            if (countOf(level + 1, cx, cy, cz) == 0) {
+                continue;
+            }
+            std::vector<OctreePoint> child;
+            bool childHasChildren = false;
+            if (!self(self, level + 1, cx, cy, cz, child, childHasChildren)) {
+                return false;
+            }
+            size_t remaining = 0;
+            for (const OctreePoint& point : child) {
+                if (sampler.Take(point.position, level)) {
+                    kept.push_back(point);
+                } else {
+                    child[remaining++] = point;
+                }
+            }
+            child.resize(remaining);
+            if (!child.empty() || childHasChildren) {
+                output.Append(NodeKey(level + 1, cx, cy, cz), child);
+            }
+        }
+        return true;
+    };
+    std::vector<OctreePoint> root;
+    bool rootHasChildren = false;
+    ok = std::all_of(chunks.begin(), chunks.end(), [](const Chunk& chunk) { return chunk.ok; }) &&
+         gather(gather, 0, 0, 0, 0, root, rootHasChildren);
+    removeTemporaries();
+    if (ok) {
+        output.Append(NodeKey(0, 0, 0, 0), root);
+    }
+
+    // Node table in breadth-first order, children contiguous in octant order
+    std::unordered_map<uint64_t, uint32_t> lookup;
+    lookup.reserve(output.records.size());
+    for (size_t i = 0; i < output.records.size(); ++i) {
+        lookup[output.records[i].key] = uint32_t(i);
+    }
+    std::vector<PointOctreeNode> nodes;
+    nodes.reserve(output.records.size());
+    auto makeNode = [&](const NodeRecord& record) {
+        PointOctreeNode node = {};
+        node.offset = record.offset;
+        node.count = record.count;
+        node.firstChild = INVALID_INDEX;
+        node.level = uint8_t(record.key >> 57);
+        node.x = uint32_t(record.key >> 38) & 0x7ffff;
+        node.y = uint32_t(record.key >> 19) & 0x7ffff;
+        node.z = uint32_t(record.key) & 0x7ffff;
+        return node;
+    };
+    if (ok) {
+        nodes.push_back(makeNode(output.records[lookup[NodeKey(0, 0, 0, 0)]]));
+    }
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        const PointOctreeNode parent = nodes[i];
+        for (uint32_t octant = 0; octant < 8; ++octant) {
+            auto found = lookup.find(NodeKey(parent.level + 1, 2 * parent.x + (octant & 1),
+                                             2 * parent.y + (octant >> 1 & 1), 2 * parent.z + (octant >> 2)));
+            if (found == lookup.end()) {
+                continue;
+            }
+            if (nodes[i].childMask == 0) {
+                nodes[i].firstChild = uint32_t(nodes.size());
+            }
+            nodes[i].childMask |= uint8_t(1u << octant);
+            nodes.push_back(makeNode(output.records[found->second]));
+            m_Depth = std::max<uint32_t>(m_Depth, parent.level + 1);
+        }
+    }
+    uint64_t stored = 0;
+    for (const PointOctreeNode& node : nodes) {
+        stored += node.count;
+    }
+    ok = ok && output.ok && stored == total;
+
+    header.nodeCount = uint32_t(nodes.size());
+    header.pointCount = stored;
+    header.nodeTableOffset = output.end;
+    ok = ok && std::fwrite(nodes.data(), sizeof(PointOctreeNode), nodes.size(), output.file) == nodes.size() &&
+         Seek(output.file, 0) && std::fwrite(&header, sizeof(header), 1, output.file) == 1;
+    ok = std::fclose(output.file) == 0 && ok;
+    if (!ok) {
+        std::cerr << "Failed to build the point octree " << outputPath << std::endl;
+        std::remove(outputPath.c_str());
+        return false;
+    }
+    m_PointCount = stored;
+    m_NodeCount = nodes.size();
+    return true;
+}
+
+} // namespace alice2
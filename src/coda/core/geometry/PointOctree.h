@@ -0,0 +1,154 @@
+#pragma once
+
+#include "Mesh.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace alice2 {
+
+class PointSource;
+
+// One point as stored on disk, streamed by the loader and pulled by the GPU
+// point pool: position relative to the file's offset and an RGBA8 colour
+// with red in the low byte
+struct OctreePoint {
+    Vec3f position;
+    uint32_t color;
+};
+static_assert(sizeof(OctreePoint) == 16, "octree points are read and uploaded as 16-byte records");
+
+uint32_t PackPointColor(const Color& color);
+Color UnpackPointColor(uint32_t color);
+
+// Entry of the node table. A node's cube is cell (x, y, z) of the root
+// cube split 2^level times per axis; its children are stored contiguously
+// from firstChild in octant order (bit 0 of the octant is x, bit 2 is z).
+struct PointOctreeNode {
+    uint64_t offset;     // Byte offset of the node's points in the file
+    uint32_t count;
+    uint32_t firstChild; // INVALID_INDEX for a leaf
+    uint32_t x, y, z;
+    uint8_t level;
+    uint8_t childMask;   // Bit i set when octant i has a child
+    uint16_t reserved;
+
+    uint32_t GetChildCount() const;
+};
+static_assert(sizeof(PointOctreeNode) == 32, "the node table is read as stored");
+
+// Out-of-core level-of-detail octree for point clouds too large to hold in
+// memory (laser scans of hundreds of millions of points), after Potree
+// (Schütz 2016). Points are distributed additively: every node keeps a
+// sample spaced about its cell size apart and passes the rest down, so a
+// node and its ancestors together are a denser sample of its cube, and a
+// viewer draws a cut through the tree that refines where the projected
+// spacing is too coarse.
+//
+// File layout: the 80-byte Header, the points of every node as contiguous
+// runs of OctreePoint, then the node table in breadth-first order (root
+// first). All values are little-endian. Positions are floats relative to
+// the header's double offset, so georeferenced coordinates keep their
+// precision.
+//
+// Opening reads only the header and node table; ReadNode fetches one
+// node's points and may be called from a loader thread while the hierarchy
+// is read elsewhere.
+class PointOctree {
+public:
+    struct Header {
+        char magic[8];           // "A2POCT\0\0"
+        uint32_t version;
+        uint32_t nodeCount;
+        uint64_t pointCount;
+        uint64_t nodeTableOffset;
+        float min[3];            // Root cube, relative to offset
+        float size;
+        float spacing;           // Sample spacing of the root (size / gridResolution)
+        uint32_t gridResolution;
+        double offset[3];        // Added to stored positions to recover the input coordinates
+    };
+    static_assert(sizeof(Header) == 80, "the header is read as stored");
+
+    static constexpr uint32_t Version = 1;
+
+    PointOctree() = default;
+    ~PointOctree();
+    PointOctree(const PointOctree&) = delete;
+    PointOctree& operator=(const PointOctree&) = delete;
+
+    bool Open(const std::string& path);
+    void Close();
+    bool IsOpen() const { return m_File != nullptr; }
+
+    const Header& GetHeader() const { return m_Header; }
+    const std::vector<PointOctreeNode>& GetNodes() const { return m_Nodes; }
+    size_t GetNodeCount() const { return m_Nodes.size(); }
+    uint64_t GetPointCount() const { return m_Header.pointCount; }
+    // Largest point count of any node, for sizing load buffers
+    uint32_t GetMaxNodePoints() const { return m_MaxNodePoints; }
+
+    // Cube and sample spacing of a node, in stored (offset-relative) coordinates
+    void GetNodeBounds(uint32_t node, Vec3f& min, Vec3f& max) const;
+    float GetNodeSize(uint32_t node) const;
+    float GetNodeSpacing(uint32_t node) const;
+
+    // Reads a node's points into points (resized); thread-safe
+    bool ReadNode(uint32_t node, std::vector<OctreePoint>& points) const;
+
+private:
+    std::FILE* m_File = nullptr;
+    Header m_Header = {};
+    std::vector<PointOctreeNode> m_Nodes;
+    uint32_t m_MaxNodePoints = 0;
+    mutable std::mutex m_FileMutex;
+};
+
+struct PointOctreeSettings {
+    uint32_t maxNodePoints = 20000;  // Leaves holding more are split
+    uint32_t gridResolution = 128;   // Sampling cells per node per axis
+    size_t chunkPoints = 1 << 21;    // Points processed in memory at once (per thread)
+    std::string temporaryDirectory;  // Chunk files; empty puts them next to the output
+    bool recenter = true;            // Store positions relative to the bounds centre
+};
+
+// Converts a point source into a PointOctree file in bounded memory.
+//
+// Pass one reads the bounds and count. Pass two counts points on a grid,
+// merges cells bottom-up into chunks of at most chunkPoints, and appends
+// each point to its chunk's temporary file. Chunks then build their
+// subtrees independently in parallel, writing every node below the chunk
+// root; the chunk roots' samples are set aside, and the levels above them
+// are built from those samples, grid-sampling children into parents. The
+// input is read three times and each point is written twice.
+class PointOctreeBuilder {
+public:
+    explicit PointOctreeBuilder(const PointOctreeSettings& settings = PointOctreeSettings());
+
+    void SetSettings(const PointOctreeSettings& settings) { m_Settings = settings; }
+    const PointOctreeSettings& GetSettings() const { return m_Settings; }
+
+    bool Build(PointSource& source, const std::string& outputPath);
+
+    // Statistics of the last build
+    uint64_t GetPointCount() const { return m_PointCount; }
+    size_t GetNodeCount() const { return m_NodeCount; }
+    size_t GetChunkCount() const { return m_ChunkCount; }
+    uint32_t GetDepth() const { return m_Depth; }
+
+    // Deepest level; below it the sample spacing drops under float precision
+    static constexpr uint32_t MaxLevel = 18;
+
+private:
+    PointOctreeSettings m_Settings;
+    uint64_t m_PointCount = 0;
+    size_t m_NodeCount = 0;
+    size_t m_ChunkCount = 0;
+    uint32_t m_Depth = 0;
+};
+
+} // namespace alice2
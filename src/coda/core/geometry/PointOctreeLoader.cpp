@@ -0,0 +1,136 @@
+#include "PointOctreeLoader.h"
+
+#include <algorithm>
+
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+#define ALICE2_LOADER_SERIAL 1
+#endif
+
+namespace alice2 {
+
+namespace {
+
+// Spare buffers kept for reuse
+constexpr size_t MaxSpareBuffers = 16;
+
+} // namespace
+
+PointOctreeLoader::PointOctreeLoader(const PointOctree& octree, size_t maxQueuedPoints)
+    : m_Octree(octree), m_MaxQueuedPoints(std::max<size_t>(maxQueuedPoints, 1)), m_States(octree.GetNodeCount(), Idle) {
+#ifndef ALICE2_LOADER_SERIAL
+    m_Thread = std::thread([this] { Run(); });
+#endif
+}
+
+PointOctreeLoader::~PointOctreeLoader() {
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stop = true;
+    }
+    m_Wake.notify_all();
+    if (m_Thread.joinable()) {
+        m_Thread.join();
+    }
+}
+
+bool PointOctreeLoader::IsThreaded() {
+#ifdef ALICE2_LOADER_SERIAL
+    return false;
+#else
+    return true;
+#endif
+}
+
+void PointOctreeLoader::Request(const std::vector<uint32_t>& nodes) {
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Requests.clear();
+        for (auto node = nodes.rbegin(); node != nodes.rend(); ++node) {
+            if (*node < m_States.size() && m_States[*node] == Idle) {
+                m_Requests.push_back(*node);
+            }
+        }
+    }
+    m_Wake.notify_one();
+}
+
+size_t PointOctreeLoader::TakeLoaded(std::vector<LoadedNode>& loaded, size_t maxPoints) {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+#ifdef ALICE2_LOADER_SERIAL
+    while (m_QueuedPoints < maxPoints && LoadNext(lock)) {
+    }
+#endif
+    size_t taken = 0, points = 0;
+    while (!m_Loaded.empty() && points < maxPoints) {
+        LoadedNode& node = m_Loaded.front();
+        m_States[node.node] = Idle;
+        m_QueuedPoints -= node.points.size();
+        points += node.points.size();
+        loaded.push_back(std::move(node));
+        m_Loaded.pop_front();
+        ++taken;
+    }
+    lock.unlock();
+    if (taken > 0) {
+        m_Wake.notify_one();
+    }
+    return taken;
+}
+
+void PointOctreeLoader::Recycle(std::vector<OctreePoint>&& points) {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (m_Spare.size() < MaxSpareBuffers) {
+        points.clear();
+        m_Spare.push_back(std::move(points));
+    }
+}
+
+size_t PointOctreeLoader::GetRequestCount() const {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Requests.size();
+}
+
+size_t PointOctreeLoader::GetQueuedCount() const {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Loaded.size();
+}
+
+bool PointOctreeLoader::LoadNext(std::unique_lock<std::mutex>& lock) {
+    while (!m_Requests.empty()) {
+        const uint32_t node = m_Requests.back();
+        m_Requests.pop_back();
+        if (m_States[node] != Idle) {
+            continue;
+        }
+        m_States[node] = Busy;
+        std::vector<OctreePoint> points;
+        if (!m_Spare.empty()) {
+            points = std::move(m_Spare.back());
+            m_Spare.pop_back();
+        }
+        lock.unlock();
+        bool ok = m_Octree.ReadNode(node, points);
+        lock.lock();
+        if (!ok) {
+            m_States[node] = Failed;
+            continue;
+        }
+        m_QueuedPoints += points.size();
+        m_Loaded.push_back({node, std::move(points)});
+        return true;
+    }
+    return false;
+}
+
+void PointOctreeLoader::Run() {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    while (!m_Stop) {
+        if (m_Requests.empty() || m_QueuedPoints >= m_MaxQueuedPoints) {
+            m_Wake.wait(lock);
+            continue;
+        }
+        LoadNext(lock);
+    }
+}
+
+} // namespace alice2
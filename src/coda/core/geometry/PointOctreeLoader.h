@@ -0,0 +1,77 @@
+#pragma once
+
+#include "PointOctree.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace alice2 {
+
+// Streams the points of octree nodes from disk on a background thread for
+// a viewer that asks, every frame, for the nodes it is missing in order of
+// importance. A request replaces the previous one, so nodes that left the
+// view before their turn are never read. Loaded nodes wait in a queue
+// capped at maxQueuedPoints until the render thread takes them, which
+// bounds the memory held between the file and the GPU.
+//
+// Web builds without pthreads have no loader thread; TakeLoaded reads the
+// requested nodes itself, up to its point budget.
+class PointOctreeLoader {
+public:
+    struct LoadedNode {
+        uint32_t node;
+        std::vector<OctreePoint> points;
+    };
+
+    // The octree must stay open while the loader exists
+    explicit PointOctreeLoader(const PointOctree& octree, size_t maxQueuedPoints = size_t(1) << 21);
+    ~PointOctreeLoader();
+    PointOctreeLoader(const PointOctreeLoader&) = delete;
+    PointOctreeLoader& operator=(const PointOctreeLoader&) = delete;
+
+    // Nodes to load, most important first. Nodes already queued or being
+    // read are skipped; a node that failed to read is not retried.
+    void Request(const std::vector<uint32_t>& nodes);
+
+    // Appends loaded nodes, oldest first, until at least maxPoints were
+    // taken or none are left; returns how many nodes were appended
+    size_t TakeLoaded(std::vector<LoadedNode>& loaded, size_t maxPoints);
+
+    // Hands a point buffer back for the next read, so steady streaming does
+    // not allocate
+    void Recycle(std::vector<OctreePoint>&& points);
+
+    // Nodes requested but not yet queued, and nodes queued
+    size_t GetRequestCount() const;
+    size_t GetQueuedCount() const;
+
+    static bool IsThreaded();
+
+private:
+    enum : uint8_t { Idle, Busy, Failed };
+
+    const PointOctree& m_Octree;
+    size_t m_MaxQueuedPoints;
+
+    mutable std::mutex m_Mutex;
+    std::condition_variable m_Wake;
+    std::vector<uint32_t> m_Requests;  // Reversed: the next node is at the back
+    std::vector<uint8_t> m_States;     // Per node: Busy while read or queued
+    std::deque<LoadedNode> m_Loaded;
+    size_t m_QueuedPoints = 0;
+    std::vector<std::vector<OctreePoint>> m_Spare;
+    bool m_Stop = false;
+    std::thread m_Thread;
+
+    void Run();
+    // Reads the next requested node with the mutex held by lock (released
+    // during the read); false when there is nothing to read
+    bool LoadNext(std::unique_lock<std::mutex>& lock);
+};
+
+} // namespace alice2
@@ -0,0 +1,422 @@
+#include "Relaxation.h"
+#include "../utilities/Parallel.h"
+#include "../utilities/Simd.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+namespace alice2 {
+
+namespace {
+
+constexpr size_t GoalGrain = 512;
+constexpr size_t FloatGrain = 16384;
+// Colours tracked per vertex; goals that find them all taken go to a last,
+// serially projected class
+constexpr uint32_t MaxColors = 64;
+
+Vec3f Rotate(const Vec3f& x, const Vec3f& axis, float angle) {
+    float c = std::cos(angle), s = std::sin(angle);
+    return x * c + axis.Cross(x) * s + axis * (axis.Dot(x) * (1.0f - c));
+}
+
+} // namespace
+
+uint32_t RelaxationSolver::AddGoal(RelaxationGoal type, const uint32_t* vertices, uint32_t count, float stiffness,
+                                   float value, const Vec3f& target) {
+    if (!(stiffness > 0.0f) || (std::isinf(stiffness) && type != RelaxationGoal::Anchor)) {
+        std::cerr << "RelaxationSolver: goal stiffness must be positive and finite" << std::endl;
+        return INVALID_INDEX;
+    }
+    Goal goal;
+    goal.type = type;
+    goal.first = uint32_t(m_GoalVertices.size());
+    goal.count = count;
+    goal.stiffness = stiffness;
+    goal.value = value;
+    goal.target = target;
+    m_GoalVertices.insert(m_GoalVertices.end(), vertices, vertices + count);
+    m_Goals.push_back(goal);
+    m_Prepared = false;
+    return uint32_t(m_Goals.size() - 1);
+}
+
+uint32_t RelaxationSolver::AddSpring(uint32_t a, uint32_t b, float restLength, float stiffness) {
+    uint32_t vertices[2] = {a, b};
+    return AddGoal(RelaxationGoal::Spring, vertices, 2, stiffness, restLength, Vec3f());
+}
+
+uint32_t RelaxationSolver::AddAnchor(uint32_t vertex, const Vec3f& target, float stiffness) {
+    return AddGoal(RelaxationGoal::Anchor, &vertex, 1, stiffness, 0.0f, target);
+}
+
+uint32_t RelaxationSolver::AddPlanarity(const std::vector<uint32_t>& vertices, float stiffness) {
+    return AddGoal(RelaxationGoal::Planarity, vertices.data(), uint32_t(vertices.size()), stiffness, 0.0f, Vec3f());
+}
+
+uint32_t RelaxationSolver::AddAngle(uint32_t a, uint32_t apex, uint32_t b, float angle, float stiffness) {
+    uint32_t vertices[3] = {a, apex, b};
+    return AddGoal(RelaxationGoal::Angle, vertices, 3, stiffness, angle, Vec3f());
+}
+
+void RelaxationSolver::SetAnchorTarget(uint32_t goal, const Vec3f& target) {
+    if (goal < m_Goals.size() && m_Goals[goal].type == RelaxationGoal::Anchor) {
+        m_Goals[goal].target = target;
+    }
+}
+
+void RelaxationSolver::AddLoad(uint32_t vertex, const Vec3f& force) {
+    m_Loads.push_back({vertex, force});
+    m_Prepared = false;
+}
+
+void RelaxationSolver::AddSprings(const Graph& graph, float stiffness, float restScale) {
+    const std::vector<Vec3f>& positions = graph.GetPositions();
+    for (uint32_t e = 0; e < graph.GetEdgeCount(); ++e) {
+        uint32_t a = graph.GetEdgeSource(e), b = graph.GetEdgeTarget(e);
+        if (a != b) {
+            AddSpring(a, b, (positions[a] - positions[b]).Length() * restScale, stiffness);
+        }
+    }
+}
+
+void RelaxationSolver::AddSprings(const Mesh& mesh, float stiffness, float restScale) {
+    const std::vector<Vec3f>& positions = mesh.GetPositions();
+    for (uint32_t e = 0; e < mesh.GetEdgeCount(); ++e) {
+        uint32_t h = mesh.EdgeHalfEdge(e);
+        uint32_t a = mesh.Source(h), b = mesh.Target(h);
+        AddSpring(a, b, (positions[a] - positions[b]).Length() * restScale, stiffness);
+    }
+}
+
+void RelaxationSolver::AddPlanarity(const Mesh& mesh, float stiffness) {
+    std::vector<uint32_t> corners;
+    for (uint32_t face = 0; face < mesh.GetFaceCount(); ++face) {
+        corners.clear();
+        uint32_t start = mesh.FaceHalfEdge(face), h = start;
+        do {
+            corners.push_back(mesh.Source(h));
+            h = mesh.Next(h);
+        } while (h != start);
+        if (corners.size() > 3) {
+            AddPlanarity(corners, stiffness);
+        }
+    }
+}
+
+void RelaxationSolver::Clear() {
+    m_Goals.clear();
+    m_GoalVertices.clear();
+    m_Loads.clear();
+    m_Prepared = false;
+    ResetMotion();
+}
+
+void RelaxationSolver::ResetMotion() {
+    std::fill(m_Velocity.begin(), m_Velocity.end(), 0.0f);
+    m_Iterations = 0;
+    m_Residual = 0.0f;
+    m_KineticEnergy = 0.0f;
+}
+
+bool RelaxationSolver::Prepare(size_t vertexCount) {
+    if (m_Prepared && m_InverseMass.size() == vertexCount) {
+        return true;
+    }
+    for (uint32_t v : m_GoalVertices) {
+        if (v >= vertexCount) {
+            std::cerr << "RelaxationSolver: goal vertex " << v << " out of range" << std::endl;
+            return false;
+        }
+    }
+    for (const auto& load : m_Loads) {
+        if (load.first >= vertexCount) {
+            std::cerr << "RelaxationSolver: load vertex " << load.first << " out of range" << std::endl;
+            return false;
+        }
+    }
+
+    // Rigid anchors pin their vertex: no mass to move, no colour to claim
+    m_InverseMass.assign(vertexCount, 1.0f);
+    m_Pins.clear();
+    for (size_t g = 0; g < m_Goals.size(); ++g) {
+        const Goal& goal = m_Goals[g];
+        if (goal.type == RelaxationGoal::Anchor && goal.stiffness == Rigid) {
+            m_InverseMass[m_GoalVertices[goal.first]] = 0.0f;
+            m_Pins.push_back(uint32_t(g));
+        }
+    }
+
+    m_Acceleration.assign(vertexCount * 3, 0.0f);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        m_Acceleration[3 * v] = m_Settings.gravity.x;
+        m_Acceleration[3 * v + 1] = m_Settings.gravity.y;
+        m_Acceleration[3 * v + 2] = m_Settings.gravity.z;
+    }
+    for (const auto& load : m_Loads) {
+        m_Acceleration[3 * load.first] += load.second.x;
+        m_Acceleration[3 * load.first + 1] += load.second.y;
+        m_Acceleration[3 * load.first + 2] += load.second.z;
+    }
+    if (m_Velocity.size() != vertexCount * 3) {
+        m_Velocity.assign(vertexCount * 3, 0.0f);
+        m_Iterations = 0;
+        m_KineticEnergy = 0.0f;
+    }
+    for (size_t v = 0; v < vertexCount; ++v) {
+        if (m_InverseMass[v] == 0.0f) {
+            for (size_t k = 3 * v; k < 3 * v + 3; ++k) {
+                m_Acceleration[k] = 0.0f;
+                m_Velocity[k] = 0.0f;
+            }
+        }
+    }
+    m_Targets.assign(vertexCount * 3, 0.0f);
+    m_Weights.assign(vertexCount * 3, 0.0f);
+
+    // Greedy colouring in insertion order; pinned vertices take no targets,
+    // so goals may share them within a colour
+    std::vector<uint64_t> used(vertexCount, 0);
+    std::vector<uint32_t> colors(m_Goals.size(), INVALID_INDEX);
+    std::vector<uint32_t> counts(MaxColors + 1, 0);
+    for (size_t g = 0; g < m_Goals.size(); ++g) {
+        const Goal& goal = m_Goals[g];
+        if (goal.type == RelaxationGoal::Anchor && goal.stiffness == Rigid) {
+            continue;
+        }
+        uint64_t taken = 0;
+        for (uint32_t i = goal.first; i < goal.first + goal.count; ++i) {
+            taken |= used[m_GoalVertices[i]];
+        }
+        uint32_t color = taken == ~uint64_t(0) ? MaxColors : uint32_t(std::countr_zero(~taken));
+        if (color < MaxColors) {
+            for (uint32_t i = goal.first; i < goal.first + goal.count; ++i) {
+                uint32_t v = m_GoalVertices[i];
+                if (m_InverseMass[v] != 0.0f) {
+                    used[v] |= uint64_t(1) << color;
+                }
+            }
+        }
+        colors[g] = color;
+        ++counts[color];
+    }
+
+    uint32_t colorCount = MaxColors + 1;
+    while (colorCount > 0 && counts[colorCount - 1] == 0) {
+        --colorCount;
+    }
+    m_ColorOffsets.assign(colorCount + 1, 0);
+    for (uint32_t c = 0; c < colorCount; ++c) {
+        m_ColorOffsets[c + 1] = m_ColorOffsets[c] + counts[c];
+    }
+    m_ColoredGoals.resize(m_ColorOffsets[colorCount]);
+    std::vector<uint32_t> cursor(m_ColorOffsets.begin(), m_ColorOffsets.end() - 1);
+    for (size_t g = 0; g < m_Goals.size(); ++g) {
+        if (colors[g] != INVALID_INDEX) {
+            m_ColoredGoals[cursor[colors[g]]++] = uint32_t(g);
+        }
+    }
+    m_Prepared = true;
+    return true;
+}
+
+void RelaxationSolver::Accumulate(const Goal& goal, const Vec3f* positions) {
+    const uint32_t* vertices = m_GoalVertices.data() + goal.first;
+    auto add = [&](uint32_t vertex, const Vec3f& target) {
+        if (m_InverseMass[vertex] == 0.0f) {
+            return;
+        }
+        float* sum = m_Targets.data() + 3 * size_t(vertex);
+        float* weight = m_Weights.data() + 3 * size_t(vertex);
+        sum[0] += goal.stiffness * target.x;
+        sum[1] += goal.stiffness * target.y;
+        sum[2] += goal.stiffness * target.z;
+        weight[0] += goal.stiffness;
+        weight[1] += goal.stiffness;
+        weight[2] += goal.stiffness;
+    };
+
+    switch (goal.type) {
+    case RelaxationGoal::Spring: {
+        const Vec3f& a = positions[vertices[0]];
+        const Vec3f& b = positions[vertices[1]];
+        Vec3f d = a - b;
+        float length = d.Length();
+        if (length < 1e-12f) {
+            return;
+        }
+        d *= goal.value / length;
+        add(vertices[0], b + d);
+        add(vertices[1], a - d);
+        return;
+    }
+    case RelaxationGoal::Anchor:
+        add(vertices[0], goal.target);
+        return;
+    case RelaxationGoal::Planarity: {
+        // Newell normal through the centroid
+        Vec3f normal, centroid;
+        for (uint32_t i = 0; i < goal.count; ++i) {
+            const Vec3f& p = positions[vertices[i]];
+            const Vec3f& q = positions[vertices[(i + 1) % goal.count]];
+            normal += Vec3f((p.y - q.y) * (p.z + q.z), (p.z - q.z) * (p.x + q.x), (p.x - q.x) * (p.y + q.y));
+            centroid += p;
+        }
+        float length = normal.Length();
+        if (length < 1e-20f) {
+            return;
+        }
+        normal /= length;
+        centroid /= float(goal.count);
+        for (uint32_t i = 0; i < goal.count; ++i) {
+            const Vec3f& p = positions[vertices[i]];
+            add(vertices[i], p - normal * normal.Dot(p - centroid));
+        }
+        return;
+    }
+    case RelaxationGoal::Angle: {
+        // Both arms turn by half the error about the apex, then the three
+        // shift back onto their centroid
+        const Vec3f& a = positions[vertices[0]];
+        const Vec3f& apex = positions[vertices[1]];
+        const Vec3f& b = positions[vertices[2]];
+        Vec3f u = a - apex, v = b - apex;
+        Vec3f cross = u.Cross(v);
+        float sine = cross.Length();
+        float delta = goal.value - std::atan2(sine, u.Dot(v));
+        Vec3f axis;
+        if (sine > 1e-12f * u.Length() * v.Length()) {
+            axis = cross / sine;
+        } else if (std::abs(delta) > 1e-7f) {
+            // Collinear: open in any plane containing the arms
+            axis = u.Cross(std::abs(u.x) < 0.9f * u.Length() ? Vec3f(1, 0, 0) : Vec3f(0, 1, 0)).Normalize();
+        }
+        Vec3f ta = apex + Rotate(u, axis, -0.5f * delta);
+        Vec3f tb = apex + Rotate(v, axis, 0.5f * delta);
+        Vec3f shift = (a + apex + b - ta - apex - tb) / 3.0f;
+        add(vertices[0], ta + shift);
+        add(vertices[1], apex + shift);
+        add(vertices[2], tb + shift);
+        return;
+    }
+    }
+}
+
+bool RelaxationSolver::Step(std::vector<Vec3f>& positions, int steps) {
+    if (!Prepare(positions.size())) {
+        return false;
+    }
+    using simd::FloatV;
+    float* x = reinterpret_cast<float*>(positions.data());
+    float* v = m_Velocity.data();
+    float* targets = m_Targets.data();
+    float* weights = m_Weights.data();
+    const float* acceleration = m_Acceleration.data();
+    const size_t floatCount = positions.size() * 3;
+    const float h = m_Settings.timeStep;
+    const float retain = 1.0f - std::clamp(m_Settings.damping, 0.0f, 1.0f);
+
+    const size_t chunkCount = parallel::ChunkCount(floatCount, FloatGrain);
+    m_ChunkResidual.resize(chunkCount);
+    m_ChunkEnergy.resize(chunkCount);
+
+    for (int step = 0; step < steps; ++step) {
+        for (uint32_t pin : m_Pins) {
+            positions[m_GoalVertices[m_Goals[pin].first]] = m_Goals[pin].target;
+        }
+
+        // Goal targets from the current positions, one colour at a time so
+        // that no two goals of a pass add to the same vertex
+        for (size_t c = 0; c + 1 < m_ColorOffsets.size(); ++c) {
+            const uint32_t first = m_ColorOffsets[c], count = m_ColorOffsets[c + 1] - first;
+            auto accumulate = [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    Accumulate(m_Goals[m_ColoredGoals[first + i]], positions.data());
+                }
+            };
+            if (c == MaxColors) {
+                accumulate(0, count);
+            } else {
+                parallel::For(count, GoalGrain, accumulate);
+            }
+        }
+
+        // Explicit step under fictitious masses m = 1 + 2 h^2 * weight, which
+        // bound the step below half a Jacobi move so that it stays stable
+        // with velocities zeroed by kinetic damping:
+        // v = retain * v + h * (a + sum - weight * x) / m, x += h * v; the
+        // sums are cleared for the next step
+        parallel::ForChunks(chunkCount, [&](size_t chunk) {
+            size_t begin = floatCount * chunk / chunkCount, end = floatCount * (chunk + 1) / chunkCount;
+            const FloatV hv = FloatV::Broadcast(h), h2 = FloatV::Broadcast(2.0f * h * h), keep = FloatV::Broadcast(retain),
+                         one = FloatV::Broadcast(1.0f), zero = FloatV::Broadcast(0.0f);
+            FloatV largest = zero, energy = zero;
+            size_t k = begin;
+            for (; k + FloatV::Width <= end; k += FloatV::Width) {
+                FloatV position = FloatV::Load(x + k), weight = FloatV::Load(weights + k);
+                FloatV force = FloatV::Load(acceleration + k) + FloatV::Load(targets + k) - weight * position;
+                FloatV velocity = simd::MulAdd(FloatV::Load(v + k), keep, hv * force / simd::MulAdd(weight, h2, one));
+                FloatV move = velocity * hv;
+                (position + move).Store(x + k);
+                velocity.Store(v + k);
+                zero.Store(targets + k);
+                zero.Store(weights + k);
+                largest = simd::Max(largest, simd::Max(move, -move));
+                energy = simd::MulAdd(velocity, velocity, energy);
+            }
+            alignas(32) float lanes[2][FloatV::Width];
+            largest.Store(lanes[0]);
+            energy.Store(lanes[1]);
+            float residual = 0.0f, sum = 0.0f;
+            for (int lane = 0; lane < FloatV::Width; ++lane) {
+                residual = std::max(residual, lanes[0][lane]);
+                sum += lanes[1][lane];
+            }
+            for (; k < end; ++k) {
+                float force = acceleration[k] + targets[k] - weights[k] * x[k];
+                v[k] = v[k] * retain + h * force / (1.0f + 2.0f * h * h * weights[k]);
+                float move = h * v[k];
+                x[k] += move;
+                targets[k] = 0.0f;
+                weights[k] = 0.0f;
+                residual = std::max(residual, std::abs(move));
+                sum += v[k] * v[k];
+            }
+            m_ChunkResidual[chunk] = residual;
+            m_ChunkEnergy[chunk] = sum;
+        });
+
+        float residual = 0.0f, energy = 0.0f;
+        for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+            residual = std::max(residual, m_ChunkResidual[chunk]);
+            energy += m_ChunkEnergy[chunk];
+        }
+        energy *= 0.5f;
+        // Kinetic damping: past a peak of kinetic energy, restart from rest
+        if (m_Settings.kineticDamping && m_Iterations > 0 && energy < m_KineticEnergy) {
+            std::fill(m_Velocity.begin(), m_Velocity.end(), 0.0f);
+            energy = 0.0f;
+        }
+        m_Residual = residual;
+        m_KineticEnergy = energy;
+        ++m_Iterations;
+    }
+    return true;
+}
+
+bool RelaxationSolver::Step(Mesh& mesh, int steps) {
+    bool ok = Step(mesh.GetPositions(), steps);
+    mesh.MarkAllDirty();
+    return ok;
+}
+
+bool RelaxationSolver::Step(Graph& graph, int steps) {
+    bool ok = Step(graph.GetPositions(), steps);
+    graph.MarkAllDirty();
+    return ok;
+}
+
+} // namespace alice2
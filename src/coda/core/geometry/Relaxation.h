@@ -0,0 +1,134 @@
+#pragma once
+
+#include "Graph.h"
+#include "Mesh.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace alice2 {
+
+enum class RelaxationGoal : uint8_t {
+    Spring,    // Distance between two vertices
+    Anchor,    // Vertex to a target point
+    Planarity, // Polygon onto its best-fit plane
+    Angle      // Angle at an apex between two neighbours
+};
+
+struct RelaxationSettings {
+    float timeStep = 1.0f;
+    float damping = 0.1f;             // Velocity fraction lost per step
+    bool kineticDamping = true;       // Zero velocities at kinetic energy peaks
+    Vec3f gravity = Vec3f(0, 0, 0);   // Acceleration on every free vertex
+    float tolerance = 1e-5f;          // Converged below this per-step displacement
+};
+
+// Form-finding by dynamic relaxation over projective goals, in the manner
+// of Kangaroo and projective dynamics (Bouaziz et al. 2014). Every step
+// lets each goal propose target positions for its vertices, predicts
+// positions from velocities and loads, and moves every vertex to the
+// stiffness-weighted blend of its prediction and targets (one Jacobi
+// iteration of the projective dynamics global solve). A goal pulls with
+// stiffness times the distance to its target, so the rest state is the
+// force balance of goals and loads. Rigid anchors pin their vertex.
+//
+// Goals are greedily coloured so that no two of a colour share a vertex,
+// which lets a colour's goals add their targets in parallel without
+// atomics. Predict and blend passes run with SIMD over the flat xyz array,
+// in place on the positions the caller passes (a Mesh's or Graph's own).
+class RelaxationSolver {
+public:
+    static constexpr float Rigid = std::numeric_limits<float>::infinity();
+
+    struct Goal {
+        RelaxationGoal type;
+        uint32_t first;   // Into GetGoalVertices()
+        uint32_t count;
+        float stiffness;
+        float value;      // Rest length or angle (radians)
+        Vec3f target;     // Anchor position
+    };
+
+    explicit RelaxationSolver(const RelaxationSettings& settings = RelaxationSettings()) : m_Settings(settings) {}
+
+    void SetSettings(const RelaxationSettings& settings) {
+        m_Settings = settings;
+        m_Prepared = false;
+    }
+    const RelaxationSettings& GetSettings() const { return m_Settings; }
+
+    // Goals; each returns its index, INVALID_INDEX for a stiffness that is
+    // not positive and finite. Adding goals or loads re-colours on the next
+    // step but keeps velocities.
+    uint32_t AddSpring(uint32_t a, uint32_t b, float restLength, float stiffness = 1.0f);
+    // A Rigid anchor pins the vertex (it is not moved by other goals)
+    uint32_t AddAnchor(uint32_t vertex, const Vec3f& target, float stiffness = Rigid);
+    // Moves an anchor's target, e.g. while dragging; no re-colouring
+    void SetAnchorTarget(uint32_t goal, const Vec3f& target);
+    uint32_t AddPlanarity(const std::vector<uint32_t>& vertices, float stiffness = 1.0f);
+    // Angle a-apex-b in radians; pi keeps the three in line
+    uint32_t AddAngle(uint32_t a, uint32_t apex, uint32_t b, float angle, float stiffness = 1.0f);
+    // External force, summed per vertex (unit masses)
+    void AddLoad(uint32_t vertex, const Vec3f& force);
+
+    // One spring per edge, at restScale times the current length
+    void AddSprings(const Graph& graph, float stiffness = 1.0f, float restScale = 1.0f);
+    void AddSprings(const Mesh& mesh, float stiffness = 1.0f, float restScale = 1.0f);
+    // Planarity for every face with more than three corners
+    void AddPlanarity(const Mesh& mesh, float stiffness = 1.0f);
+
+    void Clear();
+    // Drops velocities, e.g. after moving vertices by hand
+    void ResetMotion();
+
+    // Runs steps on the positions in place. Vertices referenced by goals
+    // must exist; velocities restart when the vertex count changes.
+    bool Step(std::vector<Vec3f>& positions, int steps = 1);
+    // The same on a mesh or graph, marking its positions dirty
+    bool Step(Mesh& mesh, int steps = 1);
+    bool Step(Graph& graph, int steps = 1);
+
+    // Largest coordinate change of the last step, and its kinetic energy
+    float GetResidual() const { return m_Residual; }
+    float GetKineticEnergy() const { return m_KineticEnergy; }
+    bool IsConverged() const { return m_Iterations > 0 && m_Residual < m_Settings.tolerance; }
+    size_t GetIterationCount() const { return m_Iterations; }
+
+    const std::vector<Goal>& GetGoals() const { return m_Goals; }
+    const std::vector<uint32_t>& GetGoalVertices() const { return m_GoalVertices; }
+    // Colour classes: goals of colour c are GetColoredGoals()[offsets[c], offsets[c + 1])
+    const std::vector<uint32_t>& GetColorOffsets() const { return m_ColorOffsets; }
+    const std::vector<uint32_t>& GetColoredGoals() const { return m_ColoredGoals; }
+
+private:
+    RelaxationSettings m_Settings;
+
+    std::vector<Goal> m_Goals;
+    std::vector<uint32_t> m_GoalVertices;
+    std::vector<std::pair<uint32_t, Vec3f>> m_Loads;
+    bool m_Prepared = false;
+
+    std::vector<uint32_t> m_ColorOffsets;
+    std::vector<uint32_t> m_ColoredGoals;
+    std::vector<float> m_InverseMass;   // 0 for pinned vertices
+    std::vector<float> m_Acceleration;  // xyz per vertex: loads and gravity
+    std::vector<float> m_Velocity;      // xyz per vertex
+    std::vector<float> m_Targets;       // xyz per vertex: stiffness-weighted goal targets
+    std::vector<float> m_Weights;       // Summed stiffness, repeated for x, y and z
+    std::vector<uint32_t> m_Pins;       // Rigid anchor goals
+    std::vector<float> m_ChunkResidual;
+    std::vector<float> m_ChunkEnergy;
+
+    size_t m_Iterations = 0;
+    float m_Residual = 0.0f;
+    float m_KineticEnergy = 0.0f;
+
+    uint32_t AddGoal(RelaxationGoal type, const uint32_t* vertices, uint32_t count, float stiffness, float value,
+                     const Vec3f& target);
+    bool Prepare(size_t vertexCount);
+    void Accumulate(const Goal& goal, const Vec3f* positions);
+};
+
+} // namespace alice2
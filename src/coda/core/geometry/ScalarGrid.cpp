@@ -0,0 +1,181 @@
+#include "ScalarGrid.h"
+#include "../utilities/Parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace alice2 {
+
+namespace {
+
+// Floor division for brick coordinates of negative points
+inline int FloorDiv(int value, int divisor) {
+    return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+}
+
+} // namespace
+
+bool ScalarGrid::Create(int sizeX, int sizeY, int sizeZ, const Vec3f& origin, float spacing, float value) {
+    if (sizeX < 2 || sizeY < 2 || sizeZ < 2 || spacing <= 0.0f) {
+        std::cerr << "ScalarGrid: needs at least 2 points per axis and a positive spacing" << std::endl;
+        return false;
+    }
+    m_SizeX = sizeX;
+    m_SizeY = sizeY;
+    m_SizeZ = sizeZ;
+    m_Origin = origin;
+    m_Spacing = spacing;
+    m_Values.assign(size_t(sizeX) * size_t(sizeY) * size_t(sizeZ), value);
+    return true;
+}
+
+void ScalarGrid::Clear() {
+    m_SizeX = m_SizeY = m_SizeZ = 0;
+    m_Values.clear();
+    m_Values.shrink_to_fit();
+}
+
+void ScalarGrid::Sample(const ScalarField& field) {
+    parallel::For(size_t(m_SizeZ), 1, [&](size_t begin, size_t end) {
+        for (size_t z = begin; z < end; ++z) {
+            for (int y = 0; y < m_SizeY; ++y) {
+                float* row = m_Values.data() + Index(0, y, int(z));
+                for (int x = 0; x < m_SizeX; ++x) {
+                    row[x] = field(GetPosition(x, y, int(z)));
+                }
+            }
+        }
+    });
+}
+
+SparseScalarGrid::SparseScalarGrid(const Vec3f& origin, float spacing, float background)
+    : m_Origin(origin), m_Spacing(spacing), m_Background(background) {}
+
+void SparseScalarGrid::Clear() {
+    m_Bricks.clear();
+    m_Values.clear();
+    m_Lookup.clear();
+    m_Tiles.clear();
+}
+
+uint64_t SparseScalarGrid::BrickKey(int bx, int by, int bz) {
+    // 21 bits per axis, biased so negative coordinates pack too
+    const int64_t bias = int64_t(1) << 20;
+    return uint64_t(bx + bias) | (uint64_t(by + bias) << 21) | (uint64_t(bz + bias) << 42);
+}
+
+uint32_t SparseScalarGrid::FindBrick(int bx, int by, int bz) const {
+    auto it = m_Lookup.find(BrickKey(bx, by, bz));
+    return it != m_Lookup.end() ? it->second : NotFound;
+}
+
+uint32_t SparseScalarGrid::AddBrick(int bx, int by, int bz) {
+    auto [it, inserted] = m_Lookup.try_emplace(BrickKey(bx, by, bz), uint32_t(m_Bricks.size()));
+    if (inserted) {
+        // A brick replaces its tile and starts at the tile's value
+        float fill = GetFill(bx, by, bz);
+        m_Tiles.erase(it->first);
+        m_Bricks.push_back({bx, by, bz});
+        m_Values.resize(m_Values.size() + BrickVolume, fill);
+    }
+    return it->second;
+}
+
+void SparseScalarGrid::GetBrickCoordinates(uint32_t brick, int& bx, int& by, int& bz) const {
+    bx = m_Bricks[brick].x;
+    by = m_Bricks[brick].y;
+    bz = m_Bricks[brick].z;
+}
+
+float SparseScalarGrid::GetFill(int bx, int by, int bz) const {
+    if (m_Tiles.empty()) {
+        return m_Background;
+    }
+    auto it = m_Tiles.find(BrickKey(bx, by, bz));
+    return it != m_Tiles.end() ? it->second : m_Background;
+}
+
+void SparseScalarGrid::SetTile(int bx, int by, int bz, float value) {
+    m_Tiles[BrickKey(bx, by, bz)] = value;
+}
+
+float SparseScalarGrid::Get(int x, int y, int z) const {
+    int bx = FloorDiv(x, BrickSize), by = FloorDiv(y, BrickSize), bz = FloorDiv(z, BrickSize);
+    uint32_t brick = FindBrick(bx, by, bz);
+    if (brick == NotFound) {
+        return GetFill(bx, by, bz);
+    }
+    int lx = x - bx * BrickSize, ly = y - by * BrickSize, lz = z - bz * BrickSize;
+    return GetBrickValues(brick)[(lz * BrickSize + ly) * BrickSize + lx];
+}
+
+void SparseScalarGrid::Set(int x, int y, int z, float value) {
+    int bx = FloorDiv(x, BrickSize), by = FloorDiv(y, BrickSize), bz = FloorDiv(z, BrickSize);
+    uint32_t brick = AddBrick(bx, by, bz);
+    int lx = x - bx * BrickSize, ly = y - by * BrickSize, lz = z - bz * BrickSize;
+    GetBrickValues(brick)[(lz * BrickSize + ly) * BrickSize + lx] = value;
+}
+
+size_t SparseScalarGrid::SampleNarrowBand(const ScalarField& field, const Vec3f& minBound, const Vec3f& maxBound,
+                                          float band) {
+    const float brickWorld = m_Spacing * BrickSize;
+    auto brickMin = [&](float coordinate, float origin) {
+        return FloorDiv(int(std::floor((coordinate - origin) / m_Spacing)), BrickSize);
+    };
+    auto brickMax = [&](float coordinate, float origin) {
+        return FloorDiv(int(std::ceil((coordinate - origin) / m_Spacing)), BrickSize);
+    };
+    int x0 = brickMin(minBound.x, m_Origin.x), x1 = brickMax(maxBound.x, m_Origin.x);
+    int y0 = brickMin(minBound.y, m_Origin.y), y1 = brickMax(maxBound.y, m_Origin.y);
+    int z0 = brickMin(minBound.z, m_Origin.z), z1 = brickMax(maxBound.z, m_Origin.z);
+    if (x1 < x0 || y1 < y0 || z1 < z0) {
+        return 0;
+    }
+    size_t countX = size_t(x1 - x0 + 1), countY = size_t(y1 - y0 + 1), countZ = size_t(z1 - z0 + 1);
+    size_t candidates = countX * countY * countZ;
+
+    // Cull on the brick centres in parallel, then allocate serially in
+    // candidate order so brick indices do not depend on the thread count
+    const float reach = band + 0.5f * std::sqrt(3.0f) * brickWorld;
+    const float half = 0.5f * m_Spacing * (BrickSize - 1);
+    std::vector<int8_t> keep(candidates); // 1 sample, -1 tile, 0 background
+    parallel::For(candidates, 64, [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; ++c) {
+            int bx = x0 + int(c % countX), by = y0 + int((c / countX) % countY), bz = z0 + int(c / (countX * countY));
+            Vec3f center = m_Origin + Vec3f(float(bx), float(by), float(bz)) * brickWorld + Vec3f(half, half, half);
+            float value = field(center);
+            keep[c] = std::abs(value) <= reach ? 1 : ((value < 0.0f) != (m_Background < 0.0f) ? -1 : 0);
+        }
+    });
+
+    std::vector<uint32_t> bricks;
+    size_t before = m_Bricks.size();
+    for (size_t c = 0; c < candidates; ++c) {
+        int bx = x0 + int(c % countX), by = y0 + int((c / countX) % countY), bz = z0 + int(c / (countX * countY));
+        if (keep[c] > 0) {
+            bricks.push_back(AddBrick(bx, by, bz));
+        } else if (keep[c] < 0 && FindBrick(bx, by, bz) == NotFound) {
+            SetTile(bx, by, bz, -m_Background);
+        }
+    }
+
+    parallel::For(bricks.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const BrickCoordinates& brick = m_Bricks[bricks[i]];
+            float* values = GetBrickValues(bricks[i]);
+            for (int z = 0; z < BrickSize; ++z) {
+                for (int y = 0; y < BrickSize; ++y) {
+                    for (int x = 0; x < BrickSize; ++x) {
+                        Vec3f point(float(brick.x * BrickSize + x), float(brick.y * BrickSize + y),
+                                    float(brick.z * BrickSize + z));
+                        *values++ = field(m_Origin + point * m_Spacing);
+                    }
+                }
+            }
+        }
+    });
+    return m_Bricks.size() - before;
+}
+
+} // namespace alice2
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "../../../core/base/Types.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace alice2 {
+
+using ScalarField = std::function<float(const Vec3f&)>;
+
+// Scalar samples on a bounded regular lattice; point (x, y, z) sits at
+// origin + spacing * (x, y, z). Values are stored x-fastest.
+class ScalarGrid {
+public:
+    bool Create(int sizeX, int sizeY, int sizeZ, const Vec3f& origin, float spacing, float value = 0.0f);
+    void Clear();
+
+    // Evaluates field at every lattice point, z-slices in parallel
+    void Sample(const ScalarField& field);
+
+    float Get(int x, int y, int z) const { return m_Values[Index(x, y, z)]; }
+    void Set(int x, int y, int z, float value) { m_Values[Index(x, y, z)] = value; }
+    size_t Index(int x, int y, int z) const {
+        return (size_t(z) * size_t(m_SizeY) + size_t(y)) * size_t(m_SizeX) + size_t(x);
+    }
+    Vec3f GetPosition(int x, int y, int z) const {
+        return m_Origin + Vec3f(float(x), float(y), float(z)) * m_Spacing;
+    }
+
+    int GetSizeX() const { return m_SizeX; }
+    int GetSizeY() const { return m_SizeY; }
+    int GetSizeZ() const { return m_SizeZ; }
+    size_t GetPointCount() const { return m_Values.size(); }
+    const Vec3f& GetOrigin() const { return m_Origin; }
+    float GetSpacing() const { return m_Spacing; }
+    std::vector<float>& GetValues() { return m_Values; }
+    const std::vector<float>& GetValues() const { return m_Values; }
+
+private:
+    int m_SizeX = 0;
+    int m_SizeY = 0;
+    int m_SizeZ = 0;
+    Vec3f m_Origin;
+    float m_Spacing = 1.0f;
+    std::vector<float> m_Values;
+};
+
+// Unbounded lattice stored as 8^3 bricks of samples. Unallocated bricks read
+// a constant: a tile value where one is set (e.g. the inside of a distance
+// field), the background elsewhere. Suited to narrow bands around the
+// surfaces of signed distance fields, where a dense grid would be mostly
+// empty.
+class SparseScalarGrid {
+public:
+    static constexpr int BrickSize = 8;
+    static constexpr int BrickVolume = BrickSize * BrickSize * BrickSize;
+    static constexpr uint32_t NotFound = ~uint32_t(0);
+
+    explicit SparseScalarGrid(const Vec3f& origin = Vec3f(), float spacing = 1.0f, float background = 1.0f);
+    void Clear();
+
+    float Get(int x, int y, int z) const;
+    void Set(int x, int y, int z, float value); // Allocates the brick
+
+    // Samples field on the bricks overlapping [minBound, maxBound], keeping
+    // a brick only when |field| at its centre is within band plus its half
+    // diagonal (exact for distance fields, whose gradient is at most 1).
+    // Culled bricks on the other side of the surface from the background
+    // become tiles of -background, so the band has no false inner surface.
+    // Brick culling and sampling run in parallel. Returns bricks added.
+    size_t SampleNarrowBand(const ScalarField& field, const Vec3f& minBound, const Vec3f& maxBound, float band);
+
+    // Brick storage: brick b covers points BrickSize * coordinate + [0, BrickSize)
+    size_t GetBrickCount() const { return m_Bricks.size(); }
+    uint32_t FindBrick(int bx, int by, int bz) const;
+    uint32_t AddBrick(int bx, int by, int bz); // Existing index, or a new brick at the fill value
+    void GetBrickCoordinates(uint32_t brick, int& bx, int& by, int& bz) const;
+    // Constant read by the points of an unallocated brick
+    float GetFill(int bx, int by, int bz) const;
+    void SetTile(int bx, int by, int bz, float value);
+    size_t GetTileCount() const { return m_Tiles.size(); }
+    float* GetBrickValues(uint32_t brick) { return m_Values.data() + size_t(brick) * BrickVolume; }
+    const float* GetBrickValues(uint32_t brick) const { return m_Values.data() + size_t(brick) * BrickVolume; }
+
+    const Vec3f& GetOrigin() const { return m_Origin; }
+    float GetSpacing() const { return m_Spacing; }
+    float GetBackground() const { return m_Background; }
+
+    static uint64_t BrickKey(int bx, int by, int bz);
+
+private:
+    struct BrickCoordinates {
+        int32_t x, y, z;
+    };
+
+    Vec3f m_Origin;
+    float m_Spacing;
+    float m_Background;
+    std::vector<BrickCoordinates> m_Bricks;
+    std::vector<float> m_Values; // BrickVolume per brick, x-fastest
+    std::unordered_map<uint64_t, uint32_t> m_Lookup;
+    std::unordered_map<uint64_t, float> m_Tiles;
+};
+
+} // namespace alice2
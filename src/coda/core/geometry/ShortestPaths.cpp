@@ -0,0 +1,477 @@
+#include "ShortestPaths.h"
+#include "../utilities/Parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <iostream>
+
+namespace alice2 {
+
+namespace {
+
+constexpr size_t GrainSize = 4096;
+// Frontiers below this are relaxed on the calling thread
+constexpr size_t ParallelFrontier = 1024;
+// Delta-stepping bucket cap; farther distances share the last bucket, which
+// is then relaxed label-correcting until it settles
+constexpr size_t MaxBuckets = 1 << 16;
+constexpr float Infinity = std::numeric_limits<float>::infinity();
+
+uint32_t FloatBits(float value) { return std::bit_cast<uint32_t>(value); }
+
+uint64_t Pack(float distance, uint32_t predecessor) {
+    return (uint64_t(FloatBits(distance)) << 32) | predecessor;
+}
+
+float PackedDistance(uint64_t packed) { return std::bit_cast<float>(uint32_t(packed >> 32)); }
+
+// Monotone priority queue over 32-bit keys (Ahuja et al. 1990). Bucket i
+// holds keys whose highest bit differing from the last popped key is i - 1,
+// so a pop only redistributes the lowest non-empty bucket.
+class RadixHeap {
+public:
+    bool Empty() const { return m_Size == 0; }
+
+    void Clear() {
+        for (std::vector<Entry>& bucket : m_Buckets) {
+            bucket.clear();
+        }
+        m_Size = 0;
+        m_Last = 0;
+    }
+
+    // key must not be below the last popped key
+    void Push(uint32_t key, uint32_t value) {
+        m_Buckets[BucketOf(key)].push_back({key, value});
+        ++m_Size;
+    }
+
+    uint32_t Pop(uint32_t& key) {
+        if (m_Buckets[0].empty()) {
+            size_t i = 1;
+            while (m_Buckets[i].empty()) {
+                ++i;
+            }
+            std::vector<Entry>& bucket = m_Buckets[i];
+            uint32_t last = bucket[0].key;
+            for (const Entry& entry : bucket) {
+                last = std::min(last, entry.key);
+            }
+            m_Last = last;
+            for (const Entry& entry : bucket) {
+                m_Buckets[BucketOf(entry.key)].push_back(entry);
+            }
+            bucket.clear();
+        }
+        Entry entry = m_Buckets[0].back();
+        m_Buckets[0].pop_back();
+        --m_Size;
+        key = entry.key;
+        return entry.value;
+    }
+
+private:
+    struct Entry {
+        uint32_t key;
+        uint32_t value;
+    };
+
+    std::vector<Entry> m_Buckets[33];
+    size_t m_Size = 0;
+    uint32_t m_Last = 0;
+
+    size_t BucketOf(uint32_t key) const { return key == m_Last ? 0 : 32 - std::countl_zero(key ^ m_Last); }
+};
+
+} // namespace
+
+struct ShortestPaths::Workspace {
+    RadixHeap heap;
+    std::vector<float> distances; // All infinity between searches
+    std::vector<uint32_t> reached;
+};
+
+ShortestPaths::ShortestPaths(const ShortestPathSettings& settings) : m_Settings(settings) {}
+
+ShortestPaths::~ShortestPaths() = default;
+
+void ShortestPaths::SetSettings(const ShortestPathSettings& settings) {
+    if (settings.weightAttribute != m_Settings.weightAttribute) {
+        m_Prepared = false;
+    }
+    m_Settings = settings;
+}
+
+bool ShortestPaths::Prepare(const Graph& graph) {
+    // Euclidean weights follow the positions; attribute weights only the topology
+    bool weighted = !m_Settings.weightAttribute.empty();
+    if (m_Prepared && m_Graph == &graph && m_TopologyVersion == graph.GetTopologyVersion() &&
+        (weighted || m_EditCursor == graph.GetEditCursor())) {
+        return true;
+    }
+    m_Prepared = false;
+
+    const std::vector<float>* weights = nullptr;
+    if (weighted) {
+        weights = graph.GetAttributes(GraphElement::Edge).Get<float>(m_Settings.weightAttribute);
+        if (!weights) {
+            std::cerr << "ShortestPaths: no float edge attribute '" << m_Settings.weightAttribute << "'" << std::endl;
+            return false;
+        }
+        for (float weight : *weights) {
+            if (!(weight >= 0.0f) || !std::isfinite(weight)) {
+                std::cerr << "ShortestPaths: edge weights must be finite and non-negative" << std::endl;
+                return false;
+            }
+        }
+    }
+
+    const uint32_t vertexCount = uint32_t(graph.GetVertexCount());
+    m_Offsets.resize(size_t(vertexCount) + 1);
+    m_Offsets[0] = 0;
+    for (uint32_t v = 0; v < vertexCount; ++v) {
+        m_Offsets[v + 1] = m_Offsets[v] + graph.GetDegree(v);
+    }
+    m_Arcs.resize(m_Offsets[vertexCount]);
+
+    const std::vector<Vec3f>& positions = graph.GetPositions();
+    const std::vector<uint32_t>& neighbors = graph.GetNeighbors();
+    const std::vector<uint32_t>& slotEdges = graph.GetSlotEdges();
+    const std::vector<uint32_t>& pendingNeighbors = graph.GetPendingNeighbors();
+    const std::vector<uint32_t>& pendingEdges = graph.GetPendingEdges();
+    const std::vector<uint32_t>& pendingNext = graph.GetPendingNext();
+    parallel::For(vertexCount, GrainSize, [&](size_t begin, size_t end) {
+        for (size_t v = begin; v < end; ++v) {
+            Graph::Adjacency adjacency = graph.GetAdjacency(uint32_t(v));
+            Arc* arc = m_Arcs.data() + m_Offsets[v];
+            auto add = [&](uint32_t neighbor, uint32_t edge) {
+                float weight = weights ? (*weights)[edge] : (positions[neighbor] - positions[v]).Length();
+                // -0 would break the monotone float-bit keys
+                *arc++ = {neighbor, weight > 0.0f ? weight : 0.0f};
+            };
+            for (uint32_t slot = adjacency.begin; slot < adjacency.end; ++slot) {
+                add(neighbors[slot], slotEdges[slot]);
+            }
+            for (uint32_t slot = adjacency.pendingHead, i = 0; i < adjacency.pendingCount; ++i) {
+                add(pendingNeighbors[slot], pendingEdges[slot]);
+                slot = pendingNext[slot];
+            }
+        }
+    });
+
+    double total = 0.0;
+    for (const Arc& arc : m_Arcs) {
+        total += arc.weight;
+    }
+    m_MeanWeight = m_Arcs.empty() ? 0.0f : float(total / double(m_Arcs.size()));
+
+    m_Graph = &graph;
+    m_TopologyVersion = graph.GetTopologyVersion();
+    m_EditCursor = graph.GetEditCursor();
+    m_Prepared = true;
+    return true;
+}
+
+bool ShortestPaths::Begin(const Graph& graph, const uint32_t* sources, size_t sourceCount) {
+    if (!Prepare(graph)) {
+        return false;
+    }
+    for (size_t i = 0; i < sourceCount; ++i) {
+        if (sources[i] >= graph.GetVertexCount()) {
+            std::cerr << "ShortestPaths: vertex " << sources[i] << " out of range" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ShortestPaths::Compute(const Graph& graph, uint32_t source, std::vector<float>& distances,
+                            std::vector<uint32_t>* predecessors) {
+    if (!Begin(graph, &source, 1)) {
+        return false;
+    }
+    Solve(&source, 1, distances, predecessors);
+    return true;
+}
+
+bool ShortestPaths::Compute(const Graph& graph, const std::vector<uint32_t>& sources, std::vector<float>& distances,
+                            std::vector<uint32_t>* predecessors) {
+    if (!Begin(graph, sources.data(), sources.size())) {
+        return false;
+    }
+    Solve(sources.data(), sources.size(), distances, predecessors);
+    return true;
+}
+
+void ShortestPaths::Solve(const uint32_t* sources, size_t sourceCount, std::vector<float>& distances,
+                          std::vector<uint32_t>* predecessors) {
+    const size_t vertexCount = m_Offsets.size() - 1;
+    bool deltaStepping = m_Settings.method == ShortestPathMethod::DeltaStepping ||
+                         (m_Settings.method == ShortestPathMethod::Auto && parallel::ThreadCount() > 1 &&
+                          vertexCount >= m_Settings.parallelThreshold);
+    if (deltaStepping) {
+        RunDeltaStepping(sources, sourceCount, distances, predecessors);
+        return;
+    }
+
+    distances.assign(vertexCount, Infinity);
+    if (predecessors) {
+        predecessors->assign(vertexCount, INVALID_INDEX);
+    }
+    Workspace* workspace = AcquireWorkspace();
+    RunDijkstra(*workspace, sources, sourceCount, distances.data(), predecessors ? predecessors->data() : nullptr, 0);
+    workspace->reached.clear();
+    ReleaseWorkspace(workspace);
+}
+
+bool ShortestPaths::ComputeBatch(const Graph& graph, const std::vector<uint32_t>& origins,
+                                 const std::vector<uint32_t>& targets, std::vector<float>& distances) {
+    if (!Begin(graph, origins.data(), origins.size()) || !Begin(graph, targets.data(), targets.size())) {
+        return false;
+    }
+    const size_t vertexCount = m_Offsets.size() - 1;
+    const size_t columns = targets.empty() ? vertexCount : targets.size();
+    distances.resize(origins.size() * columns);
+
+    size_t targetCount = 0;
+    if (!targets.empty()) {
+        m_TargetMarks.assign(vertexCount, 0);
+        for (uint32_t target : targets) {
+            targetCount += m_TargetMarks[target] == 0;
+            m_TargetMarks[target] = 1;
+        }
+    }
+
+    const size_t chunkCount = parallel::ChunkCount(origins.size(), 1);
+    parallel::ForChunks(chunkCount, [&](size_t chunk) {
+        size_t begin = origins.size() * chunk / chunkCount;
+        size_t end = origins.size() * (chunk + 1) / chunkCount;
+        Workspace* workspace = AcquireWorkspace();
+        for (size_t i = begin; i < end; ++i) {
+            float* row = distances.data() + i * columns;
+            if (targets.empty()) {
+                std::fill(row, row + columns, Infinity);
+                RunDijkstra(*workspace, &origins[i], 1, row, nullptr, 0);
+                workspace->reached.clear();
+                continue;
+            }
+            // Search in the workspace, gather the targets and reset only
+            // what the search reached
+            if (workspace->distances.size() != vertexCount) {
+                workspace->distances.assign(vertexCount, Infinity);
+            }
+            RunDijkstra(*workspace, &origins[i], 1, workspace->distances.data(), nullptr, targetCount);
+            for (size_t j = 0; j < columns; ++j) {
+                row[j] = workspace->distances[targets[j]];
+            }
+            for (uint32_t v : workspace->reached) {
+                workspace->distances[v] = Infinity;
+            }
+            workspace->reached.clear();
+        }
+        ReleaseWorkspace(workspace);
+    });
+    return true;
+}
+
+bool ShortestPaths::GetPath(const std::vector<float>& distances, const std::vector<uint32_t>& predecessors,
+                            uint32_t target, std::vector<uint32_t>& path) {
+    path.clear();
+    if (target >= distances.size() || target >= predecessors.size() || !std::isfinite(distances[target])) {
+        return false;
+    }
+    for (uint32_t v = target; v != INVALID_INDEX; v = predecessors[v]) {
+        if (path.size() > predecessors.size()) {
+            path.clear();
+            return false;
+        }
+        path.push_back(v);
+    }
+    std::reverse(path.begin(), path.end());
+    return true;
+}
+
+ShortestPaths::Workspace* ShortestPaths::AcquireWorkspace() {
+    std::lock_guard<std::mutex> lock(m_WorkspaceMutex);
+    if (m_FreeWorkspaces.empty()) {
+        m_Workspaces.push_back(std::make_unique<Workspace>());
+        return m_Workspaces.back().get();
+    }
+    Workspace* workspace = m_FreeWorkspaces.back();
+    m_FreeWorkspaces.pop_back();
+    return workspace;
+}
+
+void ShortestPaths::ReleaseWorkspace(Workspace* workspace) {
+    std::lock_guard<std::mutex> lock(m_WorkspaceMutex);
+    m_FreeWorkspaces.push_back(workspace);
+}
+
+void ShortestPaths::RunDijkstra(Workspace& workspace, const uint32_t* sources, size_t sourceCount, float* distances,
+                                uint32_t* predecessors, size_t targetCount) {
+    const uint32_t* offsets = m_Offsets.data();
+    const Arc* arcs = m_Arcs.data();
+    const float maxDistance = m_Settings.maxDistance;
+    RadixHeap& heap = workspace.heap;
+    std::vector<uint32_t>& reached = workspace.reached;
+
+    heap.Clear();
+    for (size_t i = 0; i < sourceCount; ++i) {
+        uint32_t source = sources[i];
+        if (distances[source] != 0.0f) {
+            distances[source] = 0.0f;
+            reached.push_back(source);
+            heap.Push(0, source);
+        }
+    }
+
+    size_t remaining = targetCount;
+    while (!heap.Empty()) {
+        uint32_t key;
+        uint32_t u = heap.Pop(key);
+        float distance = std::bit_cast<float>(key);
+        if (distance > distances[u]) {
+            continue; // Superseded by a shorter entry
+        }
+        if (remaining > 0 && m_TargetMarks[u] && --remaining == 0) {
+            break;
+        }
+        for (uint32_t a = offsets[u]; a < offsets[u + 1]; ++a) {
+            uint32_t v = arcs[a].target;
+            float candidate = distance + arcs[a].weight;
+            if (candidate < distances[v] && candidate <= maxDistance) {
+                if (distances[v] == Infinity) {
+                    reached.push_back(v);
+                }
+                distances[v] = candidate;
+                if (predecessors) {
+                    predecessors[v] = u;
+                }
+                heap.Push(FloatBits(candidate), v);
+            }
+        }
+    }
+}
+
+void ShortestPaths::RunDeltaStepping(const uint32_t* sources, size_t sourceCount, std::vector<float>& distances,
+                                     std::vector<uint32_t>* predecessors) {
+    const size_t vertexCount = m_Offsets.size() - 1;
+    const uint32_t* offsets = m_Offsets.data();
+    const Arc* arcs = m_Arcs.data();
+    const float maxDistance = m_Settings.maxDistance;
+    float delta = m_Settings.delta > 0.0f ? m_Settings.delta : 2.0f * m_MeanWeight;
+    if (!(delta > 0.0f)) {
+        delta = 1.0f;
+    }
+    const float inverseDelta = 1.0f / delta;
+    auto bucketOf = [&](float distance) {
+        return size_t(std::min(distance * inverseDelta, float(MaxBuckets - 1)));
+    };
+
+    m_Packed.resize(vertexCount);
+    const uint64_t unreached = Pack(Infinity, INVALID_INDEX);
+    parallel::For(vertexCount, GrainSize, [&](size_t begin, size_t end) {
+        std::fill(m_Packed.begin() + begin, m_Packed.begin() + end, unreached);
+    });
+    m_Frontier.clear();
+    for (size_t i = 0; i < sourceCount; ++i) {
+        if (m_Packed[sources[i]] != Pack(0.0f, INVALID_INDEX)) {
+            m_Packed[sources[i]] = Pack(0.0f, INVALID_INDEX);
+            m_Frontier.push_back(sources[i]);
+        }
+    }
+
+    // Buckets are per chunk so that relaxation appends without locks; the
+    // chunk count is fixed for the whole search
+    const size_t chunkCount = parallel::ThreadCount() * 4;
+    m_Buckets.resize(chunkCount);
+    for (std::vector<std::vector<uint32_t>>& buckets : m_Buckets) {
+        for (std::vector<uint32_t>& bucket : buckets) {
+            bucket.clear();
+        }
+    }
+
+    size_t current = 0;
+    auto relax = [&](size_t chunk, size_t begin, size_t end) {
+        std::vector<std::vector<uint32_t>>& buckets = m_Buckets[chunk];
+        for (size_t i = begin; i < end; ++i) {
+            uint32_t u = m_Frontier[i];
+            float distance = PackedDistance(std::atomic_ref<uint64_t>(m_Packed[u]).load(std::memory_order_relaxed));
+            // Improved into an earlier bucket since it was queued, and
+            // relaxed there already
+            if (bucketOf(distance) < current) {
+                continue;
+            }
+            for (uint32_t a = offsets[u]; a < offsets[u + 1]; ++a) {
+                uint32_t v = arcs[a].target;
+                float candidate = distance + arcs[a].weight;
+                if (candidate > maxDistance) {
+                    continue;
+                }
+                std::atomic_ref<uint64_t> packed(m_Packed[v]);
+                uint64_t previous = packed.load(std::memory_order_relaxed);
+                while (candidate < PackedDistance(previous)) {
+                    if (packed.compare_exchange_weak(previous, Pack(candidate, u), std::memory_order_relaxed)) {
+                        size_t bucket = bucketOf(candidate);
+                        if (buckets.size() <= bucket) {
+                            buckets.resize(bucket + 1);
+                        }
+                        buckets[bucket].push_back(v);
+                        break;
+                    }
+                }
+            }
+        }
+    };
+
+    while (!m_Frontier.empty()) {
+        const size_t frontierSize = m_Frontier.size();
+        if (frontierSize < ParallelFrontier) {
+            relax(0, 0, frontierSize);
+        } else {
+            parallel::ForChunks(chunkCount, [&](size_t chunk) {
+                relax(chunk, frontierSize * chunk / chunkCount, frontierSize * (chunk + 1) / chunkCount);
+            });
+        }
+
+        // Lowest non-empty bucket; relaxation never lands below the current one,
+        // so the current bucket repeats until it stops refilling
+        size_t next = MaxBuckets;
+        for (const std::vector<std::vector<uint32_t>>& buckets : m_Buckets) {
+            for (size_t b = current; b < std::min(buckets.size(), next); ++b) {
+                if (!buckets[b].empty()) {
+                    next = b;
+                    break;
+                }
+            }
+        }
+        m_Frontier.clear();
+        if (next == MaxBuckets) {
+            break;
+        }
+        current = next;
+        for (std::vector<std::vector<uint32_t>>& buckets : m_Buckets) {
+            if (current < buckets.size()) {
+                m_Frontier.insert(m_Frontier.end(), buckets[current].begin(), buckets[current].end());
+                buckets[current].clear();
+            }
+        }
+    }
+
+    distances.resize(vertexCount);
+    if (predecessors) {
+        predecessors->resize(vertexCount);
+    }
+    parallel::For(vertexCount, GrainSize, [&](size_t begin, size_t end) {
+        for (size_t v = begin; v < end; ++v) {
+            distances[v] = PackedDistance(m_Packed[v]);
+            if (predecessors) {
+                (*predecessors)[v] = uint32_t(m_Packed[v]);
+            }
+        }
+    });
+}
+
+} // namespace alice2
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "Graph.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace alice2 {
+
+enum class ShortestPathMethod {
+    Auto,         // Delta-stepping on large graphs when threads are available
+    Dijkstra,
+    DeltaStepping
+};
+
+struct ShortestPathSettings {
+    std::string weightAttribute; // Float edge layer; empty uses Euclidean edge lengths
+    float maxDistance = std::numeric_limits<float>::infinity(); // Farther vertices stay unreached
+    ShortestPathMethod method = ShortestPathMethod::Auto;
+    float delta = 0.0f;                 // Delta-stepping bucket width; 0 picks 2x the mean weight
+    size_t parallelThreshold = 1 << 17; // Auto: vertex count from which delta-stepping is used
+};
+
+// Single- and multi-source shortest paths over a Graph with non-negative
+// edge weights (out-edges when directed).
+//
+// Prepare() flattens the adjacency, pending slots included, into a private
+// weighted CSR that is reused until the graph's topology or positions change.
+// Sequential queries run Dijkstra on a radix heap keyed by the float bits of
+// the distance, which are monotone for non-negative values. Large single
+// queries use delta-stepping (Meyer & Sanders 2003): the frontier of the
+// current distance bucket is relaxed in parallel with a compare-and-swap
+// minimum on packed (distance, predecessor) words. Batches run one Dijkstra
+// per origin across the thread pool, each on a pooled workspace.
+//
+// Results go into caller-owned buffers, and the scratch state lives in the
+// object, so repeated queries of the same size do not allocate.
+class ShortestPaths {
+public:
+    explicit ShortestPaths(const ShortestPathSettings& settings = ShortestPathSettings());
+    ~ShortestPaths();
+
+    void SetSettings(const ShortestPathSettings& settings);
+    const ShortestPathSettings& GetSettings() const { return m_Settings; }
+
+    // Builds or refreshes the weighted adjacency; queries call it. After
+    // editing the weight attribute in place, Invalidate() first.
+    bool Prepare(const Graph& graph);
+    void Invalidate() { m_Prepared = false; }
+
+    // Distance of every vertex from the nearest source, infinity where
+    // unreached. Predecessors (optional) hold the previous vertex on a
+    // shortest path, INVALID_INDEX at sources and unreached vertices.
+    bool Compute(const Graph& graph, uint32_t source, std::vector<float>& distances,
+                 std::vector<uint32_t>* predecessors = nullptr);
+    bool Compute(const Graph& graph, const std::vector<uint32_t>& sources, std::vector<float>& distances,
+                 std::vector<uint32_t>* predecessors = nullptr);
+
+    // Origin-destination matrix, row-major with one row per origin. Empty
+    // targets means every vertex. With targets, each search stops once all
+    // of them are settled.
+    bool ComputeBatch(const Graph& graph, const std::vector<uint32_t>& origins, const std::vector<uint32_t>& targets,
+                      std::vector<float>& distances);
+
+    // Vertices from the source to target along the predecessors of a
+    // Compute(); false when the target was not reached
+    static bool GetPath(const std::vector<float>& distances, const std::vector<uint32_t>& predecessors,
+                        uint32_t target, std::vector<uint32_t>& path);
+
+    // Weighted adjacency: arcs of vertex v are [offsets[v], offsets[v + 1])
+    struct Arc {
+        uint32_t target;
+        float weight;
+    };
+    const std::vector<uint32_t>& GetOffsets() const { return m_Offsets; }
+    const std::vector<Arc>& GetArcs() const { return m_Arcs; }
+
+private:
+    struct Workspace;
+
+    ShortestPathSettings m_Settings;
+
+    const Graph* m_Graph = nullptr;
+    uint64_t m_TopologyVersion = 0;
+    uint64_t m_EditCursor = 0;
+    bool m_Prepared = false;
+
+    std::vector<uint32_t> m_Offsets;
+    std::vector<Arc> m_Arcs;
+    float m_MeanWeight = 0.0f;
+
+    // Delta-stepping state: packed (distance bits << 32 | predecessor) per
+    // vertex, the current frontier and per-chunk buckets of later ones
+    std::vector<uint64_t> m_Packed;
+    std::vector<uint32_t> m_Frontier;
+    std::vector<std::vector<std::vector<uint32_t>>> m_Buckets;
+
+    // Dijkstra workspaces, one per concurrently running search
+    std::vector<std::unique_ptr<Workspace>> m_Workspaces;
+    std::vector<Workspace*> m_FreeWorkspaces;
+    std::mutex m_WorkspaceMutex;
+    std::vector<uint8_t> m_TargetMarks; // Per vertex, 1 when it is a batch target
+
+    bool Begin(const Graph& graph, const uint32_t* sources, size_t sourceCount);
+    void Solve(const uint32_t* sources, size_t sourceCount, std::vector<float>& distances,
+               std::vector<uint32_t>* predecessors);
+    Workspace* AcquireWorkspace();
+    void ReleaseWorkspace(Workspace* workspace);
+    void RunDijkstra(Workspace& workspace, const uint32_t* sources, size_t sourceCount, float* distances,
+                     uint32_t* predecessors, size_t targetCount);
+    void RunDeltaStepping(const uint32_t* sources, size_t sourceCount, std::vector<float>& distances,
+                          std::vector<uint32_t>* predecessors);
+};
+
+} // namespace alice2
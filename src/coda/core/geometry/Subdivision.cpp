@@ -0,0 +1,536 @@
+#include "Subdivision.h"
+#include "../utilities/Parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace alice2 {
+
+namespace {
+
+constexpr size_t GrainSize = 1024;
+
+// Sparse rows in CSR form; used for both the per-level rules (refined
+// vertex -> previous level) and the composed stencils (-> cage)
+struct SparseRows {
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> indices;
+    std::vector<float> weights;
+};
+
+struct NoScratch {};
+
+// Composed rows are accumulated densely, one accumulator per chunk
+struct Accumulator {
+    std::vector<float> values;
+    std::vector<uint32_t> marks;
+    std::vector<uint32_t> touched;
+};
+
+// Runs row(r, scratch, indices, weights) for every row in parallel chunks,
+// each appending to chunk-local buffers, then concatenates them in order.
+// Scratch is default-constructed once per chunk.
+template <typename Scratch, typename RowFn>
+void BuildRows(size_t rowCount, SparseRows& rows, RowFn&& row) {
+    rows.offsets.assign(rowCount + 1, 0);
+    rows.indices.clear();
+    rows.weights.clear();
+    size_t chunkCount = parallel::ChunkCount(rowCount, GrainSize);
+    if (chunkCount == 0) {
+        return;
+    }
+    size_t chunkSize = (rowCount + chunkCount - 1) / chunkCount;
+
+    std::vector<std::vector<uint32_t>> chunkIndices(chunkCount);
+    std::vector<std::vector<float>> chunkWeights(chunkCount);
+    parallel::ForChunks(chunkCount, [&](size_t chunk) {
+        Scratch scratch;
+        std::vector<uint32_t>& indices = chunkIndices[chunk];
+        std::vector<float>& weights = chunkWeights[chunk];
+        size_t end = std::min(rowCount, (chunk + 1) * chunkSize);
+        for (size_t r = chunk * chunkSize; r < end; ++r) {
+            size_t before = indices.size();
+            row(static_cast<uint32_t>(r), scratch, indices, weights);
+            rows.offsets[r + 1] = static_cast<uint32_t>(indices.size() - before);
+        }
+    });
+    for (size_t r = 0; r < rowCount; ++r) {
+        rows.offsets[r + 1] += rows.offsets[r];
+    }
+
+    rows.indices.resize(rows.offsets[rowCount]);
+    rows.weights.resize(rows.offsets[rowCount]);
+    parallel::ForChunks(chunkCount, [&](size_t chunk) {
+        size_t first = std::min(rowCount, chunk * chunkSize);
+        std::copy(chunkIndices[chunk].begin(), chunkIndices[chunk].end(), rows.indices.begin() + rows.offsets[first]);
+        std::copy(chunkWeights[chunk].begin(), chunkWeights[chunk].end(), rows.weights.begin() + rows.offsets[first]);
+    });
+}
+
+inline void Add(std::vector<uint32_t>& indices, std::vector<float>& weights, uint32_t index, float weight) {
+    indices.push_back(index);
+    weights.push_back(weight);
+}
+
+inline bool IsInfinite(float sharpness) { return sharpness >= SubdivisionStencils::InfiniteSharpness; }
+
+float EdgeSharpness(const Mesh& mesh, const std::vector<float>& sharpness, uint32_t edge) {
+    return mesh.IsBoundaryEdge(edge) ? SubdivisionStencils::InfiniteSharpness : sharpness[edge];
+}
+
+// Sharp edges around a vertex decide its rule: fewer than two is smooth,
+// two is a crease, more is a corner. Semi-sharp vertices blend towards the
+// smooth rule by their mean edge sharpness.
+struct VertexCreases {
+    uint32_t valence = 0;
+    uint32_t faces = 0;
+    uint32_t count = 0;
+    uint32_t ends[2] = {0, 0};
+    float sharpness = 0.0f;
+    bool boundary = false;
+};
+
+VertexCreases ClassifyVertex(const Mesh& mesh, const std::vector<float>& sharpness, uint32_t v) {
+    VertexCreases creases;
+    uint32_t start = mesh.VertexHalfEdge(v);
+    uint32_t h = start;
+    float sum = 0.0f;
+    do {
+        ++creases.valence;
+        if (mesh.Face(h) != INVALID_INDEX) {
+            ++creases.faces;
+        } else {
+            creases.boundary = true;
+        }
+        float s = EdgeSharpness(mesh, sharpness, mesh.Edge(h));
+        if (s > 0.0f) {
+            if (creases.count < 2) {
+                creases.ends[creases.count] = mesh.Target(h);
+            }
+            ++creases.count;
+            sum += std::min(s, SubdivisionStencils::InfiniteSharpness);
+        }
+        h = mesh.Twin(mesh.Prev(h));
+    } while (h != start);
+    creases.sharpness = creases.count > 0 ? sum / creases.count : 0.0f;
+    return creases;
+}
+
+// Shared by both schemes: crease, corner and the blend towards smooth
+template <typename SmoothFn>
+void VertexRow(const Mesh& mesh, const std::vector<float>& sharpness, uint32_t v,
+               std::vector<uint32_t>& indices, std::vector<float>& weights, SmoothFn&& smooth) {
+    if (mesh.IsIsolatedVertex(v)) {
+        Add(indices, weights, v, 1.0f);
+        return;
+    }
+    VertexCreases creases = ClassifyVertex(mesh, sharpness, v);
+    if (creases.count < 2) {
+        smooth(1.0f);
+        return;
+    }
+    float blend = creases.boundary ? 1.0f : std::min(creases.sharpness, 1.0f);
+    if (creases.count > 2 || (creases.boundary && creases.faces == 1)) {
+        Add(indices, weights, v, blend);
+    } else {
+        Add(indices, weights, v, 0.75f * blend);
+        Add(indices, weights, creases.ends[0], 0.125f * blend);
+        Add(indices, weights, creases.ends[1], 0.125f * blend);
+    }
+    if (blend < 1.0f) {
+        smooth(1.0f - blend);
+    }
+}
+
+void AddFacePoint(const Mesh& mesh, uint32_t face, float scale, std::vector<uint32_t>& indices,
+                  std::vector<float>& weights) {
+    uint32_t start = mesh.FaceHalfEdge(face);
+    uint32_t corners = 0;
+    uint32_t h = start;
+    do {
+        ++corners;
+        h = mesh.Next(h);
+    } while (h != start);
+    float weight = scale / corners;
+    do {
+        Add(indices, weights, mesh.Source(h), weight);
+        h = mesh.Next(h);
+    } while (h != start);
+}
+
+// Catmull-Clark: vertex points [0, V), edge points [V, V + E), face points
+// [V + E, V + E + F)
+void CatmullClarkRow(const Mesh& mesh, const std::vector<float>& sharpness, uint32_t row,
+                     std::vector<uint32_t>& indices, std::vector<float>& weights) {
+    uint32_t vertexCount = static_cast<uint32_t>(mesh.GetVertexCount());
+    uint32_t edgeCount = static_cast<uint32_t>(mesh.GetEdgeCount());
+
+    if (row >= vertexCount + edgeCount) {
+        AddFacePoint(mesh, row - vertexCount - edgeCount, 1.0f, indices, weights);
+        return;
+    }
+
+    if (row >= vertexCount) {
+        uint32_t edge = row - vertexCount;
+        uint32_t h = mesh.EdgeHalfEdge(edge);
+        float s = EdgeSharpness(mesh, sharpness, edge);
+        float sharp = std::min(s, 1.0f);
+        float smooth = 1.0f - sharp;
+        Add(indices, weights, mesh.Source(h), 0.5f * sharp + 0.25f * smooth);
+        Add(indices, weights, mesh.Target(h), 0.5f * sharp + 0.25f * smooth);
+        if (smooth > 0.0f) {
+            AddFacePoint(mesh, mesh.Face(h), 0.25f * smooth, indices, weights);
+            AddFacePoint(mesh, mesh.Face(mesh.Twin(h)), 0.25f * smooth, indices, weights);
+        }
+        return;
+    }
+
+    // Smooth vertex: ((n - 2) S + (1 / n) sum(edge ends) + (1 / n) sum(face points)) / n
+    uint32_t v = row;
+    VertexRow(mesh, sharpness, v, indices, weights, [&](float scale) {
+        uint32_t n = 0;
+        uint32_t start = mesh.VertexHalfEdge(v);
+        uint32_t h = start;
+        do {
+            ++n;
+            h = mesh.Twin(mesh.Prev(h));
+        } while (h != start);
+        float ring = scale / (static_cast<float>(n) * n);
+        Add(indices, weights, v, scale * (n - 2.0f) / n);
+        do {
+            Add(indices, weights, mesh.Target(h), ring);
+            AddFacePoint(mesh, mesh.Face(h), ring, indices, weights);
+            h = mesh.Twin(mesh.Prev(h));
+        } while (h != start);
+    });
+}
+
+// Loop: vertex points [0, V), edge points [V, V + E)
+void LoopRow(const Mesh& mesh, const std::vector<float>& sharpness, uint32_t row,
+             std::vector<uint32_t>& indices, std::vector<float>& weights) {
+    uint32_t vertexCount = static_cast<uint32_t>(mesh.GetVertexCount());
+
+    if (row >= vertexCount) {
+        uint32_t edge = row - vertexCount;
+        uint32_t h = mesh.EdgeHalfEdge(edge);
+        float s = EdgeSharpness(mesh, sharpness, edge);
+        float sharp = std::min(s, 1.0f);
+        float smooth = 1.0f - sharp;
+        Add(indices, weights, mesh.Source(h), 0.5f * sharp + 0.375f * smooth);
+        Add(indices, weights, mesh.Target(h), 0.5f * sharp + 0.375f * smooth);
+        if (smooth > 0.0f) {
+            Add(indices, weights, mesh.Target(mesh.Next(h)), 0.125f * smooth);
+            Add(indices, weights, mesh.Target(mesh.Next(mesh.Twin(h))), 0.125f * smooth);
+        }
+        return;
+    }
+
+    uint32_t v = row;
+    VertexRow(mesh, sharpness, v, indices, weights, [&](float scale) {
+        uint32_t n = 0;
+        uint32_t start = mesh.VertexHalfEdge(v);
+        uint32_t h = start;
+        do {
+            ++n;
+            h = mesh.Twin(mesh.Prev(h));
+        } while (h != start);
+        float c = 0.375f + 0.25f * std::cos(6.28318531f / n);
+        float beta = (0.625f - c * c) / n;
+        Add(indices, weights, v, scale * (1.0f - n * beta));
+        do {
+            Add(indices, weights, mesh.Target(h), scale * beta);
+            h = mesh.Twin(mesh.Prev(h));
+        } while (h != start);
+    });
+}
+
+// One refinement step: rules for every new vertex, the refined topology and
+// the sharpness carried onto the child edges
+bool RefineLevel(const Mesh& mesh, const std::vector<float>& sharpness, SubdivisionScheme scheme,
+                 SparseRows& rules, Mesh& refined, std::vector<float>& refinedSharpness) {
+    uint32_t vertexCount = static_cast<uint32_t>(mesh.GetVertexCount());
+    uint32_t edgeCount = static_cast<uint32_t>(mesh.GetEdgeCount());
+    uint32_t facePoints = vertexCount + edgeCount;
+    bool catmullClark = scheme == SubdivisionScheme::CatmullClark;
+
+    size_t rowCount = vertexCount + edgeCount + (catmullClark ? mesh.GetFaceCount() : 0);
+    BuildRows<NoScratch>(rowCount, rules, [&](uint32_t row, NoScratch&, std::vector<uint32_t>& indices,
+                                             std::vector<float>& weights) {
+        if (catmullClark) {
+            CatmullClarkRow(mesh, sharpness, row, indices, weights);
+        } else {
+            LoopRow(mesh, sharpness, row, indices, weights);
+        }
+    });
+
+    std::vector<Vec3f> positions(rowCount);
+    const std::vector<Vec3f>& source = mesh.GetPositions();
+    parallel::For(rowCount, GrainSize, [&](size_t begin, size_t end) {
+        for (size_t r = begin; r < end; ++r) {
+            Vec3f p;
+            for (uint32_t k = rules.offsets[r]; k < rules.offsets[r + 1]; ++k) {
+                p += source[rules.indices[k]] * rules.weights[k];
+            }
+            positions[r] = p;
+        }
+    });
+
+    std::vector<uint32_t> faceCounts;
+    std::vector<uint32_t> faceIndices;
+    for (uint32_t f = 0; f < mesh.GetFaceCount(); ++f) {
+        uint32_t start = mesh.FaceHalfEdge(f);
+        if (catmullClark) {
+            uint32_t h = start;
+            do {
+                faceCounts.push_back(4);
+                faceIndices.push_back(mesh.Source(h));
+                faceIndices.push_back(vertexCount + mesh.Edge(h));
+                faceIndices.push_back(facePoints + f);
+                faceIndices.push_back(vertexCount + mesh.Edge(mesh.Prev(h)));
+                h = mesh.Next(h);
+            } while (h != start);
+        } else {
+            uint32_t h0 = start, h1 = mesh.Next(h0), h2 = mesh.Next(h1);
+            uint32_t e0 = vertexCount + mesh.Edge(h0);
+            uint32_t e1 = vertexCount + mesh.Edge(h1);
+            uint32_t e2 = vertexCount + mesh.Edge(h2);
+            uint32_t corners[12] = {mesh.Source(h0), e0, e2, mesh.Source(h1), e1, e0,
+                                    mesh.Source(h2), e2, e1, e0, e1, e2};
+            faceCounts.insert(faceCounts.end(), 4, 3);
+            faceIndices.insert(faceIndices.end(), corners, corners + 12);
+        }
+    }
+    if (!refined.Create(positions, faceCounts, faceIndices)) {
+        return false;
+    }
+
+    // Both halves of a sharp edge are one level less sharp
+    refinedSharpness.assign(refined.GetEdgeCount(), 0.0f);
+    parallel::For(edgeCount, GrainSize, [&](size_t begin, size_t end) {
+        for (size_t e = begin; e < end; ++e) {
+            float s = sharpness[e];
+            if (s <= 0.0f) {
+                continue;
+            }
+            float child = IsInfinite(s) ? s : std::max(s - 1.0f, 0.0f);
+            uint32_t start = refined.VertexHalfEdge(vertexCount + static_cast<uint32_t>(e));
+            uint32_t h = start;
+            do {
+                if (refined.Target(h) < vertexCount) {
+                    refinedSharpness[refined.Edge(h)] = child;
+                }
+                h = refined.Twin(refined.Prev(h));
+            } while (h != start);
+        }
+    });
+    return true;
+}
+
+} // namespace
+
+bool SubdivisionStencils::Build(const Mesh& cage, SubdivisionScheme scheme, int levels,
+                                const std::vector<float>& creases) {
+    Clear();
+    if (levels < 1 || levels > MaxLevel) {
+        std::cerr << "SubdivisionStencils: levels must be between 1 and " << MaxLevel << std::endl;
+        return false;
+    }
+    if (cage.GetFaceCount() == 0) {
+        std::cerr << "SubdivisionStencils: cage has no faces" << std::endl;
+        return false;
+    }
+
+    std::vector<float> sharpness;
+    const std::vector<float>* creaseAttribute = cage.GetAttributes(MeshElement::Edge).Get<float>("crease");
+    if (!creases.empty()) {
+        sharpness = creases;
+    } else if (creaseAttribute) {
+        sharpness = *creaseAttribute;
+    }
+    if (sharpness.empty()) {
+        sharpness.assign(cage.GetEdgeCount(), 0.0f);
+    } else if (sharpness.size() != cage.GetEdgeCount()) {
+        std::cerr << "SubdivisionStencils: crease array does not match the edge count" << std::endl;
+        return false;
+    }
+
+    if (scheme == SubdivisionScheme::Loop) {
+        const auto& next = cage.GetHalfEdgeNext();
+        for (uint32_t f = 0; f < cage.GetFaceCount(); ++f) {
+            uint32_t h = cage.FaceHalfEdge(f);
+            if (next[next[next[h]]] != h) {
+                std::cerr << "SubdivisionStencils: Loop subdivision needs a triangle mesh (face " << f << ")"
+                          << std::endl;
+                return false;
+            }
+        }
+    }
+
+    // Level 0 stencils are the identity
+    uint32_t cageCount = static_cast<uint32_t>(cage.GetVertexCount());
+    SparseRows stencils;
+    stencils.offsets.resize(cageCount + 1);
+    stencils.indices.resize(cageCount);
+    stencils.weights.assign(cageCount, 1.0f);
+    for (uint32_t v = 0; v <= cageCount; ++v) {
+        stencils.offsets[v] = v;
+        if (v < cageCount) {
+            stencils.indices[v] = v;
+        }
+    }
+
+    Mesh levelMesh;
+    const Mesh* current = &cage;
+    SparseRows rules;
+    SparseRows composed;
+    std::vector<float> refinedSharpness;
+    for (int level = 0; level < levels; ++level) {
+        if (!RefineLevel(*current, sharpness, scheme, rules, m_Refined, refinedSharpness)) {
+            std::cerr << "SubdivisionStencils: refinement failed at level " << level + 1 << std::endl;
+            Clear();
+            return false;
+        }
+        sharpness.swap(refinedSharpness);
+
+        // Compose: new row = sum of rule weight * previous stencil row
+        size_t rowCount = rules.offsets.size() - 1;
+        BuildRows<Accumulator>(rowCount, composed, [&](uint32_t row, Accumulator& acc,
+                                                       std::vector<uint32_t>& indices, std::vector<float>& weights) {
+            if (acc.values.empty()) {
+                acc.values.assign(cageCount, 0.0f);
+                acc.marks.assign(cageCount, 0);
+            }
+            acc.touched.clear();
+            for (uint32_t k = rules.offsets[row]; k < rules.offsets[row + 1]; ++k) {
+                uint32_t previous = rules.indices[k];
+                float w = rules.weights[k];
+                for (uint32_t j = stencils.offsets[previous]; j < stencils.offsets[previous + 1]; ++j) {
+                    uint32_t c = stencils.indices[j];
+                    if (acc.marks[c] != row + 1) {
+                        acc.marks[c] = row + 1;
+                        acc.values[c] = 0.0f;
+                        acc.touched.push_back(c);
+                    }
+                    acc.values[c] += w * stencils.weights[j];
+                }
+            }
+            std::sort(acc.touched.begin(), acc.touched.end());
+            for (uint32_t c : acc.touched) {
+                if (acc.values[c] != 0.0f) {
+                    Add(indices, weights, c, acc.values[c]);
+                }
+            }
+        });
+        stencils.offsets.swap(composed.offsets);
+        stencils.indices.swap(composed.indices);
+        stencils.weights.swap(composed.weights);
+
+        if (level + 1 < levels) {
+            levelMesh = m_Refined;
+            current = &levelMesh;
+        }
+    }
+
+    m_Scheme = scheme;
+    m_Levels = levels;
+    m_CageVertexCount = cageCount;
+    m_Offsets.swap(stencils.offsets);
+    m_Indices.swap(stencils.indices);
+    m_Weights.swap(stencils.weights);
+
+    // Display indices: quads split along one diagonal, unique edges
+    m_TriangleIndices.clear();
+    m_TriangleIndices.reserve(m_Refined.GetFaceCount() * (scheme == SubdivisionScheme::Loop ? 3 : 6));
+    for (uint32_t f = 0; f < m_Refined.GetFaceCount(); ++f) {
+        uint32_t first = m_Refined.FaceHalfEdge(f);
+        uint32_t h = m_Refined.Next(first);
+        while (m_Refined.Next(h) != first) {
+            m_TriangleIndices.push_back(m_Refined.Source(first));
+            m_TriangleIndices.push_back(m_Refined.Source(h));
+            m_TriangleIndices.push_back(m_Refined.Target(h));
+            h = m_Refined.Next(h);
+        }
+    }
+    m_EdgeIndices.resize(m_Refined.GetEdgeCount() * 2);
+    for (uint32_t e = 0; e < m_Refined.GetEdgeCount(); ++e) {
+        m_EdgeIndices[e * 2] = m_Refined.Source(m_Refined.EdgeHalfEdge(e));
+        m_EdgeIndices[e * 2 + 1] = m_Refined.Target(m_Refined.EdgeHalfEdge(e));
+    }
+    return true;
+}
+
+void SubdivisionStencils::Clear() {
+    m_Levels = 0;
+    m_CageVertexCount = 0;
+    m_Offsets.clear();
+    m_Indices.clear();
+    m_Weights.clear();
+    m_Refined.Clear();
+    m_TriangleIndices.clear();
+    m_EdgeIndices.clear();
+}
+
+void SubdivisionStencils::Evaluate(const Vec3f* cage, Vec3f* out) const {
+    parallel::For(GetVertexCount(), GrainSize, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            float x = 0.0f, y = 0.0f, z = 0.0f;
+            for (uint32_t k = m_Offsets[i]; k < m_Offsets[i + 1]; ++k) {
+                const Vec3f& p = cage[m_Indices[k]];
+                float w = m_Weights[k];
+                x += w * p.x;
+                y += w * p.y;
+                z += w * p.z;
+            }
+            out[i] = Vec3f(x, y, z);
+        }
+    });
+}
+
+void SubdivisionStencils::Evaluate(const std::vector<Vec3f>& cage, std::vector<Vec3f>& out) const {
+    if (cage.size() != m_CageVertexCount) {
+        std::cerr << "SubdivisionStencils: cage has " << cage.size() << " vertices, stencils expect "
+                  << m_CageVertexCount << std::endl;
+        return;
+    }
+    out.resize(GetVertexCount());
+    Evaluate(cage.data(), out.data());
+}
+
+void SubdivisionStencils::Evaluate(const Vec3f* cage, void* out, size_t strideBytes) const {
+    char* base = static_cast<char*>(out);
+    parallel::For(GetVertexCount(), GrainSize, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            float x = 0.0f, y = 0.0f, z = 0.0f;
+            for (uint32_t k = m_Offsets[i]; k < m_Offsets[i + 1]; ++k) {
+                const Vec3f& p = cage[m_Indices[k]];
+                float w = m_Weights[k];
+                x += w * p.x;
+                y += w * p.y;
+                z += w * p.z;
+            }
+            float* target = reinterpret_cast<float*>(base + i * strideBytes);
+            target[0] = x;
+            target[1] = y;
+            target[2] = z;
+        }
+    });
+}
+
+void SubdivisionStencils::EvaluateAttribute(const float* cage, float* out, int components) const {
+    parallel::For(GetVertexCount(), GrainSize, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            float* target = out + i * components;
+            std::fill(target, target + components, 0.0f);
+            for (uint32_t k = m_Offsets[i]; k < m_Offsets[i + 1]; ++k) {
+                const float* value = cage + static_cast<size_t>(m_Indices[k]) * components;
+                float w = m_Weights[k];
+                for (int c = 0; c < components; ++c) {
+                    target[c] += w * value[c];
+                }
+            }
+        }
+    });
+}
+
+} // namespace alice2
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Mesh.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace alice2 {
+
+enum class SubdivisionScheme {
+    CatmullClark, // Any polygons, quads after one level
+    Loop          // Triangle meshes only
+};
+
+// Subdivision of a control cage expressed as stencils: every refined vertex
+// is a fixed weighted sum of cage vertices. Build() walks the levels once
+// and composes the per-level rules; afterwards moving cage vertices only
+// needs Evaluate(), a parallel sparse matrix-vector product, and the
+// refined topology never changes.
+//
+// Creases use semi-sharp edge sharpness (decremented per level; 10 or more
+// is infinitely sharp). Boundary edges are infinitely sharp and boundary
+// vertices with a single face stay pinned as corners.
+class SubdivisionStencils {
+public:
+    static constexpr int MaxLevel = 4;
+    static constexpr float InfiniteSharpness = 10.0f;
+
+    SubdivisionStencils() = default;
+
+    // creases holds a sharpness per cage edge; when empty the cage's float
+    // edge attribute "crease" is used if present
+    bool Build(const Mesh& cage, SubdivisionScheme scheme, int levels, const std::vector<float>& creases = {});
+    void Clear();
+
+    bool IsValid() const { return !m_Offsets.empty(); }
+    SubdivisionScheme GetScheme() const { return m_Scheme; }
+    int GetLevels() const { return m_Levels; }
+    size_t GetCageVertexCount() const { return m_CageVertexCount; }
+    size_t GetVertexCount() const { return m_Offsets.empty() ? 0 : m_Offsets.size() - 1; }
+    size_t GetStencilEntryCount() const { return m_Indices.size(); }
+
+    // out[i] = sum of w_ij * cage[j]; out must hold GetVertexCount() entries
+    void Evaluate(const Vec3f* cage, Vec3f* out) const;
+    void Evaluate(const std::vector<Vec3f>& cage, std::vector<Vec3f>& out) const;
+    // Writes xyz at out + i * strideBytes, e.g. straight into interleaved
+    // renderer vertices
+    void Evaluate(const Vec3f* cage, void* out, size_t strideBytes) const;
+    // Per-vertex attribute of components floats (colours, UVs, ...)
+    void EvaluateAttribute(const float* cage, float* out, int components) const;
+
+    // Final level topology; positions are those of the cage passed to Build()
+    const Mesh& GetRefinedMesh() const { return m_Refined; }
+    const std::vector<uint32_t>& GetTriangleIndices() const { return m_TriangleIndices; }
+    const std::vector<uint32_t>& GetEdgeIndices() const { return m_EdgeIndices; }
+
+private:
+    SubdivisionScheme m_Scheme = SubdivisionScheme::CatmullClark;
+    int m_Levels = 0;
+    size_t m_CageVertexCount = 0;
+
+    // Stencil matrix in CSR form, columns sorted per row
+    std::vector<uint32_t> m_Offsets;
+    std::vector<uint32_t> m_Indices;
+    std::vector<float> m_Weights;
+
+    Mesh m_Refined;
+    std::vector<uint32_t> m_TriangleIndices;
+    std::vector<uint32_t> m_EdgeIndices;
+};
+
+} // namespace alice2
@@ -0,0 +1,172 @@
+#include "FnGraph.h"
+#include "../objects/ObjGraph.h"
+#include "../iterators/ItGraph.h"
+#include "../../utilities/Parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+
+namespace alice2 {
+
+FnGraph::FnGraph(ObjGraph& object)
+    : m_Graph(&object.GetGraph()) {
+}
+
+bool FnGraph::Create(const std::vector<Vec3f>& positions, const std::vector<uint32_t>& edgeVertices, bool directed) {
+    return m_Graph->Create(positions, edgeVertices, directed);
+}
+
+bool FnGraph::CreateGrid(int rows, int columns, float spacing) {
+    if (rows < 1 || columns < 1) {
+        return false;
+    }
+
+    size_t vertexColumns = static_cast<size_t>(columns) + 1;
+    size_t vertexRows = static_cast<size_t>(rows) + 1;
+    std::vector<Vec3f> positions(vertexRows * vertexColumns);
+    float offsetX = columns * spacing * 0.5f;
+    float offsetZ = rows * spacing * 0.5f;
+    parallel::For(vertexRows, 64, [&](size_t begin, size_t end) {
+        for (size_t r = begin; r < end; ++r) {
+            for (size_t c = 0; c < vertexColumns; ++c) {
+                positions[r * vertexColumns + c] = Vec3f(c * spacing - offsetX, 0.0f, r * spacing - offsetZ);
+            }
+        }
+    });
+
+    // Per vertex row: the horizontal edges of the row, then the vertical
+    // edges up to the next row
+    size_t rowEdges = static_cast<size_t>(columns) + vertexColumns;
+    std::vector<uint32_t> edgeVertices((vertexRows * rowEdges - vertexColumns) * 2);
+    parallel::For(vertexRows, 64, [&](size_t begin, size_t end) {
+        for (size_t r = begin; r < end; ++r) {
+            uint32_t* edge = &edgeVertices[r * rowEdges * 2];
+            uint32_t v0 = static_cast<uint32_t>(r * vertexColumns);
+            for (size_t c = 0; c < static_cast<size_t>(columns); ++c, edge += 2) {
+                edge[0] = v0 + static_cast<uint32_t>(c);
+                edge[1] = v0 + static_cast<uint32_t>(c) + 1;
+            }
+            if (r + 1 == vertexRows) {
+                continue;
+            }
+            for (size_t c = 0; c < vertexColumns; ++c, edge += 2) {
+                edge[0] = v0 + static_cast<uint32_t>(c);
+                edge[1] = v0 + static_cast<uint32_t>(c + vertexColumns);
+            }
+        }
+    });
+
+    return m_Graph->Create(positions, edgeVertices);
+}
+
+bool FnGraph::CreateFromMesh(const Mesh& mesh) {
+    std::vector<uint32_t> edgeVertices(mesh.GetEdgeCount() * 2);
+    parallel::For(mesh.GetEdgeCount(), 16384, [&](size_t begin, size_t end) {
+        for (size_t e = begin; e < end; ++e) {
+            uint32_t h = mesh.EdgeHalfEdge(static_cast<uint32_t>(e));
+            edgeVertices[2 * e] = mesh.Source(h);
+            edgeVertices[2 * e + 1] = mesh.Target(h);
+        }
+    });
+    return m_Graph->Create(mesh.GetPositions(), edgeVertices);
+}
+
+void FnGraph::GetBounds(Vec3f& minBound, Vec3f& maxBound) const {
+    constexpr float inf = std::numeric_limits<float>::infinity();
+    minBound = Vec3f(inf, inf, inf);
+    maxBound = Vec3f(-inf, -inf, -inf);
+    for (const Vec3f& p : m_Graph->GetPositions()) {
+        minBound = Vec3f(std::min(minBound.x, p.x), std::min(minBound.y, p.y), std::min(minBound.z, p.z));
+        maxBound = Vec3f(std::max(maxBound.x, p.x), std::max(maxBound.y, p.y), std::max(maxBound.z, p.z));
+    }
+}
+
+void FnGraph::ComputeEdgeLengths(std::vector<float>& lengths) const {
+    const std::vector<Vec3f>& positions = m_Graph->GetPositions();
+    const std::vector<uint32_t>& edgeVertices = m_Graph->GetEdgeVertices();
+    lengths.resize(m_Graph->GetEdgeCount());
+    parallel::For(lengths.size(), 16384, [&](size_t begin, size_t end) {
+        for (size_t e = begin; e < end; ++e) {
+            lengths[e] = positions[edgeVertices[2 * e]].DistanceTo(positions[edgeVertices[2 * e + 1]]);
+        }
+    });
+}
+
+void FnGraph::GetDegrees(std::vector<uint32_t>& degrees) const {
+    degrees.resize(m_Graph->GetVertexCount());
+    parallel::For(degrees.size(), 4096, [&](size_t begin, size_t end) {
+        for (size_t v = begin; v < end; ++v) {
+            degrees[v] = m_Graph->GetDegree(static_cast<uint32_t>(v));
+        }
+    });
+}
+
+void FnGraph::GetIsolatedVertices(std::vector<uint32_t>& vertices) const {
+    // Directed graphs list edges only at their source, so mark both ends
+    std::vector<uint8_t> connected(m_Graph->GetVertexCount(), 0);
+    for (uint32_t vertex : m_Graph->GetEdgeVertices()) {
+        connected[vertex] = 1;
+    }
+    vertices.clear();
+    for (uint32_t v : Vertices(*m_Graph)) {
+        if (!connected[v]) {
+            vertices.push_back(v);
+        }
+    }
+}
+
+void FnGraph::GetEdgeIndices(std::vector<uint32_t>& indices) const {
+    indices = m_Graph->GetEdgeVertices();
+}
+
+bool FnGraph::Validate() const {
+    const Graph& graph = *m_Graph;
+    const std::vector<uint32_t>& offsets = graph.GetOffsets();
+    size_t vertexCount = graph.GetVertexCount();
+    size_t edgeCount = graph.GetEdgeCount();
+    if (offsets.size() > vertexCount + 1 || (!offsets.empty() && offsets[0] != 0)) {
+        return false;
+    }
+    for (size_t v = 1; v < offsets.size(); ++v) {
+        if (offsets[v] < offsets[v - 1]) {
+            return false;
+        }
+    }
+    size_t slotCount = graph.GetNeighbors().size() + graph.GetPendingNeighbors().size();
+    if ((offsets.empty() ? 0 : offsets.back()) != graph.GetNeighbors().size()
+        || slotCount != (graph.IsDirected() ? edgeCount : 2 * edgeCount)) {
+        return false;
+    }
+
+    std::atomic<bool> valid{true};
+    parallel::For(vertexCount, 4096, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end && valid.load(std::memory_order_relaxed); ++i) {
+            uint32_t v = static_cast<uint32_t>(i);
+            Graph::Adjacency adjacency = graph.GetAdjacency(v);
+            for (uint32_t slot = adjacency.begin; slot < adjacency.end; ++slot) {
+                if (slot > adjacency.begin && graph.GetNeighbors()[slot] < graph.GetNeighbors()[slot - 1]) {
+                    valid = false;
+                }
+            }
+            GraphNeighborRange neighbors = VertexNeighbors(graph, v);
+            GraphEdgeRange edges = VertexEdges(graph, v);
+            GraphEdgeRange::Iterator e = edges.begin();
+            for (auto n = neighbors.begin(); n != neighbors.end(); ++n, ++e) {
+                uint32_t edge = *e, neighbor = *n;
+                bool ok = edge < edgeCount && neighbor < vertexCount;
+                if (ok) {
+                    uint32_t source = graph.GetEdgeSource(edge), target = graph.GetEdgeTarget(edge);
+                    ok = (source == v && target == neighbor)
+                        || (!graph.IsDirected() && source == neighbor && target == v);
+                }
+                if (!ok) {
+                    valid = false;
+                }
+            }
+        }
+    });
+    return valid;
+}
+
+} // namespace alice2
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "../../geometry/Graph.h"
+#include "../../geometry/Mesh.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace alice2 {
+
+class ObjGraph;
+
+// Function set over a Graph: construction helpers and whole-graph queries.
+// Per-element kernels run on the shared thread pool.
+class FnGraph {
+public:
+    explicit FnGraph(Graph& graph) : m_Graph(&graph) {}
+    explicit FnGraph(ObjGraph& object);
+
+    // Construction
+    bool Create(const std::vector<Vec3f>& positions, const std::vector<uint32_t>& edgeVertices,
+                bool directed = false);
+    // Lattice in the XZ plane centred on the origin, rows x columns cells
+    bool CreateGrid(int rows, int columns, float spacing = 1.0f);
+    // Vertices and edges of a mesh, edge indices preserved
+    bool CreateFromMesh(const Mesh& mesh);
+
+    size_t GetVertexCount() const { return m_Graph->GetVertexCount(); }
+    size_t GetEdgeCount() const { return m_Graph->GetEdgeCount(); }
+
+    // Geometry
+    void GetBounds(Vec3f& minBound, Vec3f& maxBound) const;
+    void ComputeEdgeLengths(std::vector<float>& lengths) const;
+
+    // Topology
+    void GetDegrees(std::vector<uint32_t>& degrees) const;
+    // Vertices with no incident edge
+    void GetIsolatedVertices(std::vector<uint32_t>& vertices) const;
+
+    // Index buffer for rendering: edge pairs
+    void GetEdgeIndices(std::vector<uint32_t>& indices) const;
+
+    // Checks that every edge appears in the adjacency of its endpoints and
+    // every slot names an edge incident to its vertex; for debugging
+    bool Validate() const;
+
+private:
+    Graph* m_Graph;
+};
+
+} // namespace alice2
@@ -0,0 +1,202 @@
+#include "FnMesh.h"
+#include "../objects/ObjMesh.h"
+#include "../iterators/ItMesh.h"
+#include "../../utilities/Parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+
+namespace alice2 {
+
+FnMesh::FnMesh(ObjMesh& object)
+    : m_Mesh(&object.GetMesh()) {
+}
+
+bool FnMesh::Create(const std::vector<Vec3f>& positions,
+                    const std::vector<uint32_t>& faceCounts,
+                    const std::vector<uint32_t>& faceIndices) {
+    return m_Mesh->Create(positions, faceCounts, faceIndices);
+}
+
+bool FnMesh::CreateGrid(int rows, int columns, float spacing) {
+    if (rows < 1 || columns < 1) {
+        return false;
+    }
+
+    size_t vertexColumns = static_cast<size_t>(columns) + 1;
+    size_t vertexRows = static_cast<size_t>(rows) + 1;
+    std::vector<Vec3f> positions(vertexRows * vertexColumns);
+    float offsetX = columns * spacing * 0.5f;
+    float offsetZ = rows * spacing * 0.5f;
+    parallel::For(vertexRows, 64, [&](size_t begin, size_t end) {
+        for (size_t r = begin; r < end; ++r) {
+            for (size_t c = 0; c < vertexColumns; ++c) {
+                positions[r * vertexColumns + c] = Vec3f(c * spacing - offsetX, 0.0f, r * spacing - offsetZ);
+            }
+        }
+    });
+
+    // Counter-clockwise seen from +Y
+    size_t faceCount = static_cast<size_t>(rows) * columns;
+    std::vector<uint32_t> faceCounts(faceCount, 4);
+    std::vector<uint32_t> faceIndices(faceCount * 4);
+    parallel::For(static_cast<size_t>(rows), 64, [&](size_t begin, size_t end) {
+        for (size_t r = begin; r < end; ++r) {
+            for (size_t c = 0; c < static_cast<size_t>(columns); ++c) {
+                uint32_t* quad = &faceIndices[(r * columns + c) * 4];
+                uint32_t v0 = static_cast<uint32_t>(r * vertexColumns + c);
+                quad[0] = v0;
+                quad[1] = v0 + static_cast<uint32_t>(vertexColumns);
+                quad[2] = v0 + static_cast<uint32_t>(vertexColumns) + 1;
+                quad[3] = v0 + 1;
+            }
+        }
+    });
+
+    return m_Mesh->Create(positions, faceCounts, faceIndices);
+}
+
+void FnMesh::GetBounds(Vec3f& minBound, Vec3f& maxBound) const {
+    constexpr float inf = std::numeric_limits<float>::infinity();
+    minBound = Vec3f(inf, inf, inf);
+    maxBound = Vec3f(-inf, -inf, -inf);
+    for (const Vec3f& p : m_Mesh->GetPositions()) {
+        minBound = Vec3f(std::min(minBound.x, p.x), std::min(minBound.y, p.y), std::min(minBound.z, p.z));
+        maxBound = Vec3f(std::max(maxBound.x, p.x), std::max(maxBound.y, p.y), std::max(maxBound.z, p.z));
+    }
+}
+
+void FnMesh::ComputeFaceNormals(std::vector<Vec3f>& normals) const {
+    MeshNormals cache;
+    cache.Update(*m_Mesh);
+    normals = cache.GetFaceNormals();
+}
+
+void FnMesh::ComputeVertexNormals(std::vector<Vec3f>& normals, NormalWeighting weighting) const {
+    MeshNormals cache(weighting);
+    cache.Update(*m_Mesh);
+    normals = cache.GetVertexNormals();
+}
+
+void FnMesh::ComputeFaceAreas(std::vector<float>& areas) const {
+    MeshNormals cache;
+    cache.Update(*m_Mesh);
+    areas = cache.GetFaceAreas();
+}
+
+Vec3f FnMesh::GetFaceCenter(uint32_t face) const {
+    return ItMeshFace(*m_Mesh, face).GetCenter();
+}
+
+int FnMesh::GetValence(uint32_t vertex) const {
+    return ItMeshVertex(*m_Mesh, vertex).GetValence();
+}
+
+void FnMesh::GetValences(std::vector<int>& valences) const {
+    valences.resize(m_Mesh->GetVertexCount());
+    parallel::For(valences.size(), 4096, [&](size_t begin, size_t end) {
+        for (size_t v = begin; v < end; ++v) {
+            valences[v] = GetValence(static_cast<uint32_t>(v));
+        }
+    });
+}
+
+void FnMesh::GetBoundaryLoops(std::vector<std::vector<uint32_t>>& loops) const {
+    loops.clear();
+    std::vector<uint8_t> visited(m_Mesh->GetHalfEdgeCount(), 0);
+    for (uint32_t start : HalfEdges(*m_Mesh)) {
+        if (visited[start] || !m_Mesh->IsBoundaryHalfEdge(start)) {
+            continue;
+        }
+        std::vector<uint32_t> loop;
+        for (uint32_t halfEdge : BoundaryLoop(*m_Mesh, start)) {
+            visited[halfEdge] = 1;
+            loop.push_back(m_Mesh->Source(halfEdge));
+        }
+        loops.push_back(std::move(loop));
+    }
+}
+
+bool FnMesh::IsTriangleMesh() const {
+    const auto& next = m_Mesh->GetHalfEdgeNext();
+    for (uint32_t face : Faces(*m_Mesh)) {
+        uint32_t h = m_Mesh->FaceHalfEdge(face);
+        if (next[next[next[h]]] != h) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void FnMesh::GetTriangleIndices(std::vector<uint32_t>& indices) const {
+    // Triangle offsets per face so the fill runs in parallel
+    size_t faceCount = m_Mesh->GetFaceCount();
+    std::vector<size_t> offsets(faceCount + 1, 0);
+    for (size_t f = 0; f < faceCount; ++f) {
+        offsets[f + 1] = offsets[f] + (ItMeshFace(*m_Mesh, static_cast<uint32_t>(f)).GetVertexCount() - 2) * 3;
+    }
+
+    indices.resize(offsets[faceCount]);
+    parallel::For(faceCount, 4096, [&](size_t begin, size_t end) {
+        for (size_t f = begin; f < end; ++f) {
+            uint32_t h0 = m_Mesh->FaceHalfEdge(static_cast<uint32_t>(f));
+            uint32_t anchor = m_Mesh->Source(h0);
+            size_t out = offsets[f];
+            for (uint32_t h = m_Mesh->Next(h0); m_Mesh->Target(h) != anchor; h = m_Mesh->Next(h)) {
+                indices[out++] = anchor;
+                indices[out++] = m_Mesh->Source(h);
+                indices[out++] = m_Mesh->Target(h);
+            }
+        }
+    });
+}
+
+void FnMesh::GetEdgeIndices(std::vector<uint32_t>& indices) const {
+    indices.resize(m_Mesh->GetEdgeCount() * 2);
+    parallel::For(m_Mesh->GetEdgeCount(), 16384, [&](size_t begin, size_t end) {
+        for (size_t e = begin; e < end; ++e) {
+            uint32_t h = m_Mesh->EdgeHalfEdge(static_cast<uint32_t>(e));
+            indices[e * 2] = m_Mesh->Source(h);
+            indices[e * 2 + 1] = m_Mesh->Target(h);
+        }
+    });
+}
+
+bool FnMesh::Validate() const {
+    const Mesh& mesh = *m_Mesh;
+    std::atomic<bool> valid{true};
+
+    parallel::For(mesh.GetHalfEdgeCount(), 16384, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end && valid.load(std::memory_order_relaxed); ++i) {
+            uint32_t h = static_cast<uint32_t>(i);
+            uint32_t next = mesh.Next(h), prev = mesh.Prev(h);
+            bool ok = next < mesh.GetHalfEdgeCount() && prev < mesh.GetHalfEdgeCount()
+                && mesh.Prev(next) == h && mesh.Next(prev) == h
+                && mesh.Face(next) == mesh.Face(h)
+                && mesh.Source(next) == mesh.Target(h)
+                && mesh.Target(h) < mesh.GetVertexCount()
+                && mesh.Target(h) != mesh.Source(h)
+                && (mesh.Face(h) == INVALID_INDEX || mesh.Face(h) < mesh.GetFaceCount())
+                && !(mesh.IsBoundaryHalfEdge(h) && mesh.IsBoundaryHalfEdge(mesh.Twin(h)));
+            if (!ok) {
+                valid = false;
+            }
+        }
+    });
+
+    for (uint32_t v : Vertices(mesh)) {
+        uint32_t h = mesh.VertexHalfEdge(v);
+        if (h != INVALID_INDEX && mesh.Source(h) != v) {
+            return false;
+        }
+    }
+    for (uint32_t f : Faces(mesh)) {
+        if (mesh.Face(mesh.FaceHalfEdge(f)) != f) {
+            return false;
+        }
+    }
+    return valid.load();
+}
+
+} // namespace alice2
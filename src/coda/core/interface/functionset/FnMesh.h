@@ -0,0 +1,58 @@
+#pragma once
+
+#include "../../geometry/Mesh.h"
+#include "../../geometry/MeshNormals.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace alice2 {
+
+class ObjMesh;
+
+// Function set over a Mesh: construction helpers and whole-mesh queries.
+// Per-element kernels run on the shared thread pool.
+class FnMesh {
+public:
+    explicit FnMesh(Mesh& mesh) : m_Mesh(&mesh) {}
+    explicit FnMesh(ObjMesh& object);
+
+    // Construction
+    bool Create(const std::vector<Vec3f>& positions,
+                const std::vector<uint32_t>& faceCounts,
+                const std::vector<uint32_t>& faceIndices);
+    // Quad grid in the XZ plane centred on the origin, rows x columns faces
+    bool CreateGrid(int rows, int columns, float spacing = 1.0f);
+
+    size_t GetVertexCount() const { return m_Mesh->GetVertexCount(); }
+    size_t GetFaceCount() const { return m_Mesh->GetFaceCount(); }
+    size_t GetEdgeCount() const { return m_Mesh->GetEdgeCount(); }
+
+    // Geometry
+    void GetBounds(Vec3f& minBound, Vec3f& maxBound) const;
+    // One-shot normals; keep a MeshNormals around to update incrementally
+    void ComputeFaceNormals(std::vector<Vec3f>& normals) const;
+    void ComputeVertexNormals(std::vector<Vec3f>& normals, NormalWeighting weighting = NormalWeighting::Area) const;
+    void ComputeFaceAreas(std::vector<float>& areas) const;
+    Vec3f GetFaceCenter(uint32_t face) const;
+
+    // Topology
+    int GetValence(uint32_t vertex) const;
+    void GetValences(std::vector<int>& valences) const;
+    // Vertex loops along each boundary, following boundary half-edge order
+    void GetBoundaryLoops(std::vector<std::vector<uint32_t>>& loops) const;
+    bool IsTriangleMesh() const;
+
+    // Index buffers for rendering: fan-triangulated faces and edge pairs
+    void GetTriangleIndices(std::vector<uint32_t>& indices) const;
+    void GetEdgeIndices(std::vector<uint32_t>& indices) const;
+
+    // Checks every link invariant (twin/next/prev/face/vertex); for debugging
+    // and loaders that build meshes by hand
+    bool Validate() const;
+
+private:
+    Mesh* m_Mesh;
+};
+
+} // namespace alice2
@@ -0,0 +1,31 @@
+#include "ItGraph.h"
+
+namespace alice2 {
+
+// ---------------------------------------------------------------------------
+// ItGraphVertex
+// ---------------------------------------------------------------------------
+
+void ItGraphVertex::GetNeighbors(std::vector<uint32_t>& neighbors) const {
+    neighbors.clear();
+    for (uint32_t vertex : VertexNeighbors(*m_Graph, m_Index)) {
+        neighbors.push_back(vertex);
+    }
+}
+
+void ItGraphVertex::GetEdges(std::vector<uint32_t>& edges) const {
+    edges.clear();
+    for (uint32_t edge : VertexEdges(*m_Graph, m_Index)) {
+        edges.push_back(edge);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// ItGraphEdge
+// ---------------------------------------------------------------------------
+
+float ItGraphEdge::GetLength() const {
+    return m_Graph->GetPosition(GetStartVertex()).DistanceTo(m_Graph->GetPosition(GetEndVertex()));
+}
+
+} // namespace alice2
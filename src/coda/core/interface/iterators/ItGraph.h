@@ -0,0 +1,123 @@
+#pragma once
+
+#include "ItMesh.h"
+#include "../../geometry/Graph.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+namespace alice2 {
+
+// Lightweight iteration over graph elements. Vertices and edges are plain
+// index ranges; adjacency ranges count through a vertex's CSR slots and then
+// follow its pending chain, yielding neighbour or edge indices.
+
+inline IndexRange Vertices(const Graph& graph) { return IndexRange(0, graph.GetVertexCount()); }
+inline IndexRange Edges(const Graph& graph) { return IndexRange(0, graph.GetEdgeCount()); }
+
+// Slots of one vertex; YieldEdges picks edge indices over neighbour vertices
+template <bool YieldEdges>
+class GraphAdjacencyRange {
+public:
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = uint32_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const uint32_t*;
+        using reference = uint32_t;
+
+        Iterator(const Graph* graph, const Graph::Adjacency& adjacency, uint32_t slot)
+            : m_Graph(graph), m_Adjacency(adjacency), m_Slot(slot), m_Pending(adjacency.pendingHead) {}
+
+        uint32_t operator*() const {
+            uint32_t slot = m_Adjacency.begin + m_Slot;
+            if (slot < m_Adjacency.end) {
+                return YieldEdges ? m_Graph->GetSlotEdges()[slot] : m_Graph->GetNeighbors()[slot];
+            }
+            return YieldEdges ? m_Graph->GetPendingEdges()[m_Pending] : m_Graph->GetPendingNeighbors()[m_Pending];
+        }
+        Iterator& operator++() {
+            if (m_Adjacency.begin + m_Slot >= m_Adjacency.end) {
+                m_Pending = m_Graph->GetPendingNext()[m_Pending];
+            }
+            ++m_Slot;
+            return *this;
+        }
+        bool operator==(const Iterator& other) const { return m_Slot == other.m_Slot; }
+        bool operator!=(const Iterator& other) const { return m_Slot != other.m_Slot; }
+
+    private:
+        const Graph* m_Graph;
+        Graph::Adjacency m_Adjacency;
+        uint32_t m_Slot;
+        uint32_t m_Pending; // Current pending slot once past the CSR ones
+    };
+
+    GraphAdjacencyRange(const Graph& graph, uint32_t vertex)
+        : m_Graph(&graph), m_Adjacency(graph.GetAdjacency(vertex)) {}
+    Iterator begin() const { return Iterator(m_Graph, m_Adjacency, 0); }
+    Iterator end() const { return Iterator(m_Graph, m_Adjacency, m_Adjacency.GetDegree()); }
+    size_t size() const { return m_Adjacency.GetDegree(); }
+
+private:
+    const Graph* m_Graph;
+    Graph::Adjacency m_Adjacency;
+};
+
+// Neighbour vertices / incident edges of a vertex (out-edges when directed)
+using GraphNeighborRange = GraphAdjacencyRange<false>;
+using GraphEdgeRange = GraphAdjacencyRange<true>;
+
+inline GraphNeighborRange VertexNeighbors(const Graph& graph, uint32_t vertex) {
+    return GraphNeighborRange(graph, vertex);
+}
+inline GraphEdgeRange VertexEdges(const Graph& graph, uint32_t vertex) {
+    return GraphEdgeRange(graph, vertex);
+}
+
+// Stateful element iterators in the CODA style:
+//   for (ItGraphVertex it(graph); !it.End(); it.Next()) { ... }
+class ItGraphVertex {
+public:
+    explicit ItGraphVertex(const Graph& graph, uint32_t index = 0) : m_Graph(&graph), m_Index(index) {}
+
+    bool End() const { return m_Index >= m_Graph->GetVertexCount(); }
+    void Next() { ++m_Index; }
+    void Reset() { m_Index = 0; }
+    uint32_t GetIndex() const { return m_Index; }
+
+    const Vec3f& GetPosition() const { return m_Graph->GetPosition(m_Index); }
+    int GetDegree() const { return static_cast<int>(m_Graph->GetDegree(m_Index)); }
+    void GetNeighbors(std::vector<uint32_t>& neighbors) const;
+    void GetEdges(std::vector<uint32_t>& edges) const;
+
+    GraphNeighborRange Neighbors() const { return VertexNeighbors(*m_Graph, m_Index); }
+    GraphEdgeRange IncidentEdges() const { return VertexEdges(*m_Graph, m_Index); }
+
+private:
+    const Graph* m_Graph;
+    uint32_t m_Index;
+};
+
+class ItGraphEdge {
+public:
+    explicit ItGraphEdge(const Graph& graph, uint32_t index = 0) : m_Graph(&graph), m_Index(index) {}
+
+    bool End() const { return m_Index >= m_Graph->GetEdgeCount(); }
+    void Next() { ++m_Index; }
+    void Reset() { m_Index = 0; }
+    uint32_t GetIndex() const { return m_Index; }
+
+    uint32_t GetStartVertex() const { return m_Graph->GetEdgeSource(m_Index); }
+    uint32_t GetEndVertex() const { return m_Graph->GetEdgeTarget(m_Index); }
+    float GetLength() const;
+
+private:
+    const Graph* m_Graph;
+    uint32_t m_Index;
+};
+
+} // namespace alice2
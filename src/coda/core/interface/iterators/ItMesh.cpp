@@ -0,0 +1,72 @@
+#include "ItMesh.h"
+
+namespace alice2 {
+
+// ---------------------------------------------------------------------------
+// ItMeshVertex
+// ---------------------------------------------------------------------------
+
+int ItMeshVertex::GetValence() const {
+    int valence = 0;
+    for (uint32_t halfEdge : VertexHalfEdges(*m_Mesh, m_Index)) {
+        (void)halfEdge;
+        ++valence;
+    }
+    return valence;
+}
+
+void ItMeshVertex::GetNeighbors(std::vector<uint32_t>& neighbors) const {
+    neighbors.clear();
+    for (uint32_t vertex : VertexNeighbors(*m_Mesh, m_Index)) {
+        neighbors.push_back(vertex);
+    }
+}
+
+void ItMeshVertex::GetFaces(std::vector<uint32_t>& faces) const {
+    faces.clear();
+    for (uint32_t face : VertexFaces(*m_Mesh, m_Index)) {
+        if (face != INVALID_INDEX) {
+            faces.push_back(face);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// ItMeshFace
+// ---------------------------------------------------------------------------
+
+int ItMeshFace::GetVertexCount() const {
+    int count = 0;
+    for (uint32_t halfEdge : FaceHalfEdges(*m_Mesh, m_Index)) {
+        (void)halfEdge;
+        ++count;
+    }
+    return count;
+}
+
+void ItMeshFace::GetVertices(std::vector<uint32_t>& vertices) const {
+    vertices.clear();
+    for (uint32_t vertex : FaceVertices(*m_Mesh, m_Index)) {
+        vertices.push_back(vertex);
+    }
+}
+
+Vec3f ItMeshFace::GetCenter() const {
+    Vec3f center;
+    int count = 0;
+    for (uint32_t vertex : FaceVertices(*m_Mesh, m_Index)) {
+        center += m_Mesh->GetPosition(vertex);
+        ++count;
+    }
+    return count > 0 ? center / static_cast<float>(count) : center;
+}
+
+// ---------------------------------------------------------------------------
+// ItMeshEdge
+// ---------------------------------------------------------------------------
+
+float ItMeshEdge::GetLength() const {
+    return m_Mesh->GetPosition(GetStartVertex()).DistanceTo(m_Mesh->GetPosition(GetEndVertex()));
+}
+
+} // namespace alice2
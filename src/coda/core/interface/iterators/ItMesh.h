@@ -0,0 +1,207 @@
+#pragma once
+
+#include "../../geometry/Mesh.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+namespace alice2 {
+
+// Lightweight iteration over mesh elements. Element ranges are plain index
+// ranges; circulators walk half-edge links and yield indices, so range-for
+// loops compile down to array lookups with no allocation.
+
+// [begin, end) of element indices
+class IndexRange {
+public:
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = uint32_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const uint32_t*;
+        using reference = uint32_t;
+
+        explicit Iterator(uint32_t index) : m_Index(index) {}
+        uint32_t operator*() const { return m_Index; }
+        Iterator& operator++() { ++m_Index; return *this; }
+        bool operator==(const Iterator& other) const { return m_Index == other.m_Index; }
+        bool operator!=(const Iterator& other) const { return m_Index != other.m_Index; }
+
+    private:
+        uint32_t m_Index;
+    };
+
+    IndexRange(size_t begin, size_t end) : m_Begin(static_cast<uint32_t>(begin)), m_End(static_cast<uint32_t>(end)) {}
+    Iterator begin() const { return Iterator(m_Begin); }
+    Iterator end() const { return Iterator(m_End); }
+    size_t size() const { return m_End - m_Begin; }
+
+private:
+    uint32_t m_Begin;
+    uint32_t m_End;
+};
+
+inline IndexRange Vertices(const Mesh& mesh) { return IndexRange(0, mesh.GetVertexCount()); }
+inline IndexRange Faces(const Mesh& mesh) { return IndexRange(0, mesh.GetFaceCount()); }
+inline IndexRange Edges(const Mesh& mesh) { return IndexRange(0, mesh.GetEdgeCount()); }
+inline IndexRange HalfEdges(const Mesh& mesh) { return IndexRange(0, mesh.GetHalfEdgeCount()); }
+
+// Circulator over a closed half-edge cycle. Step advances the half-edge and
+// Map turns it into the yielded index (half-edge, vertex or face).
+template <typename Step, typename Map>
+class HalfEdgeCycle {
+public:
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = uint32_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const uint32_t*;
+        using reference = uint32_t;
+
+        Iterator(const Mesh* mesh, uint32_t start, uint32_t current)
+            : m_Mesh(mesh), m_Start(start), m_Current(current) {}
+
+        uint32_t operator*() const { return Map()(*m_Mesh, m_Current); }
+        uint32_t GetHalfEdge() const { return m_Current; }
+        Iterator& operator++() {
+            m_Current = Step()(*m_Mesh, m_Current);
+            if (m_Current == m_Start) {
+                m_Current = INVALID_INDEX;
+            }
+            return *this;
+        }
+        bool operator==(const Iterator& other) const { return m_Current == other.m_Current; }
+        bool operator!=(const Iterator& other) const { return m_Current != other.m_Current; }
+
+    private:
+        const Mesh* m_Mesh;
+        uint32_t m_Start;
+        uint32_t m_Current;
+    };
+
+    HalfEdgeCycle(const Mesh& mesh, uint32_t start) : m_Mesh(&mesh), m_Start(start) {}
+    Iterator begin() const { return Iterator(m_Mesh, m_Start, m_Start); }
+    Iterator end() const { return Iterator(m_Mesh, m_Start, INVALID_INDEX); }
+
+private:
+    const Mesh* m_Mesh;
+    uint32_t m_Start;
+};
+
+namespace circulate {
+struct FaceStep { uint32_t operator()(const Mesh& m, uint32_t h) const { return m.Next(h); } };
+struct VertexStep { uint32_t operator()(const Mesh& m, uint32_t h) const { return m.Twin(m.Prev(h)); } };
+struct HalfEdgeMap { uint32_t operator()(const Mesh&, uint32_t h) const { return h; } };
+struct TargetMap { uint32_t operator()(const Mesh& m, uint32_t h) const { return m.Target(h); } };
+struct SourceMap { uint32_t operator()(const Mesh& m, uint32_t h) const { return m.Source(h); } };
+struct FaceMap { uint32_t operator()(const Mesh& m, uint32_t h) const { return m.Face(h); } };
+struct TwinFaceMap { uint32_t operator()(const Mesh& m, uint32_t h) const { return m.Face(m.Twin(h)); } };
+} // namespace circulate
+
+// Half-edges / vertices / adjacent faces (INVALID_INDEX across boundaries) of a face
+using FaceHalfEdgeRange = HalfEdgeCycle<circulate::FaceStep, circulate::HalfEdgeMap>;
+using FaceVertexRange = HalfEdgeCycle<circulate::FaceStep, circulate::SourceMap>;
+using FaceNeighborRange = HalfEdgeCycle<circulate::FaceStep, circulate::TwinFaceMap>;
+
+// Outgoing half-edges / one-ring vertices / incident faces of a vertex. Faces
+// yield INVALID_INDEX for the boundary gap of a boundary vertex.
+using VertexHalfEdgeRange = HalfEdgeCycle<circulate::VertexStep, circulate::HalfEdgeMap>;
+using VertexVertexRange = HalfEdgeCycle<circulate::VertexStep, circulate::TargetMap>;
+using VertexFaceRange = HalfEdgeCycle<circulate::VertexStep, circulate::FaceMap>;
+
+// Half-edges of the boundary loop through a boundary half-edge
+using BoundaryLoopRange = HalfEdgeCycle<circulate::FaceStep, circulate::HalfEdgeMap>;
+
+inline FaceHalfEdgeRange FaceHalfEdges(const Mesh& mesh, uint32_t face) {
+    return FaceHalfEdgeRange(mesh, mesh.FaceHalfEdge(face));
+}
+inline FaceVertexRange FaceVertices(const Mesh& mesh, uint32_t face) {
+    return FaceVertexRange(mesh, mesh.FaceHalfEdge(face));
+}
+inline FaceNeighborRange FaceNeighbors(const Mesh& mesh, uint32_t face) {
+    return FaceNeighborRange(mesh, mesh.FaceHalfEdge(face));
+}
+inline VertexHalfEdgeRange VertexHalfEdges(const Mesh& mesh, uint32_t vertex) {
+    return VertexHalfEdgeRange(mesh, mesh.VertexHalfEdge(vertex));
+}
+inline VertexVertexRange VertexNeighbors(const Mesh& mesh, uint32_t vertex) {
+    return VertexVertexRange(mesh, mesh.VertexHalfEdge(vertex));
+}
+inline VertexFaceRange VertexFaces(const Mesh& mesh, uint32_t vertex) {
+    return VertexFaceRange(mesh, mesh.VertexHalfEdge(vertex));
+}
+inline BoundaryLoopRange BoundaryLoop(const Mesh& mesh, uint32_t boundaryHalfEdge) {
+    return BoundaryLoopRange(mesh, boundaryHalfEdge);
+}
+
+// Stateful element iterators in the CODA style:
+//   for (ItMeshVertex it(mesh); !it.End(); it.Next()) { ... }
+class ItMeshVertex {
+public:
+    explicit ItMeshVertex(const Mesh& mesh, uint32_t index = 0) : m_Mesh(&mesh), m_Index(index) {}
+
+    bool End() const { return m_Index >= m_Mesh->GetVertexCount(); }
+    void Next() { ++m_Index; }
+    void Reset() { m_Index = 0; }
+    uint32_t GetIndex() const { return m_Index; }
+
+    const Vec3f& GetPosition() const { return m_Mesh->GetPosition(m_Index); }
+    bool IsBoundary() const { return m_Mesh->IsBoundaryVertex(m_Index); }
+    int GetValence() const;
+    void GetNeighbors(std::vector<uint32_t>& neighbors) const;
+    void GetFaces(std::vector<uint32_t>& faces) const;
+
+    VertexVertexRange Neighbors() const { return VertexNeighbors(*m_Mesh, m_Index); }
+    VertexHalfEdgeRange OutgoingHalfEdges() const { return VertexHalfEdges(*m_Mesh, m_Index); }
+
+private:
+    const Mesh* m_Mesh;
+    uint32_t m_Index;
+};
+
+class ItMeshFace {
+public:
+    explicit ItMeshFace(const Mesh& mesh, uint32_t index = 0) : m_Mesh(&mesh), m_Index(index) {}
+
+    bool End() const { return m_Index >= m_Mesh->GetFaceCount(); }
+    void Next() { ++m_Index; }
+    void Reset() { m_Index = 0; }
+    uint32_t GetIndex() const { return m_Index; }
+
+    int GetVertexCount() const;
+    void GetVertices(std::vector<uint32_t>& vertices) const;
+    Vec3f GetCenter() const;
+
+    FaceVertexRange Vertices() const { return FaceVertices(*m_Mesh, m_Index); }
+    FaceHalfEdgeRange HalfEdges() const { return FaceHalfEdges(*m_Mesh, m_Index); }
+
+private:
+    const Mesh* m_Mesh;
+    uint32_t m_Index;
+};
+
+class ItMeshEdge {
+public:
+    explicit ItMeshEdge(const Mesh& mesh, uint32_t index = 0) : m_Mesh(&mesh), m_Index(index) {}
+
+    bool End() const { return m_Index >= m_Mesh->GetEdgeCount(); }
+    void Next() { ++m_Index; }
+    void Reset() { m_Index = 0; }
+    uint32_t GetIndex() const { return m_Index; }
+
+    uint32_t GetHalfEdge() const { return m_Mesh->EdgeHalfEdge(m_Index); }
+    uint32_t GetStartVertex() const { return m_Mesh->Source(GetHalfEdge()); }
+    uint32_t GetEndVertex() const { return m_Mesh->Target(GetHalfEdge()); }
+    bool IsBoundary() const { return m_Mesh->IsBoundaryEdge(m_Index); }
+    float GetLength() const;
+
+private:
+    const Mesh* m_Mesh;
+    uint32_t m_Index;
+};
+
+} // namespace alice2
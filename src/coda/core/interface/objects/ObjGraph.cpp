@@ -0,0 +1,189 @@
+#include "ObjGraph.h"
+#include "../../../../renderer/unified_renderer.h"
+
+#include <algorithm>
+
+namespace alice2 {
+
+ObjGraph::ObjGraph()
+    : m_EdgeStream(std::make_unique<LineStream>()) {}
+
+ObjGraph::~ObjGraph() {
+    ClearLods();
+    UnifiedRenderer::ReleaseLineStream(*m_EdgeStream);
+}
+
+void ObjGraph::SetEdgeColorAttribute(const std::string& name, GraphElement element) {
+    m_EdgeColorAttribute = name;
+    m_EdgeColorElement = element;
+    m_EdgeColorsDirty = true;
+}
+
+void ObjGraph::StartLayout(const GraphLayoutSettings& settings, int iterationsPerFrame) {
+    m_Layout.SetSettings(settings);
+    m_Layout.Reset();
+    m_LayoutIterations = std::max(iterationsPerFrame, 1);
+    m_LayoutRunning = true;
+}
+
+bool ObjGraph::RunMultilevelLayout(const GraphLayoutSettings& settings, int iterationsPerLevel) {
+    m_LayoutRunning = false;
+    m_Layout.SetSettings(settings);
+    bool ok = m_Hierarchy.Layout(m_Graph, m_Layout, std::max(iterationsPerLevel, 1));
+    m_LodEditCursor = m_Graph.GetEditCursor();
+    return ok;
+}
+
+bool ObjGraph::GenerateLods(const GraphCoarseningSettings& settings) {
+    ClearLods();
+    m_Hierarchy.SetSettings(settings);
+    if (!m_Hierarchy.Build(m_Graph)) {
+        return false;
+    }
+    m_LodEditCursor = m_Graph.GetEditCursor();
+    m_LodStreams.resize(m_Hierarchy.GetLevelCount());
+    for (LodStream& lod : m_LodStreams) {
+        lod.stream = std::make_unique<LineStream>();
+    }
+    return m_Hierarchy.GetLevelCount() > 0;
+}
+
+void ObjGraph::ClearLods() {
+    for (LodStream& lod : m_LodStreams) {
+        UnifiedRenderer::ReleaseLineStream(*lod.stream);
+    }
+    m_LodStreams.clear();
+    m_Hierarchy.Clear();
+    m_DrawnLod = 0;
+}
+
+size_t ObjGraph::SelectLod(UnifiedRenderer* renderer) {
+    if (m_LodStreams.empty()) {
+        return 0;
+    }
+    if (!m_Hierarchy.IsBuiltFor(m_Graph)) {
+        ClearLods();
+        return 0;
+    }
+    if (m_LodEditCursor != m_Graph.GetEditCursor()) {
+        m_Hierarchy.UpdatePositions(m_Graph);
+        m_LodEditCursor = m_Graph.GetEditCursor();
+    }
+
+    // Aggregates grow with the level: take the last one still below the tolerance
+    float pixelsPerUnit = renderer->GetPixelsPerUnit(m_Hierarchy.GetCenter(), m_Hierarchy.GetRadius());
+    size_t level = 0;
+    while (level < m_Hierarchy.GetLevelCount() && m_Hierarchy.GetLevel(level).error * pixelsPerUnit <= m_LodTolerance) {
+        ++level;
+    }
+    return level;
+}
+
+void ObjGraph::DrawLod(UnifiedRenderer* renderer, size_t index) {
+    const GraphHierarchy::Level& level = m_Hierarchy.GetLevel(index);
+    const Graph& graph = level.graph;
+    LodStream& lod = m_LodStreams[index];
+
+    if (!m_DisplayEdges && !m_DisplayVertices) {
+        return;
+    }
+    // Edges are stored heaviest first, so the budget keeps a prefix;
+    // aggregates are drawn as points from the same positions
+    const std::vector<Vec3f>& positions = graph.GetPositions();
+    const std::vector<uint32_t>& indices = graph.GetEdgeVertices();
+    size_t edgeCount = std::min(graph.GetEdgeCount(), std::max<size_t>(m_LodEdgeBudget, 1));
+    if (!lod.stream->bindGroup || lod.edgeCount != edgeCount) {
+        if (!renderer->CreateLineStream(*lod.stream, positions.data(), positions.size(), indices.data(),
+                                        edgeCount * 2)) {
+            return;
+        }
+        lod.edgeCount = edgeCount;
+        lod.positionVersion = m_Hierarchy.GetPositionVersion();
+        lod.colorUploaded = false;
+    } else if (lod.positionVersion != m_Hierarchy.GetPositionVersion()) {
+        renderer->UpdateLineStreamPositions(*lod.stream, positions.data(), positions.size());
+        lod.positionVersion = m_Hierarchy.GetPositionVersion();
+    }
+
+    if (m_DisplayEdges && edgeCount > 0) {
+        // Per-vertex and per-edge layers do not aggregate: coarse levels
+        // take the uniform edge colour
+        if (!lod.colorUploaded || !(lod.color == m_EdgeColor)) {
+            renderer->SetLineStreamColors(*lod.stream, LineColorMode::Uniform, &m_EdgeColor, 1);
+            lod.color = m_EdgeColor;
+            lod.colorUploaded = true;
+        }
+        renderer->DrawLineStream(*lod.stream);
+    }
+    if (m_DisplayVertices) {
+        renderer->DrawLineStreamPoints(*lod.stream, m_VertexColor, m_VertexSize);
+    }
+}
+
+void ObjGraph::UploadEdgeColors(UnifiedRenderer* renderer) {
+    LineStream& stream = *m_EdgeStream;
+    const std::vector<Color>* colors = nullptr;
+    if (!m_EdgeColorAttribute.empty()) {
+        colors = m_Graph.GetAttributes(m_EdgeColorElement).Get<Color>(m_EdgeColorAttribute);
+    }
+    if (colors && !colors->empty()) {
+        LineColorMode mode = m_EdgeColorElement == GraphElement::Vertex ? LineColorMode::PerVertex : LineColorMode::PerLine;
+        renderer->SetLineStreamColors(stream, mode, colors->data(), colors->size());
+    } else {
+        renderer->SetLineStreamColors(stream, LineColorMode::Uniform, &m_EdgeColor, 1);
+    }
+}
+
+bool ObjGraph::UpdateEdgeStream(UnifiedRenderer* renderer) {
+    LineStream& stream = *m_EdgeStream;
+    const std::vector<Vec3f>& positions = m_Graph.GetPositions();
+
+    if (!stream.bindGroup || m_EdgeTopologyVersion != m_Graph.GetTopologyVersion()) {
+        const std::vector<uint32_t>& indices = m_Graph.GetEdgeVertices();
+        if (!renderer->CreateLineStream(stream, positions.data(), positions.size(), indices.data(), indices.size())) {
+            return false;
+        }
+        m_EdgeTopologyVersion = m_Graph.GetTopologyVersion();
+        m_EdgeColorsDirty = true;
+    } else if (m_EdgeEditCursor != m_Graph.GetEditCursor()) {
+        if (m_Graph.GetEditsSince(m_EdgeEditCursor, m_EditedVertices)) {
+            renderer->UpdateLineStreamPositions(stream, positions.data(), m_EditedVertices);
+        } else {
+            renderer->UpdateLineStreamPositions(stream, positions.data(), positions.size());
+        }
+    }
+    m_EdgeEditCursor = m_Graph.GetEditCursor();
+
+    if (m_EdgeColorsDirty) {
+        UploadEdgeColors(renderer);
+        m_EdgeColorsDirty = false;
+    }
+    return true;
+}
+
+void ObjGraph::Draw(UnifiedRenderer* renderer) {
+    if (!renderer || m_Graph.GetVertexCount() == 0) {
+        return;
+    }
+    if (m_LayoutRunning) {
+        m_Layout.Step(m_Graph, m_LayoutIterations);
+    }
+
+    m_DrawnLod = SelectLod(renderer);
+    if (m_DrawnLod > 0) {
+        DrawLod(renderer, m_DrawnLod - 1);
+        return;
+    }
+
+    // Vertices are drawn from the edge stream's positions
+    if ((m_DisplayEdges || m_DisplayVertices) && UpdateEdgeStream(renderer)) {
+        if (m_DisplayEdges) {
+            renderer->DrawLineStream(*m_EdgeStream);
+        }
+        if (m_DisplayVertices) {
+            renderer->DrawLineStreamPoints(*m_EdgeStream, m_VertexColor, m_VertexSize);
+        }
+    }
+}
+
+} // namespace alice2
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "../../geometry/Graph.h"
+#include "../../geometry/GraphCoarsening.h"
+#include "../../geometry/GraphLayout.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace alice2 {
+
+class UnifiedRenderer;
+struct LineStream;
+
+// Scene object wrapping a Graph with its display settings. Edges and
+// vertices are drawn from a line stream holding the graph's own position
+// array and edge list; it is rebuilt when the topology version changes, and
+// position edits rewrite only the runs of edited vertices. A running layout steps once per
+// Draw, so its positions stream into that buffer frame by frame. Zoomed out,
+// levels of a coarsening hierarchy stand in for the graph: aggregates as
+// points, and their heaviest edges up to a budget, from one line stream per
+// level.
+class ObjGraph {
+public:
+    ObjGraph();
+    ~ObjGraph();
+
+    Graph& GetGraph() { return m_Graph; }
+    const Graph& GetGraph() const { return m_Graph; }
+
+    // Display settings
+    void SetDisplayVertices(bool display) { m_DisplayVertices = display; }
+    void SetDisplayEdges(bool display) { m_DisplayEdges = display; }
+    void SetVertexColor(const Color& color) { m_VertexColor = color; }
+    void SetEdgeColor(const Color& color) { m_EdgeColor = color; m_EdgeColorsDirty = true; }
+    void SetVertexSize(float size) { m_VertexSize = size; }
+
+    bool IsDisplayVertices() const { return m_DisplayVertices; }
+    bool IsDisplayEdges() const { return m_DisplayEdges; }
+
+    // Colours edges from a Color layer, per vertex (blended along each edge)
+    // or per edge; an empty name returns to the edge colour. Layers are read
+    // when set and after MarkEdgeColorsDirty().
+    void SetEdgeColorAttribute(const std::string& name, GraphElement element = GraphElement::Edge);
+    void MarkEdgeColorsDirty() { m_EdgeColorsDirty = true; }
+
+    // Force-directed layout advanced by iterationsPerFrame on every Draw
+    void StartLayout(const GraphLayoutSettings& settings = GraphLayoutSettings(), int iterationsPerFrame = 1);
+    void StopLayout() { m_LayoutRunning = false; }
+    bool IsLayoutRunning() const { return m_LayoutRunning; }
+    GraphLayout& GetLayout() { return m_Layout; }
+    // Multilevel layout through the LOD hierarchy (built if needed), run to
+    // completion with iterationsPerLevel on every level
+    bool RunMultilevelLayout(const GraphLayoutSettings& settings = GraphLayoutSettings(), int iterationsPerLevel = 50);
+
+    // Levels of detail by heavy-edge coarsening. Draw picks the coarsest
+    // level whose aggregates project below the pixel tolerance and draws at
+    // most the budget of its heaviest edges, so zoomed-out views stay
+    // bounded whatever the graph size. Aggregates follow position edits;
+    // topology changes drop the levels.
+    bool GenerateLods(const GraphCoarseningSettings& settings = GraphCoarseningSettings());
+    void ClearLods();
+    void SetLodTolerance(float pixels) { m_LodTolerance = pixels; }
+    float GetLodTolerance() const { return m_LodTolerance; }
+    void SetLodEdgeBudget(size_t edges) { m_LodEdgeBudget = edges; }
+    size_t GetLodEdgeBudget() const { return m_LodEdgeBudget; }
+    size_t GetLodCount() const { return m_Hierarchy.GetLevelCount(); }
+    size_t GetDrawnLod() const { return m_DrawnLod; } // 0 = full graph
+    const GraphHierarchy& GetHierarchy() const { return m_Hierarchy; }
+
+    void Draw(UnifiedRenderer* renderer);
+
+private:
+    Graph m_Graph;
+
+    bool m_DisplayVertices = true;
+    bool m_DisplayEdges = true;
+    Color m_VertexColor = Color::Red();
+    Color m_EdgeColor = Color::Black();
+    float m_VertexSize = 3.0f; // Pixels across
+
+    GraphLayout m_Layout;
+    bool m_LayoutRunning = false;
+    int m_LayoutIterations = 1;
+
+    // Line stream of one coarse level, with what it last received
+    struct LodStream {
+        std::unique_ptr<LineStream> stream;
+        uint64_t positionVersion = ~uint64_t(0);
+        size_t edgeCount = 0;
+        Color color;                // Edge colour last uploaded
+        bool colorUploaded = false; // Cleared whenever the stream is recreated
+    };
+
+    GraphHierarchy m_Hierarchy;
+    std::vector<LodStream> m_LodStreams;
+    uint64_t m_LodEditCursor = 0;
+    float m_LodTolerance = 2.0f;
+    size_t m_LodEdgeBudget = 1 << 18;
+    size_t m_DrawnLod = 0;
+
+    std::unique_ptr<LineStream> m_EdgeStream;
+    std::string m_EdgeColorAttribute;
+    GraphElement m_EdgeColorElement = GraphElement::Edge;
+    std::vector<uint32_t> m_EditedVertices;
+    uint64_t m_EdgeTopologyVersion = ~uint64_t(0);
+    uint64_t m_EdgeEditCursor = ~uint64_t(0);
+    bool m_EdgeColorsDirty = true;
+
+    size_t SelectLod(UnifiedRenderer* renderer);
+    void DrawLod(UnifiedRenderer* renderer, size_t level);
+    bool UpdateEdgeStream(UnifiedRenderer* renderer);
+    void UploadEdgeColors(UnifiedRenderer* renderer);
+};
+
+} // namespace alice2
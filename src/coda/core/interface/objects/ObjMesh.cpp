@@ -0,0 +1,416 @@
+#include "ObjMesh.h"
+#include "../functionset/FnMesh.h"
+#include "../../../../renderer/unified_renderer.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace alice2 {
+
+namespace {
+
+// Fixed directional shading so faces read without a lighting pipeline
+Color ShadeColor(const Color& color, const Vec3f& normal) {
+    static const Vec3f light = Vec3f(0.3f, 1.0f, 0.5f).Normalize();
+    float shade = 0.4f + 0.6f * std::abs(normal.Dot(light));
+    return Color(color.r * shade, color.g * shade, color.b * shade, color.a);
+}
+
+} // namespace
+
+ObjMesh::ObjMesh()
+    : m_FaceBuffers(std::make_unique<IndexedMesh>()), m_EdgeStream(std::make_unique<LineStream>()),
+      m_SubdivisionBuffers(std::make_unique<IndexedMesh>()) {}
+
+ObjMesh::~ObjMesh() {
+    UnifiedRenderer::ReleaseIndexedMesh(*m_FaceBuffers);
+    UnifiedRenderer::ReleaseLineStream(*m_EdgeStream);
+    UnifiedRenderer::ReleaseIndexedMesh(*m_SubdivisionBuffers);
+    ClearLods();
+}
+
+void ObjMesh::UpdateRenderCache() {
+    if (m_CachedTopologyVersion == m_Mesh.GetTopologyVersion()) {
+        return;
+    }
+    FnMesh fnMesh(m_Mesh);
+    fnMesh.GetTriangleIndices(m_TriangleIndices);
+    fnMesh.GetEdgeIndices(m_EdgeIndices);
+    m_CachedTopologyVersion = m_Mesh.GetTopologyVersion();
+}
+
+void ObjMesh::SetFeatureEdges(bool enabled, const FeatureEdgeSettings& settings) {
+    m_DisplayFeatureEdges = enabled;
+    m_FeatureSettings = settings;
+    m_EdgeIndicesDirty = true;
+}
+
+void ObjMesh::SetEdgeColorAttribute(const std::string& name, MeshElement element) {
+    m_EdgeColorAttribute = name;
+    m_EdgeColorElement = element;
+    m_EdgeColorsDirty = true;
+}
+
+const MeshNormals& ObjMesh::GetNormals() {
+    m_Normals.Update(m_Mesh);
+    return m_Normals;
+}
+
+bool ObjMesh::GenerateLods(float ratio, size_t minTriangles) {
+    ClearLods();
+    MeshSimplifier simplifier;
+    if (!simplifier.Load(m_Mesh)) {
+        return false;
+    }
+    simplifier.BuildLodChain(m_Lods, ratio, minTriangles);
+    m_LodBuffers.resize(m_Lods.size());
+
+    Vec3f minBound, maxBound;
+    FnMesh(m_Mesh).GetBounds(minBound, maxBound);
+    m_LodCenter = (minBound + maxBound) * 0.5f;
+    m_LodRadius = (maxBound - minBound).Length() * 0.5f;
+    m_LodTopologyVersion = m_Mesh.GetTopologyVersion();
+    m_LodEditCursor = m_Mesh.GetEditCursor();
+    return !m_Lods.empty();
+}
+
+void ObjMesh::ClearLods() {
+    for (LodBuffers& buffers : m_LodBuffers) {
+        if (buffers.faces) {
+            UnifiedRenderer::ReleaseIndexedMesh(*buffers.faces);
+        }
+        if (buffers.edges) {
+            UnifiedRenderer::ReleaseLineStream(*buffers.edges);
+        }
+    }
+    m_LodBuffers.clear();
+    m_Lods.clear();
+    m_DrawnLod = 0;
+}
+
+size_t ObjMesh::SelectLod(UnifiedRenderer* renderer) {
+    if (m_Lods.empty()) {
+        return 0;
+    }
+    if (m_LodTopologyVersion != m_Mesh.GetTopologyVersion() || m_LodEditCursor != m_Mesh.GetEditCursor()) {
+        ClearLods();
+        return 0;
+    }
+
+    // Errors grow with the level, so take the last one still within tolerance
+    float pixelsPerUnit = renderer->GetPixelsPerUnit(m_LodCenter, m_LodRadius);
+    size_t level = 0;
+    while (level < m_Lods.size() && m_Lods[level].error * pixelsPerUnit <= m_LodTolerance) {
+        ++level;
+    }
+    return level;
+}
+
+void ObjMesh::DrawLod(UnifiedRenderer* renderer, size_t level) {
+    const MeshLod& lod = m_Lods[level];
+    LodBuffers& buffers = m_LodBuffers[level];
+
+    if (m_DisplayFaces && !lod.triangles.empty()) {
+        if (!buffers.faces) {
+            buffers.faces = std::make_unique<IndexedMesh>();
+        }
+        bool upload = !buffers.faces->vertexBuffer;
+        if (upload || buffers.colorVersion != m_ColorVersion) {
+            // Area-weighted vertex normals, as for the full mesh
+            std::vector<Vec3f> normals(lod.positions.size(), Vec3f(0.0f, 0.0f, 0.0f));
+            for (size_t i = 0; i + 2 < lod.triangles.size(); i += 3) {
+                uint32_t a = lod.triangles[i], b = lod.triangles[i + 1], c = lod.triangles[i + 2];
+                Vec3f normal = (lod.positions[b] - lod.positions[a]).Cross(lod.positions[c] - lod.positions[a]);
+                normals[a] += normal;
+                normals[b] += normal;
+                normals[c] += normal;
+            }
+            m_LodVertices.resize(lod.positions.size());
+            for (size_t i = 0; i < lod.positions.size(); ++i) {
+                m_LodVertices[i].position = lod.positions[i];
+                m_LodVertices[i].color = ShadeColor(m_FaceColor, normals[i].Normalize());
+                m_LodVertices[i].size = 1.0f;
+            }
+            if (upload) {
+                if (!renderer->CreateIndexedMesh(*buffers.faces, m_LodVertices.data(), m_LodVertices.size(),
+                                                 lod.triangles.data(), lod.triangles.size())) {
+                    return;
+                }
+            } else {
+                renderer->UpdateIndexedMeshVertices(*buffers.faces, m_LodVertices.data(), m_LodVertices.size());
+            }
+            buffers.colorVersion = m_ColorVersion;
+        }
+        renderer->DrawIndexedMesh(*buffers.faces);
+    }
+
+    if (m_DisplayEdges || m_DisplayVertices) {
+        if (!buffers.edges) {
+            buffers.edges = std::make_unique<LineStream>();
+        }
+        LineStream& stream = *buffers.edges;
+        if (!stream.bindGroup) {
+            if (!renderer->CreateLineStream(stream, lod.positions.data(), lod.positions.size(), lod.edges.data(),
+                                            lod.edges.size())) {
+                return;
+            }
+            buffers.edgeColorUploaded = false;
+        }
+        if (!buffers.edgeColorUploaded || !(buffers.edgeColor == m_EdgeColor)) {
+            renderer->SetLineStreamColors(stream, LineColorMode::Uniform, &m_EdgeColor, 1);
+            buffers.edgeColor = m_EdgeColor;
+            buffers.edgeColorUploaded = true;
+        }
+        if (m_DisplayEdges) {
+            renderer->DrawLineStream(stream);
+        }
+        if (m_DisplayVertices) {
+            renderer->DrawLineStreamPoints(stream, m_VertexColor, m_VertexSize);
+        }
+    }
+}
+
+bool ObjMesh::SetSubdivision(SubdivisionScheme scheme, int levels, const std::vector<float>& creases) {
+    ClearSubdivision();
+    if (!m_Subdivision.Build(m_Mesh, scheme, levels, creases)) {
+        return false;
+    }
+    // Shading comes from the surface as built; cage edits only move it
+    const Mesh& refined = m_Subdivision.GetRefinedMesh();
+    m_SubdivisionNormals.Update(refined);
+    m_SubdivisionVertices.resize(refined.GetVertexCount());
+    m_SubdivisionTopologyVersion = m_Mesh.GetTopologyVersion();
+    return true;
+}
+
+void ObjMesh::ClearSubdivision() {
+    m_Subdivision.Clear();
+    m_SubdivisionNormals.Invalidate();
+    m_SubdivisionVertices.clear();
+    UnifiedRenderer::ReleaseIndexedMesh(*m_SubdivisionBuffers);
+    m_SubdivisionEditCursor = ~uint64_t(0);
+    m_SubdivisionColorVersion = 0;
+}
+
+void ObjMesh::DrawSubdivision(UnifiedRenderer* renderer) {
+    IndexedMesh& buffers = *m_SubdivisionBuffers;
+    bool recolor = m_SubdivisionColorVersion != m_ColorVersion;
+    if (recolor) {
+        const std::vector<Vec3f>& normals = m_SubdivisionNormals.GetVertexNormals();
+        for (size_t i = 0; i < m_SubdivisionVertices.size(); ++i) {
+            m_SubdivisionVertices[i].color = ShadeColor(m_FaceColor, normals[i]);
+            m_SubdivisionVertices[i].size = 1.0f;
+        }
+        m_SubdivisionColorVersion = m_ColorVersion;
+    }
+    bool moved = m_SubdivisionEditCursor != m_Mesh.GetEditCursor() || !buffers.vertexBuffer;
+    if (moved) {
+        // Cage moved: one sparse mat-vec straight into the vertex positions
+        m_Subdivision.Evaluate(m_Mesh.GetPositions().data(), m_SubdivisionVertices.data(), sizeof(Vertex));
+        m_SubdivisionEditCursor = m_Mesh.GetEditCursor();
+    }
+    if (moved || recolor) {
+        const std::vector<uint32_t>& indices = m_Subdivision.GetTriangleIndices();
+        if (buffers.vertexBuffer) {
+            renderer->UpdateIndexedMeshVertices(buffers, m_SubdivisionVertices.data(), m_SubdivisionVertices.size());
+        } else if (!renderer->CreateIndexedMesh(buffers, m_SubdivisionVertices.data(), m_SubdivisionVertices.size(),
+                                                indices.data(), indices.size())) {
+            m_SubdivisionEditCursor = ~uint64_t(0);
+            return;
+        }
+    }
+    renderer->DrawIndexedMesh(buffers);
+}
+
+void ObjMesh::DrawFaces(UnifiedRenderer* renderer) {
+    IndexedMesh& buffers = *m_FaceBuffers;
+    const std::vector<Vec3f>& positions = m_Mesh.GetPositions();
+    const std::vector<Vec3f>& normals = GetNormals().GetVertexNormals();
+    auto shade = [&](uint32_t vertex) {
+        Vertex& out = m_FaceVertices[vertex];
+        out.position = positions[vertex];
+        out.color = ShadeColor(m_FaceColor, normals[vertex]);
+        out.size = 1.0f;
+    };
+
+    bool rebuild = !buffers.vertexBuffer || m_FaceTopologyVersion != m_Mesh.GetTopologyVersion();
+    bool recolor = m_FaceColorVersion != m_ColorVersion;
+    if (rebuild || recolor || m_FaceEditCursor != m_Mesh.GetEditCursor()) {
+        if (!rebuild && !recolor && m_Mesh.GetEditsSince(m_FaceEditCursor, m_EditedVertices)) {
+            // A moved vertex turns the faces around it, and with them the
+            // normals of all their corners
+            m_ShadedVertices.clear();
+            for (uint32_t vertex : m_EditedVertices) {
+                uint32_t start = m_Mesh.VertexHalfEdge(vertex);
+                if (start == INVALID_INDEX) {
+                    m_ShadedVertices.push_back(vertex);
+                    continue;
+                }
+                uint32_t h = start;
+                do {
+                    if (!m_Mesh.IsBoundaryHalfEdge(h)) {
+                        uint32_t corner = h;
+                        do {
+                            m_ShadedVertices.push_back(m_Mesh.Source(corner));
+                            corner = m_Mesh.Next(corner);
+                        } while (corner != h);
+                    }
+                    h = m_Mesh.Next(m_Mesh.Twin(h));
+                } while (h != start);
+            }
+            for (uint32_t vertex : m_ShadedVertices) {
+                shade(vertex);
+            }
+            renderer->UpdateIndexedMeshVertices(buffers, m_FaceVertices.data(), m_ShadedVertices);
+        } else {
+            m_FaceVertices.resize(positions.size());
+            for (uint32_t vertex = 0; vertex < positions.size(); ++vertex) {
+                shade(vertex);
+            }
+            if (rebuild) {
+                if (!renderer->CreateIndexedMesh(buffers, m_FaceVertices.data(), m_FaceVertices.size(),
+                                                 m_TriangleIndices.data(), m_TriangleIndices.size())) {
+                    return;
+                }
+                m_FaceTopologyVersion = m_Mesh.GetTopologyVersion();
+            } else {
+                renderer->UpdateIndexedMeshVertices(buffers, m_FaceVertices.data(), m_FaceVertices.size());
+            }
+        }
+        m_FaceEditCursor = m_Mesh.GetEditCursor();
+        m_FaceColorVersion = m_ColorVersion;
+    }
+    renderer->DrawIndexedMesh(buffers);
+}
+
+void ObjMesh::UploadEdgeColors(UnifiedRenderer* renderer) {
+    LineStream& stream = *m_EdgeStream;
+    const std::vector<Color>* colors = nullptr;
+    if (!m_EdgeColorAttribute.empty() &&
+        (m_EdgeColorElement == MeshElement::Vertex || m_EdgeColorElement == MeshElement::Edge)) {
+        colors = m_Mesh.GetAttributes(m_EdgeColorElement).Get<Color>(m_EdgeColorAttribute);
+    }
+    if (!colors || colors->empty()) {
+        renderer->SetLineStreamColors(stream, LineColorMode::Uniform, &m_EdgeColor, 1);
+        return;
+    }
+    if (m_EdgeColorElement == MeshElement::Vertex) {
+        renderer->SetLineStreamColors(stream, LineColorMode::PerVertex, colors->data(), colors->size());
+        return;
+    }
+    // All edges are listed in edge order; a feature set needs its subset
+    if (m_DisplayFeatureEdges) {
+        const std::vector<uint32_t>& edges = m_FeatureEdges.GetEdges();
+        m_FeatureEdgeColors.resize(edges.size());
+        for (size_t i = 0; i < edges.size(); ++i) {
+            m_FeatureEdgeColors[i] = (*colors)[edges[i]];
+        }
+        colors = &m_FeatureEdgeColors;
+    }
+    if (!colors->empty()) {
+        renderer->SetLineStreamColors(stream, LineColorMode::PerLine, colors->data(), colors->size());
+    }
+}
+
+bool ObjMesh::UpdateEdgeStream(UnifiedRenderer* renderer) {
+    LineStream& stream = *m_EdgeStream;
+    const std::vector<Vec3f>& positions = m_Mesh.GetPositions();
+    bool rebuild = !stream.bindGroup || m_EdgeTopologyVersion != m_Mesh.GetTopologyVersion();
+    bool moved = m_EdgeEditCursor != m_Mesh.GetEditCursor();
+    bool indicesChanged = rebuild || m_EdgeIndicesDirty;
+    bool edges = m_DisplayEdges && !m_EdgeIndices.empty();
+
+    const std::vector<uint32_t>* indices = &m_EdgeIndices;
+    if (m_DisplayFeatureEdges && edges) {
+        // Silhouettes follow the camera, so they are reclassified every frame
+        FeatureEdgeSettings settings = m_FeatureSettings;
+        if (settings.silhouette) {
+            settings.orthographic = !renderer->GetViewOrigin(settings.viewOrigin);
+        }
+        if (settings.silhouette || moved || indicesChanged) {
+            m_FeatureEdges.Extract(m_Mesh, settings);
+            indicesChanged = true;
+        }
+        indices = &m_FeatureEdges.GetIndices();
+    }
+
+    if (rebuild) {
+        // Feature sets may start empty; the index buffer grows on demand
+        if (!renderer->CreateLineStream(stream, positions.data(), positions.size(), m_EdgeIndices.data(),
+                                        m_EdgeIndices.size())) {
+            return false;
+        }
+        m_EdgeTopologyVersion = m_Mesh.GetTopologyVersion();
+        m_EdgeColorsDirty = true;
+    } else if (moved) {
+        if (m_Mesh.GetEditsSince(m_EdgeEditCursor, m_EditedVertices)) {
+            renderer->UpdateLineStreamPositions(stream, positions.data(), m_EditedVertices);
+        } else {
+            renderer->UpdateLineStreamPositions(stream, positions.data(), positions.size());
+        }
+    }
+    m_EdgeEditCursor = m_Mesh.GetEditCursor();
+    if (!edges) {
+        // Hidden edges skip classification and catch up once they show again
+        m_EdgeIndicesDirty = m_EdgeIndicesDirty || indicesChanged || (m_DisplayFeatureEdges && moved);
+        return true;
+    }
+
+    // A rebuilt stream already holds the full edge list
+    if (indicesChanged && !(rebuild && indices == &m_EdgeIndices)) {
+        if (!renderer->UpdateLineStreamIndices(stream, indices->data(), indices->size())) {
+            return false;
+        }
+    }
+    // Per-edge colours follow the listed edges
+    if (indicesChanged && m_EdgeColorElement == MeshElement::Edge && !m_EdgeColorAttribute.empty()) {
+        m_EdgeColorsDirty = true;
+    }
+    if (m_EdgeColorsDirty) {
+        UploadEdgeColors(renderer);
+    }
+    m_EdgeColorsDirty = false;
+    m_EdgeIndicesDirty = false;
+    return true;
+}
+
+void ObjMesh::Draw(UnifiedRenderer* renderer) {
+    if (!renderer || m_Mesh.GetVertexCount() == 0) {
+        return;
+    }
+
+    bool drawFaces = m_DisplayFaces;
+    if (m_Subdivision.IsValid() && m_SubdivisionTopologyVersion != m_Mesh.GetTopologyVersion()) {
+        ClearSubdivision();
+    }
+    if (m_Subdivision.IsValid()) {
+        m_DrawnLod = 0;
+        if (drawFaces) {
+            DrawSubdivision(renderer);
+            drawFaces = false;
+        }
+    } else {
+        m_DrawnLod = SelectLod(renderer);
+        if (m_DrawnLod > 0) {
+            DrawLod(renderer, m_DrawnLod - 1);
+            return;
+        }
+    }
+    UpdateRenderCache();
+
+    if (drawFaces && !m_TriangleIndices.empty()) {
+        DrawFaces(renderer);
+    }
+
+    // Vertices are drawn from the edge stream's positions
+    if ((m_DisplayEdges || m_DisplayVertices) && UpdateEdgeStream(renderer)) {
+        if (m_DisplayEdges) {
+            renderer->DrawLineStream(*m_EdgeStream);
+        }
+        if (m_DisplayVertices) {
+            renderer->DrawLineStreamPoints(*m_EdgeStream, m_VertexColor, m_VertexSize);
+        }
+    }
+}
+
+} // namespace alice2
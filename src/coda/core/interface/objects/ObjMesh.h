@@ -0,0 +1,165 @@
+#pragma once
+
+#include "../../geometry/Mesh.h"
+#include "../../geometry/MeshFeatures.h"
+#include "../../geometry/MeshNormals.h"
+#include "../../geometry/MeshSimplify.h"
+#include "../../geometry/Subdivision.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace alice2 {
+
+class UnifiedRenderer;
+struct Vertex;
+struct IndexedMesh;
+struct LineStream;
+
+// Scene object wrapping a Mesh with its display settings. Faces, edges and
+// vertices stay on the GPU: index buffers are rebuilt only when the mesh
+// topology version changes, and vertex edits rewrite only the edited
+// vertices (for the smooth-shaded faces, with the corners of the faces
+// around them, whose normals the incremental normal cache recomputed).
+class ObjMesh {
+public:
+    ObjMesh();
+    ~ObjMesh();
+
+    Mesh& GetMesh() { return m_Mesh; }
+    const Mesh& GetMesh() const { return m_Mesh; }
+
+    // Display settings
+    void SetDisplayVertices(bool display) { m_DisplayVertices = display; }
+    void SetDisplayEdges(bool display) { m_DisplayEdges = display; }
+    void SetDisplayFaces(bool display) { m_DisplayFaces = display; }
+    void SetVertexColor(const Color& color) { m_VertexColor = color; }
+    void SetEdgeColor(const Color& color) { m_EdgeColor = color; m_EdgeColorsDirty = true; }
+    void SetFaceColor(const Color& color) { m_FaceColor = color; ++m_ColorVersion; }
+    void SetVertexSize(float size) { m_VertexSize = size; }
+
+    bool IsDisplayVertices() const { return m_DisplayVertices; }
+    bool IsDisplayEdges() const { return m_DisplayEdges; }
+    bool IsDisplayFaces() const { return m_DisplayFaces; }
+
+    // Restricts displayed edges to sharp, boundary, crease and (per frame,
+    // from the renderer's camera) silhouette edges. Edges, all or features,
+    // are drawn once each from a line stream over the mesh positions, and
+    // vertex edits rewrite only the runs of edited vertices.
+    void SetFeatureEdges(bool enabled, const FeatureEdgeSettings& settings = FeatureEdgeSettings());
+    bool IsFeatureEdges() const { return m_DisplayFeatureEdges; }
+
+    // Colours edges from a Color layer on vertices (blended along each edge)
+    // or edges; an empty name returns to the edge colour. Layers are read
+    // when set and after MarkEdgeColorsDirty().
+    void SetEdgeColorAttribute(const std::string& name, MeshElement element = MeshElement::Edge);
+    void MarkEdgeColorsDirty() { m_EdgeColorsDirty = true; }
+    const FeatureEdges& GetFeatureEdges() const { return m_FeatureEdges; }
+
+    // Normals brought up to date with the mesh edit log
+    const MeshNormals& GetNormals();
+
+    // Levels of detail simplified from the mesh, each keeping ratio of the
+    // previous level's triangles. Draw picks the coarsest level whose error
+    // projects below the pixel tolerance. Any mesh edit drops them.
+    bool GenerateLods(float ratio = 0.5f, size_t minTriangles = 1024);
+    void ClearLods();
+    void SetLodTolerance(float pixels) { m_LodTolerance = pixels; }
+    float GetLodTolerance() const { return m_LodTolerance; }
+    size_t GetLodCount() const { return m_Lods.size(); }
+    size_t GetDrawnLod() const { return m_DrawnLod; } // 0 = full mesh
+
+    // Smooth display of the mesh as a subdivision cage. The refined surface
+    // is re-evaluated through precomputed stencils when the cage moves,
+    // straight into the uploaded vertices; its shading is taken once, from
+    // the surface as built. Edges and vertices still show the cage.
+    // Topology changes drop it.
+    bool SetSubdivision(SubdivisionScheme scheme, int levels, const std::vector<float>& creases = {});
+    void ClearSubdivision();
+    int GetSubdivisionLevels() const { return m_Subdivision.GetLevels(); }
+
+    void Draw(UnifiedRenderer* renderer);
+
+private:
+    Mesh m_Mesh;
+
+    bool m_DisplayVertices = false;
+    bool m_DisplayEdges = true;
+    bool m_DisplayFaces = true;
+    Color m_VertexColor = Color::Red();
+    Color m_EdgeColor = Color::Black();
+    Color m_FaceColor = Color::Gray();
+    float m_VertexSize = 3.0f; // Pixels across
+
+    // Cached render data
+    uint64_t m_CachedTopologyVersion = ~uint64_t(0);
+    std::vector<uint32_t> m_TriangleIndices;
+    std::vector<uint32_t> m_EdgeIndices;
+    MeshNormals m_Normals;
+    uint64_t m_ColorVersion = 1; // Bumped by SetFaceColor
+
+    // Faces as an indexed mesh over the mesh vertices, shaded by vertex normal
+    std::unique_ptr<IndexedMesh> m_FaceBuffers;
+    std::vector<Vertex> m_FaceVertices;
+    std::vector<uint32_t> m_ShadedVertices;
+    uint64_t m_FaceTopologyVersion = ~uint64_t(0);
+    uint64_t m_FaceEditCursor = ~uint64_t(0);
+    uint64_t m_FaceColorVersion = 0;
+
+    // Edge lines and vertex points; positions follow the mesh, indices the
+    // edge selection
+    bool m_DisplayFeatureEdges = false;
+    FeatureEdgeSettings m_FeatureSettings;
+    FeatureEdges m_FeatureEdges;
+    std::unique_ptr<LineStream> m_EdgeStream;
+    std::string m_EdgeColorAttribute;
+    MeshElement m_EdgeColorElement = MeshElement::Edge;
+    std::vector<Color> m_FeatureEdgeColors; // Edge layer gathered for feature edges
+    std::vector<uint32_t> m_EditedVertices;
+    uint64_t m_EdgeTopologyVersion = ~uint64_t(0);
+    uint64_t m_EdgeEditCursor = ~uint64_t(0);
+    bool m_EdgeColorsDirty = true;
+    bool m_EdgeIndicesDirty = true;
+
+    // Level of detail chain; valid while the mesh is unchanged. Each level
+    // is uploaded once, when first drawn
+    struct LodBuffers {
+        std::unique_ptr<IndexedMesh> faces;
+        std::unique_ptr<LineStream> edges;
+        uint64_t colorVersion = 0;
+        Color edgeColor;                // Edge colour last uploaded
+        bool edgeColorUploaded = false; // Cleared whenever the stream is recreated
+    };
+    std::vector<MeshLod> m_Lods;
+    std::vector<LodBuffers> m_LodBuffers;
+    std::vector<Vertex> m_LodVertices;
+    uint64_t m_LodTopologyVersion = 0;
+    uint64_t m_LodEditCursor = 0;
+    Vec3f m_LodCenter;
+    float m_LodRadius = 0.0f;
+    float m_LodTolerance = 1.0f;
+    size_t m_DrawnLod = 0;
+
+    // Subdivision surface; GPU buffers are rewritten only after cage edits
+    // and face colour changes
+    SubdivisionStencils m_Subdivision;
+    MeshNormals m_SubdivisionNormals; // Of the refined mesh as built
+    std::vector<Vertex> m_SubdivisionVertices;
+    std::unique_ptr<IndexedMesh> m_SubdivisionBuffers;
+    uint64_t m_SubdivisionTopologyVersion = 0;
+    uint64_t m_SubdivisionEditCursor = ~uint64_t(0);
+    uint64_t m_SubdivisionColorVersion = 0;
+
+    void UpdateRenderCache();
+    size_t SelectLod(UnifiedRenderer* renderer);
+    void DrawLod(UnifiedRenderer* renderer, size_t level);
+    void DrawSubdivision(UnifiedRenderer* renderer);
+    void DrawFaces(UnifiedRenderer* renderer);
+    // Brings the edge stream's positions, and while edges show its indices
+    // and colours, up to date; false when it could not be created
+    bool UpdateEdgeStream(UnifiedRenderer* renderer);
+    void UploadEdgeColors(UnifiedRenderer* renderer);
+};
+
+} // namespace alice2
@@ -0,0 +1,242 @@
+#include "ObjPointCloud.h"
+#include "../../../../renderer/unified_renderer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <queue>
+#include <utility>
+
+namespace alice2 {
+
+namespace {
+
+// Points per pool block; a node wastes less than one block
+constexpr size_t BlockPoints = 4096;
+// Requests handed to the loader per frame
+constexpr size_t MaxRequests = 64;
+
+} // namespace
+
+ObjPointCloud::ObjPointCloud()
+    : m_Pool(std::make_unique<PointPool>()) {}
+
+ObjPointCloud::~ObjPointCloud() {
+    Close();
+}
+
+bool ObjPointCloud::Open(const std::string& path) {
+    Close();
+    if (!m_Octree.Open(path)) {
+        return false;
+    }
+    m_States.assign(m_Octree.GetNodeCount(), NodeState());
+    m_Loader = std::make_unique<PointOctreeLoader>(m_Octree);
+    return true;
+}
+
+void ObjPointCloud::Close() {
+    // The loader reads from the octree, so it stops first
+    m_Loader.reset();
+    UnifiedRenderer::ReleasePointPool(*m_Pool);
+    m_Octree.Close();
+    m_States.clear();
+    m_BlockNext.clear();
+    m_FreeBlock = INVALID_INDEX;
+    m_FreeBlockCount = 0;
+    m_Newest = m_Oldest = INVALID_INDEX;
+    m_ResidentCount = 0;
+    m_DrawList.clear();
+    m_Wanted.clear();
+    m_DrawnPoints = 0;
+    m_Loaded.clear();
+}
+
+bool ObjPointCloud::CreatePool(UnifiedRenderer* renderer) {
+    size_t blockCount = std::max<size_t>(m_MemoryBudget / (BlockPoints * sizeof(OctreePoint)), 1);
+    if (!renderer->CreatePointPool(*m_Pool, blockCount, BlockPoints)) {
+        return false;
+    }
+    // Every block starts on the free list
+    m_BlockNext.resize(blockCount);
+    for (size_t b = 0; b < blockCount; ++b) {
+        m_BlockNext[b] = b + 1 < blockCount ? uint32_t(b + 1) : INVALID_INDEX;
+    }
+    m_FreeBlock = 0;
+    m_FreeBlockCount = uint32_t(blockCount);
+    return true;
+}
+
+void ObjPointCloud::Unlink(uint32_t node) {
+    NodeState& state = m_States[node];
+    (state.newer != INVALID_INDEX ? m_States[state.newer].older : m_Newest) = state.older;
+    (state.older != INVALID_INDEX ? m_States[state.older].newer : m_Oldest) = state.newer;
+    state.newer = state.older = INVALID_INDEX;
+}
+
+void ObjPointCloud::Touch(uint32_t node) {
+    NodeState& state = m_States[node];
+    state.lastUsed = m_Frame;
+    if (m_Newest == node) {
+        return;
+    }
+    if (state.newer != INVALID_INDEX || state.older != INVALID_INDEX) {
+        Unlink(node);
+    }
+    state.older = m_Newest;
+    if (m_Newest != INVALID_INDEX) {
+        m_States[m_Newest].newer = node;
+    }
+    m_Newest = node;
+    if (m_Oldest == INVALID_INDEX) {
+        m_Oldest = node;
+    }
+}
+
+void ObjPointCloud::Evict(uint32_t node) {
+    NodeState& state = m_States[node];
+    Unlink(node);
+    uint32_t block = state.firstBlock;
+    while (block != INVALID_INDEX) {
+        uint32_t next = m_BlockNext[block];
+        m_BlockNext[block] = m_FreeBlock;
+        m_FreeBlock = block;
+        ++m_FreeBlockCount;
+        block = next;
+    }
+    state.firstBlock = INVALID_INDEX;
+    state.resident = false;
+    --m_ResidentCount;
+}
+
+bool ObjPointCloud::MakeResident(UnifiedRenderer* renderer, uint32_t node, const std::vector<OctreePoint>& points) {
+    NodeState& state = m_States[node];
+    if (state.resident) {
+        return true;
+    }
+    // Nodes used last frame and this one are likely to be drawn, so only
+    // older ones make room
+    const uint32_t needed = uint32_t((points.size() + BlockPoints - 1) / BlockPoints);
+    while (m_FreeBlockCount < needed && m_Oldest != INVALID_INDEX && m_States[m_Oldest].lastUsed + 1 < m_Frame) {
+        Evict(m_Oldest);
+    }
+    if (m_FreeBlockCount < needed) {
+        return false;
+    }
+    uint32_t* link = &state.firstBlock;
+    for (size_t first = 0; first < points.size(); first += BlockPoints) {
+        uint32_t block = m_FreeBlock;
+        m_FreeBlock = m_BlockNext[block];
+        --m_FreeBlockCount;
+        *link = block;
+        link = &m_BlockNext[block];
+        renderer->UpdatePointPoolBlock(*m_Pool, block, points.data() + first,
+                                       std::min(BlockPoints, points.size() - first));
+    }
+    *link = INVALID_INDEX;
+    state.resident = true;
+    ++m_ResidentCount;
+    Touch(node);
+    return true;
+}
+
+void ObjPointCloud::Upload(UnifiedRenderer* renderer) {
+    m_Loaded.clear();
+    m_Loader->TakeLoaded(m_Loaded, m_UploadBudget);
+    for (PointOctreeLoader::LoadedNode& loaded : m_Loaded) {
+        // A node that does not fit now is dropped and requested again
+        MakeResident(renderer, loaded.node, loaded.points);
+        m_Loader->Recycle(std::move(loaded.points));
+    }
+    m_Loaded.clear();
+}
+
+void ObjPointCloud::Select(UnifiedRenderer* renderer) {
+    const std::vector<PointOctreeNode>& nodes = m_Octree.GetNodes();
+    m_DrawList.clear();
+    m_Wanted.clear();
+    m_DrawnPoints = 0;
+
+    // Drawn nodes stay resident together, so they may fill at most three
+    // quarters of the pool, leaving room for the nodes on their way in
+    const size_t maxBlocks = std::max<size_t>(size_t(m_Pool->blockCount) / 4 * 3, 1);
+    size_t blocks = 0;
+
+    auto sphere = [&](uint32_t node, Vec3f& center, float& radius) {
+        Vec3f min, max;
+        m_Octree.GetNodeBounds(node, min, max);
+        center = (min + max) * 0.5f;
+        radius = 0.8660254f * m_Octree.GetNodeSize(node);
+    };
+
+    // Largest projected size first; nodes reaching the camera plane project infinitely large
+    std::priority_queue<std::pair<float, uint32_t>> queue;
+    Vec3f center;
+    float radius;
+    sphere(0, center, radius);
+    if (renderer->IsSphereVisible(center, radius)) {
+        queue.push({0.0f, 0});
+    }
+    while (!queue.empty()) {
+        const uint32_t node = queue.top().second;
+        queue.pop();
+        const PointOctreeNode& n = nodes[node];
+        const size_t nodeBlocks = (n.count + BlockPoints - 1) / BlockPoints;
+        if (m_DrawnPoints + n.count > m_PointBudget || blocks + nodeBlocks > maxBlocks) {
+            break;
+        }
+        NodeState& state = m_States[node];
+        if (!state.resident) {
+            // Empty nodes need no load
+            if (n.count > 0) {
+                if (m_Wanted.size() < MaxRequests) {
+                    m_Wanted.push_back(node);
+                }
+                continue;
+            }
+            state.resident = true;
+            ++m_ResidentCount;
+        }
+        Touch(node);
+        m_DrawList.push_back(node);
+        m_DrawnPoints += n.count;
+        blocks += nodeBlocks;
+
+        sphere(node, center, radius);
+        if (n.childMask == 0 ||
+            m_Octree.GetNodeSpacing(node) * renderer->GetPixelsPerUnit(center, radius) <= m_ErrorTolerance) {
+            continue;
+        }
+        for (uint32_t c = 0; c < n.GetChildCount(); ++c) {
+            const uint32_t child = n.firstChild + c;
+            sphere(child, center, radius);
+            if (renderer->IsSphereVisible(center, radius)) {
+                queue.push({radius * renderer->GetPixelsPerUnit(center, radius), child});
+            }
+        }
+    }
+    m_Loader->Request(m_Wanted);
+}
+
+void ObjPointCloud::Draw(UnifiedRenderer* renderer) {
+    if (!renderer || !m_Octree.IsOpen() || !m_Loader) {
+        return;
+    }
+    if (m_Pool->bindGroups.empty() && !CreatePool(renderer)) {
+        return;
+    }
+    ++m_Frame;
+    Upload(renderer);
+    Select(renderer);
+
+    for (uint32_t node : m_DrawList) {
+        size_t remaining = m_Octree.GetNodes()[node].count;
+        for (uint32_t block = m_States[node].firstBlock; block != INVALID_INDEX && remaining > 0;
+             block = m_BlockNext[block]) {
+            uint32_t count = uint32_t(std::min(remaining, BlockPoints));
+            renderer->DrawPointPoolBlock(*m_Pool, block, count);
+            remaining -= count;
+        }
+    }
+}
+
+} // namespace alice2
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "../../geometry/PointOctree.h"
+#include "../../geometry/PointOctreeLoader.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace alice2 {
+
+class UnifiedRenderer;
+struct PointPool;
+
+// Scene object streaming a point cloud from an out-of-core PointOctree
+// (written by tools/point_octree_converter). Every Draw selects a cut
+// through the tree: from the root, visible nodes are refined largest
+// projected size first while their point spacing projects above the error
+// tolerance, until the point budget is spent. Only nodes already on the GPU
+// are drawn and refined; missing ones are requested from the background
+// loader in the same order, so detail fills in over a few frames as the
+// camera rests. Nodes occupy blocks of a fixed GPU point pool; when it is
+// full, the least recently drawn nodes are evicted.
+//
+// Points are drawn in the file's offset-relative coordinates, which keeps
+// georeferenced clouds precise in floats; GetHeader().offset maps them back.
+class ObjPointCloud {
+public:
+    ObjPointCloud();
+    ~ObjPointCloud();
+
+    bool Open(const std::string& path);
+    void Close();
+    bool IsOpen() const { return m_Octree.IsOpen(); }
+    const PointOctree& GetOctree() const { return m_Octree; }
+
+    // Refine while a node's point spacing covers more pixels than this
+    void SetErrorTolerance(float pixels) { m_ErrorTolerance = pixels; }
+    float GetErrorTolerance() const { return m_ErrorTolerance; }
+    // Points drawn per frame at most
+    void SetPointBudget(size_t points) { m_PointBudget = points; }
+    size_t GetPointBudget() const { return m_PointBudget; }
+    // GPU memory for resident nodes; takes effect at the next Open
+    void SetMemoryBudget(size_t bytes) { m_MemoryBudget = bytes; }
+    size_t GetMemoryBudget() const { return m_MemoryBudget; }
+    // Points uploaded per frame at most, bounding the per-frame upload cost
+    void SetUploadBudget(size_t points) { m_UploadBudget = points; }
+    size_t GetUploadBudget() const { return m_UploadBudget; }
+
+    // Statistics of the last Draw
+    size_t GetDrawnNodeCount() const { return m_DrawList.size(); }
+    size_t GetDrawnPointCount() const { return m_DrawnPoints; }
+    size_t GetResidentNodeCount() const { return m_ResidentCount; }
+    size_t GetRequestedNodeCount() const { return m_Wanted.size(); }
+
+    void Draw(UnifiedRenderer* renderer);
+
+private:
+    // Residency of one node: its chain of pool blocks and its place in the
+    // least-recently-drawn list
+    struct NodeState {
+        uint32_t firstBlock = INVALID_INDEX;
+        uint32_t newer = INVALID_INDEX;
+        uint32_t older = INVALID_INDEX;
+        uint64_t lastUsed = 0;
+        bool resident = false;
+    };
+
+    PointOctree m_Octree;
+    std::unique_ptr<PointOctreeLoader> m_Loader;
+    std::unique_ptr<PointPool> m_Pool;
+
+    float m_ErrorTolerance = 1.5f;
+    size_t m_PointBudget = size_t(4) << 20;
+    size_t m_MemoryBudget = size_t(256) << 20;
+    size_t m_UploadBudget = size_t(1) << 19;
+
+    std::vector<NodeState> m_States;
+    std::vector<uint32_t> m_BlockNext; // Next block of the same node, or of the free list
+    uint32_t m_FreeBlock = INVALID_INDEX;
+    uint32_t m_FreeBlockCount = 0;
+    uint32_t m_Newest = INVALID_INDEX;
+    uint32_t m_Oldest = INVALID_INDEX;
+    size_t m_ResidentCount = 0;
+    uint64_t m_Frame = 0;
+
+    std::vector<uint32_t> m_DrawList;
+    std::vector<uint32_t> m_Wanted;
+    size_t m_DrawnPoints = 0;
+    std::vector<PointOctreeLoader::LoadedNode> m_Loaded;
+
+    bool CreatePool(UnifiedRenderer* renderer);
+    void Upload(UnifiedRenderer* renderer);
+    bool MakeResident(UnifiedRenderer* renderer, uint32_t node, const std::vector<OctreePoint>& points);
+    void Evict(uint32_t node);
+    void Touch(uint32_t node);
+    void Unlink(uint32_t node);
+    void Select(UnifiedRenderer* renderer);
+};
+
+} // namespace alice2
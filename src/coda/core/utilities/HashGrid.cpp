@@ -0,0 +1,161 @@
+#include "HashGrid.h"
+#include "Parallel.h"
+#include "SpatialSort.h"
+
+#include <bit>
+#include <iostream>
+#include <limits>
+#include <numeric>
+
+namespace alice2 {
+namespace spatial {
+
+namespace {
+
+constexpr size_t PointGrain = 16384;
+constexpr size_t QueryGrain = 1024;
+
+} // namespace
+
+bool HashGrid::Build(const Vec3f* points, size_t count, float cellSize) {
+    if (!(cellSize > 0.0f) || !std::isfinite(cellSize)) {
+        std::cerr << "HashGrid::Build: cell size must be positive and finite" << std::endl;
+        return false;
+    }
+    if (count >= std::numeric_limits<uint32_t>::max()) {
+        std::cerr << "HashGrid::Build: too many points" << std::endl;
+        return false;
+    }
+    m_CellSize = cellSize;
+    m_InverseCellSize = 1.0f / cellSize;
+
+    // Cells count from the lower bounds so every coordinate is non-negative
+    const size_t chunkCount = parallel::ChunkCount(count, PointGrain);
+    const size_t chunkSize = chunkCount ? (count + chunkCount - 1) / chunkCount : 0;
+    constexpr float inf = std::numeric_limits<float>::infinity();
+    std::vector<Vec3f> mins(chunkCount, Vec3f(inf, inf, inf));
+    parallel::ForChunks(chunkCount, [&](size_t chunk) {
+        size_t end = std::min(count, (chunk + 1) * chunkSize);
+        Vec3f lo = mins[chunk];
+        for (size_t i = chunk * chunkSize; i < end; ++i) {
+            lo = Vec3f(std::min(lo.x, points[i].x), std::min(lo.y, points[i].y), std::min(lo.z, points[i].z));
+        }
+        mins[chunk] = lo;
+    });
+    m_Origin = Vec3f(inf, inf, inf);
+    for (const Vec3f& lo : mins) {
+        m_Origin = Vec3f(std::min(m_Origin.x, lo.x), std::min(m_Origin.y, lo.y), std::min(m_Origin.z, lo.z));
+    }
+    if (!std::isfinite(m_Origin.x) || !std::isfinite(m_Origin.y) || !std::isfinite(m_Origin.z)) {
+        m_Origin = Vec3f();
+    }
+
+    // About one bucket per point
+    const size_t bucketCount = std::bit_ceil(std::max<size_t>(count, 64));
+    m_Mask = uint32_t(bucketCount - 1);
+
+    m_Keys.resize(count);
+    m_Order.resize(count);
+    parallel::For(count, PointGrain, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const Vec3f& p = points[i];
+            m_Keys[i] = (RowHash(Cell(p.y, m_Origin.y), Cell(p.z, m_Origin.z)) + Cell(p.x, m_Origin.x)) & m_Mask;
+            m_Order[i] = uint32_t(i);
+        }
+    });
+    RadixSort(m_Keys, m_Order);
+
+    m_Points.resize(count);
+    m_Cells.resize(count);
+    m_Starts.resize(bucketCount + 1);
+    const size_t sortedChunks = parallel::ChunkCount(count, PointGrain);
+    std::vector<uint64_t> extents(sortedChunks * 3, 0);
+    parallel::ForChunks(sortedChunks, [&](size_t chunk) {
+        const size_t sortedSize = (count + sortedChunks - 1) / sortedChunks;
+        const size_t begin = chunk * sortedSize, end = std::min(count, begin + sortedSize);
+        uint64_t* extent = &extents[chunk * 3];
+        for (size_t i = begin; i < end; ++i) {
+            const Vec3f& p = points[m_Order[i]];
+            m_Points[i] = p;
+            const uint32_t x = Cell(p.x, m_Origin.x), y = Cell(p.y, m_Origin.y), z = Cell(p.z, m_Origin.z);
+            m_Cells[i] = uint64_t(x) | uint64_t(y) << CellBits | uint64_t(z) << (2 * CellBits);
+            extent[0] = std::max<uint64_t>(extent[0], x);
+            extent[1] = std::max<uint64_t>(extent[1], y);
+            extent[2] = std::max<uint64_t>(extent[2], z);
+            // Sorted point i starts every bucket after the previous point's,
+            // up to its own; each start is written exactly once
+            const uint32_t from = i == 0 ? 0 : m_Keys[i - 1] + 1;
+            for (uint32_t bucket = from; bucket <= m_Keys[i]; ++bucket) {
+                m_Starts[bucket] = uint32_t(i);
+            }
+        }
+    });
+    const uint32_t tail = count == 0 ? 0 : m_Keys[count - 1] + 1;
+    std::fill(m_Starts.begin() + tail, m_Starts.end(), uint32_t(count));
+    for (int axis = 0; axis < 3; ++axis) {
+        m_Extent[axis] = 0;
+        for (size_t chunk = 0; chunk < sortedChunks; ++chunk) {
+            m_Extent[axis] = std::max(m_Extent[axis], uint32_t(extents[chunk * 3 + axis]));
+        }
+    }
+    return true;
+}
+
+void HashGrid::Clear() {
+    m_Points.clear();
+    m_Cells.clear();
+    m_Order.clear();
+    m_Starts.clear();
+    m_Keys.clear();
+    m_Mask = 0;
+}
+
+void HashGrid::FindInRadius(const Vec3f& center, float radius, std::vector<uint32_t>& indices) const {
+    indices.clear();
+    ForEachInRadius(center, radius, [&](uint32_t index, float) { indices.push_back(index); });
+}
+
+void HashGrid::FindAllInRadius(float radius, std::vector<uint32_t>& offsets, std::vector<uint32_t>& neighbors) const {
+    const size_t count = m_Points.size();
+    offsets.assign(count + 1, 0);
+    neighbors.clear();
+    if (count == 0) {
+        return;
+    }
+
+    // Queries run in sorted order, so consecutive ones touch the same cells;
+    // each chunk gathers its lists locally, then they are copied into place
+    const size_t chunkCount = parallel::ChunkCount(count, QueryGrain);
+    const size_t chunkSize = (count + chunkCount - 1) / chunkCount;
+    std::vector<std::vector<uint32_t>> lists(chunkCount);
+    std::vector<uint32_t> localStarts(count);
+    parallel::ForChunks(chunkCount, [&](size_t chunk) {
+        std::vector<uint32_t>& list = lists[chunk];
+        size_t end = std::min(count, (chunk + 1) * chunkSize);
+        for (size_t i = chunk * chunkSize; i < end; ++i) {
+            const uint32_t self = m_Order[i];
+            localStarts[i] = uint32_t(list.size());
+            ForEachInRadius(m_Points[i], radius, [&](uint32_t index, float) {
+                if (index != self) {
+                    list.push_back(index);
+                }
+            });
+            offsets[self + 1] = uint32_t(list.size() - localStarts[i]);
+        }
+    });
+
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    neighbors.resize(offsets[count]);
+    parallel::ForChunks(chunkCount, [&](size_t chunk) {
+        const std::vector<uint32_t>& list = lists[chunk];
+        size_t end = std::min(count, (chunk + 1) * chunkSize);
+        for (size_t i = chunk * chunkSize; i < end; ++i) {
+            const uint32_t self = m_Order[i];
+            std::copy(list.begin() + localStarts[i], list.begin() + localStarts[i] + (offsets[self + 1] - offsets[self]),
+                      neighbors.begin() + offsets[self]);
+        }
+    });
+}
+
+} // namespace spatial
+} // namespace alice2
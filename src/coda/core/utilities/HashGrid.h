@@ -0,0 +1,141 @@
+#pragma once
+
+#include "../../../core/base/Types.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace alice2 {
+namespace spatial {
+
+// Uniform grid over a point set for radius neighbour queries, meant to be
+// rebuilt every frame for particles, agents and point clouds.
+//
+// Cells are hashed into a power-of-two bucket table; a parallel radix sort
+// on the bucket gives the points in bucket order and a compact start array
+// (bucket b holds sorted points [starts[b], starts[b + 1])). The hash adds
+// the x cell to a hash of (y, z), so a row of neighbouring cells lands in
+// consecutive buckets and a query reads one contiguous run per row instead
+// of one scattered bucket per cell. Points are stored sorted, with their
+// cell, so distance tests stream through memory; cells that share a bucket
+// are told apart by the stored cell.
+//
+// Queries are const and may run concurrently from any number of threads.
+class HashGrid {
+public:
+    HashGrid() = default;
+
+    // Bins the points into cells of the given size, reusing the buffers of
+    // the previous build. False for a cell size that is not positive.
+    bool Build(const Vec3f* points, size_t count, float cellSize);
+    bool Build(const std::vector<Vec3f>& points, float cellSize) {
+        return Build(points.data(), points.size(), cellSize);
+    }
+    void Clear();
+
+    size_t GetPointCount() const { return m_Points.size(); }
+    float GetCellSize() const { return m_CellSize; }
+    size_t GetBucketCount() const { return m_Starts.empty() ? 0 : m_Starts.size() - 1; }
+
+    // Points in bucket order; GetOrder()[i] is the input index of sorted point i
+    const std::vector<Vec3f>& GetSortedPoints() const { return m_Points; }
+    const std::vector<uint32_t>& GetOrder() const { return m_Order; }
+    const std::vector<uint32_t>& GetCellStarts() const { return m_Starts; }
+
+    // Calls visit(index, distanceSquared) for every point within radius of
+    // center, with the input index; each point is visited once
+    template <typename Visitor>
+    void ForEachInRadius(const Vec3f& center, float radius, Visitor&& visit) const;
+
+    // Input indices within radius, replacing the contents of indices
+    void FindInRadius(const Vec3f& center, float radius, std::vector<uint32_t>& indices) const;
+
+    // Neighbours within radius of every point, itself excluded, in parallel:
+    // point i's are neighbors[offsets[i], offsets[i + 1]) (input indices)
+    void FindAllInRadius(float radius, std::vector<uint32_t>& offsets, std::vector<uint32_t>& neighbors) const;
+
+private:
+    static constexpr int CellBits = 21;
+    static constexpr uint32_t MaxCell = (1u << CellBits) - 1;
+
+    float m_CellSize = 0.0f;
+    float m_InverseCellSize = 0.0f;
+    Vec3f m_Origin;
+    uint32_t m_Mask = 0;
+    uint32_t m_Extent[3] = {0, 0, 0}; // Largest occupied cell per axis
+
+    std::vector<Vec3f> m_Points;
+    std::vector<uint64_t> m_Cells; // Packed x | y << 21 | z << 42 per sorted point
+    std::vector<uint32_t> m_Order;
+    std::vector<uint32_t> m_Starts;
+    std::vector<uint32_t> m_Keys;  // Build scratch
+
+    uint32_t Cell(float coordinate, float origin) const {
+        float cell = (coordinate - origin) * m_InverseCellSize;
+        // Also clamps NaN to 0
+        return cell >= float(MaxCell) ? MaxCell : (cell > 0.0f ? uint32_t(cell) : 0u);
+    }
+    static uint32_t RowHash(uint32_t y, uint32_t z) { return y * 73856093u ^ z * 19349663u; }
+};
+
+template <typename Visitor>
+void HashGrid::ForEachInRadius(const Vec3f& center, float radius, Visitor&& visit) const {
+    if (m_Points.empty() || !(radius >= 0.0f)) {
+        return;
+    }
+    const uint32_t x0 = Cell(center.x - radius, m_Origin.x);
+    const uint32_t x1 = std::min(Cell(center.x + radius, m_Origin.x), m_Extent[0]);
+    const uint32_t y0 = Cell(center.y - radius, m_Origin.y);
+    const uint32_t y1 = std::min(Cell(center.y + radius, m_Origin.y), m_Extent[1]);
+    const uint32_t z0 = Cell(center.z - radius, m_Origin.z);
+    const uint32_t z1 = std::min(Cell(center.z + radius, m_Origin.z), m_Extent[2]);
+    if (x0 > x1 || y0 > y1 || z0 > z1) {
+        return;
+    }
+    const float radiusSquared = radius * radius;
+    auto test = [&](uint32_t i) {
+        const Vec3f d = m_Points[i] - center;
+        const float distanceSquared = d.x * d.x + d.y * d.y + d.z * d.z;
+        if (distanceSquared <= radiusSquared) {
+            visit(m_Order[i], distanceSquared);
+        }
+    };
+    // A radius spanning more rows than there are points reads them all
+    if (uint64_t(y1 - y0 + 1) * (z1 - z0 + 1) >= m_Points.size()) {
+        for (uint32_t i = 0; i < uint32_t(m_Points.size()); ++i) {
+            test(i);
+        }
+        return;
+    }
+    // A row spanning the whole table is read once, in two runs at most
+    const uint32_t span = std::min(x1 - x0, m_Mask);
+
+    for (uint32_t z = z0; z <= z1; ++z) {
+        for (uint32_t y = y0; y <= y1; ++y) {
+            const uint64_t row = uint64_t(y) << CellBits | uint64_t(z) << (2 * CellBits);
+            const uint32_t first = (RowHash(y, z) + x0) & m_Mask;
+            const uint32_t last = first + span;
+            auto scan = [&](uint32_t begin, uint32_t end) {
+                for (uint32_t i = m_Starts[begin]; i < m_Starts[end]; ++i) {
+                    const uint64_t cell = m_Cells[i];
+                    const uint32_t x = uint32_t(cell) & MaxCell;
+                    if ((cell & ~uint64_t(MaxCell)) == row && x >= x0 && x <= x1) {
+                        test(i);
+                    }
+                }
+            };
+            if (last <= m_Mask) {
+                scan(first, last + 1);
+            } else {
+                scan(first, m_Mask + 1);
+                scan(0, (last & m_Mask) + 1);
+            }
+        }
+    }
+}
+
+} // namespace spatial
+} // namespace alice2
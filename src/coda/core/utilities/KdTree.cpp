@@ -0,0 +1,417 @@
+#include "KdTree.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <numeric>
+#include <utility>
+
+namespace alice2 {
+namespace spatial {
+
+namespace {
+
+constexpr size_t PointGrain = 16384;
+constexpr size_t QueryGrain = 256;
+
+struct Item {
+    float p[3];
+    uint32_t index;
+};
+
+struct Range {
+    uint32_t begin, end;
+    uint32_t node;
+    float min[3], max[3];
+};
+
+float Coordinate(const Vec3f& p, int axis) { return axis == 0 ? p.x : (axis == 1 ? p.y : p.z); }
+
+// Node count of the subtree over a given number of points. Halving keeps at
+// most two sizes per depth, so the table is short; it is filled before the
+// build and only read during it.
+class NodeCounts {
+public:
+    explicit NodeCounts(uint32_t count) { Count(count); }
+
+    uint32_t operator()(uint32_t count) const {
+        if (count <= KdTree::LeafSize) {
+            return 1;
+        }
+        for (const auto& entry : m_Table) {
+            if (entry.first == count) {
+                return entry.second;
+            }
+        }
+        return 0;
+    }
+
+private:
+    std::vector<std::pair<uint32_t, uint32_t>> m_Table;
+
+    uint32_t Count(uint32_t count) {
+        uint32_t known = (*this)(count);
+        if (known != 0) {
+            return known;
+        }
+        uint32_t nodes = 1 + Count(count / 2) + Count(count - count / 2);
+        m_Table.push_back({count, nodes});
+        return nodes;
+    }
+};
+
+// Writes the node for a range; for an interior node, the two child ranges
+// and true
+bool Split(std::vector<Item>& items, std::vector<KdTree::Node>& nodes, const NodeCounts& counts, const Range& range,
+           Range& left, Range& right) {
+    KdTree::Node& node = nodes[range.node];
+    const uint32_t count = range.end - range.begin;
+    if (count <= KdTree::LeafSize) {
+        node = {0.0f, 0.0f, range.begin, uint16_t(count), 0};
+        return false;
+    }
+
+    int axis = 0;
+    for (int a = 1; a < 3; ++a) {
+        if (range.max[a] - range.min[a] > range.max[axis] - range.min[axis]) {
+            axis = a;
+        }
+    }
+    const uint32_t middle = range.begin + count / 2;
+    Item* first = items.data() + range.begin;
+    std::nth_element(first, items.data() + middle, items.data() + range.end,
+                     [axis](const Item& a, const Item& b) { return a.p[axis] < b.p[axis]; });
+    const float high = items[middle].p[axis];
+    float low = first->p[axis];
+    for (const Item* item = first; item != items.data() + middle; ++item) {
+        low = std::max(low, item->p[axis]);
+    }
+
+    left = range;
+    left.end = middle;
+    left.node = range.node + 1;
+    left.max[axis] = low;
+    right = range;
+    right.begin = middle;
+    right.node = range.node + 1 + counts(count / 2);
+    right.min[axis] = high;
+    node = {low, high, right.node, 0, uint16_t(axis)};
+    return true;
+}
+
+void BuildSubtree(std::vector<Item>& items, std::vector<KdTree::Node>& nodes, const NodeCounts& counts,
+                  const Range& range) {
+    Range left, right;
+    if (Split(items, nodes, counts, range, left, right)) {
+        BuildSubtree(items, nodes, counts, left);
+        BuildSubtree(items, nodes, counts, right);
+    }
+}
+
+} // namespace
+
+// Closest points so far, sorted by distance, in caller-provided arrays
+struct KdTree::Neighbours {
+    uint32_t* points;   // Leaf-order positions
+    float* distances;
+    uint32_t k;
+    uint32_t count = 0;
+    float worst;        // Squared search radius until k are found, then the kth distance
+
+    bool Accepts(float distanceSquared) const {
+        return distanceSquared < worst || (count < k && distanceSquared <= worst);
+    }
+
+    void Insert(uint32_t point, float distanceSquared) {
+        uint32_t i = count < k ? count++ : k - 1;
+        while (i > 0 && distances[i - 1] > distanceSquared) {
+            distances[i] = distances[i - 1];
+            points[i] = points[i - 1];
+            --i;
+        }
+        distances[i] = distanceSquared;
+        points[i] = point;
+        if (count == k) {
+            worst = distances[k - 1];
+        }
+    }
+};
+
+bool KdTree::Build(const Vec3f* points, size_t count) {
+    Clear();
+    if (count >= std::numeric_limits<uint32_t>::max()) {
+        std::cerr << "KdTree::Build: too many points" << std::endl;
+        return false;
+    }
+    if (count == 0) {
+        return true;
+    }
+
+    // Bounds, and a check that every coordinate orders (nth_element needs it)
+    const size_t chunkCount = parallel::ChunkCount(count, PointGrain);
+    const size_t chunkSize = (count + chunkCount - 1) / chunkCount;
+    std::vector<Vec3f> mins(chunkCount, points[0]), maxs(chunkCount, points[0]);
+    std::vector<char> finite(chunkCount, 1);
+    parallel::ForChunks(chunkCount, [&](size_t chunk) {
+        size_t end = std::min(count, (chunk + 1) * chunkSize);
+        Vec3f lo = mins[chunk], hi = maxs[chunk];
+        for (size_t i = chunk * chunkSize; i < end; ++i) {
+            const Vec3f& p = points[i];
+            if (!std::isfinite(p.x) || !std::isfinite(p.y) || !std::isfinite(p.z)) {
+                finite[chunk] = 0;
+                return;
+            }
+            lo = Vec3f(std::min(lo.x, p.x), std::min(lo.y, p.y), std::min(lo.z, p.z));
+            hi = Vec3f(std::max(hi.x, p.x), std::max(hi.y, p.y), std::max(hi.z, p.z));
+        }
+        mins[chunk] = lo;
+        maxs[chunk] = hi;
+    });
+    if (std::find(finite.begin(), finite.end(), 0) != finite.end()) {
+        std::cerr << "KdTree::Build: points must be finite" << std::endl;
+        return false;
+    }
+    m_Min = mins[0];
+    m_Max = maxs[0];
+    for (size_t chunk = 1; chunk < chunkCount; ++chunk) {
+        m_Min = Vec3f(std::min(m_Min.x, mins[chunk].x), std::min(m_Min.y, mins[chunk].y),
+                      std::min(m_Min.z, mins[chunk].z));
+        m_Max = Vec3f(std::max(m_Max.x, maxs[chunk].x), std::max(m_Max.y, maxs[chunk].y),
+                      std::max(m_Max.z, maxs[chunk].z));
+    }
+
+    std::vector<Item> items(count);
+    parallel::For(count, PointGrain, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            items[i] = {{points[i].x, points[i].y, points[i].z}, uint32_t(i)};
+        }
+    });
+
+    const NodeCounts counts(static_cast<uint32_t>(count));
+    m_Nodes.resize(counts(uint32_t(count)));
+
+    // Top levels: split the ranges of a level in parallel until there are
+    // enough to keep every worker busy, then build the subtrees below
+    Range root = {0, uint32_t(count), 0, {m_Min.x, m_Min.y, m_Min.z}, {m_Max.x, m_Max.y, m_Max.z}};
+    std::vector<Range> level = {root};
+    const size_t subtreeCount = parallel::ThreadCount() * 8;
+    while (!level.empty() && level.size() < subtreeCount) {
+        std::vector<Range> children(level.size() * 2);
+        std::vector<char> split(level.size(), 0);
+        parallel::ForChunks(level.size(), [&](size_t r) {
+            split[r] = Split(items, m_Nodes, counts, level[r], children[r * 2], children[r * 2 + 1]);
+        });
+        std::vector<Range> next;
+        for (size_t r = 0; r < level.size(); ++r) {
+            if (split[r]) {
+                next.push_back(children[r * 2]);
+                next.push_back(children[r * 2 + 1]);
+            }
+        }
+        level.swap(next);
+    }
+    parallel::ForChunks(level.size(), [&](size_t r) { BuildSubtree(items, m_Nodes, counts, level[r]); });
+
+    m_Points.resize(count);
+    m_Indices.resize(count);
+    parallel::For(count, PointGrain, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            m_Points[i] = Vec3f(items[i].p[0], items[i].p[1], items[i].p[2]);
+            m_Indices[i] = items[i].index;
+        }
+    });
+    return true;
+}
+
+void KdTree::Clear() {
+    m_Nodes.clear();
+    m_Points.clear();
+    m_Indices.clear();
+}
+
+float KdTree::BoxDistanceSquared(const Vec3f& query, float offsets[3]) const {
+    float distanceSquared = 0.0f;
+    for (int axis = 0; axis < 3; ++axis) {
+        float q = Coordinate(query, axis);
+        offsets[axis] = std::max({Coordinate(m_Min, axis) - q, q - Coordinate(m_Max, axis), 0.0f});
+        distanceSquared += offsets[axis] * offsets[axis];
+    }
+    return distanceSquared;
+}
+
+void KdTree::SearchKNearest(uint32_t index, const Vec3f& query, float distanceSquared, float offsets[3],
+                            Neighbours& neighbours) const {
+    const Node& node = m_Nodes[index];
+    if (node.count > 0) {
+        for (uint32_t i = node.offset; i < node.offset + node.count; ++i) {
+            const Vec3f d = m_Points[i] - query;
+            const float pointDistance = d.x * d.x + d.y * d.y + d.z * d.z;
+            if (neighbours.Accepts(pointDistance)) {
+                neighbours.Insert(i, pointDistance);
+            }
+        }
+        return;
+    }
+    // The nearer half first; the farther one only if its box, one cut
+    // further along the split axis, can still hold a closer point
+    const int axis = node.axis;
+    const float toLow = Coordinate(query, axis) - node.low;
+    const float toHigh = Coordinate(query, axis) - node.high;
+    const bool leftFirst = toLow + toHigh < 0.0f;
+    const float cut = leftFirst ? toHigh : toLow;
+    SearchKNearest(leftFirst ? index + 1 : node.offset, query, distanceSquared, offsets, neighbours);
+
+    const float previous = offsets[axis];
+    const float farDistance = distanceSquared - previous * previous + cut * cut;
+    if (neighbours.Accepts(farDistance)) {
+        offsets[axis] = cut;
+        SearchKNearest(leftFirst ? node.offset : index + 1, query, farDistance, offsets, neighbours);
+        offsets[axis] = previous;
+    }
+}
+
+template <typename Visitor>
+void KdTree::SearchRadius(uint32_t index, const Vec3f& query, float radiusSquared, float distanceSquared,
+                          float offsets[3], Visitor& visit) const {
+    const Node& node = m_Nodes[index];
+    if (node.count > 0) {
+        for (uint32_t i = node.offset; i < node.offset + node.count; ++i) {
+            const Vec3f d = m_Points[i] - query;
+            const float pointDistance = d.x * d.x + d.y * d.y + d.z * d.z;
+            if (pointDistance <= radiusSquared) {
+                visit(m_Indices[i], pointDistance);
+            }
+        }
+        return;
+    }
+    const int axis = node.axis;
+    const float toLow = Coordinate(query, axis) - node.low;
+    const float toHigh = Coordinate(query, axis) - node.high;
+    const bool leftFirst = toLow + toHigh < 0.0f;
+    const float cut = leftFirst ? toHigh : toLow;
+    SearchRadius(leftFirst ? index + 1 : node.offset, query, radiusSquared, distanceSquared, offsets, visit);
+
+    const float previous = offsets[axis];
+    const float farDistance = distanceSquared - previous * previous + cut * cut;
+    if (farDistance <= radiusSquared) {
+        offsets[axis] = cut;
+        SearchRadius(leftFirst ? node.offset : index + 1, query, radiusSquared, farDistance, offsets, visit);
+        offsets[axis] = previous;
+    }
+}
+
+uint32_t KdTree::FindKNearest(const Vec3f& query, uint32_t k, uint32_t* indices, float* distancesSquared,
+                              float maxDistance) const {
+    std::fill(indices, indices + k, NoPoint);
+    std::vector<float> scratch(distancesSquared ? 0 : k);
+    float* distances = distancesSquared ? distancesSquared : scratch.data();
+    std::fill(distances, distances + k, std::numeric_limits<float>::infinity());
+    if (m_Nodes.empty() || k == 0 || !(maxDistance >= 0.0f)) {
+        return 0;
+    }
+
+    Neighbours neighbours = {indices, distances, k, 0, maxDistance * maxDistance};
+    float offsets[3];
+    const float distanceSquared = BoxDistanceSquared(query, offsets);
+    if (neighbours.Accepts(distanceSquared)) {
+        SearchKNearest(0, query, distanceSquared, offsets, neighbours);
+    }
+    // Leaf positions to input indices
+    for (uint32_t i = 0; i < neighbours.count; ++i) {
+        indices[i] = m_Indices[indices[i]];
+    }
+    return neighbours.count;
+}
+
+uint32_t KdTree::FindNearest(const Vec3f& query, float* distanceSquared) const {
+    uint32_t index = NoPoint;
+    float distance = std::numeric_limits<float>::infinity();
+    FindKNearest(query, 1, &index, &distance);
+    if (distanceSquared) {
+        *distanceSquared = distance;
+    }
+    return index;
+}
+
+void KdTree::FindInRadius(const Vec3f& query, float radius, std::vector<uint32_t>& indices,
+                          std::vector<float>* distancesSquared) const {
+    indices.clear();
+    if (distancesSquared) {
+        distancesSquared->clear();
+    }
+    if (m_Nodes.empty() || !(radius >= 0.0f)) {
+        return;
+    }
+    const float radiusSquared = radius * radius;
+    float offsets[3];
+    const float distanceSquared = BoxDistanceSquared(query, offsets);
+    if (distanceSquared > radiusSquared) {
+        return;
+    }
+    auto visit = [&](uint32_t index, float pointDistance) {
+        indices.push_back(index);
+        if (distancesSquared) {
+            distancesSquared->push_back(pointDistance);
+        }
+    };
+    SearchRadius(0, query, radiusSquared, distanceSquared, offsets, visit);
+}
+
+void KdTree::FindKNearest(const Vec3f* queries, size_t count, uint32_t k, uint32_t* indices,
+                          float* distancesSquared, uint32_t* counts, float maxDistance) const {
+    if (k == 0) {
+        return;
+    }
+    parallel::For(count, QueryGrain, [&](size_t begin, size_t end) {
+        // One scratch buffer per block when distances are not wanted
+        std::vector<float> scratch(distancesSquared ? 0 : k);
+        for (size_t q = begin; q < end; ++q) {
+            float* distances = distancesSquared ? distancesSquared + q * k : scratch.data();
+            uint32_t found = FindKNearest(queries[q], k, indices + q * k, distances, maxDistance);
+            if (counts) {
+                counts[q] = found;
+            }
+        }
+    });
+}
+
+void KdTree::FindInRadius(const Vec3f* queries, size_t count, float radius, std::vector<uint32_t>& offsets,
+                          std::vector<uint32_t>& indices) const {
+    offsets.assign(count + 1, 0);
+    indices.clear();
+    if (count == 0 || m_Nodes.empty() || !(radius >= 0.0f)) {
+        return;
+    }
+
+    // Each chunk of consecutive queries gathers its lists locally; the
+    // chunks are then copied into place one after another
+    const float radiusSquared = radius * radius;
+    const size_t chunkCount = parallel::ChunkCount(count, QueryGrain);
+    const size_t chunkSize = (count + chunkCount - 1) / chunkCount;
+    std::vector<std::vector<uint32_t>> lists(chunkCount);
+    parallel::ForChunks(chunkCount, [&](size_t chunk) {
+        std::vector<uint32_t>& list = lists[chunk];
+        auto visit = [&](uint32_t index, float) { list.push_back(index); };
+        size_t end = std::min(count, (chunk + 1) * chunkSize);
+        for (size_t q = chunk * chunkSize; q < end; ++q) {
+            const size_t before = list.size();
+            float boxOffsets[3];
+            const float distanceSquared = BoxDistanceSquared(queries[q], boxOffsets);
+            if (distanceSquared <= radiusSquared) {
+                SearchRadius(0, queries[q], radiusSquared, distanceSquared, boxOffsets, visit);
+            }
+            offsets[q + 1] = uint32_t(list.size() - before);
+        }
+    });
+
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    indices.resize(offsets[count]);
+    parallel::ForChunks(chunkCount, [&](size_t chunk) {
+        size_t first = std::min(count, chunk * chunkSize);
+        std::copy(lists[chunk].begin(), lists[chunk].end(), indices.begin() + offsets[first]);
+    });
+}
+
+} // namespace spatial
+} // namespace alice2
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "../../../core/base/Types.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace alice2 {
+namespace spatial {
+
+// Static KD-tree over a point cloud for k-nearest and radius searches, the
+// queries behind normal estimation, denoising and registration.
+//
+// Every node splits its points at the median (std::nth_element) along the
+// axis where its box is widest, down to leaves of at most LeafSize points,
+// so the tree is balanced and its shape depends only on the point count.
+// That fixes every subtree's node range in advance: the top levels are
+// split level by level with the ranges of a level in parallel, then the
+// subtrees below are built concurrently straight into the shared node
+// array. Nodes are 16 bytes in depth-first order (the left child follows
+// its parent) and keep the extent of both halves along the split axis, and
+// points are stored in leaf order, so a leaf is one contiguous run.
+//
+// Searches descend the nearer child first and prune the farther one with
+// the incrementally updated distance to its box (Arya and Mount). Queries
+// are const and thread-safe; the batched forms run many queries in
+// parallel into buffers the caller allocates once and reuses.
+class KdTree {
+public:
+    struct Node {
+        float low;       // Interior: largest coordinate of the left half along axis
+        float high;      // Interior: smallest coordinate of the right half
+        uint32_t offset; // Leaf: first point; interior: right child (left is the next node)
+        uint16_t count;  // Points in a leaf, 0 for interior nodes
+        uint16_t axis;
+    };
+
+    static constexpr uint32_t LeafSize = 16;
+    // Index of an empty kNN slot
+    static constexpr uint32_t NoPoint = std::numeric_limits<uint32_t>::max();
+
+    // False for non-finite points; the tree is left empty then
+    bool Build(const Vec3f* points, size_t count);
+    bool Build(const std::vector<Vec3f>& points) { return Build(points.data(), points.size()); }
+    void Clear();
+
+    bool IsEmpty() const { return m_Nodes.empty(); }
+    size_t GetPointCount() const { return m_Points.size(); }
+    const std::vector<Node>& GetNodes() const { return m_Nodes; }
+    // Points in leaf order; GetIndices()[i] is the input index of point i.
+    // Querying them in this order keeps batches coherent.
+    const std::vector<Vec3f>& GetPoints() const { return m_Points; }
+    const std::vector<uint32_t>& GetIndices() const { return m_Indices; }
+
+    // The k nearest input points within maxDistance, closest first, into
+    // indices[k] and distancesSquared[k] (may be null); returns how many
+    // were found, and the remaining slots are NoPoint
+    uint32_t FindKNearest(const Vec3f& query, uint32_t k, uint32_t* indices, float* distancesSquared,
+                          float maxDistance = std::numeric_limits<float>::infinity()) const;
+    // Nearest input point, NoPoint for an empty tree
+    uint32_t FindNearest(const Vec3f& query, float* distanceSquared = nullptr) const;
+
+    // Input indices within radius, replacing the contents of the vectors
+    void FindInRadius(const Vec3f& query, float radius, std::vector<uint32_t>& indices,
+                      std::vector<float>* distancesSquared = nullptr) const;
+
+    // Batched kNN: query q writes indices[q * k, q * k + k) and the same
+    // range of distancesSquared (may be null); counts (may be null) gets
+    // how many each found. A finite maxDistance makes this a radius search
+    // capped at the k closest.
+    void FindKNearest(const Vec3f* queries, size_t count, uint32_t k, uint32_t* indices, float* distancesSquared,
+                      uint32_t* counts = nullptr,
+                      float maxDistance = std::numeric_limits<float>::infinity()) const;
+
+    // Batched uncapped radius search: query q's neighbours are
+    // indices[offsets[q], offsets[q + 1]); the vectors keep their capacity
+    // across calls
+    void FindInRadius(const Vec3f* queries, size_t count, float radius, std::vector<uint32_t>& offsets,
+                      std::vector<uint32_t>& indices) const;
+
+private:
+    struct Neighbours;
+
+    std::vector<Node> m_Nodes;
+    std::vector<Vec3f> m_Points;
+    std::vector<uint32_t> m_Indices;
+    Vec3f m_Min, m_Max; // Bounds of the points
+
+    void SearchKNearest(uint32_t node, const Vec3f& query, float distanceSquared, float offsets[3],
+                        Neighbours& neighbours) const;
+    template <typename Visitor>
+    void SearchRadius(uint32_t node, const Vec3f& query, float radiusSquared, float distanceSquared,
+                      float offsets[3], Visitor& visit) const;
+    float BoxDistanceSquared(const Vec3f& query, float offsets[3]) const;
+};
+
+} // namespace spatial
+} // namespace alice2
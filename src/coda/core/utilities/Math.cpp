@@ -0,0 +1,316 @@
+#include "Math.h"
+#include "Simd.h"
+
+#include <cstdint>
+#include <limits>
+
+namespace alice2 {
+namespace math {
+
+using namespace simd;
+
+namespace {
+
+constexpr float PI_F = 3.14159265358979323846f;
+constexpr float PI_2_F = 1.57079632679489661923f;
+constexpr float PI_4_F = 0.78539816339744830962f;
+
+template <typename V> inline V C(float x) { return V::Broadcast(x); }
+template <typename V> inline typename V::Int CI(int32_t x) { return V::Int::Broadcast(x); }
+
+// Sine and cosine: Cody-Waite reduction to [-pi/4, pi/4] by quadrant, then
+// Cephes minimax polynomials. pi/2 is split into 11-bit parts so q * part is
+// exact while the quadrant index stays below 2^13 (|x| < ~12800).
+template <bool Fast, typename V>
+inline void SinCosKernel(V x, V& sinOut, V& cosOut) {
+    auto q = RoundToInt(x * C<V>(0.63661977236758134308f)); // 2/pi
+    V qf = ToFloat(q);
+
+    V r = MulAdd(qf, C<V>(-1.5703125f), x);
+    r = MulAdd(qf, C<V>(-4.8375129699707031e-4f), r);
+    r = MulAdd(qf, C<V>(-7.5495336204767227e-8f), r);
+    r = MulAdd(qf, C<V>(-2.5632829192545614e-12f), r);
+    r = MulAdd(qf, C<V>(-6.1257422745431001e-17f), r);
+    V z = r * r;
+
+    V s, c;
+    if constexpr (Fast) {
+        s = MulAdd(MulAdd(z, C<V>(8.163281565e-3f), C<V>(-1.666339036e-1f)), z * r, r);
+        c = MulAdd(MulAdd(z, C<V>(-1.365244978e-3f), C<V>(4.166127861e-2f)), z * z, MulAdd(z, C<V>(-0.5f), C<V>(1.0f)));
+    } else {
+        V ps = MulAdd(MulAdd(z, C<V>(-1.9515295891e-4f), C<V>(8.3321608736e-3f)), z, C<V>(-1.6666654611e-1f));
+        s = MulAdd(ps, z * r, r);
+        V pc = MulAdd(MulAdd(z, C<V>(2.443315711809948e-5f), C<V>(-1.388731625493765e-3f)), z, C<V>(4.166664568298827e-2f));
+        c = MulAdd(pc, z * z, MulAdd(z, C<V>(-0.5f), C<V>(1.0f)));
+    }
+
+    V swap = CmpEq(q & CI<V>(1), CI<V>(1));
+    V sinNeg = CmpEq(q & CI<V>(2), CI<V>(2));
+    V cosNeg = CmpEq((q + CI<V>(1)) & CI<V>(2), CI<V>(2));
+    V signBit = C<V>(-0.0f);
+
+    sinOut = Xor(Select(swap, c, s), And(sinNeg, signBit));
+    cosOut = Xor(Select(swap, s, c), And(cosNeg, signBit));
+}
+
+// atan(t) for t in [0, 1], reduced to [0, tan(pi/8)] around pi/4
+template <bool Fast, typename V>
+inline V AtanUnit(V a) {
+    V big = CmpGt(a, C<V>(0.41421356237309504880f));
+    V t = Select(big, (a - C<V>(1.0f)) / (a + C<V>(1.0f)), a);
+    V z = t * t;
+
+    V p;
+    if constexpr (Fast) {
+        p = MulAdd(z, C<V>(1.703417207e-1f), C<V>(-3.318337691e-1f)) * z;
+    } else {
+        p = MulAdd(z, C<V>(8.05374449538e-2f), C<V>(-1.38776856032e-1f));
+        p = MulAdd(p, z, C<V>(1.99777106478e-1f));
+        p = MulAdd(p, z, C<V>(-3.33329491539e-1f));
+        p = p * z;
+    }
+    return And(big, C<V>(PI_4_F)) + MulAdd(p, t, t);
+}
+
+template <bool Fast, typename V>
+inline V Atan2Kernel(V y, V x) {
+    V ax = Abs(x);
+    V ay = Abs(y);
+    V mx = Max(ax, ay);
+    V mn = Min(ax, ay);
+
+    // 0/0 at the origin resolves to 0, matching std::atan2 up to sign handling below
+    V a = And(CmpGt(mx, C<V>(0.0f)), mn / mx);
+    V r = AtanUnit<Fast>(a);
+
+    r = Select(CmpGt(ay, ax), C<V>(PI_2_F) - r, r);
+    V xNeg = CmpEq(AsInt(SignBit(x)), CI<V>(std::numeric_limits<int32_t>::min()));
+    r = Select(xNeg, C<V>(PI_F) - r, r);
+    return Or(r, SignBit(y));
+}
+
+// asin(t) for t in [0, 0.5] given z = t*t
+template <bool Fast, typename V>
+inline V AsinCore(V t, V z) {
+    V p;
+    if constexpr (Fast) {
+        p = MulAdd(MulAdd(z, C<V>(6.410734403e-2f), C<V>(7.189978701e-2f)), z, C<V>(1.668012600e-1f));
+    } else {
+        p = MulAdd(z, C<V>(4.2163199048e-2f), C<V>(2.4181311049e-2f));
+        p = MulAdd(p, z, C<V>(4.5470025998e-2f));
+        p = MulAdd(p, z, C<V>(7.4953002686e-2f));
+        p = MulAdd(p, z, C<V>(1.6666752422e-1f));
+    }
+    return MulAdd(p * z, t, t);
+}
+
+// Shared range reduction: |x| > 0.5 uses asin(|x|) = pi/2 - 2 asin(sqrt((1-|x|)/2))
+template <bool Fast, typename V>
+inline V AsinReduced(V ax, V& big) {
+    big = CmpGt(ax, C<V>(0.5f));
+    V zBig = C<V>(0.5f) * (C<V>(1.0f) - ax);
+    V t = Select(big, Sqrt(zBig), ax);
+    V z = Select(big, zBig, ax * ax);
+    return AsinCore<Fast>(t, z);
+}
+
+template <bool Fast, typename V>
+inline V AsinKernel(V x) {
+    V big;
+    V p = AsinReduced<Fast>(Abs(x), big);
+    V r = Select(big, C<V>(PI_2_F) - (p + p), p);
+    return Or(r, SignBit(x));
+}
+
+template <bool Fast, typename V>
+inline V AcosKernel(V x) {
+    V big;
+    V p = AsinReduced<Fast>(Abs(x), big);
+    V twoP = p + p;
+    V small = C<V>(PI_2_F) - Or(p, SignBit(x));
+    V large = Select(CmpLt(x, C<V>(0.0f)), C<V>(PI_F) - twoP, twoP);
+    return Select(big, large, small);
+}
+
+// exp: x = n ln2 + r with |r| <= ln2/2, then 2^n * P(r)
+template <bool Fast, typename V>
+inline V ExpKernel(V x) {
+    V overflow = CmpGt(x, C<V>(88.72283905206835f));
+    V underflow = CmpLt(x, C<V>(-87.33654475055310f)); // Flush denormal results to zero
+    V xc = Min(Max(x, C<V>(-87.33654475055310f)), C<V>(88.72283905206835f));
+
+    auto n = RoundToInt(xc * C<V>(1.44269504088896341f));
+    V nf = ToFloat(n);
+    V r = MulAdd(nf, C<V>(-0.693359375f), xc);
+    r = MulAdd(nf, C<V>(2.12194440e-4f), r);
+    V z = r * r;
+
+    V p;
+    if constexpr (Fast) {
+        p = MulAdd(MulAdd(r, C<V>(4.127774725e-2f), C<V>(1.675351430e-1f)), r, C<V>(5.000511606e-1f));
+    } else {
+        p = MulAdd(r, C<V>(1.9875691500e-4f), C<V>(1.3981999507e-3f));
+        p = MulAdd(p, r, C<V>(8.3334519073e-3f));
+        p = MulAdd(p, r, C<V>(4.1665795894e-2f));
+        p = MulAdd(p, r, C<V>(1.6666665459e-1f));
+        p = MulAdd(p, r, C<V>(5.0000001201e-1f));
+    }
+    V y = MulAdd(p, z, r) + C<V>(1.0f);
+
+    // 2^n in two halves: n reaches 128 at the top of the range, past the
+    // largest biased exponent
+    auto half = ShiftRightArithmetic<1>(n);
+    V result = y * AsFloat(ShiftLeft<23>(half + CI<V>(127))) * AsFloat(ShiftLeft<23>(n - half + CI<V>(127)));
+    result = Select(overflow, C<V>(std::numeric_limits<float>::infinity()), result);
+    return AndNot(underflow, result);
+}
+
+// log: x = m 2^e with m in [sqrt(1/2), sqrt(2)), then log1p polynomial on m - 1
+template <bool Fast, typename V>
+inline V LogKernel(V x) {
+    // Scale denormals into the normal range first
+    V denormal = CmpLt(x, C<V>(std::numeric_limits<float>::min()));
+    V xs = Select(denormal, x * C<V>(8388608.0f), x); // 2^23
+    V ebias = Select(denormal, C<V>(-23.0f), C<V>(0.0f));
+
+    auto bits = AsInt(xs);
+    auto e = ShiftRightLogical<23>(bits & CI<V>(0x7f800000)) - CI<V>(126);
+    V m = AsFloat((bits & CI<V>(0x007fffff)) | CI<V>(0x3f000000)); // [0.5, 1)
+
+    V small = CmpLt(m, C<V>(0.70710678118654752440f));
+    V ef = ToFloat(e) + ebias - And(small, C<V>(1.0f));
+    m = m + And(small, m) - C<V>(1.0f);
+    V z = m * m;
+
+    V p;
+    if constexpr (Fast) {
+        p = MulAdd(m, C<V>(-1.470244376e-1f), C<V>(2.192439471e-1f));
+        p = MulAdd(p, m, C<V>(-2.525215344e-1f));
+        p = MulAdd(p, m, C<V>(3.327248679e-1f));
+    } else {
+        p = MulAdd(m, C<V>(7.0376836292e-2f), C<V>(-1.1514610310e-1f));
+        p = MulAdd(p, m, C<V>(1.1676998740e-1f));
+        p = MulAdd(p, m, C<V>(-1.2420140846e-1f));
+        p = MulAdd(p, m, C<V>(1.4249322787e-1f));
+        p = MulAdd(p, m, C<V>(-1.6668057665e-1f));
+        p = MulAdd(p, m, C<V>(2.0000714765e-1f));
+        p = MulAdd(p, m, C<V>(-2.4999993993e-1f));
+        p = MulAdd(p, m, C<V>(3.3333331174e-1f));
+    }
+    V y = p * m * z;
+    y = MulAdd(ef, C<V>(-2.12194440e-4f), y);
+    y = MulAdd(z, C<V>(-0.5f), y);
+    V r = MulAdd(ef, C<V>(0.693359375f), m + y);
+
+    // Special values: log(0) = -inf, log(+inf) = +inf, negative or NaN -> NaN
+    V inf = C<V>(std::numeric_limits<float>::infinity());
+    r = Select(CmpEq(x, C<V>(0.0f)), -inf, r);
+    r = Select(CmpEq(x, inf), inf, r);
+    V valid = CmpLe(C<V>(0.0f), x);
+    return Select(valid, r, C<V>(std::numeric_limits<float>::quiet_NaN()));
+}
+
+// Batch drivers: full vectors first, scalar lanes for the tail
+
+template <bool Fast>
+void SinCosBatch(const float* x, float* sinOut, float* cosOut, size_t count) {
+    size_t i = 0;
+    for (; i + FloatV::Width <= count; i += FloatV::Width) {
+        FloatV s, c;
+        SinCosKernel<Fast>(FloatV::Load(x + i), s, c);
+        if (sinOut) s.Store(sinOut + i);
+        if (cosOut) c.Store(cosOut + i);
+    }
+    for (; i < count; ++i) {
+        Float1 s, c;
+        SinCosKernel<Fast>(Float1::Load(x + i), s, c);
+        if (sinOut) s.Store(sinOut + i);
+        if (cosOut) c.Store(cosOut + i);
+    }
+}
+
+template <typename Kernel>
+void UnaryBatch(const float* x, float* out, size_t count, Kernel kernel) {
+    size_t i = 0;
+    for (; i + FloatV::Width <= count; i += FloatV::Width) {
+        kernel(FloatV::Load(x + i)).Store(out + i);
+    }
+    for (; i < count; ++i) {
+        kernel(Float1::Load(x + i)).Store(out + i);
+    }
+}
+
+template <typename Kernel>
+void BinaryBatch(const float* a, const float* b, float* out, size_t count, Kernel kernel) {
+    size_t i = 0;
+    for (; i + FloatV::Width <= count; i += FloatV::Width) {
+        kernel(FloatV::Load(a + i), FloatV::Load(b + i)).Store(out + i);
+    }
+    for (; i < count; ++i) {
+        kernel(Float1::Load(a + i), Float1::Load(b + i)).Store(out + i);
+    }
+}
+
+#define ALICE2_MATH_UNARY(Name, Kernel)                                                        \
+    void Name(const float* x, float* out, size_t count, Precision precision) {                 \
+        if (precision == Precision::Fast) {                                                    \
+            UnaryBatch(x, out, count, [](auto v) { return Kernel<true>(v); });                 \
+        } else {                                                                               \
+            UnaryBatch(x, out, count, [](auto v) { return Kernel<false>(v); });                \
+        }                                                                                      \
+    }                                                                                          \
+    float Name(float x, Precision precision) {                                                 \
+        return (precision == Precision::Fast ? Kernel<true>(Float1{x}) : Kernel<false>(Float1{x})).v; \
+    }
+
+} // namespace
+
+void SinCos(const float* x, float* sinOut, float* cosOut, size_t count, Precision precision) {
+    if (precision == Precision::Fast) {
+        SinCosBatch<true>(x, sinOut, cosOut, count);
+    } else {
+        SinCosBatch<false>(x, sinOut, cosOut, count);
+    }
+}
+
+void Sin(const float* x, float* out, size_t count, Precision precision) {
+    SinCos(x, out, nullptr, count, precision);
+}
+
+void Cos(const float* x, float* out, size_t count, Precision precision) {
+    SinCos(x, nullptr, out, count, precision);
+}
+
+void SinCos(float x, float& sinOut, float& cosOut, Precision precision) {
+    Float1 s, c;
+    if (precision == Precision::Fast) {
+        SinCosKernel<true>(Float1{x}, s, c);
+    } else {
+        SinCosKernel<false>(Float1{x}, s, c);
+    }
+    sinOut = s.v;
+    cosOut = c.v;
+}
+
+void Atan2(const float* y, const float* x, float* out, size_t count, Precision precision) {
+    if (precision == Precision::Fast) {
+        BinaryBatch(y, x, out, count, [](auto a, auto b) { return Atan2Kernel<true>(a, b); });
+    } else {
+        BinaryBatch(y, x, out, count, [](auto a, auto b) { return Atan2Kernel<false>(a, b); });
+    }
+}
+
+float Atan2(float y, float x, Precision precision) {
+    return (precision == Precision::Fast ? Atan2Kernel<true>(Float1{y}, Float1{x})
+                                         : Atan2Kernel<false>(Float1{y}, Float1{x})).v;
+}
+
+ALICE2_MATH_UNARY(Asin, AsinKernel)
+ALICE2_MATH_UNARY(Acos, AcosKernel)
+ALICE2_MATH_UNARY(Exp, ExpKernel)
+ALICE2_MATH_UNARY(Log, LogKernel)
+
+#undef ALICE2_MATH_UNARY
+
+} // namespace math
+} // namespace alice2
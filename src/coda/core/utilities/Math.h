@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+
+namespace alice2 {
+namespace math {
+
+// Batch transcendental kernels built on polynomial approximations and
+// vectorised for the target ISA (AVX2, SSE2 or wasm-simd128, scalar
+// otherwise). Input and output arrays may alias.
+//
+// Maximum error against correctly rounded results, measured over the
+// documented domains (identical across ISAs; FMA only changes rounding):
+//
+//   function   Accurate   Fast       domain
+//   SinCos     3 ulp      30 ulp     |x| <= 1e4 (reduction loses bits beyond)
+//   Atan2      4 ulp      300 ulp    all finite inputs, signed zeros honoured
+//   Asin/Acos  3 ulp      35 ulp     [-1, 1], NaN outside
+//   Exp        1 ulp      70 ulp     [-87.3, 88.72]; inf above, 0 below
+//   Log        1 ulp      220 ulp    positive floats incl. denormals; log(0) = -inf
+//
+// Fast uses lower-degree minimax polynomials; use it for animation and
+// display where a few hundred ulp (~2e-5 relative) are invisible.
+enum class Precision {
+    Fast,
+    Accurate
+};
+
+// Batch API
+void SinCos(const float* x, float* sinOut, float* cosOut, size_t count, Precision precision = Precision::Accurate);
+void Sin(const float* x, float* out, size_t count, Precision precision = Precision::Accurate);
+void Cos(const float* x, float* out, size_t count, Precision precision = Precision::Accurate);
+void Atan2(const float* y, const float* x, float* out, size_t count, Precision precision = Precision::Accurate);
+void Asin(const float* x, float* out, size_t count, Precision precision = Precision::Accurate);
+void Acos(const float* x, float* out, size_t count, Precision precision = Precision::Accurate);
+void Exp(const float* x, float* out, size_t count, Precision precision = Precision::Accurate);
+void Log(const float* x, float* out, size_t count, Precision precision = Precision::Accurate);
+
+// Scalar versions using the same polynomials (results match the batch API)
+void SinCos(float x, float& sinOut, float& cosOut, Precision precision = Precision::Accurate);
+float Atan2(float y, float x, Precision precision = Precision::Accurate);
+float Asin(float x, Precision precision = Precision::Accurate);
+float Acos(float x, Precision precision = Precision::Accurate);
+float Exp(float x, Precision precision = Precision::Accurate);
+float Log(float x, Precision precision = Precision::Accurate);
+
+} // namespace math
+} // namespace alice2
@@ -0,0 +1,179 @@
+#include "Parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+#define ALICE2_PARALLEL_SERIAL 1
+#endif
+
+namespace alice2 {
+namespace parallel {
+
+namespace {
+
+thread_local bool t_InsideParallel = false;
+
+// Persistent worker pool. One job runs at a time; the submitting thread
+// claims chunks alongside the workers through a shared atomic counter.
+class ThreadPool {
+public:
+    static ThreadPool& Get() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    size_t ThreadCount() const { return m_Workers.size() + 1; }
+
+    void Run(size_t chunkCount, const std::function<void(size_t)>& task) {
+        if (chunkCount == 0) {
+            return;
+        }
+        if (chunkCount == 1 || m_Workers.empty() || t_InsideParallel) {
+            for (size_t i = 0; i < chunkCount; ++i) {
+                task(i);
+            }
+            return;
+        }
+
+        std::lock_guard<std::mutex> submitLock(m_SubmitMutex);
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Task = &task;
+            m_ChunkCount = chunkCount;
+            m_NextChunk.store(0);
+            m_DoneChunks.store(0);
+            ++m_Generation;
+        }
+        m_WakeCondition.notify_all();
+
+        t_InsideParallel = true;
+        Work(task, chunkCount);
+        t_InsideParallel = false;
+
+        // Wait for all chunks and for every worker to leave the job
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_DoneCondition.wait(lock, [this] { return m_DoneChunks.load() == m_ChunkCount && m_ActiveWorkers == 0; });
+        m_Task = nullptr;
+    }
+
+private:
+    std::vector<std::thread> m_Workers;
+    std::mutex m_SubmitMutex;
+    std::mutex m_Mutex;
+    std::condition_variable m_WakeCondition;
+    std::condition_variable m_DoneCondition;
+
+    const std::function<void(size_t)>* m_Task = nullptr;
+    size_t m_ChunkCount = 0;
+    std::atomic<size_t> m_NextChunk{0};
+    std::atomic<size_t> m_DoneChunks{0};
+    uint64_t m_Generation = 0;
+    size_t m_ActiveWorkers = 0;
+    bool m_Stop = false;
+
+    ThreadPool() {
+#if !defined(ALICE2_PARALLEL_SERIAL)
+        unsigned hardware = std::thread::hardware_concurrency();
+        size_t workerCount = hardware > 1 ? hardware - 1 : 0;
+        for (size_t i = 0; i < workerCount; ++i) {
+            m_Workers.emplace_back([this] { WorkerLoop(); });
+        }
+#endif
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Stop = true;
+        }
+        m_WakeCondition.notify_all();
+        for (auto& worker : m_Workers) {
+            worker.join();
+        }
+    }
+
+    void Work(const std::function<void(size_t)>& task, size_t chunkCount) {
+        size_t finished = 0;
+        for (size_t chunk = m_NextChunk.fetch_add(1); chunk < chunkCount; chunk = m_NextChunk.fetch_add(1)) {
+            task(chunk);
+            ++finished;
+        }
+        if (finished > 0 && m_DoneChunks.fetch_add(finished) + finished == chunkCount) {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_DoneCondition.notify_all();
+        }
+    }
+
+    void WorkerLoop() {
+        t_InsideParallel = true;
+        uint64_t seenGeneration = 0;
+
+        while (true) {
+            const std::function<void(size_t)>* task = nullptr;
+            size_t chunkCount = 0;
+            {
+                std::unique_lock<std::mutex> lock(m_Mutex);
+                m_WakeCondition.wait(lock, [&] { return m_Stop || (m_Generation != seenGeneration && m_Task); });
+                if (m_Stop) {
+                    return;
+                }
+                seenGeneration = m_Generation;
+                task = m_Task;
+                chunkCount = m_ChunkCount;
+                ++m_ActiveWorkers;
+            }
+
+            Work(*task, chunkCount);
+
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            --m_ActiveWorkers;
+            m_DoneCondition.notify_all();
+        }
+    }
+};
+
+} // namespace
+
+size_t ThreadCount() {
+    return ThreadPool::Get().ThreadCount();
+}
+
+size_t ChunkCount(size_t count, size_t grainSize) {
+    if (count == 0) {
+        return 0;
+    }
+    grainSize = std::max<size_t>(grainSize, 1);
+    // A few chunks per thread balances uneven work without excess scheduling
+    size_t maxChunks = ThreadCount() * 4;
+    size_t chunks = (count + grainSize - 1) / grainSize;
+    return std::max<size_t>(1, std::min(chunks, maxChunks));
+}
+
+void For(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& body) {
+    size_t chunkCount = ChunkCount(count, grainSize);
+    if (chunkCount == 0) {
+        return;
+    }
+    size_t chunkSize = (count + chunkCount - 1) / chunkCount;
+
+    ThreadPool::Get().Run(chunkCount, [&](size_t chunk) {
+        size_t begin = chunk * chunkSize;
+        size_t end = std::min(count, begin + chunkSize);
+        if (begin < end) {
+            body(begin, end);
+        }
+    });
+}
+
+void ForChunks(size_t chunkCount, const std::function<void(size_t)>& task) {
+    ThreadPool::Get().Run(chunkCount, task);
+}
+
+} // namespace parallel
+} // namespace alice2
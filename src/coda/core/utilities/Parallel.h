@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+namespace alice2 {
+namespace parallel {
+
+// Number of threads that participate in a parallel loop (workers + caller).
+// Single-threaded web builds without pthreads report 1.
+size_t ThreadCount();
+
+// Splits [0, count) into chunks of at least grainSize elements and runs
+// body(begin, end) on the shared worker pool; the caller works too and the
+// call returns once every chunk is done. Nested calls from inside a body run
+// inline on the calling worker.
+void For(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& body);
+
+// Runs task(chunk) for chunk in [0, chunkCount), one chunk per invocation.
+// Useful when per-chunk state (histograms, partial sums) is indexed by chunk.
+void ForChunks(size_t chunkCount, const std::function<void(size_t)>& task);
+
+// Chunk count For() would use for count elements; lets callers size
+// per-chunk scratch to match ForChunks.
+size_t ChunkCount(size_t count, size_t grainSize);
+
+} // namespace parallel
+} // namespace alice2
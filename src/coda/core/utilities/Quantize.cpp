@@ -0,0 +1,477 @@
+#include "Quantize.h"
+#include "Parallel.h"
+#include "Simd.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace alice2 {
+namespace quantize {
+
+using namespace simd;
+
+namespace {
+
+constexpr size_t GrainSize = 1 << 16;
+
+template <typename V> inline V C(float x) { return V::Broadcast(x); }
+template <typename V> inline typename V::Int CI(int32_t x) { return V::Int::Broadcast(x); }
+
+template <typename I> inline I SelectInt(decltype(AsFloat(I())) mask, I a, I b) {
+    return AsInt(Select(mask, AsFloat(a), AsFloat(b)));
+}
+
+// NaN lanes become 0 so clamping and rounding stay well defined
+template <typename V> inline V ZeroNaN(V x) { return And(CmpEq(x, x), x); }
+
+// Giesen's branchless float -> half with round to nearest even. The three
+// cases (normal, subnormal via a magic add, inf/NaN) are computed per lane
+// and selected.
+template <typename V>
+inline typename V::Int FloatToHalfKernel(V x) {
+    using I = typename V::Int;
+    I f = AsInt(x);
+    I sign = f & CI<V>(static_cast<int32_t>(0x80000000u));
+    f = f ^ sign;
+
+    I mantissaOdd = ShiftRightLogical<13>(f) & CI<V>(1);
+    I normal = ShiftRightLogical<13>(f + CI<V>(((15 - 127) << 23) + 0xfff) + mantissaOdd);
+
+    I denormalMagic = CI<V>(((127 - 15) + (23 - 10) + 1) << 23);
+    I denormal = AsInt(AsFloat(f) + AsFloat(denormalMagic)) - denormalMagic;
+
+    I infNan = SelectInt<I>(CmpGt(f, CI<V>(0x7f800000)), CI<V>(0x7e00), CI<V>(0x7c00));
+
+    I h = SelectInt<I>(CmpGt(CI<V>(113 << 23), f), denormal, normal);
+    h = SelectInt<I>(CmpGt(f, CI<V>(0x477fffff)), infNan, h);
+    return h | ShiftRightLogical<16>(sign);
+}
+
+template <typename V>
+inline V HalfToFloatKernel(typename V::Int h) {
+    using I = typename V::Int;
+    I shiftedExponent = CI<V>(0x7c00 << 13);
+    I o = ShiftLeft<13>(h & CI<V>(0x7fff));
+    I exponent = o & shiftedExponent;
+    o = o + CI<V>((127 - 15) << 23);
+
+    I infNan = o + CI<V>((128 - 16) << 23);
+    I denormal = AsInt(AsFloat(o + CI<V>(1 << 23)) - AsFloat(CI<V>(113 << 23)));
+
+    o = SelectInt<I>(CmpEq(exponent, shiftedExponent), infNan, o);
+    o = SelectInt<I>(CmpEq(exponent, CI<V>(0)), denormal, o);
+    return AsFloat(o | ShiftLeft<16>(h & CI<V>(0x8000)));
+}
+
+template <typename V>
+inline typename V::Int FloatToSnorm16Kernel(V x) {
+    V clamped = Min(Max(ZeroNaN(x), C<V>(-1.0f)), C<V>(1.0f));
+    return RoundToInt(clamped * C<V>(32767.0f));
+}
+
+template <typename V>
+inline V Snorm16ToFloatKernel(typename V::Int q) {
+    return Max(ToFloat(q) * C<V>(1.0f / 32767.0f), C<V>(-1.0f));
+}
+
+template <typename V>
+inline typename V::Int FloatToUnorm8Kernel(V x) {
+    V clamped = Min(Max(ZeroNaN(x), C<V>(0.0f)), C<V>(1.0f));
+    return RoundToInt(clamped * C<V>(255.0f));
+}
+
+template <typename V>
+inline V Unorm8ToFloatKernel(typename V::Int q) {
+    return ToFloat(q) * C<V>(1.0f / 255.0f);
+}
+
+// copysign(1, x) without a branch; -0 maps to -1
+template <typename V> inline V SignNotZero(V x) { return Or(SignBit(x), C<V>(1.0f)); }
+
+// Octahedral map: project onto |x| + |y| + |z| = 1, fold the lower hemisphere
+// over the diagonals, pack both snorm16 values into one 32-bit word
+template <typename V>
+inline typename V::Int EncodeOctahedralKernel(V x, V y, V z) {
+    x = ZeroNaN(x);
+    y = ZeroNaN(y);
+    z = ZeroNaN(z);
+    V l1 = Abs(x) + Abs(y) + Abs(z);
+    V invL1 = Select(CmpGt(l1, C<V>(0.0f)), C<V>(1.0f) / l1, C<V>(0.0f));
+    V px = x * invL1;
+    V py = y * invL1;
+
+    V lower = CmpLt(z, C<V>(0.0f));
+    V foldedX = (C<V>(1.0f) - Abs(py)) * SignNotZero(px);
+    V foldedY = (C<V>(1.0f) - Abs(px)) * SignNotZero(py);
+    px = Select(lower, foldedX, px);
+    py = Select(lower, foldedY, py);
+
+    auto qx = FloatToSnorm16Kernel(px);
+    auto qy = FloatToSnorm16Kernel(py);
+    return (qx & CI<V>(0xffff)) | ShiftLeft<16>(qy);
+}
+
+template <typename V>
+inline void DecodeOctahedralKernel(typename V::Int packed, V& x, V& y, V& z) {
+    x = Snorm16ToFloatKernel<V>(ShiftRightArithmetic<16>(ShiftLeft<16>(packed)));
+    y = Snorm16ToFloatKernel<V>(ShiftRightArithmetic<16>(packed));
+    z = C<V>(1.0f) - Abs(x) - Abs(y);
+
+    // Unfold the lower hemisphere: move each coordinate towards zero by t
+    V t = Max(-z, C<V>(0.0f));
+    x = x - Or(t, SignBit(x));
+    y = y - Or(t, SignBit(y));
+
+    V invLength = C<V>(1.0f) / Sqrt(x * x + y * y + z * z);
+    x = x * invLength;
+    y = y * invLength;
+    z = z * invLength;
+}
+
+// Batch drivers: full vectors first, scalar lanes for the tail, chunks of
+// the range split across the thread pool
+
+template <typename Step>
+void RunBatch(size_t count, Step step) {
+    parallel::For(count, GrainSize, [&](size_t begin, size_t end) {
+        size_t i = begin;
+        for (; i + FloatV::Width <= end; i += FloatV::Width) {
+            step(FloatV(), i);
+        }
+        for (; i < end; ++i) {
+            step(Float1(), i);
+        }
+    });
+}
+
+template <typename V>
+inline void LoadVec3(const Vec3f* p, V& x, V& y, V& z) {
+    alignas(32) float xs[V::Width], ys[V::Width], zs[V::Width];
+    for (int lane = 0; lane < V::Width; ++lane) {
+        xs[lane] = p[lane].x;
+        ys[lane] = p[lane].y;
+        zs[lane] = p[lane].z;
+    }
+    x = V::Load(xs);
+    y = V::Load(ys);
+    z = V::Load(zs);
+}
+
+template <typename V>
+inline void StoreVec3(Vec3f* p, V x, V y, V z) {
+    alignas(32) float xs[V::Width], ys[V::Width], zs[V::Width];
+    x.Store(xs);
+    y.Store(ys);
+    z.Store(zs);
+    for (int lane = 0; lane < V::Width; ++lane) {
+        p[lane] = Vec3f(xs[lane], ys[lane], zs[lane]);
+    }
+}
+
+size_t ComponentSize(AttributeFormat format) {
+    switch (format) {
+    case AttributeFormat::Half:
+    case AttributeFormat::Snorm16:
+    case AttributeFormat::Octahedral:
+        return 2;
+    case AttributeFormat::Unorm8:
+        return 1;
+    case AttributeFormat::Float32:
+    default:
+        return 4;
+    }
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Scalar conversions
+// ---------------------------------------------------------------------------
+
+uint16_t FloatToHalf(float x) {
+    return static_cast<uint16_t>(FloatToHalfKernel(Float1::Broadcast(x)).v);
+}
+
+float HalfToFloat(uint16_t h) {
+    return HalfToFloatKernel<Float1>(Int1::Broadcast(h)).v;
+}
+
+int16_t FloatToSnorm16(float x) {
+    return static_cast<int16_t>(FloatToSnorm16Kernel(Float1::Broadcast(x)).v);
+}
+
+float Snorm16ToFloat(int16_t q) {
+    return Snorm16ToFloatKernel<Float1>(Int1::Broadcast(q)).v;
+}
+
+uint8_t FloatToUnorm8(float x) {
+    return static_cast<uint8_t>(FloatToUnorm8Kernel(Float1::Broadcast(x)).v);
+}
+
+float Unorm8ToFloat(uint8_t q) {
+    return Unorm8ToFloatKernel<Float1>(Int1::Broadcast(q)).v;
+}
+
+uint32_t EncodeOctahedral(const Vec3f& normal) {
+    auto packed = EncodeOctahedralKernel(Float1::Broadcast(normal.x), Float1::Broadcast(normal.y),
+                                         Float1::Broadcast(normal.z));
+    return static_cast<uint32_t>(packed.v);
+}
+
+Vec3f DecodeOctahedral(uint32_t packed) {
+    Float1 x, y, z;
+    DecodeOctahedralKernel<Float1>(Int1::Broadcast(static_cast<int32_t>(packed)), x, y, z);
+    return Vec3f(x.v, y.v, z.v);
+}
+
+// ---------------------------------------------------------------------------
+// Batch conversions
+// ---------------------------------------------------------------------------
+
+void FloatToHalf(const float* in, uint16_t* out, size_t count) {
+    RunBatch(count, [&](auto v, size_t i) {
+        using V = decltype(v);
+        FloatToHalfKernel(V::Load(in + i)).StoreU16(out + i);
+    });
+}
+
+void HalfToFloat(const uint16_t* in, float* out, size_t count) {
+    RunBatch(count, [&](auto v, size_t i) {
+        using V = decltype(v);
+        HalfToFloatKernel<V>(V::Int::LoadU16(in + i)).Store(out + i);
+    });
+}
+
+void FloatToSnorm16(const float* in, int16_t* out, size_t count) {
+    uint16_t* bits = reinterpret_cast<uint16_t*>(out);
+    RunBatch(count, [&](auto v, size_t i) {
+        using V = decltype(v);
+        FloatToSnorm16Kernel(V::Load(in + i)).StoreU16(bits + i);
+    });
+}
+
+void Snorm16ToFloat(const int16_t* in, float* out, size_t count) {
+    RunBatch(count, [&](auto v, size_t i) {
+        using V = decltype(v);
+        Snorm16ToFloatKernel<V>(V::Int::LoadS16(in + i)).Store(out + i);
+    });
+}
+
+void FloatToUnorm8(const float* in, uint8_t* out, size_t count) {
+    RunBatch(count, [&](auto v, size_t i) {
+        using V = decltype(v);
+        FloatToUnorm8Kernel(V::Load(in + i)).StoreU8(out + i);
+    });
+}
+
+void Unorm8ToFloat(const uint8_t* in, float* out, size_t count) {
+    RunBatch(count, [&](auto v, size_t i) {
+        using V = decltype(v);
+        Unorm8ToFloatKernel<V>(V::Int::LoadU8(in + i)).Store(out + i);
+    });
+}
+
+void EncodeOctahedral(const Vec3f* normals, uint32_t* out, size_t count) {
+    int32_t* words = reinterpret_cast<int32_t*>(out);
+    RunBatch(count, [&](auto v, size_t i) {
+        using V = decltype(v);
+        V x, y, z;
+        LoadVec3(normals + i, x, y, z);
+        EncodeOctahedralKernel(x, y, z).Store(words + i);
+    });
+}
+
+void DecodeOctahedral(const uint32_t* in, Vec3f* normals, size_t count) {
+    const int32_t* words = reinterpret_cast<const int32_t*>(in);
+    RunBatch(count, [&](auto v, size_t i) {
+        using V = decltype(v);
+        V x, y, z;
+        DecodeOctahedralKernel<V>(V::Int::Load(words + i), x, y, z);
+        StoreVec3(normals + i, x, y, z);
+    });
+}
+
+// ---------------------------------------------------------------------------
+// PackedAttribute
+// ---------------------------------------------------------------------------
+
+PackedAttribute::PackedAttribute(AttributeFormat format, int components)
+    : m_Format(format), m_Components(std::clamp(components, 1, 4)) {
+    if (m_Format == AttributeFormat::Octahedral) {
+        m_Components = 3;
+        m_StoredComponents = 2;
+    } else if (m_Format != AttributeFormat::Float32 && m_Components == 3) {
+        m_StoredComponents = 4;
+    } else {
+        m_StoredComponents = m_Components;
+    }
+    m_Stride = ComponentSize(m_Format) * m_StoredComponents;
+}
+
+bool PackedAttribute::IsVertexFetchable() const {
+    switch (m_Format) {
+    case AttributeFormat::Float32:
+    case AttributeFormat::Octahedral:
+        return true;
+    case AttributeFormat::Half:
+    case AttributeFormat::Snorm16:
+        return m_StoredComponents == 2 || m_StoredComponents == 4;
+    case AttributeFormat::Unorm8:
+        return m_StoredComponents == 4;
+    }
+    return false;
+}
+
+void PackedAttribute::Resize(size_t count) {
+    m_Count = count;
+    m_Storage.resize((count * m_Stride + 3) / 4, 0);
+}
+
+void PackedAttribute::Clear() {
+    m_Count = 0;
+    m_Storage.clear();
+}
+
+void PackedAttribute::Assign(const float* values, size_t count) {
+    m_Count = count;
+    m_Storage.assign((count * m_Stride + 3) / 4, 0);
+    parallel::For(count, GrainSize / 4, [&](size_t begin, size_t end) {
+        EncodeElements(values + begin * m_Components, begin, end - begin);
+    });
+}
+
+void PackedAttribute::Assign(const std::vector<float>& values) {
+    Assign(values.data(), values.size() / m_Components);
+}
+
+void PackedAttribute::Assign(const std::vector<Vec3f>& values) {
+    static_assert(sizeof(Vec3f) == sizeof(float) * 3, "Vec3f must be tightly packed");
+    Assign(reinterpret_cast<const float*>(values.data()), values.size() * 3 / m_Components);
+}
+
+void PackedAttribute::Assign(const std::vector<Color>& values) {
+    static_assert(sizeof(Color) == sizeof(float) * 4, "Color must be tightly packed");
+    Assign(reinterpret_cast<const float*>(values.data()), values.size() * 4 / m_Components);
+}
+
+void PackedAttribute::Extract(float* values) const {
+    parallel::For(m_Count, GrainSize / 4, [&](size_t begin, size_t end) {
+        DecodeElements(values + begin * m_Components, begin, end - begin);
+    });
+}
+
+std::vector<float> PackedAttribute::Extract() const {
+    std::vector<float> values(m_Count * m_Components);
+    Extract(values.data());
+    return values;
+}
+
+void PackedAttribute::Set(size_t index, const float* value) {
+    if (index < m_Count) {
+        EncodeElements(value, index, 1);
+    }
+}
+
+void PackedAttribute::Get(size_t index, float* value) const {
+    if (index < m_Count) {
+        DecodeElements(value, index, 1);
+    }
+}
+
+// Encodes count elements from source into slots [first, first + count).
+// Padded layouts are widened through a scratch block; padding encodes 0.
+void PackedAttribute::EncodeElements(const float* source, size_t first, size_t count) {
+    uint8_t* target = Bytes() + first * m_Stride;
+
+    if (m_Format == AttributeFormat::Octahedral) {
+        EncodeOctahedral(reinterpret_cast<const Vec3f*>(source), reinterpret_cast<uint32_t*>(target), count);
+        return;
+    }
+
+    constexpr size_t BlockSize = 1024;
+    float scratch[BlockSize * 4];
+    size_t components = static_cast<size_t>(m_Components);
+    size_t stored = static_cast<size_t>(m_StoredComponents);
+
+    for (size_t blockBegin = 0; blockBegin < count; blockBegin += BlockSize) {
+        size_t blockCount = std::min(BlockSize, count - blockBegin);
+        const float* block = source + blockBegin * components;
+        size_t valueCount = blockCount * stored;
+        if (stored != components) {
+            for (size_t i = 0; i < blockCount; ++i) {
+                for (size_t c = 0; c < stored; ++c) {
+                    scratch[i * stored + c] = c < components ? block[i * components + c] : 0.0f;
+                }
+            }
+            block = scratch;
+        }
+
+        uint8_t* out = target + blockBegin * m_Stride;
+        switch (m_Format) {
+        case AttributeFormat::Float32:
+            std::memcpy(out, block, valueCount * sizeof(float));
+            break;
+        case AttributeFormat::Half:
+            FloatToHalf(block, reinterpret_cast<uint16_t*>(out), valueCount);
+            break;
+        case AttributeFormat::Snorm16:
+            FloatToSnorm16(block, reinterpret_cast<int16_t*>(out), valueCount);
+            break;
+        case AttributeFormat::Unorm8:
+            FloatToUnorm8(block, out, valueCount);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+void PackedAttribute::DecodeElements(float* target, size_t first, size_t count) const {
+    const uint8_t* source = Bytes() + first * m_Stride;
+
+    if (m_Format == AttributeFormat::Octahedral) {
+        DecodeOctahedral(reinterpret_cast<const uint32_t*>(source), reinterpret_cast<Vec3f*>(target), count);
+        return;
+    }
+
+    constexpr size_t BlockSize = 1024;
+    float scratch[BlockSize * 4];
+    size_t components = static_cast<size_t>(m_Components);
+    size_t stored = static_cast<size_t>(m_StoredComponents);
+
+    for (size_t blockBegin = 0; blockBegin < count; blockBegin += BlockSize) {
+        size_t blockCount = std::min(BlockSize, count - blockBegin);
+        const uint8_t* in = source + blockBegin * m_Stride;
+        size_t valueCount = blockCount * stored;
+        float* block = stored != components ? scratch : target + blockBegin * components;
+
+        switch (m_Format) {
+        case AttributeFormat::Float32:
+            std::memcpy(block, in, valueCount * sizeof(float));
+            break;
+        case AttributeFormat::Half:
+            HalfToFloat(reinterpret_cast<const uint16_t*>(in), block, valueCount);
+            break;
+        case AttributeFormat::Snorm16:
+            Snorm16ToFloat(reinterpret_cast<const int16_t*>(in), block, valueCount);
+            break;
+        case AttributeFormat::Unorm8:
+            Unorm8ToFloat(in, block, valueCount);
+            break;
+        default:
+            break;
+        }
+
+        if (block == scratch) {
+            float* out = target + blockBegin * components;
+            for (size_t i = 0; i < blockCount; ++i) {
+                for (size_t c = 0; c < components; ++c) {
+                    out[i * components + c] = scratch[i * stored + c];
+                }
+            }
+        }
+    }
+}
+
+} // namespace quantize
+} // namespace alice2
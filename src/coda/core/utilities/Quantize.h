@@ -0,0 +1,107 @@
+#pragma once
+
+#include "../../../core/base/Types.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace alice2 {
+namespace quantize {
+
+// Compact storage types for attribute data. Encodings match the GPU vertex
+// formats bit for bit (Float16, Snorm16, Unorm8), so packed arrays can be
+// uploaded without conversion.
+//
+//   half       IEEE binary16, round to nearest even; overflow -> inf, NaN kept
+//   snorm16    round(clamp(x, -1, 1) * 32767); decodes as max(q / 32767, -1)
+//   unorm8     round(clamp(x, 0, 1) * 255)
+//   octahedral unit vector folded onto the octahedron, two snorm16 in one
+//              uint32_t (x in the low half); max angular error ~0.045 degrees
+//
+// NaN inputs encode as 0 for the normalised formats.
+
+// Scalar conversions
+uint16_t FloatToHalf(float x);
+float HalfToFloat(uint16_t h);
+int16_t FloatToSnorm16(float x);
+float Snorm16ToFloat(int16_t q);
+uint8_t FloatToUnorm8(float x);
+float Unorm8ToFloat(uint8_t q);
+uint32_t EncodeOctahedral(const Vec3f& normal);
+Vec3f DecodeOctahedral(uint32_t packed);
+
+// Batch conversions (SIMD, split across threads for large counts)
+void FloatToHalf(const float* in, uint16_t* out, size_t count);
+void HalfToFloat(const uint16_t* in, float* out, size_t count);
+void FloatToSnorm16(const float* in, int16_t* out, size_t count);
+void Snorm16ToFloat(const int16_t* in, float* out, size_t count);
+void FloatToUnorm8(const float* in, uint8_t* out, size_t count);
+void Unorm8ToFloat(const uint8_t* in, float* out, size_t count);
+void EncodeOctahedral(const Vec3f* normals, uint32_t* out, size_t count);
+void DecodeOctahedral(const uint32_t* in, Vec3f* normals, size_t count);
+
+enum class AttributeFormat {
+    Float32,
+    Half,
+    Snorm16,
+    Unorm8,
+    Octahedral // Unit normals only; 3 components in, 2 x snorm16 stored
+};
+
+// Per-element attribute array kept in a packed format. Three-component
+// half/snorm16/unorm8 data is padded to four components so the common
+// layouts map onto a vertex format and can be bound directly.
+//
+//   Vec3f normals   12 B -> 4 B (Octahedral)
+//   Color           16 B -> 4 B (Unorm8)
+//   Vec3f positions 12 B -> 8 B (Half)
+//   float scalars    4 B -> 2 B (Half, storage-buffer use only)
+class PackedAttribute {
+public:
+    PackedAttribute(AttributeFormat format = AttributeFormat::Float32, int components = 1);
+
+    // Replaces the contents with count elements of GetComponents() floats each
+    void Assign(const float* values, size_t count);
+    void Assign(const std::vector<float>& values);
+    void Assign(const std::vector<Vec3f>& values);
+    void Assign(const std::vector<Color>& values);
+
+    // Decodes every element into count * GetComponents() floats
+    void Extract(float* values) const;
+    std::vector<float> Extract() const;
+
+    // Single element access
+    void Set(size_t index, const float* value);
+    void Get(size_t index, float* value) const;
+
+    void Resize(size_t count);
+    void Clear();
+
+    AttributeFormat GetFormat() const { return m_Format; }
+    int GetComponents() const { return m_Components; }
+    int GetStoredComponents() const { return m_StoredComponents; }
+    size_t GetCount() const { return m_Count; }
+    size_t GetStride() const { return m_Stride; }
+    size_t GetByteSize() const { return m_Count * m_Stride; }
+    const void* GetData() const { return m_Storage.data(); }
+
+    // True when the stored layout maps to a WebGPU vertex format
+    bool IsVertexFetchable() const;
+
+private:
+    AttributeFormat m_Format;
+    int m_Components;
+    int m_StoredComponents;
+    size_t m_Stride;
+    size_t m_Count = 0;
+    std::vector<uint32_t> m_Storage; // Word storage keeps rows 4-byte aligned
+
+    uint8_t* Bytes() { return reinterpret_cast<uint8_t*>(m_Storage.data()); }
+    const uint8_t* Bytes() const { return reinterpret_cast<const uint8_t*>(m_Storage.data()); }
+    void EncodeElements(const float* source, size_t first, size_t count);
+    void DecodeElements(float* target, size_t first, size_t count) const;
+};
+
+} // namespace quantize
+} // namespace alice2
@@ -0,0 +1,361 @@
+#pragma once
+
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define ALICE2_SIMD_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ALICE2_SIMD_SSE2 1
+#elif defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#define ALICE2_SIMD_WASM 1
+#else
+#define ALICE2_SIMD_SCALAR 1
+#endif
+
+namespace alice2 {
+namespace simd {
+
+// Thin wrappers over the native float/int32 vector of the target ISA so kernels
+// are written once and instantiated for both FloatV (full width) and Float1
+// (scalar tail). Masks are float vectors with all bits set in true lanes.
+
+// ---------------------------------------------------------------------------
+// Scalar lane (always available; used for loop tails and the fallback ISA)
+// ---------------------------------------------------------------------------
+
+struct Int1;
+
+struct Float1 {
+    static constexpr int Width = 1;
+    using Int = Int1;
+    float v;
+
+    static Float1 Broadcast(float x) { return {x}; }
+    static Float1 Load(const float* p) { return {*p}; }
+    void Store(float* p) const { *p = v; }
+};
+
+struct Int1 {
+    static constexpr int Width = 1;
+    int32_t v;
+
+    static Int1 Broadcast(int32_t x) { return {x}; }
+
+    static Int1 Load(const int32_t* p) { return {*p}; }
+    void Store(int32_t* p) const { *p = v; }
+
+    // Widening loads and narrowing stores for packed attributes
+    // (StoreU16 keeps the low 16 bits, StoreU8 expects values in [0, 255])
+    static Int1 LoadU16(const uint16_t* p) { return {*p}; }
+    static Int1 LoadS16(const int16_t* p) { return {*p}; }
+    static Int1 LoadU8(const uint8_t* p) { return {*p}; }
+    void StoreU16(uint16_t* p) const { *p = static_cast<uint16_t>(v); }
+    void StoreU8(uint8_t* p) const { *p = static_cast<uint8_t>(v); }
+};
+
+inline Float1 operator+(Float1 a, Float1 b) { return {a.v + b.v}; }
+inline Float1 operator-(Float1 a, Float1 b) { return {a.v - b.v}; }
+inline Float1 operator*(Float1 a, Float1 b) { return {a.v * b.v}; }
+inline Float1 operator/(Float1 a, Float1 b) { return {a.v / b.v}; }
+inline Float1 operator-(Float1 a) { return {-a.v}; }
+inline Float1 MulAdd(Float1 a, Float1 b, Float1 c) { return {a.v * b.v + c.v}; }
+inline Float1 Min(Float1 a, Float1 b) { return {b.v < a.v ? b.v : a.v}; }
+inline Float1 Max(Float1 a, Float1 b) { return {a.v < b.v ? b.v : a.v}; }
+inline Float1 Sqrt(Float1 a) { return {std::sqrt(a.v)}; }
+
+inline Float1 MaskOf(bool b) { return {std::bit_cast<float>(b ? ~0u : 0u)}; }
+inline Float1 CmpLt(Float1 a, Float1 b) { return MaskOf(a.v < b.v); }
+inline Float1 CmpLe(Float1 a, Float1 b) { return MaskOf(a.v <= b.v); }
+inline Float1 CmpGt(Float1 a, Float1 b) { return MaskOf(a.v > b.v); }
+inline Float1 CmpEq(Float1 a, Float1 b) { return MaskOf(a.v == b.v); }
+
+inline Float1 BitOp(Float1 a, Float1 b, uint32_t (*op)(uint32_t, uint32_t)) {
+    return {std::bit_cast<float>(op(std::bit_cast<uint32_t>(a.v), std::bit_cast<uint32_t>(b.v)))};
+}
+inline Float1 And(Float1 a, Float1 b) { return BitOp(a, b, [](uint32_t x, uint32_t y) { return x & y; }); }
+inline Float1 Or(Float1 a, Float1 b) { return BitOp(a, b, [](uint32_t x, uint32_t y) { return x | y; }); }
+inline Float1 Xor(Float1 a, Float1 b) { return BitOp(a, b, [](uint32_t x, uint32_t y) { return x ^ y; }); }
+inline Float1 AndNot(Float1 a, Float1 b) { return BitOp(a, b, [](uint32_t x, uint32_t y) { return ~x & y; }); }
+inline Float1 Select(Float1 mask, Float1 a, Float1 b) { return Or(And(mask, a), AndNot(mask, b)); }
+// One bit per lane from the mask sign bits (lane 0 lowest)
+inline int MoveMask(Float1 mask) { return int(std::bit_cast<uint32_t>(mask.v) >> 31); }
+
+inline Int1 RoundToInt(Float1 a) { return {static_cast<int32_t>(std::nearbyint(a.v))}; }
+inline Float1 ToFloat(Int1 a) { return {static_cast<float>(a.v)}; }
+inline Int1 AsInt(Float1 a) { return {std::bit_cast<int32_t>(a.v)}; }
+inline Float1 AsFloat(Int1 a) { return {std::bit_cast<float>(a.v)}; }
+
+inline Int1 operator+(Int1 a, Int1 b) { return {a.v + b.v}; }
+inline Int1 operator-(Int1 a, Int1 b) { return {a.v - b.v}; }
+inline Int1 operator&(Int1 a, Int1 b) { return {a.v & b.v}; }
+inline Int1 operator|(Int1 a, Int1 b) { return {a.v | b.v}; }
+template <int N> inline Int1 ShiftLeft(Int1 a) { return {static_cast<int32_t>(static_cast<uint32_t>(a.v) << N)}; }
+template <int N> inline Int1 ShiftRightLogical(Int1 a) { return {static_cast<int32_t>(static_cast<uint32_t>(a.v) >> N)}; }
+inline Int1 operator^(Int1 a, Int1 b) { return {a.v ^ b.v}; }
+template <int N> inline Int1 ShiftRightArithmetic(Int1 a) { return {a.v >> N}; }
+inline Float1 CmpEq(Int1 a, Int1 b) { return MaskOf(a.v == b.v); }
+inline Float1 CmpGt(Int1 a, Int1 b) { return MaskOf(a.v > b.v); }
+
+// ---------------------------------------------------------------------------
+// Native vector lane
+// ---------------------------------------------------------------------------
+
+#if defined(ALICE2_SIMD_AVX2)
+
+struct IntV;
+
+struct FloatV {
+    static constexpr int Width = 8;
+    using Int = IntV;
+    __m256 v;
+
+    static FloatV Broadcast(float x) { return {_mm256_set1_ps(x)}; }
+    static FloatV Load(const float* p) { return {_mm256_loadu_ps(p)}; }
+    void Store(float* p) const { _mm256_storeu_ps(p, v); }
+};
+
+struct IntV {
+    static constexpr int Width = 8;
+    __m256i v;
+
+    static IntV Broadcast(int32_t x) { return {_mm256_set1_epi32(x)}; }
+
+    static IntV Load(const int32_t* p) { return {_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p))}; }
+    void Store(int32_t* p) const { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+
+    static IntV LoadU16(const uint16_t* p) { return {_mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)))}; }
+    static IntV LoadS16(const int16_t* p) { return {_mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)))}; }
+    static IntV LoadU8(const uint8_t* p) { return {_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)))}; }
+    void StoreU16(uint16_t* p) const {
+        // Sign-extend the low halves so the saturating pack keeps them intact
+        __m256i low = _mm256_srai_epi32(_mm256_slli_epi32(v, 16), 16);
+        __m128i packed = _mm_packs_epi32(_mm256_castsi256_si128(low), _mm256_extracti128_si256(low, 1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p), packed);
+    }
+    void StoreU8(uint8_t* p) const {
+        __m128i words = _mm_packs_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_packus_epi16(words, words));
+    }
+};
+
+inline FloatV operator+(FloatV a, FloatV b) { return {_mm256_add_ps(a.v, b.v)}; }
+inline FloatV operator-(FloatV a, FloatV b) { return {_mm256_sub_ps(a.v, b.v)}; }
+inline FloatV operator*(FloatV a, FloatV b) { return {_mm256_mul_ps(a.v, b.v)}; }
+inline FloatV operator/(FloatV a, FloatV b) { return {_mm256_div_ps(a.v, b.v)}; }
+inline FloatV operator-(FloatV a) { return {_mm256_xor_ps(a.v, _mm256_set1_ps(-0.0f))}; }
+#if defined(__FMA__)
+inline FloatV MulAdd(FloatV a, FloatV b, FloatV c) { return {_mm256_fmadd_ps(a.v, b.v, c.v)}; }
+#else
+inline FloatV MulAdd(FloatV a, FloatV b, FloatV c) { return {_mm256_add_ps(_mm256_mul_ps(a.v, b.v), c.v)}; }
+#endif
+inline FloatV Min(FloatV a, FloatV b) { return {_mm256_min_ps(a.v, b.v)}; }
+inline FloatV Max(FloatV a, FloatV b) { return {_mm256_max_ps(a.v, b.v)}; }
+inline FloatV Sqrt(FloatV a) { return {_mm256_sqrt_ps(a.v)}; }
+
+inline FloatV CmpLt(FloatV a, FloatV b) { return {_mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ)}; }
+inline FloatV CmpLe(FloatV a, FloatV b) { return {_mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ)}; }
+inline FloatV CmpGt(FloatV a, FloatV b) { return {_mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ)}; }
+inline FloatV CmpEq(FloatV a, FloatV b) { return {_mm256_cmp_ps(a.v, b.v, _CMP_EQ_OQ)}; }
+
+inline FloatV And(FloatV a, FloatV b) { return {_mm256_and_ps(a.v, b.v)}; }
+inline FloatV Or(FloatV a, FloatV b) { return {_mm256_or_ps(a.v, b.v)}; }
+inline FloatV Xor(FloatV a, FloatV b) { return {_mm256_xor_ps(a.v, b.v)}; }
+inline FloatV AndNot(FloatV a, FloatV b) { return {_mm256_andnot_ps(a.v, b.v)}; }
+inline FloatV Select(FloatV mask, FloatV a, FloatV b) { return {_mm256_blendv_ps(b.v, a.v, mask.v)}; }
+inline int MoveMask(FloatV mask) { return _mm256_movemask_ps(mask.v); }
+
+inline IntV RoundToInt(FloatV a) { return {_mm256_cvtps_epi32(a.v)}; }
+inline FloatV ToFloat(IntV a) { return {_mm256_cvtepi32_ps(a.v)}; }
+inline IntV AsInt(FloatV a) { return {_mm256_castps_si256(a.v)}; }
+inline FloatV AsFloat(IntV a) { return {_mm256_castsi256_ps(a.v)}; }
+
+inline IntV operator+(IntV a, IntV b) { return {_mm256_add_epi32(a.v, b.v)}; }
+inline IntV operator-(IntV a, IntV b) { return {_mm256_sub_epi32(a.v, b.v)}; }
+inline IntV operator&(IntV a, IntV b) { return {_mm256_and_si256(a.v, b.v)}; }
+inline IntV operator|(IntV a, IntV b) { return {_mm256_or_si256(a.v, b.v)}; }
+template <int N> inline IntV ShiftLeft(IntV a) { return {_mm256_slli_epi32(a.v, N)}; }
+template <int N> inline IntV ShiftRightLogical(IntV a) { return {_mm256_srli_epi32(a.v, N)}; }
+inline IntV operator^(IntV a, IntV b) { return {_mm256_xor_si256(a.v, b.v)}; }
+template <int N> inline IntV ShiftRightArithmetic(IntV a) { return {_mm256_srai_epi32(a.v, N)}; }
+inline FloatV CmpEq(IntV a, IntV b) { return {_mm256_castsi256_ps(_mm256_cmpeq_epi32(a.v, b.v))}; }
+inline FloatV CmpGt(IntV a, IntV b) { return {_mm256_castsi256_ps(_mm256_cmpgt_epi32(a.v, b.v))}; }
+
+#elif defined(ALICE2_SIMD_SSE2)
+
+struct IntV;
+
+struct FloatV {
+    static constexpr int Width = 4;
+    using Int = IntV;
+    __m128 v;
+
+    static FloatV Broadcast(float x) { return {_mm_set1_ps(x)}; }
+    static FloatV Load(const float* p) { return {_mm_loadu_ps(p)}; }
+    void Store(float* p) const { _mm_storeu_ps(p, v); }
+};
+
+struct IntV {
+    static constexpr int Width = 4;
+    __m128i v;
+
+    static IntV Broadcast(int32_t x) { return {_mm_set1_epi32(x)}; }
+
+    static IntV Load(const int32_t* p) { return {_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))}; }
+    void Store(int32_t* p) const { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+
+    static IntV LoadU16(const uint16_t* p) {
+        return {_mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)), _mm_setzero_si128())};
+    }
+    static IntV LoadS16(const int16_t* p) {
+        __m128i x = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+        return {_mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16)};
+    }
+    static IntV LoadU8(const uint8_t* p) {
+        int32_t bytes;
+        std::memcpy(&bytes, p, sizeof(bytes));
+        __m128i zero = _mm_setzero_si128();
+        return {_mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(bytes), zero), zero)};
+    }
+    void StoreU16(uint16_t* p) const {
+        // Sign-extend the low halves so the saturating pack keeps them intact
+        __m128i low = _mm_srai_epi32(_mm_slli_epi32(v, 16), 16);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_packs_epi32(low, low));
+    }
+    void StoreU8(uint8_t* p) const {
+        __m128i words = _mm_packs_epi32(v, v);
+        int32_t bytes = _mm_cvtsi128_si32(_mm_packus_epi16(words, words));
+        std::memcpy(p, &bytes, sizeof(bytes));
+    }
+};
+
+inline FloatV operator+(FloatV a, FloatV b) { return {_mm_add_ps(a.v, b.v)}; }
+inline FloatV operator-(FloatV a, FloatV b) { return {_mm_sub_ps(a.v, b.v)}; }
+inline FloatV operator*(FloatV a, FloatV b) { return {_mm_mul_ps(a.v, b.v)}; }
+inline FloatV operator/(FloatV a, FloatV b) { return {_mm_div_ps(a.v, b.v)}; }
+inline FloatV operator-(FloatV a) { return {_mm_xor_ps(a.v, _mm_set1_ps(-0.0f))}; }
+inline FloatV MulAdd(FloatV a, FloatV b, FloatV c) { return {_mm_add_ps(_mm_mul_ps(a.v, b.v), c.v)}; }
+inline FloatV Min(FloatV a, FloatV b) { return {_mm_min_ps(a.v, b.v)}; }
+inline FloatV Max(FloatV a, FloatV b) { return {_mm_max_ps(a.v, b.v)}; }
+inline FloatV Sqrt(FloatV a) { return {_mm_sqrt_ps(a.v)}; }
+
+inline FloatV CmpLt(FloatV a, FloatV b) { return {_mm_cmplt_ps(a.v, b.v)}; }
+inline FloatV CmpLe(FloatV a, FloatV b) { return {_mm_cmple_ps(a.v, b.v)}; }
+inline FloatV CmpGt(FloatV a, FloatV b) { return {_mm_cmpgt_ps(a.v, b.v)}; }
+inline FloatV CmpEq(FloatV a, FloatV b) { return {_mm_cmpeq_ps(a.v, b.v)}; }
+
+inline FloatV And(FloatV a, FloatV b) { return {_mm_and_ps(a.v, b.v)}; }
+inline FloatV Or(FloatV a, FloatV b) { return {_mm_or_ps(a.v, b.v)}; }
+inline FloatV Xor(FloatV a, FloatV b) { return {_mm_xor_ps(a.v, b.v)}; }
+inline FloatV AndNot(FloatV a, FloatV b) { return {_mm_andnot_ps(a.v, b.v)}; }
+inline FloatV Select(FloatV mask, FloatV a, FloatV b) { return {_mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v))}; }
+inline int MoveMask(FloatV mask) { return _mm_movemask_ps(mask.v); }
+
+inline IntV RoundToInt(FloatV a) { return {_mm_cvtps_epi32(a.v)}; }
+inline FloatV ToFloat(IntV a) { return {_mm_cvtepi32_ps(a.v)}; }
+inline IntV AsInt(FloatV a) { return {_mm_castps_si128(a.v)}; }
+inline FloatV AsFloat(IntV a) { return {_mm_castsi128_ps(a.v)}; }
+
+inline IntV operator+(IntV a, IntV b) { return {_mm_add_epi32(a.v, b.v)}; }
+inline IntV operator-(IntV a, IntV b) { return {_mm_sub_epi32(a.v, b.v)}; }
+inline IntV operator&(IntV a, IntV b) { return {_mm_and_si128(a.v, b.v)}; }
+inline IntV operator|(IntV a, IntV b) { return {_mm_or_si128(a.v, b.v)}; }
+template <int N> inline IntV ShiftLeft(IntV a) { return {_mm_slli_epi32(a.v, N)}; }
+template <int N> inline IntV ShiftRightLogical(IntV a) { return {_mm_srli_epi32(a.v, N)}; }
+inline IntV operator^(IntV a, IntV b) { return {_mm_xor_si128(a.v, b.v)}; }
+template <int N> inline IntV ShiftRightArithmetic(IntV a) { return {_mm_srai_epi32(a.v, N)}; }
+inline FloatV CmpEq(IntV a, IntV b) { return {_mm_castsi128_ps(_mm_cmpeq_epi32(a.v, b.v))}; }
+inline FloatV CmpGt(IntV a, IntV b) { return {_mm_castsi128_ps(_mm_cmpgt_epi32(a.v, b.v))}; }
+
+#elif defined(ALICE2_SIMD_WASM)
+
+struct IntV;
+
+struct FloatV {
+    static constexpr int Width = 4;
+    using Int = IntV;
+    v128_t v;
+
+    static FloatV Broadcast(float x) { return {wasm_f32x4_splat(x)}; }
+    static FloatV Load(const float* p) { return {wasm_v128_load(p)}; }
+    void Store(float* p) const { wasm_v128_store(p, v); }
+};
+
+struct IntV {
+    static constexpr int Width = 4;
+    v128_t v;
+
+    static IntV Broadcast(int32_t x) { return {wasm_i32x4_splat(x)}; }
+
+    static IntV Load(const int32_t* p) { return {wasm_v128_load(p)}; }
+    void Store(int32_t* p) const { wasm_v128_store(p, v); }
+
+    static IntV LoadU16(const uint16_t* p) { return {wasm_u32x4_load16x4(p)}; }
+    static IntV LoadS16(const int16_t* p) { return {wasm_i32x4_load16x4(p)}; }
+    static IntV LoadU8(const uint8_t* p) {
+        return {wasm_u32x4_extend_low_u16x8(wasm_u16x8_extend_low_u8x16(wasm_v128_load32_zero(p)))};
+    }
+    void StoreU16(uint16_t* p) const {
+        wasm_v128_store64_lane(p, wasm_i8x16_shuffle(v, v, 0, 1, 4, 5, 8, 9, 12, 13, 0, 1, 4, 5, 8, 9, 12, 13), 0);
+    }
+    void StoreU8(uint8_t* p) const {
+        wasm_v128_store32_lane(p, wasm_i8x16_shuffle(v, v, 0, 4, 8, 12, 0, 4, 8, 12, 0, 4, 8, 12, 0, 4, 8, 12), 0);
+    }
+};
+
+inline FloatV operator+(FloatV a, FloatV b) { return {wasm_f32x4_add(a.v, b.v)}; }
+inline FloatV operator-(FloatV a, FloatV b) { return {wasm_f32x4_sub(a.v, b.v)}; }
+inline FloatV operator*(FloatV a, FloatV b) { return {wasm_f32x4_mul(a.v, b.v)}; }
+inline FloatV operator/(FloatV a, FloatV b) { return {wasm_f32x4_div(a.v, b.v)}; }
+inline FloatV operator-(FloatV a) { return {wasm_f32x4_neg(a.v)}; }
+inline FloatV MulAdd(FloatV a, FloatV b, FloatV c) { return {wasm_f32x4_add(wasm_f32x4_mul(a.v, b.v), c.v)}; }
+inline FloatV Min(FloatV a, FloatV b) { return {wasm_f32x4_pmin(a.v, b.v)}; }
+inline FloatV Max(FloatV a, FloatV b) { return {wasm_f32x4_pmax(a.v, b.v)}; }
+inline FloatV Sqrt(FloatV a) { return {wasm_f32x4_sqrt(a.v)}; }
+
+inline FloatV CmpLt(FloatV a, FloatV b) { return {wasm_f32x4_lt(a.v, b.v)}; }
+inline FloatV CmpLe(FloatV a, FloatV b) { return {wasm_f32x4_le(a.v, b.v)}; }
+inline FloatV CmpGt(FloatV a, FloatV b) { return {wasm_f32x4_gt(a.v, b.v)}; }
+inline FloatV CmpEq(FloatV a, FloatV b) { return {wasm_f32x4_eq(a.v, b.v)}; }
+
+inline FloatV And(FloatV a, FloatV b) { return {wasm_v128_and(a.v, b.v)}; }
+inline FloatV Or(FloatV a, FloatV b) { return {wasm_v128_or(a.v, b.v)}; }
+inline FloatV Xor(FloatV a, FloatV b) { return {wasm_v128_xor(a.v, b.v)}; }
+inline FloatV AndNot(FloatV a, FloatV b) { return {wasm_v128_andnot(b.v, a.v)}; }
+inline FloatV Select(FloatV mask, FloatV a, FloatV b) { return {wasm_v128_bitselect(a.v, b.v, mask.v)}; }
+inline int MoveMask(FloatV mask) { return int(wasm_i32x4_bitmask(mask.v)); }
+
+inline IntV RoundToInt(FloatV a) { return {wasm_i32x4_trunc_sat_f32x4(wasm_f32x4_nearest(a.v))}; }
+inline FloatV ToFloat(IntV a) { return {wasm_f32x4_convert_i32x4(a.v)}; }
+inline IntV AsInt(FloatV a) { return {a.v}; }
+inline FloatV AsFloat(IntV a) { return {a.v}; }
+
+inline IntV operator+(IntV a, IntV b) { return {wasm_i32x4_add(a.v, b.v)}; }
+inline IntV operator-(IntV a, IntV b) { return {wasm_i32x4_sub(a.v, b.v)}; }
+inline IntV operator&(IntV a, IntV b) { return {wasm_v128_and(a.v, b.v)}; }
+inline IntV operator|(IntV a, IntV b) { return {wasm_v128_or(a.v, b.v)}; }
+template <int N> inline IntV ShiftLeft(IntV a) { return {wasm_i32x4_shl(a.v, N)}; }
+template <int N> inline IntV ShiftRightLogical(IntV a) { return {wasm_u32x4_shr(a.v, N)}; }
+inline IntV operator^(IntV a, IntV b) { return {wasm_v128_xor(a.v, b.v)}; }
+template <int N> inline IntV ShiftRightArithmetic(IntV a) { return {wasm_i32x4_shr(a.v, N)}; }
+inline FloatV CmpEq(IntV a, IntV b) { return {wasm_i32x4_eq(a.v, b.v)}; }
+inline FloatV CmpGt(IntV a, IntV b) { return {wasm_i32x4_gt(a.v, b.v)}; }
+
+#else
+
+using FloatV = Float1;
+using IntV = Int1;
+
+#endif
+
+// Common helpers built on the primitives above
+template <typename V> inline V Abs(V a) { return AndNot(V::Broadcast(-0.0f), a); }
+template <typename V> inline V SignBit(V a) { return And(V::Broadcast(-0.0f), a); }
+
+} // namespace simd
+} // namespace alice2
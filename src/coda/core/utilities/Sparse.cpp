@@ -0,0 +1,894 @@
+#include "Sparse.h"
+#include "Parallel.h"
+#include "SpatialSort.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iostream>
+#include <numeric>
+
+namespace alice2 {
+namespace sparse {
+
+namespace {
+
+constexpr size_t GrainSize = 4096;
+constexpr uint32_t LeafSize = 64;   // Nested dissection stops below this
+constexpr uint32_t MinSubtree = 256; // Smaller subtrees are factored sequentially
+
+// Deterministic parallel dot product: partial sums per chunk, added in order
+double Dot(const double* a, const double* b, size_t count) {
+    size_t chunkCount = parallel::ChunkCount(count, GrainSize);
+    if (chunkCount == 0) {
+        return 0.0;
+    }
+    size_t chunkSize = (count + chunkCount - 1) / chunkCount;
+    std::vector<double> partial(chunkCount, 0.0);
+    parallel::ForChunks(chunkCount, [&](size_t chunk) {
+        size_t end = std::min(count, (chunk + 1) * chunkSize);
+        double sum = 0.0;
+        for (size_t i = chunk * chunkSize; i < end; ++i) {
+            sum += a[i] * b[i];
+        }
+        partial[chunk] = sum;
+    });
+    double sum = 0.0;
+    for (double value : partial) {
+        sum += value;
+    }
+    return sum;
+}
+
+// Rows of (row, column) keys sorted with the parallel radix sort; equal
+// keys are summed
+bool AssembleRows(size_t rows, size_t columns, const std::vector<Triplet>& triplets, bool transposed,
+                  std::vector<uint32_t>& offsets, std::vector<uint32_t>& indices, std::vector<double>& values) {
+    std::vector<uint64_t> keys(triplets.size());
+    std::vector<uint32_t> order(triplets.size());
+    for (size_t t = 0; t < triplets.size(); ++t) {
+        const Triplet& triplet = triplets[t];
+        if (triplet.row >= rows || triplet.column >= columns) {
+            std::cerr << "sparse: triplet (" << triplet.row << ", " << triplet.column << ") outside a " << rows
+                      << " x " << columns << " matrix" << std::endl;
+            return false;
+        }
+        uint64_t major = transposed ? triplet.column : triplet.row;
+        uint64_t minor = transposed ? triplet.row : triplet.column;
+        keys[t] = (major << 32) | minor;
+        order[t] = static_cast<uint32_t>(t);
+    }
+    spatial::RadixSort(keys, order);
+
+    size_t majorCount = transposed ? columns : rows;
+    offsets.assign(majorCount + 1, 0);
+    indices.clear();
+    values.clear();
+    indices.reserve(keys.size());
+    values.reserve(keys.size());
+    for (size_t t = 0; t < keys.size(); ++t) {
+        if (t > 0 && keys[t] == keys[t - 1]) {
+            values.back() += triplets[order[t]].value;
+            continue;
+        }
+        indices.push_back(static_cast<uint32_t>(keys[t]));
+        values.push_back(triplets[order[t]].value);
+        ++offsets[(keys[t] >> 32) + 1];
+    }
+    for (size_t i = 0; i < majorCount; ++i) {
+        offsets[i + 1] += offsets[i];
+    }
+    return true;
+}
+
+void TransposeArrays(size_t majorCount, size_t minorCount, const std::vector<uint32_t>& offsets,
+                     const std::vector<uint32_t>& indices, const std::vector<double>& values,
+                     std::vector<uint32_t>& outOffsets, std::vector<uint32_t>& outIndices,
+                     std::vector<double>& outValues) {
+    outOffsets.assign(minorCount + 1, 0);
+    for (uint32_t index : indices) {
+        ++outOffsets[index + 1];
+    }
+    for (size_t i = 0; i < minorCount; ++i) {
+        outOffsets[i + 1] += outOffsets[i];
+    }
+    outIndices.resize(indices.size());
+    outValues.resize(values.size());
+    std::vector<uint32_t> next(outOffsets.begin(), outOffsets.end() - 1);
+    for (size_t major = 0; major < majorCount; ++major) {
+        for (uint32_t k = offsets[major]; k < offsets[major + 1]; ++k) {
+            uint32_t position = next[indices[k]]++;
+            outIndices[position] = static_cast<uint32_t>(major);
+            outValues[position] = values[k];
+        }
+    }
+}
+
+// Nested dissection with level-structure separators. Each range of order[]
+// is split by a breadth-first search from a pseudo-peripheral vertex: the
+// middle level, trimmed to the vertices touching the next level, separates
+// the earlier levels from the later ones and is numbered last. Ranges
+// shrink to LeafSize. Returns order[new] = original.
+std::vector<uint32_t> NestedDissection(const CsrMatrix& matrix) {
+    uint32_t n = static_cast<uint32_t>(matrix.GetRowCount());
+    const std::vector<uint32_t>& offsets = matrix.GetRowOffsets();
+    const std::vector<uint32_t>& adjacency = matrix.GetColumnIndices();
+
+    std::vector<uint32_t> order(n);
+    std::iota(order.begin(), order.end(), 0u);
+    std::vector<uint32_t> region(n, 0);
+    std::vector<int32_t> level(n, -1);
+    std::vector<uint32_t> queue;
+    std::vector<uint32_t> scratch;
+    queue.reserve(n);
+
+    const uint32_t Separated = ~0u;
+    auto search = [&](uint32_t start, uint32_t id) {
+        queue.clear();
+        level[start] = 0;
+        queue.push_back(start);
+        for (size_t q = 0; q < queue.size(); ++q) {
+            uint32_t v = queue[q];
+            for (uint32_t k = offsets[v]; k < offsets[v + 1]; ++k) {
+                uint32_t u = adjacency[k];
+                if (region[u] == id && level[u] < 0) {
+                    level[u] = level[v] + 1;
+                    queue.push_back(u);
+                }
+            }
+        }
+    };
+
+    struct Range {
+        uint32_t begin, end, id;
+    };
+    std::vector<Range> stack = {{0, n, 0}};
+    uint32_t nextId = 1;
+    while (!stack.empty()) {
+        Range range = stack.back();
+        stack.pop_back();
+        uint32_t size = range.end - range.begin;
+        if (size <= LeafSize) {
+            continue;
+        }
+        auto resetLevels = [&]() {
+            for (uint32_t i = range.begin; i < range.end; ++i) {
+                level[order[i]] = -1;
+            }
+        };
+
+        resetLevels();
+        search(order[range.begin], range.id);
+        if (queue.size() < size) {
+            // Disconnected: split off the component just found
+            uint32_t* first = order.data() + range.begin;
+            uint32_t* middle = std::partition(first, order.data() + range.end,
+                                              [&](uint32_t v) { return level[v] >= 0; });
+            uint32_t split = static_cast<uint32_t>(middle - order.data());
+            uint32_t idA = nextId++, idB = nextId++;
+            for (uint32_t i = range.begin; i < range.end; ++i) {
+                region[order[i]] = i < split ? idA : idB;
+            }
+            stack.push_back({range.begin, split, idA});
+            stack.push_back({split, range.end, idB});
+            continue;
+        }
+
+        uint32_t far = queue.back();
+        resetLevels();
+        search(far, range.id);
+        int32_t depth = level[queue.back()];
+        if (depth < 2) {
+            continue;
+        }
+        int32_t middleLevel = std::clamp(level[queue[size / 2]], 1, depth - 1);
+
+        // A: before the separator, B: after it, S: level vertices touching B
+        scratch.clear();
+        uint32_t countA = 0, countB = 0;
+        for (uint32_t v : queue) {
+            bool separator = false;
+            if (level[v] == middleLevel) {
+                for (uint32_t k = offsets[v]; k < offsets[v + 1] && !separator; ++k) {
+                    uint32_t u = adjacency[k];
+                    separator = region[u] == range.id && level[u] == middleLevel + 1;
+                }
+            }
+            if (separator) {
+                level[v] = -2;
+            } else if (level[v] > middleLevel) {
+                ++countB;
+            } else {
+                ++countA;
+            }
+        }
+        uint32_t writeA = range.begin, writeB = range.begin + countA, writeS = writeB + countB;
+        uint32_t idA = nextId++, idB = nextId++;
+        for (uint32_t v : queue) {
+            if (level[v] == -2) {
+                order[writeS++] = v;
+                region[v] = Separated;
+            } else if (level[v] > middleLevel) {
+                order[writeB++] = v;
+                region[v] = idB;
+            } else {
+                order[writeA++] = v;
+                region[v] = idA;
+            }
+        }
+        stack.push_back({range.begin, range.begin + countA, idA});
+        stack.push_back({range.begin + countA, range.begin + countA + countB, idB});
+    }
+    return order;
+}
+
+// Elimination tree from the permuted lower triangle by rows (Liu's
+// algorithm with path compression)
+void EliminationTree(uint32_t n, const std::vector<uint32_t>& rowOffsets, const std::vector<uint32_t>& rowIndices,
+                     std::vector<int32_t>& parent) {
+    parent.assign(n, -1);
+    std::vector<int32_t> ancestor(n, -1);
+    for (uint32_t k = 0; k < n; ++k) {
+        for (uint32_t p = rowOffsets[k]; p < rowOffsets[k + 1]; ++p) {
+            int32_t i = static_cast<int32_t>(rowIndices[p]);
+            while (i != -1 && i < static_cast<int32_t>(k)) {
+                int32_t next = ancestor[i];
+                ancestor[i] = static_cast<int32_t>(k);
+                if (next == -1) {
+                    parent[i] = static_cast<int32_t>(k);
+                }
+                i = next;
+            }
+        }
+    }
+}
+
+std::vector<uint32_t> Postorder(const std::vector<int32_t>& parent) {
+    uint32_t n = static_cast<uint32_t>(parent.size());
+    std::vector<int32_t> head(n, -1), next(n, -1);
+    for (int32_t j = static_cast<int32_t>(n) - 1; j >= 0; --j) {
+        if (parent[j] != -1) {
+            next[j] = head[parent[j]];
+            head[parent[j]] = j;
+        }
+    }
+    std::vector<uint32_t> post;
+    post.reserve(n);
+    std::vector<int32_t> stack;
+    for (uint32_t root = 0; root < n; ++root) {
+        if (parent[root] != -1) {
+            continue;
+        }
+        stack.push_back(static_cast<int32_t>(root));
+        while (!stack.empty()) {
+            int32_t p = stack.back();
+            int32_t child = head[p];
+            if (child == -1) {
+                stack.pop_back();
+                post.push_back(static_cast<uint32_t>(p));
+            } else {
+                head[p] = next[child];
+                stack.push_back(child);
+            }
+        }
+    }
+    return post;
+}
+
+// Permuted lower triangle by rows: entry (pinv[r], pinv[c]) for pinv[c] <= pinv[r]
+void PermutedLower(const CsrMatrix& matrix, const std::vector<uint32_t>& inverse, std::vector<uint32_t>& rowOffsets,
+                   std::vector<uint32_t>& rowIndices, std::vector<uint32_t>& sourcePositions) {
+    uint32_t n = static_cast<uint32_t>(matrix.GetRowCount());
+    const std::vector<uint32_t>& offsets = matrix.GetRowOffsets();
+    const std::vector<uint32_t>& columns = matrix.GetColumnIndices();
+    rowOffsets.assign(n + 1, 0);
+    for (uint32_t r = 0; r < n; ++r) {
+        for (uint32_t p = offsets[r]; p < offsets[r + 1]; ++p) {
+            if (inverse[columns[p]] <= inverse[r]) {
+                ++rowOffsets[inverse[r] + 1];
+            }
+        }
+    }
+    for (uint32_t k = 0; k < n; ++k) {
+        rowOffsets[k + 1] += rowOffsets[k];
+    }
+    rowIndices.resize(rowOffsets[n]);
+    sourcePositions.resize(rowOffsets[n]);
+    std::vector<uint32_t> next(rowOffsets.begin(), rowOffsets.end() - 1);
+    for (uint32_t r = 0; r < n; ++r) {
+        for (uint32_t p = offsets[r]; p < offsets[r + 1]; ++p) {
+            if (inverse[columns[p]] <= inverse[r]) {
+                uint32_t position = next[inverse[r]]++;
+                rowIndices[position] = inverse[columns[p]];
+                sourcePositions[position] = p;
+            }
+        }
+    }
+}
+
+// Row k's pattern in L: columns reached from the entries of row k up the
+// elimination tree, stored topologically in stack[top, size). Indices are
+// local to base; flag[local] == k marks visited columns.
+inline uint32_t ReachRow(uint32_t k, uint32_t base, uint32_t size, const std::vector<uint32_t>& rowOffsets,
+                         const std::vector<uint32_t>& rowIndices, const std::vector<int32_t>& parent,
+                         int32_t* flag, uint32_t* stack) {
+    uint32_t top = size;
+    flag[k - base] = static_cast<int32_t>(k);
+    for (uint32_t p = rowOffsets[k]; p < rowOffsets[k + 1]; ++p) {
+        uint32_t i = rowIndices[p];
+        uint32_t length = 0;
+        while (flag[i - base] != static_cast<int32_t>(k)) {
+            stack[length++] = i;
+            flag[i - base] = static_cast<int32_t>(k);
+            i = static_cast<uint32_t>(parent[i]);
+        }
+        while (length > 0) {
+            stack[--top] = stack[--length];
+        }
+    }
+    return top;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// CsrMatrix
+// ---------------------------------------------------------------------------
+
+bool CsrMatrix::SetFromTriplets(size_t rows, size_t columns, const std::vector<Triplet>& triplets) {
+    Clear();
+    if (!AssembleRows(rows, columns, triplets, false, m_Offsets, m_Indices, m_Values)) {
+        return false;
+    }
+    m_Rows = rows;
+    m_Columns = columns;
+    return true;
+}
+
+void CsrMatrix::Clear() {
+    m_Rows = 0;
+    m_Columns = 0;
+    m_Offsets.clear();
+    m_Indices.clear();
+    m_Values.clear();
+}
+
+size_t CsrMatrix::Find(uint32_t row, uint32_t column) const {
+    if (row >= m_Rows) {
+        return NotFound;
+    }
+    auto begin = m_Indices.begin() + m_Offsets[row];
+    auto end = m_Indices.begin() + m_Offsets[row + 1];
+    auto it = std::lower_bound(begin, end, column);
+    return it != end && *it == column ? static_cast<size_t>(it - m_Indices.begin()) : NotFound;
+}
+
+double CsrMatrix::Get(uint32_t row, uint32_t column) const {
+    size_t position = Find(row, column);
+    return position == NotFound ? 0.0 : m_Values[position];
+}
+
+void CsrMatrix::GetDiagonal(std::vector<double>& diagonal) const {
+    diagonal.assign(std::min(m_Rows, m_Columns), 0.0);
+    for (uint32_t i = 0; i < diagonal.size(); ++i) {
+        diagonal[i] = Get(i, i);
+    }
+}
+
+void CsrMatrix::Multiply(const double* x, double* y) const {
+    parallel::For(m_Rows, GrainSize, [&](size_t begin, size_t end) {
+        for (size_t r = begin; r < end; ++r) {
+            double sum = 0.0;
+            for (uint32_t k = m_Offsets[r]; k < m_Offsets[r + 1]; ++k) {
+                sum += m_Values[k] * x[m_Indices[k]];
+            }
+            y[r] = sum;
+        }
+    });
+}
+
+void CsrMatrix::Multiply(const std::vector<double>& x, std::vector<double>& y) const {
+    y.resize(m_Rows);
+    Multiply(x.data(), y.data());
+}
+
+void CsrMatrix::Transpose(CsrMatrix& transposed) const {
+    transposed.m_Rows = m_Columns;
+    transposed.m_Columns = m_Rows;
+    TransposeArrays(m_Rows, m_Columns, m_Offsets, m_Indices, m_Values, transposed.m_Offsets, transposed.m_Indices,
+                    transposed.m_Values);
+}
+
+// ---------------------------------------------------------------------------
+// CscMatrix
+// ---------------------------------------------------------------------------
+
+bool CscMatrix::SetFromTriplets(size_t rows, size_t columns, const std::vector<Triplet>& triplets) {
+    Clear();
+    if (!AssembleRows(rows, columns, triplets, true, m_Offsets, m_Indices, m_Values)) {
+        return false;
+    }
+    m_Rows = rows;
+    m_Columns = columns;
+    return true;
+}
+
+void CscMatrix::SetFromCsr(const CsrMatrix& matrix) {
+    m_Rows = matrix.GetRowCount();
+    m_Columns = matrix.GetColumnCount();
+    TransposeArrays(m_Rows, m_Columns, matrix.GetRowOffsets(), matrix.GetColumnIndices(), matrix.GetValues(),
+                    m_Offsets, m_Indices, m_Values);
+}
+
+void CscMatrix::Clear() {
+    m_Rows = 0;
+    m_Columns = 0;
+    m_Offsets.clear();
+    m_Indices.clear();
+    m_Values.clear();
+}
+
+void CscMatrix::Multiply(const double* x, double* y) const {
+    std::fill(y, y + m_Rows, 0.0);
+    for (size_t c = 0; c < m_Columns; ++c) {
+        double value = x[c];
+        for (uint32_t k = m_Offsets[c]; k < m_Offsets[c + 1]; ++k) {
+            y[m_Indices[k]] += m_Values[k] * value;
+        }
+    }
+}
+
+void CscMatrix::MultiplyTransposed(const double* x, double* y) const {
+    parallel::For(m_Columns, GrainSize, [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; ++c) {
+            double sum = 0.0;
+            for (uint32_t k = m_Offsets[c]; k < m_Offsets[c + 1]; ++k) {
+                sum += m_Values[k] * x[m_Indices[k]];
+            }
+            y[c] = sum;
+        }
+    });
+}
+
+// ---------------------------------------------------------------------------
+// ConjugateGradient
+// ---------------------------------------------------------------------------
+
+bool ConjugateGradient::Compute(const CsrMatrix& matrix) {
+    m_Matrix = nullptr;
+    if (matrix.GetRowCount() != matrix.GetColumnCount()) {
+        std::cerr << "ConjugateGradient: matrix is not square" << std::endl;
+        return false;
+    }
+
+    if (m_Preconditioner == Preconditioner::Jacobi) {
+        matrix.GetDiagonal(m_InverseDiagonal);
+        for (double& d : m_InverseDiagonal) {
+            d = d > 0.0 ? 1.0 / d : 1.0;
+        }
+    } else if (m_Preconditioner == Preconditioner::IncompleteCholesky && !ComputeIncompleteCholesky(matrix)) {
+        return false;
+    }
+    m_Matrix = &matrix;
+    return true;
+}
+
+bool ConjugateGradient::ComputeIncompleteCholesky(const CsrMatrix& matrix) {
+    // Lower triangle pattern, values filled per attempt
+    size_t n = matrix.GetRowCount();
+    const std::vector<uint32_t>& offsets = matrix.GetRowOffsets();
+    const std::vector<uint32_t>& columns = matrix.GetColumnIndices();
+    const std::vector<double>& values = matrix.GetValues();
+
+    std::vector<Triplet> lower;
+    lower.reserve(matrix.GetNonZeroCount() / 2 + n);
+    for (uint32_t r = 0; r < n; ++r) {
+        bool diagonal = false;
+        for (uint32_t k = offsets[r]; k < offsets[r + 1] && columns[k] <= r; ++k) {
+            lower.push_back({r, columns[k], values[k]});
+            diagonal = diagonal || columns[k] == r;
+        }
+        if (!diagonal) {
+            std::cerr << "ConjugateGradient: IC(0) needs a stored diagonal (row " << r << ")" << std::endl;
+            return false;
+        }
+    }
+    m_Lower.SetFromTriplets(n, n, lower);
+    const std::vector<uint32_t>& lowerOffsets = m_Lower.GetRowOffsets();
+    const std::vector<uint32_t>& lowerColumns = m_Lower.GetColumnIndices();
+    std::vector<double>& factor = m_Lower.GetValues();
+    const std::vector<double> source = factor;
+
+    // A non-positive pivot means IC(0) broke down; retry on a diagonally
+    // shifted matrix (Manteuffel)
+    double shift = 0.0;
+    for (int attempt = 0; attempt < 12; ++attempt) {
+        bool ok = true;
+        for (uint32_t i = 0; i < n && ok; ++i) {
+            uint32_t rowBegin = lowerOffsets[i], diagonal = lowerOffsets[i + 1] - 1;
+            for (uint32_t p = rowBegin; p < diagonal; ++p) {
+                // L_ik = (A_ik - sum_j<k L_ij L_kj) / L_kk over the shared pattern
+                uint32_t k = lowerColumns[p];
+                double sum = source[p];
+                uint32_t a = rowBegin, b = lowerOffsets[k], bEnd = lowerOffsets[k + 1] - 1;
+                while (a < p && b < bEnd) {
+                    if (lowerColumns[a] == lowerColumns[b]) {
+                        sum -= factor[a++] * factor[b++];
+                    } else if (lowerColumns[a] < lowerColumns[b]) {
+                        ++a;
+                    } else {
+                        ++b;
+                    }
+                }
+                factor[p] = sum / factor[bEnd];
+            }
+            double pivot = source[diagonal] * (1.0 + shift);
+            for (uint32_t p = rowBegin; p < diagonal; ++p) {
+                pivot -= factor[p] * factor[p];
+            }
+            ok = pivot > 0.0;
+            factor[diagonal] = ok ? std::sqrt(pivot) : 0.0;
+        }
+        if (ok) {
+            m_Lower.Transpose(m_Upper);
+            return true;
+        }
+        shift = shift == 0.0 ? 1e-3 : shift * 2.0;
+    }
+    std::cerr << "ConjugateGradient: IC(0) failed; is the matrix positive definite?" << std::endl;
+    return false;
+}
+
+void ConjugateGradient::ApplyPreconditioner(const std::vector<double>& r, std::vector<double>& z) const {
+    size_t n = r.size();
+    if (m_Preconditioner == Preconditioner::Jacobi) {
+        parallel::For(n, GrainSize, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                z[i] = r[i] * m_InverseDiagonal[i];
+            }
+        });
+        return;
+    }
+    if (m_Preconditioner == Preconditioner::None) {
+        std::copy(r.begin(), r.end(), z.begin());
+        return;
+    }
+
+    // L y = r, then L^T z = y, in place
+    const std::vector<uint32_t>& lowerOffsets = m_Lower.GetRowOffsets();
+    const std::vector<uint32_t>& lowerColumns = m_Lower.GetColumnIndices();
+    const std::vector<double>& lower = m_Lower.GetValues();
+    for (size_t i = 0; i < n; ++i) {
+        double sum = r[i];
+        uint32_t diagonal = lowerOffsets[i + 1] - 1;
+        for (uint32_t p = lowerOffsets[i]; p < diagonal; ++p) {
+            sum -= lower[p] * z[lowerColumns[p]];
+        }
+        z[i] = sum / lower[diagonal];
+    }
+    const std::vector<uint32_t>& upperOffsets = m_Upper.GetRowOffsets();
+    const std::vector<uint32_t>& upperColumns = m_Upper.GetColumnIndices();
+    const std::vector<double>& upper = m_Upper.GetValues();
+    for (size_t i = n; i-- > 0;) {
+        double sum = z[i];
+        uint32_t diagonal = upperOffsets[i];
+        for (uint32_t p = diagonal + 1; p < upperOffsets[i + 1]; ++p) {
+            sum -= upper[p] * z[upperColumns[p]];
+        }
+        z[i] = sum / upper[diagonal];
+    }
+}
+
+SolverResult ConjugateGradient::Solve(const std::vector<double>& b, std::vector<double>& x,
+                                      const SolverSettings& settings) {
+    SolverResult result;
+    if (!m_Matrix || b.size() != m_Matrix->GetRowCount()) {
+        std::cerr << "ConjugateGradient: Compute() a matrix matching the right-hand side first" << std::endl;
+        return result;
+    }
+    size_t n = b.size();
+    if (x.size() != n) {
+        x.assign(n, 0.0);
+    }
+    m_R.resize(n);
+    m_Z.resize(n);
+    m_P.resize(n);
+    m_Q.resize(n);
+
+    double normB = std::sqrt(Dot(b.data(), b.data(), n));
+    if (normB == 0.0) {
+        std::fill(x.begin(), x.end(), 0.0);
+        result.converged = true;
+        return result;
+    }
+
+    m_Matrix->Multiply(x.data(), m_Q.data());
+    parallel::For(n, GrainSize, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            m_R[i] = b[i] - m_Q[i];
+        }
+    });
+    ApplyPreconditioner(m_R, m_Z);
+    std::copy(m_Z.begin(), m_Z.end(), m_P.begin());
+    double rz = Dot(m_R.data(), m_Z.data(), n);
+    result.residual = std::sqrt(Dot(m_R.data(), m_R.data(), n)) / normB;
+
+    while (result.residual > settings.tolerance && result.iterations < settings.maxIterations) {
+        m_Matrix->Multiply(m_P.data(), m_Q.data());
+        double alpha = rz / Dot(m_P.data(), m_Q.data(), n);
+        parallel::For(n, GrainSize, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                x[i] += alpha * m_P[i];
+                m_R[i] -= alpha * m_Q[i];
+            }
+        });
+        ++result.iterations;
+        result.residual = std::sqrt(Dot(m_R.data(), m_R.data(), n)) / normB;
+        if (result.residual <= settings.tolerance) {
+            break;
+        }
+
+        ApplyPreconditioner(m_R, m_Z);
+        double rzNext = Dot(m_R.data(), m_Z.data(), n);
+        double beta = rzNext / rz;
+        rz = rzNext;
+        parallel::For(n, GrainSize, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                m_P[i] = m_Z[i] + beta * m_P[i];
+            }
+        });
+    }
+    result.converged = result.residual <= settings.tolerance;
+    return result;
+}
+
+// ---------------------------------------------------------------------------
+// CholeskySolver
+// ---------------------------------------------------------------------------
+
+bool CholeskySolver::Analyze(const CsrMatrix& matrix) {
+    m_Permutation.clear();
+    m_LowerOffsets.clear();
+    m_Factorized = false;
+    if (matrix.GetRowCount() != matrix.GetColumnCount() || matrix.GetRowCount() == 0) {
+        std::cerr << "CholeskySolver: matrix is not square" << std::endl;
+        return false;
+    }
+    uint32_t n = static_cast<uint32_t>(matrix.GetRowCount());
+
+    // Fill-reducing order, then the elimination tree postorder so every
+    // subtree is a contiguous range
+    std::vector<uint32_t> order = NestedDissection(matrix);
+    std::vector<uint32_t> inverse(n);
+    for (uint32_t k = 0; k < n; ++k) {
+        inverse[order[k]] = k;
+    }
+    PermutedLower(matrix, inverse, m_RowOffsets, m_RowIndices, m_SourcePositions);
+    EliminationTree(n, m_RowOffsets, m_RowIndices, m_Parent);
+    std::vector<uint32_t> post = Postorder(m_Parent);
+
+    m_Permutation.resize(n);
+    for (uint32_t k = 0; k < n; ++k) {
+        m_Permutation[k] = order[post[k]];
+        inverse[m_Permutation[k]] = k;
+    }
+    PermutedLower(matrix, inverse, m_RowOffsets, m_RowIndices, m_SourcePositions);
+    EliminationTree(n, m_RowOffsets, m_RowIndices, m_Parent);
+    m_SourceNonZeros = matrix.GetNonZeroCount();
+
+    // Column counts from the row patterns
+    std::vector<uint64_t> counts(n, 1);
+    std::vector<int32_t> flag(n, -1);
+    std::vector<uint32_t> stack(n);
+    for (uint32_t k = 0; k < n; ++k) {
+        uint32_t top = ReachRow(k, 0, n, m_RowOffsets, m_RowIndices, m_Parent, flag.data(), stack.data());
+        for (uint32_t t = top; t < n; ++t) {
+            ++counts[stack[t]];
+        }
+    }
+    uint64_t total = 0;
+    m_LowerOffsets.resize(n + 1);
+    for (uint32_t k = 0; k < n; ++k) {
+        m_LowerOffsets[k] = static_cast<uint32_t>(total);
+        total += counts[k];
+        if (total > std::numeric_limits<uint32_t>::max()) {
+            std::cerr << "CholeskySolver: factor exceeds 2^32 non-zeros" << std::endl;
+            m_Permutation.clear();
+            m_LowerOffsets.clear();
+            return false;
+        }
+    }
+    m_LowerOffsets[n] = static_cast<uint32_t>(total);
+
+    // Disjoint subtrees small enough to balance across threads run in
+    // parallel; their ancestors follow in order
+    m_SubtreeBegins.clear();
+    m_SubtreeEnds.clear();
+    m_SequentialRows.clear();
+    std::vector<uint32_t> subtreeSize(n, 0);
+    for (uint32_t k = 0; k < n; ++k) {
+        ++subtreeSize[k];
+        if (m_Parent[k] != -1) {
+            subtreeSize[m_Parent[k]] += subtreeSize[k];
+        }
+    }
+    size_t threads = parallel::ThreadCount();
+    uint32_t limit = threads > 1 ? static_cast<uint32_t>(n / (threads * 4)) : 0;
+    std::vector<uint8_t> covered(n, 0);
+    for (uint32_t k = 0; k < n; ++k) {
+        bool top = m_Parent[k] == -1 || subtreeSize[m_Parent[k]] > limit;
+        if (subtreeSize[k] <= limit && subtreeSize[k] >= MinSubtree && top) {
+            m_SubtreeBegins.push_back(k + 1 - subtreeSize[k]);
+            m_SubtreeEnds.push_back(k + 1);
+            std::fill(covered.begin() + (k + 1 - subtreeSize[k]), covered.begin() + k + 1, 1);
+        }
+    }
+    for (uint32_t k = 0; k < n; ++k) {
+        if (!covered[k]) {
+            m_SequentialRows.push_back(k);
+        }
+    }
+    return true;
+}
+
+bool CholeskySolver::Factorize(const CsrMatrix& matrix) {
+    m_Factorized = false;
+    if (!IsAnalyzed() || matrix.GetRowCount() != GetSize() || matrix.GetNonZeroCount() != m_SourceNonZeros) {
+        std::cerr << "CholeskySolver: matrix pattern differs from the analysed one" << std::endl;
+        return false;
+    }
+    uint32_t n = static_cast<uint32_t>(GetSize());
+    const std::vector<double>& values = matrix.GetValues();
+    m_LowerIndices.resize(m_LowerOffsets[n]);
+    m_LowerValues.resize(m_LowerOffsets[n]);
+    std::vector<uint32_t> next(m_LowerOffsets.begin(), m_LowerOffsets.end() - 1);
+    std::atomic<bool> ok{true};
+
+    // Up-looking: row k of L from a sparse triangular solve against the
+    // columns already done. Row k only touches columns of its own subtree,
+    // so disjoint subtrees share nothing.
+    auto factorRow = [&](uint32_t k, uint32_t base, uint32_t size, double* x, int32_t* flag, uint32_t* stack) {
+        uint32_t top = ReachRow(k, base, size, m_RowOffsets, m_RowIndices, m_Parent, flag, stack);
+        for (uint32_t p = m_RowOffsets[k]; p < m_RowOffsets[k + 1]; ++p) {
+            x[m_RowIndices[p] - base] += values[m_SourcePositions[p]];
+        }
+        double diagonal = x[k - base];
+        x[k - base] = 0.0;
+        for (uint32_t t = top; t < size; ++t) {
+            uint32_t j = stack[t];
+            double lkj = x[j - base] / m_LowerValues[m_LowerOffsets[j]];
+            x[j - base] = 0.0;
+            for (uint32_t p = m_LowerOffsets[j] + 1; p < next[j]; ++p) {
+                x[m_LowerIndices[p] - base] -= m_LowerValues[p] * lkj;
+            }
+            diagonal -= lkj * lkj;
+            uint32_t p = next[j]++;
+            m_LowerIndices[p] = k;
+            m_LowerValues[p] = lkj;
+        }
+        if (!(diagonal > 0.0)) {
+            return false;
+        }
+        uint32_t p = next[k]++;
+        m_LowerIndices[p] = k;
+        m_LowerValues[p] = std::sqrt(diagonal);
+        return true;
+    };
+
+    parallel::ForChunks(m_SubtreeBegins.size(), [&](size_t subtree) {
+        uint32_t begin = m_SubtreeBegins[subtree], end = m_SubtreeEnds[subtree];
+        uint32_t size = end - begin;
+        std::vector<double> x(size, 0.0);
+        std::vector<int32_t> flag(size, -1);
+        std::vector<uint32_t> stack(size);
+        for (uint32_t k = begin; k < end && ok.load(std::memory_order_relaxed); ++k) {
+            if (!factorRow(k, begin, size, x.data(), flag.data(), stack.data())) {
+                ok = false;
+            }
+        }
+    });
+
+    std::vector<double> x(n, 0.0);
+    std::vector<int32_t> flag(n, -1);
+    std::vector<uint32_t> stack(n);
+    for (size_t i = 0; i < m_SequentialRows.size() && ok; ++i) {
+        if (!factorRow(m_SequentialRows[i], 0, n, x.data(), flag.data(), stack.data())) {
+            ok = false;
+        }
+    }
+    if (!ok) {
+        std::cerr << "CholeskySolver: matrix is not positive definite" << std::endl;
+        return false;
+    }
+    m_Factorized = true;
+    return true;
+}
+
+void CholeskySolver::Solve(const double* b, double* x) const {
+    if (!m_Factorized) {
+        std::cerr << "CholeskySolver: Factorize() before Solve()" << std::endl;
+        return;
+    }
+    size_t n = GetSize();
+    std::vector<double> y(n);
+    for (size_t k = 0; k < n; ++k) {
+        y[k] = b[m_Permutation[k]];
+    }
+    for (size_t j = 0; j < n; ++j) {
+        y[j] /= m_LowerValues[m_LowerOffsets[j]];
+        for (uint32_t p = m_LowerOffsets[j] + 1; p < m_LowerOffsets[j + 1]; ++p) {
+            y[m_LowerIndices[p]] -= m_LowerValues[p] * y[j];
+        }
+    }
+    for (size_t j = n; j-- > 0;) {
+        double sum = y[j];
+        for (uint32_t p = m_LowerOffsets[j] + 1; p < m_LowerOffsets[j + 1]; ++p) {
+            sum -= m_LowerValues[p] * y[m_LowerIndices[p]];
+        }
+        y[j] = sum / m_LowerValues[m_LowerOffsets[j]];
+    }
+    for (size_t k = 0; k < n; ++k) {
+        x[m_Permutation[k]] = y[k];
+    }
+}
+
+void CholeskySolver::Solve(const std::vector<double>& b, std::vector<double>& x) const {
+    x.resize(GetSize());
+    Solve(b.data(), x.data());
+}
+
+void CholeskySolver::Solve(const double* b, double* x, size_t count) const {
+    if (!m_Factorized) {
+        std::cerr << "CholeskySolver: Factorize() before Solve()" << std::endl;
+        return;
+    }
+    if (count == 1) {
+        Solve(b, x);
+        return;
+    }
+    // Right-hand sides interleaved per row, so every factor entry updates
+    // all of them from one contiguous block
+    size_t n = GetSize();
+    std::vector<double> y(n * count);
+    for (size_t k = 0; k < n; ++k) {
+        for (size_t r = 0; r < count; ++r) {
+            y[k * count + r] = b[r * n + m_Permutation[k]];
+        }
+    }
+    for (size_t j = 0; j < n; ++j) {
+        double* yj = y.data() + j * count;
+        double diagonal = m_LowerValues[m_LowerOffsets[j]];
+        for (size_t r = 0; r < count; ++r) {
+            yj[r] /= diagonal;
+        }
+        for (uint32_t p = m_LowerOffsets[j] + 1; p < m_LowerOffsets[j + 1]; ++p) {
+            double* yi = y.data() + size_t(m_LowerIndices[p]) * count;
+            double value = m_LowerValues[p];
+            for (size_t r = 0; r < count; ++r) {
+                yi[r] -= value * yj[r];
+            }
+        }
+    }
+    for (size_t j = n; j-- > 0;) {
+        double* yj = y.data() + j * count;
+        for (uint32_t p = m_LowerOffsets[j] + 1; p < m_LowerOffsets[j + 1]; ++p) {
+            const double* yi = y.data() + size_t(m_LowerIndices[p]) * count;
+            double value = m_LowerValues[p];
+            for (size_t r = 0; r < count; ++r) {
+                yj[r] -= value * yi[r];
+            }
+        }
+        double diagonal = m_LowerValues[m_LowerOffsets[j]];
+        for (size_t r = 0; r < count; ++r) {
+            yj[r] /= diagonal;
+        }
+    }
+    for (size_t k = 0; k < n; ++k) {
+        for (size_t r = 0; r < count; ++r) {
+            x[r * n + m_Permutation[k]] = y[k * count + r];
+        }
+    }
+}
+
+} // namespace sparse
+} // namespace alice2
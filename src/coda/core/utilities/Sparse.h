@@ -0,0 +1,188 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace alice2 {
+namespace sparse {
+
+// Sparse linear algebra for mesh and graph solves: compressed row/column
+// matrices, parallel products, preconditioned conjugate gradient and a
+// sparse Cholesky factorisation that keeps its symbolic analysis while only
+// values change.
+
+constexpr size_t NotFound = std::numeric_limits<size_t>::max();
+
+// Matrix entry for assembly; duplicates are summed
+struct Triplet {
+    uint32_t row;
+    uint32_t column;
+    double value;
+};
+
+// Compressed sparse row matrix, columns sorted within each row
+class CsrMatrix {
+public:
+    CsrMatrix() = default;
+
+    bool SetFromTriplets(size_t rows, size_t columns, const std::vector<Triplet>& triplets);
+    void Clear();
+
+    size_t GetRowCount() const { return m_Rows; }
+    size_t GetColumnCount() const { return m_Columns; }
+    size_t GetNonZeroCount() const { return m_Values.size(); }
+
+    const std::vector<uint32_t>& GetRowOffsets() const { return m_Offsets; }
+    const std::vector<uint32_t>& GetColumnIndices() const { return m_Indices; }
+    // Values can be rewritten in place when the pattern stays the same
+    std::vector<double>& GetValues() { return m_Values; }
+    const std::vector<double>& GetValues() const { return m_Values; }
+
+    // Position of (row, column) in GetValues(), NotFound if not stored
+    size_t Find(uint32_t row, uint32_t column) const;
+    double Get(uint32_t row, uint32_t column) const;
+    void GetDiagonal(std::vector<double>& diagonal) const;
+
+    // y = A x, parallel over rows; x and y must not alias
+    void Multiply(const double* x, double* y) const;
+    void Multiply(const std::vector<double>& x, std::vector<double>& y) const;
+
+    void Transpose(CsrMatrix& transposed) const;
+
+private:
+    size_t m_Rows = 0;
+    size_t m_Columns = 0;
+    std::vector<uint32_t> m_Offsets;
+    std::vector<uint32_t> m_Indices;
+    std::vector<double> m_Values;
+};
+
+// Compressed sparse column matrix, rows sorted within each column. A^T x is
+// a parallel gather over columns; A x scatters and runs serially.
+class CscMatrix {
+public:
+    CscMatrix() = default;
+
+    bool SetFromTriplets(size_t rows, size_t columns, const std::vector<Triplet>& triplets);
+    void SetFromCsr(const CsrMatrix& matrix);
+    void Clear();
+
+    size_t GetRowCount() const { return m_Rows; }
+    size_t GetColumnCount() const { return m_Columns; }
+    size_t GetNonZeroCount() const { return m_Values.size(); }
+
+    const std::vector<uint32_t>& GetColumnOffsets() const { return m_Offsets; }
+    const std::vector<uint32_t>& GetRowIndices() const { return m_Indices; }
+    std::vector<double>& GetValues() { return m_Values; }
+    const std::vector<double>& GetValues() const { return m_Values; }
+
+    void Multiply(const double* x, double* y) const;
+    void MultiplyTransposed(const double* x, double* y) const;
+
+private:
+    size_t m_Rows = 0;
+    size_t m_Columns = 0;
+    std::vector<uint32_t> m_Offsets;
+    std::vector<uint32_t> m_Indices;
+    std::vector<double> m_Values;
+};
+
+enum class Preconditioner {
+    None,
+    Jacobi,             // Inverse diagonal
+    IncompleteCholesky  // IC(0): Cholesky restricted to the pattern of A
+};
+
+struct SolverSettings {
+    size_t maxIterations = 1000;
+    double tolerance = 1e-8; // Relative residual |b - Ax| / |b|
+};
+
+struct SolverResult {
+    size_t iterations = 0;
+    double residual = 0.0;
+    bool converged = false;
+};
+
+// Preconditioned conjugate gradient for symmetric positive definite
+// matrices. Products, dot products and updates run in parallel; the IC(0)
+// triangular solves are sequential.
+class ConjugateGradient {
+public:
+    explicit ConjugateGradient(Preconditioner preconditioner = Preconditioner::Jacobi)
+        : m_Preconditioner(preconditioner) {}
+
+    // Keeps a pointer to matrix; call again after its values change
+    bool Compute(const CsrMatrix& matrix);
+    // x is used as the initial guess when it already has the right size
+    SolverResult Solve(const std::vector<double>& b, std::vector<double>& x,
+                       const SolverSettings& settings = SolverSettings());
+
+private:
+    Preconditioner m_Preconditioner;
+    const CsrMatrix* m_Matrix = nullptr;
+    std::vector<double> m_InverseDiagonal;
+    CsrMatrix m_Lower; // IC(0) factor by rows, diagonal last
+    CsrMatrix m_Upper; // Its transpose, diagonal first
+
+    std::vector<double> m_R, m_Z, m_P, m_Q;
+
+    bool ComputeIncompleteCholesky(const CsrMatrix& matrix);
+    void ApplyPreconditioner(const std::vector<double>& r, std::vector<double>& z) const;
+};
+
+// Sparse Cholesky A = P^T L L^T P for symmetric positive definite matrices
+// given with both triangles. Analyze() computes a nested dissection
+// ordering, the elimination tree and the factor pattern; Factorize() only
+// fills in values, so matrices whose values change (time steps, reweighted
+// Laplacians) skip the symbolic work. Independent elimination subtrees are
+// factored in parallel.
+class CholeskySolver {
+public:
+    CholeskySolver() = default;
+
+    bool Analyze(const CsrMatrix& matrix);
+    // The matrix must have the analysed pattern
+    bool Factorize(const CsrMatrix& matrix);
+    bool Compute(const CsrMatrix& matrix) { return Analyze(matrix) && Factorize(matrix); }
+
+    bool IsAnalyzed() const { return !m_Permutation.empty(); }
+    bool IsFactorized() const { return m_Factorized; }
+    size_t GetSize() const { return m_Permutation.size(); }
+    size_t GetFactorNonZeroCount() const { return m_LowerOffsets.empty() ? 0 : m_LowerOffsets.back(); }
+
+    // Safe to call concurrently once factorised
+    void Solve(const double* b, double* x) const;
+    void Solve(const std::vector<double>& b, std::vector<double>& x) const;
+    // count right-hand sides stored one after another (b[r * size + i]);
+    // the factor is traversed once for all of them
+    void Solve(const double* b, double* x, size_t count) const;
+
+private:
+    std::vector<uint32_t> m_Permutation;    // New index -> original
+    std::vector<int32_t> m_Parent;          // Elimination tree, -1 at roots
+    size_t m_SourceNonZeros = 0;
+
+    // Permuted lower triangle by rows: entries (k, i <= k) with the
+    // position of their value in the source matrix
+    std::vector<uint32_t> m_RowOffsets;
+    std::vector<uint32_t> m_RowIndices;
+    std::vector<uint32_t> m_SourcePositions;
+
+    // Subtrees factored in parallel, as [begin, end) ranges of the postorder,
+    // then the remaining rows in order
+    std::vector<uint32_t> m_SubtreeBegins;
+    std::vector<uint32_t> m_SubtreeEnds;
+    std::vector<uint32_t> m_SequentialRows;
+
+    // L by columns, diagonal first
+    std::vector<uint32_t> m_LowerOffsets;
+    std::vector<uint32_t> m_LowerIndices;
+    std::vector<double> m_LowerValues;
+    bool m_Factorized = false;
+};
+
+} // namespace sparse
+} // namespace alice2
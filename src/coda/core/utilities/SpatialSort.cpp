@@ -0,0 +1,307 @@
+#include "SpatialSort.h"
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+
+namespace alice2 {
+namespace spatial {
+
+namespace {
+
+uint32_t Part1By2(uint32_t x) {
+    x &= 0x000003ff;
+    x = (x | (x << 16)) & 0x030000ff;
+    x = (x | (x << 8)) & 0x0300f00f;
+    x = (x | (x << 4)) & 0x030c30c3;
+    x = (x | (x << 2)) & 0x09249249;
+    return x;
+}
+
+uint64_t Part1By2(uint64_t x) {
+    x &= 0x1fffff;
+    x = (x | (x << 32)) & 0x001f00000000ffffull;
+    x = (x | (x << 16)) & 0x001f0000ff0000ffull;
+    x = (x | (x << 8)) & 0x100f00f00f00f00full;
+    x = (x | (x << 4)) & 0x10c30c30c30c30c3ull;
+    x = (x | (x << 2)) & 0x1249249249249249ull;
+    return x;
+}
+
+// Skilling, "Programming the Hilbert curve" (2004): converts axes to the
+// transposed Hilbert index in place; interleaving the result gives the key.
+// Branchless, since the per-bit tests are data dependent.
+inline void AxesToTranspose(uint32_t& x0, uint32_t& x1, uint32_t& x2, int bits) {
+    // Inverse undo
+    for (uint32_t Q = 1u << (bits - 1); Q > 1; Q >>= 1) {
+        uint32_t P = Q - 1;
+        x0 ^= P & (0u - ((x0 & Q) != 0));
+
+        uint32_t set = 0u - ((x1 & Q) != 0);
+        uint32_t t = (x0 ^ x1) & P & ~set;
+        x0 ^= (P & set) | t;
+        x1 ^= t;
+
+        set = 0u - ((x2 & Q) != 0);
+        t = (x0 ^ x2) & P & ~set;
+        x0 ^= (P & set) | t;
+        x2 ^= t;
+    }
+
+    // Gray encode
+    x1 ^= x0;
+    x2 ^= x1;
+    uint32_t t = 0;
+    for (uint32_t Q = 1u << (bits - 1); Q > 1; Q >>= 1) {
+        t ^= (Q - 1) & (0u - ((x2 & Q) != 0));
+    }
+    x0 ^= t;
+    x1 ^= t;
+    x2 ^= t;
+}
+
+struct Bounds {
+    Vec3f min;
+    float scale = 0.0f; // Quantisation scale for the bounding cube
+};
+
+Bounds ComputeQuantisation(const Vec3f* points, size_t count, uint32_t maxCoord) {
+    size_t chunkCount = parallel::ChunkCount(count, 16384);
+    size_t chunkSize = chunkCount ? (count + chunkCount - 1) / chunkCount : 0;
+
+    constexpr float inf = std::numeric_limits<float>::infinity();
+    std::vector<Vec3f> mins(chunkCount, Vec3f(inf, inf, inf));
+    std::vector<Vec3f> maxs(chunkCount, Vec3f(-inf, -inf, -inf));
+
+    parallel::ForChunks(chunkCount, [&](size_t chunk) {
+        size_t end = std::min(count, (chunk + 1) * chunkSize);
+        Vec3f lo = mins[chunk], hi = maxs[chunk];
+        for (size_t i = chunk * chunkSize; i < end; ++i) {
+            const Vec3f& p = points[i];
+            lo = Vec3f(std::min(lo.x, p.x), std::min(lo.y, p.y), std::min(lo.z, p.z));
+            hi = Vec3f(std::max(hi.x, p.x), std::max(hi.y, p.y), std::max(hi.z, p.z));
+        }
+        mins[chunk] = lo;
+        maxs[chunk] = hi;
+    });
+
+    Vec3f lo(inf, inf, inf), hi(-inf, -inf, -inf);
+    for (size_t c = 0; c < chunkCount; ++c) {
+        lo = Vec3f(std::min(lo.x, mins[c].x), std::min(lo.y, mins[c].y), std::min(lo.z, mins[c].z));
+        hi = Vec3f(std::max(hi.x, maxs[c].x), std::max(hi.y, maxs[c].y), std::max(hi.z, maxs[c].z));
+    }
+
+    Bounds bounds;
+    bounds.min = lo;
+    float extent = std::max(hi.x - lo.x, std::max(hi.y - lo.y, hi.z - lo.z));
+    bounds.scale = extent > 0.0f ? static_cast<float>(maxCoord) / extent : 0.0f;
+    return bounds;
+}
+
+inline uint32_t Quantise(float value, float min, float scale, uint32_t maxCoord) {
+    float q = (value - min) * scale;
+    if (!(q > 0.0f)) return 0; // Also catches NaN
+    return std::min(maxCoord, static_cast<uint32_t>(q));
+}
+
+template <typename Key, typename KeyFn>
+void ComputeKeysImpl(const Vec3f* points, size_t count, int bitsPerAxis, Key* keys, KeyFn keyFn) {
+    uint32_t maxCoord = (1u << bitsPerAxis) - 1;
+    Bounds bounds = ComputeQuantisation(points, count, maxCoord);
+
+    parallel::For(count, 8192, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const Vec3f& p = points[i];
+            keys[i] = keyFn(Quantise(p.x, bounds.min.x, bounds.scale, maxCoord),
+                            Quantise(p.y, bounds.min.y, bounds.scale, maxCoord),
+                            Quantise(p.z, bounds.min.z, bounds.scale, maxCoord));
+        }
+    });
+}
+
+// LSD radix sort with 8-bit digits. Each pass builds per-chunk histograms in
+// parallel, prefix-sums them serially (256 x chunks) and scatters in parallel;
+// chunk order keeps the sort stable.
+template <typename Key>
+void RadixSortImpl(std::vector<Key>& keys, std::vector<uint32_t>& values) {
+    constexpr int DigitBits = 8;
+    constexpr size_t Buckets = size_t(1) << DigitBits;
+
+    const size_t count = keys.size();
+    if (values.size() != count || count < 2) {
+        return;
+    }
+
+    const size_t chunkCount = parallel::ChunkCount(count, 16384);
+    const size_t chunkSize = (count + chunkCount - 1) / chunkCount;
+
+    // Bits that vary anywhere in the set; constant digits are skipped
+    std::vector<Key> chunkOr(chunkCount, 0), chunkAnd(chunkCount, ~Key(0));
+    parallel::ForChunks(chunkCount, [&](size_t chunk) {
+        size_t end = std::min(count, (chunk + 1) * chunkSize);
+        Key o = 0, a = ~Key(0);
+        for (size_t i = chunk * chunkSize; i < end; ++i) {
+            o |= keys[i];
+            a &= keys[i];
+        }
+        chunkOr[chunk] = o;
+        chunkAnd[chunk] = a;
+    });
+    Key varying = 0, allAnd = ~Key(0), allOr = 0;
+    for (size_t c = 0; c < chunkCount; ++c) {
+        allOr |= chunkOr[c];
+        allAnd &= chunkAnd[c];
+    }
+    varying = allOr ^ allAnd;
+
+    std::vector<Key> tempKeys(count);
+    std::vector<uint32_t> tempValues(count);
+    std::vector<size_t> histograms(chunkCount * Buckets);
+
+    for (int shift = 0; shift < static_cast<int>(sizeof(Key) * 8); shift += DigitBits) {
+        if (((varying >> shift) & Key(Buckets - 1)) == 0) {
+            continue;
+        }
+
+        parallel::ForChunks(chunkCount, [&](size_t chunk) {
+            size_t* histogram = &histograms[chunk * Buckets];
+            std::fill(histogram, histogram + Buckets, 0);
+            size_t end = std::min(count, (chunk + 1) * chunkSize);
+            for (size_t i = chunk * chunkSize; i < end; ++i) {
+                ++histogram[(keys[i] >> shift) & Key(Buckets - 1)];
+            }
+        });
+
+        // Exclusive prefix over (bucket, chunk) turns counts into scatter offsets
+        size_t offset = 0;
+        for (size_t bucket = 0; bucket < Buckets; ++bucket) {
+            for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+                size_t& slot = histograms[chunk * Buckets + bucket];
+                size_t bucketCount = slot;
+                slot = offset;
+                offset += bucketCount;
+            }
+        }
+
+        parallel::ForChunks(chunkCount, [&](size_t chunk) {
+            size_t* offsets = &histograms[chunk * Buckets];
+            size_t end = std::min(count, (chunk + 1) * chunkSize);
+            for (size_t i = chunk * chunkSize; i < end; ++i) {
+                size_t destination = offsets[(keys[i] >> shift) & Key(Buckets - 1)]++;
+                tempKeys[destination] = keys[i];
+                tempValues[destination] = values[i];
+            }
+        });
+
+        keys.swap(tempKeys);
+        values.swap(tempValues);
+    }
+}
+
+template <typename Key>
+std::vector<uint32_t> SortedOrder(std::vector<Key>& keys) {
+    std::vector<uint32_t> order(keys.size());
+    parallel::For(order.size(), 16384, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            order[i] = static_cast<uint32_t>(i);
+        }
+    });
+    RadixSort(keys, order);
+    return order;
+}
+
+} // namespace
+
+uint32_t MortonKey30(uint32_t x, uint32_t y, uint32_t z) {
+    return Part1By2(x) | (Part1By2(y) << 1) | (Part1By2(z) << 2);
+}
+
+uint64_t MortonKey63(uint32_t x, uint32_t y, uint32_t z) {
+    return Part1By2(uint64_t(x)) | (Part1By2(uint64_t(y)) << 1) | (Part1By2(uint64_t(z)) << 2);
+}
+
+uint32_t HilbertKey30(uint32_t x, uint32_t y, uint32_t z) {
+    x &= 0x3ff;
+    y &= 0x3ff;
+    z &= 0x3ff;
+    AxesToTranspose(x, y, z, 10);
+    // x carries the most significant bit of each triple
+    return MortonKey30(z, y, x);
+}
+
+uint64_t HilbertKey63(uint32_t x, uint32_t y, uint32_t z) {
+    x &= 0x1fffff;
+    y &= 0x1fffff;
+    z &= 0x1fffff;
+    AxesToTranspose(x, y, z, 21);
+    return MortonKey63(z, y, x);
+}
+
+void ComputeKeys30(const Vec3f* points, size_t count, SpaceFillingCurve curve, uint32_t* keys) {
+    if (curve == SpaceFillingCurve::Hilbert) {
+        ComputeKeysImpl(points, count, 10, keys, [](uint32_t x, uint32_t y, uint32_t z) { return HilbertKey30(x, y, z); });
+    } else {
+        ComputeKeysImpl(points, count, 10, keys, [](uint32_t x, uint32_t y, uint32_t z) { return MortonKey30(x, y, z); });
+    }
+}
+
+void ComputeKeys63(const Vec3f* points, size_t count, SpaceFillingCurve curve, uint64_t* keys) {
+    if (curve == SpaceFillingCurve::Hilbert) {
+        ComputeKeysImpl(points, count, 21, keys, [](uint32_t x, uint32_t y, uint32_t z) { return HilbertKey63(x, y, z); });
+    } else {
+        ComputeKeysImpl(points, count, 21, keys, [](uint32_t x, uint32_t y, uint32_t z) { return MortonKey63(x, y, z); });
+    }
+}
+
+void RadixSort(std::vector<uint32_t>& keys, std::vector<uint32_t>& values) {
+    RadixSortImpl(keys, values);
+}
+
+void RadixSort(std::vector<uint64_t>& keys, std::vector<uint32_t>& values) {
+    RadixSortImpl(keys, values);
+}
+
+std::vector<uint32_t> ComputeSpatialOrder(const Vec3f* points, size_t count, SpaceFillingCurve curve, KeyBits bits) {
+    if (bits == KeyBits::Bits63) {
+        std::vector<uint64_t> keys(count);
+        ComputeKeys63(points, count, curve, keys.data());
+        return SortedOrder(keys);
+    }
+    std::vector<uint32_t> keys(count);
+    ComputeKeys30(points, count, curve, keys.data());
+    return SortedOrder(keys);
+}
+
+std::vector<uint32_t> InvertPermutation(const std::vector<uint32_t>& order) {
+    std::vector<uint32_t> inverse(order.size());
+    parallel::For(order.size(), 16384, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            inverse[order[i]] = static_cast<uint32_t>(i);
+        }
+    });
+    return inverse;
+}
+
+bool CheckAttributeSizes(size_t pointCount, std::initializer_list<size_t> attributeSizes) {
+    size_t index = 0;
+    for (size_t size : attributeSizes) {
+        if (size != pointCount) {
+            std::cerr << "SpatialReorder: attribute " << index << " holds " << size << " entries for " << pointCount
+                      << " points" << std::endl;
+            return false;
+        }
+        ++index;
+    }
+    return true;
+}
+
+void RemapIndices(uint32_t* indices, size_t count, const std::vector<uint32_t>& inverse) {
+    parallel::For(count, 16384, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            indices[i] = inverse[indices[i]];
+        }
+    });
+}
+
+} // namespace spatial
+} // namespace alice2
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "../../../core/base/Types.h"
+#include "Parallel.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+
+namespace alice2 {
+namespace spatial {
+
+// Space-filling curve orderings for point and vertex sets. Keys are computed
+// on a cube around the bounds so neighbouring points get nearby keys; sorting
+// by key gives cache-friendly layouts for neighbour queries and vertex fetch.
+
+enum class SpaceFillingCurve {
+    Morton,
+    Hilbert
+};
+
+enum class KeyBits {
+    Bits30, // 10 bits per axis, uint32_t keys
+    Bits63  // 21 bits per axis, uint64_t keys
+};
+
+// Bit interleaving (x in the lowest bit of each triple)
+uint32_t MortonKey30(uint32_t x, uint32_t y, uint32_t z);
+uint64_t MortonKey63(uint32_t x, uint32_t y, uint32_t z);
+
+// Hilbert index for integer coordinates (Skilling's transpose algorithm)
+uint32_t HilbertKey30(uint32_t x, uint32_t y, uint32_t z);
+uint64_t HilbertKey63(uint32_t x, uint32_t y, uint32_t z);
+
+// Key per point, quantised against the bounding cube of the set
+void ComputeKeys30(const Vec3f* points, size_t count, SpaceFillingCurve curve, uint32_t* keys);
+void ComputeKeys63(const Vec3f* points, size_t count, SpaceFillingCurve curve, uint64_t* keys);
+
+// Parallel LSD radix sort of keys carrying a payload of uint32_t values.
+// Digit passes whose digit is constant across all keys are skipped.
+void RadixSort(std::vector<uint32_t>& keys, std::vector<uint32_t>& values);
+void RadixSort(std::vector<uint64_t>& keys, std::vector<uint32_t>& values);
+
+// Ordering permutation: sorted[i] = points[order[i]]
+std::vector<uint32_t> ComputeSpatialOrder(const Vec3f* points, size_t count,
+                                          SpaceFillingCurve curve = SpaceFillingCurve::Hilbert,
+                                          KeyBits bits = KeyBits::Bits30);
+
+// inverse[order[i]] = i, i.e. maps old indices to new ones
+std::vector<uint32_t> InvertPermutation(const std::vector<uint32_t>& order);
+
+// Rewrites old element indices (e.g. face vertex indices) to their new positions
+void RemapIndices(uint32_t* indices, size_t count, const std::vector<uint32_t>& inverse);
+
+// Gathers data into the given order in parallel; false, leaving data as it
+// was, when the sizes differ
+template <typename T>
+bool ApplyPermutation(std::vector<T>& data, const std::vector<uint32_t>& order) {
+    if (data.size() != order.size()) {
+        return false;
+    }
+    std::vector<T> sorted(data.size());
+    parallel::For(order.size(), 4096, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            sorted[i] = data[order[i]];
+        }
+    });
+    data.swap(sorted);
+    return true;
+}
+
+// True when every attribute size equals pointCount; otherwise reports the
+// first mismatch
+bool CheckAttributeSizes(size_t pointCount, std::initializer_list<size_t> attributeSizes);
+
+// Reorders points and every attached per-point attribute array along the
+// curve and returns the permutation (sorted[i] = original[order[i]]). Sizes
+// are checked first: if any attribute does not match the points, nothing is
+// reordered and the permutation is empty.
+template <typename... Attributes>
+std::vector<uint32_t> SpatialReorder(std::vector<Vec3f>& points, SpaceFillingCurve curve, KeyBits bits,
+                                     Attributes&... attributes) {
+    if (!CheckAttributeSizes(points.size(), {attributes.size()...})) {
+        return {};
+    }
+    std::vector<uint32_t> order = ComputeSpatialOrder(points.data(), points.size(), curve, bits);
+    ApplyPermutation(points, order);
+    (ApplyPermutation(attributes, order), ...);
+    return order;
+}
+
+} // namespace spatial
+} // namespace alice2
@@ -0,0 +1,79 @@
+#include "UnionFind.h"
+#include "Parallel.h"
+
+#include <numeric>
+#include <utility>
+
+namespace alice2 {
+
+namespace {
+
+constexpr size_t ElementGrain = 16384;
+
+} // namespace
+
+void UnionFind::Reset(size_t count) {
+    m_Parents.resize(count);
+    parallel::For(count, ElementGrain, [&](size_t begin, size_t end) {
+        std::iota(m_Parents.begin() + begin, m_Parents.begin() + end, uint32_t(begin));
+    });
+}
+
+uint32_t UnionFind::Find(uint32_t element) {
+    uint32_t parent = Parent(element);
+    while (parent != element) {
+        uint32_t grandparent = Parent(parent);
+        if (grandparent != parent) {
+            // Path halving; losing the race only means another thread
+            // shortened the path first
+            std::atomic_ref<uint32_t>(m_Parents[element])
+                .compare_exchange_weak(parent, grandparent, std::memory_order_relaxed);
+        }
+        element = grandparent;
+        parent = Parent(element);
+    }
+    return element;
+}
+
+bool UnionFind::Unite(uint32_t a, uint32_t b) {
+    while (true) {
+        a = Find(a);
+        b = Find(b);
+        if (a == b) {
+            return false;
+        }
+        if (a < b) {
+            std::swap(a, b);
+        }
+        // a is the larger root; link it under b unless it stopped being a root
+        uint32_t expected = a;
+        if (std::atomic_ref<uint32_t>(m_Parents[a]).compare_exchange_strong(expected, b, std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+}
+
+bool UnionFind::IsSameSet(uint32_t a, uint32_t b) {
+    while (true) {
+        a = Find(a);
+        b = Find(b);
+        if (a == b) {
+            return true;
+        }
+        // Different roots are only final while the larger one is still a root
+        if (Parent(a < b ? b : a) == (a < b ? b : a)) {
+            return false;
+        }
+    }
+}
+
+void UnionFind::GetRoots(std::vector<uint32_t>& roots) {
+    roots.resize(m_Parents.size());
+    parallel::For(m_Parents.size(), ElementGrain, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            roots[i] = Find(uint32_t(i));
+        }
+    });
+}
+
+} // namespace alice2
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace alice2 {
+
+// Disjoint sets over [0, n) that any number of threads may unite and query
+// concurrently, without locks. Roots are linked by index, the larger under
+// the smaller, with a compare-and-swap on the root's parent; Find() halves
+// paths with the same kind of swap. Parents only ever decrease, so the
+// structure stays a forest under races and a set's root is always its
+// smallest element, which makes labels independent of the thread schedule.
+class UnionFind {
+public:
+    UnionFind() = default;
+    explicit UnionFind(size_t count) { Reset(count); }
+
+    // Every element in its own set
+    void Reset(size_t count);
+    size_t GetCount() const { return m_Parents.size(); }
+
+    uint32_t Find(uint32_t element);
+    // False when the two were already in one set
+    bool Unite(uint32_t a, uint32_t b);
+    bool IsSameSet(uint32_t a, uint32_t b);
+
+    // Root of every element, in parallel; call while no thread unites
+    void GetRoots(std::vector<uint32_t>& roots);
+
+private:
+    std::vector<uint32_t> m_Parents;
+
+    uint32_t Parent(uint32_t element) {
+        return std::atomic_ref<uint32_t>(m_Parents[element]).load(std::memory_order_relaxed);
+    }
+};
+
+} // namespace alice2
@@ -109,12 +109,12 @@ struct Vec3f {
         b.Normalize();
 
         float dotProduct = a.Dot(b);
-        float factor = std::powf(10.0f, PRECISION);
-        dotProduct = std::roundf(dotProduct * factor) / factor;
+        float factor = std::pow(10.0f, static_cast<float>(PRECISION));
+        dotProduct = std::round(dotProduct * factor) / factor;
 
         if (dotProduct >= 1.0f) return 0.0f;
         if (dotProduct <= -1.0f) return 180.0f;
-        return std::acosf(dotProduct) * RAD_TO_DEG;
+        return std::acos(dotProduct) * RAD_TO_DEG;
     }
 
     float Angle360(const Vec3f& v1, const Vec3f& normal) const {
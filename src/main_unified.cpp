@@ -53,7 +53,11 @@ extern "C" {
     }
     
     EMSCRIPTEN_KEEPALIVE void alice2_set_fov(float fov) {
-        // Implementation would set camera FOV
+        if (auto* scene = alice2::UnifiedApplication::Get().GetScene()) {
+            if (auto* camera = scene->GetCamera()) {
+                camera->SetFov(fov);
+            }
+        }
         std::cout << "Setting FOV to: " << fov << " degrees" << std::endl;
     }
     
@@ -1,8 +1,12 @@
 #include "unified_renderer.h"
 #include "../platform/platform_interface.h"
+#include "../coda/core/geometry/PointOctree.h"
 #include <iostream>
 #include <cassert>
 #include <cstring>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <thread>
 #include <chrono>
 
@@ -56,6 +60,108 @@ fn fs_main(input: VertexOutput) -> @location(0) vec4<f32> {
 }
 )";
 
+// Line streams pull their vertices: each index names a vertex in a tightly
+// packed xyz array, and colours come per vertex, per line or uniform.
+// vs_points draws the vertices themselves as quads in one colour.
+static const char* LINE_STREAM_SHADER_SOURCE = R"(
+struct Uniforms {
+    mvp_matrix: mat4x4<f32>,
+}
+
+struct LineParams {
+    color_mode: u32,
+    point_size: f32,
+    viewport: vec2<f32>,
+    point_color: vec4<f32>,
+}
+
+struct VertexOutput {
+    @builtin(position) position: vec4<f32>,
+    @location(0) color: vec4<f32>,
+    @location(1) size: f32,
+}
+
+@group(0) @binding(0) var<uniform> uniforms: Uniforms;
+@group(1) @binding(0) var<storage, read> positions: array<f32>;
+@group(1) @binding(1) var<storage, read> indices: array<u32>;
+@group(1) @binding(2) var<storage, read> colors: array<vec4<f32>>;
+@group(1) @binding(3) var<uniform> params: LineParams;
+
+@vertex
+fn vs_main(@builtin(vertex_index) index: u32) -> VertexOutput {
+    let vertex = indices[index];
+    let position = vec3<f32>(positions[3u * vertex], positions[3u * vertex + 1u], positions[3u * vertex + 2u]);
+    var color_index = 0u;
+    if (params.color_mode == 1u) {
+        color_index = vertex;
+    } else if (params.color_mode == 2u) {
+        color_index = index / 2u;
+    }
+    var output: VertexOutput;
+    output.position = uniforms.mvp_matrix * vec4<f32>(position, 1.0);
+    output.color = colors[color_index];
+    output.size = 1.0;
+    return output;
+}
+
+// Two triangles per point, point_size pixels across
+@vertex
+fn vs_points(@builtin(vertex_index) index: u32) -> VertexOutput {
+    var corners = array<vec2<f32>, 6>(vec2<f32>(-1.0, -1.0), vec2<f32>(1.0, -1.0), vec2<f32>(1.0, 1.0),
+                                      vec2<f32>(-1.0, -1.0), vec2<f32>(1.0, 1.0), vec2<f32>(-1.0, 1.0));
+    let vertex = index / 6u;
+    let position = vec3<f32>(positions[3u * vertex], positions[3u * vertex + 1u], positions[3u * vertex + 2u]);
+    let clip = uniforms.mvp_matrix * vec4<f32>(position, 1.0);
+    let offset = corners[index % 6u] * params.point_size / params.viewport * clip.w;
+    var output: VertexOutput;
+    output.position = clip + vec4<f32>(offset, 0.0, 0.0);
+    output.color = params.point_color;
+    output.size = params.point_size;
+    return output;
+}
+)";
+
+// Point pools pull 16-byte records by vertex index: the position and an
+// RGBA8 colour, unpacked in the shader
+static const char* POINT_POOL_SHADER_SOURCE = R"(
+struct Uniforms {
+    mvp_matrix: mat4x4<f32>,
+}
+
+struct PooledPoint {
+    position: vec3<f32>,
+    color: u32,
+}
+
+struct VertexOutput {
+    @builtin(position) position: vec4<f32>,
+    @location(0) color: vec4<f32>,
+    @location(1) size: f32,
+}
+
+@group(0) @binding(0) var<uniform> uniforms: Uniforms;
+@group(1) @binding(0) var<storage, read> points: array<PooledPoint>;
+
+@vertex
+fn vs_main(@builtin(vertex_index) index: u32) -> VertexOutput {
+    let point = points[index];
+    var output: VertexOutput;
+    output.position = uniforms.mvp_matrix * vec4<f32>(point.position, 1.0);
+    output.color = unpack4x8unorm(point.color);
+    output.size = 1.0;
+    return output;
+}
+)";
+
+static_assert(sizeof(Vec3f) == 3 * sizeof(float), "line streams read positions as packed xyz");
+static_assert(sizeof(Color) == 4 * sizeof(float), "line streams read colours as vec4<f32>");
+
+// Dirty vertices closer than this are uploaded as one run
+static const size_t DIRTY_RUN_MERGE_GAP = 64;
+
+// Point pool pages stay at half the default maxStorageBufferBindingSize
+static const size_t POINT_POOL_PAGE_BYTES = size_t(64) << 20;
+
 // WebGPU callback functions
 static void OnAdapterRequestEnded(WGPURequestAdapterStatus status, WGPUAdapter adapter, char const* message, void* userdata) {
     if (status == WGPURequestAdapterStatus_Success) {
@@ -101,6 +207,11 @@ bool UnifiedRenderer::Initialize(platform::IPlatform* platform) {
         return false;
     }
     
+    if (!CreateDepthTexture()) {
+        std::cerr << "Failed to create depth texture" << std::endl;
+        return false;
+    }
+
     if (!CreatePipelines()) {
         std::cerr << "Failed to create rendering pipelines" << std::endl;
         return false;
@@ -125,6 +236,14 @@ void UnifiedRenderer::Shutdown() {
         wgpuBindGroupLayoutRelease(m_BindGroupLayout);
         m_BindGroupLayout = nullptr;
     }
+    if (m_LineStreamLayout) {
+        wgpuBindGroupLayoutRelease(m_LineStreamLayout);
+        m_LineStreamLayout = nullptr;
+    }
+    if (m_PointPoolLayout) {
+        wgpuBindGroupLayoutRelease(m_PointPoolLayout);
+        m_PointPoolLayout = nullptr;
+    }
     if (m_UniformBuffer) {
         wgpuBufferRelease(m_UniformBuffer);
         m_UniformBuffer = nullptr;
@@ -133,18 +252,9 @@ void UnifiedRenderer::Shutdown() {
         wgpuBufferRelease(m_VertexBuffer);
         m_VertexBuffer = nullptr;
     }
-    if (m_PointPipeline) {
-        wgpuRenderPipelineRelease(m_PointPipeline);
-        m_PointPipeline = nullptr;
-    }
-    if (m_LinePipeline) {
-        wgpuRenderPipelineRelease(m_LinePipeline);
-        m_LinePipeline = nullptr;
-    }
-    if (m_TrianglePipeline) {
-        wgpuRenderPipelineRelease(m_TrianglePipeline);
-        m_TrianglePipeline = nullptr;
-    }
+    m_VertexBufferCapacity = 0;
+    ReleasePipelines();
+    ReleaseDepthTexture();
     if (m_Queue) {
         wgpuQueueRelease(m_Queue);
         m_Queue = nullptr;
@@ -170,12 +280,25 @@ void UnifiedRenderer::BeginFrame() {
     m_PointVertices.clear();
     m_LineVertices.clear();
     m_TriangleVertices.clear();
+    m_IndexedDraws.clear();
+    m_LineStreamDraws.clear();
+    m_LineStreamPointDraws.clear();
+    m_PointPoolDraws.clear();
 }
 
 void UnifiedRenderer::EndFrame() {
     // Update uniform buffer with current matrices
     UpdateUniformBuffer();
 
+    // The immediate batches share one vertex buffer at consecutive offsets,
+    // since every queued write lands before the pass runs
+    if (!ReserveVertexBuffer(m_PointVertices.size() + m_LineVertices.size() + m_TriangleVertices.size())) {
+        m_PointVertices.clear();
+        m_LineVertices.clear();
+        m_TriangleVertices.clear();
+    }
+    size_t vertexOffset = 0;
+
     // Get current surface texture
     WGPUSurfaceTexture surfaceTexture;
     wgpuSurfaceGetCurrentTexture(m_Surface, &surfaceTexture);
@@ -212,12 +335,24 @@ void UnifiedRenderer::EndFrame() {
     colorAttachment.storeOp = WGPUStoreOp_Store;
     colorAttachment.clearValue = {m_ClearColor.r, m_ClearColor.g, m_ClearColor.b, m_ClearColor.a};
 
+    // Reversed-Z clears depth to 0 (far) and keeps fragments with greater depth
+    WGPURenderPassDepthStencilAttachment depthAttachment = {};
+    depthAttachment.view = m_DepthTextureView;
+    depthAttachment.depthLoadOp = WGPULoadOp_Clear;
+    depthAttachment.depthStoreOp = WGPUStoreOp_Store;
+    depthAttachment.depthClearValue = m_ReversedZ ? 0.0f : 1.0f;
+    depthAttachment.depthReadOnly = false;
+    depthAttachment.stencilLoadOp = WGPULoadOp_Undefined;
+    depthAttachment.stencilStoreOp = WGPUStoreOp_Undefined;
+    depthAttachment.stencilClearValue = 0;
+    depthAttachment.stencilReadOnly = true;
+
     WGPURenderPassDescriptor renderPassDesc = {};
     renderPassDesc.nextInChain = nullptr;
     renderPassDesc.label = "Alice2 Render Pass";
     renderPassDesc.colorAttachmentCount = 1;
     renderPassDesc.colorAttachments = &colorAttachment;
-    renderPassDesc.depthStencilAttachment = nullptr;
+    renderPassDesc.depthStencilAttachment = m_DepthTextureView ? &depthAttachment : nullptr;
 
     WGPURenderPassEncoder renderPass = wgpuCommandEncoderBeginRenderPass(encoder, &renderPassDesc);
     if (!renderPass) {
@@ -232,17 +367,59 @@ void UnifiedRenderer::EndFrame() {
 
     // Render points
     if (!m_PointVertices.empty()) {
-        FlushVertexData(m_PointVertices, m_PointPipeline, renderPass);
+        FlushVertexData(m_PointVertices, vertexOffset, m_PointPipeline, renderPass);
+    }
+
+    // Render point pool blocks, binding each page once per run
+    if (!m_PointPoolDraws.empty() && m_PointPoolPipeline) {
+        wgpuRenderPassEncoderSetPipeline(renderPass, m_PointPoolPipeline);
+        WGPUBindGroup bound = nullptr;
+        for (const PointPoolDraw& draw : m_PointPoolDraws) {
+            if (draw.bindGroup != bound) {
+                wgpuRenderPassEncoderSetBindGroup(renderPass, 1, draw.bindGroup, 0, nullptr);
+                bound = draw.bindGroup;
+            }
+            wgpuRenderPassEncoderDraw(renderPass, draw.count, 1, draw.firstPoint, 0);
+        }
     }
 
     // Render lines
     if (!m_LineVertices.empty()) {
-        FlushVertexData(m_LineVertices, m_LinePipeline, renderPass);
+        FlushVertexData(m_LineVertices, vertexOffset, m_LinePipeline, renderPass);
+    }
+
+    // Render line streams
+    if (!m_LineStreamDraws.empty() && m_LineStreamPipeline) {
+        wgpuRenderPassEncoderSetPipeline(renderPass, m_LineStreamPipeline);
+        for (const LineStream& stream : m_LineStreamDraws) {
+            wgpuRenderPassEncoderSetBindGroup(renderPass, 1, stream.bindGroup, 0, nullptr);
+            wgpuRenderPassEncoderDraw(renderPass, stream.indexCount, 1, 0, 0);
+        }
+    }
+
+    // Render line stream vertices as points
+    if (!m_LineStreamPointDraws.empty() && m_LineStreamPointPipeline) {
+        wgpuRenderPassEncoderSetPipeline(renderPass, m_LineStreamPointPipeline);
+        for (const LineStream& stream : m_LineStreamPointDraws) {
+            wgpuRenderPassEncoderSetBindGroup(renderPass, 1, stream.bindGroup, 0, nullptr);
+            wgpuRenderPassEncoderDraw(renderPass, stream.vertexCount * 6, 1, 0, 0);
+        }
     }
 
     // Render triangles
     if (!m_TriangleVertices.empty()) {
-        FlushVertexData(m_TriangleVertices, m_TrianglePipeline, renderPass);
+        FlushVertexData(m_TriangleVertices, vertexOffset, m_TrianglePipeline, renderPass);
+    }
+
+    // Render retained indexed meshes with the triangle pipeline
+    if (!m_IndexedDraws.empty() && m_TrianglePipeline) {
+        wgpuRenderPassEncoderSetPipeline(renderPass, m_TrianglePipeline);
+        for (const IndexedMesh& mesh : m_IndexedDraws) {
+            wgpuRenderPassEncoderSetVertexBuffer(renderPass, 0, mesh.vertexBuffer, 0, mesh.vertexCount * sizeof(Vertex));
+            wgpuRenderPassEncoderSetIndexBuffer(renderPass, mesh.indexBuffer, WGPUIndexFormat_Uint32, 0,
+                                                mesh.indexCount * sizeof(uint32_t));
+            wgpuRenderPassEncoderDrawIndexed(renderPass, mesh.indexCount, 1, 0, 0, 0);
+        }
     }
 
     // End render pass
@@ -348,20 +525,33 @@ void UnifiedRenderer::EndTriangles() {
 }
 
 void UnifiedRenderer::SetViewMatrix(const float* viewMatrix) {
-    if (viewMatrix) {
+    if (viewMatrix && !std::equal(viewMatrix, viewMatrix + 16, m_ViewMatrix.begin())) {
         std::copy(viewMatrix, viewMatrix + 16, m_ViewMatrix.begin());
+        m_HasViewProjectionMatrix = false;
+        m_UniformsDirty = true;
     }
 }
 
 void UnifiedRenderer::SetProjectionMatrix(const float* projMatrix) {
-    if (projMatrix) {
+    if (projMatrix && !std::equal(projMatrix, projMatrix + 16, m_ProjectionMatrix.begin())) {
         std::copy(projMatrix, projMatrix + 16, m_ProjectionMatrix.begin());
+        m_HasViewProjectionMatrix = false;
+        m_UniformsDirty = true;
     }
 }
 
 void UnifiedRenderer::SetModelMatrix(const float* modelMatrix) {
-    if (modelMatrix) {
+    if (modelMatrix && !std::equal(modelMatrix, modelMatrix + 16, m_ModelMatrix.begin())) {
         std::copy(modelMatrix, modelMatrix + 16, m_ModelMatrix.begin());
+        m_UniformsDirty = true;
+    }
+}
+
+void UnifiedRenderer::SetViewProjectionMatrix(const float* viewProjMatrix) {
+    if (viewProjMatrix) {
+        std::copy(viewProjMatrix, viewProjMatrix + 16, m_ViewProjectionMatrix.begin());
+        m_HasViewProjectionMatrix = true;
+        m_UniformsDirty = true;
     }
 }
 
@@ -370,13 +560,459 @@ void UnifiedRenderer::SetViewport(int width, int height) {
     m_Height = height;
     std::cout << "Setting viewport to " << width << "x" << height << std::endl;
 
-    // TODO: Reconfigure WebGPU surface when implemented
+    // Reconfigure the surface and resize the depth attachment to match
+    if (m_Device && m_Surface && width > 0 && height > 0) {
+        ConfigureSurface();
+        CreateDepthTexture();
+    }
 }
 
 void UnifiedRenderer::SetClearColor(const Color& color) {
     m_ClearColor = color;
 }
 
+void UnifiedRenderer::SetReversedZ(bool reversed) {
+    if (reversed == m_ReversedZ) {
+        return;
+    }
+    m_ReversedZ = reversed;
+
+    // Depth compare is baked into the pipelines, so rebuild them
+    if (m_Device) {
+        ReleasePipelines();
+        CreatePipelines();
+    }
+}
+
+WGPUVertexFormat UnifiedRenderer::GetVertexFormat(const quantize::PackedAttribute& attribute) {
+    if (!attribute.IsVertexFetchable()) {
+        return WGPUVertexFormat_Undefined;
+    }
+
+    int components = attribute.GetStoredComponents();
+    switch (attribute.GetFormat()) {
+    case quantize::AttributeFormat::Float32:
+        switch (components) {
+        case 1: return WGPUVertexFormat_Float32;
+        case 2: return WGPUVertexFormat_Float32x2;
+        case 3: return WGPUVertexFormat_Float32x3;
+        default: return WGPUVertexFormat_Float32x4;
+        }
+    case quantize::AttributeFormat::Half:
+        return components == 2 ? WGPUVertexFormat_Float16x2 : WGPUVertexFormat_Float16x4;
+    case quantize::AttributeFormat::Snorm16:
+        return components == 2 ? WGPUVertexFormat_Snorm16x2 : WGPUVertexFormat_Snorm16x4;
+    case quantize::AttributeFormat::Unorm8:
+        return WGPUVertexFormat_Unorm8x4;
+    case quantize::AttributeFormat::Octahedral:
+        return WGPUVertexFormat_Snorm16x2; // Unfolded in the vertex shader
+    }
+    return WGPUVertexFormat_Undefined;
+}
+
+WGPUBuffer UnifiedRenderer::CreateAttributeBuffer(const quantize::PackedAttribute& attribute, const char* label) {
+    if (!m_Device || attribute.GetCount() == 0) {
+        return nullptr;
+    }
+
+    // Queue writes must be 4-byte multiples; packed storage is word aligned
+    WGPUBufferDescriptor bufferDesc = {};
+    bufferDesc.nextInChain = nullptr;
+    bufferDesc.label = label;
+    bufferDesc.usage = WGPUBufferUsage_Vertex | WGPUBufferUsage_Storage | WGPUBufferUsage_CopyDst;
+    bufferDesc.size = (attribute.GetByteSize() + 3) & ~size_t(3);
+    bufferDesc.mappedAtCreation = false;
+
+    WGPUBuffer buffer = wgpuDeviceCreateBuffer(m_Device, &bufferDesc);
+    if (!buffer) {
+        std::cerr << "Failed to create attribute buffer" << std::endl;
+        return nullptr;
+    }
+
+    UpdateAttributeBuffer(buffer, attribute);
+    return buffer;
+}
+
+void UnifiedRenderer::UpdateAttributeBuffer(WGPUBuffer buffer, const quantize::PackedAttribute& attribute) {
+    if (!buffer || attribute.GetCount() == 0) {
+        return;
+    }
+    size_t size = (attribute.GetByteSize() + 3) & ~size_t(3);
+    wgpuQueueWriteBuffer(m_Queue, buffer, 0, attribute.GetData(), size);
+}
+
+bool UnifiedRenderer::CreateIndexedMesh(IndexedMesh& mesh, const Vertex* vertices, size_t vertexCount,
+                                        const uint32_t* indices, size_t indexCount) {
+    ReleaseIndexedMesh(mesh);
+    if (!m_Device || vertexCount == 0 || indexCount == 0) {
+        return false;
+    }
+
+    WGPUBufferDescriptor bufferDesc = {};
+    bufferDesc.nextInChain = nullptr;
+    bufferDesc.label = "Alice2 Indexed Mesh Vertices";
+    bufferDesc.usage = WGPUBufferUsage_Vertex | WGPUBufferUsage_CopyDst;
+    bufferDesc.size = vertexCount * sizeof(Vertex);
+    bufferDesc.mappedAtCreation = false;
+    mesh.vertexBuffer = wgpuDeviceCreateBuffer(m_Device, &bufferDesc);
+
+    bufferDesc.label = "Alice2 Indexed Mesh Indices";
+    bufferDesc.usage = WGPUBufferUsage_Index | WGPUBufferUsage_CopyDst;
+    bufferDesc.size = indexCount * sizeof(uint32_t);
+    mesh.indexBuffer = wgpuDeviceCreateBuffer(m_Device, &bufferDesc);
+
+    if (!mesh.vertexBuffer || !mesh.indexBuffer) {
+        std::cerr << "Failed to create indexed mesh buffers" << std::endl;
+        ReleaseIndexedMesh(mesh);
+        return false;
+    }
+
+    mesh.vertexCount = static_cast<uint32_t>(vertexCount);
+    mesh.indexCount = static_cast<uint32_t>(indexCount);
+    mesh.indexCapacity = mesh.indexCount;
+    wgpuQueueWriteBuffer(m_Queue, mesh.vertexBuffer, 0, vertices, vertexCount * sizeof(Vertex));
+    wgpuQueueWriteBuffer(m_Queue, mesh.indexBuffer, 0, indices, indexCount * sizeof(uint32_t));
+    return true;
+}
+
+void UnifiedRenderer::UpdateIndexedMeshVertices(const IndexedMesh& mesh, const Vertex* vertices, size_t count, size_t first) {
+    if (!mesh.vertexBuffer || count == 0 || first + count > mesh.vertexCount) {
+        return;
+    }
+    wgpuQueueWriteBuffer(m_Queue, mesh.vertexBuffer, first * sizeof(Vertex), vertices, count * sizeof(Vertex));
+}
+
+void UnifiedRenderer::UpdateIndexedMeshVertices(const IndexedMesh& mesh, const Vertex* vertices,
+                                                std::vector<uint32_t>& indices) {
+    if (!mesh.vertexBuffer || indices.empty()) {
+        return;
+    }
+    std::sort(indices.begin(), indices.end());
+    indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+    while (!indices.empty() && indices.back() >= mesh.vertexCount) {
+        indices.pop_back();
+    }
+    size_t begin = 0;
+    for (size_t i = 1; i <= indices.size(); ++i) {
+        if (i == indices.size() || indices[i] - indices[i - 1] > DIRTY_RUN_MERGE_GAP) {
+            size_t first = indices[begin];
+            UpdateIndexedMeshVertices(mesh, vertices + first, indices[i - 1] + 1 - first, first);
+            begin = i;
+        }
+    }
+}
+
+bool UnifiedRenderer::UpdateIndexedMeshIndices(IndexedMesh& mesh, const uint32_t* indices, size_t count) {
+    if (!mesh.vertexBuffer || !m_Device) {
+        return false;
+    }
+    if (count > mesh.indexCapacity) {
+        if (mesh.indexBuffer) {
+            wgpuBufferRelease(mesh.indexBuffer);
+        }
+        WGPUBufferDescriptor bufferDesc = {};
+        bufferDesc.nextInChain = nullptr;
+        bufferDesc.label = "Alice2 Indexed Mesh Indices";
+        bufferDesc.usage = WGPUBufferUsage_Index | WGPUBufferUsage_CopyDst;
+        bufferDesc.size = count * sizeof(uint32_t);
+        bufferDesc.mappedAtCreation = false;
+        mesh.indexBuffer = wgpuDeviceCreateBuffer(m_Device, &bufferDesc);
+        if (!mesh.indexBuffer) {
+            std::cerr << "Failed to create indexed mesh buffers" << std::endl;
+            ReleaseIndexedMesh(mesh);
+            return false;
+        }
+        mesh.indexCapacity = static_cast<uint32_t>(count);
+    }
+    mesh.indexCount = static_cast<uint32_t>(count);
+    if (count > 0) {
+        wgpuQueueWriteBuffer(m_Queue, mesh.indexBuffer, 0, indices, count * sizeof(uint32_t));
+    }
+    return true;
+}
+
+void UnifiedRenderer::DrawIndexedMesh(const IndexedMesh& mesh) {
+    if (mesh.vertexBuffer && mesh.indexBuffer && mesh.indexCount > 0) {
+        m_IndexedDraws.push_back(mesh);
+    }
+}
+
+void UnifiedRenderer::ReleaseIndexedMesh(IndexedMesh& mesh) {
+    if (mesh.vertexBuffer) {
+        wgpuBufferRelease(mesh.vertexBuffer);
+    }
+    if (mesh.indexBuffer) {
+        wgpuBufferRelease(mesh.indexBuffer);
+    }
+    mesh = IndexedMesh();
+}
+
+WGPUBuffer UnifiedRenderer::CreateStreamBuffer(const char* label, WGPUBufferUsageFlags usage, size_t size) {
+    WGPUBufferDescriptor bufferDesc = {};
+    bufferDesc.nextInChain = nullptr;
+    bufferDesc.label = label;
+    bufferDesc.usage = usage | WGPUBufferUsage_CopyDst;
+    // Bindings must not be empty
+    bufferDesc.size = std::max<size_t>((size + 15) & ~size_t(15), 16);
+    bufferDesc.mappedAtCreation = false;
+    return wgpuDeviceCreateBuffer(m_Device, &bufferDesc);
+}
+
+bool UnifiedRenderer::BindLineStream(LineStream& stream) {
+    if (stream.bindGroup) {
+        wgpuBindGroupRelease(stream.bindGroup);
+        stream.bindGroup = nullptr;
+    }
+    if (!m_LineStreamLayout) {
+        return false;
+    }
+    WGPUBuffer buffers[4] = {stream.positionBuffer, stream.indexBuffer, stream.colorBuffer, stream.paramBuffer};
+    WGPUBindGroupEntry entries[4] = {};
+    for (uint32_t i = 0; i < 4; ++i) {
+        entries[i].binding = i;
+        entries[i].buffer = buffers[i];
+        entries[i].offset = 0;
+        entries[i].size = wgpuBufferGetSize(buffers[i]);
+    }
+
+    WGPUBindGroupDescriptor bindGroupDesc = {};
+    bindGroupDesc.nextInChain = nullptr;
+    bindGroupDesc.label = "Alice2 Line Stream Bind Group";
+    bindGroupDesc.layout = m_LineStreamLayout;
+    bindGroupDesc.entryCount = 4;
+    bindGroupDesc.entries = entries;
+    stream.bindGroup = wgpuDeviceCreateBindGroup(m_Device, &bindGroupDesc);
+    return stream.bindGroup != nullptr;
+}
+
+bool UnifiedRenderer::CreateLineStream(LineStream& stream, const Vec3f* positions, size_t vertexCount,
+                                       const uint32_t* indices, size_t indexCount) {
+    ReleaseLineStream(stream);
+    if (!m_Device || vertexCount == 0) {
+        return false;
+    }
+
+    stream.positionBuffer = CreateStreamBuffer("Alice2 Line Stream Positions", WGPUBufferUsage_Storage,
+                                               vertexCount * sizeof(Vec3f));
+    stream.indexBuffer = CreateStreamBuffer("Alice2 Line Stream Indices", WGPUBufferUsage_Storage,
+                                            indexCount * sizeof(uint32_t));
+    stream.colorBuffer = CreateStreamBuffer("Alice2 Line Stream Colors", WGPUBufferUsage_Storage, sizeof(Color));
+    stream.paramBuffer = CreateStreamBuffer("Alice2 Line Stream Params", WGPUBufferUsage_Uniform, 32);
+    if (!stream.positionBuffer || !stream.indexBuffer || !stream.colorBuffer || !stream.paramBuffer) {
+        std::cerr << "Failed to create line stream buffers" << std::endl;
+        ReleaseLineStream(stream);
+        return false;
+    }
+    stream.vertexCount = static_cast<uint32_t>(vertexCount);
+    stream.indexCount = static_cast<uint32_t>(indexCount);
+    stream.indexCapacity = std::max<uint32_t>(stream.indexCount, 4);
+    stream.colorCapacity = 1;
+
+    wgpuQueueWriteBuffer(m_Queue, stream.positionBuffer, 0, positions, vertexCount * sizeof(Vec3f));
+    if (indexCount > 0) {
+        wgpuQueueWriteBuffer(m_Queue, stream.indexBuffer, 0, indices, indexCount * sizeof(uint32_t));
+    }
+    Color color = Color::Black();
+    if (!BindLineStream(stream) || !SetLineStreamColors(stream, LineColorMode::Uniform, &color, 1)) {
+        std::cerr << "Failed to bind line stream" << std::endl;
+        ReleaseLineStream(stream);
+        return false;
+    }
+    return true;
+}
+
+void UnifiedRenderer::UpdateLineStreamPositions(const LineStream& stream, const Vec3f* positions, size_t count,
+                                                size_t first) {
+    if (!stream.positionBuffer || count == 0 || first + count > stream.vertexCount) {
+        return;
+    }
+    wgpuQueueWriteBuffer(m_Queue, stream.positionBuffer, first * sizeof(Vec3f), positions + first,
+                         count * sizeof(Vec3f));
+}
+
+void UnifiedRenderer::UpdateLineStreamPositions(const LineStream& stream, const Vec3f* positions,
+                                                std::vector<uint32_t>& vertices) {
+    if (!stream.positionBuffer || vertices.empty()) {
+        return;
+    }
+    std::sort(vertices.begin(), vertices.end());
+    vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+    while (!vertices.empty() && vertices.back() >= stream.vertexCount) {
+        vertices.pop_back();
+    }
+    // Runs separated by small gaps cost less as one write than as several
+    size_t begin = 0;
+    for (size_t i = 1; i <= vertices.size(); ++i) {
+        if (i == vertices.size() || vertices[i] - vertices[i - 1] > DIRTY_RUN_MERGE_GAP) {
+            UpdateLineStreamPositions(stream, positions, vertices[i - 1] + 1 - vertices[begin], vertices[begin]);
+            begin = i;
+        }
+    }
+}
+
+bool UnifiedRenderer::UpdateLineStreamIndices(LineStream& stream, const uint32_t* indices, size_t count) {
+    if (!stream.positionBuffer || !m_Device) {
+        return false;
+    }
+    if (count > stream.indexCapacity) {
+        wgpuBufferRelease(stream.indexBuffer);
+        stream.indexBuffer = CreateStreamBuffer("Alice2 Line Stream Indices", WGPUBufferUsage_Storage,
+                                                count * sizeof(uint32_t));
+        if (!stream.indexBuffer || !BindLineStream(stream)) {
+            std::cerr << "Failed to create line stream buffers" << std::endl;
+            ReleaseLineStream(stream);
+            return false;
+        }
+        stream.indexCapacity = static_cast<uint32_t>(count);
+    }
+    stream.indexCount = static_cast<uint32_t>(count);
+    if (count > 0) {
+        wgpuQueueWriteBuffer(m_Queue, stream.indexBuffer, 0, indices, count * sizeof(uint32_t));
+    }
+    return true;
+}
+
+bool UnifiedRenderer::SetLineStreamColors(LineStream& stream, LineColorMode mode, const Color* colors, size_t count) {
+    if (!stream.positionBuffer || !m_Device || count == 0) {
+        return false;
+    }
+    size_t expected = mode == LineColorMode::PerVertex ? stream.vertexCount
+                      : mode == LineColorMode::PerLine ? stream.indexCount / 2
+                                                        : 1;
+    if (count != expected) {
+        std::cerr << "Line stream colours: expected " << expected << ", got " << count << std::endl;
+        return false;
+    }
+    if (count > stream.colorCapacity) {
+        wgpuBufferRelease(stream.colorBuffer);
+        stream.colorBuffer = CreateStreamBuffer("Alice2 Line Stream Colors", WGPUBufferUsage_Storage,
+                                                count * sizeof(Color));
+        if (!stream.colorBuffer || !BindLineStream(stream)) {
+            std::cerr << "Failed to create line stream buffers" << std::endl;
+            ReleaseLineStream(stream);
+            return false;
+        }
+        stream.colorCapacity = static_cast<uint32_t>(count);
+    }
+    wgpuQueueWriteBuffer(m_Queue, stream.colorBuffer, 0, colors, count * sizeof(Color));
+    // Fresh buffers read as zero, i.e. Uniform
+    if (mode != stream.colorMode) {
+        // Only the mode word; the point parameters follow it
+        uint32_t modeValue = static_cast<uint32_t>(mode);
+        wgpuQueueWriteBuffer(m_Queue, stream.paramBuffer, 0, &modeValue, sizeof(modeValue));
+        stream.colorMode = mode;
+    }
+    return true;
+}
+
+void UnifiedRenderer::DrawLineStream(const LineStream& stream) {
+    if (stream.bindGroup && stream.indexCount > 1) {
+        m_LineStreamDraws.push_back(stream);
+    }
+}
+
+void UnifiedRenderer::DrawLineStreamPoints(LineStream& stream, const Color& color, float size) {
+    if (!stream.bindGroup || stream.vertexCount == 0 || m_Width <= 0 || m_Height <= 0) {
+        return;
+    }
+    // Size, viewport and colour follow the colour mode in the parameters
+    size = std::max(size, 1.0f);
+    float width = static_cast<float>(m_Width), height = static_cast<float>(m_Height);
+    if (color != stream.pointColor || size != stream.pointSize || width != stream.pointViewport[0] ||
+        height != stream.pointViewport[1]) {
+        const float params[7] = {size, width, height, color.r, color.g, color.b, color.a};
+        wgpuQueueWriteBuffer(m_Queue, stream.paramBuffer, 4, params, sizeof(params));
+        stream.pointColor = color;
+        stream.pointSize = size;
+        stream.pointViewport[0] = width;
+        stream.pointViewport[1] = height;
+    }
+    m_LineStreamPointDraws.push_back(stream);
+}
+
+void UnifiedRenderer::ReleaseLineStream(LineStream& stream) {
+    if (stream.bindGroup) {
+        wgpuBindGroupRelease(stream.bindGroup);
+    }
+    WGPUBuffer buffers[4] = {stream.positionBuffer, stream.indexBuffer, stream.colorBuffer, stream.paramBuffer};
+    for (WGPUBuffer buffer : buffers) {
+        if (buffer) {
+            wgpuBufferRelease(buffer);
+        }
+    }
+    stream = LineStream();
+}
+
+bool UnifiedRenderer::CreatePointPool(PointPool& pool, size_t blockCount, size_t blockPoints) {
+    ReleasePointPool(pool);
+    if (!m_Device || !m_PointPoolLayout || blockCount == 0 || blockPoints == 0 ||
+        blockPoints * sizeof(OctreePoint) > POINT_POOL_PAGE_BYTES) {
+        return false;
+    }
+    pool.blockPoints = static_cast<uint32_t>(blockPoints);
+    pool.blockCount = static_cast<uint32_t>(blockCount);
+    pool.blocksPerBuffer = static_cast<uint32_t>(POINT_POOL_PAGE_BYTES / (blockPoints * sizeof(OctreePoint)));
+
+    for (size_t first = 0; first < blockCount; first += pool.blocksPerBuffer) {
+        size_t blocks = std::min<size_t>(pool.blocksPerBuffer, blockCount - first);
+        WGPUBuffer buffer = CreateStreamBuffer("Alice2 Point Pool Page", WGPUBufferUsage_Storage,
+                                               blocks * blockPoints * sizeof(OctreePoint));
+        WGPUBindGroup bindGroup = nullptr;
+        if (buffer) {
+            WGPUBindGroupEntry entry = {};
+            entry.binding = 0;
+            entry.buffer = buffer;
+            entry.offset = 0;
+            entry.size = wgpuBufferGetSize(buffer);
+            WGPUBindGroupDescriptor bindGroupDesc = {};
+            bindGroupDesc.nextInChain = nullptr;
+            bindGroupDesc.label = "Alice2 Point Pool Bind Group";
+            bindGroupDesc.layout = m_PointPoolLayout;
+            bindGroupDesc.entryCount = 1;
+            bindGroupDesc.entries = &entry;
+            bindGroup = wgpuDeviceCreateBindGroup(m_Device, &bindGroupDesc);
+        }
+        if (buffer) {
+            pool.buffers.push_back(buffer);
+        }
+        if (!bindGroup) {
+            std::cerr << "Failed to create point pool pages" << std::endl;
+            ReleasePointPool(pool);
+            return false;
+        }
+        pool.bindGroups.push_back(bindGroup);
+    }
+    return true;
+}
+
+void UnifiedRenderer::UpdatePointPoolBlock(const PointPool& pool, uint32_t block, const OctreePoint* points,
+                                           size_t count) {
+    if (block >= pool.blockCount || count == 0 || count > pool.blockPoints || pool.buffers.empty()) {
+        return;
+    }
+    uint64_t offset = uint64_t(block % pool.blocksPerBuffer) * pool.blockPoints * sizeof(OctreePoint);
+    wgpuQueueWriteBuffer(m_Queue, pool.buffers[block / pool.blocksPerBuffer], offset, points,
+                         count * sizeof(OctreePoint));
+}
+
+void UnifiedRenderer::DrawPointPoolBlock(const PointPool& pool, uint32_t block, uint32_t count) {
+    if (block >= pool.blockCount || count == 0 || pool.bindGroups.empty()) {
+        return;
+    }
+    m_PointPoolDraws.push_back({pool.bindGroups[block / pool.blocksPerBuffer],
+                                (block % pool.blocksPerBuffer) * pool.blockPoints, std::min(count, pool.blockPoints)});
+}
+
+void UnifiedRenderer::ReleasePointPool(PointPool& pool) {
+    for (WGPUBindGroup bindGroup : pool.bindGroups) {
+        wgpuBindGroupRelease(bindGroup);
+    }
+    for (WGPUBuffer buffer : pool.buffers) {
+        wgpuBufferRelease(buffer);
+    }
+    pool = PointPool();
+}
+
 
 
 bool UnifiedRenderer::InitializeWebGPU() {
@@ -471,6 +1107,17 @@ bool UnifiedRenderer::InitializeWebGPU() {
 
     std::cout << "Surface format: " << m_SurfaceFormat << std::endl;
 
+    ConfigureSurface();
+    std::cout << "✓ WebGPU surface configured" << std::endl;
+
+    // Clean up adapter (no longer needed)
+    wgpuAdapterRelease(adapter);
+
+    std::cout << "WebGPU initialization complete!" << std::endl;
+    return true;
+}
+
+void UnifiedRenderer::ConfigureSurface() {
     WGPUSurfaceConfiguration surfaceConfig = {};
     surfaceConfig.nextInChain = nullptr;
     surfaceConfig.device = m_Device;
@@ -484,15 +1131,89 @@ bool UnifiedRenderer::InitializeWebGPU() {
     surfaceConfig.viewFormats = nullptr;
 
     wgpuSurfaceConfigure(m_Surface, &surfaceConfig);
-    std::cout << "✓ WebGPU surface configured" << std::endl;
+}
 
-    // Clean up adapter (no longer needed)
-    wgpuAdapterRelease(adapter);
+bool UnifiedRenderer::CreateDepthTexture() {
+    ReleaseDepthTexture();
+
+    WGPUTextureDescriptor depthTextureDesc = {};
+    depthTextureDesc.nextInChain = nullptr;
+    depthTextureDesc.label = "Alice2 Depth Texture";
+    depthTextureDesc.usage = WGPUTextureUsage_RenderAttachment;
+    depthTextureDesc.dimension = WGPUTextureDimension_2D;
+    depthTextureDesc.size = {static_cast<uint32_t>(m_Width), static_cast<uint32_t>(m_Height), 1};
+    depthTextureDesc.format = m_DepthFormat;
+    depthTextureDesc.mipLevelCount = 1;
+    depthTextureDesc.sampleCount = 1;
+    depthTextureDesc.viewFormatCount = 1;
+    depthTextureDesc.viewFormats = &m_DepthFormat;
+
+    m_DepthTexture = wgpuDeviceCreateTexture(m_Device, &depthTextureDesc);
+    if (!m_DepthTexture) {
+        std::cerr << "Failed to create depth texture" << std::endl;
+        return false;
+    }
 
-    std::cout << "WebGPU initialization complete!" << std::endl;
+    WGPUTextureViewDescriptor depthViewDesc = {};
+    depthViewDesc.nextInChain = nullptr;
+    depthViewDesc.label = "Alice2 Depth Texture View";
+    depthViewDesc.format = m_DepthFormat;
+    depthViewDesc.dimension = WGPUTextureViewDimension_2D;
+    depthViewDesc.baseMipLevel = 0;
+    depthViewDesc.mipLevelCount = 1;
+    depthViewDesc.baseArrayLayer = 0;
+    depthViewDesc.arrayLayerCount = 1;
+    depthViewDesc.aspect = WGPUTextureAspect_DepthOnly;
+
+    m_DepthTextureView = wgpuTextureCreateView(m_DepthTexture, &depthViewDesc);
+    if (!m_DepthTextureView) {
+        std::cerr << "Failed to create depth texture view" << std::endl;
+        return false;
+    }
+
+    std::cout << "✓ Depth texture created (" << m_Width << "x" << m_Height << ")" << std::endl;
     return true;
 }
 
+void UnifiedRenderer::ReleaseDepthTexture() {
+    if (m_DepthTextureView) {
+        wgpuTextureViewRelease(m_DepthTextureView);
+        m_DepthTextureView = nullptr;
+    }
+    if (m_DepthTexture) {
+        wgpuTextureDestroy(m_DepthTexture);
+        wgpuTextureRelease(m_DepthTexture);
+        m_DepthTexture = nullptr;
+    }
+}
+
+void UnifiedRenderer::ReleasePipelines() {
+    if (m_PointPipeline) {
+        wgpuRenderPipelineRelease(m_PointPipeline);
+        m_PointPipeline = nullptr;
+    }
+    if (m_LinePipeline) {
+        wgpuRenderPipelineRelease(m_LinePipeline);
+        m_LinePipeline = nullptr;
+    }
+    if (m_TrianglePipeline) {
+        wgpuRenderPipelineRelease(m_TrianglePipeline);
+        m_TrianglePipeline = nullptr;
+    }
+    if (m_LineStreamPipeline) {
+        wgpuRenderPipelineRelease(m_LineStreamPipeline);
+        m_LineStreamPipeline = nullptr;
+    }
+    if (m_LineStreamPointPipeline) {
+        wgpuRenderPipelineRelease(m_LineStreamPointPipeline);
+        m_LineStreamPointPipeline = nullptr;
+    }
+    if (m_PointPoolPipeline) {
+        wgpuRenderPipelineRelease(m_PointPoolPipeline);
+        m_PointPoolPipeline = nullptr;
+    }
+}
+
 bool UnifiedRenderer::CreatePipelines() {
     std::cout << "Creating WebGPU rendering pipelines..." << std::endl;
 
@@ -506,7 +1227,7 @@ bool UnifiedRenderer::CreatePipelines() {
     }
     std::cout << "✓ Shader modules created" << std::endl;
 
-    // Create bind group layout for uniforms
+    // Create bind group layout for uniforms (reused when pipelines are rebuilt)
     WGPUBindGroupLayoutEntry bindGroupLayoutEntry = {};
     bindGroupLayoutEntry.binding = 0;
     bindGroupLayoutEntry.visibility = WGPUShaderStage_Vertex;
@@ -520,7 +1241,7 @@ bool UnifiedRenderer::CreatePipelines() {
     bindGroupLayoutDesc.entryCount = 1;
     bindGroupLayoutDesc.entries = &bindGroupLayoutEntry;
 
-    WGPUBindGroupLayout bindGroupLayout = wgpuDeviceCreateBindGroupLayout(m_Device, &bindGroupLayoutDesc);
+    WGPUBindGroupLayout bindGroupLayout = m_BindGroupLayout ? m_BindGroupLayout : wgpuDeviceCreateBindGroupLayout(m_Device, &bindGroupLayoutDesc);
     if (!bindGroupLayout) {
         std::cerr << "Failed to create bind group layout" << std::endl;
         return false;
@@ -599,6 +1320,27 @@ bool UnifiedRenderer::CreatePipelines() {
     pointPipelineDesc.multisample.mask = ~0u;
     pointPipelineDesc.multisample.alphaToCoverageEnabled = false;
 
+    // Depth test: reversed-Z keeps the fragment with the greater depth
+    WGPUStencilFaceState stencilFace = {};
+    stencilFace.compare = WGPUCompareFunction_Always;
+    stencilFace.failOp = WGPUStencilOperation_Keep;
+    stencilFace.depthFailOp = WGPUStencilOperation_Keep;
+    stencilFace.passOp = WGPUStencilOperation_Keep;
+
+    WGPUDepthStencilState depthStencilState = {};
+    depthStencilState.nextInChain = nullptr;
+    depthStencilState.format = m_DepthFormat;
+    depthStencilState.depthWriteEnabled = true;
+    depthStencilState.depthCompare = m_ReversedZ ? WGPUCompareFunction_Greater : WGPUCompareFunction_Less;
+    depthStencilState.stencilFront = stencilFace;
+    depthStencilState.stencilBack = stencilFace;
+    depthStencilState.stencilReadMask = 0;
+    depthStencilState.stencilWriteMask = 0;
+    depthStencilState.depthBias = 0;
+    depthStencilState.depthBiasSlopeScale = 0.0f;
+    depthStencilState.depthBiasClamp = 0.0f;
+    pointPipelineDesc.depthStencil = &depthStencilState;
+
     m_PointPipeline = wgpuDeviceCreateRenderPipeline(m_Device, &pointPipelineDesc);
     if (!m_PointPipeline) {
         std::cerr << "Failed to create point pipeline" << std::endl;
@@ -630,6 +1372,18 @@ bool UnifiedRenderer::CreatePipelines() {
     }
     std::cout << "✓ Triangle pipeline created" << std::endl;
 
+    // Line stream pipeline: no vertex buffers, everything comes from group 1
+    if (!CreateLineStreamPipeline(bindGroupLayout, linePipelineDesc)) {
+        return false;
+    }
+    std::cout << "✓ Line stream pipeline created" << std::endl;
+
+    // Point pool pipeline: points pulled from storage pages in group 1
+    if (!CreatePointPoolPipeline(bindGroupLayout, pointPipelineDesc)) {
+        return false;
+    }
+    std::cout << "✓ Point pool pipeline created" << std::endl;
+
     // Store bind group layout for buffer creation
     m_BindGroupLayout = bindGroupLayout;
 
@@ -642,6 +1396,124 @@ bool UnifiedRenderer::CreatePipelines() {
     return true;
 }
 
+bool UnifiedRenderer::CreateLineStreamPipeline(WGPUBindGroupLayout uniformLayout,
+                                               const WGPURenderPipelineDescriptor& linePipelineDesc) {
+    WGPUShaderModule shader = CreateShaderModule(LINE_STREAM_SHADER_SOURCE);
+    if (!shader) {
+        std::cerr << "Failed to create line stream shader" << std::endl;
+        return false;
+    }
+
+    // Streams keep their bind groups across pipeline rebuilds, so the layout persists
+    if (!m_LineStreamLayout) {
+        WGPUBindGroupLayoutEntry entries[4] = {};
+        for (uint32_t i = 0; i < 4; ++i) {
+            entries[i].binding = i;
+            entries[i].visibility = WGPUShaderStage_Vertex;
+            entries[i].buffer.type = i < 3 ? WGPUBufferBindingType_ReadOnlyStorage : WGPUBufferBindingType_Uniform;
+            entries[i].buffer.hasDynamicOffset = false;
+            entries[i].buffer.minBindingSize = 0;
+        }
+        WGPUBindGroupLayoutDescriptor layoutDesc = {};
+        layoutDesc.nextInChain = nullptr;
+        layoutDesc.label = "Alice2 Line Stream Bind Group Layout";
+        layoutDesc.entryCount = 4;
+        layoutDesc.entries = entries;
+        m_LineStreamLayout = wgpuDeviceCreateBindGroupLayout(m_Device, &layoutDesc);
+    }
+
+    WGPUBindGroupLayout layouts[2] = {uniformLayout, m_LineStreamLayout};
+    WGPUPipelineLayoutDescriptor pipelineLayoutDesc = {};
+    pipelineLayoutDesc.nextInChain = nullptr;
+    pipelineLayoutDesc.label = "Alice2 Line Stream Pipeline Layout";
+    pipelineLayoutDesc.bindGroupLayoutCount = 2;
+    pipelineLayoutDesc.bindGroupLayouts = layouts;
+    WGPUPipelineLayout pipelineLayout =
+        m_LineStreamLayout ? wgpuDeviceCreatePipelineLayout(m_Device, &pipelineLayoutDesc) : nullptr;
+    if (!pipelineLayout) {
+        std::cerr << "Failed to create line stream pipeline layout" << std::endl;
+        wgpuShaderModuleRelease(shader);
+        return false;
+    }
+
+    WGPURenderPipelineDescriptor pipelineDesc = linePipelineDesc;
+    pipelineDesc.label = "Alice2 Line Stream Pipeline";
+    pipelineDesc.layout = pipelineLayout;
+    pipelineDesc.vertex.module = shader;
+    pipelineDesc.vertex.bufferCount = 0;
+    pipelineDesc.vertex.buffers = nullptr;
+    m_LineStreamPipeline = wgpuDeviceCreateRenderPipeline(m_Device, &pipelineDesc);
+
+    // Same bindings, one screen-aligned quad per stream vertex
+    pipelineDesc.label = "Alice2 Line Stream Point Pipeline";
+    pipelineDesc.vertex.entryPoint = "vs_points";
+    pipelineDesc.primitive.topology = WGPUPrimitiveTopology_TriangleList;
+    m_LineStreamPointPipeline = wgpuDeviceCreateRenderPipeline(m_Device, &pipelineDesc);
+
+    wgpuPipelineLayoutRelease(pipelineLayout);
+    wgpuShaderModuleRelease(shader);
+    if (!m_LineStreamPipeline || !m_LineStreamPointPipeline) {
+        std::cerr << "Failed to create line stream pipeline" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool UnifiedRenderer::CreatePointPoolPipeline(WGPUBindGroupLayout uniformLayout,
+                                              const WGPURenderPipelineDescriptor& pointPipelineDesc) {
+    WGPUShaderModule shader = CreateShaderModule(POINT_POOL_SHADER_SOURCE);
+    if (!shader) {
+        std::cerr << "Failed to create point pool shader" << std::endl;
+        return false;
+    }
+
+    // Pools keep their bind groups across pipeline rebuilds, so the layout persists
+    if (!m_PointPoolLayout) {
+        WGPUBindGroupLayoutEntry entry = {};
+        entry.binding = 0;
+        entry.visibility = WGPUShaderStage_Vertex;
+        entry.buffer.type = WGPUBufferBindingType_ReadOnlyStorage;
+        entry.buffer.hasDynamicOffset = false;
+        entry.buffer.minBindingSize = 0;
+        WGPUBindGroupLayoutDescriptor layoutDesc = {};
+        layoutDesc.nextInChain = nullptr;
+        layoutDesc.label = "Alice2 Point Pool Bind Group Layout";
+        layoutDesc.entryCount = 1;
+        layoutDesc.entries = &entry;
+        m_PointPoolLayout = wgpuDeviceCreateBindGroupLayout(m_Device, &layoutDesc);
+    }
+
+    WGPUBindGroupLayout layouts[2] = {uniformLayout, m_PointPoolLayout};
+    WGPUPipelineLayoutDescriptor pipelineLayoutDesc = {};
+    pipelineLayoutDesc.nextInChain = nullptr;
+    pipelineLayoutDesc.label = "Alice2 Point Pool Pipeline Layout";
+    pipelineLayoutDesc.bindGroupLayoutCount = 2;
+    pipelineLayoutDesc.bindGroupLayouts = layouts;
+    WGPUPipelineLayout pipelineLayout =
+        m_PointPoolLayout ? wgpuDeviceCreatePipelineLayout(m_Device, &pipelineLayoutDesc) : nullptr;
+    if (!pipelineLayout) {
+        std::cerr << "Failed to create point pool pipeline layout" << std::endl;
+        wgpuShaderModuleRelease(shader);
+        return false;
+    }
+
+    WGPURenderPipelineDescriptor pipelineDesc = pointPipelineDesc;
+    pipelineDesc.label = "Alice2 Point Pool Pipeline";
+    pipelineDesc.layout = pipelineLayout;
+    pipelineDesc.vertex.module = shader;
+    pipelineDesc.vertex.bufferCount = 0;
+    pipelineDesc.vertex.buffers = nullptr;
+    m_PointPoolPipeline = wgpuDeviceCreateRenderPipeline(m_Device, &pipelineDesc);
+
+    wgpuPipelineLayoutRelease(pipelineLayout);
+    wgpuShaderModuleRelease(shader);
+    if (!m_PointPoolPipeline) {
+        std::cerr << "Failed to create point pool pipeline" << std::endl;
+        return false;
+    }
+    return true;
+}
+
 bool UnifiedRenderer::CreateBuffers() {
     std::cout << "Creating WebGPU buffers..." << std::endl;
 
@@ -654,13 +1526,15 @@ bool UnifiedRenderer::CreateBuffers() {
     m_ViewMatrix[0] = m_ViewMatrix[5] = m_ViewMatrix[10] = m_ViewMatrix[15] = 1.0f;
     m_ProjectionMatrix[0] = m_ProjectionMatrix[5] = m_ProjectionMatrix[10] = m_ProjectionMatrix[15] = 1.0f;
     m_ModelMatrix[0] = m_ModelMatrix[5] = m_ModelMatrix[10] = m_ModelMatrix[15] = 1.0f;
+    m_HasViewProjectionMatrix = false;
+    m_UniformsDirty = true;
 
     // Create vertex buffer (dynamic, will be updated each frame)
     WGPUBufferDescriptor vertexBufferDesc = {};
     vertexBufferDesc.nextInChain = nullptr;
     vertexBufferDesc.label = "Alice2 Vertex Buffer";
     vertexBufferDesc.usage = WGPUBufferUsage_Vertex | WGPUBufferUsage_CopyDst;
-    vertexBufferDesc.size = sizeof(Vertex) * 1000; // Allocate space for up to 1000 vertices
+    vertexBufferDesc.size = sizeof(Vertex) * 1000; // Allocate space for up to 1000 vertices; grows on demand
     vertexBufferDesc.mappedAtCreation = false;
 
     m_VertexBuffer = wgpuDeviceCreateBuffer(m_Device, &vertexBufferDesc);
@@ -668,6 +1542,7 @@ bool UnifiedRenderer::CreateBuffers() {
         std::cerr << "Failed to create vertex buffer" << std::endl;
         return false;
     }
+    m_VertexBufferCapacity = 1000;
     std::cout << "✓ Vertex buffer created" << std::endl;
 
     // Create uniform buffer for MVP matrix
@@ -713,42 +1588,130 @@ bool UnifiedRenderer::CreateBuffers() {
     return true;
 }
 
-void UnifiedRenderer::UpdateUniformBuffer() {
-    // Combine view and projection matrices
-    std::array<float, 16> viewProjectionMatrix;
-
-    // Matrix multiplication: viewProjection = projection * view
-    for (int row = 0; row < 4; ++row) {
+void UnifiedRenderer::CombineViewProjection() {
+    // Combine view and projection matrices unless a combined matrix was supplied
+    if (!m_HasViewProjectionMatrix) {
+        // Matrix multiplication (column-major): viewProjection = projection * view
         for (int col = 0; col < 4; ++col) {
-            float sum = 0.0f;
-            for (int k = 0; k < 4; ++k) {
-                sum += m_ProjectionMatrix[row * 4 + k] * m_ViewMatrix[k * 4 + col];
+            for (int row = 0; row < 4; ++row) {
+                float sum = 0.0f;
+                for (int k = 0; k < 4; ++k) {
+                    sum += m_ProjectionMatrix[k * 4 + row] * m_ViewMatrix[col * 4 + k];
+                }
+                m_ViewProjectionMatrix[col * 4 + row] = sum;
             }
-            viewProjectionMatrix[row * 4 + col] = sum;
         }
     }
+}
 
-    // Debug: Print matrix values occasionally
-    static int debugCounter = 0;
-    if (debugCounter % 300 == 0) {
-        std::cout << "View matrix: [" << m_ViewMatrix[0] << "," << m_ViewMatrix[1] << "," << m_ViewMatrix[2] << "," << m_ViewMatrix[3] << "]" << std::endl;
-        std::cout << "Proj matrix: [" << m_ProjectionMatrix[0] << "," << m_ProjectionMatrix[1] << "," << m_ProjectionMatrix[2] << "," << m_ProjectionMatrix[3] << "]" << std::endl;
-        std::cout << "MVP matrix: [" << viewProjectionMatrix[0] << "," << viewProjectionMatrix[1] << "," << viewProjectionMatrix[2] << "," << viewProjectionMatrix[3] << "]" << std::endl;
-
-        // Print full MVP matrix for debugging
-        std::cout << "Full MVP matrix:" << std::endl;
-        for (int i = 0; i < 4; i++) {
-            std::cout << "[" << viewProjectionMatrix[i*4+0] << ", " << viewProjectionMatrix[i*4+1] << ", "
-                      << viewProjectionMatrix[i*4+2] << ", " << viewProjectionMatrix[i*4+3] << "]" << std::endl;
+float UnifiedRenderer::GetPixelsPerUnit(const Vec3f& center, float radius) {
+    if (m_UniformsDirty) {
+        CombineViewProjection();
+    }
+    const std::array<float, 16>& m = m_ViewProjectionMatrix;
+
+    // Clip w is the view depth under perspective and constant under an
+    // orthographic projection; the nearest point of the sphere is used
+    float w = m[3] * center.x + m[7] * center.y + m[11] * center.z + m[15];
+    float depthScale = std::sqrt(m[3] * m[3] + m[7] * m[7] + m[11] * m[11]);
+    if (depthScale > 0.0f) {
+        w -= radius * depthScale;
+        if (w <= 1e-6f) {
+            return std::numeric_limits<float>::infinity();
         }
     }
-    debugCounter++;
+    float yScale = std::sqrt(m[1] * m[1] + m[5] * m[5] + m[9] * m[9]);
+    return 0.5f * static_cast<float>(m_Height) * yScale / w;
+}
+
+bool UnifiedRenderer::IsSphereVisible(const Vec3f& center, float radius) {
+    if (m_UniformsDirty) {
+        CombineViewProjection();
+    }
+    const std::array<float, 16>& m = m_ViewProjectionMatrix;
+
+    // Clip space keeps -w <= x, y <= w; each side plane is w plus or minus
+    // a clip row, and w > 0 is the half-space in front of the camera
+    const float x[4] = {m[0], m[4], m[8], m[12]};
+    const float y[4] = {m[1], m[5], m[9], m[13]};
+    const float w[4] = {m[3], m[7], m[11], m[15]};
+    auto outside = [&](const float* row, float sign) {
+        float a = w[0] + sign * row[0], b = w[1] + sign * row[1], c = w[2] + sign * row[2];
+        float distance = a * center.x + b * center.y + c * center.z + w[3] + sign * row[3];
+        return distance < -radius * std::sqrt(a * a + b * b + c * c);
+    };
+    if (outside(x, 1.0f) || outside(x, -1.0f) || outside(y, 1.0f) || outside(y, -1.0f)) {
+        return false;
+    }
+    return !outside(w, 0.0f);
+}
+
+bool UnifiedRenderer::GetViewOrigin(Vec3f& origin) {
+    if (m_UniformsDirty) {
+        CombineViewProjection();
+    }
+    const std::array<float, 16>& m = m_ViewProjectionMatrix;
+
+    // The camera centre is the null vector of the clip x, y and w rows; its
+    // components are the signed 3x3 minors of those rows
+    const float r0[4] = {m[0], m[4], m[8], m[12]};
+    const float r1[4] = {m[1], m[5], m[9], m[13]};
+    const float r3[4] = {m[3], m[7], m[11], m[15]};
+    auto minor = [&](int a, int b, int c) {
+        return r0[a] * (r1[b] * r3[c] - r1[c] * r3[b]) - r0[b] * (r1[a] * r3[c] - r1[c] * r3[a])
+             + r0[c] * (r1[a] * r3[b] - r1[b] * r3[a]);
+    };
+    float x = minor(1, 2, 3), y = -minor(0, 2, 3), z = minor(0, 1, 3), w = -minor(0, 1, 2);
+    float length = std::sqrt(x * x + y * y + z * z);
+    if (std::abs(w) > 1e-6f * length) {
+        origin = Vec3f(x / w, y / w, z / w);
+        return true;
+    }
+    origin = length > 0.0f ? Vec3f(x / length, y / length, z / length) : Vec3f(0.0f, 0.0f, -1.0f);
+    return false;
+}
+
+void UnifiedRenderer::UpdateUniformBuffer() {
+    // Skip the upload entirely when no matrix changed since the last frame
+    if (!m_UniformsDirty) {
+        return;
+    }
+
+    CombineViewProjection();
 
     // Upload to WebGPU uniform buffer
-    wgpuQueueWriteBuffer(m_Queue, m_UniformBuffer, 0, viewProjectionMatrix.data(), sizeof(float) * 16);
+    wgpuQueueWriteBuffer(m_Queue, m_UniformBuffer, 0, m_ViewProjectionMatrix.data(), sizeof(float) * 16);
+    m_UniformsDirty = false;
+}
+
+bool UnifiedRenderer::ReserveVertexBuffer(size_t count) {
+    if (count <= m_VertexBufferCapacity) {
+        return true;
+    }
+    if (m_VertexBuffer) {
+        wgpuBufferRelease(m_VertexBuffer);
+        m_VertexBuffer = nullptr;
+    }
+    // Doubling keeps reallocation rare while the scene grows
+    size_t capacity = std::max(count, m_VertexBufferCapacity * 2);
+    WGPUBufferDescriptor vertexBufferDesc = {};
+    vertexBufferDesc.nextInChain = nullptr;
+    vertexBufferDesc.label = "Alice2 Vertex Buffer";
+    vertexBufferDesc.usage = WGPUBufferUsage_Vertex | WGPUBufferUsage_CopyDst;
+    vertexBufferDesc.size = capacity * sizeof(Vertex);
+    vertexBufferDesc.mappedAtCreation = false;
+    m_VertexBuffer = wgpuDeviceCreateBuffer(m_Device, &vertexBufferDesc);
+    if (!m_VertexBuffer) {
+        std::cerr << "Failed to grow vertex buffer to " << capacity << " vertices" << std::endl;
+        m_VertexBufferCapacity = 0;
+        return false;
+    }
+    m_VertexBufferCapacity = capacity;
+    return true;
 }
 
-void UnifiedRenderer::FlushVertexData(const std::vector<Vertex>& vertices, WGPURenderPipeline pipeline, WGPURenderPassEncoder renderPass) {
+void UnifiedRenderer::FlushVertexData(const std::vector<Vertex>& vertices, size_t& offset, WGPURenderPipeline pipeline,
+                                      WGPURenderPassEncoder renderPass) {
     if (vertices.empty() || !pipeline || !renderPass) {
         return;
     }
@@ -763,15 +1726,17 @@ void UnifiedRenderer::FlushVertexData(const std::vector<Vertex>& vertices, WGPUR
     }
     debugCounter++;
 
-    // Upload vertex data to buffer
+    // Upload vertex data to buffer after the batches already flushed this frame
     size_t dataSize = vertices.size() * sizeof(Vertex);
-    wgpuQueueWriteBuffer(m_Queue, m_VertexBuffer, 0, vertices.data(), dataSize);
+    size_t dataOffset = offset * sizeof(Vertex);
+    wgpuQueueWriteBuffer(m_Queue, m_VertexBuffer, dataOffset, vertices.data(), dataSize);
+    offset += vertices.size();
 
     // Set pipeline
     wgpuRenderPassEncoderSetPipeline(renderPass, pipeline);
 
     // Set vertex buffer
-    wgpuRenderPassEncoderSetVertexBuffer(renderPass, 0, m_VertexBuffer, 0, dataSize);
+    wgpuRenderPassEncoderSetVertexBuffer(renderPass, 0, m_VertexBuffer, dataOffset, dataSize);
 
     // Draw vertices
     wgpuRenderPassEncoderDraw(renderPass, static_cast<uint32_t>(vertices.size()), 1, 0, 0);
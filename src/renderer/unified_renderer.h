@@ -6,9 +6,11 @@
 #include <array>
 #include <string>
 #include "../core/base/Types.h"
+#include "../coda/core/utilities/Quantize.h"
 
 // Forward declarations
 namespace alice2 { namespace platform { class IPlatform; } }
+namespace alice2 { struct OctreePoint; }
 
 namespace alice2 {
 
@@ -19,6 +21,58 @@ struct Vertex {
     float size; // For points
 };
 
+// Retained indexed triangles (or line pairs) in the Vertex layout. Vertices
+// can be rewritten in place every frame (e.g. re-evaluated subdivision)
+// while the index buffer stays on the GPU.
+struct IndexedMesh {
+    WGPUBuffer vertexBuffer = nullptr;
+    WGPUBuffer indexBuffer = nullptr;
+    uint32_t vertexCount = 0;
+    uint32_t indexCount = 0;
+    uint32_t indexCapacity = 0;
+};
+
+// How a line stream colours its lines
+enum class LineColorMode : uint32_t {
+    Uniform,   // colors[0]
+    PerVertex, // colors[vertex]
+    PerLine    // colors[index / 2], one per vertex pair
+};
+
+// Retained lines drawn straight from a positions array and a list of vertex
+// pairs (e.g. a Mesh or Graph position array and its edge list). The shader
+// fetches each endpoint through the index list, so the arrays upload as
+// stored, with no per-line vertices; moved vertices can be rewritten by range.
+struct LineStream {
+    WGPUBuffer positionBuffer = nullptr;
+    WGPUBuffer indexBuffer = nullptr;
+    WGPUBuffer colorBuffer = nullptr;
+    WGPUBuffer paramBuffer = nullptr;
+    WGPUBindGroup bindGroup = nullptr;
+    uint32_t vertexCount = 0;
+    uint32_t indexCount = 0;
+    uint32_t indexCapacity = 0;
+    uint32_t colorCapacity = 0;
+    LineColorMode colorMode = LineColorMode::Uniform;
+    // Point parameters last written; fresh parameter buffers read as zero
+    Color pointColor = Color(0.0f, 0.0f, 0.0f, 0.0f);
+    float pointSize = 0.0f;
+    float pointViewport[2] = {0.0f, 0.0f};
+};
+
+// Fixed GPU memory for streamed point clouds, split into blocks of
+// blockPoints OctreePoint records (position and RGBA8 colour). A streamed
+// octree node occupies whole blocks, so blocks are freed and reused in any
+// order without fragmenting the pool; the shader pulls the records by
+// vertex index, so a block draws without vertex buffers.
+struct PointPool {
+    std::vector<WGPUBuffer> buffers; // Pages of blocksPerBuffer blocks
+    std::vector<WGPUBindGroup> bindGroups;
+    uint32_t blockPoints = 0;
+    uint32_t blockCount = 0;
+    uint32_t blocksPerBuffer = 0;
+};
+
 class UnifiedRenderer {
 public:
     UnifiedRenderer();
@@ -53,11 +107,75 @@ public:
     void SetViewMatrix(const float* viewMatrix);
     void SetProjectionMatrix(const float* projMatrix);
     void SetModelMatrix(const float* modelMatrix);
+    void SetViewProjectionMatrix(const float* viewProjMatrix);
     
+    // Screen pixels covered by one world unit at the nearest point of a
+    // bounding sphere (for LOD selection); infinite when the sphere reaches
+    // the camera plane
+    float GetPixelsPerUnit(const Vec3f& center, float radius = 0.0f);
+
+    // Whether a bounding sphere reaches inside the side planes of the view
+    // frustum and in front of the camera (near and far are not tested)
+    bool IsSphereVisible(const Vec3f& center, float radius);
+
+    // World-space camera position recovered from the view-projection matrix.
+    // Returns false under an orthographic projection, where origin receives
+    // the viewing direction instead (up to sign)
+    bool GetViewOrigin(Vec3f& origin);
+
     // Viewport and settings
     void SetViewport(int width, int height);
     void SetClearColor(const Color& color);
+
+    // Depth convention; must match the camera projection (reversed-Z uses Greater)
+    void SetReversedZ(bool reversed);
+    bool IsReversedZ() const { return m_ReversedZ; }
     
+    // Packed attribute upload. Bytes are copied as stored, so the buffer can
+    // be bound with GetVertexFormat(); the caller releases the buffer.
+    static WGPUVertexFormat GetVertexFormat(const quantize::PackedAttribute& attribute);
+    WGPUBuffer CreateAttributeBuffer(const quantize::PackedAttribute& attribute, const char* label = "Alice2 Attribute Buffer");
+    void UpdateAttributeBuffer(WGPUBuffer buffer, const quantize::PackedAttribute& attribute);
+
+    // Indexed mesh upload; DrawIndexedMesh queues a draw for the current frame,
+    // issued after the immediate-mode triangles. The caller releases the mesh.
+    bool CreateIndexedMesh(IndexedMesh& mesh, const Vertex* vertices, size_t vertexCount,
+                           const uint32_t* indices, size_t indexCount);
+    void UpdateIndexedMeshVertices(const IndexedMesh& mesh, const Vertex* vertices, size_t count, size_t first = 0);
+    // vertices is the whole array; rewrites the listed vertices (sorted in
+    // place) in coalesced runs
+    void UpdateIndexedMeshVertices(const IndexedMesh& mesh, const Vertex* vertices, std::vector<uint32_t>& indices);
+    // Replaces the index list, reallocating the index buffer only when it grows
+    bool UpdateIndexedMeshIndices(IndexedMesh& mesh, const uint32_t* indices, size_t count);
+    void DrawIndexedMesh(const IndexedMesh& mesh);
+    static void ReleaseIndexedMesh(IndexedMesh& mesh);
+
+    // Line streams; DrawLineStream queues a draw after the immediate-mode lines.
+    // Index lists may be empty (and grow later). The caller releases the stream.
+    bool CreateLineStream(LineStream& stream, const Vec3f* positions, size_t vertexCount,
+                          const uint32_t* indices, size_t indexCount);
+    // positions is the whole array; [first, first + count) is rewritten
+    void UpdateLineStreamPositions(const LineStream& stream, const Vec3f* positions, size_t count, size_t first = 0);
+    // Rewrites the listed vertices (sorted in place) in coalesced runs
+    void UpdateLineStreamPositions(const LineStream& stream, const Vec3f* positions, std::vector<uint32_t>& vertices);
+    bool UpdateLineStreamIndices(LineStream& stream, const uint32_t* indices, size_t count);
+    // count must match the mode: 1, the vertex count or the line count
+    bool SetLineStreamColors(LineStream& stream, LineColorMode mode, const Color* colors, size_t count);
+    void DrawLineStream(const LineStream& stream);
+    // Queues every vertex of the stream as a square point size pixels
+    // across, pulled from the same position buffer, so vertex display needs
+    // no per-frame upload
+    void DrawLineStreamPoints(LineStream& stream, const Color& color, float size = 1.0f);
+    static void ReleaseLineStream(LineStream& stream);
+
+    // Point pools; DrawPointPoolBlock queues a draw of the first count points
+    // of a block, issued after the immediate-mode points. Pages stay within
+    // the default storage binding limit. The caller releases the pool.
+    bool CreatePointPool(PointPool& pool, size_t blockCount, size_t blockPoints);
+    void UpdatePointPoolBlock(const PointPool& pool, uint32_t block, const OctreePoint* points, size_t count);
+    void DrawPointPoolBlock(const PointPool& pool, uint32_t block, uint32_t count);
+    static void ReleasePointPool(PointPool& pool);
+
     // WebGPU access for advanced usage
     WGPUDevice GetDevice() const { return m_Device; }
     WGPUQueue GetQueue() const { return m_Queue; }
@@ -72,6 +190,12 @@ private:
     WGPUDevice m_Device = nullptr;
     WGPUQueue m_Queue = nullptr;
     WGPUTextureFormat m_SurfaceFormat = WGPUTextureFormat_Undefined;
+
+    // Depth attachment (float depth for reversed-Z precision)
+    WGPUTextureFormat m_DepthFormat = WGPUTextureFormat_Depth32Float;
+    WGPUTexture m_DepthTexture = nullptr;
+    WGPUTextureView m_DepthTextureView = nullptr;
+    bool m_ReversedZ = true;
     
     // Rendering state
     int m_Width = 0;
@@ -82,14 +206,23 @@ private:
     std::array<float, 16> m_ViewMatrix;
     std::array<float, 16> m_ProjectionMatrix;
     std::array<float, 16> m_ModelMatrix;
+    std::array<float, 16> m_ViewProjectionMatrix;
+    bool m_HasViewProjectionMatrix = false; // Set when the caller supplies a precombined matrix
+    bool m_UniformsDirty = true;
     
     // Rendering pipelines
     WGPURenderPipeline m_PointPipeline = nullptr;
     WGPURenderPipeline m_LinePipeline = nullptr;
     WGPURenderPipeline m_TrianglePipeline = nullptr;
+    WGPURenderPipeline m_LineStreamPipeline = nullptr;
+    WGPURenderPipeline m_LineStreamPointPipeline = nullptr;
+    WGPUBindGroupLayout m_LineStreamLayout = nullptr;
+    WGPURenderPipeline m_PointPoolPipeline = nullptr;
+    WGPUBindGroupLayout m_PointPoolLayout = nullptr;
 
     // Buffers for immediate mode rendering
     WGPUBuffer m_VertexBuffer = nullptr;
+    size_t m_VertexBufferCapacity = 0; // In vertices
     WGPUBuffer m_UniformBuffer = nullptr;
     WGPUBindGroup m_UniformBindGroup = nullptr;
     WGPUBindGroupLayout m_BindGroupLayout = nullptr;
@@ -98,13 +231,36 @@ private:
     std::vector<Vertex> m_PointVertices;
     std::vector<Vertex> m_LineVertices;
     std::vector<Vertex> m_TriangleVertices;
+    std::vector<IndexedMesh> m_IndexedDraws;
+    std::vector<LineStream> m_LineStreamDraws;
+    std::vector<LineStream> m_LineStreamPointDraws;
+
+    // Queued point pool block draws
+    struct PointPoolDraw {
+        WGPUBindGroup bindGroup;
+        uint32_t firstPoint;
+        uint32_t count;
+    };
+    std::vector<PointPoolDraw> m_PointPoolDraws;
     
     // Internal methods
     bool InitializeWebGPU();
     bool CreatePipelines();
+    bool CreateLineStreamPipeline(WGPUBindGroupLayout uniformLayout, const WGPURenderPipelineDescriptor& linePipelineDesc);
+    bool CreatePointPoolPipeline(WGPUBindGroupLayout uniformLayout, const WGPURenderPipelineDescriptor& pointPipelineDesc);
+    void ReleasePipelines();
     bool CreateBuffers();
+    void ConfigureSurface();
+    bool CreateDepthTexture();
+    void ReleaseDepthTexture();
+    void CombineViewProjection();
     void UpdateUniformBuffer();
-    void FlushVertexData(const std::vector<Vertex>& vertices, WGPURenderPipeline pipeline, WGPURenderPassEncoder renderPass);
+    WGPUBuffer CreateStreamBuffer(const char* label, WGPUBufferUsageFlags usage, size_t size);
+    bool BindLineStream(LineStream& stream);
+    bool ReserveVertexBuffer(size_t count);
+    // Draws vertices from offset in the shared vertex buffer and advances offset
+    void FlushVertexData(const std::vector<Vertex>& vertices, size_t& offset, WGPURenderPipeline pipeline,
+                         WGPURenderPassEncoder renderPass);
 
     // Shader creation helpers
     WGPUShaderModule CreateShaderModule(const char* source);